@@ -264,6 +264,78 @@ void TF_EnqueueNamedTensor(TF_Session* session, int tensor_id,
   VLOG(1) << "Enqueuing is done.";
 }
 
+void TF_SessionMakeCallable(TF_Session* session, const TF_Output* feeds,
+                            int nfeeds, const TF_Output* fetches, int nfetches,
+                            int64_t* out_handle, TF_Status* status) {
+  if (session->extend_before_run &&
+      !tensorflow::ExtendSessionGraphHelper(session, status)) {
+    return;
+  }
+
+  tensorflow::CallableOptions callable_options;
+  for (int i = 0; i < nfeeds; ++i) {
+    callable_options.add_feed(tensorflow::strings::StrCat(
+        feeds[i].oper->node.name(), ":", feeds[i].index));
+  }
+  for (int i = 0; i < nfetches; ++i) {
+    callable_options.add_fetch(tensorflow::strings::StrCat(
+        fetches[i].oper->node.name(), ":", fetches[i].index));
+  }
+
+  tensorflow::Session::CallableHandle handle;
+  status->status = session->session->MakeCallable(callable_options, &handle);
+  if (TF_GetCode(status) == TF_OK) {
+    *out_handle = handle;
+  }
+}
+
+void TF_SessionRunCallable(TF_Session* session, int64_t handle,
+                           TF_Tensor* const* feed_values, int nfeeds,
+                           TF_Tensor** fetch_values, int nfetches,
+                           TF_Status* status) {
+  for (int i = 0; i < nfetches; ++i) {
+    fetch_values[i] = nullptr;
+  }
+
+  // TF_TensorToTensor shares the underlying buffer for all dtypes except
+  // TF_STRING, so no input copies are made here.
+  std::vector<tensorflow::Tensor> feed_tensors(nfeeds);
+  for (int i = 0; i < nfeeds; ++i) {
+    status->status =
+        tensorflow::TF_TensorToTensor(feed_values[i], &feed_tensors[i]);
+    if (TF_GetCode(status) != TF_OK) return;
+  }
+
+  std::vector<tensorflow::Tensor> fetch_tensors;
+  status->status = session->session->RunCallable(handle, feed_tensors,
+                                                 &fetch_tensors, nullptr);
+  if (TF_GetCode(status) != TF_OK) return;
+
+  if (fetch_tensors.size() != static_cast<size_t>(nfetches)) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Expected ", nfetches, " fetch tensors from the callable but got ",
+        fetch_tensors.size());
+    return;
+  }
+  // TF_TensorFromTensor likewise aliases the output buffers for all dtypes
+  // except TF_STRING.
+  for (int i = 0; i < nfetches; ++i) {
+    fetch_values[i] = tensorflow::TF_TensorFromTensor(fetch_tensors[i], status);
+    if (TF_GetCode(status) != TF_OK) {
+      for (int j = 0; j < i; ++j) {
+        TF_DeleteTensor(fetch_values[j]);
+        fetch_values[j] = nullptr;
+      }
+      return;
+    }
+  }
+}
+
+void TF_SessionReleaseCallable(TF_Session* session, int64_t handle,
+                               TF_Status* status) {
+  status->status = session->session->ReleaseCallable(handle);
+}
+
 TF_Buffer* TFE_GetServerDef(const char* text_proto, TF_Status* status) {
   tensorflow::ServerDef server_def;
   if (!tensorflow::protobuf::TextFormat::ParseFromString(text_proto,
@@ -121,6 +121,41 @@ TF_CAPI_EXPORT extern void TF_EnqueueNamedTensor(TF_Session* session,
                                                  int tensor_id,
                                                  TF_Tensor* tensor,
                                                  TF_Status* status);
+
+// On success, returns a handle to a pre-registered subgraph of `session` that
+// feeds the tensors `feeds[0..nfeeds)` and fetches `fetches[0..nfetches)`,
+// like `Session::MakeCallable()`.  The name resolution and per-call string
+// vectors that TF_SessionRun() performs on every call happen once, here.
+//
+// The handle stays valid until released or the session is closed.
+TF_CAPI_EXPORT extern void TF_SessionMakeCallable(
+    TF_Session* session, const TF_Output* feeds, int nfeeds,
+    const TF_Output* fetches, int nfetches, int64_t* out_handle,
+    TF_Status* status);
+
+// Runs the subgraph registered with `handle`, feeding `feed_values[0..nfeeds)`
+// and fetching into `fetch_values[0..nfetches)`; `nfeeds` and `nfetches` must
+// match the binding the handle was created with.
+//
+// Unlike TF_SessionRun(), the feed tensors' buffers are borrowed rather than
+// copied (except for TF_STRING, which needs conversion), so the caller must
+// not mutate them until this call returns.  On success the caller takes
+// ownership of the returned fetch tensors, which alias the session's output
+// buffers; on failure no fetch tensors are returned.
+TF_CAPI_EXPORT extern void TF_SessionRunCallable(TF_Session* session,
+                                                 int64_t handle,
+                                                 TF_Tensor* const* feed_values,
+                                                 int nfeeds,
+                                                 TF_Tensor** fetch_values,
+                                                 int nfetches,
+                                                 TF_Status* status);
+
+// Releases the resources associated with a handle created by
+// TF_SessionMakeCallable().
+TF_CAPI_EXPORT extern void TF_SessionReleaseCallable(TF_Session* session,
+                                                     int64_t handle,
+                                                     TF_Status* status);
+
 // Create a serialized tensorflow.ServerDef proto.
 TF_Buffer* TFE_GetServerDef(const char* text_proto, TF_Status* status);
 
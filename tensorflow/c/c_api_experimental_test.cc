@@ -82,6 +82,49 @@ TEST(CAPI_EXPERIMENTAL, IsStateful) {
   EXPECT_EQ(id, 0);
 }
 
+TEST(CAPI_EXPERIMENTAL, SessionCallable) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* neg = Neg(feed, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* session = TF_NewSession(graph, opts, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSessionOptions(opts);
+
+  TF_Output feeds[] = {TF_Output{feed, 0}};
+  TF_Output fetches[] = {TF_Output{neg, 0}};
+  int64_t handle = -1;
+  TF_SessionMakeCallable(session, feeds, 1, fetches, 1, &handle, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // The same handle can be run repeatedly with different feed buffers.
+  for (int32_t v : {3, -7}) {
+    TF_Tensor* feed_value = Int32Tensor(v);
+    TF_Tensor* fetch_value = nullptr;
+    TF_SessionRunCallable(session, handle, &feed_value, 1, &fetch_value, 1, s);
+    ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+    ASSERT_EQ(TF_INT32, TF_TensorType(fetch_value));
+    EXPECT_EQ(-v, *static_cast<int32_t*>(TF_TensorData(fetch_value)));
+    TF_DeleteTensor(fetch_value);
+    TF_DeleteTensor(feed_value);
+  }
+
+  TF_SessionReleaseCallable(session, handle, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_CloseSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI_EXPERIMENTAL, TFE_ExecuteOpInNewThreadTest_Simple) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
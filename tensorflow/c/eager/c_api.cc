@@ -438,6 +438,52 @@ TFE_TensorHandle* TFE_NewTensorHandle(TF_Tensor* t, TF_Status* status) {
   return new TFE_TensorHandle(tensor, nullptr, nullptr);
 }
 
+TFE_TensorHandle* TFE_NewTensorHandleFromHostBuffer(
+    TF_DataType dtype, const int64_t* dims, int num_dims, void* data,
+    size_t len, void (*deallocator)(void* data, size_t len, void* arg),
+    void* deallocator_arg, TF_Status* status) {
+  const tensorflow::DataType cc_dtype =
+      static_cast<tensorflow::DataType>(dtype);
+  if (!tensorflow::DataTypeCanUseMemcpy(cc_dtype)) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Cannot borrow caller-owned memory for tensors of type ",
+        tensorflow::DataTypeString(cc_dtype));
+    return nullptr;
+  }
+  if (reinterpret_cast<intptr_t>(data) %
+          std::max(1, EIGEN_MAX_ALIGN_BYTES) !=
+      0) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Caller-owned memory must be aligned to ", EIGEN_MAX_ALIGN_BYTES,
+        " bytes to be borrowed without a copy");
+    return nullptr;
+  }
+  std::vector<tensorflow::int64> dimvec(num_dims);
+  for (int i = 0; i < num_dims; ++i) {
+    dimvec[i] = static_cast<tensorflow::int64>(dims[i]);
+  }
+  tensorflow::TensorShape shape;
+  status->status = tensorflow::TensorShapeUtils::MakeShape(dimvec, &shape);
+  if (!status->status.ok()) return nullptr;
+  const size_t expected_len =
+      shape.num_elements() * tensorflow::DataTypeSize(cc_dtype);
+  if (len < expected_len) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Buffer of ", len, " bytes is too short to hold a ",
+        shape.DebugString(), " tensor of type ",
+        tensorflow::DataTypeString(cc_dtype), " (", expected_len, " bytes)");
+    return nullptr;
+  }
+  // The checks above guarantee that TF_NewTensor adopts `data` instead of
+  // taking its internal copying fallback, so the handle's tensor shares the
+  // caller's buffer and `deallocator` runs when the last reference drops.
+  TF_Tensor* t = TF_NewTensor(dtype, dims, num_dims, data, len, deallocator,
+                              deallocator_arg);
+  TFE_TensorHandle* ret = TFE_NewTensorHandle(t, status);
+  TF_DeleteTensor(t);
+  return ret;
+}
+
 void TFE_DeleteTensorHandle(TFE_TensorHandle* h) {
   if (h == nullptr) return;
   VLOG(1) << "Deleting tensor handle " << h << " with internal handle "
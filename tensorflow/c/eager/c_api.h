@@ -158,6 +158,23 @@ typedef struct TFE_TensorHandle TFE_TensorHandle;
 
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_NewTensorHandle(TF_Tensor* t,
                                                             TF_Status* status);
+
+// Creates a tensor handle on the host that borrows `data` without copying.
+// `data` points to caller-owned memory of `len` bytes holding the tensor
+// contents; `deallocator` is called with (`data`, `len`, `deallocator_arg`)
+// once the runtime no longer references the memory.  Until then the caller
+// must keep the memory valid and unmodified.
+//
+// Unlike TF_NewTensor, misaligned memory is rejected rather than silently
+// copied: for numeric dtypes `data` must be aligned the way TensorFlow's CPU
+// allocator aligns tensor buffers (EIGEN_MAX_ALIGN_BYTES; NumPy's default
+// allocator satisfies this).  TF_STRING and TF_RESOURCE tensors cannot be
+// borrowed.  On failure, returns nullptr, sets `status`, and does not call
+// `deallocator`.
+TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_NewTensorHandleFromHostBuffer(
+    TF_DataType dtype, const int64_t* dims, int num_dims, void* data,
+    size_t len, void (*deallocator)(void* data, size_t len, void* arg),
+    void* deallocator_arg, TF_Status* status);
 // Indicates that the caller will not be using `h` any more.
 TF_CAPI_EXPORT extern void TFE_DeleteTensorHandle(TFE_TensorHandle* h);
 TF_CAPI_EXPORT extern TF_DataType TFE_TensorHandleDataType(TFE_TensorHandle* h);
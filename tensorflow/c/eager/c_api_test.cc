@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/strings/match.h"
 #include "tensorflow/c/eager/c_api_test_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -88,6 +89,56 @@ void BM_Execute(int iters, int async) {
 }
 BENCHMARK(BM_Execute)->Arg(0)->Arg(1);
 
+TEST(CAPI, TensorHandleFromHostBuffer) {
+  TF_Status* status = TF_NewStatus();
+  const int64_t dims[] = {2, 2};
+  const size_t len = 4 * sizeof(float);
+  float* data = reinterpret_cast<float*>(
+      tensorflow::cpu_allocator()->AllocateRaw(EIGEN_MAX_ALIGN_BYTES, len));
+  for (int i = 0; i < 4; ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  bool deallocated = false;
+  TFE_TensorHandle* h = TFE_NewTensorHandleFromHostBuffer(
+      TF_FLOAT, &dims[0], 2, data, len,
+      [](void* buffer, size_t, void* arg) {
+        tensorflow::cpu_allocator()->DeallocateRaw(buffer);
+        *static_cast<bool*>(arg) = true;
+      },
+      &deallocated, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  // The handle borrows the caller's buffer instead of copying it.
+  TF_Tensor* t = TFE_TensorHandleResolve(h, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(data, TF_TensorData(t));
+  TF_DeleteTensor(t);
+  EXPECT_FALSE(deallocated);
+
+  // The deallocator runs once the last reference is gone.
+  TFE_DeleteTensorHandle(h);
+  EXPECT_TRUE(deallocated);
+  TF_DeleteStatus(status);
+}
+
+TEST(CAPI, TensorHandleFromHostBufferMisaligned) {
+  TF_Status* status = TF_NewStatus();
+  const int64_t dims[] = {2};
+  char* data = new char[2 * sizeof(float) + 1];
+  // Misaligned memory is rejected rather than silently copied, and the
+  // deallocator is not called.
+  bool deallocated = false;
+  TFE_TensorHandle* h = TFE_NewTensorHandleFromHostBuffer(
+      TF_FLOAT, &dims[0], 1, data + 1, 2 * sizeof(float),
+      [](void*, size_t, void* arg) { *static_cast<bool*>(arg) = true; },
+      &deallocated, status);
+  EXPECT_EQ(h, nullptr);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  EXPECT_FALSE(deallocated);
+  delete[] data;
+  TF_DeleteStatus(status);
+}
+
 TEST(CAPI, Context) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
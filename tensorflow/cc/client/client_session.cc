@@ -141,6 +141,15 @@ Status ClientSession::RunCallable(CallableHandle handle,
                                        run_metadata);
 }
 
+void ClientSession::RunCallableAsync(CallableHandle handle,
+                                     const std::vector<Tensor>& feed_tensors,
+                                     std::vector<Tensor>* fetch_tensors,
+                                     RunMetadata* run_metadata,
+                                     StatusCallback done) {
+  impl()->session_->RunCallableAsync(handle, feed_tensors, fetch_tensors,
+                                     run_metadata, std::move(done));
+}
+
 Status ClientSession::ReleaseCallable(CallableHandle handle) {
   return impl()->session_->ReleaseCallable(handle);
 }
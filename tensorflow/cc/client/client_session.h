@@ -110,6 +110,20 @@ class ClientSession {
                      std::vector<Tensor>* fetch_tensors,
                      RunMetadata* run_metadata);
 
+  /// \brief Invokes the subgraph named by `handle` without blocking the
+  /// caller; `done` is invoked with the step's status once execution
+  /// finishes.
+  ///
+  /// The caller must keep `fetch_tensors` and `run_metadata` alive until
+  /// `done` has been invoked. Multiple invocations may be in flight at once,
+  /// so independent requests can be pipelined through one session without a
+  /// thread per call.
+  /// NOTE: This API is still experimental and may change.
+  void RunCallableAsync(CallableHandle handle,
+                        const std::vector<Tensor>& feed_tensors,
+                        std::vector<Tensor>* fetch_tensors,
+                        RunMetadata* run_metadata, StatusCallback done);
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
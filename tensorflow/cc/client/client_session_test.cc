@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/cc/client/client_session.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/test.h"
@@ -116,5 +117,41 @@ TEST(ClientSessionTest, Callable) {
   TF_EXPECT_OK(session.ReleaseCallable(callable));
 }
 
+TEST(ClientSessionTest, CallableAsync) {
+  Scope root = Scope::NewRootScope();
+  auto a = Placeholder(root, DT_INT32);
+  auto b = Placeholder(root, DT_INT32);
+  auto c = Add(root, a, b);
+  ClientSession session(root);
+
+  CallableOptions options;
+  options.add_feed(a.node()->name());
+  options.add_feed(b.node()->name());
+  options.add_fetch(c.node()->name());
+  ClientSession::CallableHandle callable;
+  TF_CHECK_OK(session.MakeCallable(options, &callable));
+
+  // Two in-flight invocations of the same callable, completing out of band.
+  const int kNumCalls = 2;
+  std::vector<std::vector<Tensor>> outputs(kNumCalls);
+  Status statuses[kNumCalls];
+  Notification done[kNumCalls];
+  for (int i = 0; i < kNumCalls; ++i) {
+    session.RunCallableAsync(
+        callable,
+        {test::AsTensor<int>({i}, {}), test::AsTensor<int>({42 - i}, {})},
+        &outputs[i], nullptr, [&, i](const Status& s) {
+          statuses[i] = s;
+          done[i].Notify();
+        });
+  }
+  for (int i = 0; i < kNumCalls; ++i) {
+    done[i].WaitForNotification();
+    TF_EXPECT_OK(statuses[i]);
+    test::ExpectTensorEqual<int>(outputs[i][0], test::AsTensor<int>({42}, {}));
+  }
+  TF_EXPECT_OK(session.ReleaseCallable(callable));
+}
+
 }  // namespace
 }  // namespace tensorflow
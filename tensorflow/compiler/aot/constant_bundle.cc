@@ -0,0 +1,70 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/constant_bundle.h"
+
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+/* static */ Status ConstantBundle::Load(const string& prefix,
+                                         std::unique_ptr<ConstantBundle>* out) {
+  BundleReader reader(Env::Default(), prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+
+  auto bundle = absl::WrapUnique(new ConstantBundle);
+  for (reader.Seek(kHeaderEntryKey), reader.Next(); reader.Valid();
+       reader.Next()) {
+    absl::string_view key(reader.key().data(), reader.key().size());
+    int arg_index;
+    if (!absl::ConsumePrefix(&key, "arg_") ||
+        !absl::SimpleAtoi(key, &arg_index)) {
+      return errors::InvalidArgument(
+          "Constant bundle at ", prefix, " contains unexpected key \"",
+          absl::string_view(reader.key().data(), reader.key().size()), "\"");
+    }
+    Tensor tensor;
+    TF_RETURN_IF_ERROR(reader.ReadCurrent(&tensor));
+    bundle->args_.emplace_back(arg_index, std::move(tensor));
+  }
+  TF_RETURN_IF_ERROR(reader.status());
+  *out = std::move(bundle);
+  return Status::OK();
+}
+
+Status ConstantBundle::BindTo(XlaCompiledCpuFunction* function) const {
+  for (const auto& index_and_tensor : args_) {
+    const int arg_index = index_and_tensor.first;
+    if (arg_index < 0 || arg_index >= function->num_args()) {
+      return errors::InvalidArgument(
+          "Constant bundle binds arg ", arg_index, " but the function has ",
+          function->num_args(),
+          " args; the bundle was likely produced for a different graph");
+    }
+    function->set_arg_data(arg_index,
+                           index_and_tensor.second.tensor_data().data());
+  }
+  return Status::OK();
+}
+
+}  // namespace tfcompile
+}  // namespace tensorflow
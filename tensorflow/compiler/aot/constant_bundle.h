@@ -0,0 +1,65 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_AOT_CONSTANT_BUNDLE_H_
+#define TENSORFLOW_COMPILER_AOT_CONSTANT_BUNDLE_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+// Holds the weights that tfcompile stripped out of a generated function with
+// --out_constant_bundle, and binds them to the function's argument buffers at
+// runtime.  Typical usage:
+//
+//   std::unique_ptr<ConstantBundle> constants;
+//   TF_CHECK_OK(ConstantBundle::Load("/path/to/weights", &constants));
+//   MyComputation computation(
+//       MyComputation::AllocMode::RESULTS_PROFILES_AND_TEMPS_ONLY);
+//   TF_CHECK_OK(constants->BindTo(&computation));
+//   ... set the remaining (true feed) args, then computation.Run() ...
+//
+// The bundle must outlive every function it is bound to: BindTo points the
+// function's argument buffers directly at the loaded tensors without copying.
+class ConstantBundle {
+ public:
+  // Loads all stripped constants from the bundle written to `prefix` by
+  // tfcompile.
+  static Status Load(const string& prefix,
+                     std::unique_ptr<ConstantBundle>* out);
+
+  // Sets the argument buffer of `function` for every argument present in the
+  // bundle.  Tensor buffers are EIGEN_MAX_ALIGN_BYTES aligned, which satisfies
+  // the alignment XLA requires of entry parameters.
+  Status BindTo(XlaCompiledCpuFunction* function) const;
+
+ private:
+  ConstantBundle() = default;
+
+  // Pairs of (generated argument index, constant value).
+  std::vector<std::pair<int, Tensor>> args_;
+};
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_CONSTANT_BUNDLE_H_
@@ -68,6 +68,18 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "function."},
       {"out_session_module", &flags->out_session_module,
        "Output session module proto."},
+      {"out_constant_bundle", &flags->out_constant_bundle,
+       "Output TensorBundle prefix for stripped constants.  If set, large "
+       "constants are compiled as extra arguments of the generated function "
+       "instead of being baked into the object file, and their values are "
+       "written to a bundle at this prefix.  At runtime, load the bundle with "
+       "tfcompile::ConstantBundle and bind it to the generated function "
+       "before calling Run."},
+      {"minimum_stripped_constant_bytes",
+       &flags->minimum_stripped_constant_bytes,
+       "Constants smaller than this many bytes are never stripped to the "
+       "constant bundle; small shape-like constants typically must remain "
+       "compile-time constants for XLA shape inference."},
       {"gen_name_to_index", &flags->gen_name_to_index,
        "Generate name-to-index data for Lookup{Arg,Result}Index methods."},
       {"gen_program_shape", &flags->gen_program_shape,
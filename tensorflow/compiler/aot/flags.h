@@ -38,6 +38,8 @@ struct MainFlags {
   string out_metadata_object;
   string out_header;
   string out_session_module;
+  string out_constant_bundle;
+  int64 minimum_stripped_constant_bytes = 1024;
 
   // C++ codegen options
   bool gen_name_to_index = false;
@@ -0,0 +1,118 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/strip_constants.h"
+
+#include <map>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+namespace {
+
+// Rewrites a node name into a valid C++ identifier for the generated feed
+// accessors.
+string SanitizedFeedName(const string& node_name) {
+  string name = "constant_";
+  for (char c : node_name) {
+    const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                    (c >= '0' && c <= '9');
+    name += ok ? c : '_';
+  }
+  return name;
+}
+
+}  // namespace
+
+string StrippedConstantKey(int arg_index) {
+  return absl::StrCat("arg_", arg_index);
+}
+
+Status StripConstantsToBundle(const MainFlags& flags, GraphDef* graph_def,
+                              tf2xla::Config* config) {
+  if (flags.out_constant_bundle.empty()) {
+    return Status::OK();
+  }
+
+  absl::flat_hash_set<string> fed_nodes;
+  absl::flat_hash_set<string> feed_names;
+  for (const tf2xla::Feed& feed : config->feed()) {
+    fed_nodes.insert(feed.id().node_name());
+    feed_names.insert(feed.name());
+  }
+
+  // std::map keeps the dump below deterministic across runs; BundleWriter
+  // itself accepts keys in any order.
+  std::map<string, Tensor> stripped;
+  for (const NodeDef& node : graph_def->node()) {
+    if (node.op() != "Const" || fed_nodes.contains(node.name())) {
+      continue;
+    }
+    auto value_it = node.attr().find("value");
+    if (value_it == node.attr().end()) {
+      continue;
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(value_it->second.tensor())) {
+      return errors::InvalidArgument("Malformed Const value on node ",
+                                     node.name());
+    }
+    if (!DataTypeCanUseMemcpy(tensor.dtype()) ||
+        static_cast<int64>(tensor.TotalBytes()) <
+            flags.minimum_stripped_constant_bytes) {
+      continue;
+    }
+
+    // Feeds are compiled as entry parameters in config order, so the index of
+    // the new feed is the index of the generated argument it becomes.
+    const int arg_index = config->feed_size();
+    tf2xla::Feed* feed = config->add_feed();
+    feed->mutable_id()->set_node_name(node.name());
+    feed->mutable_id()->set_output_index(0);
+    tensor.shape().AsProto(feed->mutable_shape());
+    string feed_name = SanitizedFeedName(node.name());
+    if (!feed_names.insert(feed_name).second) {
+      // Distinct node names can sanitize to the same identifier.
+      feed_name = absl::StrCat(feed_name, "_", arg_index);
+      feed_names.insert(feed_name);
+    }
+    feed->set_name(feed_name);
+    stripped[StrippedConstantKey(arg_index)] = std::move(tensor);
+    VLOG(1) << "Stripping constant " << node.name() << " ("
+            << stripped[StrippedConstantKey(arg_index)].TotalBytes()
+            << " bytes) to bundle arg " << arg_index;
+  }
+
+  BundleWriter writer(Env::Default(), flags.out_constant_bundle);
+  for (const auto& key_and_tensor : stripped) {
+    TF_RETURN_IF_ERROR(writer.Add(key_and_tensor.first, key_and_tensor.second));
+  }
+  return writer.Finish();
+}
+
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_AOT_STRIP_CONSTANTS_H_
+#define TENSORFLOW_COMPILER_AOT_STRIP_CONSTANTS_H_
+
+#include "tensorflow/compiler/aot/flags.h"
+#include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+// Key under which the value of the stripped constant feeding generated
+// argument `arg_index` is stored in the constant bundle.
+string StrippedConstantKey(int arg_index);
+
+// Turns large Const nodes in graph_def into extra feeds of config, and writes
+// their values to a TensorBundle at the flags.out_constant_bundle prefix.
+//
+// Each stripped constant becomes one more argument of the generated function
+// (feeds are compiled as entry parameters), so the weights are no longer baked
+// into the emitted object file; callers load the bundle at runtime and bind
+// the buffers with ConstantBundle before invoking the computation.  Constants
+// smaller than flags.minimum_stripped_constant_bytes, constants with
+// non-POD element types, and constants that are already fed are left in the
+// graph untouched: small shape-like constants typically must stay
+// compile-time constant for XLA to infer static shapes.
+Status StripConstantsToBundle(const MainFlags& flags, GraphDef* graph_def,
+                              tf2xla::Config* config);
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_STRIP_CONSTANTS_H_
@@ -0,0 +1,100 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/strip_constants.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+void AddConstNode(GraphDef* graph_def, const string& name,
+                  const Tensor& value) {
+  NodeDef* node = graph_def->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  (*node->mutable_attr())["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent(
+      (*node->mutable_attr())["value"].mutable_tensor());
+}
+
+TEST(StripConstantsTest, StripsLargeConstantsOnly) {
+  GraphDef graph_def;
+  Tensor small(DT_INT32, TensorShape({2}));
+  test::FillValues<int32>(&small, {2, 3});
+  AddConstNode(&graph_def, "shape", small);
+  Tensor large(DT_FLOAT, TensorShape({64, 64}));
+  large.flat<float>().setConstant(0.5f);
+  AddConstNode(&graph_def, "weights/kernel", large);
+
+  tf2xla::Config config;
+  tf2xla::Feed* feed = config.add_feed();
+  feed->mutable_id()->set_node_name("x");
+  feed->set_name("x");
+
+  MainFlags flags;
+  flags.out_constant_bundle =
+      io::JoinPath(testing::TmpDir(), "constant_bundle");
+  TF_ASSERT_OK(StripConstantsToBundle(flags, &graph_def, &config));
+
+  // The small shape constant stays put; the large weight becomes feed 1.
+  ASSERT_EQ(config.feed_size(), 2);
+  const tf2xla::Feed& stripped = config.feed(1);
+  EXPECT_EQ(stripped.id().node_name(), "weights/kernel");
+  EXPECT_EQ(stripped.name(), "constant_weights_kernel");
+  EXPECT_EQ(TensorShape(stripped.shape()), TensorShape({64, 64}));
+
+  BundleReader reader(Env::Default(), flags.out_constant_bundle);
+  TF_ASSERT_OK(reader.status());
+  EXPECT_FALSE(reader.Contains(StrippedConstantKey(0)));
+  Tensor value;
+  TF_ASSERT_OK(reader.Lookup(StrippedConstantKey(1), &value));
+  test::ExpectTensorEqual<float>(value, large);
+}
+
+TEST(StripConstantsTest, SkipsAlreadyFedConstants) {
+  GraphDef graph_def;
+  Tensor large(DT_FLOAT, TensorShape({64, 64}));
+  large.flat<float>().setZero();
+  AddConstNode(&graph_def, "weights", large);
+
+  tf2xla::Config config;
+  tf2xla::Feed* feed = config.add_feed();
+  feed->mutable_id()->set_node_name("weights");
+  feed->set_name("weights");
+
+  MainFlags flags;
+  flags.out_constant_bundle =
+      io::JoinPath(testing::TmpDir(), "constant_bundle_fed");
+  TF_ASSERT_OK(StripConstantsToBundle(flags, &graph_def, &config));
+
+  EXPECT_EQ(config.feed_size(), 1);
+  BundleReader reader(Env::Default(), flags.out_constant_bundle);
+  TF_ASSERT_OK(reader.status());
+  EXPECT_FALSE(reader.Contains(StrippedConstantKey(0)));
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/aot/codegen.h"
 #include "tensorflow/compiler/aot/compile.h"
 #include "tensorflow/compiler/aot/flags.h"
+#include "tensorflow/compiler/aot/strip_constants.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
 #include "tensorflow/compiler/tf2xla/tf2xla_util.h"
 #include "tensorflow/compiler/xla/debug_options_flags.h"
@@ -86,6 +87,7 @@ Status Main(const MainFlags& flags) {
   }
   GraphDef graph_def;
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.graph, &graph_def));
+  TF_RETURN_IF_ERROR(StripConstantsToBundle(flags, &graph_def, &config));
   CompileResult compile_result;
   TF_RETURN_IF_ERROR(CompileGraph(graph_def, config, flags, &compile_result));
 
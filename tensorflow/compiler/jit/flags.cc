@@ -29,6 +29,7 @@ BuildXlaOpsPassFlags* build_ops_flags;
 MarkForCompilationPassFlags* mark_for_compilation_flags;
 XlaDeviceFlags* device_flags;
 XlaOpsCommonFlags* ops_flags;
+ShapeBucketingPassFlags* shape_bucketing_flags;
 IntroduceFloatingPointJitterPassFlags* jitter_flags;
 
 std::vector<Flag>* flag_list;
@@ -116,6 +117,10 @@ void AllocateAndParseFlags() {
 
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
+  ops_flags->tf_xla_async_compilation = false;
+
+  shape_bucketing_flags = new ShapeBucketingPassFlags;
+  shape_bucketing_flags->tf_xla_shape_bucket_sizes = "";
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -139,6 +144,16 @@ void AllocateAndParseFlags() {
 
        Flag("tf_xla_always_defer_compilation",
             &ops_flags->tf_xla_always_defer_compilation, ""),
+       Flag("tf_xla_async_compilation", &ops_flags->tf_xla_async_compilation,
+            "If true then compile XLA clusters on a background thread pool, "
+            "running the original TensorFlow function until the compiled "
+            "executable is ready."),
+
+       Flag("tf_xla_shape_bucket_sizes",
+            &shape_bucketing_flags->tf_xla_shape_bucket_sizes,
+            "Comma-separated, strictly increasing list of sizes the leading "
+            "dimension of XLA cluster inputs is padded up to; empty disables "
+            "shape bucketing.  Requires clusters to be padding tolerant."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
@@ -175,6 +190,11 @@ const XlaOpsCommonFlags& GetXlaOpsCommonFlags() {
   return *ops_flags;
 }
 
+const ShapeBucketingPassFlags& GetShapeBucketingPassFlags() {
+  std::call_once(flags_init, &AllocateAndParseFlags);
+  return *shape_bucketing_flags;
+}
+
 const IntroduceFloatingPointJitterPassFlags&
 GetIntroduceFloatingPointJitterPassFlags() {
   std::call_once(flags_init, &AllocateAndParseFlags);
@@ -79,6 +79,13 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile always refuses to compile the cluster, which means the
   // XLA clusters always run in the TF executor.  Defaults to false.
   bool tf_xla_always_defer_compilation;
+
+  // If true, _XlaCompile compiles clusters on a background thread pool and,
+  // while a compilation is in progress, reports the cluster as uncompiled so
+  // it runs in the TF executor; once the background compilation finishes,
+  // subsequent steps switch to the XLA executable.  Ignored for clusters with
+  // must_compile=true.  Defaults to false.
+  bool tf_xla_async_compilation;
 };
 
 // Flags for the build_xla_ops pass.
@@ -92,6 +99,15 @@ struct BuildXlaOpsPassFlags {
   bool tf_xla_print_cluster_outputs;
 };
 
+// Flags for the shape bucketing pass.
+struct ShapeBucketingPassFlags {
+  // Comma-separated, strictly increasing list of sizes the leading dimension
+  // of XLA cluster inputs is padded up to (e.g. "8,16,32,64").  Empty
+  // disables the pass.  See shape_bucketing_pass.h for the assumptions
+  // enabling this makes about the clusters in the graph.
+  string tf_xla_shape_bucket_sizes;
+};
+
 // Flags for the IntroduceFloatingPointJitter pass.
 struct IntroduceFloatingPointJitterPassFlags {
   // The amount of jitter to introduce.  This amount is added to each element in
@@ -114,6 +130,7 @@ MarkForCompilationPassFlags* GetMarkForCompilationPassFlags();
 const BuildXlaOpsPassFlags& GetBuildXlaOpsPassFlags();
 XlaDeviceFlags* GetXlaDeviceFlags();
 const XlaOpsCommonFlags& GetXlaOpsCommonFlags();
+const ShapeBucketingPassFlags& GetShapeBucketingPassFlags();
 
 const IntroduceFloatingPointJitterPassFlags&
 GetIntroduceFloatingPointJitterPassFlags();
@@ -0,0 +1,151 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Kernels for the _XlaPadToBucket and _XlaSliceToSize ops inserted by the
+// shape bucketing pass (see shape_bucketing_pass.h).  Both ops only touch
+// the leading dimension, so padding is a contiguous copy followed by a zero
+// fill and slicing is a buffer-sharing prefix view.
+
+#define EIGEN_USE_THREADS
+#if GOOGLE_CUDA
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA
+
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+int64 NextBucketSize(int64 size, const std::vector<int64>& bucket_sizes) {
+  for (int64 bucket : bucket_sizes) {
+    if (bucket >= size) {
+      return bucket;
+    }
+  }
+  // Beyond the largest bucket, round up to the next multiple of it.
+  const int64 largest = bucket_sizes.back();
+  return (size + largest - 1) / largest * largest;
+}
+
+template <typename Device>
+class PadToBucketOp : public OpKernel {
+ public:
+  explicit PadToBucketOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("bucket_sizes", &bucket_sizes_));
+    OP_REQUIRES(ctx, !bucket_sizes_.empty(),
+                errors::InvalidArgument("bucket_sizes must be non-empty"));
+    for (int i = 0; i < bucket_sizes_.size(); ++i) {
+      OP_REQUIRES(
+          ctx,
+          bucket_sizes_[i] > 0 &&
+              (i == 0 || bucket_sizes_[i] > bucket_sizes_[i - 1]),
+          errors::InvalidArgument("bucket_sizes must be positive and strictly "
+                                  "increasing"));
+    }
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& input = ctx->input(0);
+    Tensor* true_size = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({}), &true_size));
+
+    // Tensors without a paddable leading dimension pass through unchanged;
+    // true_size = -1 tells _XlaSliceToSize to ignore this input.
+    if (input.dims() == 0 || !DataTypeCanUseMemcpy(input.dtype())) {
+      true_size->scalar<int32>()() = -1;
+      ctx->set_output(0, input);
+      return;
+    }
+
+    const int64 size = input.dim_size(0);
+    true_size->scalar<int32>()() = static_cast<int32>(size);
+    const int64 bucketed = NextBucketSize(size, bucket_sizes_);
+    if (bucketed == size) {
+      ctx->set_output(0, input);
+      return;
+    }
+
+    TensorShape padded_shape = input.shape();
+    padded_shape.set_dim(0, bucketed);
+    Tensor* padded = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, padded_shape, &padded));
+
+    // Leading-dimension padding keeps the original bytes contiguous: copy
+    // them and zero-fill the tail.
+    const StringPiece in_data = input.tensor_data();
+    char* out_data = const_cast<char*>(padded->tensor_data().data());
+    const Device& d = ctx->eigen_device<Device>();
+    if (!in_data.empty()) {
+      d.memcpy(out_data, in_data.data(), in_data.size());
+    }
+    d.memset(out_data + in_data.size(), 0,
+             padded->TotalBytes() - in_data.size());
+  }
+
+ private:
+  std::vector<int64> bucket_sizes_;
+};
+
+class SliceToSizeOp : public OpKernel {
+ public:
+  explicit SliceToSizeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& input = ctx->input(0);
+    OpInputList true_sizes;
+    OP_REQUIRES_OK(ctx, ctx->input_list("true_sizes", &true_sizes));
+    int32 true_size = -1;
+    for (const Tensor& t : true_sizes) {
+      if (t.scalar<int32>()() >= 0) {
+        true_size = t.scalar<int32>()();
+        break;
+      }
+    }
+    if (true_size < 0 || input.dims() == 0 ||
+        true_size >= input.dim_size(0)) {
+      ctx->set_output(0, input);
+      return;
+    }
+    // A leading-dimension prefix shares the input buffer; no copy.
+    ctx->set_output(0, input.Slice(0, true_size));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("_XlaPadToBucket").Device(DEVICE_CPU).HostMemory("true_size"),
+    PadToBucketOp<CPUDevice>);
+REGISTER_KERNEL_BUILDER(Name("_XlaSliceToSize").Device(DEVICE_CPU),
+                        SliceToSizeOp);
+
+#if GOOGLE_CUDA
+REGISTER_KERNEL_BUILDER(
+    Name("_XlaPadToBucket").Device(DEVICE_GPU).HostMemory("true_size"),
+    PadToBucketOp<GPUDevice>);
+REGISTER_KERNEL_BUILDER(
+    Name("_XlaSliceToSize").Device(DEVICE_GPU).HostMemory("true_sizes"),
+    SliceToSizeOp);
+#endif  // GOOGLE_CUDA
+
+}  // namespace
+}  // namespace tensorflow
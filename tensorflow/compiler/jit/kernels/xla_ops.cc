@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -251,13 +252,22 @@ static Status BuildCompilationCache(OpKernelContext* ctx,
   return Status::OK();
 }
 
-static Status CompileToLocalExecutable(
-    OpKernelContext* ctx, const NameAttrList& function,
-    const XlaPlatformInfo& platform_info, absl::Span<const int> resources,
-    absl::Span<const int> constants, bool lazy, xla::LocalClient** client,
-    std::map<int, OptionalTensor>* variables,
-    const XlaCompiler::CompilationResult** kernel,
-    xla::LocalExecutable** executable) {
+// Everything XlaCompilationCache::Compile needs, assembled on the op's
+// thread.  Compiling from this state does not touch the OpKernelContext, so
+// it may also run on a background thread (see AsyncCompilationScheduler).
+struct ClusterCompilationInputs {
+  XlaCompilationCache* cache = nullptr;  // The caller holds a reference.
+  XlaCompiler::Options options;
+  XlaCompiler::CompileOptions compile_options;
+  std::vector<XlaCompiler::Argument> args;
+};
+
+static Status PrepareClusterCompilation(OpKernelContext* ctx,
+                                        const XlaPlatformInfo& platform_info,
+                                        absl::Span<const int> resources,
+                                        absl::Span<const int> constants,
+                                        std::map<int, OptionalTensor>* variables,
+                                        ClusterCompilationInputs* inputs) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -265,27 +275,21 @@ static Status CompileToLocalExecutable(
     return errors::Internal("No resource manager.");
   }
 
-  XlaCompilationCache* cache;
   TF_RETURN_IF_ERROR(rm->LookupOrCreate<XlaCompilationCache>(
-      rm->default_container(), "xla_cache", &cache,
+      rm->default_container(), "xla_cache", &inputs->cache,
       [&](XlaCompilationCache** cache) {
         return BuildCompilationCache(ctx, platform_info, cache);
       }));
-  // Hold the reference to the JIT during evaluation. (We could probably
-  // free it sooner because the ResourceMgr will retain a reference, but
-  // this is more obviously correct.)
-  core::ScopedUnref cache_ref(cache);
 
   TF_RETURN_IF_ERROR(SnapshotResourceVariables(ctx, resources, variables));
-  *client = static_cast<xla::LocalClient*>(cache->client());
 
-  XlaCompiler::Options options;
-  options.client = *client;
+  XlaCompiler::Options& options = inputs->options;
+  options.client = static_cast<xla::LocalClient*>(inputs->cache->client());
   if (ctx->op_device_context() != nullptr) {
     options.device_ordinal =
         ctx->op_device_context()->stream()->parent()->device_ordinal();
   }
-  options.device_type = cache->device_type();
+  options.device_type = inputs->cache->device_type();
   options.flib_def = ctx->function_library()->GetFunctionLibraryDefinition();
   options.graph_def_version = ctx->function_library()->graph_def_version();
   options.allow_cpu_custom_calls =
@@ -300,7 +304,7 @@ static Status CompileToLocalExecutable(
   for (int i : constants) {
     constant_args.insert({i, ctx->input(i)});
   }
-  XlaCompiler::CompileOptions compile_options;
+  XlaCompiler::CompileOptions& compile_options = inputs->compile_options;
   compile_options.is_entry_computation = true;
   // If we resolve constants we never emit them on the device, meaning that if
   // they are needed by a following computation the host has to transfer
@@ -311,13 +315,141 @@ static Status CompileToLocalExecutable(
   // rather than a one-element tuple.
   compile_options.always_return_tuple = false;
 
-  std::vector<XlaCompiler::Argument> args;
-  TF_RETURN_IF_ERROR(XlaComputationLaunchContext::BuildXlaCompilerArguments(
-      constant_args, *variables, ctx, &args));
-  return cache->Compile(options, function, args, compile_options,
-                        lazy ? XlaCompilationCache::CompileMode::kLazy
-                             : XlaCompilationCache::CompileMode::kStrict,
-                        kernel, executable);
+  return XlaComputationLaunchContext::BuildXlaCompilerArguments(
+      constant_args, *variables, ctx, &inputs->args);
+}
+
+static Status CompileToLocalExecutable(
+    OpKernelContext* ctx, const NameAttrList& function,
+    const XlaPlatformInfo& platform_info, absl::Span<const int> resources,
+    absl::Span<const int> constants, bool lazy, xla::LocalClient** client,
+    std::map<int, OptionalTensor>* variables,
+    const XlaCompiler::CompilationResult** kernel,
+    xla::LocalExecutable** executable) {
+  ClusterCompilationInputs inputs;
+  TF_RETURN_IF_ERROR(PrepareClusterCompilation(ctx, platform_info, resources,
+                                               constants, variables, &inputs));
+  // Hold the reference to the JIT during evaluation. (We could probably
+  // free it sooner because the ResourceMgr will retain a reference, but
+  // this is more obviously correct.)
+  core::ScopedUnref cache_ref(inputs.cache);
+  *client = static_cast<xla::LocalClient*>(inputs.cache->client());
+
+  return inputs.cache->Compile(inputs.options, function, inputs.args,
+                               inputs.compile_options,
+                               lazy ? XlaCompilationCache::CompileMode::kLazy
+                                    : XlaCompilationCache::CompileMode::kStrict,
+                               kernel, executable);
+}
+
+namespace {
+
+// Runs cluster compilations on a background thread pool so that XlaCompileOp
+// can report the cluster as uncompiled (and hence run the cluster's original
+// TensorFlow function) while a compilation is in progress.  At most one
+// compilation per signature is in flight at a time; finished signatures are
+// remembered so later steps can consult the compilation cache without
+// blocking.  Enabled with --tf_xla_async_compilation.
+class AsyncCompilationScheduler {
+ public:
+  // Returns true if a background compilation for `signature` has finished,
+  // in which case a subsequent XlaCompilationCache::Compile will not block.
+  // Otherwise ensures a compilation of `function` is running in the
+  // background (scheduling one from `inputs` if necessary) and returns
+  // false.
+  bool EnsureCompiled(const string& signature, const NameAttrList& function,
+                      const ClusterCompilationInputs& inputs) {
+    {
+      mutex_lock l(mu_);
+      auto it = compilations_.find(signature);
+      if (it != compilations_.end()) {
+        return it->second == State::kDone;
+      }
+      compilations_.emplace(signature, State::kRunning);
+    }
+
+    // The background task cannot rely on the caller's cache reference; take
+    // one of its own.
+    inputs.cache->Ref();
+    auto state = std::make_shared<ClusterCompilationInputs>(inputs);
+    AsyncCompilationScheduler* scheduler = this;
+    pool_.Schedule([scheduler, signature, function, state] {
+      const XlaCompiler::CompilationResult* kernel;
+      xla::LocalExecutable* executable;
+      Status s = state->cache->Compile(
+          state->options, function, state->args, state->compile_options,
+          XlaCompilationCache::CompileMode::kStrict, &kernel, &executable);
+      if (!s.ok()) {
+        // The error is also recorded in the compilation cache entry; the
+        // next step's cache lookup surfaces it to the usual error handling.
+        LOG(WARNING) << "Asynchronous compilation of cluster "
+                     << function.name() << " failed: " << s;
+      }
+      state->cache->Unref();
+      mutex_lock l(scheduler->mu_);
+      scheduler->compilations_[signature] = State::kDone;
+    });
+    return false;
+  }
+
+  static AsyncCompilationScheduler* Global() {
+    static AsyncCompilationScheduler* instance = new AsyncCompilationScheduler;
+    return instance;
+  }
+
+ private:
+  enum class State { kRunning, kDone };
+
+  static constexpr int kNumCompilerThreads = 2;
+
+  AsyncCompilationScheduler()
+      : pool_(Env::Default(), "xla_async_compilation", kNumCompilerThreads) {}
+
+  thread::ThreadPool pool_;
+  mutex mu_;
+  absl::flat_hash_map<string, State> compilations_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncCompilationScheduler);
+};
+
+constexpr int AsyncCompilationScheduler::kNumCompilerThreads;
+
+}  // namespace
+
+// As CompileToLocalExecutable, but compiles on a background thread pool.
+// Until the background compilation has finished this returns a null
+// `executable` (leaving the caller to fall back to the cluster's original
+// TensorFlow function); afterwards it behaves like the strict synchronous
+// path, which is then a cache hit.
+static Status CompileClusterAsync(
+    OpKernelContext* ctx, const NameAttrList& function,
+    const XlaPlatformInfo& platform_info, absl::Span<const int> resources,
+    absl::Span<const int> constants, xla::LocalClient** client,
+    std::map<int, OptionalTensor>* variables,
+    const XlaCompiler::CompilationResult** kernel,
+    xla::LocalExecutable** executable) {
+  *kernel = nullptr;
+  *executable = nullptr;
+
+  ClusterCompilationInputs inputs;
+  TF_RETURN_IF_ERROR(PrepareClusterCompilation(ctx, platform_info, resources,
+                                               constants, variables, &inputs));
+  core::ScopedUnref cache_ref(inputs.cache);
+  *client = static_cast<xla::LocalClient*>(inputs.cache->client());
+
+  TF_ASSIGN_OR_RETURN(
+      XlaCompilationCache::Signature signature,
+      XlaCompilationCache::BuildSignature(function, inputs.args));
+  if (!AsyncCompilationScheduler::Global()->EnsureCompiled(
+          signature.HumanString(), function, inputs)) {
+    VLOG(2) << "Deferring to TF function call for cluster " << function.name()
+            << " while compilation is in progress";
+    return Status::OK();
+  }
+  return inputs.cache->Compile(inputs.options, function, inputs.args,
+                               inputs.compile_options,
+                               XlaCompilationCache::CompileMode::kStrict,
+                               kernel, executable);
 }
 
 void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
@@ -456,9 +588,19 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
       cannot_compile_cluster) {
     executable = nullptr;
   } else {
-    Status status = CompileToLocalExecutable(
-        ctx, function_, platform_info_, resources_, constants_,
-        /*lazy=*/!must_compile_, &client, &variables, &kernel, &executable);
+    // Clusters with must_compile=true may not fall back to the TF function
+    // call, so they always compile synchronously.
+    const bool async_compilation =
+        GetXlaOpsCommonFlags().tf_xla_async_compilation && !must_compile_;
+    Status status =
+        async_compilation
+            ? CompileClusterAsync(ctx, function_, platform_info_, resources_,
+                                  constants_, &client, &variables, &kernel,
+                                  &executable)
+            : CompileToLocalExecutable(ctx, function_, platform_info_,
+                                       resources_, constants_,
+                                       /*lazy=*/!must_compile_, &client,
+                                       &variables, &kernel, &executable);
     if (must_compile_ || status.code() != error::UNIMPLEMENTED) {
       OP_REQUIRES_OK(ctx, status);
     }
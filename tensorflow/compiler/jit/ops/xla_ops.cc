@@ -80,6 +80,59 @@ compilation_successful: If the `must_compile` attr is false the _XlaCompile op
    `compilation_successful` is always true.
 )");
 
+REGISTER_OP("_XlaPadToBucket")
+    .Input("input: T")
+    .Output("padded: T")
+    .Output("true_size: int32")
+    .Attr("T: type")
+    .Attr("bucket_sizes: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      shape_inference::ShapeHandle input = c->input(0);
+      if (!c->RankKnown(input) || c->Rank(input) == 0) {
+        c->set_output(0, input);
+      } else {
+        shape_inference::ShapeHandle padded;
+        TF_RETURN_IF_ERROR(c->ReplaceDim(input, 0, c->UnknownDim(), &padded));
+        c->set_output(0, padded);
+      }
+      c->set_output(1, c->Scalar());
+      return Status::OK();
+    })
+    .Doc(R"(Pads the leading dimension up to a bucket boundary.
+For use by the XLA shape bucketing pass only.
+
+Zero-pads dimension 0 of `input` up to the smallest entry of `bucket_sizes`
+that can hold it (sizes beyond the largest bucket are rounded up to the next
+multiple of it) and returns the original size of dimension 0 in `true_size`.
+Scalars and non-POD tensors pass through unchanged with `true_size` set to -1.
+)");
+
+REGISTER_OP("_XlaSliceToSize")
+    .Input("input: T")
+    .Input("true_sizes: N * int32")
+    .Output("output: T")
+    .Attr("T: type")
+    .Attr("N: int >= 1")
+    .SetShapeFn([](InferenceContext* c) {
+      shape_inference::ShapeHandle input = c->input(0);
+      if (!c->RankKnown(input) || c->Rank(input) == 0) {
+        c->set_output(0, input);
+      } else {
+        shape_inference::ShapeHandle sliced;
+        TF_RETURN_IF_ERROR(c->ReplaceDim(input, 0, c->UnknownDim(), &sliced));
+        c->set_output(0, sliced);
+      }
+      return Status::OK();
+    })
+    .Doc(R"(Slices the leading dimension back down to its true size.
+For use by the XLA shape bucketing pass only.
+
+Slices dimension 0 of `input` down to the first non-negative entry of
+`true_sizes`, the sizes recorded by the _XlaPadToBucket nodes feeding the
+cluster that produced `input`.  If all entries are negative, or the selected
+size is no smaller than dimension 0, `input` passes through unchanged.
+)");
+
 REGISTER_OP("_XlaRun")
     .Input("args: Targs")
     .Attr("Targs: list(type) >= 0")
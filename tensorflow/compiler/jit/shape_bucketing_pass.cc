@@ -0,0 +1,160 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing_pass.h"
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace {
+
+Status ParseBucketSizes(const string& spec, std::vector<int64>* bucket_sizes) {
+  for (absl::string_view piece : absl::StrSplit(spec, ',')) {
+    int64 size;
+    if (!absl::SimpleAtoi(piece, &size) || size <= 0 ||
+        (!bucket_sizes->empty() && size <= bucket_sizes->back())) {
+      return errors::InvalidArgument(
+          "tf_xla_shape_bucket_sizes must be a comma-separated, strictly "
+          "increasing list of positive integers; got \"",
+          spec, "\"");
+    }
+    bucket_sizes->push_back(size);
+  }
+  return Status::OK();
+}
+
+// Wraps the non-constant, non-resource inputs of the cluster call `n` in
+// _XlaPadToBucket nodes and its outputs in _XlaSliceToSize nodes.
+Status BucketizeCluster(Graph* g, Node* n,
+                        const std::vector<int64>& bucket_sizes) {
+  int num_constant_args, num_resource_args;
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(n->attrs(), kXlaNumConstantArgsAttr, &num_constant_args));
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(n->attrs(), kXlaNumResourceArgsAttr, &num_resource_args));
+  const int num_args = n->num_inputs() - num_constant_args - num_resource_args;
+  if (num_args <= 0) {
+    return Status::OK();
+  }
+
+  std::vector<const Edge*> in_edges;
+  TF_RETURN_IF_ERROR(n->input_edges(&in_edges));
+
+  // Constant args feed the compilation cache signature by value and resource
+  // args carry no shape, so only the plain args are padded.
+  std::vector<Node*> pad_nodes;
+  for (int i = num_constant_args; i < num_constant_args + num_args; ++i) {
+    DataType dtype = n->input_type(i);
+    if (!DataTypeCanUseMemcpy(dtype)) {
+      continue;
+    }
+    const Edge* e = in_edges[i];
+    Node* pad;
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(g->NewName(absl::StrCat(n->name(), "/pad_to_bucket")),
+                    "_XlaPadToBucket")
+            .Input(e->src(), e->src_output())
+            .Attr("T", dtype)
+            .Attr("bucket_sizes", bucket_sizes)
+            .Device(n->requested_device())
+            .Finalize(g, &pad));
+    pad->set_assigned_device_name(n->assigned_device_name());
+    g->RemoveEdge(e);
+    g->AddEdge(pad, 0, n, i);
+    pad_nodes.push_back(pad);
+  }
+  if (pad_nodes.empty()) {
+    return Status::OK();
+  }
+
+  // Every slice node receives all true sizes and picks the first one that
+  // belonged to an input with a paddable leading dimension.
+  std::vector<NodeBuilder::NodeOut> true_sizes;
+  true_sizes.reserve(pad_nodes.size());
+  for (Node* pad : pad_nodes) {
+    true_sizes.emplace_back(pad, 1);
+  }
+
+  std::vector<const Edge*> out_edges(n->out_edges().begin(),
+                                     n->out_edges().end());
+  absl::flat_hash_map<int, Node*> slice_nodes;
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge()) {
+      continue;
+    }
+    DataType dtype = n->output_type(e->src_output());
+    if (!DataTypeCanUseMemcpy(dtype)) {
+      continue;
+    }
+    Node*& slice = slice_nodes[e->src_output()];
+    if (slice == nullptr) {
+      TF_RETURN_IF_ERROR(
+          NodeBuilder(g->NewName(absl::StrCat(n->name(), "/slice_to_size")),
+                      "_XlaSliceToSize")
+              .Input(n, e->src_output())
+              .Input(true_sizes)
+              .Attr("T", dtype)
+              .Device(n->requested_device())
+              .Finalize(g, &slice));
+      slice->set_assigned_device_name(n->assigned_device_name());
+    }
+    Node* dst = e->dst();
+    int dst_input = e->dst_input();
+    g->RemoveEdge(e);
+    g->AddEdge(slice, 0, dst, dst_input);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ShapeBucketingPass::Run(const GraphOptimizationPassOptions& options) {
+  const string& spec =
+      bucket_sizes_spec_.has_value()
+          ? *bucket_sizes_spec_
+          : GetShapeBucketingPassFlags().tf_xla_shape_bucket_sizes;
+  if (spec.empty()) {
+    return Status::OK();
+  }
+  std::vector<int64> bucket_sizes;
+  TF_RETURN_IF_ERROR(ParseBucketSizes(spec, &bucket_sizes));
+
+  Graph* graph = options.graph->get();
+  std::vector<Node*> cluster_nodes;
+  for (Node* n : graph->op_nodes()) {
+    if (IsXlaCompiledKernel(*n)) {
+      cluster_nodes.push_back(n);
+    }
+  }
+  for (Node* n : cluster_nodes) {
+    VLOG(1) << "Bucketing shapes for cluster " << n->name();
+    TF_RETURN_IF_ERROR(BucketizeCluster(graph, n, bucket_sizes));
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
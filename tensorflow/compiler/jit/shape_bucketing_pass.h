@@ -0,0 +1,71 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Bounds the number of XLA cluster recompilations under dynamic shapes by
+// padding the leading dimension of cluster inputs up to a configured bucket
+// boundary before the cluster runs, and slicing cluster outputs back down to
+// the true size afterwards.  For every encapsulated cluster call the pass
+// rewrites
+//
+//   y = cluster(x, ...)
+//
+// into
+//
+//   x_pad, n = _XlaPadToBucket(x)       // zero-pads dim 0 up to a bucket
+//   y_pad = cluster(x_pad, ...)
+//   y = _XlaSliceToSize(y_pad, n)       // slices dim 0 back down to n
+//
+// so the cluster only ever sees leading-dimension sizes drawn from the bucket
+// list and a handful of compiled executables covers all traffic.
+//
+// The pass is enabled by setting tf_xla_shape_bucket_sizes in TF_XLA_FLAGS to
+// a strictly increasing list of sizes (e.g. "8,16,32,64"); sizes beyond the
+// largest bucket are rounded up to the next multiple of it.  Enabling it
+// asserts, for every cluster in the graph, that
+//
+//  * dimension 0 of every non-scalar cluster input and output is the same
+//    batch/sequence dimension, and
+//  * the cluster is padding tolerant: zero-padded rows must not affect the
+//    first n rows of any output.  This holds for elementwise math, matmuls
+//    that do not contract over dimension 0, gathers and the like, but not
+//    for reductions over dimension 0.
+//
+// Must run after EncapsulateSubgraphsPass and before BuildXlaOpsPass.
+class ShapeBucketingPass : public GraphOptimizationPass {
+ public:
+  // If bucket_sizes_spec is not nullopt then *bucket_sizes_spec overrides
+  // the --tf_xla_shape_bucket_sizes flag.
+  explicit ShapeBucketingPass(
+      absl::optional<string> bucket_sizes_spec = absl::nullopt)
+      : bucket_sizes_spec_(std::move(bucket_sizes_spec)) {}
+
+  Status Run(const GraphOptimizationPassOptions& options) override;
+
+ private:
+  absl::optional<string> bucket_sizes_spec_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
@@ -0,0 +1,144 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing_pass.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
+#include "tensorflow/compiler/jit/node_matchers.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::testing::FindNodeByName;
+using ::tensorflow::testing::matchers::Inputs;
+using ::tensorflow::testing::matchers::NodeWith;
+using ::tensorflow::testing::matchers::Op;
+using ::tensorflow::testing::matchers::Out;
+
+Status RunShapeBucketingPass(const Scope& s,
+                             const FunctionDefLibrary& fdef_lib,
+                             const string& bucket_sizes_spec,
+                             std::unique_ptr<Graph>* result) {
+  auto graph = absl::make_unique<Graph>(OpRegistry::Global());
+  TF_RETURN_IF_ERROR(s.ToGraph(graph.get()));
+  FunctionLibraryDefinition flib_def(graph->op_registry(), fdef_lib);
+
+  FixupSourceAndSinkEdges(graph.get());
+
+  SessionOptions session_options;
+  GraphOptimizationPassOptions opt_options;
+  opt_options.session_options = &session_options;
+  opt_options.flib_def = &flib_def;
+  opt_options.graph = &graph;
+  ShapeBucketingPass pass(bucket_sizes_spec);
+  TF_RETURN_IF_ERROR(pass.Run(opt_options));
+  *result = std::move(graph);
+  return Status::OK();
+}
+
+Status MakeXlaCompiledKernel(Graph* graph, const string& callee_name,
+                             const string& node_name, Node** result) {
+  NodeDef call_node;
+  call_node.set_name(node_name);
+  call_node.set_op(callee_name);
+  AddNodeAttr(kXlaCompiledKernelAttr, true, &call_node);
+  AddNodeAttr(kXlaNumConstantArgsAttr, 0, &call_node);
+  AddNodeAttr(kXlaNumResourceArgsAttr, 0, &call_node);
+  Status s;
+  *result = graph->AddNode(call_node, &s);
+  return s;
+}
+
+FunctionDefLibrary CreateFunctionDefLibWithIdentityFunction(
+    const string& name) {
+  FunctionDefLibrary fdef_lib;
+  FunctionDef func = FunctionDefHelper::Create(
+      /*function_name=*/name, /*in_def=*/{"a: float"},
+      /*out_def=*/{"out: float"}, /*attr_def=*/{},
+      /*node_def=*/{{{"out"}, "Identity", {"a"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"out", "out:output:0"}});
+  *fdef_lib.add_function() = std::move(func);
+  return fdef_lib;
+}
+
+TEST(ShapeBucketingPassTest, WrapsClusterInPadAndSlice) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  FunctionDefLibrary fdef_lib =
+      CreateFunctionDefLibWithIdentityFunction("cluster_0");
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(fdef_lib));
+
+  Output input = ops::Placeholder(root.WithOpName("input"), DT_FLOAT);
+  Node* call;
+  TF_ASSERT_OK(MakeXlaCompiledKernel(root.graph(), "cluster_0", "C", &call));
+  root.graph()->AddEdge(input.node(), 0, call, 0);
+  ops::Neg consumer(root.WithOpName("consumer"), Output(call, 0));
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(RunShapeBucketingPass(root, fdef_lib, "8,16,32", &graph));
+
+  Node* cluster = FindNodeByName(graph.get(), "C");
+  ASSERT_NE(cluster, nullptr);
+  EXPECT_THAT(cluster,
+              NodeWith(Inputs(Out(NodeWith(Op("_XlaPadToBucket"))))));
+
+  Node* consumer_new = FindNodeByName(graph.get(), "consumer");
+  ASSERT_NE(consumer_new, nullptr);
+  EXPECT_THAT(consumer_new,
+              NodeWith(Inputs(Out(NodeWith(Op("_XlaSliceToSize"))))));
+}
+
+TEST(ShapeBucketingPassTest, DisabledWithoutBucketSizes) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  FunctionDefLibrary fdef_lib =
+      CreateFunctionDefLibWithIdentityFunction("cluster_0");
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(fdef_lib));
+
+  Output input = ops::Placeholder(root.WithOpName("input"), DT_FLOAT);
+  Node* call;
+  TF_ASSERT_OK(MakeXlaCompiledKernel(root.graph(), "cluster_0", "C", &call));
+  root.graph()->AddEdge(input.node(), 0, call, 0);
+  ops::Neg consumer(root.WithOpName("consumer"), Output(call, 0));
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(RunShapeBucketingPass(root, fdef_lib, "", &graph));
+
+  Node* cluster = FindNodeByName(graph.get(), "C");
+  ASSERT_NE(cluster, nullptr);
+  EXPECT_THAT(cluster, NodeWith(Inputs(Out(NodeWith(Op("Placeholder"))))));
+}
+
+TEST(ShapeBucketingPassTest, RejectsNonIncreasingBucketSizes) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  FunctionDefLibrary fdef_lib;
+
+  std::unique_ptr<Graph> graph;
+  Status status = RunShapeBucketingPass(root, fdef_lib, "8,4", &graph);
+  ASSERT_FALSE(status.ok());
+  EXPECT_EQ(status.code(), error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace tensorflow
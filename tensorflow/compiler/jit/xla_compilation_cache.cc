@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <stdlib.h>
+
 #include <numeric>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/type_util.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
@@ -30,7 +33,10 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
@@ -40,9 +46,109 @@ namespace tensorflow {
 
 constexpr int64 XlaCompilationCache::kDefaultCompilationThreshold;
 
+namespace {
+
+string PersistentCacheDirFromEnv() {
+  const char* dir = getenv("TF_XLA_PERSISTENT_CACHE_DIR");
+  return dir == nullptr ? "" : dir;
+}
+
+XlaSerializedCacheEntry SerializeCacheEntry(
+    const string& signature, const DeviceType& device_type,
+    const XlaCompiler::CompilationResult& result) {
+  XlaSerializedCacheEntry serialized;
+  serialized.set_signature(signature);
+  serialized.set_device_type(device_type.type());
+  serialized.set_tf_version(TF_VERSION_STRING);
+  for (int input : result.input_mapping) {
+    serialized.add_input_mapping(input);
+  }
+  for (const xla::Shape& shape : result.xla_input_shapes) {
+    *serialized.add_xla_input_shapes() = shape.ToProto();
+  }
+  *serialized.mutable_xla_output_shape() = result.xla_output_shape.ToProto();
+  for (const XlaCompiler::OutputDescription& output : result.outputs) {
+    XlaSerializedCacheEntry::Output* out = serialized.add_outputs();
+    out->set_type(output.type);
+    output.shape.AsProto(out->mutable_shape());
+    out->set_is_constant(output.is_constant);
+    if (output.is_constant) {
+      output.constant_value.AsProtoTensorContent(out->mutable_constant_value());
+    }
+    out->set_input_index(output.input_index);
+  }
+  *serialized.mutable_host_compute_metadata() = result.host_compute_metadata;
+  for (const XlaCompiler::ResourceUpdate& update : result.resource_updates) {
+    XlaSerializedCacheEntry::ResourceUpdate* upd =
+        serialized.add_resource_updates();
+    upd->set_input_index(update.input_index);
+    upd->set_type(update.type);
+    update.shape.AsProto(upd->mutable_shape());
+    upd->set_modified(update.modified);
+    for (const string& gradient : update.tensor_array_gradients_accessed) {
+      upd->add_tensor_array_gradients_accessed(gradient);
+    }
+  }
+  *serialized.mutable_hlo_module() = result.computation->proto();
+  return serialized;
+}
+
+Status DeserializeCacheEntry(const XlaSerializedCacheEntry& serialized,
+                             XlaCompiler::CompilationResult* result) {
+  result->input_mapping.assign(serialized.input_mapping().begin(),
+                               serialized.input_mapping().end());
+  for (const xla::ShapeProto& shape : serialized.xla_input_shapes()) {
+    result->xla_input_shapes.push_back(xla::Shape(shape));
+  }
+  result->xla_output_shape = xla::Shape(serialized.xla_output_shape());
+  for (const auto& output_proto : serialized.outputs()) {
+    XlaCompiler::OutputDescription output;
+    output.type = output_proto.type();
+    output.shape = TensorShape(output_proto.shape());
+    output.is_constant = output_proto.is_constant();
+    if (output.is_constant &&
+        !output.constant_value.FromProto(output_proto.constant_value())) {
+      return errors::DataLoss(
+          "Malformed constant value in persisted XLA cache entry");
+    }
+    output.input_index = output_proto.input_index();
+    result->outputs.push_back(std::move(output));
+  }
+  result->host_compute_metadata = serialized.host_compute_metadata();
+  for (const auto& update_proto : serialized.resource_updates()) {
+    XlaCompiler::ResourceUpdate update;
+    update.input_index = update_proto.input_index();
+    update.type = update_proto.type();
+    update.shape = TensorShape(update_proto.shape());
+    update.modified = update_proto.modified();
+    for (const string& gradient :
+         update_proto.tensor_array_gradients_accessed()) {
+      update.tensor_array_gradients_accessed.insert(gradient);
+    }
+    result->resource_updates.push_back(std::move(update));
+  }
+  result->computation =
+      std::make_shared<xla::XlaComputation>(serialized.hlo_module());
+  return Status::OK();
+}
+
+}  // namespace
+
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
                                          DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+    : client_(client),
+      device_type_(std::move(device_type)),
+      persistent_cache_dir_(PersistentCacheDirFromEnv()) {
+  if (!persistent_cache_dir_.empty()) {
+    Status s =
+        Env::Default()->RecursivelyCreateDir(persistent_cache_dir_);
+    if (!s.ok() && !errors::IsAlreadyExists(s)) {
+      LOG(WARNING) << "Cannot create XLA persistent cache directory "
+                   << persistent_cache_dir_ << ": " << s
+                   << "; persistence disabled for writes";
+    }
+  }
+}
 
 XlaCompilationCache::~XlaCompilationCache() {
   // Ensure any use of our programs have completed by waiting for all stream
@@ -164,6 +270,81 @@ Status XlaCompilationCache::BuildExecutable(
   return Status::OK();
 }
 
+string XlaCompilationCache::PersistentCacheFilename(
+    const Signature& signature) const {
+  DCHECK(!persistent_cache_dir_.empty());
+  return io::JoinPath(
+      persistent_cache_dir_,
+      strings::Printf("xla_compile_%016llx.pb",
+                      static_cast<unsigned long long>(  // NOLINT(runtime/int)
+                          Signature::Hash()(signature))));
+}
+
+bool XlaCompilationCache::LoadPersistedEntry(
+    const XlaCompiler::Options& options, const Signature& signature,
+    Entry* entry) {
+  const string filename = PersistentCacheFilename(signature);
+  if (!Env::Default()->FileExists(filename).ok()) {
+    return false;
+  }
+  XlaSerializedCacheEntry serialized;
+  Status s = ReadBinaryProto(Env::Default(), filename, &serialized);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read persisted XLA cache entry " << filename
+                 << ": " << s;
+    return false;
+  }
+  // The filename only encodes the signature hash; verify the full signature
+  // as well as the device and TensorFlow version the entry was built for.
+  if (serialized.signature() != signature.HumanString() ||
+      serialized.device_type() != device_type_.type() ||
+      serialized.tf_version() != TF_VERSION_STRING) {
+    VLOG(1) << "Ignoring persisted XLA cache entry " << filename
+            << ": signature, device type or TensorFlow version mismatch";
+    return false;
+  }
+  XlaCompiler::CompilationResult result;
+  s = DeserializeCacheEntry(serialized, &result);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to deserialize persisted XLA cache entry "
+                 << filename << ": " << s;
+    return false;
+  }
+  // The executable cannot be persisted in this XLA version, so rebuild it
+  // from the deserialized computation.  This skips the TensorFlow-to-XLA
+  // lowering but still pays for the backend compile.
+  std::unique_ptr<xla::LocalExecutable> executable;
+  s = BuildExecutable(options, result, &executable);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to build executable from persisted XLA cache "
+                 << "entry " << filename << ": " << s;
+    return false;
+  }
+  entry->compiled = true;
+  entry->compilation_status = Status::OK();
+  entry->compilation_result = std::move(result);
+  entry->executable = std::move(executable);
+  VLOG(1) << "Loaded persisted XLA cache entry for signature "
+          << signature.HumanString() << " from " << filename;
+  return true;
+}
+
+void XlaCompilationCache::PersistEntry(const Signature& signature,
+                                       const Entry& entry) {
+  if (!entry.compilation_status.ok() ||
+      entry.compilation_result.computation == nullptr) {
+    return;
+  }
+  XlaSerializedCacheEntry serialized = SerializeCacheEntry(
+      signature.HumanString(), device_type_, entry.compilation_result);
+  const string filename = PersistentCacheFilename(signature);
+  Status s = WriteBinaryProto(Env::Default(), filename, serialized);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to persist XLA cache entry to " << filename << ": "
+                 << s;
+  }
+}
+
 Status XlaCompilationCache::Compile(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
@@ -328,6 +509,15 @@ Status XlaCompilationCache::CompileImpl(
       return Status::OK();
     }
 
+    // A valid persisted entry skips both the TF-to-XLA lowering and writing
+    // the entry back out.
+    if (!persistent_cache_dir_.empty() &&
+        LoadPersistedEntry(options, signature, entry)) {
+      *out_compilation_result = &entry->compilation_result;
+      *out_executable = entry->executable.get();
+      return Status::OK();
+    }
+
     tensorflow::Env* env = tensorflow::Env::Default();
     const uint64 compile_start_us = env->NowMicros();
     // Do the actual JIT compilation without holding the lock (it can take
@@ -362,6 +552,10 @@ Status XlaCompilationCache::CompileImpl(
                      it->second.cumulative_compile_time_us / 1.0e6)
               << ")";
     }
+
+    if (!persistent_cache_dir_.empty() && entry->compilation_status.ok()) {
+      PersistEntry(signature, *entry);
+    }
   }
   TF_RETURN_IF_ERROR(entry->compilation_status);
   *out_compilation_result = &entry->compilation_result;
@@ -39,6 +39,13 @@ namespace tensorflow {
 // Since XLA computations must have static shapes, the cache generates a new
 // XLA computation for each new set of input shapes.
 //
+// If the TF_XLA_PERSISTENT_CACHE_DIR environment variable names a directory,
+// the cache also persists each entry's lowered XLA computation and execution
+// metadata there and reloads matching entries in later processes, skipping
+// the TensorFlow-to-XLA lowering on restart.  The backend executable is
+// rebuilt from the persisted HLO, since this XLA version cannot serialize
+// JIT executables.
+//
 // Currently no cache eviction policy is implemented and the cache grows without
 // bound.
 class XlaCompilationCache : public ResourceBase {
@@ -135,9 +142,31 @@ class XlaCompilationCache : public ResourceBase {
                          const XlaCompiler::CompilationResult& result,
                          std::unique_ptr<xla::LocalExecutable>* executable);
 
+  struct Entry;
+
+  // Returns the file the persisted entry for `signature` lives in.
+  // REQUIRES: !persistent_cache_dir_.empty()
+  string PersistentCacheFilename(const Signature& signature) const;
+
+  // Attempts to initialize `entry` from the persistent cache.  Returns true
+  // iff a valid persisted entry for `signature` was found, in which case
+  // `entry` holds the deserialized compilation result and a freshly built
+  // executable.  Any failure (missing file, version or device mismatch,
+  // parse error) logs and returns false so a normal compile proceeds.
+  // Called with `entry->mu` held.
+  bool LoadPersistedEntry(const XlaCompiler::Options& options,
+                          const Signature& signature, Entry* entry);
+
+  // Serializes a successfully compiled `entry` to the persistent cache.
+  // Failures are logged and otherwise ignored.  Called with `entry->mu` held.
+  void PersistEntry(const Signature& signature, const Entry& entry);
+
   xla::LocalClient* const client_;
   const DeviceType device_type_;
 
+  // Directory of the persistent cache; empty if persistence is disabled.
+  const string persistent_cache_dir_;
+
   // The value associated with a cache entry.
   struct Entry {
     mutex mu;
@@ -691,6 +691,77 @@ string BufferAssignment::ToString() const {
   return output;
 }
 
+string BufferAssignment::BufferInfoString() const {
+  string binfo;
+  // Columns: buffer_id,buffer_name,offset,size,definition_time,end_time,
+  // num_uses,use_names. Times are positions within the sequential order of
+  // the defining instruction's computation, or -1 if the computation has no
+  // sequential order.
+  absl::StrAppend(&binfo,
+                  "buffer_id,buffer_name,offset,size,definition_time,"
+                  "end_time,num_uses,use_names\n");
+  const HloOrdering& ordering = liveness_->hlo_ordering();
+  // Cache of instruction positions in the sequential order, built lazily for
+  // each computation a buffer is defined in.
+  absl::flat_hash_map<const HloComputation*,
+                      absl::flat_hash_map<const HloInstruction*, int64>>
+      sequential_positions;
+  auto position_in_schedule = [&](const HloInstruction* instruction) -> int64 {
+    const HloComputation* computation = instruction->parent();
+    auto it = sequential_positions.find(computation);
+    if (it == sequential_positions.end()) {
+      absl::flat_hash_map<const HloInstruction*, int64> positions;
+      const HloInstructionSequence* sequence =
+          ordering.SequentialOrder(*computation);
+      if (sequence != nullptr) {
+        int64 position = 0;
+        for (const HloInstruction* scheduled : sequence->instructions()) {
+          positions[scheduled] = position++;
+        }
+      }
+      it = sequential_positions.emplace(computation, std::move(positions))
+               .first;
+    }
+    auto position_it = it->second.find(instruction);
+    return position_it == it->second.end() ? -1 : position_it->second;
+  };
+  // Sort the assigned buffers by id so the report is stable across runs.
+  std::vector<std::pair<const LogicalBuffer*, BufferAllocation::OffsetSize>>
+      buffers;
+  for (const BufferAllocation& allocation : Allocations()) {
+    for (const auto& buffer_offset_size : allocation.assigned_buffers()) {
+      buffers.push_back(buffer_offset_size);
+    }
+  }
+  std::sort(buffers.begin(), buffers.end(),
+            [](const std::pair<const LogicalBuffer*,
+                               BufferAllocation::OffsetSize>& a,
+               const std::pair<const LogicalBuffer*,
+                               BufferAllocation::OffsetSize>& b) {
+              return a.first->id() < b.first->id();
+            });
+  for (const auto& buffer_offset_size : buffers) {
+    const LogicalBuffer& buffer = *buffer_offset_size.first;
+    const HloInstruction* defining_instruction = buffer.instruction();
+    const int64 definition_time = position_in_schedule(defining_instruction);
+    // Approximate the end of the live range with the last scheduled use of
+    // the defining instruction. Aliasing introduced by buffer sharing may
+    // extend the live range beyond this point.
+    int64 end_time = definition_time;
+    string use_names;
+    for (const HloInstruction* user : defining_instruction->users()) {
+      end_time = std::max(end_time, position_in_schedule(user));
+      absl::StrAppend(&use_names, use_names.empty() ? "" : ";", user->name());
+    }
+    absl::StrAppend(&binfo, buffer.id(), ",\"", buffer.ToString(), "\",",
+                    buffer_offset_size.second.offset, ",",
+                    buffer_offset_size.second.size, ",", definition_time, ",",
+                    end_time, ",", defining_instruction->user_count(), ",\"",
+                    use_names, "\"\n");
+  }
+  return binfo;
+}
+
 BufferAssignmentProto BufferAssignment::ToProto() const {
   BufferAssignmentProto proto;
   // NOTE: TuplePointsToAnalysis state is serialized here in BufferAssigment,
@@ -445,6 +445,12 @@ class BufferAssignment {
   string ToString() const;
   BufferAssignmentProto ToProto() const;
 
+  // Returns a machine-readable (CSV) description of every assigned buffer:
+  // its offset and size within its allocation, and its live range (definition
+  // and last-use positions) against the sequential instruction order. Useful
+  // for diffing why the memory footprint of a module changed.
+  string BufferInfoString() const;
+
   // Statistics for the assignment.  Values initialized to -1 are not always
   // collected; fragmentation is only collected for instructions that have a
   // sequential total ordering.
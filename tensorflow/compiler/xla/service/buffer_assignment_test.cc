@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/call_graph.h"
@@ -48,6 +49,7 @@ limitations under the License.
 namespace xla {
 namespace {
 
+using ::testing::HasSubstr;
 using ::testing::UnorderedElementsAre;
 
 // DFS visitor that collects the instructions referenced by a computation
@@ -1732,6 +1734,40 @@ TEST_F(BufferAssignmentTest, PeakBuffers) {
   EXPECT_THAT(peak_instructions, UnorderedElementsAre(rev, neg, concat));
 }
 
+TEST_F(BufferAssignmentTest, BufferInfoString) {
+  // Verify the machine-readable buffer report for the sequence:
+  //
+  //   %p = ...
+  //   %exp = exp(%p)
+  //   ROOT %neg = neg(%exp)
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, f32vec100_, "p"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32vec100_, HloOpcode::kExp, param));
+  auto neg = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32vec100_, HloOpcode::kNegate, exp));
+  auto module = CreateNewVerifiedModule();
+  module->AddEntryComputation(builder.Build());
+
+  auto buffers = RunBufferAssignmentWithInstructionSequence(
+      module.get(), {param, exp, neg});
+
+  const string info = buffers->BufferInfoString();
+  EXPECT_THAT(info,
+              HasSubstr("buffer_id,buffer_name,offset,size,definition_time,"
+                        "end_time,num_uses,use_names\n"));
+  // %p is 400 bytes, defined at position 0 and used once by %exp at
+  // position 1.
+  EXPECT_THAT(info,
+              HasSubstr(absl::StrCat(",400,0,1,1,\"", exp->name(), "\"\n")));
+  // %exp is defined at position 1 and used once by %neg at position 2.
+  EXPECT_THAT(info,
+              HasSubstr(absl::StrCat(",400,1,2,1,\"", neg->name(), "\"\n")));
+  // %neg is the root; it is defined at position 2 and has no uses.
+  EXPECT_THAT(info, HasSubstr(",400,2,2,0,\"\"\n"));
+}
+
 TEST_F(BufferAssignmentTest, PeakBuffersWhile) {
   auto module = CreateNewVerifiedModule();
   const Shape shape = ShapeUtil::MakeShape(F32, {123, 123});
@@ -89,6 +89,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/indexed_array_analysis.h"
@@ -642,6 +643,26 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
                       ScheduleModule(module.get(), BufferSizeBytesFunction(),
                                      DFSMemoryScheduler));
 
+  // If the backend was given a memory budget, rematerialize HLO values until
+  // the scheduled peak memory use fits within it. This must run against the
+  // final schedule and before buffer assignment, and may extend the schedule
+  // with rematerialized instructions.
+  absl::optional<int64> memory_budget_bytes =
+      options::MemoryBudgetBytes(module->config());
+  if (memory_budget_bytes) {
+    TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+    HloRematerialization::RematerializationSizes sizes;
+    HloRematerialization rematerialization(BufferSizeBytesFunction(),
+                                           *memory_budget_bytes, &sizes);
+    TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(module.get()));
+    if (changed) {
+      VLOG(1) << "Rematerialization reduced peak memory use from "
+              << sizes.before_bytes << " to " << sizes.after_bytes
+              << " bytes (budget: " << *memory_budget_bytes << " bytes)";
+    }
+    schedule = module->schedule();
+  }
+
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<BufferAssignment> assignment,
@@ -655,6 +676,8 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   if (DumpingEnabledForHloModule(*module)) {
     DumpToFileInDirOrStdout(*module, "buffer_assignment",
                             assignment->ToString());
+    DumpToFileInDirOrStdout(*module, "buffer_info.csv",
+                            assignment->BufferInfoString());
   }
   DumpHloModuleIfEnabled(*module, *assignment, "after_optimizations");
 
@@ -826,6 +849,24 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
     TF_ASSIGN_OR_RETURN(HloSchedule schedule,
                         ScheduleModule(module, BufferSizeBytesFunction()));
 
+    // Apply the memory budget, if any, before buffer assignment consumes the
+    // schedule; see the corresponding logic in RunBackend.
+    absl::optional<int64> memory_budget_bytes =
+        options::MemoryBudgetBytes(module->config());
+    if (memory_budget_bytes) {
+      TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+      HloRematerialization::RematerializationSizes sizes;
+      HloRematerialization rematerialization(BufferSizeBytesFunction(),
+                                             *memory_budget_bytes, &sizes);
+      TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(module));
+      if (changed) {
+        VLOG(1) << "Rematerialization reduced peak memory use from "
+                << sizes.before_bytes << " to " << sizes.after_bytes
+                << " bytes (budget: " << *memory_budget_bytes << " bytes)";
+      }
+      schedule = module->schedule();
+    }
+
     // Run buffer analysis on the HLO graph. This analysis figures out which
     // temporary buffers are required to run the computation.
     TF_ASSIGN_OR_RETURN(
@@ -840,6 +881,8 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
     if (DumpingEnabledForHloModule(*module)) {
       DumpToFileInDirOrStdout(*module, "buffer_assignment",
                               assignment->ToString());
+      DumpToFileInDirOrStdout(*module, "buffer_info.csv",
+                              assignment->BufferInfoString());
     }
     DumpHloModuleIfEnabled(*module, *assignment, "after_optimizations");
 
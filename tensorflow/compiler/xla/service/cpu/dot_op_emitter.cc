@@ -178,15 +178,37 @@ class DotOpEmitter {
         .value_or(kDefaultTilingFactor);
   }
 
-  std::tuple<int64, int64, int64> GetGemmTileSize() const {
-    // Tuned for broadwell - Intel(R) Xeon(R) CPU E5-2690 v4 @ 2.60GHz
+  // Returns the GEMM tile size (tile_size_m, tile_size_k,
+  // tile_size_n_in_vector_width) for the target this dot is compiled for.
+  // `vector_register_byte_size` is the width of the largest vector register
+  // available to the emitted code.
+  std::tuple<int64, int64, int64> GetGemmTileSize(
+      int64 vector_register_byte_size) const {
+    // An explicitly requested tile size trumps the per-target defaults.
+    absl::optional<std::tuple<int64, int64, int64>> requested_tile_size =
+        options::LlvmIrGemmTileSize(hlo_module_config_);
+    if (requested_tile_size.has_value()) {
+      return *requested_tile_size;
+    }
+
+    // Tile sizes tuned empirically, keyed by the vector register width of the
+    // target CPU.  The dominant constraint is the size of the register file:
+    // the emitted kernel keeps tile_size_m * tile_size_n_in_vector_width
+    // accumulators live across the K loop, so targets with a larger register
+    // file profit from taller tiles.
     //
-    // TODO(b/80093688): Tune for other architectures and centralize this
-    // information in one place.
-    const std::tuple<int64, int64, int64> kDefaultTileSize =
-        std::tuple<int64, int64, int64>(11, 9, 1);
-    return options::LlvmIrGemmTileSize(hlo_module_config_)
-        .value_or(kDefaultTileSize);
+    // TODO(b/80093688): Tune for more architectures (in particular non-x86)
+    // and centralize this information in one place.
+    switch (vector_register_byte_size) {
+      case 64:
+        // AVX-512 targets (e.g. skylake-avx512) have 32 vector registers, so
+        // they can keep roughly twice as many accumulators live as the AVX2
+        // targets the default was tuned on.
+        return std::tuple<int64, int64, int64>(23, 9, 1);
+      default:
+        // Tuned for broadwell - Intel(R) Xeon(R) CPU E5-2690 v4 @ 2.60GHz
+        return std::tuple<int64, int64, int64>(11, 9, 1);
+    }
   }
 
   DotInfo dot_info_;
@@ -248,7 +270,8 @@ void DotOpEmitter::EmitTiledLlvmIrGemm() {
 
   int64 tile_size_m, tile_size_k, tile_size_n_in_vector_width;
   std::tie(tile_size_m, tile_size_k, tile_size_n_in_vector_width) =
-      GetGemmTileSize();
+      GetGemmTileSize(target_machine_features_.vector_register_byte_size(
+          *b_->GetInsertBlock()->getParent()));
 
   EmitSmallGemm(
       /*scalar_type=*/primitive_type,
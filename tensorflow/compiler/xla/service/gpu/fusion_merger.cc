@@ -20,11 +20,13 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
 #include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/errors.h"
 
@@ -129,8 +131,9 @@ double GetMergedBytesTransferred(HloInstruction* fusion) {
 // Accumulates and reports stats on successful/failed merge attempts.
 class FusionInstructionMerger {
  public:
-  explicit FusionInstructionMerger(HloComputation* computation)
-      : computation_(computation) {}
+  FusionInstructionMerger(HloComputation* computation,
+                          const FusionProfile* fusion_profile)
+      : computation_(computation), fusion_profile_(fusion_profile) {}
 
   Status Run();
 
@@ -140,6 +143,7 @@ class FusionInstructionMerger {
   Status HandleFusion(HloInstruction* fusion);
 
   HloComputation* computation_;
+  const FusionProfile* fusion_profile_;
   bool changed_ = false;
 
   // Fusion instruction merge stats.
@@ -151,6 +155,7 @@ class FusionInstructionMerger {
   int num_fail_expensive_fused_instruction_ = 0;
   int num_fail_net_bytes_transferred_ratio_ = 0;
   int num_fail_inefficient_fusion_emitter_ = 0;
+  int num_fail_profile_veto_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FusionInstructionMerger);
 };
@@ -172,7 +177,8 @@ Status FusionInstructionMerger::Run() {
           << " expensive_instruction: " << num_fail_expensive_fused_instruction_
           << " net_bytes_transferred: " << num_fail_net_bytes_transferred_ratio_
           << " inefficient_fusion_emitter: "
-          << num_fail_inefficient_fusion_emitter_ << " }";
+          << num_fail_inefficient_fusion_emitter_
+          << " profile_veto: " << num_fail_profile_veto_ << " }";
   return Status::OK();
 }
 
@@ -216,6 +222,19 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
     return Status::OK();
   }
 
+  // Skip 'fusion' instruction if it or one of the kernels it would be merged
+  // into was measured as a regression in a prior profiled run. Merging would
+  // only grow the vetoed kernel further.
+  if (fusion_profile_->IsFusionVetoed(fusion->name()) ||
+      absl::c_any_of(fusion->users(), [&](const HloInstruction* user) {
+        return fusion_profile_->IsFusionVetoed(user->name());
+      })) {
+    VLOG(3) << "Not merging " << fusion->name()
+            << ": Vetoed by the fusion profile.";
+    ++num_fail_profile_veto_;
+    return Status::OK();
+  }
+
   // Skip 'fusion' instruction if any of its fused instructions are expensive.
   // This is done to avoid the duplication of expensive instructions, which
   // would occur if 'fusion' were merged into multiple users.
@@ -289,12 +308,14 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
 StatusOr<bool> FusionMerger::Run(HloModule* module) {
   bool changed = false;
   VLOG(2) << "FusionMerger for module: " << module->name();
+  TF_ASSIGN_OR_RETURN(FusionProfile fusion_profile,
+                      FusionProfile::Load(module->config()));
   for (auto* computation : module->MakeNonfusionComputations()) {
     VLOG(1) << "Before running FusionInstructionMerger for computation: "
             << computation->name();
     XLA_VLOG_LINES(3, computation->ToString());
 
-    FusionInstructionMerger fusion_merger(computation);
+    FusionInstructionMerger fusion_merger(computation, &fusion_profile);
     TF_RETURN_IF_ERROR(fusion_merger.Run());
     changed |= fusion_merger.changed();
 
@@ -0,0 +1,77 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
+
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+const char* const kXlaGpuFusionProfilePath = "xla_gpu_fusion_profile_path";
+
+}  // namespace
+
+/* static */ StatusOr<FusionProfile> FusionProfile::Parse(
+    absl::string_view text) {
+  FusionProfile profile;
+  for (absl::string_view line : absl::StrSplit(text, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<absl::string_view> fields = absl::StrSplit(line, ',');
+    double fused_usecs;
+    double unfused_usecs;
+    if (fields.size() != 3 || fields[0].empty() ||
+        !absl::SimpleAtod(fields[1], &fused_usecs) ||
+        !absl::SimpleAtod(fields[2], &unfused_usecs)) {
+      return InvalidArgument("Invalid fusion profile entry: %s", line);
+    }
+    if (fused_usecs > unfused_usecs) {
+      profile.vetoed_fusions_.insert(string(fields[0]));
+    }
+  }
+  return profile;
+}
+
+/* static */ StatusOr<FusionProfile> FusionProfile::Load(
+    const HloModuleConfig& config) {
+  const auto& extra_options_map =
+      config.debug_options().xla_backend_extra_options();
+  auto it = extra_options_map.find(kXlaGpuFusionProfilePath);
+  if (it == extra_options_map.end()) {
+    return FusionProfile();
+  }
+  string text;
+  TF_RETURN_IF_ERROR(tensorflow::ReadFileToString(tensorflow::Env::Default(),
+                                                  it->second, &text));
+  return Parse(text);
+}
+
+bool FusionProfile::IsFusionVetoed(absl::string_view name) const {
+  return vetoed_fusions_.contains(name);
+}
+
+}  // namespace gpu
+}  // namespace xla
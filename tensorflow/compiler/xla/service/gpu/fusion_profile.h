@@ -0,0 +1,61 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_PROFILE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_PROFILE_H_
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+namespace gpu {
+
+// A per-fusion timing profile collected from a prior execution of the module.
+// The fusion passes use it as feedback: fusions that the profile measured as
+// slower than their unfused baselines are vetoed, so the analytic fusion
+// heuristics can be overridden for kernels they mis-predict.
+class FusionProfile {
+ public:
+  // Parses a profile in text form. Each entry is a line of the form
+  //
+  //   <instruction_name>,<fused_usecs>,<unfused_usecs>
+  //
+  // where <instruction_name> is the name of a fusion (or fusion root)
+  // instruction from the profiled run. Blank lines and lines starting with
+  // '#' are ignored. An instruction is vetoed when its fused time regressed
+  // versus the unfused baseline.
+  static StatusOr<FusionProfile> Parse(absl::string_view text);
+
+  // Loads the profile from the file named by the xla_gpu_fusion_profile_path
+  // backend option. Returns an empty profile if the option is not set.
+  static StatusOr<FusionProfile> Load(const HloModuleConfig& config);
+
+  // Returns true if the profile measured a regression for a fusion with the
+  // given instruction name.
+  bool IsFusionVetoed(absl::string_view name) const;
+
+  bool empty() const { return vetoed_fusions_.empty(); }
+
+ private:
+  absl::flat_hash_set<string> vetoed_fusions_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_PROFILE_H_
@@ -0,0 +1,51 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
+
+#include "tensorflow/compiler/xla/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+TEST(FusionProfileTest, ParseVetoesOnlyRegressedFusions) {
+  FusionProfile profile = FusionProfile::Parse(
+                              "# fusion,fused_usecs,unfused_usecs\n"
+                              "fusion.1,125.0,100.0\n"
+                              "fusion.2,80.0,100.0\n"
+                              "\n"
+                              "fusion.3,100.0,100.0\n")
+                              .ValueOrDie();
+  EXPECT_TRUE(profile.IsFusionVetoed("fusion.1"));
+  EXPECT_FALSE(profile.IsFusionVetoed("fusion.2"));
+  EXPECT_FALSE(profile.IsFusionVetoed("fusion.3"));
+  EXPECT_FALSE(profile.IsFusionVetoed("fusion.4"));
+}
+
+TEST(FusionProfileTest, ParseEmptyText) {
+  FusionProfile profile = FusionProfile::Parse("").ValueOrDie();
+  EXPECT_TRUE(profile.empty());
+}
+
+TEST(FusionProfileTest, ParseRejectsMalformedEntries) {
+  EXPECT_FALSE(FusionProfile::Parse("fusion.1,125.0").ok());
+  EXPECT_FALSE(FusionProfile::Parse("fusion.1,125.0,fast").ok());
+  EXPECT_FALSE(FusionProfile::Parse(",125.0,100.0").ok());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/pattern_matcher.h"
 #include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 
 namespace xla {
@@ -114,10 +115,22 @@ bool IsIEEEFloatingPointScalarConstant(const HloInstruction* constant) {
   return operands.size() + num_output_buffers > kMaxOperandsAndOutputsPerFusion;
 }
 
+StatusOr<bool> GpuInstructionFusion::Run(HloModule* module) {
+  TF_ASSIGN_OR_RETURN(fusion_profile_, FusionProfile::Load(module->config()));
+  return InstructionFusion::Run(module);
+}
+
 bool GpuInstructionFusion::ShouldFuseInexpensiveChecks(HloInstruction* consumer,
                                                        int64 operand_index) {
   HloInstruction* producer = consumer->mutable_operand(operand_index);
 
+  // Respect measured regressions from a prior profiled run: never (re)create
+  // a fusion that the profile flagged as slower than its unfused baseline.
+  if (fusion_profile_.IsFusionVetoed(producer->name()) ||
+      fusion_profile_.IsFusionVetoed(consumer->name())) {
+    return false;
+  }
+
   // Check if we can use output fusion for (A @ B) * alpha
   if (producer->opcode() == HloOpcode::kDot ||
       (producer->opcode() == HloOpcode::kFusion &&
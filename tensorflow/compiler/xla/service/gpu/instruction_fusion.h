@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INSTRUCTION_FUSION_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INSTRUCTION_FUSION_H_
 
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
 
@@ -42,6 +43,10 @@ class GpuInstructionFusion : public InstructionFusion {
 
   static bool IsExpensive(const HloInstruction& instruction);
 
+  // Loads the fusion profile for `module`, if any, before running the
+  // fusion pass itself.
+  StatusOr<bool> Run(HloModule* module) override;
+
   bool ShouldFuse(HloInstruction* consumer, int64 operand_index) override;
 
   bool ShouldFuseIntoMultiOutput(HloInstruction* consumer,
@@ -55,6 +60,10 @@ class GpuInstructionFusion : public InstructionFusion {
   // inexpensive checks whether we should fuse the operand into 'consumer'.
   bool ShouldFuseInexpensiveChecks(HloInstruction* consumer,
                                    int64 operand_index);
+
+  // Timing profile from a prior run of the module, if one was provided.
+  // Fusions that the profile measured as regressions are not (re)created.
+  FusionProfile fusion_profile_;
 };
 
 }  // namespace gpu
@@ -22,6 +22,12 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
+namespace {
+
+void DeleteTupleAddressBuffer(void* arg) { delete[] static_cast<void**>(arg); }
+
+}  // namespace
+
 Status TupleThunk::ExecuteOnStream(const BufferAllocations& buffer_allocations,
                                    se::Stream* stream,
                                    HloExecutionProfiler* profiler) {
@@ -47,7 +53,7 @@ Status TupleThunk::ExecuteOnStream(const BufferAllocations& buffer_allocations,
   }
   // Free the tuple address buffer when memcpy is done.
   auto* buffers_raw = tuple_element_buffer_addresses.release();
-  if (!stream->ThenDoHostCallback([buffers_raw] { delete[] buffers_raw; })
+  if (!stream->ThenDoHostCallbackWithArg(&DeleteTupleAddressBuffer, buffers_raw)
            .ok()) {
     delete[] buffers_raw;
     return InternalError("Unable to enqueue host callback!");
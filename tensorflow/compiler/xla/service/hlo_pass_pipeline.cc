@@ -27,6 +27,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -51,6 +54,37 @@ Status HloPassPipeline::RunInvariantCheckers(
   return Status::OK();
 }
 
+/* static */ StatusOr<bool> HloPassPipeline::RunHelper(
+    HloPassInterface* pass, HloModuleGroup* module_group) {
+  auto* module_pass = dynamic_cast<HloModulePass*>(pass);
+  if (module_pass == nullptr || module_group->size() <= 1) {
+    return pass->RunOnModuleGroup(module_group);
+  }
+
+  // A module-scoped pass only mutates the module it is run on, so the
+  // modules of the group can be processed concurrently.
+  const int64 num_threads = std::min<int64>(
+      module_group->size(), tensorflow::port::NumSchedulableCPUs());
+  std::vector<StatusOr<bool>> results(module_group->size(), false);
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "hlo_pass_pipeline", num_threads);
+    for (int i = 0; i < module_group->size(); ++i) {
+      HloModule* module = module_group->modules()[i];
+      StatusOr<bool>* result = &results[i];
+      pool.Schedule(
+          [module_pass, module, result] { *result = module_pass->Run(module); });
+    }
+  }  // Waits for all scheduled runs to finish.
+
+  bool changed = false;
+  for (StatusOr<bool>& result : results) {
+    TF_ASSIGN_OR_RETURN(bool module_changed, std::move(result));
+    changed |= module_changed;
+  }
+  return changed;
+}
+
 template <typename HloT>
 StatusOr<bool> HloPassPipeline::RunPassesInternal(
     HloT* hlo, absl::Span<HloPassInterface* const> passes) {
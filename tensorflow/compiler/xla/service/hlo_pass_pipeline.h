@@ -96,10 +96,12 @@ class HloPassPipeline : public HloPassInterface {
   static StatusOr<bool> RunHelper(HloPassInterface* pass, HloModule* module) {
     return pass->Run(module);
   }
+  // For module-scoped passes this runs the pass on the modules of the group
+  // in parallel on a thread pool; a module-scoped pass only touches its own
+  // module, so the modules of a group can be processed independently.
+  // Module-group scoped passes run as-is.
   static StatusOr<bool> RunHelper(HloPassInterface* pass,
-                                  HloModuleGroup* module_group) {
-    return pass->RunOnModuleGroup(module_group);
-  }
+                                  HloModuleGroup* module_group);
 
   const string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
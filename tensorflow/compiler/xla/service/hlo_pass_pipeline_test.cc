@@ -232,6 +232,79 @@ ENTRY main {
   }
 }
 
+TEST_F(HloPassPipelineTest, ModulePassOnModuleGroup) {
+  // A module pass run on a module group is applied to every module of the
+  // group; the modules are processed in parallel.
+  const string module_0_str = R"(
+HloModule ModulePassOnModuleGroup.0
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  const string module_1_str = R"(
+HloModule ModulePassOnModuleGroup.1
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] add(a, b)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(HloModuleGroup module_group,
+                          ParseModuleGroup({module_0_str, module_1_str}));
+
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<FooToBarModulePass>();
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          pipeline.RunOnModuleGroup(&module_group));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(
+      module_group.module(0).entry_computation()->root_instruction()->name(),
+      "bar");
+  EXPECT_EQ(
+      module_group.module(1).entry_computation()->root_instruction()->name(),
+      "bar");
+}
+
+TEST_F(HloPassPipelineTest, ModulePassErrorOnModuleGroup) {
+  // An error produced for any module of the group is reported, even though
+  // the modules are processed in parallel.
+  const string module_0_str = R"(
+HloModule ModulePassErrorOnModuleGroup.0
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT blahblah = f32[] multiply(a, b)
+}
+)";
+  const string module_1_str = R"(
+HloModule ModulePassErrorOnModuleGroup.1
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT bar = f32[] multiply(a, b)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(HloModuleGroup module_group,
+                          ParseModuleGroup({module_0_str, module_1_str}));
+
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<BarBlowerUpper>();
+
+  Status status = pipeline.RunOnModuleGroup(&module_group).status();
+  ASSERT_IS_NOT_OK(status);
+  EXPECT_THAT(status.error_message(),
+              ::testing::HasSubstr("Module has instruction named bar"));
+}
+
 TEST_F(HloPassPipelineTest, ModuleGroupPassOnModule) {
   // Running a module group pass on a module should produce an error.
   const string module_str = R"(
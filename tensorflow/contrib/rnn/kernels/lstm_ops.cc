@@ -122,6 +122,123 @@ void LSTMBlockCellFpropWithEigen(
   h.device(d) = o * co;
 }
 
+template <typename T>
+void LayerNormLSTMBlockCellFpropWithEigen(
+    const LSTMBlockCell& cell, OpKernelContext* ctx, const CPUDevice& d,
+    const float forget_bias, const float cell_clip, const float epsilon,
+    bool use_peephole, typename TTypes<T>::ConstMatrix x,
+    typename TTypes<T>::ConstMatrix cs_prev,
+    typename TTypes<T>::ConstMatrix h_prev, typename TTypes<T>::ConstMatrix w,
+    typename TTypes<T>::ConstVec wci, typename TTypes<T>::ConstVec wcf,
+    typename TTypes<T>::ConstVec wco, typename TTypes<T>::ConstVec gamma,
+    typename TTypes<T>::ConstVec beta, typename TTypes<T>::Matrix xh,
+    typename TTypes<T>::Matrix norm, typename TTypes<T>::Matrix i,
+    typename TTypes<T>::Matrix cs, typename TTypes<T>::Matrix f,
+    typename TTypes<T>::Matrix o, typename TTypes<T>::Matrix ci,
+    typename TTypes<T>::Matrix co, typename TTypes<T>::Matrix icfo,
+    typename TTypes<T>::Matrix h) {
+  // Concat xh = [x, h].
+  xh.slice(cell.xh_x_offsets(), cell.xh_x_extents()).device(d) = x;
+  xh.slice(cell.xh_h_offsets(), cell.xh_h_extents()).device(d) = h_prev;
+
+  // icfo = xh * w.  One GEMM covers all four gates; the bias of the
+  // plain LSTMBlockCell is subsumed by the shift beta below.
+  typename TTypes<T>::ConstMatrix const_xh(xh.data(), xh.dimensions());
+  TensorBlasGemm<CPUDevice, T, false /* USE_CUBLAS */>::compute(
+      ctx, d, false, false, typename gemm_compute_type<T>::type(1.f), const_xh,
+      w, typename gemm_compute_type<T>::type(0.f), icfo);
+
+  // Layer-normalize each gate's pre-activations across the cell
+  // dimension, then apply the learned scale and shift, writing the
+  // result back into icfo in place.
+  Eigen::array<Eigen::DenseIndex, 1> red_axis({1});
+  Eigen::array<Eigen::DenseIndex, 2> mean_shape({cell.batch_size(), 1});
+  Eigen::array<Eigen::DenseIndex, 2> mean_broadcast({1, cell.cell_size()});
+  Eigen::array<Eigen::DenseIndex, 2> g_shape({1, cell.cell_size()});
+  Eigen::array<Eigen::DenseIndex, 2> g_broadcast({cell.batch_size(), 1});
+  for (int gate = 0; gate < 4; ++gate) {
+    const Eigen::array<Eigen::DenseIndex, 2> offsets(
+        {0, cell.cell_size() * gate});
+    const Eigen::array<Eigen::DenseIndex, 1> v_offsets(
+        {cell.cell_size() * gate});
+    const Eigen::array<Eigen::DenseIndex, 1> v_extents({cell.cell_size()});
+    auto pre = icfo.slice(offsets, cell.cell_extents());
+    auto centered = norm.slice(offsets, cell.cell_extents());
+    centered.device(d) = pre - pre.mean(red_axis)
+                                   .eval()
+                                   .reshape(mean_shape)
+                                   .broadcast(mean_broadcast);
+    icfo.slice(offsets, cell.cell_extents()).device(d) =
+        centered *
+            (centered.square().mean(red_axis) +
+             centered.square().mean(red_axis).constant(T(epsilon)))
+                .rsqrt()
+                .eval()
+                .reshape(mean_shape)
+                .broadcast(mean_broadcast) *
+            gamma.slice(v_offsets, v_extents)
+                .reshape(g_shape)
+                .broadcast(g_broadcast) +
+        beta.slice(v_offsets, v_extents)
+            .reshape(g_shape)
+            .broadcast(g_broadcast);
+  }
+
+  Eigen::array<Eigen::DenseIndex, 2> p_shape({1, cell.cell_size()});
+  Eigen::array<Eigen::DenseIndex, 2> p_broadcast_shape({cell.batch_size(), 1});
+
+  // Input gate.
+  if (use_peephole) {
+    auto i_peep = cs_prev * wci.reshape(p_shape).broadcast(p_broadcast_shape);
+    i.device(d) =
+        (icfo.slice(cell.icfo_i_offsets(), cell.cell_extents()) + i_peep)
+            .sigmoid();
+  } else {
+    i.device(d) =
+        icfo.slice(cell.icfo_i_offsets(), cell.cell_extents()).sigmoid();
+  }
+
+  // Cell input.
+  ci.device(d) = icfo.slice(cell.icfo_c_offsets(), cell.cell_extents()).tanh();
+
+  // Forget gate (w/ bias).
+  if (use_peephole) {
+    auto f_peep = cs_prev * wcf.reshape(p_shape).broadcast(p_broadcast_shape);
+    f.device(d) = (icfo.slice(cell.icfo_f_offsets(), cell.cell_extents()) +
+                   f.constant(T(forget_bias)) + f_peep)
+                      .sigmoid();
+  } else {
+    f.device(d) = (icfo.slice(cell.icfo_f_offsets(), cell.cell_extents()) +
+                   f.constant(T(forget_bias)))
+                      .sigmoid();
+  }
+
+  // cs = ci .* i + f .* cs_prev
+  cs.device(d) = i * ci + f * cs_prev;
+
+  if (cell_clip > 0.0f) {
+    cs.device(d) =
+        cs.binaryExpr(cs.constant(T(cell_clip)), Eigen::scalar_clip_op<T>());
+  }
+
+  // co = tanh(cs)
+  co.device(d) = cs.tanh();
+
+  // Output gate.
+  if (use_peephole) {
+    auto o_peep = cs * wco.reshape(p_shape).broadcast(p_broadcast_shape);
+    o.device(d) =
+        (icfo.slice(cell.icfo_o_offsets(), cell.cell_extents()) + o_peep)
+            .sigmoid();
+  } else {
+    o.device(d) =
+        icfo.slice(cell.icfo_o_offsets(), cell.cell_extents()).sigmoid();
+  }
+
+  // h = o .* co
+  h.device(d) = o * co;
+}
+
 template <typename Device, typename T, bool USE_CUBLAS>
 void LSTMBlockCellBpropWithEigen(
     const LSTMBlockCell& cell, OpKernelContext* ctx, const Device& d,
@@ -222,7 +339,30 @@ void LSTMBlockCellBpropWithEigen(
         i, cs, f, o, ci, co, cs_grad, h_grad, do_, dcs, dci, df, di, dicfo,   \
         cs_prev_grad, wci_grad, wcf_grad, wco_grad);                          \
   }                                                                           \
+  template <>                                                                 \
+  void LayerNormLSTMBlockCellFprop<CPUDevice, T, false /* USE_CUBLAS */>::    \
+  operator()(                                                                 \
+      OpKernelContext* ctx, const CPUDevice& d, const float forget_bias,      \
+      const float cell_clip, const float epsilon, bool use_peephole,          \
+      typename TTypes<T>::ConstMatrix x,                                      \
+      typename TTypes<T>::ConstMatrix cs_prev,                                \
+      typename TTypes<T>::ConstMatrix h_prev,                                 \
+      typename TTypes<T>::ConstMatrix w, typename TTypes<T>::ConstVec wci,    \
+      typename TTypes<T>::ConstVec wcf, typename TTypes<T>::ConstVec wco,     \
+      typename TTypes<T>::ConstVec gamma, typename TTypes<T>::ConstVec beta,  \
+      typename TTypes<T>::Matrix xh, typename TTypes<T>::Matrix norm,         \
+      typename TTypes<T>::Matrix i, typename TTypes<T>::Matrix cs,            \
+      typename TTypes<T>::Matrix f, typename TTypes<T>::Matrix o,             \
+      typename TTypes<T>::Matrix ci, typename TTypes<T>::Matrix co,           \
+      typename TTypes<T>::Matrix icfo, typename TTypes<T>::Matrix h) {        \
+    LayerNormLSTMBlockCellFpropWithEigen<T>(                                  \
+        *this, ctx, d, forget_bias, cell_clip, epsilon, use_peephole, x,      \
+        cs_prev, h_prev, w, wci, wcf, wco, gamma, beta, xh, norm, i, cs, f,   \
+        o, ci, co, icfo, h);                                                  \
+  }                                                                           \
   template struct LSTMBlockCellFprop<CPUDevice, T, false /* USE_CUBLAS */>;   \
+  template struct LayerNormLSTMBlockCellFprop<CPUDevice, T,                   \
+                                              false /* USE_CUBLAS */>;        \
   template struct LSTMBlockCellBprop<CPUDevice, T, false /* USE_CUBLAS */>;
 
 DEFINE_CPU_SPECS(float);
@@ -378,6 +518,167 @@ REGISTER_KERNEL(float);
 REGISTER_KERNEL(Eigen::half);
 #undef REGISTER_KERNEL
 
+template <typename Device, typename T, bool USE_CUBLAS>
+class LayerNormLSTMBlockCellOp : public OpKernel {
+ public:
+  explicit LayerNormLSTMBlockCellOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("forget_bias", &forget_bias_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("cell_clip", &cell_clip_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("epsilon", &epsilon_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_peephole", &use_peephole_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor* x_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("x", &x_tensor));
+
+    const Tensor* cs_prev_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("cs_prev", &cs_prev_tensor));
+
+    const Tensor* h_prev_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("h_prev", &h_prev_tensor));
+
+    const Tensor* w_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("w", &w_tensor));
+
+    const Tensor* wci_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("wci", &wci_tensor));
+
+    const Tensor* wcf_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("wcf", &wcf_tensor));
+
+    const Tensor* wco_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("wco", &wco_tensor));
+
+    const Tensor* gamma_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("gamma", &gamma_tensor));
+
+    const Tensor* beta_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->input("beta", &beta_tensor));
+
+    const int64 batch_size = x_tensor->dim_size(0);
+    const int64 input_size = x_tensor->dim_size(1);
+    const int64 cell_size = cs_prev_tensor->dim_size(1);
+
+    // Sanity checks for our input shapes.
+    OP_REQUIRES(ctx, cs_prev_tensor->dim_size(0) == batch_size,
+                errors::InvalidArgument("cs_prev.dims(0) != batch_size: ",
+                                        cs_prev_tensor->dim_size(0), " vs. ",
+                                        batch_size));
+
+    OP_REQUIRES(ctx, h_prev_tensor->dim_size(0) == batch_size,
+                errors::InvalidArgument("h_prev.dims(0) != batch_size: ",
+                                        h_prev_tensor->dim_size(0), " vs. ",
+                                        batch_size));
+    OP_REQUIRES(ctx, h_prev_tensor->dim_size(1) == cell_size,
+                errors::InvalidArgument(
+                    "h_prev.dims(1) != cell_size: ", h_prev_tensor->dim_size(1),
+                    " vs. ", cell_size));
+
+    OP_REQUIRES(ctx, w_tensor->dim_size(0) == input_size + cell_size,
+                errors::InvalidArgument(
+                    "w.dim_size(0) != input_size + cell_size: ",
+                    w_tensor->dim_size(0), " vs. ", input_size + cell_size));
+    OP_REQUIRES(ctx, w_tensor->dim_size(1) == cell_size * 4,
+                errors::InvalidArgument(
+                    "w.dim_size(1) != cell_size * 4: ", w_tensor->dim_size(1),
+                    " vs. ", cell_size * 4));
+
+    OP_REQUIRES(ctx, gamma_tensor->dim_size(0) == cell_size * 4,
+                errors::InvalidArgument("gamma.dim_size(0) != cell_size * 4: ",
+                                        gamma_tensor->dim_size(0), " vs. ",
+                                        cell_size * 4));
+    OP_REQUIRES(ctx, beta_tensor->dim_size(0) == cell_size * 4,
+                errors::InvalidArgument("beta.dim_size(0) != cell_size * 4: ",
+                                        beta_tensor->dim_size(0), " vs. ",
+                                        cell_size * 4));
+
+    // Allocate our output tensors.
+    Tensor* i_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {"h_prev"}, "i",
+                            TensorShape({batch_size, cell_size}), &i_tensor));
+
+    Tensor* cs_tensor = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output("cs", TensorShape({batch_size, cell_size}),
+                                  &cs_tensor));
+
+    Tensor* f_tensor = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output("f", TensorShape({batch_size, cell_size}),
+                                  &f_tensor));
+
+    Tensor* o_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {"cs_prev"}, "o",
+                            TensorShape({batch_size, cell_size}), &o_tensor));
+
+    Tensor* ci_tensor = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output("ci", TensorShape({batch_size, cell_size}),
+                                  &ci_tensor));
+
+    Tensor* co_tensor = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output("co", TensorShape({batch_size, cell_size}),
+                                  &co_tensor));
+
+    Tensor* h_tensor = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output("h", TensorShape({batch_size, cell_size}),
+                                  &h_tensor));
+
+    // Allocate our temp tensors.
+    Tensor xh_tensor;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                            DataTypeToEnum<T>::v(),
+                            TensorShape({batch_size, input_size + cell_size}),
+                            &xh_tensor));
+
+    Tensor icfo_tensor;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_temp(DataTypeToEnum<T>::v(),
+                                      TensorShape({batch_size, cell_size * 4}),
+                                      &icfo_tensor));
+
+    Tensor norm_tensor;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_temp(DataTypeToEnum<T>::v(),
+                                      TensorShape({batch_size, cell_size * 4}),
+                                      &norm_tensor));
+
+    const Device& device = ctx->eigen_device<Device>();
+
+    functor::LayerNormLSTMBlockCellFprop<Device, T, USE_CUBLAS>(
+        batch_size, input_size, cell_size)(
+        ctx, device, forget_bias_, cell_clip_, epsilon_, use_peephole_,
+        x_tensor->matrix<T>(), cs_prev_tensor->matrix<T>(),
+        h_prev_tensor->matrix<T>(), w_tensor->matrix<T>(), wci_tensor->vec<T>(),
+        wcf_tensor->vec<T>(), wco_tensor->vec<T>(), gamma_tensor->vec<T>(),
+        beta_tensor->vec<T>(), xh_tensor.matrix<T>(), norm_tensor.matrix<T>(),
+        i_tensor->matrix<T>(), cs_tensor->matrix<T>(), f_tensor->matrix<T>(),
+        o_tensor->matrix<T>(), ci_tensor->matrix<T>(), co_tensor->matrix<T>(),
+        icfo_tensor.matrix<T>(), h_tensor->matrix<T>());
+  }
+
+ private:
+  float forget_bias_;
+  float cell_clip_;
+  float epsilon_;
+  bool use_peephole_;
+};
+
+#define REGISTER_KERNEL(T)                                          \
+  REGISTER_KERNEL_BUILDER(Name("LayerNormLSTMBlockCell")            \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<T>("T"),              \
+                          LayerNormLSTMBlockCellOp<CPUDevice, T, false>);
+REGISTER_KERNEL(float);
+REGISTER_KERNEL(Eigen::half);
+#undef REGISTER_KERNEL
+
 #if GOOGLE_CUDA
 namespace functor {
 #define DECLARE_GPU_SPEC(T)                                                \
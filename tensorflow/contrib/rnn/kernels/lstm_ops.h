@@ -170,6 +170,38 @@ struct LSTMBlockCellFprop : public LSTMBlockCell {
                   typename TTypes<T>::Matrix h);
 };
 
+// Like LSTMBlockCellFprop, but the gate pre-activations are
+// layer-normalized per gate across the cell dimension before the
+// activations, scaled by gamma and shifted by beta (which replaces the
+// bias vector).  See lstm_ops.cc for the CPUDevice implementation; there
+// is currently no GPUDevice implementation.
+template <typename Device, typename T, bool USE_CUBLAS>
+struct LayerNormLSTMBlockCellFprop : public LSTMBlockCell {
+  LayerNormLSTMBlockCellFprop(const int batch_size, const int input_size,
+                              const int cell_size)
+      : LSTMBlockCell(batch_size, input_size, cell_size) {}
+
+  void operator()(OpKernelContext* ctx, const Device& d,
+                  const float forget_bias, const float cell_clip,
+                  const float epsilon, bool use_peephole,
+                  typename TTypes<T>::ConstMatrix x,
+                  typename TTypes<T>::ConstMatrix cs_prev,
+                  typename TTypes<T>::ConstMatrix h_prev,
+                  typename TTypes<T>::ConstMatrix w,
+                  typename TTypes<T>::ConstVec wci,
+                  typename TTypes<T>::ConstVec wcf,
+                  typename TTypes<T>::ConstVec wco,
+                  typename TTypes<T>::ConstVec gamma,
+                  typename TTypes<T>::ConstVec beta,
+                  typename TTypes<T>::Matrix xh,
+                  typename TTypes<T>::Matrix norm,
+                  typename TTypes<T>::Matrix i, typename TTypes<T>::Matrix cs,
+                  typename TTypes<T>::Matrix f, typename TTypes<T>::Matrix o,
+                  typename TTypes<T>::Matrix ci, typename TTypes<T>::Matrix co,
+                  typename TTypes<T>::Matrix icfo,
+                  typename TTypes<T>::Matrix h);
+};
+
 // See lstm_ops.cc for CPUDevice implementation and lstm_ops_gpu.cu.cc for
 // GPUDevice implementation.
 template <typename Device, typename T, bool USE_CUBLAS>
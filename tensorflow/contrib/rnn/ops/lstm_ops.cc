@@ -105,6 +105,100 @@ co: The cell after the tanh.
 h: The output h vector.
 )doc");
 
+REGISTER_OP("LayerNormLSTMBlockCell")
+    .Input("x: T")
+    .Input("cs_prev: T")
+    .Input("h_prev: T")
+    .Input("w: T")
+    .Input("wci: T")
+    .Input("wcf: T")
+    .Input("wco: T")
+    .Input("gamma: T")
+    .Input("beta: T")
+    .Output("i: T")
+    .Output("cs: T")
+    .Output("f: T")
+    .Output("o: T")
+    .Output("ci: T")
+    .Output("co: T")
+    .Output("h: T")
+    .Attr("forget_bias: float = 1.0")
+    .Attr("cell_clip: float = 3.0")
+    .Attr("epsilon: float = 1e-6")
+    .Attr("use_peephole: bool = false")
+    .Attr("T: {half, float}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle x, cs_prev;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &x));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &cs_prev));
+
+      DimensionHandle batch_size = c->Dim(x, 0);
+      DimensionHandle cell_size = c->Dim(cs_prev, 1);
+      ShapeHandle output = c->Matrix(batch_size, cell_size);
+      for (int i = 0; i < 7; ++i) {
+        c->set_output(i, output);
+      }
+      return tensorflow::Status::OK();
+    })
+    .Doc(R"doc(
+Computes the layer-normalized LSTM cell forward propagation for 1 time step.
+
+Like LSTMBlockCell, this implementation uses 1 weight matrix so all four
+gates share one GEMM, and there's an optional peephole connection.  The
+gate pre-activations are layer-normalized per gate across the cell
+dimension before the activations are applied; gamma and beta are the
+learned scale and shift of the normalization, with beta taking the place
+of the bias vector of LSTMBlockCell.
+
+This kernel op implements the following mathematical equations:
+
+```python
+xh = [x, h_prev]
+[i, f, ci, o] = norm(xh * w) .* gamma + beta
+f = f + forget_bias
+
+if not use_peephole:
+  wci = wcf = wco = 0
+
+i = sigmoid(cs_prev * wci + i)
+f = sigmoid(cs_prev * wcf + f)
+ci = tanh(ci)
+
+cs = ci .* i + cs_prev .* f
+cs = clip(cs, cell_clip)
+
+o = sigmoid(cs * wco + o)
+co = tanh(cs)
+h = co .* o
+```
+
+No gradient is currently defined for this op; it is intended for
+inference graphs.
+
+cell_clip: Value to clip the 'cs' value to.
+epsilon: Small value added to the per-gate variance for numerical stability.
+use_peephole: Whether to use peephole weights.
+forget_bias: The forget gate bias.
+
+x: The input to the LSTM cell, shape (batch_size, num_inputs).
+cs_prev: Value of the cell state at previous time step.
+h_prev: Output of the previous cell at previous time step.
+w: The weight matrix.
+wci: The weight matrix for input gate peephole connection.
+wcf: The weight matrix for forget gate peephole connection.
+wco: The weight matrix for output gate peephole connection.
+gamma: The layer normalization scale vector, shape (4 * cell_size).
+beta: The layer normalization shift vector, shape (4 * cell_size).
+
+i: The input gate.
+cs: The cell state before the tanh.
+f: The forget gate.
+o: The output gate.
+ci: The cell input.
+co: The cell after the tanh.
+h: The output h vector.
+)doc");
+
 REGISTER_OP("LSTMBlockCellGrad")
     .Input("x: T")
     .Input("cs_prev: T")
@@ -60,6 +60,21 @@ TEST_F(LSTMOpsTest, LSTMBlockCell_ShapeFn) {
   INFER_OK(op, "[?,?];[?,?]" + input_suffix, JoinedCopies("[d0_0,d1_1]", 7));
 }
 
+TEST_F(LSTMOpsTest, LayerNormLSTMBlockCell_ShapeFn) {
+  ShapeInferenceTestOp op("LayerNormLSTMBlockCell");
+
+  // Last 7 inputs don't affect shape inference.
+  string input_suffix = strings::StrCat(";", JoinedCopies("?", 7));
+
+  // Rank checks.
+  INFER_ERROR("must be rank 2", op, "[?];?" + input_suffix);
+  INFER_ERROR("must be rank 2", op, "?;[?]" + input_suffix);
+
+  // Output
+  INFER_OK(op, "?;?" + input_suffix, JoinedCopies("[?,?]", 7));
+  INFER_OK(op, "[?,?];[?,?]" + input_suffix, JoinedCopies("[d0_0,d1_1]", 7));
+}
+
 TEST_F(LSTMOpsTest, LSTMBlockCellGrad_ShapeFn) {
   ShapeInferenceTestOp op("LSTMBlockCellGrad");
 
@@ -1210,9 +1210,10 @@ void RdmaTensorResponse::SendContent(const Tensor& in, const TensorProto& proto,
     } else {
       RDMA_LOG(2) << "Encoding proto: " << rm_.name_
                   << " (Size: " << tensor_bytes << ") " << in.DebugString();
-      src_addr_ = malloc(tensor_bytes);
-      mr_ = ibv_reg_mr(channel_->adapter_->pd_, src_addr_, tensor_bytes,
-                       IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+      proto_buffer_ =
+          RdmaMemoryMgr::Singleton().AllocateRegisteredBuffer(tensor_bytes);
+      src_addr_ = proto_buffer_.addr;
+      mr_ = proto_buffer_.mr;
       proto.SerializeToArray(src_addr_, tensor_bytes);
     }
   } else {
@@ -1259,9 +1260,14 @@ void RdmaTensorResponse::Destroy() {
   if (tensor_ != nullptr) {
     delete tensor_;
   }
+  if (proto_buffer_.addr != nullptr) {
+    // Return the proto scratch buffer whether or not the response was
+    // cloned; the old code only released it together with proto_, leaking
+    // the registration whenever the meta-data had not changed.
+    RdmaMemoryMgr::Singleton().ReleaseRegisteredBuffer(proto_buffer_);
+    proto_buffer_ = RdmaMemoryMgr::RegisteredBuffer();
+  }
   if (proto_ != nullptr) {
-    ibv_dereg_mr(mr_);
-    free(src_addr_);
     delete proto_;
   }
   // Remove response from the pending list:
@@ -1408,7 +1414,9 @@ void RdmaMessage::ParseMessage(RdmaMessage& rm, void* buffer) {
 //*****************************************************************************
 
 ibv_mr* RdmaMemoryMgr::FindMemoryRegion(void* addr, size_t length) {
-  mutex_lock l(mrs_mu_);
+  // Every tensor send consults the region table, so reads take only a
+  // shared lock; insertions and evictions are comparatively rare.
+  tf_shared_lock l(mrs_mu_);
   auto iter = std::upper_bound(mrs_.begin(), mrs_.end(), addr, &Comparator);
   if (iter == std::end(mrs_) || iter->get()->addr > addr) {
     return nullptr;
@@ -1422,10 +1430,10 @@ void RdmaMemoryMgr::InsertMemoryRegion(void* addr, size_t length,
   if (length == 0) return;
   ibv_mr* mr = ibv_reg_mr(pd_, addr, length,
                           IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
-  RDMA_LOG(1) << "Insert memory region 0x" << std::hex << mr->rkey << ". ["
-              << addr << "-" << (void*)((uint64_t)addr + length - 1) << "]"
-              << " SIZE: 0x" << length << " (" << allocator_name << ").";
   if (mr != nullptr) {
+    RDMA_LOG(1) << "Insert memory region 0x" << std::hex << mr->rkey << ". ["
+                << addr << "-" << (void*)((uint64_t)addr + length - 1) << "]"
+                << " SIZE: 0x" << length << " (" << allocator_name << ").";
     mutex_lock l(mrs_mu_);
     auto iter = std::upper_bound(mrs_.begin(), mrs_.end(), addr, &Comparator);
     mrs_.insert(iter, {mr, &MRDeleter});
@@ -1439,14 +1447,71 @@ void RdmaMemoryMgr::EvictMemoryRegion(void* addr, size_t length) {
   mutex_lock l(mrs_mu_);
   auto iter = std::upper_bound(mrs_.begin(), mrs_.end(), addr, &Comparator);
   if (iter != std::end(mrs_) && iter->get()->addr == addr) {
-    mrs_.erase(iter);
     RDMA_LOG(1) << "Evict memory region 0x" << std::hex << iter->get()->rkey;
-
+    mrs_.erase(iter);
   } else {
     LOG(WARNING) << "Failed to de-register memory region";
   }
 }
 
+namespace {
+// Cap on the total bytes parked in the registered scratch-buffer pool;
+// buffers released beyond this are de-registered and freed.
+const size_t kMaxFreeRegisteredBufferBytes = 256 * 1024 * 1024;
+
+// Round buffer capacities up to a power of two (with a one-page floor) so
+// that requests of similar size reuse the same pooled buffers.
+size_t RoundUpRegisteredBufferLength(size_t length) {
+  size_t rounded = 4096;
+  while (rounded < length) {
+    rounded *= 2;
+  }
+  return rounded;
+}
+}  // namespace
+
+RdmaMemoryMgr::RegisteredBuffer RdmaMemoryMgr::AllocateRegisteredBuffer(
+    size_t length) {
+  const size_t rounded = RoundUpRegisteredBufferLength(length);
+  {
+    mutex_lock l(free_buffers_mu_);
+    auto iter = free_buffers_.find(rounded);
+    if (iter != free_buffers_.end()) {
+      RegisteredBuffer buffer = iter->second;
+      free_buffers_.erase(iter);
+      free_buffers_bytes_ -= buffer.length;
+      return buffer;
+    }
+  }
+  RegisteredBuffer buffer;
+  buffer.addr = malloc(rounded);
+  buffer.length = rounded;
+  buffer.mr = ibv_reg_mr(pd_, buffer.addr, rounded,
+                         IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+  if (buffer.mr == nullptr) {
+    LOG(WARNING) << "Cannot register scratch buffer of size 0x" << std::hex
+                 << rounded;
+  }
+  return buffer;
+}
+
+void RdmaMemoryMgr::ReleaseRegisteredBuffer(const RegisteredBuffer& buffer) {
+  if (buffer.addr == nullptr) return;
+  if (buffer.mr != nullptr) {
+    mutex_lock l(free_buffers_mu_);
+    if (free_buffers_bytes_ + buffer.length <=
+        kMaxFreeRegisteredBufferBytes) {
+      free_buffers_.insert({buffer.length, buffer});
+      free_buffers_bytes_ += buffer.length;
+      return;
+    }
+  }
+  if (buffer.mr != nullptr) {
+    ibv_dereg_mr(buffer.mr);
+  }
+  free(buffer.addr);
+}
+
 const TensorMetaData* RdmaMemoryMgr::GetTensorMetaData(
     const std::string& tensor_name) {
   mutex_lock l(tensor_meta_data_mu_);
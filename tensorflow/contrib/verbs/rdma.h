@@ -21,6 +21,7 @@ limitations under the License.
 #include <infiniband/verbs.h>
 #include <cstring>  // for memset
 #include <functional>
+#include <map>
 #include <memory>  // for shared_ptr
 #include <queue>
 #include <string>
@@ -204,6 +205,22 @@ class RdmaMemoryMgr {
                           const std::string& allocator_name);
   void EvictMemoryRegion(void* addr, size_t length);
 
+  // Pool of pre-registered scratch buffers, used for responses whose
+  // payload is not a registered tensor buffer (e.g. proto-encoded
+  // tensors).  Registering memory is a syscall plus page-pinning, far too
+  // expensive to do once per response.
+  struct RegisteredBuffer {
+    void* addr = nullptr;
+    size_t length = 0;
+    ibv_mr* mr = nullptr;
+  };
+  // Returns a registered buffer of at least `length` bytes, reusing a
+  // pooled one when available.  Returns a buffer with a null `mr` if
+  // registration fails.
+  RegisteredBuffer AllocateRegisteredBuffer(size_t length);
+  // Returns `buffer` to the pool, or releases it if the pool is full.
+  void ReleaseRegisteredBuffer(const RegisteredBuffer& buffer);
+
   // Tensor meta-data cache
   const TensorMetaData* GetTensorMetaData(const std::string& tensor_name);
   const TensorMetaData* SetTensorMetaData(const std::string& tensor_name,
@@ -227,6 +244,12 @@ class RdmaMemoryMgr {
   // Managed memory regions
   mutex mrs_mu_;
   std::vector<MemoryRegionPtr> mrs_ GUARDED_BY(mrs_mu_);
+
+  // Free pre-registered scratch buffers, keyed by capacity.
+  mutex free_buffers_mu_;
+  std::multimap<size_t, RegisteredBuffer> free_buffers_
+      GUARDED_BY(free_buffers_mu_);
+  size_t free_buffers_bytes_ GUARDED_BY(free_buffers_mu_) = 0;
 };
 
 // RdmaTensorRequest
@@ -355,6 +378,7 @@ class RdmaTensorResponse {
   TensorBuffer* src_buffer_ = nullptr;
   void* src_addr_ = nullptr;
   ibv_mr* mr_ = nullptr;
+  RdmaMemoryMgr::RegisteredBuffer proto_buffer_;
   uint64_t checksum_ = 0;
   bool meta_data_changed_ = false;
 
@@ -55,6 +55,17 @@ void CollectiveParamResolverLocal::CompleteGroupAsync(
 }
 
 namespace {
+// Returns true if the NcclReduce collective is linked into this binary, i.e.
+// the build was configured with NCCL support.
+bool NcclReduceAvailable() {
+  static const bool available = [] {
+    CollectiveImplementationInterface* impl = nullptr;
+    return CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &impl)
+        .ok();
+  }();
+  return available;
+}
+
 string GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   switch (cp->instance.type) {
     case BROADCAST_COLLECTIVE:
@@ -63,9 +74,25 @@ string GetCollectiveName(const CollectiveParams* cp, bool nccl) {
     case REDUCTION_COLLECTIVE: {
       if (nccl) {
         return "NcclReduce";
-      } else {
-        return "RingReduce";
       }
+      // When every participant is a GPU on this task, NCCL moves the data
+      // over NVLink/PCIe directly and beats the staged-copy ring, so prefer
+      // it whenever it is linked in. Multi-task groups still require the
+      // explicit collective_nccl config option since NCCL then needs
+      // out-of-band communicator exchange.
+      if (NcclReduceAvailable() && cp->group.num_tasks == 1 &&
+          cp->group.device_type == DeviceType(DEVICE_GPU)) {
+        return "NcclReduce";
+      }
+      // When the group spans multiple tasks and at least one task has
+      // more than one device, reduce within each task first and exchange
+      // only the per-task partials across the network, instead of
+      // sending the whole tensor around one flat ring.
+      if (cp->group.num_tasks > 1 &&
+          cp->group.group_size > cp->group.num_tasks) {
+        return "HierarchicalTreeReduce";
+      }
+      return "RingReduce";
     }
 
     case GATHER_COLLECTIVE:
@@ -144,6 +171,9 @@ void CollectiveParamResolverLocal::CompleteGroupLocal(
               " but that group doesn't contain that device.");
         } else {
           // This is a new device that has not yet joined the group.
+          // Membership is changing, so any resolved params cached for
+          // this group are stale.
+          InvalidateResolvedParams(gr->group.group_key);
           gr->device_set.insert(device);
           gr->device_list.push_back(device);
           DeviceNameUtils::ParsedName parsed_device;
@@ -629,16 +659,84 @@ void CollectiveParamResolverLocal::CallInitInstanceSharedParams(
       });
 }
 
+// static
+string CollectiveParamResolverLocal::ResolvedParamsKey(
+    const string& device, const CollectiveParams* cp) {
+  // The group key leads so that InvalidateResolvedParams can drop a whole
+  // group by prefix.
+  return strings::StrCat(cp->group.group_key, ";", cp->instance.instance_key,
+                         ";", DataTypeString(cp->instance.data_type), ";",
+                         cp->instance.shape.DebugString(), ";", device);
+}
+
+bool CollectiveParamResolverLocal::LookupResolvedParams(const string& device,
+                                                        CollectiveParams* cp) {
+  const string key = ResolvedParamsKey(device, cp);
+  tf_shared_lock l(resolved_mu_);
+  auto it = resolved_table_.find(key);
+  if (it == resolved_table_.end()) return false;
+  const CollectiveParams* cached = it->second.get();
+  // name, is_source, merge_op and final_op belong to the calling kernel;
+  // everything the resolver computes comes from the cached copy.
+  cp->group = cached->group;
+  cp->instance = cached->instance;
+  cp->task = cached->task;
+  cp->default_rank = cached->default_rank;
+  cp->source_rank = cached->source_rank;
+  cp->subdiv_rank = cached->subdiv_rank;
+  return true;
+}
+
+void CollectiveParamResolverLocal::CacheResolvedParams(
+    const string& device, const CollectiveParams* cp) {
+  std::unique_ptr<CollectiveParams> copy(new CollectiveParams);
+  copy->group = cp->group;
+  copy->instance = cp->instance;
+  copy->task = cp->task;
+  copy->default_rank = cp->default_rank;
+  copy->source_rank = cp->source_rank;
+  copy->subdiv_rank = cp->subdiv_rank;
+  const string key = ResolvedParamsKey(device, cp);
+  mutex_lock l(resolved_mu_);
+  resolved_table_[key] = std::move(copy);
+}
+
+void CollectiveParamResolverLocal::InvalidateResolvedParams(int32 group_key) {
+  const string prefix = strings::StrCat(group_key, ";");
+  mutex_lock l(resolved_mu_);
+  std::vector<string> stale;
+  for (const auto& entry : resolved_table_) {
+    if (str_util::StartsWith(entry.first, prefix)) {
+      stale.push_back(entry.first);
+    }
+  }
+  for (const string& key : stale) {
+    resolved_table_.erase(key);
+  }
+}
+
 void CollectiveParamResolverLocal::CompleteParamsAsync(
     const string& device, CollectiveParams* cp, CancellationManager* cancel_mgr,
     const StatusCallback& done) {
   VLOG(1) << "CompleteParams local " << device << " for " << cp << ": "
           << cp->ToString();
+  // Steady-state fast path: a previous execution of this instance already
+  // resolved everything and membership has not changed since.
+  if (LookupResolvedParams(device, cp)) {
+    done(Status::OK());
+    return;
+  }
   CompleteGroupLocal(
       device, cp,
       [this, device, cp, done](const Status& s, const GroupRec* gr) {
         if (s.ok()) {
-          CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
+          CompleteInstanceLocal(device, gr, cp, cp->is_source,
+                                [this, device, cp, done](const Status& s) {
+                                  if (s.ok()) {
+                                    CacheResolvedParams(device, cp);
+                                  }
+                                  done(s);
+                                });
         } else {
           done(s);
         }
@@ -654,11 +752,33 @@ void CollectiveParamResolverLocal::CompleteInstanceAsync(
                        "intended only for non-distributed deployment."));
 }
 
+namespace {
+// Reductions of at most this many bytes in groups of at least
+// kMinTreeReduceGroupSize participants are latency-bound rather than
+// bandwidth-bound, so the O(log n)-latency tree algorithm is preferred
+// over the O(n)-latency ring.
+constexpr int64 kMaxTreeReduceTensorBytes = 32 * 1024;
+constexpr int32 kMinTreeReduceGroupSize = 8;
+}  // namespace
+
 // TODO(b/111897089): we need a better way to pick the collective
 // implementation.  The ideal way would depend upon the topology and link
 // strength before picking a particular implementation.
 void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
-  cp->instance.impl_details.collective_name = GetCollectiveName(cp, nccl_);
+  string collective_name = GetCollectiveName(cp, nccl_);
+  if (collective_name == "RingReduce" &&
+      cp->group.group_size >= kMinTreeReduceGroupSize) {
+    // The ring moves a chunk between every pair of adjacent ranks, so its
+    // latency grows linearly with group size.  For small tensors in large
+    // groups use the tree reducer instead, which degenerates to a pure
+    // binary-tree all-reduce when the group has a single task.
+    const int64 tensor_bytes = cp->instance.shape.num_elements() *
+                               DataTypeSize(cp->instance.data_type);
+    if (tensor_bytes <= kMaxTreeReduceTensorBytes) {
+      collective_name = "HierarchicalTreeReduce";
+    }
+  }
+  cp->instance.impl_details.collective_name = std::move(collective_name);
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
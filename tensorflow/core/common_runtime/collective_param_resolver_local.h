@@ -227,6 +227,26 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
   void CallbackWithStatus(const InstanceRecCallback& done, InstanceRec* irec)
       LOCKS_EXCLUDED(irec->out_mu);
 
+  // Key identifying one fully-resolved parameter set in resolved_table_:
+  // group, instance, dtype+shape and the requesting device (default_rank
+  // and task.is_local are device-specific).
+  static string ResolvedParamsKey(const string& device,
+                                  const CollectiveParams* cp);
+
+  // If a fully-resolved parameter set for (device, *cp) is cached, copies
+  // it into *cp and returns true.  Steady-state steps hit this under a
+  // shared lock and skip group/instance resolution entirely.
+  bool LookupResolvedParams(const string& device, CollectiveParams* cp)
+      LOCKS_EXCLUDED(resolved_mu_);
+
+  // Stores a copy of the fully-resolved *cp for future executions.
+  void CacheResolvedParams(const string& device, const CollectiveParams* cp)
+      LOCKS_EXCLUDED(resolved_mu_);
+
+  // Drops every cached parameter set belonging to group_key.  Called when
+  // the membership of that group changes.
+  void InvalidateResolvedParams(int32 group_key) LOCKS_EXCLUDED(resolved_mu_);
+
   const bool nccl_;
   const DeviceMgr* dev_mgr_;
   DeviceResolverInterface* dev_resolver_;  // Not owned.
@@ -237,6 +257,13 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
   mutex instance_mu_;
   gtl::FlatMap<int32, std::unique_ptr<InstanceRec>> instance_table_
       GUARDED_BY(instance_mu_);
+  // Fully-resolved parameter sets from completed resolutions, so that
+  // repeat executions of the same instance bypass the group and instance
+  // bookkeeping above.  Read under a shared lock; written only on the
+  // first resolution of an instance and on invalidation.
+  mutable mutex resolved_mu_;
+  gtl::FlatMap<string, std::unique_ptr<CollectiveParams>> resolved_table_
+      GUARDED_BY(resolved_mu_);
 };
 
 }  // namespace tensorflow
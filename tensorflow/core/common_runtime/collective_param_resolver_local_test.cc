@@ -197,6 +197,56 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
     EXPECT_FALSE(cps[i].is_source);
     EXPECT_EQ(cps[i].default_rank, i);
     EXPECT_TRUE(cps[i].instance.same_num_devices_per_task);
+    // The group is too small for the tree reducer to be worthwhile.
+    EXPECT_EQ("RingReduce", cps[i].instance.impl_details.collective_name);
+  }
+}
+
+TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReductionCached) {
+  // Resolve the same instance twice; the second round should be served
+  // from the resolved-params cache and produce identical results.
+  for (int round = 0; round < 2; ++round) {
+    CollectiveParams cps[NUM_DEVS];
+    Status statuses[NUM_DEVS];
+    Notification note[NUM_DEVS];
+    for (int i = 0; i < NUM_DEVS; ++i) {
+      CollectiveParams* cp = &cps[i];
+      cp->group.group_key = 1;
+      cp->group.group_size = 3;
+      cp->group.device_type = DeviceType("CPU");
+      cp->group.num_tasks = 1;
+      cp->instance.instance_key = 7;
+      cp->instance.type = REDUCTION_COLLECTIVE;
+      cp->instance.data_type = DataType(DT_FLOAT);
+      cp->instance.shape = TensorShape({5});
+      cp->instance.device_names.push_back(
+          strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i));
+      cp->instance.impl_details.subdiv_offsets.push_back(0);
+      cp->is_source = false;
+      Env::Default()->SchedClosure([this, i, cp, &note, &statuses]() {
+        prl_->CompleteParamsAsync(cp->instance.device_names[0], cp,
+                                  nullptr /*CancellationManager*/,
+                                  [&statuses, &note, i](const Status& s) {
+                                    statuses[i] = s;
+                                    note[i].Notify();
+                                  });
+      });
+    }
+    for (int i = 0; i < NUM_DEVS; ++i) {
+      note[i].WaitForNotification();
+    }
+    for (int i = 0; i < NUM_DEVS; ++i) {
+      TF_ASSERT_OK(statuses[i]);
+      ASSERT_EQ(cps[i].instance.device_names.size(), 3);
+      for (int j = 0; j < NUM_DEVS; ++j) {
+        EXPECT_EQ(
+            strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", j),
+            cps[i].instance.device_names[j]);
+        EXPECT_TRUE(cps[i].task.is_local[j]);
+      }
+      EXPECT_EQ(cps[i].default_rank, i);
+      EXPECT_EQ("RingReduce", cps[i].instance.impl_details.collective_name);
+    }
   }
 }
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <list>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -36,10 +37,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -558,6 +562,113 @@ bool ReplaceTensorWithConstant(
   return true;
 }
 
+// Fingerprints the extracted constant graph and its fetch list.  Nodes are
+// hashed in id order (deterministic for a given input graph) by op type,
+// attrs and in-edges; node names are excluded so renamed copies of the same
+// subgraph fingerprint identically.  Two graphs with equal fingerprints
+// evaluate to the same fetched tensors.
+uint64 ConstantGraphFingerprint(const Graph& constant_graph,
+                                const std::vector<NodeAndOutput>& fetches) {
+  uint64 h = 0xDECAFCAFFE;
+  for (int id = 0; id < constant_graph.num_node_ids(); ++id) {
+    const Node* n = constant_graph.FindNodeId(id);
+    if (n == nullptr) continue;
+    h = Hash64(n->type_string().data(), n->type_string().size(), h);
+    std::vector<std::pair<string, string>> attrs;
+    for (const auto& attr : n->def().attr()) {
+      attrs.emplace_back(attr.first, attr.second.SerializeAsString());
+    }
+    std::sort(attrs.begin(), attrs.end());
+    for (const auto& attr : attrs) {
+      h = Hash64(attr.first.data(), attr.first.size(), h);
+      h = Hash64(attr.second.data(), attr.second.size(), h);
+    }
+    for (const Edge* e : n->in_edges()) {
+      h = Hash64Combine(h, Hash64Combine(e->src()->id(),
+                                         Hash64Combine(e->src_output(),
+                                                       e->dst_input())));
+    }
+  }
+  for (const NodeAndOutput& fetch : fetches) {
+    h = Hash64Combine(h, Hash64Combine(fetch.first->id(), fetch.second));
+  }
+  return h;
+}
+
+// Process-wide LRU cache mapping constant-graph fingerprints to the folded
+// tensors, so repeated loads of models sharing constant subgraphs skip
+// re-evaluation.  Capacity in MB is read from
+// TF_CONSTANT_FOLDING_CACHE_SIZE_MB (default 0: disabled).
+class ConstantFoldingCache {
+ public:
+  static ConstantFoldingCache* Global() {
+    static ConstantFoldingCache* cache = new ConstantFoldingCache;
+    return cache;
+  }
+
+  bool enabled() const { return capacity_bytes_ > 0; }
+
+  // If 'key' is present, copies the cached tensors into '*outputs', marks
+  // the entry most-recently-used and returns true.
+  bool Lookup(uint64 key, std::vector<Tensor>* outputs) {
+    mutex_lock l(mu_);
+    auto it = cache_.find(key);
+    if (it == cache_.end()) return false;
+    lru_.erase(it->second.lru_position);
+    lru_.push_front(key);
+    it->second.lru_position = lru_.begin();
+    *outputs = it->second.outputs;
+    return true;
+  }
+
+  // Inserts 'outputs' under 'key', evicting least-recently-used entries
+  // until the cache fits the configured capacity.  Entries larger than the
+  // whole cache are not stored.
+  void Insert(uint64 key, const std::vector<Tensor>& outputs) {
+    int64 bytes = 0;
+    for (const Tensor& t : outputs) bytes += t.TotalBytes();
+    if (bytes > capacity_bytes_) return;
+    mutex_lock l(mu_);
+    if (cache_.count(key) > 0) return;
+    while (total_bytes_ + bytes > capacity_bytes_ && !lru_.empty()) {
+      const uint64 evict_key = lru_.back();
+      lru_.pop_back();
+      auto evict_it = cache_.find(evict_key);
+      total_bytes_ -= evict_it->second.bytes;
+      cache_.erase(evict_it);
+    }
+    lru_.push_front(key);
+    Entry& entry = cache_[key];
+    entry.outputs = outputs;
+    entry.bytes = bytes;
+    entry.lru_position = lru_.begin();
+    total_bytes_ += bytes;
+  }
+
+ private:
+  ConstantFoldingCache() {
+    int64 capacity_mb = 0;
+    Status s = ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_CACHE_SIZE_MB", 0,
+                                   &capacity_mb);
+    if (!s.ok()) {
+      LOG(ERROR) << "ConstantFoldingCache: " << s.error_message();
+    }
+    capacity_bytes_ = capacity_mb * (1LL << 20);
+  }
+
+  struct Entry {
+    std::vector<Tensor> outputs;
+    int64 bytes;
+    std::list<uint64>::iterator lru_position;
+  };
+
+  int64 capacity_bytes_;
+  mutex mu_;
+  std::unordered_map<uint64, Entry> cache_ GUARDED_BY(mu_);
+  std::list<uint64> lru_ GUARDED_BY(mu_);  // Most recent first.
+  int64 total_bytes_ GUARDED_BY(mu_) = 0;
+};
+
 }  // namespace
 
 Status ConstantFold(const ConstantFoldingOptions& opts,
@@ -616,10 +727,19 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
                const std::pair<NodeAndOutput, Node*>& n2) {
               return n1.first.first->name() < n2.first.first->name();
             });
+  std::vector<NodeAndOutput> fetches_in_constant_graph;
   for (auto n : tensors_to_fetch_sorted) {
     tensors_to_fetch_names.push_back(
         strings::StrCat(n.first.first->name(), ":", n.first.second));
     tensors_to_replace.push_back({n.second, n.first.second});
+    fetches_in_constant_graph.push_back(n.first);
+  }
+
+  ConstantFoldingCache* cache = ConstantFoldingCache::Global();
+  uint64 cache_key = 0;
+  if (cache->enabled()) {
+    cache_key =
+        ConstantGraphFingerprint(*constant_graph, fetches_in_constant_graph);
   }
 
   auto graph_runner = std::unique_ptr<GraphRunner>(new GraphRunner(env));
@@ -631,13 +751,22 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
     graph_runner.reset(nullptr);
   });
 
-  Status s =
-      graph_runner->Run(constant_graph.get(), function_library, {} /* inputs*/,
-                        tensors_to_fetch_names, &outputs);
-  if (!s.ok()) {
-    VLOG(1) << "Could not fetch constants: " << s;
-    *was_mutated = false;
-    return s;
+  if (!cache->enabled() || !cache->Lookup(cache_key, &outputs)) {
+    Status s = graph_runner->Run(constant_graph.get(), function_library,
+                                 {} /* inputs*/, tensors_to_fetch_names,
+                                 &outputs);
+    if (!s.ok()) {
+      VLOG(1) << "Could not fetch constants: " << s;
+      *was_mutated = false;
+      return s;
+    }
+    // GraphRunner deep-copies its outputs, so the cached tensors do not
+    // reference any per-run allocator.
+    if (cache->enabled()) {
+      cache->Insert(cache_key, outputs);
+    }
+  } else {
+    VLOG(1) << "Constant folding cache hit for fingerprint " << cache_key;
   }
 
   // Fetch the constant tensors and replace the corresponding tensors in the
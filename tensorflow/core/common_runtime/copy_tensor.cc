@@ -15,14 +15,23 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <atomic>
+#include <map>
+#include <memory>
+#include <tuple>
 #include <utility>
 #include <vector>
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 
@@ -112,6 +121,195 @@ void CopyHostToDevice(const Tensor* input, Allocator* cpu_allocator,
   }
 }
 
+// Coalesces small host-to-device tensor copies that are issued close together
+// in time into a single staging buffer and one DMA transfer. Each small copy
+// otherwise pays a full transfer-launch latency, which dominates for graphs
+// that move many sub-32KB tensors per step. Copies destined for the same
+// (device, device context) pair are queued for a short window; at flush time
+// their bytes are packed into one pinned staging tensor, transferred with a
+// single CopyCPUTensorToDevice call, and the output tensors are materialized
+// as bitcast views at aligned offsets into the packed device buffer, so no
+// device-side scatter pass is needed. Ordering relative to other work on the
+// destination stream is preserved since the packed copy goes through the same
+// device context as the copies it replaces.
+//
+// Disabled by default; enabled by setting TF_COALESCE_SMALL_H2D_COPIES=1.
+class HostToDeviceCopyCoalescer {
+ public:
+  // Returns the process-wide coalescer, or nullptr when disabled.
+  static HostToDeviceCopyCoalescer* Get() {
+    static HostToDeviceCopyCoalescer* instance =
+        []() -> HostToDeviceCopyCoalescer* {
+      const char* enabled = getenv("TF_COALESCE_SMALL_H2D_COPIES");
+      if (enabled == nullptr || strcmp(enabled, "1") != 0) {
+        return nullptr;
+      }
+      return new HostToDeviceCopyCoalescer;
+    }();
+    return instance;
+  }
+
+  // Whether `input` is eligible for coalescing: a small, non-zero-sized,
+  // DMA-copyable tensor of a fixed-size dtype (bitcast views require a
+  // nonzero DataTypeSize).
+  bool ShouldCoalesce(const Tensor& input) const {
+    if (input.dtype() == DT_VARIANT || DataTypeSize(input.dtype()) == 0 ||
+        !DMAHelper::CanUseDMA(&input)) {
+      return false;
+    }
+    const int64 bytes = input.TotalBytes();
+    return bytes > 0 && bytes <= max_tensor_bytes_;
+  }
+
+  // Queues one copy. `done` is invoked after the batched transfer completes;
+  // `*output` is valid once `done` is called with an OK status.
+  void Enqueue(const Tensor& input, Allocator* cpu_allocator,
+               Allocator* out_allocator, Device* dst, Tensor* output,
+               DeviceContext* recv_dev_context, StatusCallback done) {
+    const BatchKey key(dst, recv_dev_context, cpu_allocator, out_allocator);
+    Batch batch_to_flush;
+    bool flush_now = false;
+    {
+      mutex_lock l(mu_);
+      Batch& batch = batches_[key];
+      if (batch.copies.empty()) {
+        HostToDeviceCopyCoalescer* coalescer = this;
+        Env::Default()->SchedClosureAfter(
+            window_micros_, [coalescer, key]() { coalescer->FlushKey(key); });
+      }
+      PendingCopy copy;
+      copy.input = input;
+      copy.output = output;
+      copy.done = std::move(done);
+      batch.copies.push_back(std::move(copy));
+      batch.total_bytes += Align(input.TotalBytes());
+      if (batch.total_bytes >= kMaxBatchBytes) {
+        batch_to_flush = std::move(batch);
+        batches_.erase(key);
+        flush_now = true;
+      }
+    }
+    if (flush_now) {
+      FlushBatch(std::move(batch_to_flush), key);
+    }
+  }
+
+ private:
+  // Batches larger than this are flushed without waiting for the window to
+  // close, bounding staging-buffer sizes.
+  static const int64 kMaxBatchBytes = 2 << 20;
+
+  struct PendingCopy {
+    Tensor input;
+    Tensor* output;
+    StatusCallback done;
+  };
+  struct Batch {
+    std::vector<PendingCopy> copies;
+    int64 total_bytes = 0;
+  };
+  // Copies may only be packed together if they share the destination device
+  // and device context as well as both allocators.
+  typedef std::tuple<Device*, DeviceContext*, Allocator*, Allocator*> BatchKey;
+
+  HostToDeviceCopyCoalescer() {
+    max_tensor_bytes_ = 32 << 10;
+    window_micros_ = 50;
+    const char* max_bytes_str = getenv("TF_COALESCE_SMALL_H2D_MAX_BYTES");
+    if (max_bytes_str != nullptr) {
+      strings::safe_strto64(max_bytes_str, &max_tensor_bytes_);
+    }
+    const char* window_str = getenv("TF_COALESCE_SMALL_H2D_WINDOW_MICROS");
+    if (window_str != nullptr) {
+      strings::safe_strto64(window_str, &window_micros_);
+    }
+  }
+
+  // Offsets into the packed buffer are aligned so that the bitcast views
+  // satisfy the usual allocator alignment guarantees.
+  static int64 Align(int64 bytes) {
+    return (bytes + (Allocator::kAllocatorAlignment - 1)) &
+           ~static_cast<int64>(Allocator::kAllocatorAlignment - 1);
+  }
+
+  // Flushes whatever batch is pending for `key`, if any. Called from the
+  // window timer; a no-op if the batch was already flushed by size.
+  void FlushKey(const BatchKey& key) {
+    Batch batch;
+    {
+      mutex_lock l(mu_);
+      auto iter = batches_.find(key);
+      if (iter == batches_.end()) {
+        return;
+      }
+      batch = std::move(iter->second);
+      batches_.erase(iter);
+    }
+    FlushBatch(std::move(batch), key);
+  }
+
+  void FlushBatch(Batch batch, const BatchKey& key) {
+    Device* dst = std::get<0>(key);
+    DeviceContext* recv_dev_context = std::get<1>(key);
+    Allocator* cpu_allocator = std::get<2>(key);
+    Allocator* out_allocator = std::get<3>(key);
+
+    // Keeps the staging tensors and the pending callbacks alive until the
+    // device has consumed the packed buffer.
+    struct FlushState {
+      std::vector<PendingCopy> copies;
+      Tensor staging;
+      Tensor packed;
+    };
+    auto state = std::make_shared<FlushState>();
+    state->copies = std::move(batch.copies);
+
+    if (state->copies.size() == 1) {
+      // Nothing to pack; issue the copy directly as CopyHostToDevice would.
+      PendingCopy& copy = state->copies[0];
+      *copy.output = Tensor(out_allocator, copy.input.dtype(),
+                            copy.input.shape());
+      recv_dev_context->CopyCPUTensorToDevice(
+          &copy.input, dst, copy.output, [state](const Status& s) {
+            state->copies[0].done(s);
+          });
+      return;
+    }
+
+    state->staging =
+        Tensor(cpu_allocator, DT_UINT8, TensorShape({batch.total_bytes}));
+    state->packed =
+        Tensor(out_allocator, DT_UINT8, TensorShape({batch.total_bytes}));
+
+    char* staging_base = reinterpret_cast<char*>(DMAHelper::base(&state->staging));
+    int64 offset = 0;
+    for (PendingCopy& copy : state->copies) {
+      const int64 bytes = copy.input.TotalBytes();
+      memcpy(staging_base + offset, DMAHelper::base(&copy.input), bytes);
+      Tensor slice = state->packed.Slice(offset, offset + bytes);
+      TF_CHECK_OK(copy.output->BitcastFrom(slice, copy.input.dtype(),
+                                           copy.input.shape()));
+      offset += Align(bytes);
+    }
+    VLOG(2) << "Coalescing " << state->copies.size()
+            << " host-to-device copies (" << batch.total_bytes
+            << " bytes) for " << dst->name();
+
+    recv_dev_context->CopyCPUTensorToDevice(
+        &state->staging, dst, &state->packed, [state](const Status& s) {
+          for (PendingCopy& copy : state->copies) {
+            copy.done(s);
+          }
+        });
+  }
+
+  int64 max_tensor_bytes_;
+  int64 window_micros_;
+
+  mutex mu_;
+  std::map<BatchKey, Batch> batches_ GUARDED_BY(mu_);
+};
+
 void CopyDeviceToHost(const Tensor* input, Allocator* cpu_allocator,
                       Allocator* out_allocator, StringPiece edge_name,
                       Device* src, Tensor* output,
@@ -333,6 +531,12 @@ void CopyTensor::ViaDMA(StringPiece edge_name, DeviceContext* send_dev_context,
   // E.g., cpu -> gpu
   if (!non_cpu_src && non_cpu_dst) {
     // Host to Device copy.
+    HostToDeviceCopyCoalescer* coalescer = HostToDeviceCopyCoalescer::Get();
+    if (coalescer != nullptr && coalescer->ShouldCoalesce(*input)) {
+      coalescer->Enqueue(*input, cpu_allocator, out_allocator, dst, output,
+                         recv_dev_context, std::move(done));
+      return;
+    }
     CopyHostToDevice(input, cpu_allocator, out_allocator, edge_name, dst,
                      output, recv_dev_context, std::move(done));
     return;
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
+#include "tensorflow/core/common_runtime/kernel_timing.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
@@ -50,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/subgraph.h"
 #include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/refcount.h"
@@ -57,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -79,14 +82,55 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// Number of threads hosting the blocking bodies of RunCallableAsync()
+// calls, and therefore the number of steps one session pipelines before
+// further async requests queue up behind them.
+const int kNumAsyncRunThreads = 2;
+
+// Fingerprints a feed/fetch/target signature without materializing the
+// string key used by the executors_ map.  Order-sensitive, matching the
+// fast (unsorted) lookup path in GetOrCreateExecutors.
+uint64 SignatureFingerprint(gtl::ArraySlice<string> inputs,
+                            gtl::ArraySlice<string> outputs,
+                            gtl::ArraySlice<string> target_nodes) {
+  uint64 h = 0xDECAFCAFFE;
+  for (const string& name : inputs) {
+    h = Hash64(name.data(), name.size(), h);
+  }
+  h = Hash64Combine(h, inputs.size());
+  for (const string& name : outputs) {
+    h = Hash64(name.data(), name.size(), h);
+  }
+  h = Hash64Combine(h, outputs.size());
+  for (const string& name : target_nodes) {
+    h = Hash64(name.data(), name.size(), h);
+  }
+  return h;
+}
+
+// Returns true iff 'a' and 'b' contain the same names in the same order.
+bool NamesMatch(gtl::ArraySlice<string> a, const std::vector<string>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i] != b[i]) return false;
+  }
+  return true;
+}
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
-    thread::ThreadPool** pool, bool* owned) {
+    thread::ThreadPool** pool, bool* owned,
+    std::unique_ptr<ThreadPoolQuota>* quota) {
   int32 num_threads = thread_pool_options.num_threads();
   if (num_threads == 0) {
     num_threads = NumInterOpThreadsFromSessionOptions(options);
   }
+  const int32 max_concurrency = thread_pool_options.max_concurrency();
+  if (max_concurrency < 0) {
+    return errors::InvalidArgument("max_concurrency must be non-negative: ",
+                                   max_concurrency);
+  }
   const string& name = thread_pool_options.global_name();
   if (name.empty()) {
     // Session-local threadpool.
@@ -95,6 +139,9 @@ Status NewThreadPoolFromThreadPoolOptions(
     *pool = new thread::ThreadPool(
         options.env, strings::StrCat("Compute", pool_number), num_threads);
     *owned = true;
+    if (max_concurrency > 0 && max_concurrency < num_threads) {
+      quota->reset(new ThreadPoolQuota(*pool, max_concurrency));
+    }
     return Status::OK();
   }
 
@@ -120,6 +167,11 @@ Status NewThreadPoolFromThreadPoolOptions(
   }
   *owned = false;
   *pool = mvalue->second;
+  // The quota is per-session even though the pool is shared, so sessions
+  // naming the same pool may carry different concurrency caps.
+  if (max_concurrency > 0 && max_concurrency < num_threads) {
+    quota->reset(new ThreadPoolQuota(*pool, max_concurrency));
+  }
   return Status::OK();
 }
 
@@ -230,6 +282,7 @@ std::atomic_int_fast64_t DirectSession::step_id_counter_(1);
 // devices that run concurrently, in which case we will need to
 // revisit this decision.
 void DirectSession::SchedClosure(thread::ThreadPool* pool,
+                                 ThreadPoolQuota* quota,
                                  std::function<void()> c) {
 // TODO(sanjay): Get rid of __ANDROID__ path
 #ifdef __ANDROID__
@@ -240,7 +293,9 @@ void DirectSession::SchedClosure(thread::ThreadPool* pool,
   // safe given the reasoning above.
   c();
 #else
-  if (pool != nullptr) {
+  if (quota != nullptr) {
+    quota->Schedule(std::move(c));
+  } else if (pool != nullptr) {
     pool->Schedule(std::move(c));
   } else {
     c();
@@ -285,16 +340,20 @@ DirectSession::DirectSession(const SessionOptions& options,
     for (int i = 0; i < thread_pool_size; ++i) {
       thread::ThreadPool* pool = nullptr;
       bool owned = false;
+      std::unique_ptr<ThreadPoolQuota> quota;
       init_error_.Update(NewThreadPoolFromThreadPoolOptions(
           options_, options_.config.session_inter_op_thread_pool(i), i, &pool,
-          &owned));
+          &owned, &quota));
       thread_pools_.emplace_back(pool, owned);
+      thread_pool_quotas_.push_back(std::move(quota));
     }
   } else if (options_.config.use_per_session_threads()) {
     thread_pools_.emplace_back(NewThreadPoolFromSessionOptions(options_),
                                true /* owned */);
+    thread_pool_quotas_.emplace_back();
   } else {
     thread_pools_.emplace_back(GlobalThreadPool(options), false /* owned */);
+    thread_pool_quotas_.emplace_back();
   }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
@@ -554,8 +613,19 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
   }
   if (do_trace || update_cost_model ||
       run_options.report_tensor_allocations_upon_oom()) {
-    run_state.collector.reset(
-        new StepStatsCollector(run_metadata->mutable_step_stats()));
+    // Sample a subset of nodes when the collector only feeds the cost
+    // model; explicit traces and OOM reports must stay complete.
+    float node_sample_rate = 1.0f;
+    if (update_cost_model && !do_trace &&
+        !run_options.report_tensor_allocations_upon_oom()) {
+      const float configured_rate =
+          options_.config.graph_options().build_cost_model_sample_rate();
+      if (configured_rate > 0.0f && configured_rate < 1.0f) {
+        node_sample_rate = configured_rate;
+      }
+    }
+    run_state.collector.reset(new StepStatsCollector(
+        run_metadata->mutable_step_stats(), node_sample_rate));
     args.stats_collector = run_state.collector.get();
   }
 
@@ -599,16 +669,18 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
     return errors::Cancelled("Run call was cancelled");
   }
 
+  const int32 requested_pool = run_options.inter_op_thread_pool();
   thread::ThreadPool* pool =
-      run_options.inter_op_thread_pool() >= 0
-          ? thread_pools_[run_options.inter_op_thread_pool()].first
-          : nullptr;
+      requested_pool >= 0 ? thread_pools_[requested_pool].first : nullptr;
+  ThreadPoolQuota* pool_quota =
+      requested_pool >= 0 ? thread_pool_quotas_[requested_pool].get() : nullptr;
 
   if (pool == nullptr) {
     // We allow using the caller thread only when having a single executor
     // specified.
     if (executors_and_keys->items.size() > 1) {
       pool = thread_pools_[0].first;
+      pool_quota = thread_pool_quotas_[0].get();
     } else {
       VLOG(1) << "Executing Session::Run() synchronously!";
     }
@@ -631,8 +703,8 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
       handler_ptr->ScheduleInterOpClosure(std::move(c));
     };
   } else {
-    default_runner = [this, pool](Executor::Args::Closure c) {
-      SchedClosure(pool, std::move(c));
+    default_runner = [this, pool, pool_quota](Executor::Args::Closure c) {
+      SchedClosure(pool, pool_quota, std::move(c));
     };
   }
 
@@ -648,7 +720,7 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
       args.runner = default_runner;
     } else {
       args.runner = [this, device_thread_pool](Executor::Args::Closure c) {
-        SchedClosure(device_thread_pool, std::move(c));
+        SchedClosure(device_thread_pool, nullptr /* quota */, std::move(c));
       };
     }
     item.executor->RunAsync(args, barrier->Get());
@@ -720,7 +792,11 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
       exec_and_lib.graph->ToGraphDef(partition_graph_def);
     }
   }
-  metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
+  const uint64 elapsed_usecs = options_.env->NowMicros() - start_time_usecs;
+  metrics::UpdateGraphExecTime(elapsed_usecs);
+  if (KernelTimingCollector* collector = KernelTimingCollector::Get()) {
+    collector->RecordStep(step_id, start_time_usecs, elapsed_usecs);
+  }
 
   return Status::OK();
 }
@@ -846,6 +922,7 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
 
   // RunOptions is not available in PRunSetup, so use thread pool 0.
   thread::ThreadPool* pool = thread_pools_[0].first;
+  ThreadPoolQuota* pool_quota = thread_pool_quotas_[0].get();
 
   // Check if we already have an executor for these arguments.
   ExecutorsAndKeys* executors_and_keys;
@@ -891,8 +968,8 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   // because RunOptions is not passed in so we can't know whether
   // their use is intended.
   args.collective_executor = nullptr;
-  args.runner = [this, pool](Executor::Args::Closure c) {
-    SchedClosure(pool, std::move(c));
+  args.runner = [this, pool, pool_quota](Executor::Args::Closure c) {
+    SchedClosure(pool, pool_quota, std::move(c));
   };
   args.session_state = &session_state_;
   args.session_handle = session_handle_;
@@ -1288,6 +1365,8 @@ Status DirectSession::CreateExecutors(
       if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
         delete kernel;
     };
+    params.use_batched_dispatch =
+        options_.config.experimental().use_batched_executor_dispatch();
 
     optimizer.Optimize(lib, options_.env, device, &partition_graph,
                        /*shape_map=*/nullptr);
@@ -1350,6 +1429,20 @@ Status DirectSession::CreateExecutors(
   return Status::OK();
 }
 
+void DirectSession::RememberSignature(
+    uint64 fingerprint, gtl::ArraySlice<string> inputs,
+    gtl::ArraySlice<string> outputs, gtl::ArraySlice<string> target_nodes,
+    std::shared_ptr<ExecutorsAndKeys> ek) {
+  ExecutorSignature& sig = executors_by_signature_[fingerprint];
+  // On a fingerprint collision keep the existing entry; the colliding
+  // signature falls back to the string-keyed lookup.
+  if (sig.executors_and_keys != nullptr) return;
+  sig.inputs.assign(inputs.begin(), inputs.end());
+  sig.outputs.assign(outputs.begin(), outputs.end());
+  sig.targets.assign(target_nodes.begin(), target_nodes.end());
+  sig.executors_and_keys = std::move(ek);
+}
+
 Status DirectSession::GetOrCreateExecutors(
     gtl::ArraySlice<string> inputs, gtl::ArraySlice<string> outputs,
     gtl::ArraySlice<string> target_nodes, ExecutorsAndKeys** executors_and_keys,
@@ -1365,6 +1458,26 @@ Status DirectSession::GetOrCreateExecutors(
         run_state_args->debug_options.debug_tensor_watch_opts());
   }
 
+  // Fastest lookup path: hash the signature instead of building a key
+  // string, so steady-state Run() calls do no allocation here.  Skipped
+  // when a handle string is needed (memory logging, partial runs) or when
+  // the debugger is attached, since those paths need the string key below.
+  const bool can_use_signature_lookup =
+      handle_name_counter_value < 0 && debug_tensor_watches_summary.empty();
+  uint64 signature_fingerprint = 0;
+  if (can_use_signature_lookup) {
+    signature_fingerprint = SignatureFingerprint(inputs, outputs, target_nodes);
+    mutex_lock l(executor_lock_);
+    auto it = executors_by_signature_.find(signature_fingerprint);
+    if (it != executors_by_signature_.end() &&
+        NamesMatch(inputs, it->second.inputs) &&
+        NamesMatch(outputs, it->second.outputs) &&
+        NamesMatch(target_nodes, it->second.targets)) {
+      *executors_and_keys = it->second.executors_and_keys.get();
+      return Status::OK();
+    }
+  }
+
   // Fast lookup path, no sorting.
   const string key = strings::StrCat(
       str_util::Join(inputs, ","), "->", str_util::Join(outputs, ","), "/",
@@ -1381,6 +1494,10 @@ Status DirectSession::GetOrCreateExecutors(
     mutex_lock l(executor_lock_);  // could use reader lock
     auto it = executors_.find(key);
     if (it != executors_.end()) {
+      if (can_use_signature_lookup) {
+        RememberSignature(signature_fingerprint, inputs, outputs, target_nodes,
+                          it->second);
+      }
       *executors_and_keys = it->second.get();
       return Status::OK();
     }
@@ -1455,6 +1572,10 @@ Status DirectSession::GetOrCreateExecutors(
   // Insert the value under the original key, so the fast path lookup will work
   // if the user uses the same order of inputs, outputs, and targets again.
   executors_.emplace(key, insert_result.first->second);
+  if (can_use_signature_lookup) {
+    RememberSignature(signature_fingerprint, inputs, outputs, target_nodes,
+                      insert_result.first->second);
+  }
   *executors_and_keys = insert_result.first->second.get();
 
   return Status::OK();
@@ -1574,15 +1695,15 @@ Status DirectSession::CreateGraphs(
     }
   }
 
-  for (const auto& partition : partitions) {
+  for (auto& partition : partitions) {
     std::unique_ptr<Graph> device_graph(
         new Graph(client_graph->flib_def.get()));
     GraphConstructorOptions device_opts;
     // There are internal operations (e.g., send/recv) that we now allow.
     device_opts.allow_internal_ops = true;
     device_opts.expect_device_spec = true;
-    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(device_opts, partition.second,
-                                              device_graph.get()));
+    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
+        device_opts, std::move(partition.second), device_graph.get()));
     outputs->emplace(partition.first, std::move(device_graph));
   }
 
@@ -1742,6 +1863,62 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   return Status::OK();
 }
 
+Status DirectSession::Warmup(const CallableOptions& callable_options) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  TF_RETURN_IF_ERROR(CheckGraphCreated("Warmup()"));
+
+  // Construct the executors (and with them every kernel) for this
+  // signature.  They are retained in the executor cache, so subsequent
+  // Run() calls with the same feeds/fetches find them ready.
+  std::vector<string> feeds(callable_options.feed().begin(),
+                            callable_options.feed().end());
+  std::vector<string> fetches(callable_options.fetch().begin(),
+                              callable_options.fetch().end());
+  std::vector<string> targets(callable_options.target().begin(),
+                              callable_options.target().end());
+  ExecutorsAndKeys* executors_and_keys;
+  RunStateArgs run_state_args(callable_options.run_options().debug_options());
+  TF_RETURN_IF_ERROR(GetOrCreateExecutors(feeds, fetches, targets,
+                                          &executors_and_keys,
+                                          &run_state_args));
+
+  // Pre-grow each device allocator to the configured high-water mark by
+  // taking and releasing one large allocation, so BFC regions are carved
+  // out of the system allocator now rather than during the first request.
+  int64 warmup_alloc_mb = 0;
+  Status s =
+      ReadInt64FromEnvVar("TF_SESSION_WARMUP_ALLOC_MB", 0, &warmup_alloc_mb);
+  if (!s.ok()) {
+    LOG(ERROR) << "Warmup: " << s.error_message();
+  }
+  if (warmup_alloc_mb > 0) {
+    for (Device* device : devices_) {
+      Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+      void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                         warmup_alloc_mb << 20);
+      if (ptr != nullptr) {
+        allocator->DeallocateRaw(ptr);
+      } else {
+        LOG(WARNING) << "Warmup: could not reserve " << warmup_alloc_mb
+                     << "MB on " << device->name();
+      }
+    }
+  }
+
+  // Run one no-op closure per worker so every inter-op thread has been
+  // created and scheduled at least once before the first step.
+  for (const auto& pool_and_owned : thread_pools_) {
+    thread::ThreadPool* pool = pool_and_owned.first;
+    const int num_threads = pool->NumThreads();
+    BlockingCounter counter(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      pool->Schedule([&counter]() { counter.DecrementCount(); });
+    }
+    counter.Wait();
+  }
+  return Status::OK();
+}
+
 class DirectSession::RunCallableCallFrame : public CallFrameInterface {
  public:
   RunCallableCallFrame(DirectSession* session,
@@ -1862,6 +2039,32 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   return Status::OK();
 }
 
+void DirectSession::RunCallableAsync(CallableHandle handle,
+                                     const std::vector<Tensor>& feed_tensors,
+                                     std::vector<Tensor>* fetch_tensors,
+                                     RunMetadata* run_metadata,
+                                     StatusCallback done) {
+  // All per-step state (rendezvous, step container, run state) is created
+  // inside RunCallable(), so any number of steps may safely be in flight
+  // at once. The blocking body runs on a dedicated pool rather than an
+  // inter-op compute pool: it parks in WaitForNotification() for the
+  // lifetime of the step, and parking it in the compute pool could starve
+  // the executors that need those threads to finish the step.
+  thread::ThreadPool* pool = nullptr;
+  {
+    mutex_lock l(async_run_pool_lock_);
+    if (!async_run_pool_) {
+      async_run_pool_.reset(new thread::ThreadPool(
+          options_.env, "session_async_runs", kNumAsyncRunThreads));
+    }
+    pool = async_run_pool_.get();
+  }
+  pool->Schedule([this, handle, feed_tensors, fetch_tensors, run_metadata,
+                  done]() {
+    done(RunCallable(handle, feed_tensors, fetch_tensors, run_metadata));
+  });
+}
+
 ::tensorflow::Status DirectSession::ReleaseCallable(CallableHandle handle) {
   mutex_lock l(callables_lock_);
   if (handle >= next_callable_handle_) {
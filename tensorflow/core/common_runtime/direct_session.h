@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/threadpool_quota.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -114,7 +115,13 @@ class DirectSession : public Session {
                                    const std::vector<Tensor>& feed_tensors,
                                    std::vector<Tensor>* fetch_tensors,
                                    RunMetadata* run_metadata) override;
+  void RunCallableAsync(CallableHandle handle,
+                        const std::vector<Tensor>& feed_tensors,
+                        std::vector<Tensor>* fetch_tensors,
+                        RunMetadata* run_metadata,
+                        StatusCallback done) override;
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
+  ::tensorflow::Status Warmup(const CallableOptions& callable_options) override;
 
  private:
   // For access to collective_graph_key_.
@@ -326,12 +333,18 @@ class DirectSession : public Session {
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // Parallel to thread_pools_: per-session admission control for pools
+  // whose options cap this session's concurrency (see the max_concurrency
+  // field of ThreadPoolOptionProto), otherwise nullptr.
+  std::vector<std::unique_ptr<ThreadPoolQuota>> thread_pool_quotas_;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
-  // Schedules 'c' for execution on pool.
-  void SchedClosure(thread::ThreadPool* pool, std::function<void()> c);
+  // Schedules 'c' for execution on pool, through quota if one is given.
+  void SchedClosure(thread::ThreadPool* pool, ThreadPoolQuota* quota,
+                    std::function<void()> c);
 
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       GUARDED_BY(executor_lock_);
@@ -345,6 +358,26 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       GUARDED_BY(executor_lock_);
 
+  // Allocation-free lookup for repeated Run() calls with the same feeds,
+  // fetches and targets: maps a fingerprint of the (unsorted) signature to
+  // its executors.  The names are kept to resolve fingerprint collisions
+  // without rebuilding the string key.
+  struct ExecutorSignature {
+    std::vector<string> inputs;
+    std::vector<string> outputs;
+    std::vector<string> targets;
+    std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+  };
+  std::unordered_map<uint64, ExecutorSignature> executors_by_signature_
+      GUARDED_BY(executor_lock_);
+
+  // Records 'ek' under 'fingerprint' in executors_by_signature_.
+  void RememberSignature(uint64 fingerprint, gtl::ArraySlice<string> inputs,
+                         gtl::ArraySlice<string> outputs,
+                         gtl::ArraySlice<string> target_nodes,
+                         std::shared_ptr<ExecutorsAndKeys> ek)
+      EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
   class RunCallableCallFrame;
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
@@ -355,6 +388,13 @@ class DirectSession : public Session {
   int64 next_callable_handle_ GUARDED_BY(callables_lock_) = 0;
   std::unordered_map<int64, Callable> callables_ GUARDED_BY(callables_lock_);
 
+  // Hosts the blocking bodies of RunCallableAsync() calls. Created on
+  // first use; its size bounds the number of steps in flight before
+  // additional async requests queue up behind them.
+  mutex async_run_pool_lock_;
+  std::unique_ptr<thread::ThreadPool> async_run_pool_
+      GUARDED_BY(async_run_pool_lock_);
+
   // Holds mappings from handle to partial run state.
   std::unordered_map<string, std::unique_ptr<RunState>> partial_runs_
       GUARDED_BY(executor_lock_);
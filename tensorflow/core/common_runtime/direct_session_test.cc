@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -188,6 +189,55 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableAsync) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {y_ + ":0"}, {y_neg_}), &handle));
+
+  // Launch several steps without waiting for any of them, so that their
+  // execution overlaps within the session.
+  static const int kNumSteps = 8;
+  std::vector<std::vector<Tensor>> outputs(kNumSteps);
+  std::vector<Status> statuses(kNumSteps);
+  BlockingCounter pending(kNumSteps);
+  for (int i = 0; i < kNumSteps; ++i) {
+    session->RunCallableAsync(handle, {}, &outputs[i], nullptr,
+                              [&statuses, &pending, i](const Status& s) {
+                                statuses[i] = s;
+                                pending.DecrementCount();
+                              });
+  }
+  pending.Wait();
+
+  for (int i = 0; i < kNumSteps; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    ASSERT_EQ(1, outputs[i].size());
+    auto mat = outputs[i][0].matrix<float>();
+    ASSERT_TRUE(outputs[i][0].IsInitialized());
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+  }
+
+  // Errors are reported through the completion callback.
+  Notification done;
+  Status async_status;
+  session->RunCallableAsync(handle + 1, {}, nullptr, nullptr,
+                            [&async_status, &done](const Status& s) {
+                              async_status = s;
+                              done.Notify();
+                            });
+  done.WaitForNotification();
+  EXPECT_TRUE(errors::IsInvalidArgument(async_status));
+  EXPECT_TRUE(str_util::StrContains(async_status.error_message(),
+                                    "No such callable handle"));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestTensorConnection) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
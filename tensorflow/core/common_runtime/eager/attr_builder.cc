@@ -126,7 +126,7 @@ Status AttrTypeMapForOp(const char* op_name, const AttrTypeMap** out,
   AttrBuilder& AttrBuilder::Set(StringPiece attr_name, value_type&& value) { \
     DCHECK(!node_def_finalized_) << "Calling Set() after BuildNodeDef.";     \
     value_field.push_back(std::make_pair(string(attr_name), value));         \
-    cached_cache_key_ = absl::nullopt;                                       \
+    InvalidateCacheKeys();                                                   \
     return *this;                                                            \
   }
 
@@ -263,9 +263,21 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const string& device) {
 }
 
 tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
-    const string& device) const {
+    const string& device) {
   tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name_);
   f = tensorflow::FingerprintCat128(f, tensorflow::Fingerprint128(device));
+  // The attr contributions are combined into the key by (commutative)
+  // addition, so the attr fingerprint can be computed once independently of
+  // the device and cheaply re-added for every device.
+  if (!cached_attr_fingerprint_) {
+    cached_attr_fingerprint_ = BuildAttrFingerprint();
+  }
+  CombineUnordered(*cached_attr_fingerprint_, &f);
+  return f;
+}
+
+tensorflow::Fprint128 AttrBuilder::BuildAttrFingerprint() const {
+  tensorflow::Fprint128 f = {0, 0};
   if (node_def_ != nullptr) {
     // Some attributes are directly written to node_def_ instead of being
     // stored explicitly.
@@ -97,7 +97,7 @@ class AttrBuilder {
   AttrBuilder& Set(StringPiece attr_name, T&& value) {
     MayBeInitializeNodeDef();
     SetInAttrValueMap(node_def_->mutable_attr(), string(attr_name), value);
-    cached_cache_key_ = absl::nullopt;
+    InvalidateCacheKeys();
     return *this;
   }
 
@@ -126,7 +126,20 @@ class AttrBuilder {
   template <class T>
   using AttrVec = tensorflow::gtl::InlinedVector<std::pair<string, T>, 2>;
 
-  tensorflow::Fprint128 BuildCacheKeyForDevice(const string& device) const;
+  tensorflow::Fprint128 BuildCacheKeyForDevice(const string& device);
+
+  // Computes the device-independent, order-independent fingerprint of the
+  // attributes set so far.  Attr serialization is the expensive part of
+  // building a cache key, so the result is memoized in
+  // cached_attr_fingerprint_; repeat calls to CacheKey for the same op --
+  // even with alternating devices -- only recombine the memoized fingerprint
+  // with the device fingerprint.
+  tensorflow::Fprint128 BuildAttrFingerprint() const;
+
+  void InvalidateCacheKeys() {
+    cached_cache_key_ = absl::nullopt;
+    cached_attr_fingerprint_ = absl::nullopt;
+  }
 
   void MayBeInitializeNodeDef();
   // Fill `m` with the attr-value pairs set via AttrBuilder::Set() so far, as
@@ -161,6 +174,7 @@ class AttrBuilder {
 
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+  absl::optional<tensorflow::Fprint128> cached_attr_fingerprint_;
 };  // namespace tensorflow
 
 template <>
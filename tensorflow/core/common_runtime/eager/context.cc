@@ -62,6 +62,7 @@ EagerContext::EagerContext(const SessionOptions& opts,
       pflr_(new ProcessFunctionLibraryRuntime(
           device_mgr, opts.env, TF_GRAPH_DEF_VERSION, &func_lib_def_,
           opts.config.graph_options().optimizer_options(), thread_pool_.get())),
+      kernel_cache_(std::make_shared<KernelCache>()),
       log_device_placement_(opts.config.log_device_placement()),
       num_active_steps_(0),
       async_default_(async),
@@ -144,7 +145,12 @@ Status EagerContext::ClearCaches() {
   // well.
   mutex_lock ml(cache_mu_);
   TF_RETURN_IF_ERROR(executor_.WaitForAllPendingNodes());
-  gtl::STLDeleteValues(&kernel_cache_);
+  std::shared_ptr<const KernelCache> old_cache = std::atomic_exchange(
+      &kernel_cache_,
+      std::shared_ptr<const KernelCache>(std::make_shared<KernelCache>()));
+  for (const auto& entry : *old_cache) {
+    delete entry.second;
+  }
 
   return Status::OK();
 }
@@ -348,14 +354,20 @@ Status EagerContext::AddFunctionDef(const FunctionDef& fdef) {
 }
 
 KernelAndDevice* EagerContext::GetCachedKernel(Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  return gtl::FindPtrOrNull(kernel_cache_, cache_key);
+  // Lock-free: dispatch threads read a snapshot of the cache published by
+  // AddKernelToCache and never contend on cache_mu_.
+  std::shared_ptr<const KernelCache> cache = std::atomic_load(&kernel_cache_);
+  return gtl::FindPtrOrNull(*cache, cache_key);
 }
 
 void EagerContext::AddKernelToCache(Fprint128 cache_key,
                                     KernelAndDevice* kernel) {
   mutex_lock ml(cache_mu_);
-  gtl::InsertOrUpdate(&kernel_cache_, cache_key, kernel);
+  auto updated =
+      std::make_shared<KernelCache>(*std::atomic_load(&kernel_cache_));
+  gtl::InsertOrUpdate(updated.get(), cache_key, kernel);
+  std::atomic_store(&kernel_cache_,
+                    std::shared_ptr<const KernelCache>(std::move(updated)));
 }
 
 bool EagerContext::ShouldStoreGraphs() {
@@ -280,9 +280,15 @@ class EagerContext {
 
   std::function<void(std::function<void()>)> runner_;
 
+  using KernelCache =
+      std::unordered_map<Fprint128, KernelAndDevice*, Fprint128Hasher>;
+
+  // The kernel cache is consulted on every eager op dispatch, so lookups are
+  // lock-free: readers atomically load an immutable snapshot of the cache and
+  // never take cache_mu_.  Writers serialize on cache_mu_, build an updated
+  // copy of the map, and atomically publish it (read-copy-update).
   mutex cache_mu_;
-  std::unordered_map<Fprint128, KernelAndDevice*, Fprint128Hasher> kernel_cache_
-      GUARDED_BY(cache_mu_);
+  std::shared_ptr<const KernelCache> kernel_cache_;
 
   // Whether we should compute RunMetadata.
   std::atomic<bool> should_store_step_stats_{false};
@@ -22,7 +22,11 @@ EagerNode::EagerNode(tensorflow::uint64 id) : id(id) {}
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   thread_done_ = true;
-  nodes_pending_.notify_all();
+  for (auto& lane : lanes_) {
+    lane->nodes_pending.notify_all();
+  }
+  // The lane threads are joined when lanes_ is destroyed, after this lock is
+  // released.
 }
 
 tensorflow::uint64 EagerExecutor::NextId() {
@@ -32,33 +36,46 @@ tensorflow::uint64 EagerExecutor::NextId() {
 
 void EagerExecutor::EnableAsync() {
   tensorflow::mutex_lock l(node_queue_mutex_);
-  if (thread_ == nullptr) {
-    thread_.reset(tensorflow::Env::Default()->StartThread(
-        tensorflow::ThreadOptions(), "eager_async_executor",
-        std::bind(&EagerExecutor::Run, this)));
+  if (lanes_.empty()) {
+    // The default lane, for nodes not tied to a particular device.
+    LaneForDevice(nullptr);
+  }
+}
+
+EagerExecutor::ExecutionLane* EagerExecutor::LaneForDevice(Device* device) {
+  auto it = device_lanes_.find(device);
+  if (it != device_lanes_.end()) {
+    return it->second;
   }
+  lanes_.push_back(std::unique_ptr<ExecutionLane>(new ExecutionLane));
+  ExecutionLane* lane = lanes_.back().get();
+  lane->thread.reset(tensorflow::Env::Default()->StartThread(
+      tensorflow::ThreadOptions(), "eager_async_executor",
+      std::bind(&EagerExecutor::Run, this, lane)));
+  device_lanes_[device] = lane;
+  return lane;
 }
 
 void EagerExecutor::Add(EagerNode* node) {
   tensorflow::mutex_lock l(node_queue_mutex_);
-  DCHECK(thread_) << "EnableAsync should have been called before Add";
+  DCHECK(!lanes_.empty()) << "EnableAsync should have been called before Add";
   if (!status_.ok()) {
     delete node;
     return;
   }
-  int64 qlen = node_queue_.size();
-  if (qlen > 0) {
-    if (node_queue_.back()->id >= node->id) {
-      status_ = tensorflow::errors::InvalidArgument(
-          "Inserting EagerNode with non-increasing ids:",
-          node_queue_.back()->id, " vs ", node->id);
-      delete node;
-      return;
-    }
-    node_queue_.push(node);
-  } else {
-    node_queue_.push(node);
-    nodes_pending_.notify_all();
+  if (node->id <= last_added_id_) {
+    status_ = tensorflow::errors::InvalidArgument(
+        "Inserting EagerNode with non-increasing ids:", last_added_id_, " vs ",
+        node->id);
+    delete node;
+    return;
+  }
+  last_added_id_ = node->id;
+  pending_ids_.insert(node->id);
+  ExecutionLane* lane = LaneForDevice(node->device());
+  lane->node_queue.push(node);
+  if (lane->node_queue.size() == 1) {
+    lane->nodes_pending.notify_all();
   }
 }
 
@@ -72,34 +89,29 @@ tensorflow::Status EagerExecutor::WaitForAllPendingNodes() {
 
 tensorflow::Status EagerExecutor::WaitImpl(bool wait_all,
                                            tensorflow::uint64 node_id) {
-  tensorflow::condition_variable cond;
   tensorflow::mutex_lock l(node_queue_mutex_);
   // Don't wait if an error is already set.
   if (!status_.ok()) return status_;
-  if (node_queue_.empty()) return tensorflow::Status::OK();
-  if (wait_all) {
-    node_id = node_queue_.back()->id;
-  } else if (node_id < node_queue_.front()->id) {
-    // Note that we are relying on the ops being dispatched sequentially from
-    // the queue.
-    return tensorflow::Status::OK();
+  while (status_.ok() && (wait_all ? !pending_ids_.empty()
+                                   : pending_ids_.count(node_id) > 0)) {
+    node_done_.wait(l);
   }
-  node_done_notifications_.insert(std::make_pair(node_id, &cond));
-  cond.wait(l);
-  // Note that we could be woken up if an error occurs, even though the node has
-  // not actually executed.
+  // Note that we could be woken up if an error occurs, even though the node
+  // has not actually executed.
   return status_;
 }
 
 void EagerExecutor::ClearError() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   if (status_.ok()) return;
-  // If an error was set, node_done_notifications_ and node_queue_ should have
-  // been cleared, and no new entries should have been added since.
-  DCHECK(node_done_notifications_.empty());
-  DCHECK(node_queue_.empty());
+  // If an error was set, the lane queues should have been cleared, and no new
+  // entries should have been added since.
+  DCHECK(pending_ids_.empty());
   status_ = tensorflow::Status::OK();
-  nodes_pending_.notify_all();
+  for (auto& lane : lanes_) {
+    DCHECK(lane->node_queue.empty());
+    lane->nodes_pending.notify_all();
+  }
 }
 
 tensorflow::Status EagerExecutor::status() {
@@ -107,45 +119,44 @@ tensorflow::Status EagerExecutor::status() {
   return status_;
 }
 
-void EagerExecutor::Run() {
+void EagerExecutor::Run(ExecutionLane* lane) {
   while (true) {
     std::unique_ptr<EagerNode> curr_node;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
-      while (node_queue_.empty() || !status_.ok()) {
+      while (lane->node_queue.empty() || !status_.ok()) {
         if (thread_done_) return;
-        nodes_pending_.wait(l);
+        lane->nodes_pending.wait(l);
       }
-      curr_node.reset(node_queue_.front());
+      // The node stays in pending_ids_ while it runs, so waiters block until
+      // it is done even though it is no longer queued.
+      curr_node.reset(lane->node_queue.front());
+      lane->node_queue.pop();
     }
     tensorflow::Status status = curr_node->Run();
     const bool ok = status.ok();
     tensorflow::mutex_lock l(node_queue_mutex_);
-    node_queue_.pop();
-    if (!ok) {
+    pending_ids_.erase(curr_node->id);
+    if (!ok && status_.ok()) {
       status_ = status;
       // TODO(agarwal): mark all affected handles as corrupted before clearing
-      // this queue.
-      // We remove any pending ops so that we don't try to execute them if
-      // ClearError is called.
-      for (int i = 0; i < node_queue_.size(); ++i) {
-        delete node_queue_.front();
-        node_queue_.pop();
-      }
-    }
-    if (!node_done_notifications_.empty()) {
-      tensorflow::uint64 node_id = curr_node->id;
-      // Note that we notify all waiting threads in case an error has occurred.
-      // These calling threads are responsible for checking status_ before
-      // proceeding.
-      const auto range = ok ? node_done_notifications_.equal_range(node_id)
-                            : make_pair(node_done_notifications_.begin(),
-                                        node_done_notifications_.end());
-      for (auto it = range.first; it != range.second; ++it) {
-        it->second->notify_all();
+      // the queues.
+      // We remove any pending ops, on all lanes, so that we don't try to
+      // execute them if ClearError is called.  Lane threads currently running
+      // a node will drop their error status on the floor; the first error
+      // wins.
+      for (auto& other_lane : lanes_) {
+        while (!other_lane->node_queue.empty()) {
+          pending_ids_.erase(other_lane->node_queue.front()->id);
+          delete other_lane->node_queue.front();
+          other_lane->node_queue.pop();
+        }
       }
-      node_done_notifications_.erase(range.first, range.second);
     }
+    // Note that we notify all waiting threads in case an error has occurred.
+    // These calling threads are responsible for checking status_ before
+    // proceeding.
+    node_done_.notify_all();
   }
 }
 
@@ -22,6 +22,8 @@ limitations under the License.
 #include <queue>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device_factory.h"
@@ -50,6 +52,11 @@ class EagerNode {
   // execution is done.
   virtual Status Run() = 0;
 
+  // The device this node's computation runs on, or nullptr if not tied to a
+  // particular device.  The executor keeps nodes for the same device in one
+  // in-order lane and runs lanes for different devices in parallel.
+  virtual Device* device() const { return nullptr; }
+
   // An id unique to the TFE_Context under which this node is created. Allocated
   // monotonically.
   const uint64 id;
@@ -57,12 +64,19 @@ class EagerNode {
 
 // A class for handling async execution (see TFE_ContextSetAsync).
 // Note that this class is thread-safe.
+//
+// Nodes are partitioned into per-device execution lanes: each lane executes
+// its nodes in the order they were added on a dedicated thread, and different
+// lanes run in parallel, so independent ops on different devices overlap.
+// Cross-lane dependencies need no explicit tracking: a node reading a pending
+// TensorHandle blocks in WaitFor until the producing lane finishes the
+// producer.  Since handle producers always have smaller ids than their
+// consumers and every lane executes in increasing id order, the pending node
+// with the smallest id can always run, so these waits cannot deadlock.
 // TODO(agarwal): TFE_OpAddInput may currently block if it tries to access the
 // device of the input handle. Fix that.
 // TODO(agarwal): On error, mark all affected handles as corrupted.
 // TODO(agarwal): Implement support for control dependencies.
-// TODO(agarwal): Support out-of-order execution and dispatching multiple
-// EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
 class EagerExecutor {
  public:
@@ -95,38 +109,61 @@ class EagerExecutor {
   Status status();
 
  private:
-  // Starts execution of pending EagerNodes. This function loops till
+  // One in-order execution lane.  Nodes for the same device are queued on one
+  // lane and executed one-by-one on the lane's thread; different lanes run in
+  // parallel.
+  struct ExecutionLane {
+    // Used to signal the lane's thread that some EagerNodes are pending
+    // execution on node_queue.
+    condition_variable nodes_pending;
+
+    // Queue of pending EagerNodes for this lane.
+    std::queue<EagerNode*> node_queue;
+
+    // Thread object that calls the `Run` method for this lane.
+    std::unique_ptr<Thread> thread;
+  };
+
+  // Starts execution of `lane`'s pending EagerNodes. This function loops till
   // thread_done_ is set to true. If any errors are encontered, these are set
-  // inside `status_`. The loop blocks anytime there are no pending nodes, or if
-  // `status_` is not ok.
-  void Run();
+  // inside `status_`. The loop blocks anytime there are no pending nodes on
+  // the lane, or if `status_` is not ok.
+  void Run(ExecutionLane* lane);
 
   Status WaitImpl(bool wait_all, uint64 node_id);
 
+  // Returns the lane nodes for `device` execute on, creating it (and starting
+  // its thread) on first use.  A nullptr device maps to the default lane
+  // created by EnableAsync.
+  ExecutionLane* LaneForDevice(Device* device)
+      EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
   mutex node_queue_mutex_;
 
-  // Used to signal that some EagerNodes are pending execution.
-  condition_variable nodes_pending_ GUARDED_BY(node_queue_mutex_);
+  // Execution lanes in creation order; lanes_[0] is the default lane.  Lanes
+  // live for the lifetime of the executor.
+  std::vector<std::unique_ptr<ExecutionLane>> lanes_
+      GUARDED_BY(node_queue_mutex_);
+  std::unordered_map<Device*, ExecutionLane*> device_lanes_
+      GUARDED_BY(node_queue_mutex_);
 
-  // Queue of pending EagerNodes.
-  std::queue<EagerNode*> node_queue_ GUARDED_BY(node_queue_mutex_);
+  // Ids of nodes that have been added but have not finished executing, across
+  // all lanes.
+  std::unordered_set<uint64> pending_ids_ GUARDED_BY(node_queue_mutex_);
+
+  // Largest id passed to Add, used to check that ids arrive monotonically.
+  uint64 last_added_id_ GUARDED_BY(node_queue_mutex_) = 0;
 
   // `status_` is set based on any errors raised during execution of a
   // EagerNode.  It remains set until ClearError is called.
   Status status_ GUARDED_BY(node_queue_mutex_);
 
-  // Map from id of a EagerNode to condition_variables (not owned by the map).
-  // These condition_variables are notified and removed when that EagerNode is
-  // done executing, or if an error is found in execution of any EagerNode.
-  std::multimap<uint64, condition_variable*> node_done_notifications_
-      GUARDED_BY(node_queue_mutex_);
-
-  // Thread object that calls the `Run` method. Currently we use only one thread
-  // for executing the EagerNodes one-by-one.
-  std::unique_ptr<Thread> thread_ GUARDED_BY(node_queue_mutex_);
+  // Broadcast whenever a node finishes executing (or an error clears the
+  // queues); waiters in WaitImpl wake up and re-check pending_ids_/status_.
+  condition_variable node_done_ GUARDED_BY(node_queue_mutex_);
 
-  // Indicates that `thread_` should stop as soon as it is done executing the
-  // current EagerNode.
+  // Indicates that the lane threads should stop as soon as they are done
+  // executing their current EagerNode.
   bool thread_done_ GUARDED_BY(node_queue_mutex_) = false;
 
   mutex next_id_mutex_;
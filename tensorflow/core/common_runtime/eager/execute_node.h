@@ -76,6 +76,8 @@ class ExecuteNode : public EagerNode {
     }
   }
 
+  Device* device() const override { return kernel_->device(); }
+
  private:
   tensorflow::EagerContext* ctx_;
   tensorflow::gtl::InlinedVector<TensorHandle*, 4> inputs_;
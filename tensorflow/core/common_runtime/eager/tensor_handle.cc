@@ -49,6 +49,45 @@ namespace tensorflow {
 
 namespace {
 
+// Recycles TensorHandle allocations through a per-thread freelist.  A handle
+// freed on one thread may be reused on another; the freelist only caches raw
+// ::operator new blocks, so migrating blocks between threads is safe.  The
+// list is capped to bound the worst-case memory held by idle threads.
+class TensorHandleFreelist {
+ public:
+  ~TensorHandleFreelist() {
+    for (void* ptr : entries_) {
+      ::operator delete(ptr);
+    }
+  }
+
+  void* Allocate() {
+    if (entries_.empty()) {
+      return ::operator new(sizeof(TensorHandle));
+    }
+    void* ptr = entries_.back();
+    entries_.pop_back();
+    return ptr;
+  }
+
+  void Recycle(void* ptr) {
+    if (entries_.size() >= kMaxEntries) {
+      ::operator delete(ptr);
+      return;
+    }
+    entries_.push_back(ptr);
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 64;
+  std::vector<void*> entries_;
+};
+
+TensorHandleFreelist* ThreadLocalTensorHandleFreelist() {
+  static thread_local TensorHandleFreelist freelist;
+  return &freelist;
+}
+
 // If the tensor is a resource variable, return its data type and shape.
 Status GetResourceVariableDtypeAndShapeInternal(
     const tensorflow::Tensor& tensor, Device* resource_device,
@@ -92,6 +131,21 @@ Status GetResourceVariableDtypeAndShapeInternal(
 
 }  // namespace
 
+/* static */ void* TensorHandle::operator new(size_t size) {
+  if (size != sizeof(TensorHandle)) {
+    return ::operator new(size);
+  }
+  return ThreadLocalTensorHandleFreelist()->Allocate();
+}
+
+/* static */ void TensorHandle::operator delete(void* ptr, size_t size) {
+  if (size != sizeof(TensorHandle)) {
+    ::operator delete(ptr);
+    return;
+  }
+  ThreadLocalTensorHandleFreelist()->Recycle(ptr);
+}
+
 TensorHandle::TensorHandle(const class Tensor& t, Device* d, Device* op_device,
                            EagerContext* ctx)
     : dtype(t.dtype()),
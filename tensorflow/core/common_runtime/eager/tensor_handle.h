@@ -77,6 +77,13 @@ class TensorHandle : public core::RefCounted {
     }
   }
 
+  // Eager mode creates and destroys one TensorHandle per op output, so for
+  // the scalar-heavy control loops common in eager code the handle allocation
+  // itself is measurable.  Handles are recycled through a per-thread freelist
+  // instead of going to the heap on every op; see tensor_handle.cc.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   Status Tensor(const tensorflow::Tensor** t);
 
   Status TensorValue(tensorflow::TensorValue* t);
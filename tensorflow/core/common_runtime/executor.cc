@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/static_plan_executor.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -56,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -64,6 +66,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
 namespace tensorflow {
@@ -72,6 +75,58 @@ namespace {
 // 1-D, 0 element tensor.
 static const Tensor* const kEmptyTensor = new Tensor;
 
+// Number of ready nodes handed to the inter-op thread pool in a single
+// closure when batched dispatch is enabled (see
+// LocalExecutorParams::use_batched_dispatch).
+const size_t kDispatchBatchSize = 8;
+
+// Upper bound (in CPU cycles) on the work a completing thread runs inline
+// before handing the remainder of its ready queue back to the thread pool.
+// Inlining inexpensive kernels avoids a thread-pool round trip per op, but
+// an unbounded inline queue can serialize nodes that idle pool threads
+// could be executing in parallel.
+const uint64 kInlineWorkBudgetCycles = 10 * 1000 * 1000;
+
+// Maximum number of loop iterations allowed to run in parallel for frames
+// whose body contains no stateful ops, overriding a smaller
+// "parallel_iterations" attr on the Enter node. Zero (the default) disables
+// the override so the attr remains the bound. Deeper pipelining lets
+// iteration i+1's independent ops start before iteration i fully drains;
+// it is restricted to stateless bodies because reordering stateful kernels
+// across iterations would be observable. Latched once per process since it
+// only affects scheduling depth, not results.
+int64 LoopPipelineDepth() {
+  static const int64 depth = [] {
+    int64 v;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_EXECUTOR_LOOP_PIPELINE_DEPTH", 0, &v));
+    return v;
+  }();
+  return depth;
+}
+
+// Number of graph nodes below which kernel instantiation during executor
+// setup stays on the calling thread; spinning up a pool costs more than it
+// saves for small graphs.
+const int64 kMinNodesForParallelKernelCreate = 256;
+
+// Kernel constructors are independent of one another (the op registry takes
+// a reader lock on the lookup fast path and the session's OpSegment runs
+// creation outside its lock), so executor setup instantiates them across a
+// transient pool when the graph is large. Set
+// TF_EXECUTOR_PARALLEL_KERNEL_CREATE=0 to restore the serial path, e.g. to
+// rule it out when debugging a kernel whose constructor touches
+// unsynchronized global state.
+bool ParallelKernelCreateEnabled() {
+  static const bool enabled = [] {
+    bool v;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_EXECUTOR_PARALLEL_KERNEL_CREATE", true, &v));
+    return v;
+  }();
+  return enabled;
+}
+
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
@@ -285,6 +340,151 @@ class GraphView {
   TF_DISALLOW_COPY_AND_ASSIGN(GraphView);
 };
 
+// Either a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
+// TODO(yuanbyu): A better way to do "has_value"?
+struct Entry {
+  Entry() {}
+  Entry(const Entry& other)
+      : ref(other.ref),
+        ref_mu(other.ref_mu),
+        has_value(other.has_value),
+        val_field_is_set(other.val_field_is_set),
+        alloc_attr(other.alloc_attr),
+        device_context(other.device_context) {
+    if (val_field_is_set) {
+      val.Init(*other.val);
+    }
+  }
+  ~Entry() {
+    if (val_field_is_set) val.Destroy();
+  }
+
+  Entry& operator=(const Entry& other) {
+    if (val_field_is_set) {
+      val.Destroy();
+    }
+    ref = other.ref;
+    ref_mu = other.ref_mu;
+    has_value = other.has_value;
+    val_field_is_set = other.val_field_is_set;
+    alloc_attr = other.alloc_attr;
+    device_context = other.device_context;
+    if (val_field_is_set) {
+      val.Init(*other.val);
+    }
+    return *this;
+  }
+
+  Entry& operator=(Entry&& other) {
+    if (val_field_is_set) {
+      val.Destroy();
+    }
+    ref = other.ref;
+    ref_mu = other.ref_mu;
+    has_value = other.has_value;
+    val_field_is_set = other.val_field_is_set;
+    alloc_attr = other.alloc_attr;
+    device_context = other.device_context;
+    if (val_field_is_set) {
+      val.Init(std::move(*other.val));
+    }
+    return *this;
+  }
+
+  // Clears the <val> field.
+  void ClearVal() {
+    if (val_field_is_set) {
+      val.Destroy();
+      val_field_is_set = false;
+      has_value = false;
+    }
+  }
+
+  // A tensor value, if val_field_is_set.
+  ManualConstructor<Tensor> val;
+
+  Tensor* ref = nullptr;    // A tensor reference.
+  mutex* ref_mu = nullptr;  // mutex for *ref if ref is not nullptr.
+
+  // Whether the value exists, either in <val> or <ref>.
+  bool has_value = false;
+
+  bool val_field_is_set = false;
+
+  // The attributes of the allocator that creates the tensor.
+  AllocatorAttributes alloc_attr;
+
+  // Every entry carries an optional DeviceContext containing
+  // Device-specific information about how the Tensor was produced.
+  DeviceContext* device_context = nullptr;
+};
+
+struct IterationState {
+  explicit IterationState(const PendingCounts* pending_counts,
+                          int total_input_tensors)
+      : input_tensors(new Entry[total_input_tensors]),
+        outstanding_ops(0),
+        outstanding_frame_count(0),
+        counts_(*pending_counts) {  // Initialize with copy of *pending_counts
+  }
+
+  // The state of an iteration.
+
+  // One copy per iteration. For iteration k, i-th node's j-th input is in
+  // input_tensors[k][impl_->nodes[i].input_start + j]. An entry is either
+  // a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
+  //
+  // NOTE: No need to protect input_tensors[i] by any locks because it
+  // is resized once. Each element of tensors_ is written once by the
+  // source node of an edge and is cleared by the destination of the same
+  // edge. The latter node is never run concurrently with the former node.
+  Entry* input_tensors;
+
+  // The number of outstanding ops for each iteration.
+  size_t outstanding_ops;
+
+  // The number of outstanding frames for each iteration.
+  int outstanding_frame_count;
+  int pending(PendingCounts::Handle h) { return counts_.pending(h); }
+  int decrement_pending(PendingCounts::Handle h, int v) {
+    return counts_.decrement_pending(h, v);
+  }
+  // Mark a merge node as live
+  // REQUIRES: Node corresponding to "h" is a merge node
+  void mark_live(PendingCounts::Handle h) { counts_.mark_live(h); }
+  // Mark a node to show that processing has started.
+  void mark_started(PendingCounts::Handle h) { counts_.mark_started(h); }
+  // Mark a node to show that processing has completed.
+  void mark_completed(PendingCounts::Handle h) { counts_.mark_completed(h); }
+  PendingCounts::NodeState node_state(PendingCounts::Handle h) {
+    return counts_.node_state(h);
+  }
+
+  int dead_count(PendingCounts::Handle h) { return counts_.dead_count(h); }
+  void increment_dead_count(PendingCounts::Handle h) {
+    counts_.increment_dead_count(h);
+  }
+  void adjust_for_activation(PendingCounts::Handle h, bool increment_dead,
+                             int* pending_result, int* dead_result) {
+    counts_.adjust_for_activation(h, increment_dead, pending_result,
+                                  dead_result);
+  }
+
+  // Restores this object to the state it had just after construction so
+  // it can be reused for another iteration with the same layout.
+  // REQUIRES: all entries of input_tensors have been cleared.
+  void Reset(const PendingCounts* pending_counts) {
+    outstanding_ops = 0;
+    outstanding_frame_count = 0;
+    counts_.ResetFrom(*pending_counts);
+  }
+
+  ~IterationState() { delete[] input_tensors; }
+
+ private:
+  PendingCounts counts_;
+};
+
 class ExecutorImpl : public Executor {
  public:
   ExecutorImpl(const LocalExecutorParams& p, std::unique_ptr<const Graph> g)
@@ -346,7 +546,53 @@ class ExecutorImpl : public Executor {
     // The nodes in a frame. Used only for debugging.
     std::vector<const Node*>* nodes;  // Owned
 
+    // True iff any node in the frame is stateful. Stateful loop bodies must
+    // honor the user-specified "parallel_iterations" bound exactly; stateless
+    // bodies may be pipelined more deeply (see LoopPipelineDepth below).
+    bool has_stateful_nodes = false;
+
+    // Returns an IterationState for a new iteration of this frame, reusing
+    // a previously retired one when possible. The graph topology (and hence
+    // the layout of the iteration state) is fixed for the lifetime of the
+    // executor, so in steady state every step runs out of recycled states
+    // and this incurs no allocation.
+    IterationState* GetIterationState() {
+      IterationState* state = nullptr;
+      {
+        mutex_lock l(iter_state_pool_mu);
+        if (!iter_state_pool.empty()) {
+          state = iter_state_pool.back();
+          iter_state_pool.pop_back();
+        }
+      }
+      if (state == nullptr) {
+        return new IterationState(pending_counts, total_inputs);
+      }
+      state->Reset(pending_counts);
+      return state;
+    }
+
+    // Returns a retired iteration state to the pool. Entries are cleared
+    // here so that tensors still held by an iteration (e.g. after an
+    // aborted step) are released rather than kept alive in the pool.
+    void RecycleIterationState(IterationState* state) {
+      for (int i = 0; i < total_inputs; ++i) {
+        state->input_tensors[i] = Entry();
+      }
+      mutex_lock l(iter_state_pool_mu);
+      iter_state_pool.push_back(state);
+    }
+
+    // Retired iteration states available for reuse. Guarded by its own
+    // mutex because iterations are retired concurrently by different
+    // frames and steps.
+    mutex iter_state_pool_mu;
+    std::vector<IterationState*> iter_state_pool GUARDED_BY(iter_state_pool_mu);
+
     ~FrameInfo() {
+      for (IterationState* state : iter_state_pool) {
+        delete state;
+      }
       delete pending_counts;
       delete nodes;
     }
@@ -611,8 +857,45 @@ Status ExecutorImpl::Initialize() {
     EnsureFrameInfo(it)->nodes = new std::vector<const Node*>;
   }
 
-  // Preprocess every node in the graph to create an instance of op
-  // kernel for each node.
+  // Instantiate the kernel for every node before the bookkeeping pass
+  // below. Kernel construction dominates executor setup for large graphs
+  // and each kernel is independent of the others, so it is spread across a
+  // transient pool; the rest of the preprocessing is order-dependent and
+  // cheap, and stays on this thread.
+  std::vector<const Node*> ordered_nodes;
+  ordered_nodes.reserve(graph_->num_nodes());
+  for (const Node* n : graph_->nodes()) {
+    ordered_nodes.push_back(n);
+  }
+  std::vector<Status> kernel_statuses(graph_->num_node_ids());
+  auto create_kernels = [this, &ordered_nodes, &kernel_statuses](int64 start,
+                                                                 int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      const Node* n = ordered_nodes[i];
+      NodeItem* item = gview_.node(n->id());
+      Status s = params_.create_kernel(n->def(), &item->kernel);
+      if (!s.ok()) {
+        item->kernel = nullptr;
+      }
+      kernel_statuses[n->id()] = s;
+    }
+  };
+  const int64 num_ordered_nodes = ordered_nodes.size();
+  if (ParallelKernelCreateEnabled() &&
+      num_ordered_nodes >= kMinNodesForParallelKernelCreate) {
+    thread::ThreadPool pool(Env::Default(), "create_kernels",
+                            port::NumSchedulableCPUs());
+    // Constructor costs range from trivial (most element-wise ops) to
+    // expression-compilation heavy; a coarse per-kernel estimate keeps the
+    // shards small enough to balance across the pool.
+    pool.ParallelFor(num_ordered_nodes, 50000 /* cost_per_unit */,
+                     create_kernels);
+  } else {
+    create_kernels(0, num_ordered_nodes);
+  }
+
+  // Preprocess every node in the graph to finish setting up the
+  // per-node state now that its kernel exists.
   for (const Node* n : graph_->nodes()) {
     const int id = n->id();
     const string& frame_name = cf_info.frame_names[id];
@@ -629,10 +912,8 @@ Status ExecutorImpl::Initialize() {
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
 
-    Status s = params_.create_kernel(n->def(), &item->kernel);
-    if (!s.ok()) {
-      item->kernel = nullptr;
-      s = AttachDef(s, *n);
+    if (!kernel_statuses[id].ok()) {
+      Status s = AttachDef(kernel_statuses[id], *n);
       LOG(ERROR) << "Executor failed to create kernel. " << s;
       return s;
     }
@@ -665,6 +946,9 @@ Status ExecutorImpl::Initialize() {
 
     // Initialize static information about the frames in the graph.
     frame_info->nodes->push_back(n);
+    if (n->op_def().is_stateful()) {
+      frame_info->has_stateful_nodes = true;
+    }
     if (IsEnter(n)) {
       string enter_name;
       TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "frame_name", &enter_name));
@@ -856,85 +1140,6 @@ class ExecutorState {
   void RunAsync(Executor::DoneCallback done);
 
  private:
-  // Either a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
-  // TODO(yuanbyu): A better way to do "has_value"?
-  struct Entry {
-    Entry() {}
-    Entry(const Entry& other)
-        : ref(other.ref),
-          ref_mu(other.ref_mu),
-          has_value(other.has_value),
-          val_field_is_set(other.val_field_is_set),
-          alloc_attr(other.alloc_attr),
-          device_context(other.device_context) {
-      if (val_field_is_set) {
-        val.Init(*other.val);
-      }
-    }
-    ~Entry() {
-      if (val_field_is_set) val.Destroy();
-    }
-
-    Entry& operator=(const Entry& other) {
-      if (val_field_is_set) {
-        val.Destroy();
-      }
-      ref = other.ref;
-      ref_mu = other.ref_mu;
-      has_value = other.has_value;
-      val_field_is_set = other.val_field_is_set;
-      alloc_attr = other.alloc_attr;
-      device_context = other.device_context;
-      if (val_field_is_set) {
-        val.Init(*other.val);
-      }
-      return *this;
-    }
-
-    Entry& operator=(Entry&& other) {
-      if (val_field_is_set) {
-        val.Destroy();
-      }
-      ref = other.ref;
-      ref_mu = other.ref_mu;
-      has_value = other.has_value;
-      val_field_is_set = other.val_field_is_set;
-      alloc_attr = other.alloc_attr;
-      device_context = other.device_context;
-      if (val_field_is_set) {
-        val.Init(std::move(*other.val));
-      }
-      return *this;
-    }
-
-    // Clears the <val> field.
-    void ClearVal() {
-      if (val_field_is_set) {
-        val.Destroy();
-        val_field_is_set = false;
-        has_value = false;
-      }
-    }
-
-    // A tensor value, if val_field_is_set.
-    ManualConstructor<Tensor> val;
-
-    Tensor* ref = nullptr;    // A tensor reference.
-    mutex* ref_mu = nullptr;  // mutex for *ref if ref is not nullptr.
-
-    // Whether the value exists, either in <val> or <ref>.
-    bool has_value = false;
-
-    bool val_field_is_set = false;
-
-    // The attributes of the allocator that creates the tensor.
-    AllocatorAttributes alloc_attr;
-
-    // Every entry carries an optional DeviceContext containing
-    // Device-specific information about how the Tensor was produced.
-    DeviceContext* device_context = nullptr;
-  };
-
   // Contains a value for [node->id()] for the device context assigned by the
   // device at the beginning of a step.
   DeviceContextMap device_context_map_;
@@ -943,63 +1148,6 @@ class ExecutorState {
   typedef gtl::InlinedVector<TaggedNode, 8> TaggedNodeSeq;
   typedef gtl::InlinedVector<Entry, 4> EntryVector;
 
-  struct IterationState {
-    explicit IterationState(const PendingCounts* pending_counts,
-                            int total_input_tensors)
-        : input_tensors(new Entry[total_input_tensors]),
-          outstanding_ops(0),
-          outstanding_frame_count(0),
-          counts_(*pending_counts) {  // Initialize with copy of *pending_counts
-    }
-
-    // The state of an iteration.
-
-    // One copy per iteration. For iteration k, i-th node's j-th input is in
-    // input_tensors[k][impl_->nodes[i].input_start + j]. An entry is either
-    // a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
-    //
-    // NOTE: No need to protect input_tensors[i] by any locks because it
-    // is resized once. Each element of tensors_ is written once by the
-    // source node of an edge and is cleared by the destination of the same
-    // edge. The latter node is never run concurrently with the former node.
-    Entry* input_tensors;
-
-    // The number of outstanding ops for each iteration.
-    size_t outstanding_ops;
-
-    // The number of outstanding frames for each iteration.
-    int outstanding_frame_count;
-    int pending(PendingCounts::Handle h) { return counts_.pending(h); }
-    int decrement_pending(PendingCounts::Handle h, int v) {
-      return counts_.decrement_pending(h, v);
-    }
-    // Mark a merge node as live
-    // REQUIRES: Node corresponding to "h" is a merge node
-    void mark_live(PendingCounts::Handle h) { counts_.mark_live(h); }
-    // Mark a node to show that processing has started.
-    void mark_started(PendingCounts::Handle h) { counts_.mark_started(h); }
-    // Mark a node to show that processing has completed.
-    void mark_completed(PendingCounts::Handle h) { counts_.mark_completed(h); }
-    PendingCounts::NodeState node_state(PendingCounts::Handle h) {
-      return counts_.node_state(h);
-    }
-
-    int dead_count(PendingCounts::Handle h) { return counts_.dead_count(h); }
-    void increment_dead_count(PendingCounts::Handle h) {
-      counts_.increment_dead_count(h);
-    }
-    void adjust_for_activation(PendingCounts::Handle h, bool increment_dead,
-                               int* pending_result, int* dead_result) {
-      counts_.adjust_for_activation(h, increment_dead, pending_result,
-                                    dead_result);
-    }
-
-    ~IterationState() { delete[] input_tensors; }
-
-   private:
-    PendingCounts counts_;
-  };
-
   struct FrameState {
     explicit FrameState(const ExecutorImpl* impl, int parallel_iters)
         : executor(impl),
@@ -1054,8 +1202,9 @@ class ExecutorState {
     // The FrameState of its parent frame.
     FrameState* parent_frame = nullptr;
 
-    // The maximum allowed number of parallel iterations.
-    const int max_parallel_iterations;
+    // The maximum allowed number of parallel iterations. Only mutated by
+    // Reset() while the frame is unpublished (owned by a pool).
+    int max_parallel_iterations;
 
     // The number of inputs this frame is still waiting.
     int num_pending_inputs = 0;
@@ -1087,6 +1236,7 @@ class ExecutorState {
     std::vector<const Node*> dead_exits GUARDED_BY(mu);
 
     // Static information specific to this frame.
+    ExecutorImpl::FrameInfo* frame_info = nullptr;
     PendingCounts* pending_counts = nullptr;
     int total_input_tensors = 0;
     std::vector<const Node*>* nodes = nullptr;
@@ -1099,6 +1249,7 @@ class ExecutorState {
       auto it_frame_info = executor->frame_info_.find(enter_name);
       DCHECK(it_frame_info != executor->frame_info_.end());
       ExecutorImpl::FrameInfo* finfo = it_frame_info->second;
+      frame_info = finfo;
       pending_counts = finfo->pending_counts;
       total_input_tensors = finfo->total_inputs;
       num_pending_inputs = finfo->input_count;
@@ -1175,9 +1326,43 @@ class ExecutorState {
     bool CleanupIterations(const GraphView* gview, int64 iter,
                            TaggedNodeSeq* ready) EXCLUSIVE_LOCKS_REQUIRED(mu);
 
+    // Prepares a pooled frame instance for reuse by a new dynamic frame.
+    // The caller owns the frame exclusively (it is not in
+    // outstanding_frames_), so no lock is needed. Static frame information
+    // is reinitialized separately via InitializeFrameInfo().
+    void Reset(int parallel_iters) NO_THREAD_SAFETY_ANALYSIS {
+      max_parallel_iterations = parallel_iters;
+      parent_iter = -1;
+      parent_frame = nullptr;
+      num_pending_inputs = 0;
+      iteration_count = 0;
+      num_outstanding_iterations = 1;
+      iterations.clear();
+      next_iter_roots.clear();
+      inv_values.clear();
+      dead_exits.clear();
+    }
+
+    // Releases the per-instance resources of a completed frame so it can
+    // sit in a pool without pinning iteration states or tensors. The frame
+    // is no longer reachable by other threads, so no lock is needed.
+    void Retire() NO_THREAD_SAFETY_ANALYSIS {
+      for (size_t i = 0; i < iterations.size(); ++i) {
+        if (iterations[i] != nullptr) {
+          frame_info->RecycleIterationState(iterations[i]);
+          iterations[i] = nullptr;
+        }
+      }
+      next_iter_roots.clear();
+      inv_values.clear();
+      dead_exits.clear();
+    }
+
     ~FrameState() {
       for (size_t i = 0; i < iterations.size(); ++i) {
-        delete iterations[i];
+        if (iterations[i] != nullptr) {
+          frame_info->RecycleIterationState(iterations[i]);
+        }
         iterations[i] = nullptr;
       }
     }
@@ -1262,6 +1447,7 @@ class ExecutorState {
   CancellationManager* cancellation_manager_;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
+  const bool batched_dispatch_;
   const bool trace_using_annotations_;
 
   // Owned.
@@ -1293,6 +1479,11 @@ class ExecutorState {
   // name of the new frame from nodedef.
   gtl::FlatMap<string, FrameState*> outstanding_frames_ GUARDED_BY(mu_);
 
+  // Retired child frames available for reuse, so loops that repeatedly
+  // instantiate the same dynamic frame (e.g. a loop nested in another
+  // loop's body) do not pay a FrameState allocation per instance.
+  std::vector<FrameState*> frame_state_pool_ GUARDED_BY(mu_);
+
   // The unique name of a frame.
   inline string MakeFrameName(FrameState* frame, int64 iter_id,
                               const string& name) {
@@ -1393,6 +1584,7 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
+      batched_dispatch_(impl->params_.use_batched_dispatch),
       trace_using_annotations_(impl->params_.device->TraceUsingAnnotations()),
       num_outstanding_ops_(0) {
   // We start the entire execution in iteration 0 of the root frame
@@ -1404,8 +1596,7 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
 
   // Initialize iteration 0.
   root_frame_->iterations.resize(root_frame_->max_parallel_iterations);
-  root_frame_->iterations[0] = new IterationState(
-      root_frame_->pending_counts, root_frame_->total_input_tensors);
+  root_frame_->iterations[0] = root_frame_->frame_info->GetIterationState();
 
   outstanding_frames_.insert({root_frame_->frame_name, root_frame_});
 }
@@ -1414,6 +1605,9 @@ ExecutorState::~ExecutorState() {
   for (auto name_frame : outstanding_frames_) {
     delete name_frame.second;
   }
+  for (FrameState* frame : frame_state_pool_) {
+    delete frame;
+  }
   for (auto it : device_context_map_) {
     it->Unref();
   }
@@ -1663,6 +1857,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
 
   EntryVector outputs;
   bool completed = false;
+  KernelTimer inline_timer;
   inline_ready.push_back(tagged_node);
   while (!inline_ready.empty()) {
     tagged_node = inline_ready.front();
@@ -1820,14 +2015,13 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
             device->Compute(op_kernel, &ctx);
           }
         } else {
-          // In the common case, avoid creating any tracing objects.
-          if (op_kernel->IsExpensive()) {
-            KernelTimer timer;
-            device->Compute(op_kernel, &ctx);
-            op_kernel->UpdateCostEstimate(timer.ElapsedCycles());
-          } else {
-            device->Compute(op_kernel, &ctx);
-          }
+          // In the common case, avoid creating any tracing objects.  The
+          // compute is timed regardless of the kernel's current
+          // classification so that kernels migrate between the expensive
+          // and inexpensive classes as their measured cost changes.
+          KernelTimer timer;
+          device->Compute(op_kernel, &ctx);
+          op_kernel->UpdateCostEstimate(timer.ElapsedCycles());
         }
 
         nodestats::SetOpEnd(stats);
@@ -1870,6 +2064,26 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
       }
       // Postprocess.
       completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+
+      // If this thread has exhausted its inline budget, hand the remaining
+      // ready nodes back to the thread pool rather than keep serializing
+      // them here.
+      if (!completed && !inline_ready.empty() &&
+          inline_timer.ElapsedCycles() > kInlineWorkBudgetCycles) {
+        Executor::Args::Runner runner = runner_;
+        std::vector<TaggedNode> pending(inline_ready.begin(),
+                                        inline_ready.end());
+        // NOTE: Each pending node holds an outstanding op count, so the
+        // step cannot finish before the last of them is dispatched.  The
+        // dispatched closures may then finish the step and delete this
+        // ExecutorState, so nothing below may touch member state.
+        for (const TaggedNode& pending_node : pending) {
+          runner(
+              std::bind(&ExecutorState::Process, this, pending_node,
+                        scheduled_nsec));
+        }
+        return;
+      }
     }
   }  // while !inline_ready.empty()
 
@@ -2262,6 +2476,25 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
   }
 
   if (inline_ready == nullptr) {
+    if (batched_dispatch_ && ready.size() > kDispatchBatchSize) {
+      // Submit one closure per batch of ready nodes rather than one per
+      // node.  Each batch is processed sequentially by whichever thread
+      // picks it up; the batch size bounds the loss of parallelism while
+      // cutting the number of thread-pool submissions.
+      for (size_t i = 0; i < ready.size(); i += kDispatchBatchSize) {
+        const size_t end = std::min(ready.size(), i + kDispatchBatchSize);
+        std::vector<TaggedNode> batch(ready.begin() + i, ready.begin() + end);
+        runner_([this, batch, scheduled_nsec]() {
+          // NOTE: Process() for the last node in the batch may finish the
+          // step and delete this ExecutorState, so nothing below may touch
+          // member state after the final call.
+          for (const TaggedNode& tagged_node : batch) {
+            Process(tagged_node, scheduled_nsec);
+          }
+        });
+      }
+      return;
+    }
     // Schedule to run all the ready ops in thread pool.
     for (auto& tagged_node : ready) {
       runner_([=]() { Process(tagged_node, scheduled_nsec); });
@@ -2540,7 +2773,31 @@ void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
   int parallel_iters;
   s = GetNodeAttr(node->attrs(), "parallel_iterations", &parallel_iters);
   DCHECK(s.ok()) << s;
-  FrameState* temp = new FrameState(impl_, parallel_iters);
+
+  // Frames whose body is stateless may be pipelined more deeply than their
+  // "parallel_iterations" attr requests; see LoopPipelineDepth().
+  const int64 pipeline_depth = LoopPipelineDepth();
+  if (pipeline_depth > parallel_iters) {
+    auto it_frame_info = impl_->frame_info_.find(enter_name);
+    if (it_frame_info != impl_->frame_info_.end() &&
+        !it_frame_info->second->has_stateful_nodes) {
+      parallel_iters = static_cast<int>(pipeline_depth);
+    }
+  }
+
+  FrameState* temp = nullptr;
+  {
+    mutex_lock executor_lock(mu_);
+    if (!frame_state_pool_.empty()) {
+      temp = frame_state_pool_.back();
+      frame_state_pool_.pop_back();
+    }
+  }
+  if (temp == nullptr) {
+    temp = new FrameState(impl_, parallel_iters);
+  } else {
+    temp->Reset(parallel_iters);
+  }
   temp->frame_name = child_name;
   temp->frame_id = Hash64(child_name);
   temp->parent_frame = frame;
@@ -2550,8 +2807,7 @@ void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
   // 'iterations' is a fixed-length circular buffer.
   temp->iterations.resize(temp->max_parallel_iterations + 1);
   // Initialize iteration 0.
-  temp->iterations[0] =
-      new IterationState(temp->pending_counts, temp->total_input_tensors);
+  temp->iterations[0] = temp->frame_info->GetIterationState();
 
   {
     mutex_lock executor_lock(mu_);
@@ -2566,7 +2822,12 @@ void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
       temp = nullptr;
     }
   }
-  delete temp;  // Not used so delete it.
+  if (temp != nullptr) {
+    // Another thread created the frame first; pool our unused instance.
+    temp->Retire();
+    mutex_lock executor_lock(mu_);
+    frame_state_pool_.push_back(temp);
+  }
 }
 
 void ExecutorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
@@ -2620,14 +2881,16 @@ void ExecutorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
     }
   }
 
-  // Delete the frame.
+  // Retire the frame and return it to the pool for reuse by a later
+  // dynamic frame instance.
   const string& frame_name = frame->frame_name;
   if (vlog_) VLOG(2) << "Delete frame " << frame_name;
+  frame->Retire();
   {
     mutex_lock executor_lock(mu_);
     outstanding_frames_.erase(frame_name);
+    frame_state_pool_.push_back(frame);
   }
-  delete frame;
 }
 
 void ExecutorState::CleanupFramesIterations(FrameState* frame, int64 iter,
@@ -2807,8 +3070,7 @@ void ExecutorState::FrameState::IncrementIteration(const GraphView* gview,
   const int64 next_iter = iteration_count;
 
   // Initialize the next iteration.
-  IterationState* iter_state =
-      new IterationState(pending_counts, total_input_tensors);
+  IterationState* iter_state = frame_info->GetIterationState();
   SetIteration(next_iter, iter_state);
   num_outstanding_iterations++;
   dead_exits.clear();
@@ -2825,8 +3087,8 @@ bool ExecutorState::FrameState::CleanupIterations(const GraphView* gview,
                                                   TaggedNodeSeq* ready) {
   int64 curr_iter = iter;
   while (curr_iter <= iteration_count && IsIterationDone(curr_iter)) {
-    // Delete the iteration curr_iter.
-    delete GetIteration(curr_iter);
+    // Retire the iteration curr_iter.
+    frame_info->RecycleIterationState(GetIteration(curr_iter));
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -2846,16 +3108,55 @@ void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
 
 }  // namespace
 
+namespace {
+
+// Returns true if branch-free graphs should be compiled into a static
+// execution plan (see static_plan_executor.h) instead of running through the
+// general ExecutorState machinery. On by default; set the
+// TF_EXECUTOR_USE_STATIC_PLAN environment variable to `false` to opt out.
+bool StaticPlanExecutorEnabled() {
+  static bool enabled = []() {
+    bool b;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_EXECUTOR_USE_STATIC_PLAN", true, &b));
+    return b;
+  }();
+  return enabled;
+}
+
+}  // namespace
+
 Status NewLocalExecutor(const LocalExecutorParams& params,
                         std::unique_ptr<const Graph> graph,
                         Executor** executor) {
+  const bool try_static_plan =
+      StaticPlanExecutorEnabled() &&
+      params.device->attributes().device_type() == DEVICE_CPU &&
+      StaticPlanExecutorSupports(*graph);
+  const Graph* graph_ptr = graph.get();
   ExecutorImpl* impl = new ExecutorImpl(params, std::move(graph));
   const Status s = impl->Initialize();
-  if (s.ok()) {
-    *executor = impl;
-  } else {
+  if (!s.ok()) {
     delete impl;
+    return s;
+  }
+  if (try_static_plan) {
+    // Compile the branch-free graph into a static execution plan, keeping
+    // the general executor as the fallback for runs that request per-node
+    // stats. If plan compilation fails (e.g. the graph contains an async
+    // kernel), use the general executor alone.
+    std::unique_ptr<Executor> fallback(impl);
+    Executor* plan_executor = nullptr;
+    Status plan_status =
+        NewStaticPlanExecutor(params, *graph_ptr, &fallback, &plan_executor);
+    if (plan_status.ok()) {
+      *executor = plan_executor;
+    } else {
+      VLOG(1) << "Not using static execution plan: " << plan_status;
+      *executor = fallback.release();
+    }
+    return Status::OK();
   }
+  *executor = impl;
   return s;
 }
 
@@ -135,6 +135,12 @@ struct LocalExecutorParams {
   // when the executor is deleted.
   std::function<Status(const NodeDef&, OpKernel**)> create_kernel;
   std::function<void(OpKernel*)> delete_kernel;
+
+  // If true, ready nodes are handed to Args::runner in batches rather than
+  // one closure per node.  The underlying inter-op pool uses work-stealing
+  // queues, so per-node submission is the main point of contention when many
+  // small ops become ready at once.
+  bool use_batched_dispatch = false;
 };
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       std::unique_ptr<const Graph> graph,
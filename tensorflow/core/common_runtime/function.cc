@@ -397,7 +397,10 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
   // object, and an executor is created for the graph.
   struct Item {
     uint64 instantiation_counter = 0;
-    const Graph* graph = nullptr;                        // Owned by exec.
+    const Graph* graph = nullptr;  // Owned by exec, or by owned_graph.
+    // Set when exec does not take ownership of the graph (e.g. the
+    // single-threaded executor).
+    std::unique_ptr<const Graph> owned_graph;
     const FunctionLibraryDefinition* lib_def = nullptr;  // Not owned.
     FunctionBody* func_graph = nullptr;
     Executor* exec = nullptr;
@@ -886,6 +889,40 @@ void PruneFunctionBody(const FunctionDef& fdef, Graph* g) {
 }
 }  // namespace
 
+namespace {
+
+// Upper bound on the size of a function body eligible for the single-threaded
+// executor fast path.  Larger bodies may benefit from inter-op parallelism,
+// which the single-threaded executor gives up.
+constexpr int kMaxNodesForSingleThreadedExecutor = 64;
+
+// Returns true if `g` is a candidate for the single-threaded executor, which
+// caches a flattened kernel sequence with preresolved input/output locations
+// and runs a function call as one virtual call, without the per-call frame and
+// scheduling overhead of the default executor.  This replicates the static,
+// graph-level subset of the checks in single_threaded_executor.cc;
+// kernel-level constraints (e.g. asynchronous kernels) surface when the
+// executor is initialized, and the caller falls back to the default executor.
+bool IsCandidateForSingleThreadedExecutor(const Graph& g) {
+  if (g.num_op_nodes() > kMaxNodesForSingleThreadedExecutor) {
+    return false;
+  }
+  for (const Node* n : g.nodes()) {
+    if (n->IsControlFlow() || n->IsSend() || n->IsHostSend() || n->IsRecv() ||
+        n->IsHostRecv() || n->IsCollective()) {
+      return false;
+    }
+    for (DataType dt : n->output_types()) {
+      if (IsRefType(dt)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   const FunctionBody* fbody;
   const FunctionLibraryDefinition* lib_def;
@@ -928,12 +965,35 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   };
   Graph* graph = g.get();
   std::unique_ptr<Executor> exec;
-  TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, std::move(g), &exec));
+  if (executor_type.empty() && IsCandidateForSingleThreadedExecutor(*graph)) {
+    // Fast path for small, simple function bodies: the single-threaded
+    // executor runs the flattened kernel sequence inline, skipping the
+    // default executor's per-call scheduling machinery.  The executor
+    // consumes its graph, so probe with a copy and keep `g` for the
+    // fallback.
+    std::unique_ptr<Graph> g_copy(new Graph(lib_def));
+    CopyGraph(*graph, g_copy.get());
+    Status s = NewExecutor("SINGLE_THREADED_EXECUTOR", params,
+                           std::move(g_copy), &exec);
+    if (!s.ok()) {
+      // E.g. the body contains an asynchronous kernel, or the executor is not
+      // linked in.  Fall back to the default executor below.
+      VLOG(1) << "Not using single-threaded executor for function: "
+              << s.error_message();
+      exec.reset();
+    }
+  }
+  if (exec == nullptr) {
+    TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, std::move(g), &exec));
+  }
   {
     // Guard item since it is already inserted in items_.
     mutex_lock l(mu_);
     if ((*item)->exec == nullptr) {
       (*item)->graph = graph;
+      // `g` is still set iff the single-threaded executor was used; it does
+      // not take ownership of its graph.
+      (*item)->owned_graph = std::move(g);
       (*item)->exec = exec.release();
     }
   }
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_BFC_ALLOCATOR_H_
 
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
@@ -36,15 +38,21 @@ class GPUMemAllocator : public SubAllocator {
  public:
   // 'platform_gpu_id' refers to the ID of the GPU device within
   // the process and must reference a valid ID in the process.
+  // If 'unified_memory_fallback' is true, regions that cannot be satisfied
+  // from device memory are allocated from unified (managed) memory instead,
+  // so working sets moderately larger than device RAM degrade to on-demand
+  // page migration instead of failing outright.
   // Note: stream_exec cannot be null.
   explicit GPUMemAllocator(se::StreamExecutor* stream_exec,
                            PlatformGpuId gpu_id, bool use_unified_memory,
                            const std::vector<Visitor>& alloc_visitors,
-                           const std::vector<Visitor>& free_visitors)
+                           const std::vector<Visitor>& free_visitors,
+                           bool unified_memory_fallback = false)
       : SubAllocator(alloc_visitors, free_visitors),
         stream_exec_(stream_exec),
         gpu_id_(gpu_id),
-        use_unified_memory_(use_unified_memory) {
+        use_unified_memory_(use_unified_memory),
+        unified_memory_fallback_(unified_memory_fallback) {
     CHECK(stream_exec_ != nullptr);
   }
   ~GPUMemAllocator() override {}
@@ -56,6 +64,17 @@ class GPUMemAllocator : public SubAllocator {
         ptr = stream_exec_->UnifiedMemoryAllocate(num_bytes);
       } else {
         ptr = stream_exec_->AllocateArray<char>(num_bytes).opaque();
+        if (ptr == nullptr && unified_memory_fallback_) {
+          ptr = stream_exec_->UnifiedMemoryAllocate(num_bytes);
+          if (ptr != nullptr) {
+            LOG(WARNING) << "Device memory exhausted on GPU "
+                         << gpu_id_.value() << "; allocated " << num_bytes
+                         << " bytes of unified memory instead. Expect reduced "
+                            "performance from on-demand page migration.";
+            mutex_lock l(mu_);
+            unified_ptrs_.insert(ptr);
+          }
+        }
       }
       VisitAlloc(ptr, gpu_id_.value(), num_bytes);
     }
@@ -65,7 +84,16 @@ class GPUMemAllocator : public SubAllocator {
   void Free(void* ptr, size_t num_bytes) override {
     if (ptr != nullptr) {
       VisitFree(ptr, gpu_id_.value(), num_bytes);
-      if (use_unified_memory_) {
+      bool is_unified_memory = use_unified_memory_;
+      if (!is_unified_memory && unified_memory_fallback_) {
+        mutex_lock l(mu_);
+        auto it = unified_ptrs_.find(ptr);
+        if (it != unified_ptrs_.end()) {
+          unified_ptrs_.erase(it);
+          is_unified_memory = true;
+        }
+      }
+      if (is_unified_memory) {
         stream_exec_->UnifiedMemoryDeallocate(ptr);
       } else {
         se::DeviceMemoryBase gpu_ptr(ptr);
@@ -78,6 +106,12 @@ class GPUMemAllocator : public SubAllocator {
   se::StreamExecutor* stream_exec_;  // not owned, non-null
   const PlatformGpuId gpu_id_;
   const bool use_unified_memory_ = false;
+  const bool unified_memory_fallback_ = false;
+
+  mutex mu_;
+  // Regions allocated from unified memory by the fallback path, which must
+  // be released with UnifiedMemoryDeallocate rather than Deallocate.
+  std::set<void*> unified_ptrs_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(GPUMemAllocator);
 };
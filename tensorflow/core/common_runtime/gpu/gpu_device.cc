@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/common_runtime/kernel_timing.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_base.h"
@@ -64,6 +65,7 @@ limitations under the License.
 #elif TENSORFLOW_USE_ROCM
 #include "tensorflow/core/platform/rocm.h"
 #endif
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -73,6 +75,7 @@ limitations under the License.
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
+#include "tensorflow/stream_executor/timer.h"
 
 #if !defined(PLATFORM_GOOGLE)
 #if GOOGLE_CUDA
@@ -566,6 +569,12 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
     kernel_tracker_->PauseWhilePendingExceeds(pending_cap_);
   }
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  KernelTimingCollector* timing_collector = KernelTimingCollector::Get();
+  std::unique_ptr<se::Timer> sample_timer;
+  if (timing_collector != nullptr && timing_collector->ShouldSample()) {
+    sample_timer.reset(new se::Timer(stream->parent()));
+    stream->InitTimer(sample_timer.get()).ThenStartTimer(sample_timer.get());
+  }
   op_kernel->Compute(context);
   if (context->status().ok()) {
     if (sync_every_op_) {
@@ -582,6 +591,25 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
       VLOG(1) << "GpuDevice::ComputeHelper scheduled "
               << ComputeOpKernelDebugString(*op_kernel, stream_id);
     }
+    if (sample_timer) {
+      stream->ThenStopTimer(sample_timer.get());
+      se::Timer* timer = sample_timer.release();
+      auto* sample = new KernelTimingCollector::Sample;
+      sample->op_name = op_kernel->name();
+      sample->op_type = op_kernel->type_string();
+      sample->device_ordinal = tf_gpu_id_.value();
+      sample->stream_id = stream_id;
+      sample->queued_micros = Env::Default()->NowMicros();
+      KernelTimingCollector* collector = timing_collector;
+      // The elapsed time can only be read once the stream has passed the
+      // stop-timer entry, so the sample is harvested from the EventMgr.
+      em_->ThenExecute(stream, [timer, sample, collector]() {
+        sample->elapsed_micros = timer->Microseconds();
+        collector->Record(std::move(*sample));
+        delete sample;
+        delete timer;
+      });
+    }
     if (kernel_tracker_) {
       GPUKernelTracker* tracker = kernel_tracker_.get();
       DCHECK(tracker);
@@ -54,6 +54,12 @@ bool useCudaMemoryGuardAllocator() {
          std::strcmp(debug_allocator_str, "memory_guard") == 0;
 }
 
+bool useGpuHostPoolAllocator() {
+  const char* host_allocator_str = std::getenv("TF_GPU_HOST_ALLOCATOR");
+  return host_allocator_str != nullptr &&
+         std::strcmp(host_allocator_str, "pool") == 0;
+}
+
 }  // namespace
 
 /*static*/ GPUProcessState* GPUProcessState::singleton(GPUProcessState* ps) {
@@ -110,7 +116,8 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
         platform_gpu_id,
         (options.per_process_gpu_memory_fraction() > 1.0 ||
          options.experimental().use_unified_memory()),
-        gpu_visitors_[bus_id], {});
+        gpu_visitors_[bus_id], {},
+        options.experimental().use_unified_memory_fallback());
     GPUBFCAllocator* gpu_bfc_allocator =
         new GPUBFCAllocator(sub_allocator, total_bytes, options,
                             strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
@@ -240,9 +247,22 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
       LOG(ERROR) << "GetGpuHostAllocator: " << status.error_message();
     }
     int64 gpu_host_mem_limit = gpu_host_mem_limit_in_mb * (1LL << 20);
-    Allocator* allocator =
-        new BFCAllocator(sub_allocator, gpu_host_mem_limit,
-                         true /*allow_growth*/, "gpu_host_bfc" /*name*/);
+    Allocator* allocator = nullptr;
+    if (useGpuHostPoolAllocator()) {
+      // Size-classed recycling pool for pinned memory. Buffer sizes are
+      // rounded up to the next power of 2 so that a freed staging buffer can
+      // satisfy later requests of similar size, and the pool auto-resizes
+      // until the steady-state working set of the input pipeline stops
+      // hitting the driver for cudaHostAlloc/cudaFreeHost on the critical
+      // path. Excess buffers are trimmed LRU-first as the pool overflows.
+      allocator = new PoolAllocator(
+          /*pool_size_limit=*/64, /*auto_resize=*/true, sub_allocator,
+          new Pow2Rounder, "gpu_host_pool");
+    } else {
+      allocator =
+          new BFCAllocator(sub_allocator, gpu_host_mem_limit,
+                           true /*allow_growth*/, "gpu_host_bfc" /*name*/);
+    }
 
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
@@ -0,0 +1,408 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_tree_reducer.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace {
+// Key to be used for BufRendezvous by HierarchicalTreeReducer.
+string ReduceBufKey(const string& exec_key, const string& phase, int subdiv,
+                    int src_rank, int dst_rank) {
+  // TODO(b/78352018): Try a denser format, e.g. a 64 or 128 bit hash.
+  return strings::StrCat(exec_key, ":", phase, ":", subdiv, ":", src_rank, ":",
+                         dst_rank);
+}
+}  // namespace
+
+HierarchicalTreeReducer::HierarchicalTreeReducer()
+    : col_ctx_(nullptr), col_params_(nullptr), done_(nullptr) {}
+
+/* static */
+int HierarchicalTreeReducer::GetDeviceTask(
+    int device_rank, const std::vector<int>& dev_per_task) {
+  int num_tasks = static_cast<int>(dev_per_task.size());
+  int task_lo = 0;
+  int task_hi = -1;
+  for (int ti = 0; ti < num_tasks; ti++) {
+    task_hi = task_lo + dev_per_task[ti];
+    if (task_lo <= device_rank && device_rank < task_hi) return ti;
+    task_lo = task_hi;
+  }
+  LOG(FATAL) << "Unexpected device rank " << device_rank << " for " << task_hi
+             << " devices";
+  return -1;
+}
+
+Status HierarchicalTreeReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalTreeReduce");
+  const string& device_name =
+      col_params->instance.device_names[col_params->default_rank];
+  // Start by counting the devices in each task.
+  // Precondition: device_names must be sorted so that all devices in
+  // the same task are adjacent.
+  VLOG(2) << "Sorted task names: "
+          << str_util::Join(col_params->instance.task_names, ", ");
+  std::vector<int> dev_per_task;
+  const string* prior_task_name = &col_params->instance.task_names[0];
+  int dev_count = 1;
+  for (int di = 1; di < col_params->group.group_size; ++di) {
+    if (col_params->instance.task_names[di] != *prior_task_name) {
+      dev_per_task.push_back(dev_count);
+      dev_count = 1;
+      prior_task_name = &col_params->instance.task_names[di];
+    } else {
+      ++dev_count;
+    }
+  }
+  dev_per_task.push_back(dev_count);
+  CHECK_EQ(col_params->group.num_tasks, dev_per_task.size());
+
+  int num_tasks = col_params->group.num_tasks;
+  // If there is just 1 task, execute a tree reduce over all devices.
+  // Otherwise the first subdiv is the inter-task exchange between one
+  // representative device per task, and there are N more subdivs, where N
+  // is #task.  The root of every subdiv is rank 0 within the subdiv; the
+  // representative of task ti is its first device, which makes the
+  // representatives' tree roots coincide with the intra-task roots.
+  int num_subdivs = num_tasks + (num_tasks > 1 ? 1 : 0);
+
+  col_params->instance.impl_details.subdiv_permutations.resize(num_subdivs);
+  col_params->subdiv_rank.reserve(num_subdivs);
+  col_params->instance.impl_details.subdiv_source_rank.reserve(num_subdivs);
+
+  // Inter-task subdiv.  Pick the first device from each task.  If a device
+  // does not participate in the subdiv, set subdiv_rank to -1.
+  if (num_tasks > 1) {
+    const int sdi = 0;
+    std::vector<int>& perm =
+        col_params->instance.impl_details.subdiv_permutations[sdi];
+    CHECK_EQ(perm.size(), 0);
+    int device_count = 0;
+    for (int ti = 0; ti < col_params->group.num_tasks; ti++) {
+      perm.push_back(device_count);
+      if (col_params->instance.device_names[device_count] == device_name) {
+        col_params->subdiv_rank.push_back(ti);
+      }
+      device_count += dev_per_task[ti];
+    }
+    if (col_params->subdiv_rank.empty()) col_params->subdiv_rank.push_back(-1);
+    col_params->instance.impl_details.subdiv_source_rank.push_back(0);
+  }
+
+  // Intra-task subdivs.  Pick all devices in task ti for subdiv sdi.  If a
+  // device does not participate in the subdiv, set subdiv_rank to -1.
+  int abs_di = 0;
+  for (int ti = 0; ti < col_params->group.num_tasks; ti++) {
+    const int sdi = ti + (num_tasks > 1 ? 1 : 0);
+    std::vector<int>& perm =
+        col_params->instance.impl_details.subdiv_permutations[sdi];
+    CHECK_EQ(perm.size(), 0);
+    bool participate = false;
+    for (int di = 0; di < dev_per_task[ti]; di++) {
+      perm.push_back(abs_di);
+      if (col_params->instance.device_names[abs_di] == device_name) {
+        participate = true;
+        col_params->subdiv_rank.push_back(di);
+      }
+      abs_di++;
+    }
+    if (!participate) col_params->subdiv_rank.push_back(-1);
+    col_params->instance.impl_details.subdiv_source_rank.push_back(0);
+  }
+
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return Status::OK();
+}
+
+Status HierarchicalTreeReducer::InitializeCollectiveContext(
+    CollectiveContext* col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+/* static */
+int HierarchicalTreeReducer::TreeParent(int my_rank) {
+  if (my_rank <= 0) return -1;
+  return (my_rank - 1) / 2;
+}
+
+/* static */
+void HierarchicalTreeReducer::TreeChildren(const CollectiveParams& cp,
+                                           int subdiv, int my_rank,
+                                           std::vector<int>* children) {
+  DCHECK_LT(subdiv,
+            static_cast<int>(cp.instance.impl_details.subdiv_permutations.size()));
+  const int group_size = static_cast<int>(
+      cp.instance.impl_details.subdiv_permutations[subdiv].size());
+  for (int child = (2 * my_rank) + 1; child <= (2 * my_rank) + 2; ++child) {
+    if (child < group_size) children->push_back(child);
+  }
+}
+
+Status HierarchicalTreeReducer::SendToRank(const string& phase, int subdiv,
+                                           int dst_rank,
+                                           const Tensor* src_tensor) {
+  int my_rank = col_params_->subdiv_rank[subdiv];
+  string send_buf_key =
+      ReduceBufKey(col_ctx_->exec_key, phase, subdiv, my_rank, dst_rank);
+  int dst_idx =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv][dst_rank];
+  VLOG(3) << "SendToRank " << send_buf_key << " from_device "
+          << col_ctx_->device_name << " to_device "
+          << col_params_->instance.device_names[dst_idx] << " subdiv=" << subdiv
+          << " dst_rank=" << dst_rank << " dst_idx=" << dst_idx;
+  Status status;
+  Notification note;
+  col_ctx_->col_exec->PostToPeer(col_params_->instance.device_names[dst_idx],
+                                 col_params_->instance.task_names[dst_idx],
+                                 send_buf_key, col_ctx_->device,
+                                 col_ctx_->op_ctx->op_device_context(),
+                                 col_ctx_->op_ctx->output_alloc_attr(0),
+                                 src_tensor, col_ctx_->device_locality,
+                                 [&status, &note](const Status& s) {
+                                   status.Update(s);
+                                   note.Notify();
+                                 });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalTreeReducer::RecvFromRank(const string& phase, int subdiv,
+                                             int src_rank, Tensor* dst_tensor) {
+  int my_rank = col_params_->subdiv_rank[subdiv];
+  string recv_buf_key =
+      ReduceBufKey(col_ctx_->exec_key, phase, subdiv, src_rank, my_rank);
+  int src_idx =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv][src_rank];
+  VLOG(3) << "RecvFromRank " << recv_buf_key << " from_device "
+          << col_params_->instance.device_names[src_idx] << " to_device "
+          << col_ctx_->device_name << " subdiv=" << subdiv
+          << " src_rank=" << src_rank << " src_idx=" << src_idx;
+  Status status;
+  Notification note;
+  col_ctx_->col_exec->RecvFromPeer(
+      col_params_->instance.device_names[src_idx],
+      col_params_->instance.task_names[src_idx],
+      col_params_->task.is_local[src_idx], recv_buf_key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->device_locality, 0 /*stream_index*/,
+      [&status, &note](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalTreeReducer::ReduceToRoot(int subdiv) {
+  int my_rank = col_params_->subdiv_rank[subdiv];
+  DCHECK_GE(my_rank, 0);
+  std::vector<int> children;
+  TreeChildren(*col_params_, subdiv, my_rank, &children);
+  // Receive and merge the partial value of each child, deepest-ranked
+  // first so that values propagate up the tree in one wave.
+  for (auto it = children.rbegin(); it != children.rend(); ++it) {
+    TF_RETURN_IF_ERROR(RecvFromRank("red", subdiv, *it, &tmp_));
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op.get(), col_ctx_->output, &tmp_));
+  }
+  int parent = TreeParent(my_rank);
+  if (parent >= 0) {
+    TF_RETURN_IF_ERROR(SendToRank("red", subdiv, parent, col_ctx_->output));
+  }
+  return Status::OK();
+}
+
+Status HierarchicalTreeReducer::BroadcastFromRoot(int subdiv) {
+  int my_rank = col_params_->subdiv_rank[subdiv];
+  DCHECK_GE(my_rank, 0);
+  int parent = TreeParent(my_rank);
+  if (parent >= 0) {
+    TF_RETURN_IF_ERROR(RecvFromRank("bc", subdiv, parent, col_ctx_->output));
+  }
+  std::vector<int> children;
+  TreeChildren(*col_params_, subdiv, my_rank, &children);
+  for (int child : children) {
+    TF_RETURN_IF_ERROR(SendToRank("bc", subdiv, child, col_ctx_->output));
+  }
+  return Status::OK();
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+void HierarchicalTreeReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  done_ = std::move(done);
+  const int num_subdivs = static_cast<int>(col_params_->subdiv_rank.size());
+  CHECK_GT(num_subdivs, 0);
+  // Every device participates in exactly one intra-task subdiv; with more
+  // than one task the representatives additionally participate in the
+  // inter-task subdiv 0.
+  const bool multi_task = num_subdivs > 1;
+  int intra_subdiv = -1;
+  for (int si = (multi_task ? 1 : 0); si < num_subdivs; ++si) {
+    if (col_params_->subdiv_rank[si] >= 0) {
+      intra_subdiv = si;
+      break;
+    }
+  }
+  CHECK_GE(intra_subdiv, 0);
+  const bool is_inter_rep = multi_task && col_params_->subdiv_rank[0] >= 0;
+  // Rank 0 of subdiv 0 is both task 0's representative and the root of
+  // the inter-task tree (or of the single-task tree).
+  const bool is_global_root = col_params_->subdiv_rank[0] == 0;
+
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << "HierarchicalTreeReducer::Run for device "
+            << col_ctx_->device_name << " default_rank "
+            << col_params_->default_rank << "\n"
+            << collective_util::SubdivPermDebugString(*col_params_);
+  }
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  Status status;
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    // We are running in a blockable thread and the callback can't block so
+    // just wait here on the copy.
+    Notification note;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->input_device_context(0),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done_(status);
+      return;
+    }
+  }
+
+  // Allocate staging for received partial values, and an adapter used
+  // only to construct the on-device group_size scalar for final_op.
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  Allocator* allocator = col_ctx_->device->GetAllocator(attr);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, 1 /*num_chunks*/,
+                                  allocator));
+  tmp_ = Tensor(allocator, col_ctx_->output->dtype(),
+                col_ctx_->output->shape());
+  if (col_params_->final_op && is_global_root) {
+    // Create an on-device scalar value from group_size that is needed
+    // once the reduction completes.
+    Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+    if (col_params_->group.device_type != "CPU") {
+      group_size_tensor_ = ca_->Scalar(col_ctx_->device->GetAllocator(
+          col_ctx_->op_ctx->input_alloc_attr(0)));
+      DeviceContext* op_dev_ctx = col_ctx_->op_ctx->op_device_context();
+      Notification note;
+      op_dev_ctx->CopyCPUTensorToDevice(&group_size_val, col_ctx_->device,
+                                        &group_size_tensor_,
+                                        [&status, &note](const Status& s) {
+                                          status.Update(s);
+                                          note.Notify();
+                                        });
+      note.WaitForNotification();
+      if (!status.ok()) {
+        done_(status);
+        return;
+      }
+    } else {
+      group_size_tensor_ = group_size_val;
+    }
+  }
+  const DeviceBase::GpuDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_gpu_device_info();
+  if (gpu_info) {
+    // Wait for all currently queued events on the CPU compute stream to
+    // complete before proceeding.  The tmp_ buffer allocated above is not
+    // guaranteed to be valid (e.g. for RDMA write) unless we do.
+    Notification note;
+    Status s = gpu_info->default_context->ThenExecute(
+        col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+    if (s.ok()) {
+      note.WaitForNotification();
+    } else {
+      done_(errors::Internal(
+          "Failed to dispatch ThenExecute in HierarchicalTreeReducer"));
+      return;
+    }
+  }
+
+  // Phase 1: reduce within the task, to the task representative.
+  status = ReduceToRoot(intra_subdiv);
+
+  // Phase 2: the representatives reduce among themselves over the
+  // network, the global root applies final_op, then the final value is
+  // redistributed down the representatives' tree.
+  if (status.ok() && is_inter_rep) {
+    status = ReduceToRoot(0);
+  }
+  if (status.ok() && col_params_->final_op && is_global_root) {
+    status = collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op.get(), col_ctx_->output, &group_size_tensor_);
+  }
+  if (status.ok() && is_inter_rep) {
+    status = BroadcastFromRoot(0);
+  }
+
+  // Phase 3: redistribute the final value within the task.
+  if (status.ok()) {
+    status = BroadcastFromRoot(intra_subdiv);
+  }
+
+  VLOG(2) << "device=" << col_ctx_->device_name << " return status " << status;
+  done_(status);
+}
+
+REGISTER_COLLECTIVE(HierarchicalTreeReduce, HierarchicalTreeReducer);
+
+}  // namespace tensorflow
@@ -0,0 +1,109 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_TREE_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_TREE_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/lib/core/notification.h"
+
+namespace tensorflow {
+
+// Hierarchical tree-algorithm implementation of collective all-reduce.
+//
+// The flat ring algorithm moves every byte of the tensor across the
+// network group_size - 1 times.  When the group spans multiple tasks
+// this reducer instead reduces within each task first, exchanges the
+// per-task partial results once over the network, then redistributes
+// the final value locally, so inter-task links carry the tensor only
+// O(log num_tasks) times.
+class HierarchicalTreeReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalTreeReducer();
+  ~HierarchicalTreeReducer() override = default;
+
+  // Establishes subdivision permutations mirroring those of
+  // HierarchicalTreeBroadcaster: if there are n tasks, n>1, subdiv 0
+  // contains one representative device per task and subdiv i+1 contains
+  // the devices of task i.  With a single task there is one subdiv
+  // containing all devices.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(CollectiveContext* col_ctx) override;
+
+  // No-op for this collective implementation.
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Begins async execution of the hierarchical tree reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+  // Returns the rank of the tree parent of rank `my_rank`, or -1 for the
+  // root.  The root of every subdiv is rank 0: during the reduction
+  // phase values flow from the leaves to the root, during the
+  // redistribution phase they flow back down the same tree.
+  static int TreeParent(int my_rank);
+
+  // Adds to `children` the ranks (at most 2) from which rank `my_rank`
+  // receives partial values during the reduction phase of `subdiv`, in
+  // increasing rank order.
+  static void TreeChildren(const CollectiveParams& cp, int subdiv, int my_rank,
+                           std::vector<int>* children);
+
+ private:
+  // Maps device rank within the group to its task index given the number
+  // of devices on each task.
+  static int GetDeviceTask(int device_rank,
+                           const std::vector<int>& dev_per_task);
+
+  // Blocking helpers wrapping PostToPeer/RecvFromPeer.  `phase`
+  // distinguishes reduction traffic from redistribution traffic in the
+  // BufRendezvous keys.
+  Status SendToRank(const string& phase, int subdiv, int dst_rank,
+                    const Tensor* src_tensor);
+  Status RecvFromRank(const string& phase, int subdiv, int src_rank,
+                      Tensor* dst_tensor);
+
+  // Receives the partial value of each tree child in `subdiv` and merges
+  // it into the output, then forwards the merged value to the tree
+  // parent unless this device is the subdiv root.
+  Status ReduceToRoot(int subdiv);
+
+  // Receives the final value from the tree parent in `subdiv` unless this
+  // device is the subdiv root, then forwards it to the tree children.
+  Status BroadcastFromRoot(int subdiv);
+
+  CollectiveContext* col_ctx_;          // Not owned
+  const CollectiveParams* col_params_;  // Not owned
+  StatusCallback done_;
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Tensor tmp_;  // Staging for received partial values during reduction.
+  Tensor group_size_tensor_;
+  Notification group_size_tensor_ready_;
+
+  friend class HierarchicalTreeReducerTest;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_TREE_REDUCER_H_
@@ -0,0 +1,164 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_tree_reducer.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(HierarchicalTreeReducerParentTest, Basics) {
+  EXPECT_EQ(-1, HierarchicalTreeReducer::TreeParent(0));
+  EXPECT_EQ(0, HierarchicalTreeReducer::TreeParent(1));
+  EXPECT_EQ(0, HierarchicalTreeReducer::TreeParent(2));
+  EXPECT_EQ(1, HierarchicalTreeReducer::TreeParent(3));
+  EXPECT_EQ(1, HierarchicalTreeReducer::TreeParent(4));
+  EXPECT_EQ(2, HierarchicalTreeReducer::TreeParent(5));
+  EXPECT_EQ(3, HierarchicalTreeReducer::TreeParent(7));
+}
+
+class HierarchicalTreeReducerTest : public ::testing::Test {
+ protected:
+  void PrepColParamsForSubdivPermsTest(CollectiveParams* cp,
+                                       const std::vector<int>& dev_per_task) {
+    cp->group.device_type = DeviceType("GPU");
+    cp->group.num_tasks = static_cast<int32>(dev_per_task.size());
+    cp->group.group_size = 0;
+    cp->instance.type = REDUCTION_COLLECTIVE;
+    cp->instance.impl_details.collective_name = "HierarchicalTreeReduce";
+    for (int ti = 0; ti < cp->group.num_tasks; ti++) {
+      string task_name = strings::StrCat("/job:worker/replica:0/task:", ti);
+      for (int di = 0; di < dev_per_task[ti]; di++) {
+        string dev_name = strings::StrCat(task_name, "/device:GPU:", di);
+        cp->instance.task_names.push_back(task_name);
+        cp->instance.device_names.push_back(dev_name);
+        cp->group.group_size++;
+      }
+    }
+  }
+
+  void RunSubdivPermsTest(
+      CollectiveParams* cp,
+      const std::vector<std::vector<int>>& expected_subdiv_perms,
+      const std::vector<int>& expected_subdiv_rank) {
+    cp->instance.impl_details.subdiv_permutations.clear();
+    cp->subdiv_rank.clear();
+    cp->instance.impl_details.subdiv_source_rank.clear();
+    // Create a stub reducer only for testing param initialization.
+    HierarchicalTreeReducer reducer;
+    TF_CHECK_OK(reducer.InitializeCollectiveParams(cp));
+    EXPECT_EQ(expected_subdiv_perms,
+              cp->instance.impl_details.subdiv_permutations);
+    EXPECT_EQ(expected_subdiv_rank, cp->subdiv_rank);
+    // The root of every subdiv is rank 0.
+    for (int sr : cp->instance.impl_details.subdiv_source_rank) {
+      EXPECT_EQ(0, sr);
+    }
+  }
+
+  void ExpectChildren(const CollectiveParams& cp, int subdiv, int my_rank,
+                      const std::vector<int>& expected) {
+    std::vector<int> children;
+    HierarchicalTreeReducer::TreeChildren(cp, subdiv, my_rank, &children);
+    EXPECT_EQ(expected, children) << "subdiv " << subdiv << " rank " << my_rank;
+  }
+};
+
+TEST_F(HierarchicalTreeReducerTest, InitializeParams1Task8GPU) {
+  CollectiveParams cp;
+  PrepColParamsForSubdivPermsTest(&cp, {8});
+
+  cp.default_rank = 0;
+  RunSubdivPermsTest(&cp, {{0, 1, 2, 3, 4, 5, 6, 7}}, {0});
+
+  cp.default_rank = 3;
+  RunSubdivPermsTest(&cp, {{0, 1, 2, 3, 4, 5, 6, 7}}, {3});
+
+  ExpectChildren(cp, 0, 0, {1, 2});
+  ExpectChildren(cp, 0, 2, {5, 6});
+  ExpectChildren(cp, 0, 3, {7});
+  ExpectChildren(cp, 0, 4, {});
+}
+
+TEST_F(HierarchicalTreeReducerTest, InitializeParams4Tasks8GPU) {
+  CollectiveParams cp;
+  PrepColParamsForSubdivPermsTest(&cp, {8, 8, 8, 8});
+
+  // Device 0 is task 0's representative and the global root.
+  cp.default_rank = 0;
+  RunSubdivPermsTest(&cp,
+                     {{0, 8, 16, 24},
+                      {0, 1, 2, 3, 4, 5, 6, 7},
+                      {8, 9, 10, 11, 12, 13, 14, 15},
+                      {16, 17, 18, 19, 20, 21, 22, 23},
+                      {24, 25, 26, 27, 28, 29, 30, 31}},
+                     {0, 0, -1, -1, -1});
+
+  // Device 8 is task 1's representative.
+  cp.default_rank = 8;
+  RunSubdivPermsTest(&cp,
+                     {{0, 8, 16, 24},
+                      {0, 1, 2, 3, 4, 5, 6, 7},
+                      {8, 9, 10, 11, 12, 13, 14, 15},
+                      {16, 17, 18, 19, 20, 21, 22, 23},
+                      {24, 25, 26, 27, 28, 29, 30, 31}},
+                     {1, -1, 0, -1, -1});
+
+  // Device 9 only participates in task 1's intra-task subdiv.
+  cp.default_rank = 9;
+  RunSubdivPermsTest(&cp,
+                     {{0, 8, 16, 24},
+                      {0, 1, 2, 3, 4, 5, 6, 7},
+                      {8, 9, 10, 11, 12, 13, 14, 15},
+                      {16, 17, 18, 19, 20, 21, 22, 23},
+                      {24, 25, 26, 27, 28, 29, 30, 31}},
+                     {-1, -1, 1, -1, -1});
+
+  // Inter-task subdiv has 4 participants.
+  ExpectChildren(cp, 0, 0, {1, 2});
+  ExpectChildren(cp, 0, 1, {3});
+  ExpectChildren(cp, 0, 2, {});
+}
+
+TEST_F(HierarchicalTreeReducerTest, InitializeParams4TasksVariableGPU) {
+  CollectiveParams cp;
+  PrepColParamsForSubdivPermsTest(&cp, {4, 4, 6, 8});
+
+  cp.default_rank = 0;
+  RunSubdivPermsTest(&cp,
+                     {{0, 4, 8, 14},
+                      {0, 1, 2, 3},
+                      {4, 5, 6, 7},
+                      {8, 9, 10, 11, 12, 13},
+                      {14, 15, 16, 17, 18, 19, 20, 21}},
+                     {0, 0, -1, -1, -1});
+
+  cp.default_rank = 13;
+  RunSubdivPermsTest(&cp,
+                     {{0, 4, 8, 14},
+                      {0, 1, 2, 3},
+                      {4, 5, 6, 7},
+                      {8, 9, 10, 11, 12, 13},
+                      {14, 15, 16, 17, 18, 19, 20, 21}},
+                     {-1, -1, -1, 5, -1});
+}
+
+}  // namespace
+}  // namespace tensorflow
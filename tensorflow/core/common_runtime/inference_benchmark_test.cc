@@ -0,0 +1,351 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End-to-end inference benchmark for the common runtime.
+//
+// Unlike the kernel-level *_benchmark_test.cc files, this harness drives
+// whole Session::Run() calls, optionally from several concurrent client
+// threads, and breaks the measured step time down into executor dispatch,
+// rendezvous transfers, allocation volume and kernel compute based on the
+// StepStatsCollector data in RunMetadata.
+//
+// The default workload is a frozen multi-layer MLP built in-process, so
+// the benchmark has no data dependencies.  A real frozen graph can be
+// substituted through environment variables:
+//
+//   TF_INFERENCE_BENCHMARK_GRAPH   path to a binary GraphDef whose inputs
+//                                  are frozen (no feeds required)
+//   TF_INFERENCE_BENCHMARK_OUTPUT  name of the tensor to fetch
+//
+// The breakdown is reported three ways: through TestReporter (the usual
+// CI benchmark-log pipeline), as a JSON BenchmarkEntries blob in the test
+// log, and - when TF_INFERENCE_BENCHMARK_BASELINE names a JSON file
+// produced from an earlier run - as hard EXPECT failures whenever a
+// metric regresses beyond the baseline's tolerance_ratio.
+
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/human_readable_json.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/reporter.h"
+#include "tensorflow/core/util/test_log.pb.h"
+
+namespace tensorflow {
+namespace {
+
+// Runtime-level breakdown of traced steps, aggregated over all devices.
+// Times are microseconds summed over all nodes of all traced steps; the
+// allocator columns count bytes and allocation events per traced step.
+struct RuntimeBreakdown {
+  int64 steps = 0;
+  double step_wall_us = 0;
+  double kernel_compute_us = 0;
+  double dispatch_overhead_us = 0;
+  double rendezvous_us = 0;
+  double allocated_bytes = 0;
+  double num_allocations = 0;
+};
+
+// Builds a frozen inference-style MLP: input constant followed by
+// num_layers blocks of MatMul + Add + Relu with constant weights.
+// Returns the name of the tensor to fetch in *output_name.
+GraphDef BuildFrozenMlpGraphDef(int num_layers, int batch, int width,
+                                string* output_name) {
+  Graph g(OpRegistry::Global());
+
+  Tensor input_t(DT_FLOAT, TensorShape({batch, width}));
+  input_t.flat<float>().setRandom();
+  Node* cur = test::graph::Constant(&g, input_t, "input");
+
+  for (int layer = 0; layer < num_layers; ++layer) {
+    Tensor weights_t(DT_FLOAT, TensorShape({width, width}));
+    weights_t.flat<float>().setRandom();
+    // Keep activations bounded across layers.
+    weights_t.flat<float>() = weights_t.flat<float>() * (1.0f / width);
+    Tensor bias_t(DT_FLOAT, TensorShape({width}));
+    bias_t.flat<float>().setRandom();
+
+    Node* weights = test::graph::Constant(&g, weights_t);
+    Node* bias = test::graph::Constant(&g, bias_t);
+    Node* matmul = test::graph::Matmul(&g, cur, weights, false, false);
+    Node* sum = test::graph::Add(&g, matmul, bias);
+    cur = test::graph::Unary(&g, "Relu", sum);
+  }
+  *output_name = strings::StrCat(cur->name(), ":0");
+
+  GraphDef def;
+  g.ToGraphDef(&def);
+  return def;
+}
+
+// Returns the workload: the env-configured frozen graph when present,
+// otherwise the built-in MLP.
+GraphDef BenchmarkGraphDef(string* output_name) {
+  const char* graph_path = getenv("TF_INFERENCE_BENCHMARK_GRAPH");
+  if (graph_path != nullptr) {
+    const char* output = getenv("TF_INFERENCE_BENCHMARK_OUTPUT");
+    CHECK(output != nullptr)
+        << "TF_INFERENCE_BENCHMARK_OUTPUT must name the tensor to fetch "
+        << "when TF_INFERENCE_BENCHMARK_GRAPH is set.";
+    GraphDef def;
+    TF_CHECK_OK(ReadBinaryProto(Env::Default(), graph_path, &def));
+    *output_name = output;
+    return def;
+  }
+  return BuildFrozenMlpGraphDef(8 /* num_layers */, 32 /* batch */,
+                                256 /* width */, output_name);
+}
+
+std::unique_ptr<Session> CreateBenchmarkSession(const GraphDef& def) {
+  SessionOptions options;
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_CHECK_OK(session->Create(def));
+  return session;
+}
+
+// Runs total_steps Run() calls spread over num_clients concurrent client
+// threads and returns the elapsed wall time in microseconds.
+double RunConcurrentSteps(Session* session, const string& fetch,
+                          int num_clients, int total_steps) {
+  thread::ThreadPool clients(Env::Default(), "clients", num_clients);
+  BlockingCounter done(num_clients);
+  const uint64 start_us = Env::Default()->NowMicros();
+  for (int c = 0; c < num_clients; ++c) {
+    const int steps =
+        total_steps / num_clients + (c < total_steps % num_clients ? 1 : 0);
+    clients.Schedule([session, &fetch, steps, &done]() {
+      for (int i = 0; i < steps; ++i) {
+        std::vector<Tensor> outputs;
+        TF_CHECK_OK(session->Run({}, {fetch}, {}, &outputs));
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  return static_cast<double>(Env::Default()->NowMicros() - start_us);
+}
+
+// NodeExecStats timeline labels look like "name = Op(input, ...)".
+bool IsRendezvousTransfer(const NodeExecStats& node_stats) {
+  const string& label = node_stats.timeline_label();
+  return str_util::StrContains(label, "= _Send(") ||
+         str_util::StrContains(label, "= _HostSend(") ||
+         str_util::StrContains(label, "= _Recv(") ||
+         str_util::StrContains(label, "= _HostRecv(");
+}
+
+// Runs traced steps and aggregates the StepStatsCollector output into a
+// runtime breakdown.  Kernel compute is the op's own Compute window;
+// dispatch overhead is the executor time around it (input preparation,
+// scheduling, output propagation); rendezvous is the compute window of
+// Send/Recv nodes.  Allocation cost is reported as volume (bytes and
+// events) since the collector does not time allocator calls.
+RuntimeBreakdown CollectRuntimeBreakdown(Session* session, const string& fetch,
+                                         int steps) {
+  RuntimeBreakdown breakdown;
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::FULL_TRACE);
+  for (int i = 0; i < steps; ++i) {
+    RunMetadata run_metadata;
+    std::vector<Tensor> outputs;
+    const uint64 start_us = Env::Default()->NowMicros();
+    TF_CHECK_OK(session->Run(run_options, {}, {fetch}, {}, &outputs,
+                             &run_metadata));
+    breakdown.step_wall_us +=
+        static_cast<double>(Env::Default()->NowMicros() - start_us);
+
+    for (const DeviceStepStats& dev_stats :
+         run_metadata.step_stats().dev_stats()) {
+      for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+        const double compute_us = static_cast<double>(
+            node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros());
+        const double overhead_us = static_cast<double>(
+            node_stats.op_start_rel_micros() +
+            (node_stats.all_end_rel_micros() - node_stats.op_end_rel_micros()));
+        if (IsRendezvousTransfer(node_stats)) {
+          breakdown.rendezvous_us += compute_us;
+        } else {
+          breakdown.kernel_compute_us += compute_us;
+        }
+        breakdown.dispatch_overhead_us += overhead_us;
+        for (const AllocatorMemoryUsed& memory : node_stats.memory()) {
+          breakdown.allocated_bytes +=
+              static_cast<double>(memory.total_bytes());
+          breakdown.num_allocations += memory.allocation_records_size();
+        }
+      }
+    }
+  }
+  breakdown.steps = steps;
+  return breakdown;
+}
+
+// Packs the measurements into the CI benchmark-log schema so baselines
+// are ordinary serialized BenchmarkEntries.
+BenchmarkEntry ToBenchmarkEntry(const string& name, int64 steps,
+                                double wall_seconds,
+                                const RuntimeBreakdown& breakdown) {
+  BenchmarkEntry entry;
+  entry.set_name(name);
+  entry.set_iters(steps);
+  entry.set_wall_time(wall_seconds);
+  entry.set_throughput(steps / wall_seconds);
+  auto set_extra = [&entry](const string& key, double value) {
+    (*entry.mutable_extras())[key].set_double_value(value);
+  };
+  const double traced_steps = static_cast<double>(breakdown.steps);
+  set_extra("traced_step_wall_us", breakdown.step_wall_us / traced_steps);
+  set_extra("kernel_compute_us_per_step",
+            breakdown.kernel_compute_us / traced_steps);
+  set_extra("dispatch_overhead_us_per_step",
+            breakdown.dispatch_overhead_us / traced_steps);
+  set_extra("rendezvous_us_per_step", breakdown.rendezvous_us / traced_steps);
+  set_extra("allocated_bytes_per_step",
+            breakdown.allocated_bytes / traced_steps);
+  set_extra("allocations_per_step", breakdown.num_allocations / traced_steps);
+  return entry;
+}
+
+// Compares the entry against the JSON baseline named by
+// TF_INFERENCE_BENCHMARK_BASELINE, if any.  Every double metric present
+// in the baseline entry of the same name must not exceed
+// baseline * tolerance_ratio (a baseline extra, default 1.5); wall_time
+// is compared the same way.
+void MaybeCompareWithBaseline(const BenchmarkEntry& entry) {
+  const char* baseline_path = getenv("TF_INFERENCE_BENCHMARK_BASELINE");
+  if (baseline_path == nullptr) {
+    return;
+  }
+  string baseline_json;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), baseline_path, &baseline_json));
+  BenchmarkEntries baseline_entries;
+  TF_CHECK_OK(HumanReadableJsonToProto(baseline_json, &baseline_entries));
+
+  const BenchmarkEntry* baseline = nullptr;
+  for (const BenchmarkEntry& candidate : baseline_entries.entry()) {
+    if (candidate.name() == entry.name()) {
+      baseline = &candidate;
+      break;
+    }
+  }
+  if (baseline == nullptr) {
+    LOG(WARNING) << "No baseline entry named " << entry.name() << " in "
+                 << baseline_path << "; skipping comparison.";
+    return;
+  }
+
+  double tolerance_ratio = 1.5;
+  auto tolerance_it = baseline->extras().find("tolerance_ratio");
+  if (tolerance_it != baseline->extras().end()) {
+    tolerance_ratio = tolerance_it->second.double_value();
+  }
+
+  EXPECT_LE(entry.wall_time(), baseline->wall_time() * tolerance_ratio)
+      << "wall_time regressed against baseline " << baseline_path;
+  for (const auto& extra : baseline->extras()) {
+    if (extra.first == "tolerance_ratio") continue;
+    auto measured_it = entry.extras().find(extra.first);
+    if (measured_it == entry.extras().end()) continue;
+    EXPECT_LE(measured_it->second.double_value(),
+              extra.second.double_value() * tolerance_ratio)
+        << extra.first << " regressed against baseline " << baseline_path;
+  }
+}
+
+void ReportEntry(const BenchmarkEntry& entry) {
+  BenchmarkEntries entries;
+  *entries.add_entry() = entry;
+  string json;
+  TF_CHECK_OK(ProtoToHumanReadableJson(entries, &json));
+  // The blob below is a valid baseline file for
+  // TF_INFERENCE_BENCHMARK_BASELINE.
+  LOG(INFO) << "Inference benchmark results:\n" << json;
+
+  TestReporter reporter(entry.name());
+  TF_CHECK_OK(reporter.Initialize());
+  TF_CHECK_OK(reporter.Benchmark(entry.iters(), 0.0 /* cpu_time */,
+                                 entry.wall_time(), entry.throughput()));
+  for (const auto& extra : entry.extras()) {
+    TF_CHECK_OK(
+        reporter.SetProperty(extra.first, extra.second.double_value()));
+  }
+  TF_CHECK_OK(reporter.Close());
+}
+
+TEST(InferenceBenchmarkTest, ConcurrentBreakdown) {
+  string fetch;
+  const GraphDef def = BenchmarkGraphDef(&fetch);
+  std::unique_ptr<Session> session = CreateBenchmarkSession(def);
+
+  // Warm up: constant folding, kernel instantiation, allocator growth.
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {fetch}, {}, &outputs));
+  }
+
+  const int kClients = 4;
+  const int kSteps = 32;
+  const double wall_us = RunConcurrentSteps(session.get(), fetch, kClients,
+                                            kSteps);
+  const RuntimeBreakdown breakdown =
+      CollectRuntimeBreakdown(session.get(), fetch, 4 /* traced steps */);
+
+  // The traced steps must have produced a usable breakdown.
+  ASSERT_GT(breakdown.kernel_compute_us, 0.0);
+  ASSERT_GT(breakdown.dispatch_overhead_us, 0.0);
+
+  const BenchmarkEntry entry = ToBenchmarkEntry(
+      strings::StrCat("InferenceBenchmark.concurrent_breakdown/", kClients),
+      kSteps, wall_us * 1e-6, breakdown);
+  ReportEntry(entry);
+  MaybeCompareWithBaseline(entry);
+
+  TF_ASSERT_OK(session->Close());
+}
+
+void BM_FrozenGraphInference(int iters, int num_clients) {
+  testing::StopTiming();
+  string fetch;
+  const GraphDef def = BenchmarkGraphDef(&fetch);
+  std::unique_ptr<Session> session = CreateBenchmarkSession(def);
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run({}, {fetch}, {}, &outputs));
+  }
+  testing::StartTiming();
+  RunConcurrentSteps(session.get(), fetch, num_clients, iters);
+  testing::StopTiming();
+  TF_CHECK_OK(session->Close());
+}
+BENCHMARK(BM_FrozenGraphInference)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,153 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_timing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace {
+
+// Estimated fixed host-side cost of taking one sample beyond the time spent
+// inside Record(): creating, starting and stopping the device timer and the
+// event-manager callback. Charged against the overhead budget since it
+// cannot be measured from here.
+const uint64 kPerSampleFixedCostMicros = 25;
+
+// Number of samples per overhead accounting window.
+const int64 kAdaptWindowSamples = 64;
+
+// Upper bound for the adapted sampling rate.
+const int64 kMaxSampleRate = 1 << 20;
+
+}  // namespace
+
+KernelTimingCollector::KernelTimingCollector()
+    : op_counter_(0),
+      next_(0),
+      window_overhead_micros_(0),
+      window_samples_(0) {
+  min_sample_rate_ = 100;
+  overhead_budget_percent_ = 1;
+  int64 capacity = 4096;
+  const char* sample_rate_str = getenv("TF_KERNEL_TIMING_SAMPLE_RATE");
+  if (sample_rate_str != nullptr) {
+    strings::safe_strto64(sample_rate_str, &min_sample_rate_);
+  }
+  const char* capacity_str = getenv("TF_KERNEL_TIMING_BUFFER_SIZE");
+  if (capacity_str != nullptr) {
+    strings::safe_strto64(capacity_str, &capacity);
+  }
+  const char* budget_str = getenv("TF_KERNEL_TIMING_OVERHEAD_PERCENT");
+  if (budget_str != nullptr) {
+    strings::safe_strto64(budget_str, &overhead_budget_percent_);
+  }
+  min_sample_rate_ = std::max<int64>(min_sample_rate_, 1);
+  overhead_budget_percent_ =
+      std::min<int64>(std::max<int64>(overhead_budget_percent_, 1), 100);
+  capacity_ = std::max<int64>(capacity, 1);
+  sample_rate_.store(min_sample_rate_, std::memory_order_relaxed);
+  samples_.reserve(capacity_);
+  window_start_micros_ = Env::Default()->NowMicros();
+}
+
+// static
+KernelTimingCollector* KernelTimingCollector::Get() {
+  static KernelTimingCollector* instance = []() -> KernelTimingCollector* {
+    const char* enabled = getenv("TF_KERNEL_TIMING");
+    if (enabled == nullptr || strcmp(enabled, "1") != 0) {
+      return nullptr;
+    }
+    return new KernelTimingCollector;
+  }();
+  return instance;
+}
+
+void KernelTimingCollector::Record(Sample sample) {
+  const uint64 start = Env::Default()->NowMicros();
+  mutex_lock l(mu_);
+  if (samples_.size() < capacity_) {
+    samples_.push_back(std::move(sample));
+  } else {
+    samples_[next_] = std::move(sample);
+    next_ = (next_ + 1) % capacity_;
+  }
+  const uint64 now = Env::Default()->NowMicros();
+  AccountOverhead(now - start + kPerSampleFixedCostMicros, now);
+}
+
+void KernelTimingCollector::RecordStep(int64 step_id, uint64 start_micros,
+                                       uint64 elapsed_micros) {
+  Sample sample;
+  sample.op_name = strings::StrCat("step_", step_id);
+  sample.op_type = "_STEP";
+  sample.device_ordinal = -1;
+  sample.queued_micros = start_micros;
+  sample.elapsed_micros = elapsed_micros;
+  Record(std::move(sample));
+}
+
+void KernelTimingCollector::AccountOverhead(uint64 micros, uint64 now_micros) {
+  window_overhead_micros_ += micros;
+  if (++window_samples_ < kAdaptWindowSamples) {
+    return;
+  }
+  const uint64 wall = now_micros > window_start_micros_
+                          ? now_micros - window_start_micros_
+                          : 1;
+  const uint64 budget = wall * overhead_budget_percent_ / 100;
+  const int64 rate = sample_rate_.load(std::memory_order_relaxed);
+  if (window_overhead_micros_ > budget) {
+    // Over budget: halve the sampling frequency.
+    sample_rate_.store(std::min<int64>(rate * 2, kMaxSampleRate),
+                       std::memory_order_relaxed);
+  } else if (window_overhead_micros_ * 4 < budget &&
+             rate > min_sample_rate_) {
+    // Comfortably under budget: recover towards the configured rate.
+    sample_rate_.store(std::max<int64>(rate / 2, min_sample_rate_),
+                       std::memory_order_relaxed);
+  }
+  window_overhead_micros_ = 0;
+  window_samples_ = 0;
+  window_start_micros_ = now_micros;
+}
+
+string KernelTimingCollector::Export() const {
+  mutex_lock l(mu_);
+  string result = strings::StrCat(
+      "# sample_rate=", sample_rate_.load(std::memory_order_relaxed),
+      " min_sample_rate=", min_sample_rate_,
+      " overhead_budget_percent=", overhead_budget_percent_,
+      " samples=", samples_.size(), "\n");
+  for (size_t i = 0; i < samples_.size(); ++i) {
+    // `next_` points at the oldest sample once the buffer has wrapped.
+    const Sample& sample = samples_[(next_ + i) % samples_.size()];
+    strings::StrAppend(&result, sample.queued_micros, " ",
+                       sample.device_ordinal, " ", sample.stream_id, " ",
+                       sample.elapsed_micros, " ", sample.op_type, " ",
+                       sample.op_name, "\n");
+  }
+  return result;
+}
+
+}  // namespace tensorflow
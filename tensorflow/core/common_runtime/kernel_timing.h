@@ -0,0 +1,108 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_TIMING_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_TIMING_H_
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Collects sampled per-op device execution times and per-step host times
+// into a fixed-size ring buffer — a flight recorder. Unlike full tracing,
+// sampling a small fraction of op executions is cheap enough to leave
+// enabled in production; devices time the sampled ops with device events and
+// record the results here, sessions record step durations, and the most
+// recent samples can be exported on demand (e.g. through the profiler
+// service's Monitor RPC) when a stall or SLO breach is being investigated,
+// without perturbing the workload being measured.
+//
+// The sampling rate adapts to stay within an overhead budget: the collector
+// accounts the time spent taking samples against elapsed wall time and backs
+// off (or recovers towards the configured rate) so that the estimated
+// overhead stays below TF_KERNEL_TIMING_OVERHEAD_PERCENT (default 1) percent.
+class KernelTimingCollector {
+ public:
+  struct Sample {
+    string op_name;
+    string op_type;
+    int device_ordinal = 0;
+    int stream_id = 0;
+    uint64 queued_micros = 0;   // Host wall time when the op was queued.
+    uint64 elapsed_micros = 0;  // Device-measured execution time.
+  };
+
+  // Returns the process-wide collector, or nullptr when collection is
+  // disabled. Enabled by setting TF_KERNEL_TIMING=1.
+  static KernelTimingCollector* Get();
+
+  // Returns true if the caller should time the current op execution.
+  // Approximately one in TF_KERNEL_TIMING_SAMPLE_RATE (default 100) calls
+  // returns true; the effective rate is lowered while the overhead budget is
+  // exceeded.
+  bool ShouldSample() {
+    return (op_counter_.fetch_add(1, std::memory_order_relaxed) %
+            sample_rate_.load(std::memory_order_relaxed)) == 0;
+  }
+
+  // Appends a completed sample, evicting the oldest one once the buffer
+  // holds TF_KERNEL_TIMING_BUFFER_SIZE (default 4096) samples.
+  void Record(Sample sample);
+
+  // Records the host-side duration of one session step as a sample with
+  // op_type "_STEP" and device ordinal -1. Steps are rare relative to ops,
+  // so every step is recorded.
+  void RecordStep(int64 step_id, uint64 start_micros, uint64 elapsed_micros);
+
+  // Returns the buffered samples, oldest first, one line per sample:
+  //   <queued_micros> <device> <stream> <elapsed_micros> <op_type> <op_name>
+  // preceded by a '#'-prefixed summary line with the current sampling state.
+  string Export() const;
+
+ private:
+  KernelTimingCollector();
+
+  // Accounts `micros` of collection overhead and adapts the sampling rate
+  // once enough samples have accumulated in the current window.
+  void AccountOverhead(uint64 micros, uint64 now_micros)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  int64 min_sample_rate_;  // Configured rate; adaptation never goes below it.
+  int64 overhead_budget_percent_;
+  size_t capacity_;
+  std::atomic<uint64> op_counter_;
+  std::atomic<int64> sample_rate_;
+
+  mutable mutex mu_;
+  std::vector<Sample> samples_ GUARDED_BY(mu_);
+  // Insertion point once the buffer is full.
+  size_t next_ GUARDED_BY(mu_);
+  // Overhead accounting window for adaptive sampling.
+  uint64 window_start_micros_ GUARDED_BY(mu_);
+  uint64 window_overhead_micros_ GUARDED_BY(mu_);
+  int64 window_samples_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(KernelTimingCollector);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_TIMING_H_
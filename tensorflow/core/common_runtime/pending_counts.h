@@ -91,6 +91,15 @@ class PendingCounts {
 
   ~PendingCounts() { delete[] bytes_; }
 
+  // Overwrite the counts held by this object with the counts from "other",
+  // so an existing PendingCounts can be reused for a fresh iteration
+  // without reallocating its storage.
+  // REQUIRES: "other" was created with the same Layout as this object.
+  void ResetFrom(const PendingCounts& other) {
+    DCHECK_EQ(num_bytes_, other.num_bytes_);
+    memcpy(bytes_, other.bytes_, other.num_bytes_);
+  }
+
   void set_initial_count(Handle h, size_t pending_count) {
     if (h.is_large_) {
       LargeCounts* c = Large(h);
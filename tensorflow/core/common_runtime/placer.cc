@@ -32,9 +32,12 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/port.h"
 
@@ -76,6 +79,115 @@ Status AssignAndLog(int assigned_device, Node* node,
   return Status::OK();
 }
 
+// Whether placement decisions should be cached across Placer instances,
+// keyed by a fingerprint of the graph and the device set.  Off by default
+// because the cache trades a (small) risk of fingerprint collisions for
+// placement time on processes that repeatedly load near-identical graphs.
+// Read per Run() rather than latched process-wide; placement is rare enough
+// that the getenv cost is noise, and tests can toggle the mode.
+bool PlacementCacheEnabled() {
+  bool enabled = false;
+  Status status = ReadBoolFromEnvVar("TF_PLACER_CACHE", false, &enabled);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+    return false;
+  }
+  return enabled;
+}
+
+// Hashes everything about "node" that the placement algorithm can observe:
+// identity, op, requested and pre-assigned devices, colocation attribute, and
+// incoming edges.  Two nodes with equal signatures in graphs over the same
+// device set are subject to identical placement constraints.
+uint64 NodeSignature(const Node* node) {
+  uint64 h = Hash64(node->name());
+  h = Hash64Combine(h, Hash64(node->type_string()));
+  h = Hash64Combine(h, Hash64(node->requested_device()));
+  if (node->has_assigned_device_name()) {
+    h = Hash64Combine(h, Hash64(node->assigned_device_name()));
+  }
+  const AttrValue* colocation_attr = node->attrs().Find(kColocationAttrName);
+  if (colocation_attr != nullptr) {
+    h = Hash64Combine(h, Hash64(colocation_attr->SerializeAsString()));
+  }
+  uint64 edges = 0;
+  for (const Edge* edge : node->in_edges()) {
+    uint64 edge_hash = Hash64(edge->src()->name());
+    edge_hash = Hash64Combine(edge_hash, edge->src_output());
+    edge_hash = Hash64Combine(edge_hash, edge->dst_input());
+    edges = Hash64CombineUnordered(edges, edge_hash);
+  }
+  return Hash64Combine(h, edges);
+}
+
+uint64 DeviceSetFingerprint(const DeviceSet& devices) {
+  uint64 h = 0;
+  for (const Device* device : devices.devices()) {
+    h = Hash64CombineUnordered(h, Hash64(device->name()));
+  }
+  return h;
+}
+
+// Process-wide cache of placement decisions (see TF_PLACER_CACHE).  Holds
+// both full-graph placements, keyed by graph fingerprint, and individual
+// node placements, keyed by node signature, which seed the placement of
+// graphs that differ from a previously placed one by a small delta.
+class PlacementCache {
+ public:
+  static PlacementCache* Global() {
+    static PlacementCache* cache = new PlacementCache;
+    return cache;
+  }
+
+  bool Lookup(uint64 graph_fingerprint,
+              std::unordered_map<string, string>* assignments)
+      LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = placements_.find(graph_fingerprint);
+    if (it == placements_.end()) return false;
+    *assignments = it->second;
+    return true;
+  }
+
+  bool LookupNode(uint64 node_signature, string* device)
+      LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = node_placements_.find(node_signature);
+    if (it == node_placements_.end()) return false;
+    *device = it->second;
+    return true;
+  }
+
+  void Insert(uint64 graph_fingerprint,
+              const std::vector<std::pair<Node*, uint64>>& signatures)
+      LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    // Cheap bound on memory: start over rather than tracking recency.
+    if (placements_.size() >= kMaxCachedGraphs) placements_.clear();
+    if (node_placements_.size() + signatures.size() > kMaxCachedNodes) {
+      node_placements_.clear();
+    }
+    std::unordered_map<string, string>& assignments =
+        placements_[graph_fingerprint];
+    assignments.clear();
+    for (const auto& node_and_signature : signatures) {
+      const Node* node = node_and_signature.first;
+      assignments[node->name()] = node->assigned_device_name();
+      node_placements_[node_and_signature.second] =
+          node->assigned_device_name();
+    }
+  }
+
+ private:
+  static const size_t kMaxCachedGraphs = 16;
+  static const size_t kMaxCachedNodes = 1 << 20;
+
+  mutex mu_;
+  std::unordered_map<uint64, std::unordered_map<string, string>> placements_
+      GUARDED_BY(mu_);
+  std::unordered_map<uint64, string> node_placements_ GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 Placer::Placer(Graph* graph, const DeviceSet* devices,
@@ -97,6 +209,84 @@ Placer::Placer(Graph* graph, const DeviceSet* devices)
 Placer::~Placer() {}
 
 Status Placer::Run() {
+  if (!PlacementCacheEnabled()) {
+    return RunImpl();
+  }
+  if (devices_->devices().empty()) {
+    return errors::FailedPrecondition("No devices are registered");
+  }
+
+  const uint64 device_fingerprint = DeviceSetFingerprint(*devices_);
+  std::vector<std::pair<Node*, uint64>> signatures;
+  uint64 graph_fingerprint = device_fingerprint;
+  for (Node* node : graph_->op_nodes()) {
+    const uint64 signature =
+        Hash64Combine(NodeSignature(node), device_fingerprint);
+    signatures.emplace_back(node, signature);
+    graph_fingerprint = Hash64CombineUnordered(graph_fingerprint, signature);
+  }
+  graph_fingerprint = Hash64Combine(graph_fingerprint, signatures.size());
+
+  // Fast path: this exact graph was placed before on this device set, so the
+  // cached assignments are known to satisfy all constraints.
+  std::unordered_map<string, string> cached;
+  if (PlacementCache::Global()->Lookup(graph_fingerprint, &cached) &&
+      cached.size() == signatures.size()) {
+    bool valid = true;
+    for (const auto& node_and_signature : signatures) {
+      auto it = cached.find(node_and_signature.first->name());
+      if (it == cached.end() ||
+          devices_->FindDeviceByName(it->second) == nullptr) {
+        valid = false;
+        break;
+      }
+    }
+    if (valid) {
+      for (const auto& node_and_signature : signatures) {
+        Node* node = node_and_signature.first;
+        if (!node->has_assigned_device_name()) {
+          node->set_assigned_device_name(cached[node->name()]);
+        }
+        LogDeviceAssignment(node, log_device_placement_);
+      }
+      return Status::OK();
+    }
+  }
+
+  // Incremental path: seed unplaced nodes whose constraints are unchanged
+  // since an earlier placement with their cached assignment, then let the
+  // algorithm place the delta around them via the pre-assigned-device path.
+  std::vector<Node*> unassigned;
+  bool seeded = false;
+  for (const auto& node_and_signature : signatures) {
+    Node* node = node_and_signature.first;
+    if (node->has_assigned_device_name()) continue;
+    unassigned.push_back(node);
+    string device;
+    if (PlacementCache::Global()->LookupNode(node_and_signature.second,
+                                             &device) &&
+        devices_->FindDeviceByName(device) != nullptr) {
+      node->set_assigned_device_name(device);
+      seeded = true;
+    }
+  }
+
+  Status status = RunImpl();
+  if (!status.ok() && seeded) {
+    // A cached assignment may be infeasible against the changed part of the
+    // graph; discard every assignment made above and place from scratch.
+    for (Node* node : unassigned) {
+      node->set_assigned_device_name_index(0);
+    }
+    status = RunImpl();
+  }
+  if (status.ok()) {
+    PlacementCache::Global()->Insert(graph_fingerprint, signatures);
+  }
+  return status;
+}
+
+Status Placer::RunImpl() {
   if (devices_->devices().empty()) {
     return errors::FailedPrecondition("No devices are registered");
   }
@@ -85,6 +85,10 @@ class Placer {
   Status Run();
 
  private:
+  // Runs the constraint-based placement algorithm.  Run() consults the
+  // process-wide placement cache (if enabled) before falling back to this.
+  Status RunImpl();
+
   // Returns true if the device type of 'candidate_device_name' is
   // found in 'devices'.
   bool CanAssignToDevice(const string& candidate_device_name,
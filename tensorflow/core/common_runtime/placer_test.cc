@@ -1873,5 +1873,50 @@ TEST_P(SoftPlacementPlacerTest,
   }
 }
 
+// With TF_PLACER_CACHE set, placing the same graph twice must reproduce the
+// first placement, and a graph that adds a node to a previously placed one
+// must keep the unchanged nodes where they were.
+TEST_F(PlacerTest, PlacementCache) {
+  setenv("TF_PLACER_CACHE", "1", 1);
+
+  GraphDef graph_def = GDef({
+      NDef("in", "TestInput", {}),
+      NDef("n1", "TestRelu", {"in:0"}),
+      NDef("n2", "TestRelu", {"in:1"}),
+  });
+
+  Graph g1(OpRegistry::Global());
+  TF_ASSERT_OK(BuildGraph(graph_def, &g1));
+  TF_EXPECT_OK(Place(&g1));
+  const string in_device = GetNodeByName(g1, "in")->assigned_device_name();
+  const string n1_device = GetNodeByName(g1, "n1")->assigned_device_name();
+
+  // Identical graph: served from the cache, byte-identical assignments.
+  Graph g2(OpRegistry::Global());
+  TF_ASSERT_OK(BuildGraph(graph_def, &g2));
+  TF_EXPECT_OK(Place(&g2));
+  EXPECT_EQ(in_device, GetNodeByName(g2, "in")->assigned_device_name());
+  EXPECT_EQ(n1_device, GetNodeByName(g2, "n1")->assigned_device_name());
+  EXPECT_EQ(GetNodeByName(g1, "n2")->assigned_device_name(),
+            GetNodeByName(g2, "n2")->assigned_device_name());
+
+  // Small delta: the added node is placed fresh, the rest is seeded from the
+  // per-node cache.
+  GraphDef delta_def = GDef({
+      NDef("in", "TestInput", {}),
+      NDef("n1", "TestRelu", {"in:0"}),
+      NDef("n2", "TestRelu", {"in:1"}),
+      NDef("n3", "TestRelu", {"n2"}),
+  });
+  Graph g3(OpRegistry::Global());
+  TF_ASSERT_OK(BuildGraph(delta_def, &g3));
+  TF_EXPECT_OK(Place(&g3));
+  EXPECT_EQ(in_device, GetNodeByName(g3, "in")->assigned_device_name());
+  EXPECT_EQ(n1_device, GetNodeByName(g3, "n1")->assigned_device_name());
+  EXPECT_DEVICE_TYPE(g3, "n3", "FakeGPU");
+
+  unsetenv("TF_PLACER_CACHE");
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -75,6 +75,20 @@ void IntraProcessRendezvous::SameWorkerRecvDone(
     return;
   }
 
+  // Same-device fast path: when the producer and consumer name the same
+  // device (and the same device context, so no cross-stream hazard) and
+  // neither side asked for host memory, alias the buffer instead of going
+  // through ViaDMA's allocate-and-copy.  Send passes the tensor by value
+  // and receivers treat it as const, so sharing the buffer is safe, as in
+  // the host-to-host case above.
+  if (parsed.src_device == parsed.dst_device &&
+      send_args.device_context == recv_args.device_context &&
+      !send_args.alloc_attrs.on_host() && !recv_args.alloc_attrs.on_host()) {
+    *out = in;
+    done(Status::OK());
+    return;
+  }
+
   // This copy must involve a non-CPU device. Hence, "in" must support DMA
   // (e.g., string tensors do not work on GPU).  Variant copy DMA
   // checks happen inside CopyTensor::ViaDMA.
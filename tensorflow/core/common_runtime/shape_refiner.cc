@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_set>
@@ -31,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/public/session.h"
 
 namespace tensorflow {
@@ -40,6 +43,29 @@ using shape_inference::InferenceContext;
 using shape_inference::ShapeAndType;
 using shape_inference::ShapeHandle;
 
+/* static */ ShapeInferenceCache* ShapeInferenceCache::Global() {
+  static ShapeInferenceCache* cache = new ShapeInferenceCache;
+  return cache;
+}
+
+bool ShapeInferenceCache::Lookup(const string& key,
+                                 std::vector<TensorShapeProto>* output_shapes) {
+  mutex_lock l(mu_);
+  auto it = cache_.find(key);
+  if (it == cache_.end()) return false;
+  *output_shapes = it->second;
+  return true;
+}
+
+void ShapeInferenceCache::Insert(const string& key,
+                                 std::vector<TensorShapeProto> output_shapes) {
+  mutex_lock l(mu_);
+  if (cache_.size() >= kMaxEntries) return;
+  cache_.emplace(key, std::move(output_shapes));
+}
+
+constexpr int64 ShapeInferenceCache::kMaxEntries;
+
 ShapeRefiner::ShapeRefiner(int graph_def_version,
                            const OpRegistryInterface* ops)
     : graph_def_version_(graph_def_version),
@@ -285,9 +311,25 @@ Status ShapeRefiner::AddNode(const Node* node) {
   std::unique_ptr<ExtendedInferenceContext> ec(
       new ExtendedInferenceContext(std::move(c), node));
 
+  // Reuse the output shapes of a previously inferred identical node, if
+  // available, instead of running the shape function.
+  string cache_key;
+  if (shape_cache_ != nullptr && op_reg_data->shape_inference_fn != nullptr) {
+    cache_key = ShapeCacheKey(node, ec->get_context());
+    if (!cache_key.empty() &&
+        TryShapeCacheLookup(cache_key, ec->get_context())) {
+      node_to_context_[node].swap(ec);
+      return Status::OK();
+    }
+  }
+
   // Run the shape inference function, and return if there was an error.
   TF_RETURN_IF_ERROR(RunShapeFn(node, op_reg_data, ec.get()));
 
+  if (!cache_key.empty()) {
+    MaybeCacheShapeResult(cache_key, ec->get_context());
+  }
+
   // Store the resulting context object in the map.
   node_to_context_[node].swap(ec);
 
@@ -756,6 +798,82 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   return Status::OK();
 }
 
+string ShapeRefiner::ShapeCacheKey(const Node* node,
+                                   InferenceContext* c) const {
+  // Function calls descend into the function body, and handle data on an
+  // input is not described by the key, so neither result may be reused.
+  if (function_library_ != nullptr &&
+      IsFunctionCall(*function_library_, *node)) {
+    return "";
+  }
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    if (c->input_handle_shapes_and_types(i) != nullptr) return "";
+  }
+
+  // Don't spend cache memory on nodes with very large attrs (e.g. the value
+  // of a large Const); re-running their shape functions is cheap compared to
+  // keeping the attr around as a key.
+  static constexpr int64 kMaxAttrBytes = 16 << 10;
+
+  string key = strings::StrCat(node->type_string(), ";", graph_def_version_);
+  std::vector<std::pair<StringPiece, const AttrValue*>> attrs;
+  attrs.reserve(node->attrs().size());
+  for (const auto& attr : node->attrs()) {
+    attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  string serialized;
+  for (const auto& attr : attrs) {
+    serialized.clear();
+    if (!SerializeToStringDeterministic(*attr.second, &serialized) ||
+        serialized.size() > kMaxAttrBytes) {
+      return "";
+    }
+    strings::StrAppend(&key, ";", attr.first, "=", serialized);
+  }
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    strings::StrAppend(&key, ";", c->DebugString(c->input(i)));
+  }
+  return key;
+}
+
+bool ShapeRefiner::TryShapeCacheLookup(const string& cache_key,
+                                       InferenceContext* c) {
+  std::vector<TensorShapeProto> output_shapes;
+  if (!shape_cache_->Lookup(cache_key, &output_shapes)) return false;
+  if (output_shapes.size() != static_cast<size_t>(c->num_outputs())) {
+    return false;
+  }
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    ShapeHandle shape;
+    if (!c->MakeShapeFromShapeProto(output_shapes[i], &shape).ok()) {
+      return false;
+    }
+    c->set_output(i, shape);
+  }
+  return true;
+}
+
+void ShapeRefiner::MaybeCacheShapeResult(const string& cache_key,
+                                         InferenceContext* c) {
+  // Results that depended on the values of input tensors, or that produced
+  // handle data on an output, depend on more than the cache key describes.
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    if (c->requested_input_tensor(i) ||
+        c->requested_input_tensor_as_partial_shape(i)) {
+      return;
+    }
+  }
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    if (c->output_handle_shapes_and_types(i) != nullptr) return;
+  }
+  std::vector<TensorShapeProto> output_shapes(c->num_outputs());
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    c->ShapeHandleToProto(c->output(i), &output_shapes[i]);
+  }
+  shape_cache_->Insert(cache_key, std::move(output_shapes));
+}
+
 bool ShapeRefiner::SameDefinedShape(InferenceContext* c, ShapeHandle s0,
                                     ShapeHandle s1) {
   if (s0.SameHandle(s1)) {
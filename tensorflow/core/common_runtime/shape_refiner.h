@@ -15,20 +15,55 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace grappler {
 class GraphProperties;
 }
 
+// A cache of inferred output shapes keyed by op, attrs and input shapes, used
+// to avoid re-running shape functions for identical nodes across graph loads.
+// Thread-safe, and may be shared by any number of ShapeRefiners.
+//
+// Only results that depend on nothing but the key are stored: nodes whose
+// shape function requested input tensor values, produced resource handle
+// data, or descended into a function body are always re-inferred.
+class ShapeInferenceCache {
+ public:
+  // Returns a process-wide cache, shared by all graph loads.
+  static ShapeInferenceCache* Global();
+
+  // If `key` is present, copies the cached output shapes to `*output_shapes`
+  // and returns true.
+  bool Lookup(const string& key,
+              std::vector<TensorShapeProto>* output_shapes);
+
+  // Stores `output_shapes` under `key`. No-op if the cache is full.
+  void Insert(const string& key, std::vector<TensorShapeProto> output_shapes);
+
+ private:
+  // Bounds the memory the cache can consume. Entries are small (a key and a
+  // few TensorShapeProtos), so this is mostly a safety net for pathological
+  // graphs. This could be changed to some kind of LRU cache if eviction
+  // eventually becomes a concern.
+  static constexpr int64 kMaxEntries = 100000;
+
+  mutex mu_;
+  std::unordered_map<string, std::vector<TensorShapeProto>> cache_
+      GUARDED_BY(mu_);
+};
+
 // This class stores extra inference information in addition to
 // InferenceContext, such as inference tree for user-defined functions and node
 // input and output types.
@@ -169,6 +204,14 @@ class ShapeRefiner {
     return function_library_ != nullptr;
   }
 
+  // Sets the cache used to reuse shape inference results of identical nodes,
+  // e.g. ShapeInferenceCache::Global() to share results across graph loads.
+  // May be nullptr (the default) to disable reuse. The cache must outlive
+  // the shape refiner.
+  void set_shape_inference_cache(ShapeInferenceCache* cache) {
+    shape_cache_ = cache;
+  }
+
   // Call this to keep nested shapes information for user-defined functions:
   // nested inferences will be available on the ExtendedInferenceContext for
   // each function node, forming a tree of shape inferences corresponding to the
@@ -260,6 +303,23 @@ class ShapeRefiner {
   Status RunShapeFn(const Node* node, const OpRegistrationData* op_reg_data,
                     ExtendedInferenceContext* ec);
 
+  // Returns the shape cache key for 'node' given the input shapes recorded in
+  // 'c', or the empty string if the node's result is known in advance not to
+  // be cacheable (e.g. function calls, or inputs carrying handle data).
+  string ShapeCacheKey(const Node* node,
+                       shape_inference::InferenceContext* c) const;
+
+  // Sets 'c's output shapes from the cache entry for 'cache_key', if any.
+  // Returns true on a cache hit.
+  bool TryShapeCacheLookup(const string& cache_key,
+                           shape_inference::InferenceContext* c);
+
+  // Caches 'c's output shapes under 'cache_key', unless the shape function
+  // depended on information that is not part of the key (requested input
+  // tensors, or handle data on an output).
+  void MaybeCacheShapeResult(const string& cache_key,
+                             shape_inference::InferenceContext* c);
+
   int32 graph_def_version_;
   const OpRegistryInterface* const ops_registry_;
 
@@ -285,6 +345,10 @@ class ShapeRefiner {
   bool require_shape_inference_fns_ = true;
   bool disable_constant_propagation_ = false;
 
+  // Optional cache of inferred output shapes, not owned. See
+  // set_shape_inference_cache().
+  ShapeInferenceCache* shape_cache_ = nullptr;
+
   // Function library is optional, but has to be set to enable function
   // shape inference.
   const tensorflow::FunctionLibraryDefinition* function_library_ = nullptr;
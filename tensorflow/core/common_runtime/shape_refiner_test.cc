@@ -1567,5 +1567,45 @@ TEST_F(ShapeRefinerTest, FunctionShapeInferenceWorksForResourceHandles) {
   EXPECT_RESOURCE_SINGLE_TYPE(DataType::DT_FLOAT, m, swap, 1);
 }
 
+// An op whose shape function counts its invocations, to make shape cache
+// hits observable.
+int shape_cache_counting_op_runs = 0;
+REGISTER_OP("ShapeCacheCountingOp")
+    .Input("a: float")
+    .Output("o: float")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      ++shape_cache_counting_op_runs;
+      c->set_output(0, c->Matrix(3, 4));
+      return Status::OK();
+    });
+
+TEST_F(ShapeRefinerTest, ShapeInferenceCacheReuse) {
+  ShapeInferenceCache cache;
+  shape_cache_counting_op_runs = 0;
+
+  // Refine two identical graphs, as happens when the same model is loaded
+  // twice. The second load should reuse the first load's result instead of
+  // running the shape function again.
+  for (int load = 0; load < 2; ++load) {
+    Graph graph(OpRegistry::Global());
+    Tensor a(DT_FLOAT, TensorShape({}));
+    a.scalar<float>()() = 1.0;
+    Node* input = test::graph::Constant(&graph, a);
+    Node* node;
+    TF_ASSERT_OK(NodeBuilder("Counting", "ShapeCacheCountingOp")
+                     .Input(input)
+                     .Finalize(&graph, &node));
+
+    ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+    m.set_shape_inference_cache(&cache);
+    TF_ASSERT_OK(m.AddNode(input));
+    TF_ASSERT_OK(m.AddNode(node));
+    shape_inference::InferenceContext* ctx = m.GetContext(node);
+    EXPECT_EQ("[3,4]", ctx->DebugString(ctx->output(0)));
+  }
+
+  EXPECT_EQ(1, shape_cache_counting_op_runs);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,450 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_plan_executor.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
+typedef gtl::InlinedVector<DeviceContext*, 4> DeviceContextVec;
+typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+
+// An executor for branch-free graphs that runs from a precompiled plan.
+//
+// Initialize() flattens the graph into a topologically-ordered array of
+// kernels with, for each kernel, the locations in a flat input vector that
+// its outputs must be forwarded to, the number of edges it waits on, and the
+// indices of its consumers. All of the pending-count, frame, and iteration
+// bookkeeping that ExecutorState re-derives every step therefore reduces to
+// one atomic dependency counter per node per step.
+//
+// The input-forwarding layout is the same as the single-threaded executor's
+// (see single_threaded_executor.cc): the inputs of kernel `i` occupy the
+// contiguous range `[input_start_index, input_start_index + num_inputs)` of
+// a flat per-step vector, and each slot is written by exactly one producer.
+class StaticPlanExecutorImpl : public Executor {
+ public:
+  explicit StaticPlanExecutorImpl(const LocalExecutorParams& params)
+      : params_(params) {}
+
+  void set_fallback(std::unique_ptr<Executor> fallback) {
+    fallback_ = std::move(fallback);
+  }
+
+  ~StaticPlanExecutorImpl() override {
+    for (const KernelState& kernel_state : kernels_) {
+      // `kernel` may be null if Initialize() failed partway through.
+      if (kernel_state.kernel != nullptr) {
+        params_.delete_kernel(kernel_state.kernel);
+      }
+    }
+  }
+
+  Status Initialize(const Graph& graph) {
+    std::vector<Node*> ordered_nodes;
+    ordered_nodes.reserve(graph.num_nodes());
+    GetReversePostOrder(graph, &ordered_nodes);
+
+    if (ordered_nodes.size() != graph.num_nodes()) {
+      return errors::InvalidArgument("Graph had ", graph.num_nodes(),
+                                     " but reverse post-order had ",
+                                     ordered_nodes.size());
+    }
+
+    kernels_.resize(ordered_nodes.size());
+
+    std::unordered_map<Node*, size_t> node_to_index_map;
+
+    for (size_t i = 0; i < ordered_nodes.size(); ++i) {
+      Node* n = ordered_nodes[i];
+      node_to_index_map[n] = i;
+
+      KernelState& kernel_state = kernels_[i];
+      TF_RETURN_IF_ERROR(params_.create_kernel(n->def(), &kernel_state.kernel));
+      if (kernel_state.kernel->AsAsync() != nullptr) {
+        // Asynchronous kernels cannot be detected without instantiating the
+        // kernel, so this failure mode is reached even for graphs that
+        // passed StaticPlanExecutorSupports().
+        return errors::Unimplemented(
+            "Static-plan executor does not support asynchronous kernels.  "
+            "But saw async kernel in node ",
+            n->name());
+      }
+      kernel_state.num_inputs = n->num_inputs();
+      kernel_state.num_outputs = n->num_outputs();
+      kernel_state.initial_pending = n->in_edges().size();
+
+      if (i == 0) {
+        kernel_state.input_start_index = 0;
+      } else {
+        const KernelState& previous_kernel_state = kernels_[i - 1];
+        kernel_state.input_start_index =
+            previous_kernel_state.input_start_index +
+            previous_kernel_state.num_inputs;
+      }
+
+      if (kernel_state.initial_pending == 0) {
+        initial_ready_.push_back(i);
+      }
+    }
+
+    // Build, for each node, the forwarding locations of its outputs and the
+    // indices of its consumers (one entry per out edge, matching the one
+    // pending count charged per in edge on the consumer side).
+    for (size_t i = 0; i < ordered_nodes.size(); ++i) {
+      Node* n = ordered_nodes[i];
+      KernelState& kernel_state = kernels_[i];
+      kernel_state.output_locations.resize(kernel_state.num_outputs);
+      for (const Edge* e : n->out_edges()) {
+        kernel_state.consumers.push_back(node_to_index_map[e->dst()]);
+        if (!e->IsControlEdge()) {
+          kernel_state.output_locations[e->src_output()].push_back(
+              kernels_[node_to_index_map[e->dst()]].input_start_index +
+              e->dst_input());
+        }
+      }
+
+      // Compute allocator attributes for each node output.
+      kernel_state.output_alloc_attrs.resize(kernel_state.num_outputs);
+      AllocatorAttributes* attrs = kernel_state.output_alloc_attrs.data();
+
+      OpKernel* op_kernel = kernel_state.kernel;
+      for (int out = 0; out < n->num_outputs(); out++) {
+        DCHECK_LT(out, op_kernel->output_memory_types().size());
+        bool on_host = op_kernel->output_memory_types()[out] == HOST_MEMORY;
+        if (on_host) {
+          AllocatorAttributes h;
+          h.set_on_host(on_host);
+          attrs[out].Merge(h);
+        }
+      }
+    }
+
+    if (!kernels_.empty()) {
+      const KernelState& last_kernel_state = kernels_.back();
+      total_num_inputs_ =
+          last_kernel_state.input_start_index + last_kernel_state.num_inputs;
+      input_alloc_attrs_.resize(total_num_inputs_);
+      for (size_t i = 0; i < ordered_nodes.size(); ++i) {
+        for (size_t j = 0; j < kernels_[i].output_locations.size(); ++j) {
+          for (size_t output_location : kernels_[i].output_locations[j]) {
+            input_alloc_attrs_[output_location] =
+                kernels_[i].output_alloc_attrs[j];
+          }
+        }
+      }
+    } else {
+      total_num_inputs_ = 0;
+    }
+    return Status::OK();
+  }
+
+  void RunAsync(const Args& args, DoneCallback done) override {
+    // The plan executor does not produce per-node step stats; delegate runs
+    // that request them to the general executor.
+    if (args.stats_collector != nullptr && fallback_ != nullptr) {
+      fallback_->RunAsync(args, std::move(done));
+      return;
+    }
+    if (kernels_.empty()) {
+      done(Status::OK());
+      return;
+    }
+    StepState* step = new StepState(kernels_.size(), total_num_inputs_, args,
+                                    std::move(done));
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      step->pending[i].store(kernels_[i].initial_pending,
+                             std::memory_order_relaxed);
+    }
+    step->num_active.store(initial_ready_.size(), std::memory_order_relaxed);
+    for (size_t node_index : initial_ready_) {
+      args.runner([this, step, node_index]() { Process(step, node_index); });
+    }
+  }
+
+ private:
+  // Per-step state shared by all tasks of one RunAsync() call.
+  struct StepState {
+    StepState(size_t num_kernels, size_t num_inputs, const Args& args,
+              DoneCallback done)
+        : inputs(num_inputs),
+          pending(new std::atomic<int32>[num_kernels]),
+          args(args),
+          done(std::move(done)) {}
+
+    // The flat input-forwarding vector. Each slot is written by exactly one
+    // producer kernel and read by exactly one consumer kernel; the
+    // dependency counters order those accesses. Slots are reset as soon as
+    // the consumer has run so buffers are released early, and any slots
+    // left populated by an error are released by the vector destructor.
+    std::vector<Tensor> inputs;
+    std::unique_ptr<std::atomic<int32>[]> pending;
+    // Number of tasks currently queued or running. The task that drops this
+    // to zero completes the step.
+    std::atomic<int64> num_active;
+    // Set when any kernel fails; remaining tasks drain without executing.
+    std::atomic<bool> has_error{false};
+    mutex mu;
+    Status status GUARDED_BY(mu);
+    const Args args;
+    DoneCallback done;
+  };
+
+  // Executes the kernel at `node_index` and then any newly-ready consumer,
+  // looping inline on one ready node at a time and handing the rest to the
+  // runner.
+  void Process(StepState* step, size_t node_index) {
+    TensorValueVec node_inputs;
+    DeviceContextVec input_device_contexts;
+    AllocatorAttributeVec input_alloc_attrs;
+
+    OpKernelContext::Params params;
+    params.step_id = step->args.step_id;
+    Device* device = params_.device;
+    params.device = device;
+    params.log_memory = false;
+    params.record_tensor_accesses = false;
+    params.rendezvous = step->args.rendezvous;
+    params.session_state = step->args.session_state;
+    params.session_handle = step->args.session_handle;
+    params.tensor_store = step->args.tensor_store;
+    params.cancellation_manager = step->args.cancellation_manager;
+    params.call_frame = step->args.call_frame;
+    params.function_library = params_.function_library;
+    params.resource_manager = device->resource_manager();
+    params.step_container = step->args.step_container;
+    params.slice_reader_cache = nullptr;
+    params.inputs = &node_inputs;
+    params.input_device_contexts = &input_device_contexts;
+    params.input_alloc_attrs = &input_alloc_attrs;
+    Args::Runner runner_copy = step->args.runner;
+    params.runner = &runner_copy;
+    params.stats_collector = nullptr;
+
+    // The graph is loopless and condless.
+    params.frame_iter = FrameAndIter(0, 0);
+    params.is_input_dead = false;
+    params.op_device_context = nullptr;
+    params.forward_from_array = nullptr;
+
+    while (true) {
+      const KernelState& kernel_state = kernels_[node_index];
+      const size_t input_start_index = kernel_state.input_start_index;
+      const size_t num_inputs = kernel_state.num_inputs;
+      const size_t num_outputs = kernel_state.num_outputs;
+
+      bool failed = step->has_error.load(std::memory_order_relaxed);
+      if (!failed) {
+        node_inputs.clear();
+        node_inputs.resize(num_inputs);
+        input_alloc_attrs.clear();
+        input_alloc_attrs.resize(num_inputs);
+        for (size_t j = 0; j < num_inputs; ++j) {
+          node_inputs[j].tensor = &step->inputs[input_start_index + j];
+          input_alloc_attrs[j] = input_alloc_attrs_[input_start_index + j];
+        }
+        input_device_contexts.clear();
+        input_device_contexts.resize(num_inputs);
+        params.op_kernel = kernel_state.kernel;
+        params.output_attr_array = kernel_state.output_alloc_attrs.data();
+        OpKernelContext ctx(&params, num_outputs);
+
+        device->Compute(kernel_state.kernel, &ctx);
+
+        if (!ctx.status().ok()) {
+          RecordError(step, ctx.status());
+          failed = true;
+        } else {
+          // Release the inputs to this kernel, then forward its outputs to
+          // the input slots of its consumers.
+          for (size_t j = 0; j < num_inputs; ++j) {
+            step->inputs[input_start_index + j] = Tensor();
+          }
+          for (size_t j = 0; j < num_outputs; ++j) {
+            TensorValue val = ctx.release_output(j);
+            if (val.tensor == nullptr) {
+              if (!kernel_state.output_locations[j].empty()) {
+                RecordError(step,
+                            errors::Internal(
+                                "Missing ", j, "-th output from node ",
+                                kernel_state.kernel->name()));
+                failed = true;
+              }
+              continue;
+            }
+            for (size_t output_location : kernel_state.output_locations[j]) {
+              step->inputs[output_location] = *val.tensor;
+            }
+            delete val.tensor;
+          }
+        }
+      }
+
+      // Activate consumers. After an error the step just drains: tasks that
+      // are already queued still run (and skip their kernel), but no new
+      // tasks are created, and nodes that never become ready are abandoned.
+      gtl::InlinedVector<size_t, 8> ready;
+      if (!failed) {
+        for (size_t consumer : kernel_state.consumers) {
+          if (step->pending[consumer].fetch_sub(
+                  1, std::memory_order_acq_rel) == 1) {
+            ready.push_back(consumer);
+          }
+        }
+      }
+
+      if (ready.empty()) {
+        if (step->num_active.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          FinishStep(step);
+        }
+        return;
+      }
+      if (ready.size() > 1) {
+        step->num_active.fetch_add(ready.size() - 1,
+                                   std::memory_order_relaxed);
+        for (size_t i = 1; i < ready.size(); ++i) {
+          const size_t next_index = ready[i];
+          runner_copy([this, step, next_index]() {
+            Process(step, next_index);
+          });
+        }
+      }
+      node_index = ready[0];
+    }
+  }
+
+  void RecordError(StepState* step, const Status& status) {
+    {
+      mutex_lock l(step->mu);
+      if (step->status.ok()) {
+        step->status = status;
+      }
+    }
+    step->has_error.store(true, std::memory_order_relaxed);
+  }
+
+  void FinishStep(StepState* step) {
+    Status status;
+    {
+      mutex_lock l(step->mu);
+      status = step->status;
+    }
+    if (status.ok() && step->args.sync_on_finish) {
+      status = params_.device->Sync();
+    }
+    DoneCallback done = std::move(step->done);
+    delete step;
+    done(status);
+  }
+
+  const LocalExecutorParams params_;
+
+  // Runs steps that request per-node stats. May be null.
+  std::unique_ptr<Executor> fallback_;
+
+  // All following members are read-only after Initialize().
+
+  // The sum of the number of inputs for each node in the graph; the length
+  // of the flat per-step input vector.
+  size_t total_num_inputs_;
+
+  // The compiled plan entry for each kernel, in topological order.
+  struct KernelState {
+    // The kernel object. Not owned.
+    //
+    // This pointer is managed by `params_.create_kernel()` and
+    // `params_.delete_kernel()`.
+    OpKernel* kernel;
+
+    // These fields determine the range of elements in the flat per-step
+    // input vector that corresponds to the inputs of `kernel`.
+    size_t input_start_index;
+    size_t num_inputs;
+
+    size_t num_outputs;
+
+    // Number of in edges (data and control); the starting value of this
+    // node's per-step dependency counter.
+    int32 initial_pending;
+
+    // For the `j`th output of `kernel`, `output_locations[j]` contains the
+    // locations in the flat per-step input vector to which that output must
+    // be forwarded.
+    std::vector<std::vector<size_t>>
+        output_locations;  // Length = `num_outputs`.
+
+    // Indices into `kernels_` of this node's consumers, one entry per out
+    // edge (data and control).
+    std::vector<size_t> consumers;
+
+    // Memory space information for each output of `kernel`.
+    std::vector<AllocatorAttributes>
+        output_alloc_attrs;  // Length = `num_outputs`.
+  };
+  std::vector<KernelState> kernels_;
+
+  // Indices of the kernels with no in edges, which every step starts from.
+  std::vector<size_t> initial_ready_;
+
+  // Memory space information for each input, in the same order as the flat
+  // per-step input vector.
+  std::vector<AllocatorAttributes>
+      input_alloc_attrs_;  // Length = `total_num_inputs_`.
+};
+
+}  // namespace
+
+bool StaticPlanExecutorSupports(const Graph& graph) {
+  for (const Node* n : graph.nodes()) {
+    for (DataType dt : n->output_types()) {
+      if (IsRefType(dt)) {
+        return false;
+      }
+    }
+    if (n->IsControlFlow() || n->IsSend() || n->IsHostSend() || n->IsRecv() ||
+        n->IsHostRecv() || n->IsCollective()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             const Graph& graph,
+                             std::unique_ptr<Executor>* fallback,
+                             Executor** executor) {
+  std::unique_ptr<StaticPlanExecutorImpl> impl(
+      new StaticPlanExecutorImpl(params));
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  if (fallback != nullptr) {
+    impl->set_fallback(std::move(*fallback));
+  }
+  *executor = impl.release();
+  return Status::OK();
+}
+
+}  // namespace tensorflow
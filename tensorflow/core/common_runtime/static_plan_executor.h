@@ -0,0 +1,52 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/executor.h"
+
+namespace tensorflow {
+
+// Returns true if `graph` is eligible for the static-plan executor: no
+// control flow, no send/recv, no collective ops, and no reference-typed
+// edges. This check is cheap (a single pass over the nodes) and does not
+// instantiate any kernels; NewStaticPlanExecutor() can still fail for an
+// eligible graph if one of its kernels turns out to be asynchronous.
+bool StaticPlanExecutorSupports(const Graph& graph);
+
+// Creates an executor that runs `graph` from a compiled execution plan: a
+// flat topologically-ordered kernel array with precomputed input forwarding
+// locations and per-node dependency counts. Per-step work is limited to one
+// atomic counter per node; there is no frame or iteration bookkeeping.
+// Ready kernels are dispatched to Args::runner, so independent branches of
+// the graph still run in parallel.
+//
+// `fallback` may be null (or point to a null executor). If an executor is
+// supplied, ownership is taken on success only, and runs that request
+// per-node statistics (Args::stats_collector) are delegated to it, since
+// the plan executor does not produce step stats. On failure `*fallback` is
+// left untouched so the caller can still use it.
+//
+// The executor does not retain a reference to `graph`.
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             const Graph& graph,
+                             std::unique_ptr<Executor>* fallback,
+                             Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
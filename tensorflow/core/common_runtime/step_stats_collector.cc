@@ -23,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -195,8 +197,12 @@ void NodeExecStatsWrapper::Finalize() {
   allocations_.clear();
 }
 
-StepStatsCollector::StepStatsCollector(StepStats* step_stats)
-    : finalized_(false), step_stats_(step_stats) {}
+StepStatsCollector::StepStatsCollector(StepStats* step_stats,
+                                       float node_sample_rate)
+    : finalized_(false),
+      step_stats_(step_stats),
+      node_sample_rate_(node_sample_rate),
+      sample_seed_(random::New64()) {}
 
 static int ExtractGpuWithStreamAll(string device_name) {
   // Check if the device name matches the ".*gpu:(\\d+)/stream:all$" regexp,
@@ -431,6 +437,16 @@ NodeExecStatsInterface* StepStatsCollector::CreateNodeExecStats(
   if (IsSend(node) || IsRecv(node)) {
     return nullptr;
   }
+  if (node_sample_rate_ > 0.0f && node_sample_rate_ < 1.0f) {
+    // Deterministic within the step (a node is either fully measured or
+    // skipped) but reseeded per collector, so repeated cost-model steps
+    // cover different subsets of the graph.
+    const uint64 bucket =
+        Hash64Combine(sample_seed_, static_cast<uint64>(node->id())) % 1000000;
+    if (bucket >= static_cast<uint64>(node_sample_rate_ * 1000000.0f)) {
+      return nullptr;
+    }
+  }
   return new NodeExecStatsWrapper(node, this);
 }
 
@@ -160,8 +160,12 @@ class StepStatsCollectorInterface {
 // Each DeviceStats object holds multiple NodeExecStats.
 class StepStatsCollector : public StepStatsCollectorInterface {
  public:
-  // Does not take ownership of `step_stats`.
-  explicit StepStatsCollector(StepStats* step_stats);
+  // Does not take ownership of `step_stats`.  If `node_sample_rate` is in
+  // (0, 1), CreateNodeExecStats only returns stats for that fraction of
+  // nodes, chosen pseudo-randomly per step, so sampled cost collection can
+  // run in production without full-tracing overhead.
+  explicit StepStatsCollector(StepStats* step_stats,
+                              float node_sample_rate = 1.0f);
 
   // BuildCostModel builds or updates a CostModel managed by cost_model_manager,
   // using the currently collected DeviceStats associated with the devices in
@@ -205,6 +209,11 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   std::unordered_map<string, ThreadNamesMap> thread_names_ GUARDED_BY(mu_);
   StepStats* step_stats_ GUARDED_BY(mu_);
   uint64 collected_nodes_ GUARDED_BY(mu_) = 0;
+
+  // Fraction of nodes to collect stats for, and the per-step seed used to
+  // pick the sampled subset.  Immutable after construction.
+  const float node_sample_rate_;
+  const uint64 sample_seed_;
 };
 
 }  // namespace tensorflow
@@ -25,7 +25,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb_text.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
+#include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
@@ -49,6 +51,13 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  if (options.config.experimental().use_numa_affinity()) {
+    // Cache the per-node allocators so the hot path in GetAllocator() can
+    // index them without taking ProcessState's mutex.
+    for (int i = 0; i < port::NUMANumNodes(); ++i) {
+      numa_allocators_.push_back(ProcessState::singleton()->GetCPUAllocator(i));
+    }
+  }
 #ifdef INTEL_MKL
   // Early return when MKL is disabled
   if (DisableMKL()) return;
@@ -74,6 +83,18 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
 ThreadPoolDevice::~ThreadPoolDevice() {}
 
 Allocator* ThreadPoolDevice::GetAllocator(AllocatorAttributes attr) {
+  // With NUMA affinity enabled, allocate from the arena local to the calling
+  // thread's node: each node has its own allocator (and hence its own lock),
+  // which partitions both allocator contention and cross-socket memory
+  // traffic.  Frees always return to the owning arena because the
+  // TensorBuffer records the allocator that produced it.
+  if (!numa_allocators_.empty()) {
+    const int numa_node = port::NUMAGetThreadNodeAffinity();
+    if (numa_node != port::kNUMANoAffinity &&
+        static_cast<size_t>(numa_node) < numa_allocators_.size()) {
+      return numa_allocators_[numa_node];
+    }
+  }
   return allocator_;
 }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_THREADPOOL_DEVICE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_THREADPOOL_DEVICE_H_
 
+#include <vector>
+
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 
@@ -44,6 +46,10 @@ class ThreadPoolDevice : public LocalDevice {
  private:
   Allocator* allocator_;  // Not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+  // When NUMA affinity is enabled, the per-NUMA-node allocators, indexed by
+  // node.  Cached here so GetAllocator() does not go through ProcessState's
+  // mutex on every allocation.  Not owned.
+  std::vector<Allocator*> numa_allocators_;
 };
 
 }  // namespace tensorflow
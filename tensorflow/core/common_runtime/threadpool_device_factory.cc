@@ -32,10 +32,20 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<std::unique_ptr<Device>>* devices) override {
     int num_numa_nodes = port::NUMANumNodes();
+    if (options.config.experimental().use_numa_affinity()) {
+      // Partition the CPU allocator into per-NUMA-node arenas; see
+      // ProcessState::GetCPUAllocator.
+      ProcessState::singleton()->EnableNUMA();
+    }
     int n = 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
+    } else if (options.config.experimental().use_numa_affinity()) {
+      // One CPU device per NUMA node, each backed by an intra-op pool whose
+      // workers are pinned to that node (see ThreadPool) and by the
+      // node-local allocator, so an op's compute runs next to its buffers.
+      n = num_numa_nodes;
     }
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
@@ -0,0 +1,62 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/threadpool_quota.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+ThreadPoolQuota::ThreadPoolQuota(thread::ThreadPool* pool,
+                                 int32 max_concurrency)
+    : pool_(pool), max_concurrency_(max_concurrency) {
+  CHECK_GT(max_concurrency_, 0);
+}
+
+void ThreadPoolQuota::Schedule(std::function<void()> fn) {
+  {
+    mutex_lock l(mu_);
+    if (in_flight_ >= max_concurrency_) {
+      queued_.push_back(std::move(fn));
+      return;
+    }
+    ++in_flight_;
+  }
+  // NOTE: fn is captured by copy; C++11 lambdas cannot move-capture.
+  pool_->Schedule([this, fn]() { RunAndScheduleNext(fn); });
+}
+
+void ThreadPoolQuota::RunAndScheduleNext(std::function<void()> fn) {
+  fn();
+  std::function<void()> next;
+  {
+    mutex_lock l(mu_);
+    if (queued_.empty()) {
+      --in_flight_;
+      return;
+    }
+    next = std::move(queued_.front());
+    queued_.pop_front();
+  }
+  // The finished closure's slot passes to the dequeued one, so in_flight_
+  // is unchanged.  Resubmitting through the pool instead of running next
+  // inline puts it behind work other tenants have already queued there,
+  // keeping the shared pool fair.
+  pool_->Schedule([this, next]() { RunAndScheduleNext(next); });
+}
+
+}  // namespace tensorflow
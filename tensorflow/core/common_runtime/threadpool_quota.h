@@ -0,0 +1,70 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_THREADPOOL_QUOTA_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_THREADPOOL_QUOTA_H_
+
+#include <deque>
+#include <functional>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Admission control for a shared inter-op threadpool.
+//
+// Several sessions may point at one process-wide pool (see the global_name
+// field of ThreadPoolOptionProto).  A ThreadPoolQuota sits between one such
+// session and the pool and caps how many of the session's closures may run
+// on the pool concurrently; closures beyond the cap are queued here and
+// submitted as running ones finish.  The pool's threads therefore stay
+// shared, but no single tenant can occupy all of them, and the relative
+// quota sizes act as scheduling weights between the tenants.
+//
+// This class is thread-safe.  The underlying pool is not owned and must
+// outlive this object, and all scheduled closures must have finished
+// before this object is destroyed; DirectSession guarantees both by
+// waiting for outstanding steps before tearing down its pools.
+class ThreadPoolQuota {
+ public:
+  // Caps this tenant at max_concurrency concurrently running closures.
+  // max_concurrency must be positive.
+  ThreadPoolQuota(thread::ThreadPool* pool, int32 max_concurrency);
+
+  // Runs fn on the wrapped pool: immediately if fewer than max_concurrency
+  // of this tenant's closures are running, otherwise once one of them
+  // finishes.
+  void Schedule(std::function<void()> fn);
+
+ private:
+  // Runs fn, then submits the longest-waiting queued closure, if any.
+  void RunAndScheduleNext(std::function<void()> fn);
+
+  thread::ThreadPool* const pool_;  // not owned
+  const int32 max_concurrency_;
+
+  mutex mu_;
+  int32 in_flight_ GUARDED_BY(mu_) = 0;
+  std::deque<std::function<void()>> queued_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ThreadPoolQuota);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_THREADPOOL_QUOTA_H_
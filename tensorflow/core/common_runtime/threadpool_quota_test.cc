@@ -0,0 +1,98 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/threadpool_quota.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ThreadPoolQuotaTest, RunsAllClosures) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  ThreadPoolQuota quota(&pool, 2);
+  std::atomic<int32> count(0);
+  BlockingCounter counter(100);
+  for (int i = 0; i < 100; ++i) {
+    quota.Schedule([&count, &counter]() {
+      ++count;
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  EXPECT_EQ(100, count.load());
+}
+
+TEST(ThreadPoolQuotaTest, CapsConcurrency) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  ThreadPoolQuota quota(&pool, 2);
+  mutex mu;
+  int32 running = 0;
+  int32 max_running = 0;
+  BlockingCounter counter(50);
+  for (int i = 0; i < 50; ++i) {
+    quota.Schedule([&mu, &running, &max_running, &counter]() {
+      {
+        mutex_lock l(mu);
+        ++running;
+        max_running = std::max(max_running, running);
+      }
+      Env::Default()->SleepForMicroseconds(1000);
+      {
+        mutex_lock l(mu);
+        --running;
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  mutex_lock l(mu);
+  EXPECT_LE(max_running, 2);
+  EXPECT_EQ(0, running);
+}
+
+TEST(ThreadPoolQuotaTest, SharedPoolIndependentQuotas) {
+  // Two tenants with different quotas on one pool; both finish and
+  // neither exceeds its own cap.
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  ThreadPoolQuota quota_a(&pool, 1);
+  ThreadPoolQuota quota_b(&pool, 3);
+  std::atomic<int32> running_a(0);
+  std::atomic<bool> a_exceeded(false);
+  BlockingCounter counter(40);
+  for (int i = 0; i < 20; ++i) {
+    quota_a.Schedule([&running_a, &a_exceeded, &counter]() {
+      if (++running_a > 1) a_exceeded = true;
+      Env::Default()->SleepForMicroseconds(500);
+      --running_a;
+      counter.DecrementCount();
+    });
+    quota_b.Schedule([&counter]() {
+      Env::Default()->SleepForMicroseconds(500);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  EXPECT_FALSE(a_exceeded.load());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -137,7 +137,9 @@ BaseRemoteRendezvous::BaseRemoteRendezvous(const WorkerEnv* env, int64 step_id)
       session_(nullptr) {}
 
 BaseRemoteRendezvous::~BaseRemoteRendezvous() {
-  CHECK(active_.empty());
+  for (ActiveCallShard& shard : active_shards_) {
+    CHECK(shard.calls.empty());
+  }
   local_->Unref();
 }
 
@@ -331,6 +333,42 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
   }
 }
 
+void BaseRemoteRendezvous::RecvBulkAsync(const std::vector<ParsedKey>& keys,
+                                         const Rendezvous::Args& args,
+                                         BulkDoneCallback done) {
+  if (keys.empty()) {
+    done({});
+    return;
+  }
+  // Each pending recv writes to its own slot, so only the completion
+  // counter needs to be synchronized.
+  struct BulkState {
+    explicit BulkState(size_t n) : pending(n), results(n) {}
+    std::atomic<int64> pending;
+    std::vector<BulkRecvResult> results;
+    BulkDoneCallback done;
+  };
+  BulkState* state = new BulkState(keys.size());
+  state->done = std::move(done);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    RecvAsync(keys[i], args,
+              [state, i](const Status& status,
+                         const Rendezvous::Args& send_args,
+                         const Rendezvous::Args& recv_args, const Tensor& val,
+                         bool is_dead) {
+                BulkRecvResult* result = &state->results[i];
+                result->status = status;
+                result->recv_args = recv_args;
+                result->tensor = val;
+                result->is_dead = is_dead;
+                if (state->pending.fetch_sub(1) == 1) {
+                  state->done(std::move(state->results));
+                  delete state;
+                }
+              });
+  }
+}
+
 void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
                                           DoneCallback done) {
   {
@@ -365,30 +403,48 @@ void BaseRemoteRendezvous::StartAbort(const Status& s) {
   CHECK(!s.ok());
   local_->StartAbort(s);
   {
-    // Aborts all active RecvTensor calls.
     mutex_lock l(mu_);
-    if (status_.ok()) {
-      status_ = s;
-      for (BaseRecvTensorCall* call : active_) {
-        call->StartAbort(s);
-      }
-      active_.clear();
+    if (!status_.ok()) {
+      return;
+    }
+    status_ = s;
+  }
+  // Aborts all active RecvTensor calls.  Later registrations observe
+  // aborted_ and fail without touching the shards drained here.
+  aborted_.store(true, std::memory_order_release);
+  for (ActiveCallShard& shard : active_shards_) {
+    gtl::FlatSet<BaseRecvTensorCall*> calls;
+    {
+      mutex_lock l(shard.mu);
+      calls.swap(shard.calls);
+    }
+    for (BaseRecvTensorCall* call : calls) {
+      call->StartAbort(s);
     }
   }
 }
 
 void BaseRemoteRendezvous::RegisterCall(BaseRecvTensorCall* call) {
-  mutex_lock l(mu_);
-  if (!status_.ok()) {
-    call->StartAbort(status_);
-  } else {
-    CHECK(active_.insert(call).second);
+  ActiveCallShard* shard = active_shard(call);
+  {
+    mutex_lock l(shard->mu);
+    if (!aborted_.load(std::memory_order_acquire)) {
+      CHECK(shard->calls.insert(call).second);
+      return;
+    }
   }
+  Status s;
+  {
+    mutex_lock l(mu_);
+    s = status_;
+  }
+  call->StartAbort(s);
 }
 
 void BaseRemoteRendezvous::DeregisterCall(BaseRecvTensorCall* call) {
-  mutex_lock l(mu_);
-  active_.erase(call);
+  ActiveCallShard* shard = active_shard(call);
+  mutex_lock l(shard->mu);
+  shard->calls.erase(call);
 }
 
 BaseRemoteRendezvous::DeferredCall::DeferredCall(const ParsedKey& parsed,
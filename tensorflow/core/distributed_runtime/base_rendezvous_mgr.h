@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 
+#include <atomic>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
@@ -135,6 +137,23 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   void RecvAsync(const ParsedKey& key, const Rendezvous::Args& args,
                  DoneCallback done) override;
 
+  // Result of one key in a RecvBulkAsync() call.
+  struct BulkRecvResult {
+    Status status;
+    Args recv_args;
+    Tensor tensor;
+    bool is_dead = false;
+  };
+  typedef std::function<void(std::vector<BulkRecvResult>)> BulkDoneCallback;
+
+  // Registers receives for all of "keys" at once and runs "done" exactly
+  // once when every key has completed, with results in the same order as
+  // "keys".  Compared to issuing one RecvAsync per key with its own
+  // callback, a step receiving many small tensors schedules a single
+  // continuation instead of thousands.
+  void RecvBulkAsync(const std::vector<ParsedKey>& keys,
+                     const Rendezvous::Args& args, BulkDoneCallback done);
+
   void StartAbort(const Status& status) override;
 
   // This method is called only by the local Worker, forwarded through
@@ -192,8 +211,24 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   };
   std::vector<DeferredCall> deferred_calls_ GUARDED_BY(mu_);
 
-  // Active outstanding RecvTensor calls.
-  gtl::FlatSet<BaseRecvTensorCall*> active_ GUARDED_BY(mu_);
+  // Active outstanding RecvTensor calls, sharded by call pointer so
+  // that a step issuing thousands of concurrent recvs does not
+  // serialize every register/deregister on a single mutex.
+  static const int kActiveShards = 8;
+  struct ActiveCallShard {
+    mutex mu;
+    gtl::FlatSet<BaseRecvTensorCall*> calls GUARDED_BY(mu);
+  };
+  ActiveCallShard active_shards_[kActiveShards];
+
+  // Set once StartAbort() has drained the shards; lets RegisterCall()
+  // detect abortion without taking mu_.
+  std::atomic<bool> aborted_{false};
+
+  ActiveCallShard* active_shard(BaseRecvTensorCall* call) {
+    return &active_shards_[(reinterpret_cast<uintptr_t>(call) >> 4) %
+                           kActiveShards];
+  }
 
   bool is_initialized_locked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     return session_ != nullptr;
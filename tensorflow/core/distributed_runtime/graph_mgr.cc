@@ -43,8 +43,11 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/validate.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -66,6 +69,23 @@ GraphMgr::GraphMgr(const WorkerEnv* worker_env, DeviceMgr* device_mgr)
 
 GraphMgr::~GraphMgr() {
   for (auto p : table_) p.second->Unref();
+  for (auto p : fingerprint_table_) p.second->Unref();
+}
+
+// Fingerprints everything that determines the contents of a registered
+// graph.  Two Register() calls with equal fingerprints would build
+// identical executors, so the first registration can be reused.
+static uint64 GraphRegistrationFingerprint(const string& session,
+                                           const GraphDef& gdef,
+                                           const GraphOptions& graph_options,
+                                           const DebugOptions& debug_options,
+                                           int64 collective_graph_key) {
+  uint64 fp = DeterministicProtoHash64(gdef);
+  fp = FingerprintCat64(fp, DeterministicProtoHash64(graph_options));
+  fp = FingerprintCat64(fp, DeterministicProtoHash64(debug_options));
+  fp = FingerprintCat64(fp, Fingerprint64(session));
+  fp = FingerprintCat64(fp, static_cast<uint64>(collective_graph_key));
+  return fp;
 }
 
 GraphMgr::Item::~Item() {
@@ -176,14 +196,14 @@ Status GraphMgr::InitItem(const string& session, const GraphDef& gdef,
   }
 
   std::unordered_map<string, std::unique_ptr<Graph>> partition_graphs;
-  for (const auto& partition : partitions) {
+  for (auto& partition : partitions) {
     std::unique_ptr<Graph> device_graph(new Graph(OpRegistry::Global()));
     GraphConstructorOptions device_opts;
     // There are internal operations (e.g., send/recv) that we now allow.
     device_opts.allow_internal_ops = true;
     device_opts.expect_device_spec = true;
-    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(device_opts, partition.second,
-                                              device_graph.get()));
+    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
+        device_opts, std::move(partition.second), device_graph.get()));
     partition_graphs.emplace(partition.first, std::move(device_graph));
   }
 
@@ -285,6 +305,26 @@ Status GraphMgr::Register(const string& session, const GraphDef& gdef,
                           int64 collective_graph_key,
                           DistributedFunctionLibraryRuntime* cluster_flr,
                           string* handle) {
+  // Masters re-register identical partitions whenever they rebuild a
+  // client graph, e.g. for a new feed/fetch signature.  Serve those
+  // from the fingerprint cache instead of repeating partitioning,
+  // optimization and executor construction.
+  const uint64 fingerprint = GraphRegistrationFingerprint(
+      session, gdef, graph_options, debug_options, collective_graph_key);
+  {
+    mutex_lock l(mu_);
+    Item** cached = gtl::FindOrNull(fingerprint_table_, fingerprint);
+    if (cached != nullptr) {
+      Item* item = *cached;
+      item->Ref();
+      *handle = strings::Printf("%016llx", ++next_id_);
+      CHECK(table_.insert({*handle, item}).second);
+      VLOG(1) << "Reusing registered graph " << item->handle << " for handle "
+              << *handle;
+      return Status::OK();
+    }
+  }
+
   Item* item = new Item;
   Status s = InitItem(session, gdef, graph_options, debug_options,
                       collective_graph_key, cluster_flr, item);
@@ -299,6 +339,11 @@ Status GraphMgr::Register(const string& session, const GraphDef& gdef,
     *handle = strings::Printf("%016llx", ++next_id_);
     item->handle = *handle;
     CHECK(table_.insert({*handle, item}).second);
+    if (fingerprint_table_.insert({fingerprint, item}).second) {
+      // The cache keeps its own reference so the item survives
+      // Deregister() and can satisfy the next identical registration.
+      item->Ref();
+    }
   }
   return Status::OK();
 }
@@ -322,13 +367,18 @@ Status GraphMgr::Deregister(const string& handle) {
 
 Status GraphMgr::DeregisterAll() {
   std::vector<Item*> items;
-  // Removes all items from table_.
+  // Removes all items from table_ and drops the fingerprint cache's
+  // references.
   {
     mutex_lock l(mu_);
     for (const auto& entry : table_) {
       items.push_back(entry.second);
     }
     table_.clear();
+    for (const auto& entry : fingerprint_table_) {
+      items.push_back(entry.second);
+    }
+    fingerprint_table_.clear();
   }
   for (auto item : items) {
     item->Unref();
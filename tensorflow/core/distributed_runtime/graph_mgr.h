@@ -162,6 +162,13 @@ class GraphMgr {
   // mechanism to gc these graphs.
   std::unordered_map<string, Item*> table_;
 
+  // Cache of registered graphs keyed by a fingerprint of the graph
+  // contents and registration options, so that re-registering an
+  // identical partition reuses the existing executors instead of
+  // repeating graph construction and optimization.  The cache owns one
+  // reference to each Item, dropped by DeregisterAll().
+  std::unordered_map<uint64, Item*> fingerprint_table_;
+
   void StartParallelExecutors(const string& handle, int64 step_id, Item* item,
                               Rendezvous* rendezvous,
                               CollectiveExecutor::Handle* ce_handle,
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
@@ -22,11 +26,35 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/eager_service.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace eager {
 namespace {
+
+// Whether Enqueue calls issued while an earlier Enqueue RPC to the same
+// context is still in flight should be coalesced into a single RPC.  This
+// amortizes per-RPC overhead when many small op batches are sent to the same
+// remote worker, at the cost of every caller in a coalesced batch sharing the
+// fate (and error status) of that one RPC.
+bool EnqueueCoalescingEnabled() {
+  static bool enabled = []() {
+    bool b = false;
+    Status status =
+        ReadBoolFromEnvVar("TF_GRPC_EAGER_ENQUEUE_COALESCING", false, &b);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      return false;
+    }
+    return b;
+  }();
+  return enabled;
+}
+
 class GrpcEagerClient : public EagerClient {
  public:
   GrpcEagerClient(const tensorflow::SharedGrpcChannelPtr& channel,
@@ -44,7 +72,6 @@ class GrpcEagerClient : public EagerClient {
   }
 
   CLIENT_METHOD(CreateContext);
-  CLIENT_METHOD(Enqueue);
   CLIENT_METHOD(WaitQueueDone);
   CLIENT_METHOD(KeepAlive);
   CLIENT_METHOD(CloseContext);
@@ -53,9 +80,112 @@ class GrpcEagerClient : public EagerClient {
 
 #undef CLIENT_METHOD
 
+  void EnqueueAsync(const EnqueueRequest* request, EnqueueResponse* response,
+                    StatusCallback done) override {
+    if (!EnqueueCoalescingEnabled()) {
+      new RPCState<protobuf::Message>(
+          &stub_, cq_, "/tensorflow.eager.EagerService/Enqueue", *request,
+          response, std::move(done), nullptr, nullptr);
+      return;
+    }
+    {
+      mutex_lock l(enqueue_mu_);
+      EnqueueState& state = enqueue_states_[request->context_id()];
+      if (state.rpc_in_flight) {
+        // An Enqueue RPC for this context is already on the wire; buffer this
+        // call and send it as part of the next coalesced RPC.
+        PendingEnqueue pending;
+        pending.request = request;
+        pending.response = response;
+        pending.done = std::move(done);
+        state.pending.push_back(std::move(pending));
+        return;
+      }
+      state.rpc_in_flight = true;
+    }
+    // The queue is idle, so send right away; coalescing never delays the
+    // first call of a burst.
+    std::vector<PendingEnqueue> batch(1);
+    batch[0].request = request;
+    batch[0].response = response;
+    batch[0].done = std::move(done);
+    SendEnqueueBatch(request->context_id(), std::move(batch));
+  }
+
  private:
+  // One buffered Enqueue call awaiting the next coalesced RPC.  The request
+  // and response are owned by the caller and stay valid until "done" runs.
+  struct PendingEnqueue {
+    const EnqueueRequest* request;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  // Per-context coalescing state.
+  struct EnqueueState {
+    bool rpc_in_flight = false;
+    std::vector<PendingEnqueue> pending;
+  };
+
+  // Owns the combined request and response of one in-flight coalesced RPC.
+  struct CoalescedEnqueue {
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<PendingEnqueue> batch;
+  };
+
+  // Issues one Enqueue RPC carrying the queue items of every call in "batch",
+  // in order.  On completion the coalesced response is split back into the
+  // callers' responses, and any calls buffered in the meantime form the next
+  // batch.
+  void SendEnqueueBatch(uint64 context_id, std::vector<PendingEnqueue> batch) {
+    CoalescedEnqueue* coalesced = new CoalescedEnqueue;
+    coalesced->batch = std::move(batch);
+    coalesced->request.set_context_id(context_id);
+    for (const PendingEnqueue& call : coalesced->batch) {
+      for (const QueueItem& item : call.request->queue()) {
+        *coalesced->request.add_queue() = item;
+      }
+    }
+    StatusCallback done = [this, context_id, coalesced](const Status& s) {
+      int offset = 0;
+      for (PendingEnqueue& call : coalesced->batch) {
+        if (s.ok()) {
+          for (int i = 0; i < call.request->queue_size(); ++i) {
+            *call.response->add_queue_response() =
+                coalesced->response.queue_response(offset + i);
+          }
+        }
+        offset += call.request->queue_size();
+        call.done(s);
+      }
+      std::vector<PendingEnqueue> next;
+      {
+        mutex_lock l(enqueue_mu_);
+        EnqueueState& state = enqueue_states_[context_id];
+        if (state.pending.empty()) {
+          state.rpc_in_flight = false;
+        } else {
+          next.swap(state.pending);
+        }
+      }
+      delete coalesced;
+      if (!next.empty()) {
+        SendEnqueueBatch(context_id, std::move(next));
+      }
+    };
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.eager.EagerService/Enqueue",
+        coalesced->request, &coalesced->response, std::move(done), nullptr,
+        nullptr);
+  }
+
   ::grpc::GenericStub stub_;
   ::grpc::CompletionQueue* cq_;
+
+  mutex enqueue_mu_;
+  std::unordered_map<uint64, EnqueueState> enqueue_states_
+      GUARDED_BY(enqueue_mu_);
 };
 
 class GrpcEagerClientCache : public EagerClientCache {
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/impl/codegen/service_type.h"
@@ -149,7 +150,10 @@ class Call : public UntypedCall<Service> {
       Call<Service, GrpcService, RequestMessage, ResponseMessage>*);
 
   Call(HandleRequestFunction handle_request_function)
-      : handle_request_function_(handle_request_function), responder_(&ctx_) {}
+      : request(*protobuf::Arena::CreateMessage<RequestMessage>(&arena_)),
+        response(*protobuf::Arena::CreateMessage<ResponseMessage>(&arena_)),
+        handle_request_function_(handle_request_function),
+        responder_(&ctx_) {}
 
   virtual ~Call() {}
 
@@ -231,8 +235,17 @@ class Call : public UntypedCall<Service> {
                                     &call->request_received_tag_);
   }
 
-  RequestMessage request;
-  ResponseMessage response;
+ private:
+  // Arena backing `request` and `response`. Allocating the messages on an
+  // arena pools their submessage and string allocations, and releases the
+  // whole tree in one shot when the call object is destroyed instead of
+  // freeing it node-by-node. Must be declared before the message references
+  // below so that it outlives them.
+  protobuf::Arena arena_;
+
+ public:
+  RequestMessage& request;
+  ResponseMessage& response;
 
   const std::multimap<::grpc::string_ref, ::grpc::string_ref>& client_metadata()
       const {
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 
+#include <stdlib.h>
+
+#include <atomic>
 #include <limits>
 #include <map>
 #include <unordered_map>
@@ -54,6 +57,24 @@ Status ValidateHostPortPair(const string& host_port) {
   return Status::OK();
 }
 
+// Number of independent gRPC channels to open per remote target,
+// controlled by the TF_GRPC_CHANNELS_PER_TARGET environment variable.
+// Each channel gets its own TCP connection, so spreading a busy worker
+// pair over several channels avoids serializing all of its traffic onto
+// a single HTTP/2 connection.
+int32 NumChannelShardsPerTarget() {
+  const char* env = getenv("TF_GRPC_CHANNELS_PER_TARGET");
+  if (env == nullptr) {
+    return 1;
+  }
+  int64 num_shards;
+  if (!strings::safe_strto64(env, &num_shards) || num_shards < 1) {
+    LOG(WARNING) << "Invalid TF_GRPC_CHANNELS_PER_TARGET: \"" << env << "\"";
+    return 1;
+  }
+  return static_cast<int32>(num_shards);
+}
+
 }  // namespace
 
 ::grpc::ChannelArguments GetChannelArguments(const RPCOptions* rpc_options) {
@@ -93,6 +114,14 @@ Status NewHostPortGrpcChannel(const string& target,
   TF_RETURN_IF_ERROR(ValidateHostPortPair(target));
 
   ::grpc::ChannelArguments args = GetChannelArguments(rpc_options);
+  if (NumChannelShardsPerTarget() > 1) {
+    // Subchannels are keyed by channel arguments, so a distinct dummy
+    // argument keeps gRPC from folding the shards back onto one shared
+    // subchannel (and hence one TCP connection).
+    static std::atomic<int64> shard_id(0);
+    args.SetInt("tf_channel_shard_id",
+                static_cast<int>(shard_id.fetch_add(1)));
+  }
   *channel_pointer = ::grpc::CreateCustomChannel(
       "dns:///" + target, ::grpc::InsecureChannelCredentials(), args);
   return Status::OK();
@@ -137,39 +166,56 @@ Status GrpcChannelSpec::AddHostPortsJob(
 namespace {
 
 // GrpcChannelCache that caches results to FindWorkerChannel() calls.
+// Opens up to NumChannelShardsPerTarget() channels per target and hands
+// them out round-robin, so concurrent transfers to a busy peer spread
+// across connections.
 class CachingGrpcChannelCache : public GrpcChannelCache {
  public:
-  CachingGrpcChannelCache() {}
+  CachingGrpcChannelCache() : num_shards_(NumChannelShardsPerTarget()) {}
 
   ~CachingGrpcChannelCache() override {}
 
   SharedGrpcChannelPtr FindWorkerChannel(const string& target) override {
-    SharedGrpcChannelPtr ch = nullptr;
     {
       mutex_lock l(mu_);  // could use reader lock
-      ch = gtl::FindPtrOrNull(channels_, target);
-      if (ch) {
-        return ch;
+      ShardedChannels* found = gtl::FindOrNull(channels_, target);
+      if (found != nullptr &&
+          found->channels.size() >= static_cast<size_t>(num_shards_)) {
+        found->next_shard = (found->next_shard + 1) % found->channels.size();
+        return found->channels[found->next_shard];
       }
     }
-    ch = FindChannelOnce(target);
+    SharedGrpcChannelPtr ch = FindChannelOnce(target);
     if (ch) {
       mutex_lock l(mu_);
-      channels_.insert({target, ch});
+      ShardedChannels& entry = channels_[target];
+      if (entry.channels.size() < static_cast<size_t>(num_shards_)) {
+        entry.channels.push_back(ch);
+      } else {
+        // Another thread filled the last shard concurrently; reuse its
+        // channel rather than keeping an extra connection alive.
+        ch = entry.channels[0];
+      }
     }
     return ch;
   }
 
  protected:
-  // Find the ClientChannel for "target".  Only called when no channel was
-  // found in the channels_ cache for "target".  A non nullptr result will be
-  // cached in channels_.
+  // Find the ClientChannel for "target".  Only called when fewer than
+  // num_shards_ channels for "target" are in the channels_ cache.  A non
+  // nullptr result will be cached in channels_.
   virtual SharedGrpcChannelPtr FindChannelOnce(const string& target) = 0;
 
  private:
+  struct ShardedChannels {
+    std::vector<SharedGrpcChannelPtr> channels;
+    int next_shard = 0;
+  };
+
+  const int num_shards_;
   // TODO(zhifengc): Eviction when the map becomes too big.
   mutex mu_;
-  std::unordered_map<string, SharedGrpcChannelPtr> channels_ GUARDED_BY(mu_);
+  std::unordered_map<string, ShardedChannels> channels_ GUARDED_BY(mu_);
 };
 
 // A ChannelCache that is the union of multiple ChannelCaches.
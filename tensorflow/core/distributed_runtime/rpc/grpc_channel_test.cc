@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 
+#include <stdlib.h>
+
 #include <string>
 #include <vector>
 
@@ -181,6 +183,33 @@ TEST(GrpcChannelTest, SparseHostPorts) {
   }
 }
 
+TEST(GrpcChannelTest, ShardedHostPorts) {
+  setenv("TF_GRPC_CHANNELS_PER_TARGET", "2", 1 /* overwrite */);
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {"a:1", "b:2"}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  std::unique_ptr<GrpcChannelCache> cc(NewGrpcChannelCache(spec, channel_func));
+
+  // The first two lookups open distinct channels for the target; later
+  // lookups rotate through them instead of opening more.
+  auto a_1 = cc->FindWorkerChannel("/job:mnist/replica:0/task:0");
+  auto a_2 = cc->FindWorkerChannel("/job:mnist/replica:0/task:0");
+  auto a_3 = cc->FindWorkerChannel("/job:mnist/replica:0/task:0");
+  auto a_4 = cc->FindWorkerChannel("/job:mnist/replica:0/task:0");
+  EXPECT_NE(a_1.get(), a_2.get());
+  EXPECT_NE(a_3.get(), a_4.get());
+  EXPECT_TRUE(a_3.get() == a_1.get() || a_3.get() == a_2.get());
+  EXPECT_TRUE(a_4.get() == a_1.get() || a_4.get() == a_2.get());
+
+  // Shards are per-target.
+  auto b_1 = cc->FindWorkerChannel("/job:mnist/replica:0/task:1");
+  EXPECT_NE(b_1.get(), a_1.get());
+  EXPECT_NE(b_1.get(), a_2.get());
+
+  unsetenv("TF_GRPC_CHANNELS_PER_TARGET");
+}
+
 TEST(GrpcChannelTest, NewHostPortGrpcChannelValidation) {
   SharedGrpcChannelPtr mock_ptr;
 
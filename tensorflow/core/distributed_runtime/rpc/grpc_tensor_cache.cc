@@ -0,0 +1,126 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_cache.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+// Default bound on cached tensor bytes when
+// TF_GRPC_RECV_TENSOR_CACHE_BYTES is unset.
+const int64 kDefaultMaxCacheBytes = 256 << 20;  // 256MB
+}  // namespace
+
+/* static */
+std::unique_ptr<GrpcTensorCache> GrpcTensorCache::CreateFromEnv() {
+  const char* prefixes_env = getenv("TF_GRPC_IMMUTABLE_TENSORS");
+  if (prefixes_env == nullptr || *prefixes_env == '\0') {
+    return nullptr;
+  }
+  std::vector<string> prefixes =
+      str_util::Split(prefixes_env, ',', str_util::SkipEmpty());
+  if (prefixes.empty()) {
+    return nullptr;
+  }
+  int64 max_bytes = kDefaultMaxCacheBytes;
+  const char* bytes_env = getenv("TF_GRPC_RECV_TENSOR_CACHE_BYTES");
+  if (bytes_env != nullptr &&
+      (!strings::safe_strto64(bytes_env, &max_bytes) || max_bytes < 0)) {
+    LOG(WARNING) << "Invalid TF_GRPC_RECV_TENSOR_CACHE_BYTES: \"" << bytes_env
+                 << "\"";
+    max_bytes = kDefaultMaxCacheBytes;
+  }
+  VLOG(1) << "Enabling gRPC immutable tensor cache for " << prefixes.size()
+          << " name prefixes, " << max_bytes << " bytes";
+  return std::unique_ptr<GrpcTensorCache>(
+      new GrpcTensorCache(std::move(prefixes), max_bytes));
+}
+
+GrpcTensorCache::GrpcTensorCache(std::vector<string> immutable_prefixes,
+                                 int64 max_bytes)
+    : immutable_prefixes_(std::move(immutable_prefixes)),
+      max_bytes_(max_bytes) {}
+
+bool GrpcTensorCache::IsCacheable(StringPiece tensor_name) const {
+  for (const string& prefix : immutable_prefixes_) {
+    if (str_util::StartsWith(tensor_name, prefix)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GrpcTensorCache::Lookup(const string& key, Tensor* tensor) {
+  mutex_lock l(mu_);
+  auto it = cache_.find(key);
+  if (it == cache_.end()) {
+    return false;
+  }
+  it->second.last_use = ++use_counter_;
+  *tensor = it->second.tensor;
+  VLOG(2) << "GrpcTensorCache hit for " << key;
+  return true;
+}
+
+void GrpcTensorCache::Insert(const string& key, StringPiece tensor_name,
+                             const Tensor& tensor) {
+  const int64 bytes = tensor.TotalBytes();
+  if (bytes > max_bytes_) {
+    return;
+  }
+  mutex_lock l(mu_);
+  Entry& entry = cache_[key];
+  total_bytes_ += bytes - entry.tensor.TotalBytes();
+  entry.tensor = tensor;
+  entry.tensor_name = string(tensor_name);
+  entry.last_use = ++use_counter_;
+  EvictIfNeeded();
+}
+
+void GrpcTensorCache::Invalidate(StringPiece tensor_name_prefix) {
+  mutex_lock l(mu_);
+  for (auto it = cache_.begin(); it != cache_.end();) {
+    if (str_util::StartsWith(it->second.tensor_name, tensor_name_prefix)) {
+      total_bytes_ -= it->second.tensor.TotalBytes();
+      it = cache_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void GrpcTensorCache::EvictIfNeeded() {
+  // The cache holds a handful of large tensors, so a linear scan per
+  // eviction is cheaper than maintaining an ordered structure.
+  while (total_bytes_ > max_bytes_ && !cache_.empty()) {
+    auto lru = cache_.begin();
+    for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+      if (it->second.last_use < lru->second.last_use) {
+        lru = it;
+      }
+    }
+    VLOG(2) << "GrpcTensorCache evicting " << lru->first;
+    total_bytes_ -= lru->second.tensor.TotalBytes();
+    cache_.erase(lru);
+  }
+}
+
+}  // namespace tensorflow
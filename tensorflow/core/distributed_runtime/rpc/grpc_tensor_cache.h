@@ -0,0 +1,88 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CACHE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Cross-step cache for tensors that are declared immutable and served
+// repeatedly over RecvTensor, e.g. frozen embedding shards that every
+// evaluation worker pulls from the same parameter server.  Unlike
+// GrpcResponseCache, which only dedups retries of one step's RPCs,
+// entries here outlive the step: they are keyed by the full rendezvous
+// key, which embeds the producing device's incarnation and so acts as a
+// version that changes when the producer restarts.
+//
+// Tensors are declared immutable by name prefix via the
+// TF_GRPC_IMMUTABLE_TENSORS environment variable (comma-separated).
+// Resident bytes are bounded by TF_GRPC_RECV_TENSOR_CACHE_BYTES; least
+// recently used entries are evicted first.
+class GrpcTensorCache {
+ public:
+  // Returns a cache configured from the environment, or nullptr if
+  // TF_GRPC_IMMUTABLE_TENSORS is unset or empty.
+  static std::unique_ptr<GrpcTensorCache> CreateFromEnv();
+
+  GrpcTensorCache(std::vector<string> immutable_prefixes, int64 max_bytes);
+
+  // Returns true if a tensor with the given rendezvous edge name was
+  // declared immutable and may be cached.
+  bool IsCacheable(StringPiece tensor_name) const;
+
+  // If `key` is resident, copies the cached tensor to *tensor and
+  // returns true.
+  bool Lookup(const string& key, Tensor* tensor);
+
+  // Caches `tensor` under `key`.  `tensor_name` is remembered so the
+  // entry can be dropped by Invalidate().
+  void Insert(const string& key, StringPiece tensor_name,
+              const Tensor& tensor);
+
+  // Drops every cached tensor whose name starts with `tensor_name_prefix`.
+  // Invalidation hook for when a supposedly frozen variable is assigned.
+  void Invalidate(StringPiece tensor_name_prefix);
+
+ private:
+  struct Entry {
+    Tensor tensor;
+    string tensor_name;
+    int64 last_use = 0;
+  };
+
+  void EvictIfNeeded() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::vector<string> immutable_prefixes_;
+  const int64 max_bytes_;
+
+  mutex mu_;
+  int64 use_counter_ GUARDED_BY(mu_) = 0;
+  int64 total_bytes_ GUARDED_BY(mu_) = 0;
+  std::unordered_map<string, Entry> cache_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CACHE_H_
@@ -17,6 +17,7 @@ limitations under the License.
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 // (Omitted internal-only flag)
@@ -135,7 +137,61 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Tensors at or below this size are sent raw: the cycles spent compressing
+// them cost more than the bytes they would save on the wire.
+static const size_t kMinCompressTensorBytes = 32 * 1024;
+
+int NegotiateTensorCompression(gtl::ArraySlice<int32> supported_codecs,
+                               const Tensor& val) {
+  if (!DataTypeCanUseMemcpy(val.dtype()) ||
+      val.TotalBytes() <= kMinCompressTensorBytes) {
+    return TENSOR_COMPRESSION_NONE;
+  }
+  for (int32 codec : supported_codecs) {
+    switch (codec) {
+      case TENSOR_COMPRESSION_SNAPPY:
+        return codec;
+      case TENSOR_COMPRESSION_BF16_SNAPPY:
+        if (val.dtype() == DT_FLOAT) return codec;
+        break;
+      default:
+        // Codec from a newer requester that this responder does not know.
+        break;
+    }
+  }
+  return TENSOR_COMPRESSION_NONE;
+}
+
+// Compresses "in" (the raw bytes of a "dtype" tensor) according to "codec"
+// into "*out".  Returns false when the codec does not apply or did not
+// shrink the payload, in which case the raw bytes should be sent.
+static bool CompressTensorContent(int codec, DataType dtype, StringPiece in,
+                                  string* out) {
+  if (codec == TENSOR_COMPRESSION_BF16_SNAPPY) {
+    if (dtype != DT_FLOAT) return false;
+    const int64 num_elements = in.size() / sizeof(float);
+    string truncated(num_elements * sizeof(bfloat16), '\0');
+    FloatToBFloat16(reinterpret_cast<const float*>(in.data()),
+                    reinterpret_cast<bfloat16*>(&truncated[0]), num_elements);
+    if (!port::Snappy_Compress(truncated.data(), truncated.size(), out)) {
+      return false;
+    }
+  } else if (codec == TENSOR_COMPRESSION_SNAPPY) {
+    if (!port::Snappy_Compress(in.data(), in.size(), out)) return false;
+  } else {
+    return false;
+  }
+  return out->size() < in.size();
+}
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              ::grpc::ByteBuffer* result) {
+  EncodeTensorToByteBuffer(is_dead, val, require_ack, TENSOR_COMPRESSION_NONE,
+                           result);
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              int compression_codec,
                               ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
   RecvTensorResponse response;
@@ -160,6 +216,19 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     EncodeSkeleton(val, &e_skeleton);
 
     StringPiece tdata = val.tensor_data();
+    // Compress the content when a codec was negotiated with the requester.
+    // Content the codec fails to shrink is sent raw, with no codec recorded
+    // in the response.
+    string compressed;
+    if (compression_codec != TENSOR_COMPRESSION_NONE) {
+      if (CompressTensorContent(compression_codec, val.dtype(), tdata,
+                                &compressed)) {
+        response.set_compression_codec(compression_codec);
+        tdata = compressed;
+      } else {
+        compressed.clear();
+      }
+    }
     uint32 overall_tensor_proto_bytesize =
         (e_skeleton.size() +
          VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
@@ -180,8 +249,11 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     // backing store, with appropriate reference counts to keep the
     // backing store alive as needed.
     //
-    // We enable this behavior if the tensor is large.
-    bool share_tensor_slice_memory = (tdata.size() > kLargeTensorBytes);
+    // We enable this behavior if the tensor is large and "tdata" still
+    // points at the tensor's own buffer (compressed content lives in a
+    // local string and must be copied into the slice).
+    bool share_tensor_slice_memory =
+        (tdata.size() > kLargeTensorBytes) && compressed.empty();
 
     // (Omitted internal-only conditional)
 
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
 #include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 class Tensor;
@@ -45,10 +47,27 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 //
 // "val" holds the tensor value to be encoded.
 //
+// "compression_codec" is a TensorCompressionCodec value (see worker.proto)
+// to apply to the tensor content; pass TENSOR_COMPRESSION_NONE (0) to send
+// the raw bytes.  Content that a codec fails to shrink is sent raw.
+//
 // Discards original contents of *result.
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              int compression_codec,
                               ::grpc::ByteBuffer* result);
 
+// Backwards-compatible overload that applies no compression.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              ::grpc::ByteBuffer* result);
+
+// Returns the TensorCompressionCodec value to use when encoding "val" for a
+// requester that advertised "supported_codecs" (the contents of
+// RecvTensorRequest.supported_compression_codecs), or
+// TENSOR_COMPRESSION_NONE when the tensor is too small to be worth
+// compressing or no advertised codec applies to it.
+int NegotiateTensorCompression(gtl::ArraySlice<int32> supported_codecs,
+                               const Tensor& val);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -17,10 +17,12 @@ limitations under the License.
 
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -100,4 +102,96 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+static RecvTensorResponse EncodeAndParse(const Tensor& t, int codec) {
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, t, false, codec, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  RecvTensorResponse response;
+  EXPECT_TRUE(response.ParseFromString(tmp));
+  return response;
+}
+
+TEST_F(GrpcTensorCodingTest, NegotiateCompression) {
+  // Large enough to exceed the compression size threshold.
+  Tensor large(DT_FLOAT, TensorShape({64 * 1024}));
+  test::FillFn<float>(&large, [](int i) { return 1.0f; });
+  Tensor small(DT_FLOAT, TensorShape({4}));
+  test::FillFn<float>(&small, [](int i) { return 1.0f; });
+  Tensor large_int(DT_INT32, TensorShape({64 * 1024}));
+  test::FillFn<int32>(&large_int, [](int i) { return 1; });
+
+  // No advertised codecs, or a tensor below the threshold: no compression.
+  EXPECT_EQ(TENSOR_COMPRESSION_NONE,
+            grpc::NegotiateTensorCompression({}, large));
+  EXPECT_EQ(TENSOR_COMPRESSION_NONE,
+            grpc::NegotiateTensorCompression({TENSOR_COMPRESSION_SNAPPY},
+                                             small));
+
+  EXPECT_EQ(TENSOR_COMPRESSION_SNAPPY,
+            grpc::NegotiateTensorCompression({TENSOR_COMPRESSION_SNAPPY},
+                                             large));
+  // bfloat16 truncation applies only to float tensors; other dtypes fall
+  // back to the next advertised codec.
+  EXPECT_EQ(TENSOR_COMPRESSION_BF16_SNAPPY,
+            grpc::NegotiateTensorCompression(
+                {TENSOR_COMPRESSION_BF16_SNAPPY, TENSOR_COMPRESSION_SNAPPY},
+                large));
+  EXPECT_EQ(TENSOR_COMPRESSION_SNAPPY,
+            grpc::NegotiateTensorCompression(
+                {TENSOR_COMPRESSION_BF16_SNAPPY, TENSOR_COMPRESSION_SNAPPY},
+                large_int));
+}
+
+TEST_F(GrpcTensorCodingTest, SnappyCompressedRoundTrip) {
+  Tensor a(DT_FLOAT, TensorShape({64 * 1024}));
+  test::FillFn<float>(&a, [](int i) { return static_cast<float>(i % 16); });
+
+  RecvTensorResponse response =
+      EncodeAndParse(a, TENSOR_COMPRESSION_SNAPPY);
+  EXPECT_EQ(TENSOR_COMPRESSION_SNAPPY, response.compression_codec());
+  const string& compressed = response.tensor().tensor_content();
+  EXPECT_LT(compressed.size(), a.TotalBytes());
+
+  string raw(a.TotalBytes(), '\0');
+  size_t uncompressed_size;
+  ASSERT_TRUE(port::Snappy_GetUncompressedLength(
+      compressed.data(), compressed.size(), &uncompressed_size));
+  ASSERT_EQ(a.TotalBytes(), uncompressed_size);
+  ASSERT_TRUE(port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                      &raw[0]));
+  EXPECT_EQ(string(a.tensor_data()), raw);
+}
+
+TEST_F(GrpcTensorCodingTest, Bf16SnappyCompressedRoundTrip) {
+  Tensor a(DT_FLOAT, TensorShape({64 * 1024}));
+  test::FillFn<float>(&a, [](int i) { return static_cast<float>(i % 16); });
+
+  RecvTensorResponse response =
+      EncodeAndParse(a, TENSOR_COMPRESSION_BF16_SNAPPY);
+  EXPECT_EQ(TENSOR_COMPRESSION_BF16_SNAPPY, response.compression_codec());
+  const string& compressed = response.tensor().tensor_content();
+
+  const int64 n = a.NumElements();
+  string truncated(n * sizeof(bfloat16), '\0');
+  size_t uncompressed_size;
+  ASSERT_TRUE(port::Snappy_GetUncompressedLength(
+      compressed.data(), compressed.size(), &uncompressed_size));
+  ASSERT_EQ(truncated.size(), uncompressed_size);
+  ASSERT_TRUE(port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                      &truncated[0]));
+
+  std::vector<float> expanded(n);
+  BFloat16ToFloat(reinterpret_cast<const bfloat16*>(truncated.data()),
+                  expanded.data(), n);
+  for (int64 i = 0; i < n; ++i) {
+    // Small integral values are exactly representable in bfloat16.
+    EXPECT_EQ(a.flat<float>()(i), expanded[i]);
+  }
+}
+
 }  // namespace tensorflow
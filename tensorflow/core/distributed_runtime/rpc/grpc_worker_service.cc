@@ -417,6 +417,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
 GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
     : Worker(worker_env),
+      tensor_cache_(GrpcTensorCache::CreateFromEnv()),
       recv_buf_max_chunk_(
           config.experimental().recv_buf_max_chunk() > 0
               ? config.experimental().recv_buf_max_chunk()
@@ -434,11 +435,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                      const RecvTensorRequest* request,
                                      ::grpc::ByteBuffer* response,
                                      StatusCallback done) {
-  auto do_response = [this, response, done](const Tensor& tensor, bool is_dead,
-                                            const Status& status) {
+  // Copy the requester's advertised codecs out of the request, since the
+  // response may be produced after the request object is gone.
+  std::vector<int32> supported_codecs(
+      request->supported_compression_codecs().begin(),
+      request->supported_compression_codecs().end());
+  auto do_response = [this, response, done, supported_codecs](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
       bool require_ack = (response_cache_ != nullptr);
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, require_ack, response);
+      grpc::EncodeTensorToByteBuffer(
+          is_dead, tensor, require_ack,
+          grpc::NegotiateTensorCompression(supported_codecs, tensor), response);
     }
     done(status);
   };
@@ -455,16 +464,17 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     return;
   }
 
-  auto rendezvous_done = [this, request_id, do_response](const Tensor& tensor,
-                                                         bool is_dead,
-                                                         const Status& status) {
-    if (response_cache_) {
-      // Data is ready. Process all pending requests in the response cache.
-      response_cache_->OnRequestFinished(request_id, tensor, is_dead, status);
-    } else {
-      do_response(tensor, is_dead, status);
-    }
-  };
+  std::function<void(const Tensor&, bool, const Status&)> rendezvous_done =
+      [this, request_id, do_response](const Tensor& tensor, bool is_dead,
+                                      const Status& status) {
+        if (response_cache_) {
+          // Data is ready. Process all pending requests in the response cache.
+          response_cache_->OnRequestFinished(request_id, tensor, is_dead,
+                                             status);
+        } else {
+          do_response(tensor, is_dead, status);
+        }
+      };
 
   auto fail = [&rendezvous_done](const Status& status) {
     rendezvous_done(Tensor(), false, status);
@@ -490,6 +500,30 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     return;
   }
 
+  // Serve immutable tensors from the cross-step cache, and arrange for
+  // cacheable tensors to be inserted once the rendezvous produces them.
+  // The rendezvous key embeds the source device incarnation, so entries
+  // version naturally across producer restarts.
+  if (tensor_cache_ && tensor_cache_->IsCacheable(parsed.edge_name)) {
+    Tensor cached;
+    if (tensor_cache_->Lookup(key, &cached)) {
+      rendezvous_done(cached, false, Status::OK());
+      return;
+    }
+    GrpcTensorCache* cache = tensor_cache_.get();
+    const string cache_key = key;
+    const string tensor_name(parsed.edge_name);
+    auto deliver = std::move(rendezvous_done);
+    rendezvous_done = [cache, cache_key, tensor_name, deliver](
+                          const Tensor& tensor, bool is_dead,
+                          const Status& status) {
+      if (status.ok() && !is_dead) {
+        cache->Insert(cache_key, tensor_name, tensor);
+      }
+      deliver(tensor, is_dead, status);
+    };
+  }
+
   // Request the tensor associated with the rendezvous key.
   // Note that we log the cancellation here but do not abort the current step.
   // gRPC can generate cancellations in response to transient network failures,
@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_map>
 #include "grpcpp/server_builder.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -64,6 +65,9 @@ class GrpcWorker : public Worker {
 
  private:
   std::unique_ptr<GrpcResponseCache> response_cache_;
+  // Cross-step cache for immutable tensors; nullptr unless enabled via
+  // the environment.  See GrpcTensorCache.
+  std::unique_ptr<GrpcTensorCache> tensor_cache_;
   const int32 recv_buf_max_chunk_;
 };
 
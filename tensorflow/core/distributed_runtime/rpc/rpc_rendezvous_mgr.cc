@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -37,6 +41,32 @@ namespace tensorflow {
 
 namespace {
 
+// Returns the TensorCompressionCodec values, in preference order, that this
+// process accepts for incoming RecvTensor responses.  Controlled by the
+// TF_GRPC_TENSOR_COMPRESSION environment variable: "off" (the default)
+// advertises nothing, "snappy" enables lossless snappy compression, and
+// "bf16_snappy" additionally allows float32 tensors to be truncated to
+// bfloat16 before compression (lossy).
+const std::vector<int32>& AdvertisedCompressionCodecs() {
+  static const std::vector<int32>* codecs = []() -> std::vector<int32>* {
+    const char* setting = getenv("TF_GRPC_TENSOR_COMPRESSION");
+    if (setting == nullptr || !strcmp(setting, "") || !strcmp(setting, "off")) {
+      return new std::vector<int32>;
+    }
+    if (!strcmp(setting, "snappy")) {
+      return new std::vector<int32>({TENSOR_COMPRESSION_SNAPPY});
+    }
+    if (!strcmp(setting, "bf16_snappy")) {
+      return new std::vector<int32>(
+          {TENSOR_COMPRESSION_BF16_SNAPPY, TENSOR_COMPRESSION_SNAPPY});
+    }
+    LOG(WARNING) << "Unknown TF_GRPC_TENSOR_COMPRESSION setting: \"" << setting
+                 << "\"; tensor compression is disabled.";
+    return new std::vector<int32>;
+  }();
+  return *codecs;
+}
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
@@ -69,6 +99,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    for (int32 codec : AdvertisedCompressionCodecs()) {
+      req_.add_supported_compression_codecs(codec);
+    }
   }
 
   void Reset() {
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
@@ -104,6 +105,42 @@ TEST_F(RpcRendezvousMgrTest, LocalSendRecv) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, LocalBulkSendRecv) {
+  const int64 step_id = 123;
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < 4; ++i) {
+    keys.push_back(MakeKey(Rendezvous::CreateKey(
+        "/job:mnist/replica:1/task:2/cpu:0", 7890,
+        "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+        FrameAndIter(0, 0))));
+  }
+  RemoteRendezvous* rendez = rmgr_.Find(step_id);
+  TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+  core::ScopedUnref unref(rendez);
+  Rendezvous::Args args;
+  for (const Rendezvous::ParsedKey& key : keys) {
+    TF_ASSERT_OK(rendez->Send(key, args, V("peach"), false));
+  }
+
+  Notification n;
+  std::vector<BaseRemoteRendezvous::BulkRecvResult> results;
+  static_cast<BaseRemoteRendezvous*>(rendez)->RecvBulkAsync(
+      keys, args,
+      [&n, &results](std::vector<BaseRemoteRendezvous::BulkRecvResult> r) {
+        results = std::move(r);
+        n.Notify();
+      });
+  n.WaitForNotification();
+
+  ASSERT_EQ(4, results.size());
+  for (const BaseRemoteRendezvous::BulkRecvResult& result : results) {
+    TF_EXPECT_OK(result.status);
+    EXPECT_FALSE(result.is_dead);
+    EXPECT_EQ("peach", V(result.tensor));
+  }
+  rmgr_.Cleanup(step_id);
+}
+
 TEST_F(RpcRendezvousMgrTest, LocalAbort) {
   const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
       "/job:mnist/replica:1/task:2/cpu:0", 7890,
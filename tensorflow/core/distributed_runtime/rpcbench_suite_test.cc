@@ -0,0 +1,317 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Distributed runtime benchmark suite over real gRPC transports.
+//
+// Unlike rpcbench_test.cc, which measures a few fixed stage/width program
+// shapes on one cluster size, this suite sweeps the dimensions transport
+// changes actually regress on:
+//  - tensor size per send,
+//  - fan-out / fan-in width,
+//  - hop count (chained sends through a ring of workers),
+//  - cluster size (clusters are created lazily per worker count),
+//  - reduction pattern (single-level tree AddN vs. sequential ring of Adds,
+//    the graph-level analogues of the tree and ring collective algorithms),
+// and reports the serialization share of each configuration in the label so
+// wire + rendezvous cost can be separated from tensor-coding cost when
+// comparing runs (the coding cost itself is measured by BM_EncodeTensor
+// below against the same tensor sizes).
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_session.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/default_device.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/cluster.pb.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+struct BenchCluster {
+  SessionOptions options;
+  std::vector<string> workers;
+  std::vector<DeviceAttributes> devices;  // One per process.
+  thread::ThreadPool* server_threads = nullptr;
+
+  explicit BenchCluster(int n) {
+    CHECK_GE(n, 1);
+    (*options.config.mutable_device_count())["CPU"] = 1;
+    options.config.set_intra_op_parallelism_threads(1);
+    options.config.set_inter_op_parallelism_threads(1);
+
+    std::vector<int> port(n);
+    for (int i = 0; i < n; ++i) {
+      port[i] = testing::PickUnusedPortOrDie();
+      workers.push_back(strings::StrCat("grpc://localhost:", port[i]));
+    }
+
+    server_threads = new thread::ThreadPool(
+        Env::Default(), strings::StrCat("cluster_", n), n);
+    for (int worker_idx = 0; worker_idx < n; ++worker_idx) {
+      server_threads->Schedule([this, worker_idx, n, port] {
+        ServerDef server;
+        server.set_protocol("grpc");
+        server.set_job_name("localhost");
+        server.set_task_index(worker_idx);
+
+        auto job_def = server.mutable_cluster()->add_job();
+        job_def->set_name("localhost");
+        for (int i = 0; i < n; i++) {
+          (*(job_def->mutable_tasks()))[i] =
+              strings::StrCat("localhost:", port[i]);
+        }
+
+        auto config = server.mutable_default_session_config();
+        (*config->mutable_device_count())["CPU"] = 1;
+
+        std::unique_ptr<ServerInterface> svr;
+        TF_CHECK_OK(NewServer(server, &svr));
+        TF_CHECK_OK(svr->Start());
+        TF_CHECK_OK(svr->Join());
+      });
+    }
+
+    SessionOptions options_copy(options);
+    options_copy.target = workers[0];
+    std::unique_ptr<GrpcSession> session;
+    TF_CHECK_OK(GrpcSession::Create(options_copy, &session));
+    TF_CHECK_OK(session->ListDevices(&devices));
+    options.target = workers[0];
+  }
+};
+
+// Returns a cluster with `n` single-CPU workers, creating it on first use.
+// Clusters stay up for the lifetime of the benchmark binary.
+const BenchCluster* GetClusterForSize(int n) {
+  static std::map<int, BenchCluster*>* clusters =
+      new std::map<int, BenchCluster*>;
+  auto it = clusters->find(n);
+  if (it == clusters->end()) {
+    it = clusters->emplace(n, new BenchCluster(n)).first;
+  }
+  return it->second;
+}
+
+// x (fed on worker 0) is sent to `width` workers, each computes Identity,
+// and the results are gathered back into one AddN on worker 0: one fan-out
+// and one fan-in of `tensor_size` floats per step.
+GraphDef FanOutFanInGraphDef(const BenchCluster* cluster, int width,
+                             int tensor_size) {
+  CHECK_GE(cluster->devices.size(), width);
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+  Scope s = Scope::NewRootScope();
+  Output x = Const(s.WithOpName("x"), 0.0f, {tensor_size, 1});
+  std::vector<Output> scattered;
+  for (int j = 0; j < width; j++) {
+    scattered.push_back(
+        Identity(s.WithDevice(cluster->devices[j].name()), x));
+  }
+  AddN(s.WithOpName("y"), scattered);
+
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+  return def;
+}
+
+// x is passed through `hops` Identity ops placed round-robin on the
+// cluster's workers: every hop is one send/recv rendezvous across the wire.
+GraphDef ChainGraphDef(const BenchCluster* cluster, int hops,
+                       int tensor_size) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+  Scope s = Scope::NewRootScope();
+  Output v = Const(s.WithOpName("x"), 0.0f, {tensor_size, 1});
+  const int n = cluster->devices.size();
+  for (int h = 0; h < hops; h++) {
+    v = Identity(s.WithDevice(cluster->devices[(h + 1) % n].name()), v);
+  }
+  Identity(s.WithOpName("y").WithDevice(cluster->devices[0].name()), v);
+
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+  return def;
+}
+
+// Tree reduction: every worker contributes Identity(x) and one AddN on
+// worker 0 combines them, like a single-level tree all-reduce.
+GraphDef TreeReduceGraphDef(const BenchCluster* cluster, int width,
+                            int tensor_size) {
+  return FanOutFanInGraphDef(cluster, width, tensor_size);
+}
+
+// Ring reduction: the partial sum travels once around the workers, each
+// adding its own contribution, like a ring all-reduce's reduce phase. The
+// same bytes cross the wire as in the tree, but serially.
+GraphDef RingReduceGraphDef(const BenchCluster* cluster, int width,
+                            int tensor_size) {
+  CHECK_GE(cluster->devices.size(), width);
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+  Scope s = Scope::NewRootScope();
+  Output x = Const(s.WithOpName("x"), 0.0f, {tensor_size, 1});
+  Output acc = x;
+  for (int j = 1; j < width; j++) {
+    Scope dev = s.WithDevice(cluster->devices[j].name());
+    acc = Add(dev, acc, Identity(dev, x));
+  }
+  Identity(s.WithOpName("y").WithDevice(cluster->devices[0].name()), acc);
+
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+  return def;
+}
+
+// Measures the host-side cost of encoding one tensor of `tensor_size`
+// floats for the wire, so the serialization share of a step can be read
+// off against the end-to-end numbers above.
+uint64 MeasureEncodeMicros(int tensor_size) {
+  Tensor t(DT_FLOAT, TensorShape({tensor_size, 1}));
+  t.flat<float>().setZero();
+  const int kReps = 16;
+  const uint64 start = Env::Default()->NowMicros();
+  for (int i = 0; i < kReps; i++) {
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, t, /*require_ack=*/false,
+                                   &buf);
+  }
+  return (Env::Default()->NowMicros() - start) / kReps;
+}
+
+// Runs `def` against `cluster`, feeding "x" and fetching "y", and reports
+// bytes shipped per iteration along with the measured per-tensor
+// serialization cost.
+void RunBenchGraph(int iters, const BenchCluster* cluster, GraphDef def,
+                   int tensor_size, int sends_per_step, const string& shape) {
+  testing::StopTiming();
+  std::unique_ptr<Session> session(NewSession(cluster->options));
+  graph::SetDefaultDevice(cluster->devices[0].name(), &def);
+  TF_CHECK_OK(session->Create(def));
+
+  Tensor x(DT_FLOAT, TensorShape({tensor_size, 1}));
+  x.flat<float>().setZero();
+
+  testing::SetLabel(strings::StrCat(
+      shape, "; ", cluster->workers.size(), " workers; ",
+      tensor_size * sizeof(float), " bytes/send; ", sends_per_step,
+      " sends/step; serialize ~", MeasureEncodeMicros(tensor_size),
+      " us/tensor"));
+
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < 3; i++) {
+    outputs.clear();
+    TF_CHECK_OK(session->Run({{"x", x}}, {"y:0"}, {}, &outputs));
+    CHECK_EQ(size_t{1}, outputs.size());
+  }
+
+  testing::StartTiming();
+  for (int i = 0; i < iters; i++) {
+    outputs.clear();
+    TF_CHECK_OK(session->Run({{"x", x}}, {"y:0"}, {}, &outputs));
+    CHECK_EQ(size_t{1}, outputs.size());
+  }
+  testing::StopTiming();
+  testing::BytesProcessed(static_cast<int64>(iters) * sends_per_step *
+                          tensor_size * sizeof(float));
+  TF_CHECK_OK(session->Close());
+}
+
+void BM_FanOutFanIn(int iters, int workers, int tensor_size) {
+  const BenchCluster* cluster = GetClusterForSize(workers);
+  RunBenchGraph(iters, cluster,
+                FanOutFanInGraphDef(cluster, workers, tensor_size),
+                tensor_size, 2 * (workers - 1), "fan-out/fan-in");
+}
+BENCHMARK(BM_FanOutFanIn)
+    ->ArgPair(2, 1000)
+    ->ArgPair(2, 100000)
+    ->ArgPair(4, 1000)
+    ->ArgPair(4, 100000)
+    ->ArgPair(8, 1000)
+    ->ArgPair(8, 100000)
+    ->ArgPair(16, 1000)
+    ->ArgPair(16, 100000);
+
+void BM_Chain(int iters, int hops, int tensor_size) {
+  const BenchCluster* cluster = GetClusterForSize(4);
+  RunBenchGraph(iters, cluster, ChainGraphDef(cluster, hops, tensor_size),
+                tensor_size, hops, "chain");
+}
+BENCHMARK(BM_Chain)
+    ->ArgPair(1, 1000)
+    ->ArgPair(1, 100000)
+    ->ArgPair(8, 1000)
+    ->ArgPair(8, 100000)
+    ->ArgPair(32, 1000)
+    ->ArgPair(32, 100000);
+
+void BM_TreeReduce(int iters, int workers, int tensor_size) {
+  const BenchCluster* cluster = GetClusterForSize(workers);
+  RunBenchGraph(iters, cluster,
+                TreeReduceGraphDef(cluster, workers, tensor_size), tensor_size,
+                2 * (workers - 1), "tree reduce");
+}
+BENCHMARK(BM_TreeReduce)
+    ->ArgPair(4, 100000)
+    ->ArgPair(8, 100000)
+    ->ArgPair(16, 100000);
+
+void BM_RingReduce(int iters, int workers, int tensor_size) {
+  const BenchCluster* cluster = GetClusterForSize(workers);
+  RunBenchGraph(iters, cluster,
+                RingReduceGraphDef(cluster, workers, tensor_size), tensor_size,
+                2 * (workers - 1), "ring reduce");
+}
+BENCHMARK(BM_RingReduce)
+    ->ArgPair(4, 100000)
+    ->ArgPair(8, 100000)
+    ->ArgPair(16, 100000);
+
+// Serialization phase in isolation; diffs here pinpoint grpc_tensor_coding
+// changes without any transport noise.
+void BM_EncodeTensor(int iters, int tensor_size) {
+  testing::StopTiming();
+  Tensor t(DT_FLOAT, TensorShape({tensor_size, 1}));
+  t.flat<float>().setZero();
+  testing::StartTiming();
+  for (int i = 0; i < iters; i++) {
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, t, /*require_ack=*/false,
+                                   &buf);
+  }
+  testing::StopTiming();
+  testing::BytesProcessed(static_cast<int64>(iters) * tensor_size *
+                          sizeof(float));
+}
+BENCHMARK(BM_EncodeTensor)->Arg(1000)->Arg(100000)->Arg(1000000);
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,11 +18,19 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 
+namespace {
+// Defined with the other wire-format helpers below.
+bool MaybeDecompressTensorProto(RecvTensorResponse* response);
+}  // namespace
+
 TensorResponse::Source::~Source() {}
 
 void TensorResponse::Clear() {
@@ -53,7 +61,9 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
-  if (on_host_) {
+  if (!MaybeDecompressTensorProto(&meta_)) {
+    s = errors::InvalidArgument("Cannot decompress tensor from response");
+  } else if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
@@ -81,11 +91,19 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 
 Status TensorResponse::ParseFrom(Source* source) {
   if (!on_host_) {
+    // Fast path: allocate staging storage up front from the parsed skeleton
+    // and scatter the wire bytes straight into it, followed by a single copy
+    // onto the device, instead of materializing the entire response --
+    // tensor bytes included -- in a protocol buffer first.
+    if (ParseFastToDevice(source)) return Status::OK();
+    meta_.Clear();
+
     protobuf::io::CodedInputStream input(source->contents());
     input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
 
     // Pre-parse into local storage, then delegate to device.
-    if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
+    if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage() ||
+        !MaybeDecompressTensorProto(&meta_)) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
     Status s =
@@ -102,7 +120,7 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return Status::OK();
+  if (ParseFast(source, allocator_, &tensor_)) return Status::OK();
   meta_.Clear();
   if (ParseSlow(source)) return Status::OK();
   return errors::InvalidArgument("Cannot parse tensor from response");
@@ -142,10 +160,85 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
   return input->DecrementRecursionDepthAndPopLimit(p.first);
 }
 
+// Reads "num_bytes" of "codec"-compressed tensor content from "input" and
+// expands it into "buf", which holds the raw bytes of a "dtype" tensor.
+// Returns false if the expanded size does not match buf exactly.
+bool ReadCompressedTensorContent(protobuf::io::CodedInputStream* input,
+                                 int codec, int num_bytes, DataType dtype,
+                                 StringPiece buf) {
+  string compressed(num_bytes, '\0');
+  if (!input->ReadRaw(&compressed[0], num_bytes)) return false;
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
+                                          &uncompressed_size)) {
+    return false;
+  }
+  if (codec == TENSOR_COMPRESSION_SNAPPY) {
+    if (uncompressed_size != buf.size()) return false;
+    return port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                   const_cast<char*>(buf.data()));
+  }
+  if (codec == TENSOR_COMPRESSION_BF16_SNAPPY) {
+    // The sender truncated float32 to bfloat16 before compressing, so the
+    // expanded payload is half the size of the tensor buffer.
+    if (dtype != DT_FLOAT || uncompressed_size * 2 != buf.size()) return false;
+    string truncated(uncompressed_size, '\0');
+    if (!port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                 &truncated[0])) {
+      return false;
+    }
+    BFloat16ToFloat(reinterpret_cast<const bfloat16*>(truncated.data()),
+                    reinterpret_cast<float*>(const_cast<char*>(buf.data())),
+                    uncompressed_size / sizeof(bfloat16));
+    return true;
+  }
+  return false;
+}
+
+// Expands a compressed tensor_content inside "*response" in place and clears
+// the codec field, so the regular proto-based tensor construction can run
+// unchanged.  Returns false if the content cannot be expanded.
+bool MaybeDecompressTensorProto(RecvTensorResponse* response) {
+  const int codec = response->compression_codec();
+  if (codec == TENSOR_COMPRESSION_NONE) return true;
+  TensorProto* tensor = response->mutable_tensor();
+  const string& compressed = tensor->tensor_content();
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
+                                          &uncompressed_size)) {
+    return false;
+  }
+  string raw;
+  if (codec == TENSOR_COMPRESSION_SNAPPY) {
+    raw.resize(uncompressed_size);
+    if (!port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                 &raw[0])) {
+      return false;
+    }
+  } else if (codec == TENSOR_COMPRESSION_BF16_SNAPPY) {
+    if (tensor->dtype() != DT_FLOAT) return false;
+    string truncated(uncompressed_size, '\0');
+    if (!port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                 &truncated[0])) {
+      return false;
+    }
+    raw.resize(uncompressed_size * 2);
+    BFloat16ToFloat(reinterpret_cast<const bfloat16*>(truncated.data()),
+                    reinterpret_cast<float*>(&raw[0]),
+                    uncompressed_size / sizeof(bfloat16));
+  } else {
+    return false;
+  }
+  tensor->mutable_tensor_content()->swap(raw);
+  response->clear_compression_codec();
+  return true;
+}
+
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta,
+    Allocator* allocator, Tensor* result) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -156,8 +249,8 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
-        tensor_ = std::move(t);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
+        *result = std::move(t);
       }
       return ok;
     }
@@ -196,15 +289,28 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
-        if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
-        if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
-          return false;
-        tensor_ = std::move(t);
+        const int codec = meta_.compression_codec();
+        if (codec != TENSOR_COMPRESSION_NONE) {
+          // The codec field is serialized ahead of the tensor submessage by
+          // the sender, so it has already been recorded in meta_ by now.
+          if (!ReadCompressedTensorContent(input, codec, num_bytes,
+                                           tensor_meta->dtype(), buf)) {
+            return false;
+          }
+          // The tensor now holds raw bytes; don't let metadata() claim
+          // otherwise.
+          meta_.clear_compression_codec();
+        } else {
+          if (static_cast<size_t>(num_bytes) != buf.size()) return false;
+          // TODO(jeff,sanjay): Figure out a way to avoid this copy if
+          // the underlying ZeroCopyInputStream data is properly aligned
+          // and compatible with what allocator_ wants.
+          if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
+            return false;
+        }
+        *result = std::move(t);
         break;
       }
       default: {
@@ -216,7 +322,8 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
-bool TensorResponse::ParseFast(Source* source) {
+bool TensorResponse::ParseFast(Source* source, Allocator* allocator,
+                               Tensor* result) {
   protobuf::io::CodedInputStream input(source->contents());
   input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
   while (true) {
@@ -234,8 +341,8 @@ bool TensorResponse::ParseFast(Source* source) {
         if (!ReadVarintSizeAsInt(&input, &length)) return false;
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
-        if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+        if (p.second < 0 || !ParseTensorSubmessage(&input, meta_.mutable_tensor(),
+                                                   allocator, result)) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -267,6 +374,12 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kCompressionCodecFieldNumber: {
+        uint32 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) return false;
+        meta_.set_compression_codec(static_cast<int32>(v));
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -277,10 +390,50 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+// Parses the response with the same skeleton scheme as ParseFast, but
+// scatters the tensor bytes into host staging memory (pinned when the device
+// supports it) and then issues a single copy onto the device.  Returns false
+// if the device provides no default context or the wire data does not fit
+// the fast-path format; the caller falls back on the proto-based path.
+bool TensorResponse::ParseFastToDevice(Source* source) {
+  const DeviceBase::GpuDeviceInfo* dev_info =
+      device_->tensorflow_gpu_device_info();
+  if (dev_info == nullptr || dev_info->default_context == nullptr) {
+    return false;
+  }
+  AllocatorAttributes host_attrs;
+  host_attrs.set_on_host(true);
+  host_attrs.set_gpu_compatible(true);
+  Allocator* host_allocator = device_->GetAllocator(host_attrs);
+  Tensor staging;
+  if (!ParseFast(source, host_allocator, &staging)) return false;
+  if (staging.NumElements() == 0) {
+    // Nothing to scatter; the proto-based path handles empty tensors.
+    return false;
+  }
+  Tensor device_tensor(allocator_, staging.dtype(), staging.shape());
+  if (!device_tensor.IsInitialized()) return false;
+  Status status;
+  Notification n;
+  dev_info->default_context->CopyCPUTensorToDevice(
+      &staging, static_cast<Device*>(device_), &device_tensor,
+      [&status, &n](const Status& s) {
+        status = s;
+        n.Notify();
+      });
+  n.WaitForNotification();
+  if (!status.ok()) return false;
+  tensor_ = std::move(device_tensor);
+  return true;
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
+  if (!MaybeDecompressTensorProto(&meta_)) {
+    return false;
+  }
 
   Tensor parsed(meta_.tensor().dtype());
   if (!parsed.FromProto(allocator_, meta_.tensor())) {
@@ -93,8 +93,10 @@ class TensorResponse {
 
  private:
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
-                             TensorProto* tensor_meta);
-  bool ParseFast(Source* source);
+                             TensorProto* tensor_meta, Allocator* allocator,
+                             Tensor* result);
+  bool ParseFast(Source* source, Allocator* allocator, Tensor* result);
+  bool ParseFastToDevice(Source* source);
   bool ParseSlow(Source* source);
 
   bool on_host_ = false;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -156,6 +158,71 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+static string CompressTensorContentForTest(const Tensor& t, int codec) {
+  StringPiece data = t.tensor_data();
+  string compressed;
+  if (codec == TENSOR_COMPRESSION_BF16_SNAPPY) {
+    string truncated(t.NumElements() * sizeof(bfloat16), '\0');
+    FloatToBFloat16(reinterpret_cast<const float*>(data.data()),
+                    reinterpret_cast<bfloat16*>(&truncated[0]),
+                    t.NumElements());
+    CHECK(port::Snappy_Compress(truncated.data(), truncated.size(),
+                                &compressed));
+  } else {
+    CHECK(port::Snappy_Compress(data.data(), data.size(), &compressed));
+  }
+  return compressed;
+}
+
+TEST_F(TensorResponseTest, CompressedTensorContent) {
+  Tensor src(DT_FLOAT, TensorShape({1, 2048}));
+  // Values exactly representable in bfloat16, so both codecs round-trip
+  // bit-exactly.
+  test::FillFn<float>(&src, [](int i) { return static_cast<float>(i % 16); });
+
+  for (int codec :
+       {TENSOR_COMPRESSION_SNAPPY, TENSOR_COMPRESSION_BF16_SNAPPY}) {
+    string compressed = CompressTensorContentForTest(src, codec);
+
+    RecvTensorResponse tensor_part;
+    src.AsProtoTensorContent(tensor_part.mutable_tensor());
+    tensor_part.mutable_tensor()->set_tensor_content(compressed);
+
+    // The RecvTensor encoder serializes the codec field ahead of the tensor
+    // submessage; concatenating two partial serializations reproduces that
+    // ordering and exercises the fast path.
+    RecvTensorResponse header;
+    header.set_send_start_micros(123456);
+    header.set_compression_codec(codec);
+    string codec_first;
+    header.AppendToString(&codec_first);
+    tensor_part.AppendToString(&codec_first);
+
+    // A standard proto serialization puts the tensor field first, which the
+    // fast path cannot handle; this exercises the slow path.
+    RecvTensorResponse whole = tensor_part;
+    whole.set_send_start_micros(123456);
+    whole.set_compression_codec(codec);
+    string tensor_first;
+    whole.AppendToString(&tensor_first);
+
+    for (const string& encoded : {codec_first, tensor_first}) {
+      StringSource source(&encoded, 1024);
+      TensorResponse response;
+      DummyDevice cpu_device(Env::Default());
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      Status s = response.ParseFrom(&source);
+      EXPECT_TRUE(s.ok());
+      EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+
+      const Tensor& result = response.tensor();
+      EXPECT_EQ(result.dtype(), src.dtype());
+      EXPECT_EQ(result.shape().DebugString(), src.shape().DebugString());
+      EXPECT_EQ(result.DebugString(), src.DebugString());
+    }
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
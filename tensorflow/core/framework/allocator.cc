@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/framework/allocator.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/allocator_registry.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -212,11 +218,167 @@ class CPUAllocatorFactory : public AllocatorFactory {
 };
 
 REGISTER_MEM_ALLOCATOR("DefaultCPUAllocator", 100, CPUAllocatorFactory);
+
+// Opt-in thread-caching front end for the default CPU allocator.  High-QPS
+// paths (eager, tf.data) emit storms of small metadata and buffer
+// allocations that otherwise contend in the system allocator.  When
+// TF_CPU_ALLOCATOR_THREAD_CACHE=1, allocations of at most
+// kThreadCacheMaxBytes are rounded up to a power-of-two size class and
+// served from per-thread freelists, falling back to the wrapped allocator
+// on a miss.  Every block carries a header recording its size class (or
+// that it bypassed the cache), so deallocation routes it without
+// consulting the heap; the wrapped allocator's stats therefore keep
+// counting real heap traffic, with at most the per-thread freelist caps
+// parked outside them.
+constexpr size_t kThreadCacheMaxBytes = 4096;
+constexpr size_t kThreadCacheMinClassBytes = 64;
+constexpr int kThreadCacheNumClasses = 7;  // 64B to 4KB, power-of-two steps.
+constexpr size_t kThreadCacheMaxBlocksPerClass = 64;
+constexpr size_t kThreadCacheHeaderBytes = Allocator::kAllocatorAlignment;
+
+int ThreadCacheClassIndex(size_t num_bytes) {
+  int class_index = 0;
+  size_t class_bytes = kThreadCacheMinClassBytes;
+  while (class_bytes < num_bytes) {
+    class_bytes *= 2;
+    ++class_index;
+  }
+  return class_index;
+}
+
+size_t ThreadCacheClassBytes(int class_index) {
+  return kThreadCacheMinClassBytes << class_index;
+}
+
+class ThreadCachingCPUAllocator : public Allocator {
+ public:
+  explicit ThreadCachingCPUAllocator(Allocator* base) : base_(base) {}
+
+  ~ThreadCachingCPUAllocator() override {}
+
+  string Name() override { return "cpu_thread_cache"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    if (alignment <= kAllocatorAlignment && num_bytes > 0 &&
+        num_bytes <= kThreadCacheMaxBytes) {
+      const int class_index = ThreadCacheClassIndex(num_bytes);
+      std::vector<void*>& free_list = cache()->free_lists[class_index];
+      if (!free_list.empty()) {
+        void* ptr = free_list.back();
+        free_list.pop_back();
+        return ptr;
+      }
+      return AllocateWithHeader(kAllocatorAlignment,
+                                ThreadCacheClassBytes(class_index),
+                                class_index);
+    }
+    // Large or strongly-aligned blocks bypass the cache but still carry a
+    // header so DeallocateRaw can tell them apart.
+    return AllocateWithHeader(alignment, num_bytes, -1);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (ptr == nullptr) return;
+    int64* marker = reinterpret_cast<int64*>(ptr) - 2;
+    const int64 class_index = marker[0];
+    if (class_index >= 0) {
+      std::vector<void*>& free_list = cache()->free_lists[class_index];
+      if (free_list.size() < kThreadCacheMaxBlocksPerClass) {
+        free_list.push_back(ptr);
+        return;
+      }
+    }
+    base_->DeallocateRaw(static_cast<char*>(ptr) - marker[1]);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return base_->GetStats();
+  }
+
+  void ClearStats() override { base_->ClearStats(); }
+
+  size_t AllocatedSizeSlow(const void* ptr) const override {
+    const int64* marker = reinterpret_cast<const int64*>(ptr) - 2;
+    if (marker[0] >= 0) {
+      return ThreadCacheClassBytes(marker[0]);
+    }
+    const size_t base_size =
+        base_->AllocatedSizeSlow(static_cast<const char*>(ptr) - marker[1]);
+    return base_size > static_cast<size_t>(marker[1])
+               ? base_size - marker[1]
+               : 0;
+  }
+
+ private:
+  struct ThreadCache {
+    ThreadCachingCPUAllocator* owner = nullptr;
+    std::vector<void*> free_lists[kThreadCacheNumClasses];
+
+    ~ThreadCache() {
+      // Return the parked blocks to the wrapped allocator when the thread
+      // exits.
+      for (int i = 0; i < kThreadCacheNumClasses; ++i) {
+        for (void* ptr : free_lists[i]) {
+          int64* marker = reinterpret_cast<int64*>(ptr) - 2;
+          owner->base_->DeallocateRaw(static_cast<char*>(ptr) - marker[1]);
+        }
+      }
+    }
+  };
+
+  ThreadCache* cache() {
+    // There is one ThreadCachingCPUAllocator per process (it wraps the
+    // cpu_allocator_base() singleton), so a function-local thread_local is
+    // sufficient.
+    static thread_local ThreadCache cache;
+    cache.owner = this;
+    return &cache;
+  }
+
+  // Allocates header_bytes + num_bytes from the wrapped allocator and
+  // stashes (class_index, header size) in the two words just ahead of the
+  // returned payload.  The header is at least one alignment unit so the
+  // payload keeps the requested alignment.
+  void* AllocateWithHeader(size_t alignment, size_t num_bytes,
+                           int64 class_index) {
+    const size_t header_bytes = std::max(alignment, kThreadCacheHeaderBytes);
+    char* base_ptr = static_cast<char*>(
+        base_->AllocateRaw(header_bytes, header_bytes + num_bytes));
+    if (base_ptr == nullptr) {
+      return nullptr;
+    }
+    char* payload = base_ptr + header_bytes;
+    int64* marker = reinterpret_cast<int64*>(payload) - 2;
+    marker[0] = class_index;
+    marker[1] = static_cast<int64>(header_bytes);
+    return payload;
+  }
+
+  Allocator* base_;  // Not owned.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ThreadCachingCPUAllocator);
+};
+
+bool CPUAllocatorThreadCacheEnabled() {
+  static const bool enabled = [] {
+    const char* flag = getenv("TF_CPU_ALLOCATOR_THREAD_CACHE");
+    return flag != nullptr && strcmp(flag, "1") == 0;
+  }();
+  return enabled;
+}
 }  // namespace
 
 Allocator* cpu_allocator_base() {
-  static Allocator* cpu_alloc =
-      AllocatorFactoryRegistry::singleton()->GetAllocator();
+  static Allocator* cpu_alloc = [] {
+    Allocator* alloc = AllocatorFactoryRegistry::singleton()->GetAllocator();
+    // The optional thread-caching front end sits closest to the underlying
+    // allocator, so tracking wrappers added below still observe every
+    // allocation.
+    if (CPUAllocatorThreadCacheEnabled()) {
+      alloc = new ThreadCachingCPUAllocator(alloc);
+    }
+    return alloc;
+  }();
   // TODO(tucker): This really seems wrong.  It's only going to be effective on
   // the first call in a process (but the desired effect is associated with a
   // session), and we probably ought to be tracking the highest level Allocator,
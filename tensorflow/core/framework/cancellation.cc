@@ -31,24 +31,40 @@ void CancellationManager::Reset() {
   mutex_lock l(mu_);
   is_cancelling_ = false;
   is_cancelled_.store(false);
+  for (int i = 0; i < kNumShards; i++) {
+    mutex_lock shard_lock(shards_[i].mu);
+    shards_[i].cancel_started = false;
+  }
 }
 
 void CancellationManager::StartCancel() {
-  gtl::FlatMap<CancellationToken, CancelCallback> callbacks_to_run;
   {
     mutex_lock l(mu_);
     if (is_cancelled_.load(std::memory_order_relaxed) || is_cancelling_) {
       return;
     }
     is_cancelling_ = true;
-    std::swap(callbacks_, callbacks_to_run);
   }
-  // We call these callbacks without holding mu_, so that concurrent
+  // Drain each shard under its own lock before running any callbacks.
+  // Setting `cancel_started` under the shard lock ensures that a concurrent
+  // RegisterCallback on that shard either completes before the drain (and
+  // its callback is run below) or observes the cancellation and fails.
+  gtl::FlatMap<CancellationToken, CancelCallback> callbacks_to_run;
+  for (int i = 0; i < kNumShards; i++) {
+    mutex_lock shard_lock(shards_[i].mu);
+    shards_[i].cancel_started = true;
+    for (auto& key_and_value : shards_[i].callbacks) {
+      callbacks_to_run.emplace(key_and_value.first,
+                               std::move(key_and_value.second));
+    }
+    shards_[i].callbacks.clear();
+  }
+  // We call these callbacks without holding any locks, so that concurrent
   // calls to DeregisterCallback, which can happen asynchronously, do
   // not block. The callbacks remain valid because any concurrent call
   // to DeregisterCallback will block until the
   // cancelled_notification_ is notified.
-  for (auto key_and_value : callbacks_to_run) {
+  for (auto& key_and_value : callbacks_to_run) {
     key_and_value.second();
   }
   {
@@ -60,54 +76,62 @@ void CancellationManager::StartCancel() {
 }
 
 CancellationToken CancellationManager::get_cancellation_token() {
-  mutex_lock l(mu_);
-  return next_cancellation_token_++;
+  return next_cancellation_token_.fetch_add(1, std::memory_order_relaxed);
 }
 
 bool CancellationManager::RegisterCallback(CancellationToken token,
                                            CancelCallback callback) {
-  mutex_lock l(mu_);
-  CHECK_LT(token, next_cancellation_token_) << "Invalid cancellation token";
-  bool should_register = !is_cancelled_ && !is_cancelling_;
+  CHECK_LT(token, next_cancellation_token_.load(std::memory_order_relaxed))
+      << "Invalid cancellation token";
+  CallbackShard* s = shard(token);
+  mutex_lock shard_lock(s->mu);
+  bool should_register = !s->cancel_started;
   if (should_register) {
-    std::swap(callbacks_[token], callback);
+    std::swap(s->callbacks[token], callback);
   }
   return should_register;
 }
 
 bool CancellationManager::DeregisterCallback(CancellationToken token) {
-  mu_.lock();
-  if (is_cancelled_) {
-    mu_.unlock();
-    return false;
-  } else if (is_cancelling_) {
-    mu_.unlock();
-    // Wait for all of the cancellation callbacks to be called. This
-    // wait ensures that the caller of DeregisterCallback does not
-    // return immediately and free objects that may be used in the
-    // execution of any currently pending callbacks in StartCancel.
-    cancelled_notification_.WaitForNotification();
-    return false;
-  } else {
-    callbacks_.erase(token);
-    mu_.unlock();
+  CallbackShard* s = shard(token);
+  s->mu.lock();
+  if (!s->cancel_started) {
+    // Common case: cancellation has not started, so the callback is still
+    // owned by the shard and can simply be removed. Only the shard lock is
+    // taken; the manager-wide state is not touched.
+    s->callbacks.erase(token);
+    s->mu.unlock();
     return true;
   }
+  s->mu.unlock();
+  if (is_cancelled_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // Wait for all of the cancellation callbacks to be called. This
+  // wait ensures that the caller of DeregisterCallback does not
+  // return immediately and free objects that may be used in the
+  // execution of any currently pending callbacks in StartCancel.
+  cancelled_notification_.WaitForNotification();
+  return false;
 }
 
 bool CancellationManager::TryDeregisterCallback(CancellationToken token) {
-  mutex_lock lock(mu_);
-  if (is_cancelled_ || is_cancelling_) {
+  CallbackShard* s = shard(token);
+  mutex_lock shard_lock(s->mu);
+  if (s->cancel_started) {
     return false;
   } else {
-    callbacks_.erase(token);
+    s->callbacks.erase(token);
     return true;
   }
 }
 
 CancellationManager::~CancellationManager() {
-  if (!callbacks_.empty()) {
-    StartCancel();
+  for (int i = 0; i < kNumShards; i++) {
+    if (!shards_[i].callbacks.empty()) {
+      StartCancel();
+      return;
+    }
   }
 }
 
@@ -135,13 +135,30 @@ class CancellationManager {
   bool TryDeregisterCallback(CancellationToken token);
 
  private:
-  bool is_cancelling_;
+  // Callbacks are partitioned across shards by token so that registration
+  // and deregistration on different tokens do not contend on a single
+  // mutex. Only StartCancel() and Reset() touch every shard.
+  static const int kNumShards = 16;
+
+  struct CallbackShard {
+    mutex mu;
+    // Set under `mu` once StartCancel() has drained this shard, so that a
+    // late RegisterCallback() observes the cancellation and fails.
+    bool cancel_started GUARDED_BY(mu) = false;
+    gtl::FlatMap<CancellationToken, CancelCallback> callbacks GUARDED_BY(mu);
+  };
+
+  CallbackShard* shard(CancellationToken token) {
+    return &shards_[token % kNumShards];
+  }
+
+  bool is_cancelling_ GUARDED_BY(mu_);
   std::atomic_bool is_cancelled_;
+  std::atomic<CancellationToken> next_cancellation_token_;
 
   mutex mu_;
   Notification cancelled_notification_;
-  CancellationToken next_cancellation_token_ GUARDED_BY(mu_);
-  gtl::FlatMap<CancellationToken, CancelCallback> callbacks_ GUARDED_BY(mu_);
+  CallbackShard shards_[kNumShards];
 };
 
 }  // namespace tensorflow
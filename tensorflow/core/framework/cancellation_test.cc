@@ -95,6 +95,28 @@ TEST(Cancellation, CancelMultiple) {
   delete manager;
 }
 
+TEST(Cancellation, CancelManyAcrossShards) {
+  // Use enough tokens that every internal callback shard is exercised.
+  static const int kNumCallbacks = 100;
+  CancellationManager manager;
+  std::vector<bool> is_cancelled(kNumCallbacks, false);
+  std::vector<CancellationToken> tokens;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    CancellationToken token = manager.get_cancellation_token();
+    EXPECT_TRUE(manager.RegisterCallback(
+        token, [&is_cancelled, i]() { is_cancelled[i] = true; }));
+    tokens.push_back(token);
+  }
+  // Deregister every fourth callback before cancelling.
+  for (int i = 0; i < kNumCallbacks; i += 4) {
+    EXPECT_TRUE(manager.DeregisterCallback(tokens[i]));
+  }
+  manager.StartCancel();
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    EXPECT_EQ(i % 4 != 0, is_cancelled[i]);
+  }
+}
+
 TEST(Cancellation, IsCancelled) {
   CancellationManager* cm = new CancellationManager();
   thread::ThreadPool w(Env::Default(), "test", 4);
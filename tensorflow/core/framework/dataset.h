@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 
 // Polymorphic datasets should support all primitive TensorFlow
@@ -289,6 +290,7 @@ class IteratorContext {
           function_handle_cache(ctx->function_handle_cache()),
           resource_mgr(ctx->resource_mgr()),
           model(ctx->model()),
+          numa_node(ctx->numa_node()),
           runner(*(ctx->runner())),
           runner_threadpool_size(ctx->runner_threadpool_size()),
           stats_aggregator(ctx->stats_aggregator()),
@@ -335,6 +337,12 @@ class IteratorContext {
     // If non-null, identifies the object used for performance modeling.
     std::shared_ptr<model::Model> model = nullptr;
 
+    // If not kNUMANoAffinity, the NUMA node that threads performing
+    // background work for this iterator are pinned to. Pinning the producer
+    // threads keeps the elements they stage node-local (buffers are placed
+    // by first touch) all the way to the consumer.
+    int numa_node = port::kNUMANoAffinity;
+
     // Function call support.
     std::function<void(std::function<void()>)> runner = nullptr;
 
@@ -383,8 +391,23 @@ class IteratorContext {
     return params_.thread_factory;
   }
 
+  int numa_node() const { return params_.numa_node; }
+
   std::unique_ptr<Thread> StartThread(const string& name,
                                       std::function<void()> fn) {
+    if (params_.numa_node != port::kNUMANoAffinity) {
+      // Pin the thread to the iterator's NUMA node for the duration of `fn`,
+      // so that all parallel transformations (parallel map, interleave,
+      // prefetch, ...) produce and hand off their elements node-locally.
+      // The affinity is dropped afterwards because the thread may be reused.
+      const int node = params_.numa_node;
+      std::function<void()> body = std::move(fn);
+      fn = [node, body]() {
+        port::NUMASetThreadNodeAffinity(node);
+        body();
+        port::NUMASetThreadNodeAffinity(port::kNUMANoAffinity);
+      };
+    }
     if (params_.thread_factory) {
       return params_.thread_factory->StartThread(name, std::move(fn));
     } else {
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
@@ -47,7 +48,9 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/platform_strings.h"
+#include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
@@ -84,6 +87,42 @@ Status MatchSignatureHelper(const DataTypeSlice expected_inputs,
   return Status::OK();
 }
 
+// Process-wide per-op-type tally of bytes allocated through
+// OpKernelContext, readable at runtime through the monitoring collection
+// registry without enabling full allocation tracking.
+auto* bytes_allocated_by_op_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/framework/kernel_bytes_allocated",
+    "Bytes allocated through OpKernelContext, partitioned by op type.",
+    "op_type");
+
+// Returns the stack-capture sampling rate configured with
+// TF_KERNEL_ALLOCATION_STACK_SAMPLE_RATE: every Nth successful allocation
+// (process-wide) gets its stack logged for attribution. Zero (the default)
+// disables sampling.
+int64 InitAllocationStackSampleRate() {
+  int64 sample_rate;
+  Status s = ReadInt64FromEnvVar("TF_KERNEL_ALLOCATION_STACK_SAMPLE_RATE", 0,
+                                 &sample_rate);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+    return 0;
+  }
+  return sample_rate;
+}
+
+void MaybeSampleAllocationStack(const OpKernel* kernel, int64 alloc_bytes) {
+  static const int64 sample_rate = InitAllocationStackSampleRate();
+  if (sample_rate <= 0) return;
+  static std::atomic<int64> allocation_count(0);
+  if (allocation_count.fetch_add(1, std::memory_order_relaxed) % sample_rate !=
+      0) {
+    return;
+  }
+  LOG(INFO) << "Sampled allocation of " << alloc_bytes << " bytes by kernel "
+            << kernel->name() << " (" << kernel->type_string() << "):\n"
+            << CurrentStackTrace();
+}
+
 }  // namespace
 
 // OpKernel ------------------------------------------------------------------
@@ -106,7 +145,12 @@ OpKernel::OpKernel(OpKernelConstruction* context,
       is_internal_(str_util::StartsWith(type_string(), "_")),
       input_name_map_(context->num_inputs()),
       output_name_map_(context->num_outputs()),
-      cost_estimate_(OpKernel::kInitialCostEstimateCycles) {
+      cost_estimate_(OpKernel::kInitialCostEstimateCycles),
+      total_bytes_allocated_(0),
+      peak_invocation_bytes_(0),
+      bytes_allocated_cell_(
+          bytes_allocated_by_op_counter->GetCell(type_string())),
+      scratch_in_use_(false) {
   OP_REQUIRES_OK(context,
                  NameRangesForNode(*def_, *context->op_def_, &input_name_map_,
                                    &output_name_map_));
@@ -281,6 +325,8 @@ OpKernelContext::OpKernelContext(Params* params)
 OpKernelContext::OpKernelContext(Params* params, int num_outputs)
     : params_(params),
       outputs_(num_outputs),
+      scratch_buffer_claimed_(false),
+      invocation_bytes_allocated_(0),
       temp_memory_allocated_(0),
       persistent_memory_allocated_(0) {
   params_->ensure_eigen_gpu_device();
@@ -299,6 +345,22 @@ OpKernelContext::OpKernelContext(Params* params, int num_outputs)
 }
 
 OpKernelContext::~OpKernelContext() {
+  const int64 invocation_bytes =
+      invocation_bytes_allocated_.load(std::memory_order_relaxed);
+  if (invocation_bytes > 0) {
+    OpKernel* kernel = params_->op_kernel;
+    kernel->total_bytes_allocated_.fetch_add(invocation_bytes,
+                                             std::memory_order_relaxed);
+    int64 peak = kernel->peak_invocation_bytes_.load(std::memory_order_relaxed);
+    while (invocation_bytes > peak &&
+           !kernel->peak_invocation_bytes_.compare_exchange_weak(
+               peak, invocation_bytes, std::memory_order_relaxed)) {
+    }
+  }
+  if (scratch_buffer_claimed_) {
+    mutex_lock l(params_->op_kernel->scratch_mu_);
+    params_->op_kernel->scratch_in_use_ = false;
+  }
   for (TensorValue& value : outputs_) {
     if (!value.is_ref()) {
       delete value.tensor;
@@ -717,6 +779,12 @@ Status OpKernelContext::allocate_tensor(
     LogMemory::RecordTensorAllocation(params_->op_kernel->name(),
                                       params_->step_id, new_tensor);
   }
+  // Always-on attribution: cheap enough (two relaxed atomic adds) to keep
+  // enabled in production, unlike full TrackingAllocator instrumentation.
+  const int64 alloc_bytes = new_tensor.TotalBytes();
+  invocation_bytes_allocated_.fetch_add(alloc_bytes, std::memory_order_relaxed);
+  params_->op_kernel->bytes_allocated_cell_->IncrementBy(alloc_bytes);
+  MaybeSampleAllocationStack(params_->op_kernel, alloc_bytes);
   record_tensor_reference(new_tensor);
   *out_tensor = std::move(new_tensor);
   return Status::OK();
@@ -780,6 +848,43 @@ Status OpKernelContext::allocate_persistent(DataType type,
   return s;
 }
 
+Status OpKernelContext::allocate_scratch(DataType type,
+                                         const TensorShape& shape,
+                                         Tensor* out_scratch) {
+  OpKernel* kernel = params_->op_kernel;
+  {
+    mutex_lock l(kernel->scratch_mu_);
+    if (!kernel->scratch_in_use_) {
+      Tensor* t = &kernel->scratch_tensor_;
+      if (t->dtype() != type || t->shape() != shape) {
+        // First invocation, or the requested shape changed: (re)allocate the
+        // retained buffer. It is accounted as persistent memory since it
+        // stays alive inside the OpKernel across invocations.
+        TF_RETURN_IF_ERROR(
+            allocate_tensor(type, shape, t, AllocatorAttributes()));
+        if (track_allocations()) {
+          Allocator* a = get_allocator(AllocatorAttributes());
+          if (a->TracksAllocationSizes()) {
+            int64 alloc_size = a->AllocatedSize(t->tensor_data().data());
+            int64 alloc_id = a->AllocationId(t->tensor_data().data());
+            record_persistent_memory_allocation(alloc_size, alloc_id);
+          }
+        }
+      }
+      kernel->scratch_in_use_ = true;
+      scratch_buffer_claimed_ = true;
+      // As with PersistentTensor::AccessTensor, the runtime must be told
+      // about every use of the retained buffer for correctness on
+      // asynchronous devices such as GPUs.
+      record_tensor_reference(*t);
+      *out_scratch = *t;
+      return Status::OK();
+    }
+  }
+  // Another execution of this kernel currently holds the scratch buffer.
+  return allocate_temp(type, shape, out_scratch);
+}
+
 Status OpKernelContext::set_output(StringPiece name, const Tensor& tensor) {
   int start, stop;
   TF_RETURN_IF_ERROR(params_->op_kernel->OutputRange(name, &start, &stop));
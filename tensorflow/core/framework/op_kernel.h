@@ -75,6 +75,10 @@ class ScopedStepContainer;
 class CollectiveExecutor;
 class StepStatsCollectorInterface;
 
+namespace monitoring {
+class CounterCell;
+}  // namespace monitoring
+
 class OpKernel {
  public:
   // OpKernel won't be instantiated by the scheduler, so you may perform
@@ -197,6 +201,19 @@ class OpKernel {
   // TODO(irving): Move to TensorShapeUtils once !allow_legacy_scalars
   Status MakeShape(const Tensor& shape, TensorShape* out) const;
 
+  // Always-on, low-overhead memory attribution. Updated on every successful
+  // allocation made through an OpKernelContext for this kernel, regardless of
+  // whether full allocation tracking (TrackingAllocator) is enabled.
+  // total_bytes_allocated() is the lifetime sum over all invocations of this
+  // kernel instance; peak_invocation_bytes() is the largest number of bytes
+  // allocated by a single invocation.
+  int64 total_bytes_allocated() const {
+    return total_bytes_allocated_.load(std::memory_order_relaxed);
+  }
+  int64 peak_invocation_bytes() const {
+    return peak_invocation_bytes_.load(std::memory_order_relaxed);
+  }
+
   static int DeviceNumaNode(const DeviceBase* device);
 
  private:
@@ -212,6 +229,23 @@ class OpKernel {
   bool expensive_;
   std::atomic_uint_fast64_t cost_estimate_;
 
+  // See total_bytes_allocated() and peak_invocation_bytes().
+  std::atomic<int64> total_bytes_allocated_;
+  std::atomic<int64> peak_invocation_bytes_;
+  // Cell of the process-wide per-op-type allocation counter, cached here so
+  // the hot allocation path pays a single atomic add instead of a map lookup.
+  monitoring::CounterCell* bytes_allocated_cell_;
+
+  // Scratch buffer retained across invocations; see
+  // OpKernelContext::allocate_scratch. The scratch_in_use_ flag keeps
+  // concurrent executions of the same kernel from sharing one buffer: the
+  // execution that claims the buffer releases it when its OpKernelContext is
+  // destroyed, and any others fall back to a fresh temporary allocation.
+  friend class OpKernelContext;
+  mutex scratch_mu_;
+  Tensor scratch_tensor_ GUARDED_BY(scratch_mu_);
+  bool scratch_in_use_ GUARDED_BY(scratch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(OpKernel);
 };
 
@@ -995,6 +1029,17 @@ class OpKernelContext {
                                AllocatorAttributes());
   }
 
+  // Allocates a scratch Tensor of the specified type and shape, reusing the
+  // buffer the OpKernel retained from a previous invocation when the dtype
+  // and shape still match. For fixed-shape graphs this removes one allocator
+  // round trip per invocation. The returned tensor may only be used during
+  // the current kernel execution, like a tensor from allocate_temp; the
+  // buffer itself stays alive inside the OpKernel. If another concurrent
+  // execution of this kernel currently holds the scratch buffer, a fresh
+  // temporary is allocated instead.
+  Status allocate_scratch(DataType type, const TensorShape& shape,
+                          Tensor* out_scratch);
+
   // Copies a tensor (allocated by the caller) to the specified output
   // index.  REQUIRES: !IsRefType(expected_output_dtype(index))
   // REQUIRES: 'tensor' must have the same MemoryType as
@@ -1262,6 +1307,15 @@ class OpKernelContext {
   gtl::InlinedVector<WrappedAllocator, 4> wrapped_allocators_ GUARDED_BY(mu_);
   gtl::InlinedVector<TensorValue, 4> outputs_;
 
+  // True iff this execution claimed the kernel's retained scratch buffer via
+  // allocate_scratch; the claim is released in the destructor.
+  bool scratch_buffer_claimed_;
+
+  // Bytes allocated through this context, folded into the kernel's always-on
+  // attribution counters in the destructor. Atomic because work items spawned
+  // by the kernel may allocate concurrently.
+  std::atomic<int64> invocation_bytes_allocated_;
+
   // Constructed only if <params->record_tensor_accesses>.
   ManualConstructor<UniqueTensorReferences> referenced_tensors_ GUARDED_BY(mu_);
 
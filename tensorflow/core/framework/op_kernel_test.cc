@@ -371,6 +371,88 @@ TEST_F(OpKernelTest, SaveTempTrue) {
   delete params.device;
 }
 
+TEST_F(OpKernelTest, ScratchReusedAcrossInvocations) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  params.record_tensor_accesses = false;
+  params.device = new DummyDevice(env, params.record_tensor_accesses);
+  Status status;
+  std::unique_ptr<OpKernel> op(
+      CreateOpKernel(DEVICE_CPU, params.device, cpu_allocator(),
+                     CreateNodeDef("Test1", {DT_FLOAT, DT_INT32}),
+                     TF_GRAPH_DEF_VERSION, &status));
+  EXPECT_TRUE(status.ok());
+  params.op_kernel = op.get();
+
+  // A second invocation with the same shape reuses the retained buffer.
+  const void* first_buffer = nullptr;
+  {
+    OpKernelContext ctx(&params);
+    Tensor t;
+    TF_EXPECT_OK(ctx.allocate_scratch(DT_FLOAT, TensorShape({4, 4}), &t));
+    first_buffer = t.tensor_data().data();
+
+    // While this execution holds the scratch buffer, a concurrent request
+    // falls back to a fresh temporary.
+    OpKernelContext other_ctx(&params);
+    Tensor other;
+    TF_EXPECT_OK(
+        other_ctx.allocate_scratch(DT_FLOAT, TensorShape({4, 4}), &other));
+    EXPECT_NE(first_buffer, other.tensor_data().data());
+  }
+  {
+    OpKernelContext ctx(&params);
+    Tensor t;
+    TF_EXPECT_OK(ctx.allocate_scratch(DT_FLOAT, TensorShape({4, 4}), &t));
+    EXPECT_EQ(first_buffer, t.tensor_data().data());
+  }
+
+  // A shape change reallocates the retained buffer.
+  {
+    OpKernelContext ctx(&params);
+    Tensor t;
+    TF_EXPECT_OK(ctx.allocate_scratch(DT_FLOAT, TensorShape({8, 8}), &t));
+    EXPECT_EQ(TensorShape({8, 8}), t.shape());
+  }
+
+  delete params.device;
+}
+
+TEST_F(OpKernelTest, AlwaysOnMemoryAttribution) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  params.record_tensor_accesses = false;
+  params.device = new DummyDevice(env, params.record_tensor_accesses);
+  Status status;
+  std::unique_ptr<OpKernel> op(
+      CreateOpKernel(DEVICE_CPU, params.device, cpu_allocator(),
+                     CreateNodeDef("Test1", {DT_FLOAT, DT_INT32}),
+                     TF_GRAPH_DEF_VERSION, &status));
+  EXPECT_TRUE(status.ok());
+  params.op_kernel = op.get();
+
+  EXPECT_EQ(0, op->total_bytes_allocated());
+  EXPECT_EQ(0, op->peak_invocation_bytes());
+  {
+    OpKernelContext ctx(&params);
+    Tensor t;
+    TF_EXPECT_OK(ctx.allocate_temp(DT_FLOAT, TensorShape({16}), &t));
+  }
+  EXPECT_EQ(64, op->total_bytes_allocated());
+  EXPECT_EQ(64, op->peak_invocation_bytes());
+
+  // A smaller second invocation grows the total but not the peak.
+  {
+    OpKernelContext ctx(&params);
+    Tensor t;
+    TF_EXPECT_OK(ctx.allocate_temp(DT_FLOAT, TensorShape({4}), &t));
+  }
+  EXPECT_EQ(80, op->total_bytes_allocated());
+  EXPECT_EQ(64, op->peak_invocation_bytes());
+
+  delete params.device;
+}
+
 TEST_F(OpKernelTest, InputDtype) {
   Env* env = Env::Default();
   OpKernelContext::Params params;
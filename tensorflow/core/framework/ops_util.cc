@@ -62,6 +62,15 @@ Status GetBroadcastSize(const int index, const int in_size, const int ksize,
   return Status::OK();
 }
 
+bool IsSliceDimContiguous(const TensorShape& s, int dim) {
+  DCHECK_GE(dim, 0);
+  DCHECK_LT(dim, s.dims());
+  for (int i = 0; i < dim; ++i) {
+    if (s.dim_size(i) != 1) return false;
+  }
+  return true;
+}
+
 string SanitizeThreadSuffix(string suffix) {
   string clean;
   for (int i = 0; i < suffix.size(); ++i) {
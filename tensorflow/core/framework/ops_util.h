@@ -81,6 +81,13 @@ bool IsDim0SliceAligned(const TensorShape& s, int64 start, int64 end_or_size) {
   }
 }
 
+// Given a shape 's' and a dimension 'dim' along which a tensor is about to be
+// sliced, returns true iff each slice is contiguous in memory, i.e. every
+// dimension before 'dim' has size 1. Such a slice can share the underlying
+// buffer as if it were taken along dim 0 of a two-dimensional alias of the
+// tensor.
+bool IsSliceDimContiguous(const TensorShape& s, int dim);
+
 // Returns <suffix> sanitized to have only [a-zA-Z0-9-_].
 string SanitizeThreadSuffix(string suffix);
 
@@ -107,8 +107,12 @@ ResourceMgr::~ResourceMgr() { Clear(); }
 void ResourceMgr::Clear() {
   mutex_lock l(mu_);
   for (const auto& p : containers_) {
-    for (const auto& q : *p.second) {
-      q.second->Unref();
+    for (auto& shard : p.second->shards) {
+      mutex_lock ls(shard.mu);
+      for (const auto& q : shard.map) {
+        q.second->Unref();
+      }
+      shard.map.clear();
     }
     delete p.second;
   }
@@ -126,13 +130,16 @@ string ResourceMgr::DebugString() const {
   std::vector<Line> lines;
   for (const auto& p : containers_) {
     const string& container = p.first;
-    for (const auto& q : *p.second) {
-      const Key& key = q.first;
-      const char* type = DebugTypeName(key.first);
-      const string& resource = key.second;
-      Line l{&container, port::Demangle(type), &resource,
-             q.second->DebugString()};
-      lines.push_back(l);
+    for (const auto& shard : p.second->shards) {
+      tf_shared_lock ls(shard.mu);
+      for (const auto& q : shard.map) {
+        const Key& key = q.first;
+        const char* type = DebugTypeName(key.first);
+        const string& resource = key.second;
+        Line l{&container, port::Demangle(type), &resource,
+               q.second->DebugString()};
+        lines.push_back(l);
+      }
     }
   }
   std::vector<string> text;
@@ -152,7 +159,14 @@ Status ResourceMgr::DoCreate(const string& container, TypeIndex type,
   if (*b == nullptr) {
     *b = new Container;
   }
-  if ((*b)->insert({{type.hash_code(), name}, resource}).second) {
+  const Key key{type.hash_code(), name};
+  Container::Shard& shard = (*b)->shard(key);
+  bool inserted;
+  {
+    mutex_lock ls(shard.mu);
+    inserted = shard.map.insert({key, resource}).second;
+  }
+  if (inserted) {
     TF_RETURN_IF_ERROR(InsertDebugTypeName(type.hash_code(), type.name()));
     return Status::OK();
   }
@@ -170,7 +184,10 @@ Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
                             " does not exist. (Could not find resource: ",
                             container, "/", name, ")");
   }
-  auto r = gtl::FindPtrOrNull(*b, {type.hash_code(), name});
+  const Key key{type.hash_code(), name};
+  const Container::Shard& shard = b->shard(key);
+  tf_shared_lock ls(shard.mu);
+  auto r = gtl::FindPtrOrNull(shard.map, key);
   if (r == nullptr) {
     return errors::NotFound("Resource ", container, "/", name, "/", type.name(),
                             " does not exist.");
@@ -185,18 +202,21 @@ Status ResourceMgr::DoDelete(const string& container, uint64 type_hash_code,
                              const string& type_name) {
   ResourceBase* base = nullptr;
   {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     Container* b = gtl::FindPtrOrNull(containers_, container);
     if (b == nullptr) {
       return errors::NotFound("Container ", container, " does not exist.");
     }
-    auto iter = b->find({type_hash_code, resource_name});
-    if (iter == b->end()) {
+    const Key key{type_hash_code, resource_name};
+    Container::Shard& shard = b->shard(key);
+    mutex_lock ls(shard.mu);
+    auto iter = shard.map.find(key);
+    if (iter == shard.map.end()) {
       return errors::NotFound("Resource ", container, "/", resource_name, "/",
                               type_name, " does not exist.");
     }
     base = iter->second;
-    b->erase(iter);
+    shard.map.erase(iter);
   }
   CHECK(base != nullptr);
   base->Unref();
@@ -233,8 +253,11 @@ Status ResourceMgr::Cleanup(const string& container) {
     containers_.erase(iter);
   }
   CHECK(b != nullptr);
-  for (const auto& p : *b) {
-    p.second->Unref();
+  for (auto& shard : b->shards) {
+    mutex_lock ls(shard.mu);
+    for (const auto& p : shard.map) {
+      p.second->Unref();
+    }
   }
   delete b;
   return Status::OK();
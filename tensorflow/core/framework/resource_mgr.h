@@ -190,7 +190,27 @@ class ResourceMgr {
       return (x.second == y.second) && (x.first == y.first);
     }
   };
-  typedef std::unordered_map<Key, ResourceBase*, KeyHash, KeyEqual> Container;
+  typedef std::unordered_map<Key, ResourceBase*, KeyHash, KeyEqual> ShardMap;
+
+  // Each container shards its resource map by key hash so concurrent
+  // accesses of different resources (e.g. hundreds of variable reads per
+  // step) do not serialize on a single mutex.  mu_ still orders container
+  // creation and deletion; the per-shard mutexes guard the maps.
+  struct Container {
+    static const int kNumShards = 64;
+    struct Shard {
+      mutable mutex mu;
+      ShardMap map GUARDED_BY(mu);
+    };
+    Shard shards[kNumShards];
+
+    Shard& shard(const Key& key) {
+      return shards[KeyHash()(key) % kNumShards];
+    }
+    const Shard& shard(const Key& key) const {
+      return shards[KeyHash()(key) % kNumShards];
+    }
+  };
 
   const string default_container_;
   mutable mutex mu_;
@@ -390,13 +390,35 @@ void TensorShapeBase<Shape>::InsertDim(int d, int64 size) {
   CHECK_LE(d, dims());
   if (!kIsPartial) CHECK_GE(size, 0);
   CHECK_LT(dims(), MaxDimensions());
-  gtl::InlinedVector<int64, 8> vals;
-  AppendTo(*this, &vals);
-  vals.insert(vals.begin() + d, size);
-  ClearAllButDataType();
-  for (auto dval : vals) {
-    AddDim(dval);
+  // When the current representation has room for another dimension, shift the
+  // trailing dimensions up in place rather than rebuilding the shape through a
+  // temporary vector.
+  const int nd = ndims_byte();
+  if (tag() == REP16 && nd < 6 && size < kMaxRep16) {
+    uint16* dst = as16()->dims_;
+    for (int i = nd; i > d; --i) dst[i] = dst[i - 1];
+    dst[d] =
+        kIsPartial && size < 0 ? kUnknownRep16 : static_cast<uint16>(size);
+  } else if (tag() == REP32 && nd < 3 && size < kMaxRep32) {
+    uint32* dst = as32()->dims_;
+    for (int i = nd; i > d; --i) dst[i] = dst[i - 1];
+    dst[d] =
+        kIsPartial && size < 0 ? kUnknownRep32 : static_cast<uint32>(size);
+  } else if (tag() == REP_OUT_OF_LINE) {
+    as64()->dims_->insert(as64()->dims_->begin() + d, size);
+  } else {
+    // Need to change representation.
+    gtl::InlinedVector<int64, 8> vals;
+    AppendTo(*this, &vals);
+    vals.insert(vals.begin() + d, size);
+    ClearAllButDataType();
+    for (auto dval : vals) {
+      AddDim(dval);
+    }
+    return;
   }
+  set_ndims_byte(nd + 1);
+  RecomputeNumElements();
 }
 
 template <class Shape>
@@ -444,13 +466,21 @@ void TensorShapeBase<Shape>::RemoveDimRange(int begin, int end) {
   CHECK_GE(end, 0);
   CHECK_LE(end, dims());
   if (begin >= end) return;
-  gtl::InlinedVector<int64, 8> vals;
-  AppendTo(*this, &vals);
-  vals.erase(vals.begin() + begin, vals.begin() + end);
-  ClearAllButDataType();
-  for (auto dval : vals) {
-    AddDim(dval);
+  // Every representation can drop a contiguous range of dimensions in place:
+  // shift the trailing dimensions down and shrink the rank.
+  const int num_removed = end - begin;
+  const int nd = ndims_byte();
+  if (tag() == REP16) {
+    uint16* dst = as16()->dims_;
+    for (int i = end; i < nd; ++i) dst[i - num_removed] = dst[i];
+  } else if (tag() == REP32) {
+    uint32* dst = as32()->dims_;
+    for (int i = end; i < nd; ++i) dst[i - num_removed] = dst[i];
+  } else {
+    gtl::InlinedVector<int64, 4>* vals = as64()->dims_;
+    vals->erase(vals->begin() + begin, vals->begin() + end);
   }
+  set_ndims_byte(nd - num_removed);
   RecomputeNumElements();
 }
 
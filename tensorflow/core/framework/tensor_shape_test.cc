@@ -117,6 +117,36 @@ TEST(TensorShapeTest, RemoveDimRange) {
   ASSERT_EQ(42, s3.num_elements());
 }
 
+TEST(TensorShapeTest, RemoveDimRangeLargeDims) {
+  // Exercises the removal paths for the 32-bit and out-of-line
+  // representations.
+  TensorShape s32({2, 1LL << 20, 3});
+  s32.RemoveDimRange(1, 2);
+  ASSERT_EQ(2, s32.dims());
+  EXPECT_EQ(6, s32.num_elements());
+
+  TensorShape s64({2, 1LL << 40, 3, 5});
+  s64.RemoveDimRange(0, 2);
+  ASSERT_EQ(2, s64.dims());
+  EXPECT_EQ(15, s64.num_elements());
+}
+
+TEST(TensorShapeTest, InsertDimLargeDims) {
+  // Exercises the insertion paths for the 32-bit and out-of-line
+  // representations.
+  TensorShape s32({2, 1LL << 20});
+  s32.InsertDim(1, 3);
+  ASSERT_EQ(3, s32.dims());
+  EXPECT_EQ(3, s32.dim_size(1));
+  EXPECT_EQ(6LL << 20, s32.num_elements());
+
+  TensorShape s64({2, 1LL << 40});
+  s64.InsertDim(0, 3);
+  ASSERT_EQ(3, s64.dims());
+  EXPECT_EQ(3, s64.dim_size(0));
+  EXPECT_EQ(6LL << 40, s64.num_elements());
+}
+
 TEST(TensorShapeTest, InvalidShapeProto) {
   TensorShapeProto proto;
   EXPECT_TRUE(TensorShape::IsValid(proto));
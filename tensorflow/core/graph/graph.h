@@ -478,6 +478,12 @@ class Graph {
   // Returns nullptr and sets *status on error.
   Node* AddNode(const NodeDef& node_def, Status* status);
 
+  // Same as above, but the returned node takes over the contents of
+  // `node_def` instead of copying them, which avoids duplicating any
+  // large attr values (e.g. the tensors of Const nodes). `node_def` is
+  // left in an unspecified state.
+  Node* AddNode(NodeDef&& node_def, Status* status);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
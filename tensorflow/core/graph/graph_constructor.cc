@@ -138,7 +138,29 @@ class GraphConstructor {
                                        TF_GRAPH_DEF_VERSION_MIN_PRODUCER,
                                        "GraphDef", "graph"));
     }
-    GraphConstructor c(opts, node_defs, versions, library, g, refiner,
+    GraphConstructor c(opts, node_defs, versions, library,
+                       /*consume_graph_def=*/nullptr, g, refiner,
+                       return_tensors, return_nodes,
+                       missing_unused_input_map_keys);
+    const Status s = c.TryImport();
+    if (!s.ok()) c.Undo();
+    return s;
+  }
+
+  // As above, but the graph's nodes take over the contents of graph_def's
+  // node defs instead of copying them, leaving graph_def's node defs in an
+  // unspecified state.
+  static Status Construct(
+      const Options& opts, GraphDef* graph_def, Graph* g, ShapeRefiner* refiner,
+      std::vector<std::pair<Node*, int>>* return_tensors,
+      std::vector<Node*>* return_nodes,
+      std::vector<SafeTensorId>* missing_unused_input_map_keys) {
+    TF_RETURN_IF_ERROR(CheckVersions(graph_def->versions(),
+                                     TF_GRAPH_DEF_VERSION,
+                                     TF_GRAPH_DEF_VERSION_MIN_PRODUCER,
+                                     "GraphDef", "graph"));
+    GraphConstructor c(opts, graph_def->node(), &graph_def->versions(),
+                       &graph_def->library(), graph_def, g, refiner,
                        return_tensors, return_nodes,
                        missing_unused_input_map_keys);
     const Status s = c.TryImport();
@@ -149,7 +171,8 @@ class GraphConstructor {
  private:
   GraphConstructor(const Options& opts, NodeDefSlice node_defs,
                    const VersionDef* versions,
-                   const FunctionDefLibrary* library, Graph* g,
+                   const FunctionDefLibrary* library,
+                   GraphDef* consume_graph_def, Graph* g,
                    ShapeRefiner* refiner,
                    std::vector<std::pair<Node*, int>>* return_tensors,
                    std::vector<Node*>* return_nodes,
@@ -158,6 +181,7 @@ class GraphConstructor {
         node_defs_(node_defs),
         versions_(versions),
         library_(library),
+        consume_graph_def_(consume_graph_def),
         g_(g),
         original_versions_(g->versions()),
         prefix_(opts.prefix),
@@ -195,9 +219,15 @@ class GraphConstructor {
 
   void Undo();
 
+  // Looks up the OpDef for an op type in the graph's op registry, memoizing
+  // the result. Importing a large graph looks up the same few op types once
+  // per node; the memo turns the repeated registry probes (which hash the op
+  // name under a shared lock) into local map hits.
+  Status LookUpOpDefCached(const string& op_type_name, const OpDef** op_def);
+
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
-  Status MakeNode(const NodeDef& node_def, Node** node);
+  Status MakeNode(NodeDef&& node_def, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -240,13 +270,25 @@ class GraphConstructor {
 
   // Decrement pending count for users of `processed` and add the ones that now
   // have all of their pending inputs satisfied to `ready_`.
-  void UpdatePendingCountAndReady(int processed);
+  void UpdatePendingCountAndReady(int processed, bool is_next_iteration);
+
+  // Returns the NodeDef at index i, moving it out of consume_graph_def_ when
+  // one was handed to Construct(). The NodeDef in node_defs_ must not be read
+  // again once this has been called.
+  NodeDef ConsumeNodeDef(int i) {
+    if (consume_graph_def_ == nullptr) return *node_defs_[i];
+    return std::move(*consume_graph_def_->mutable_node(i));
+  }
 
   // From constructor
   const Options opts_;
   const NodeDefSlice node_defs_;
   const VersionDef* versions_;
   const FunctionDefLibrary* library_;
+  // May be null. Not owned. When set, node_defs_ points into its node defs,
+  // and ConsumeNodeDef() moves them into the graph's nodes instead of
+  // copying them.
+  GraphDef* consume_graph_def_;
   Graph* g_;
   const VersionDef original_versions_;
 
@@ -276,21 +318,28 @@ class GraphConstructor {
     int gdef_index;
     Node* node;  // nullptr until the NodeDef is converted to a Node.
   };
-  gtl::FlatMap<StringPiece, NodeInfo, StringPieceHasher> gdef_nodes_;
+  // Keys are copies of the node names rather than StringPieces into
+  // node_defs_, since ConsumeNodeDef() may invalidate the latter.
+  gtl::FlatMap<string, NodeInfo> gdef_nodes_;
 
   // Prefixes already used in the GraphDef being imported.
-  gtl::FlatSet<StringPiece, StringPieceHasher> gdef_prefixes_;
+  gtl::FlatSet<string> gdef_prefixes_;
 
   // Mapping from node name to the existing node in g_.
   gtl::FlatMap<StringPiece, Node*, StringPieceHasher> existing_nodes_;
 
   // Prefixes already used in the graph.
-  gtl::FlatSet<StringPiece, StringPieceHasher> existing_prefixes_;
+  gtl::FlatSet<string> existing_prefixes_;
 
   // Imported node names that have been uniquified. The key is the original
   // name, the value is the new unique name.
   gtl::FlatMap<string, string> uniquified_names_;
 
+  // Memo for LookUpOpDefCached(). Values are owned by the op registry and
+  // are stable for the duration of the import: functions are added to the
+  // registry before any node is converted.
+  gtl::FlatMap<string, const OpDef*> op_def_cache_;
+
   // Index of NodeDefs in node_defs_ with all inputs already converted. We use a
   // (sorted) set so nodes are created in the order defined in the GraphDef.
   std::set<int> ready_;
@@ -338,10 +387,10 @@ class GraphConstructor {
   std::vector<EdgeInfo> back_edges_;
 };
 
-void GraphConstructor::UpdatePendingCountAndReady(int processed) {
+void GraphConstructor::UpdatePendingCountAndReady(int processed,
+                                                  bool is_next_iteration) {
   // We didn't consider NextIteration->Merge edges when computing
   // pending_counts_ so we should not have to consider it here either.
-  bool is_next_iteration = IsNextIteration(*node_defs_[processed]);
   for (size_t i = 0; i < outputs_[processed].size(); ++i) {
     const int output = outputs_[processed][i];
     bool is_next_iteration_to_merge_edge =
@@ -375,11 +424,10 @@ bool NodeNameInValues(const std::vector<string>& control_dependencies,
 
 // Adds any prefixes of `node_name` (not including the full name itself) to
 // `prefixes`.
-void AddPrefixes(StringPiece node_name,
-                 gtl::FlatSet<StringPiece, StringPieceHasher>* prefixes) {
+void AddPrefixes(StringPiece node_name, gtl::FlatSet<string>* prefixes) {
   size_t idx = -1;
   while ((idx = node_name.find('/', idx + 1)) != StringPiece::npos) {
-    prefixes->insert(node_name.substr(0, idx));
+    prefixes->insert(string(node_name.substr(0, idx)));
   }
 }
 
@@ -462,7 +510,7 @@ Status GraphConstructor::BuildNodeIndex() {
           "': Node name contains invalid characters");
     }
     if (!gdef_nodes_
-             .insert(std::make_pair(StringPiece(node_def.name()), NodeInfo(n)))
+             .insert(std::make_pair(node_def.name(), NodeInfo(n)))
              .second) {
       return errors::InvalidArgument("Node '", node_def.name(),
                                      "' is not unique");
@@ -548,7 +596,7 @@ Status GraphConstructor::InitFromEdges() {
       if (opts_.input_map.count(id) == 0) {
         // If an input is not mapped, then the input should appear in the graph
         // being imported.
-        auto iter = gdef_nodes_.find(id.first);
+        auto iter = gdef_nodes_.find(string(id.first));
         if (iter == gdef_nodes_.end()) {
           return errors::InvalidArgument("Node '", node_def.name(),
                                          "': Unknown input node '",
@@ -579,7 +627,7 @@ Status GraphConstructor::ValidateColocationConstraints(
   for (const string& c : iter->second.list().s()) {
     StringPiece s(c);
     if (str_util::ConsumePrefix(&s, kColocationGroupPrefix) &&
-        gdef_nodes_.find(s) == gdef_nodes_.end()) {
+        gdef_nodes_.find(string(s)) == gdef_nodes_.end()) {
       return errors::InvalidArgument(
           "Node '", node_def.name(),
           "' expects to be colocated with unknown node '", s, "'");
@@ -588,13 +636,13 @@ Status GraphConstructor::ValidateColocationConstraints(
   return Status::OK();
 }
 
-Status GraphConstructor::MakeNode(const NodeDef& node_def, Node** node) {
+Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   // Add the node to the graph.
   Status status;
-  *node = g_->AddNode(node_def, &status);
+  *node = g_->AddNode(std::move(node_def), &status);
   if (!status.ok()) return status;
   if (opts_.expect_device_spec) {
-    (*node)->set_assigned_device_name(node_def.device());
+    (*node)->set_assigned_device_name((*node)->def().device());
   }
   return Status::OK();
 }
@@ -697,7 +745,7 @@ Status GraphConstructor::ValidateShape(Node* node) {
 
 Status GraphConstructor::ModifyNodeDefForImport(NodeDef* node_def) {
   const OpDef* op_def;
-  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  TF_RETURN_IF_ERROR(LookUpOpDefCached(node_def->op(), &op_def));
   AddDefaultsToNodeDef(*op_def, node_def);
   TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
   if (versions_) {
@@ -771,7 +819,7 @@ void GraphConstructor::AddControlDependencies(
     // TODO(skyewm): we have many redundant ParseTensorName calls. It could be
     // worth optimizing these.
     TensorId id(ParseTensorName(node_def->input(i)));
-    auto iter = gdef_nodes_.find(id.first);
+    auto iter = gdef_nodes_.find(string(id.first));
     DCHECK(iter != gdef_nodes_.end()) << id.first;
     if (iter->second.node == nullptr) {
       // Input hasn't been created yet, indicating it's a backedge.
@@ -888,13 +936,14 @@ void GraphConstructor::UpdateUniquifiedColocationNames() {
 
 bool GraphConstructor::NameExistsInGraph(StringPiece name) {
   if (existing_nodes_.find(name) != existing_nodes_.end()) return true;
-  if (existing_prefixes_.find(name) != existing_prefixes_.end()) return true;
+  if (existing_prefixes_.find(string(name)) != existing_prefixes_.end())
+    return true;
   return false;
 }
 
 bool GraphConstructor::NameExistsInGraphDef(StringPiece name) {
-  if (gdef_nodes_.find(name) != gdef_nodes_.end()) return true;
-  if (gdef_prefixes_.find(name) != gdef_prefixes_.end()) return true;
+  if (gdef_nodes_.find(string(name)) != gdef_nodes_.end()) return true;
+  if (gdef_prefixes_.find(string(name)) != gdef_prefixes_.end()) return true;
   return false;
 }
 
@@ -909,10 +958,22 @@ string GraphConstructor::FindUniqueName(StringPiece original_name) {
   return name;
 }
 
+Status GraphConstructor::LookUpOpDefCached(const string& op_type_name,
+                                           const OpDef** op_def) {
+  auto iter = op_def_cache_.find(op_type_name);
+  if (iter != op_def_cache_.end()) {
+    *op_def = iter->second;
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(op_type_name, op_def));
+  op_def_cache_.emplace(op_type_name, *op_def);
+  return Status::OK();
+}
+
 Status GraphConstructor::IsNodeFullyMapped(const NodeDef& node_def,
                                            bool* is_node_mapped) {
   const OpDef* op_def;
-  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
+  TF_RETURN_IF_ERROR(LookUpOpDefCached(node_def.op(), &op_def));
   for (int i = 0; i < op_def->output_arg_size(); ++i) {
     if (opts_.input_map.find({node_def.name(), i}) == opts_.input_map.end()) {
       *is_node_mapped = false;
@@ -950,6 +1011,12 @@ Status GraphConstructor::Convert() {
     NodeDef imported_node_def;
     const NodeDef* node_def;
 
+    // Capture these before MakeNode() below, which may consume the NodeDef in
+    // node_defs_[o].
+    NodeInfo* gdef_node_info =
+        &gdef_nodes_.find(original_node_def.name())->second;
+    const bool is_next_iteration = IsNextIteration(original_node_def);
+
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
     // to importing node_defs_).  Conversely, input_already_exists[i] is false
@@ -964,7 +1031,7 @@ Status GraphConstructor::Convert() {
             IsNodeFullyMapped(original_node_def, &is_node_mapped));
         if (is_node_mapped) {
           // Skip this node after updating pending_count_ for outputs
-          UpdatePendingCountAndReady(o);
+          UpdatePendingCountAndReady(o, is_next_iteration);
           continue;
         }
       }
@@ -1000,7 +1067,7 @@ Status GraphConstructor::Convert() {
 
       if (!input_already_exists[i]) {
         // Locate input in newly-imported nodes
-        auto iter = gdef_nodes_.find(tensor_id.node());
+        auto iter = gdef_nodes_.find(string(tensor_id.node()));
         DCHECK(iter != gdef_nodes_.end()) << tensor_id.node();
         src_node = iter->second.node;
         src_index = tensor_id.index();
@@ -1040,10 +1107,11 @@ Status GraphConstructor::Convert() {
         UniquifyNames(input_already_exists, &imported_node_def);
       }
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&imported_node_def));
+      TF_RETURN_IF_ERROR(MakeNode(std::move(imported_node_def), &node));
+    } else {
+      TF_RETURN_IF_ERROR(MakeNode(ConsumeNodeDef(o), &node));
     }
-    TF_RETURN_IF_ERROR(MakeNode(*node_def, &node));
-    // Use original_node_def so name StringPiece remains valid
-    gdef_nodes_[original_node_def.name()].node = node;
+    gdef_node_info->node = node;
 
     // Remove duplicate control inputs before adding edges to the graph. It
     // will allow us to skip expensive duplicates check in 'AddControlEdge'.
@@ -1070,7 +1138,7 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(ValidateShape(node));
 
     // Update pending_count_ for outputs.
-    UpdatePendingCountAndReady(o);
+    UpdatePendingCountAndReady(o, is_next_iteration);
   }
 
   if (processed < node_defs_.size()) {
@@ -1137,7 +1205,7 @@ Status GraphConstructor::PopulateReturnTensors() {
     auto iter = opts_.input_map.find(id);
     if (iter == opts_.input_map.end()) {
       // Locate id in imported nodes
-      auto iter = gdef_nodes_.find(id.first);
+      auto iter = gdef_nodes_.find(string(id.first));
       if (iter == gdef_nodes_.end()) {
         return errors::InvalidArgument("Requested return tensor '",
                                        id.ToString(),
@@ -1165,7 +1233,7 @@ Status GraphConstructor::PopulateReturnTensors() {
 Status GraphConstructor::PopulateReturnNodes() {
   if (opts_.return_nodes.empty()) return Status::OK();
   for (StringPiece name : opts_.return_nodes) {
-    auto iter = gdef_nodes_.find(name);
+    auto iter = gdef_nodes_.find(string(name));
     if (iter == gdef_nodes_.end()) {
       return errors::InvalidArgument("Requested return node '", name,
                                      "' not found in graph def");
@@ -1181,7 +1249,7 @@ Status GraphConstructor::PopulateMissingUnusedInputMapKeys() {
     TensorId key = input_map_pair.first;
     if (used_input_map_keys_.count(key) > 0) continue;
 
-    auto pair = gdef_nodes_.find(key.first);
+    auto pair = gdef_nodes_.find(string(key.first));
     if (pair == gdef_nodes_.end()) {
       // key's node doesn't exist in GraphDef
       missing_unused_input_map_keys_->push_back(key);
@@ -1193,7 +1261,7 @@ Status GraphConstructor::PopulateMissingUnusedInputMapKeys() {
     // opts_.skip_mapped_nodes is true.
     const NodeDef* node_def = node_defs_[pair->second.gdef_index];
     const OpDef* op_def;
-    TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+    TF_RETURN_IF_ERROR(LookUpOpDefCached(node_def->op(), &op_def));
     int num_outputs;
     TF_RETURN_IF_ERROR(NumOutputsForNode(*node_def, *op_def, &num_outputs));
     if (key.second >= num_outputs) {
@@ -1232,12 +1300,22 @@ Status GraphConstructor::MakeEdge(Node* src, int output_index, Node* dst,
 Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                               const GraphDef& gdef, Graph* g) {
   ShapeRefiner refiner(gdef.versions().producer(), g->op_registry());
+  refiner.set_shape_inference_cache(ShapeInferenceCache::Global());
   return GraphConstructor::Construct(
       opts, gdef.node(), &gdef.versions(), &gdef.library(), g, &refiner,
       /*return_tensors=*/nullptr, /*return_nodes=*/nullptr,
       /*missing_unused_input_map_keys=*/nullptr);
 }
 
+Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
+                              GraphDef&& gdef, Graph* g) {
+  ShapeRefiner refiner(gdef.versions().producer(), g->op_registry());
+  refiner.set_shape_inference_cache(ShapeInferenceCache::Global());
+  return GraphConstructor::Construct(
+      opts, &gdef, g, &refiner, /*return_tensors=*/nullptr,
+      /*return_nodes=*/nullptr, /*missing_unused_input_map_keys=*/nullptr);
+}
+
 Status ConvertNodeDefsToGraph(const GraphConstructorOptions& opts,
                               gtl::ArraySlice<NodeDef> nodes, Graph* g) {
   ShapeRefiner refiner(TF_GRAPH_DEF_VERSION, g->op_registry());
@@ -46,6 +46,13 @@ struct GraphConstructorOptions {
 extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      const GraphDef& gdef, Graph* g);
 
+// Same as the overload above, but the graph's nodes take over the contents
+// of gdef's node defs instead of copying them, which avoids duplicating
+// every attr value (in particular the tensors of large Const nodes) during
+// conversion. gdef's node defs are left in an unspecified state.
+extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
+                                     GraphDef&& gdef, Graph* g);
+
 // Same as ConvertGraphDefToGraph, but takes just nodes.  Used by function
 // instantiation.
 // TODO(irving): This will turn into std::vector<NodeInfoPtr> soon.
@@ -867,6 +867,23 @@ TEST_F(GraphConstructorTest, SimpleModel) {
   EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
 }
 
+TEST_F(GraphConstructorTest, SimpleModelMovedNodeDefs) {
+  // The GraphDef&& overload moves the node defs into the graph's nodes
+  // instead of copying them.
+  Convert(
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1', 'input:1' ] }");
+  GraphConstructorOptions opts;
+  TF_CHECK_OK(ConvertGraphDefToGraph(opts, std::move(gdef_), &graph_));
+  EXPECT_TRUE(HasNode("W1"));
+  EXPECT_TRUE(HasNode("input"));
+  EXPECT_TRUE(HasNode("t1"));
+  EXPECT_TRUE(HasEdge("W1", 0, "t1", 0));
+  EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
+  EXPECT_EQ("TestMul", FindNode("t1")->def().op());
+}
+
 TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   ExpectOK(
       "node { name: 'W1' op: 'TestParams' }"
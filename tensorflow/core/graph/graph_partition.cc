@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <algorithm>
 #include <deque>
 #include <queue>
 #include <unordered_map>
@@ -35,10 +36,15 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
@@ -950,30 +956,60 @@ void SetIncarnation(const PartitionOptions& opts, GraphDef* gdef) {
   }
 }
 
-Status Partition(const PartitionOptions& opts, Graph* g,
-                 std::unordered_map<string, GraphDef>* partitions) {
-  Status status;
-  partitions->clear();
+namespace {
 
-  GraphInfo g_info;
-  if (!opts.control_flow_added) {
-    // Add the "code" for distributed execution of control flow. Code is
-    // added only for the frames that are placed on multiple devices. The
-    // new graph is an equivalent transformation of the original graph and
-    // has the property that it can be subsequently partitioned arbitrarily
-    // (down to the level of individual device) for distributed execution.
-    status = AddControlFlow(opts, g, &g_info);
-    if (!status.ok()) return status;
+// Number of partitions at which Partition() builds them in parallel rather
+// than in one pass over the graph.  Below this the serial pass wins (and
+// keeps the historical generated-name order).
+const size_t kMinPartitionsForParallelBuild = 8;
+
+// Per-partition locks used when partitions are built by several threads at
+// once.  A task owns one destination partition but appends Send (and dummy
+// Const) nodes to source partitions on cut edges, so two tasks may contend
+// on one GraphDef.  Locks are never nested, so any acquisition order is
+// safe.
+//
+// NOTE: appending to a GraphDef's node field never moves existing NodeDefs,
+// so once a node has been added under the lock it can be mutated (inputs,
+// attrs) without it; the locks only guard add_node().
+struct PartitionSync {
+  std::unordered_map<const GraphDef*, std::unique_ptr<mutex>> graph_mu;
+};
+
+// Holds the partition's lock while in scope when 'sync' is non-null; no-op
+// in the serial path.
+class MaybeGraphLock {
+ public:
+  MaybeGraphLock(PartitionSync* sync, const GraphDef* gdef)
+      : mu_(sync == nullptr ? nullptr : sync->graph_mu.at(gdef).get()) {
+    if (mu_ != nullptr) mu_->lock();
+  }
+  ~MaybeGraphLock() {
+    if (mu_ != nullptr) mu_->unlock();
   }
 
-  // At this point, all the graph mutations have been done. Build memory
-  // and device type info for every node and edge in the graph.
-  status = BuildMemoryDeviceInfo(*g, &g_info);
-  if (!status.ok()) return status;
+ private:
+  mutex* mu_;
+};
 
+// Builds the parts of the partitions owned by the nodes in 'dst_nodes':
+// copies each node into its partition and splits its cut input edges with
+// Send/Recv pairs, recording rendezvous dedup state in 'dup_recv'.  All
+// partitions must already exist in 'partitions'.
+//
+// When 'sync' is non-null several BuildPartitions() calls run concurrently,
+// one per destination partition; 'opts.new_name' must then be thread safe
+// and 'dup_recv' must be private to this call (its keys involve only this
+// call's destination partition, so tables can simply be kept per task).
+Status BuildPartitions(const PartitionOptions& opts, const GraphInfo& g_info,
+                       const std::vector<const Node*>& dst_nodes,
+                       PartitionSync* sync,
+                       std::unordered_map<string, GraphDef>* partitions,
+                       DupRecvTable* dup_recv, int32* num_data,
+                       int32* num_control) {
+  Status status;
   string dstp;
   std::vector<const Edge*> inputs;
-  DupRecvTable dup_recv(3);
   // For a node dst, 'ref_recvs' remembers the recvs introduced by a ref
   // edge to dst. 'ref_control_inputs' remembers the inputs by a non-ref
   // edge to dst. We will add a control edge for every pair in
@@ -981,12 +1017,14 @@ Status Partition(const PartitionOptions& opts, Graph* g,
   std::vector<NodeDef*> ref_recvs;
   std::vector<string> ref_control_inputs;
 
-  int32 num_data = 0;
-  int32 num_control = 0;
-  for (const Node* dst : g->op_nodes()) {
+  for (const Node* dst : dst_nodes) {
     dstp = opts.node_to_loc(dst);
-    GraphDef* dst_graph = &(*partitions)[dstp];
-    NodeDef* dst_def = dst_graph->add_node();
+    GraphDef* dst_graph = &partitions->at(dstp);
+    NodeDef* dst_def;
+    {
+      MaybeGraphLock l(sync, dst_graph);
+      dst_def = dst_graph->add_node();
+    }
     *dst_def = dst->def();
     MergeDebugInfo(NodeDebugInfo(dst->def()), dst_def);
     dst_def->set_device(dst->assigned_device_name());
@@ -1042,7 +1080,7 @@ Status Partition(const PartitionOptions& opts, Graph* g,
       const Node* src = edge->src();
       if (!src->IsOp()) continue;  // Skip Sink/Source nodes.
 
-      GraphDef* src_graph = &(*partitions)[opts.node_to_loc(src)];
+      GraphDef* src_graph = &partitions->at(opts.node_to_loc(src));
       if (src_graph == dst_graph && !NeedSameDeviceSendRecv(edge, g_info)) {
         // Same partition and compatible memory types:
         AddInput(dst_def, src->name(), edge->src_output());
@@ -1075,8 +1113,8 @@ Status Partition(const PartitionOptions& opts, Graph* g,
       // the same tensor/control from the src to dst partition.
       const bool on_host = IsDstInputOnHost(edge, g_info);
       DupRecvKey key{src->id(), edge->src_output(), dst_graph, on_host};
-      auto iter = dup_recv.find(key);
-      if (iter != dup_recv.end()) {
+      auto iter = dup_recv->find(key);
+      if (iter != dup_recv->end()) {
         // We found one. Reuse the data/control transferred already.
         const string& recv_node_name = iter->second.recv->name();
         if (edge->IsControlEdge()) {
@@ -1102,7 +1140,11 @@ Status Partition(const PartitionOptions& opts, Graph* g,
         VLOG(1) << "Send/Recv control: " << src->assigned_device_name() << "["
                 << src->name() << "] -> " << dst->assigned_device_name() << "["
                 << dst->name() << "]";
-        NodeDef* dummy = AddDummyConst(opts, src_graph, edge, &status);
+        NodeDef* dummy;
+        {
+          MaybeGraphLock l(sync, src_graph);
+          dummy = AddDummyConst(opts, src_graph, edge, &status);
+        }
         if (!status.ok()) return status;
         // Set the start time for this dummy node.
         if (opts.scheduling_for_recvs) {
@@ -1116,13 +1158,20 @@ Status Partition(const PartitionOptions& opts, Graph* g,
 
       // Need to split edge by placing matching send/recv nodes on
       // the src/dst sides of the edge.
-      NodeDef* send = AddSend(opts, g_info, src_graph, edge, send_from,
-                              send_start_time, &status);
+      NodeDef* send;
+      {
+        MaybeGraphLock l(sync, src_graph);
+        send = AddSend(opts, g_info, src_graph, edge, send_from,
+                       send_start_time, &status);
+      }
       if (!status.ok()) return status;
 
       NodeDef* real_recv = nullptr;
-      NodeDef* recv =
-          AddRecv(opts, g_info, dst_graph, edge, &real_recv, &status);
+      NodeDef* recv;
+      {
+        MaybeGraphLock l(sync, dst_graph);
+        recv = AddRecv(opts, g_info, dst_graph, edge, &real_recv, &status);
+      }
       if (!status.ok()) return status;
 
       // Fix up the control flow edge.
@@ -1153,15 +1202,15 @@ Status Partition(const PartitionOptions& opts, Graph* g,
         // Memorize the send/recv pair, only if this is not a "ref" edge.
         // NOTE(yuanbyu): Collapsing ref edges requires extreme care so
         // for now we don't do it.
-        dup_recv[key] = {recv, real_recv, recv_start_time};
+        (*dup_recv)[key] = {recv, real_recv, recv_start_time};
         ref_control_inputs.push_back(recv->name());
       }
 
       if (edge->IsControlEdge()) {
-        ++num_control;
+        ++(*num_control);
         AddInput(dst_def, recv->name(), Graph::kControlSlot);
       } else {
-        ++num_data;
+        ++(*num_data);
         AddInput(dst_def, recv->name(), 0);
       }
     }
@@ -1184,30 +1233,156 @@ Status Partition(const PartitionOptions& opts, Graph* g,
       }
     }
   }
+  return Status::OK();
+}
+
+// Fills in versions, the pruned function library and send/recv incarnations
+// for one finished partition.
+void FinalizePartition(const PartitionOptions& opts, const Graph& g,
+                       const FunctionLibraryDefinition& flib_def,
+                       GraphDef* gdef) {
+  *gdef->mutable_versions() = g.versions();
+  // Prune unreachable functions from `flib_def` before adding them to `gdef`.
+  *gdef->mutable_library() = flib_def.ReachableDefinitions(*gdef).ToProto();
+
+  // Traverse the graph to fill every send/recv op's incarnation
+  // information.
+  SetIncarnation(opts, gdef);
+}
+
+}  // namespace
+
+Status Partition(const PartitionOptions& opts, Graph* g,
+                 std::unordered_map<string, GraphDef>* partitions) {
+  Status status;
+  partitions->clear();
+
+  GraphInfo g_info;
+  if (!opts.control_flow_added) {
+    // Add the "code" for distributed execution of control flow. Code is
+    // added only for the frames that are placed on multiple devices. The
+    // new graph is an equivalent transformation of the original graph and
+    // has the property that it can be subsequently partitioned arbitrarily
+    // (down to the level of individual device) for distributed execution.
+    status = AddControlFlow(opts, g, &g_info);
+    if (!status.ok()) return status;
+  }
+
+  // At this point, all the graph mutations have been done. Build memory
+  // and device type info for every node and edge in the graph.
+  status = BuildMemoryDeviceInfo(*g, &g_info);
+  if (!status.ok()) return status;
+
+  // Group the op nodes by partition (in graph order), creating every
+  // partition up front so that the build phase never mutates the map itself.
+  std::vector<const Node*> op_nodes;
+  std::unordered_map<string, std::vector<const Node*>> nodes_by_partition;
+  for (const Node* dst : g->op_nodes()) {
+    op_nodes.push_back(dst);
+    nodes_by_partition[opts.node_to_loc(dst)].push_back(dst);
+  }
+  for (const auto& it : nodes_by_partition) {
+    (*partitions)[it.first];
+  }
+
+  int32 num_data = 0;
+  int32 num_control = 0;
+  // One dedup table per build task; their key spaces are disjoint since the
+  // keys involve the destination partition.
+  std::vector<DupRecvTable> dup_recv_tables;
+  const size_t num_partitions = nodes_by_partition.size();
+  if (num_partitions < kMinPartitionsForParallelBuild) {
+    // Serial: one pass over the graph, exactly as if partitions were built
+    // in place.
+    dup_recv_tables.emplace_back(3);
+    status = BuildPartitions(opts, g_info, op_nodes, nullptr, partitions,
+                             &dup_recv_tables[0], &num_data, &num_control);
+    if (!status.ok()) return status;
+  } else {
+    // Parallel: one task per destination partition.  Cut edges make a task
+    // append Send nodes to source partitions, guarded by per-partition locks
+    // in BuildPartitions(); the name generator is shared mutable state, so
+    // serialize it here.
+    mutex name_mu;
+    PartitionOptions parallel_opts = opts;
+    parallel_opts.new_name = [&opts, &name_mu](const string& prefix) {
+      mutex_lock l(name_mu);
+      return opts.new_name(prefix);
+    };
+    PartitionSync sync;
+    for (auto& it : *partitions) {
+      sync.graph_mu[&it.second].reset(new mutex);
+    }
+    const int num_threads = std::min<int>(
+        static_cast<int>(num_partitions), port::NumSchedulableCPUs());
+    thread::ThreadPool pool(Env::Default(), "graph_partition", num_threads);
+    std::vector<Status> statuses(num_partitions);
+    std::vector<int32> data_counts(num_partitions, 0);
+    std::vector<int32> control_counts(num_partitions, 0);
+    dup_recv_tables.resize(num_partitions);
+    BlockingCounter counter(num_partitions);
+    int i = 0;
+    for (const auto& it : nodes_by_partition) {
+      const std::vector<const Node*>* dst_nodes = &it.second;
+      Status* task_status = &statuses[i];
+      DupRecvTable* task_dup_recv = &dup_recv_tables[i];
+      int32* task_num_data = &data_counts[i];
+      int32* task_num_control = &control_counts[i];
+      ++i;
+      pool.Schedule([&parallel_opts, &g_info, &sync, partitions, dst_nodes,
+                     task_status, task_dup_recv, task_num_data,
+                     task_num_control, &counter]() {
+        *task_status = BuildPartitions(parallel_opts, g_info, *dst_nodes,
+                                       &sync, partitions, task_dup_recv,
+                                       task_num_data, task_num_control);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (size_t j = 0; j < num_partitions; ++j) {
+      TF_RETURN_IF_ERROR(statuses[j]);
+      num_data += data_counts[j];
+      num_control += control_counts[j];
+    }
+  }
 
   const FunctionLibraryDefinition* flib_def = opts.flib_def;
   if (flib_def == nullptr) {
     flib_def = &g->flib_def();
   }
 
-  // Set versions, function library and send/recv incarnation.
-  for (auto& it : *partitions) {
-    GraphDef* gdef = &it.second;
-    *gdef->mutable_versions() = g->versions();
-    // Prune unreachable functions from `flib_def` before adding them to `gdef`.
-    *gdef->mutable_library() = flib_def->ReachableDefinitions(*gdef).ToProto();
-
-    // Traverse the graph to fill every send/recv op's incarnation
-    // information.
-    SetIncarnation(opts, gdef);
+  // Set versions, function library and send/recv incarnation.  Partitions
+  // are finished independently; pruning a large function library per
+  // partition is the dominant cost here.
+  if (num_partitions < kMinPartitionsForParallelBuild) {
+    for (auto& it : *partitions) {
+      FinalizePartition(opts, *g, *flib_def, &it.second);
+    }
+  } else {
+    const int num_threads = std::min<int>(
+        static_cast<int>(num_partitions), port::NumSchedulableCPUs());
+    thread::ThreadPool pool(Env::Default(), "graph_partition_finalize",
+                            num_threads);
+    BlockingCounter counter(num_partitions);
+    for (auto& it : *partitions) {
+      GraphDef* gdef = &it.second;
+      pool.Schedule([&opts, g, flib_def, gdef, &counter]() {
+        FinalizePartition(opts, *g, *flib_def, gdef);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
   }
 
   // Set the start times for recvs at the very end.
   if (opts.scheduling_for_recvs) {
-    for (auto& it : dup_recv) {
-      AddNodeAttr("_start_time", it.second.start_time, it.second.recv);
-      if (it.second.real_recv != it.second.recv) {
-        AddNodeAttr("_start_time", it.second.start_time, it.second.real_recv);
+    for (const DupRecvTable& table : dup_recv_tables) {
+      for (auto& it : table) {
+        AddNodeAttr("_start_time", it.second.start_time, it.second.recv);
+        if (it.second.real_recv != it.second.recv) {
+          AddNodeAttr("_start_time", it.second.start_time,
+                      it.second.real_recv);
+        }
       }
     }
   }
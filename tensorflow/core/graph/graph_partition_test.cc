@@ -522,6 +522,32 @@ TEST_F(GraphPartitionTest, SetIncarnation) {
   }
 }
 
+TEST_F(GraphPartitionTest, ManyDeviceChain) {
+  // A chain across ten devices exercises the parallel partition build path.
+  Output prev = FloatInput(in_.WithOpName("A1"));
+  for (char c = 'B'; c <= 'J'; ++c) {
+    string name(1, c);
+    name += "1";
+    prev = Combine(in_.WithOpName(name), prev, prev);
+  }
+
+  Partition(ToGraphDef(), &partitions_);
+  EXPECT_EQ(10, partitions_.size());
+
+  int num_sends = 0;
+  int num_recvs = 0;
+  for (const auto& kv : partitions_) {
+    EXPECT_GE(kv.second.node_size(), 1);
+    for (const NodeDef& ndef : kv.second.node()) {
+      if (ndef.op() == "_Send") ++num_sends;
+      if (ndef.op() == "_Recv") ++num_recvs;
+    }
+  }
+  // One cut edge between each adjacent pair of devices in the chain.
+  EXPECT_EQ(9, num_sends);
+  EXPECT_EQ(9, num_recvs);
+}
+
 TEST(TopologicalSortNodesWithTimePriorityTest, NoDependencies) {
   // Create placeholders, shuffle them so the order in the graph is not strictly
   // increasing.
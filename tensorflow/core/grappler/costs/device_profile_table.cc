@@ -0,0 +1,173 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/device_profile_table.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/robust_stats.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+void DeviceProfileTable::AddStepStats(const GraphDef& graph,
+                                      const StepStats& step_stats) {
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::ParseFullName(dev_stats.device(), &parsed) ||
+        !parsed.has_type) {
+      // Skip pseudo devices, such as per-stream GPU stats.
+      continue;
+    }
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      auto it = name_to_node.find(node_stats.node_name());
+      if (it == name_to_node.end()) continue;
+
+      const int64 compute_micros =
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+      if (compute_micros <= 0) continue;
+
+      int64 output_bytes = 0;
+      for (const NodeOutput& output : node_stats.output()) {
+        const TensorDescription& tensor = output.tensor_description();
+        int64 num_elements = 1;
+        for (const auto& dim : tensor.shape().dim()) {
+          num_elements *= std::max<int64>(1, dim.size());
+        }
+        output_bytes += num_elements * DataTypeSize(BaseType(tensor.dtype()));
+      }
+
+      AddSample(ProfileKey(parsed.type, it->second->op(),
+                           OutputSizeBucket(output_bytes)),
+                compute_micros * 1000.0);
+    }
+  }
+}
+
+bool DeviceProfileTable::EstimateComputeTime(const OpContext& op_context,
+                                             int64* compute_time_ns) const {
+  const OpInfo& op_info = op_context.op_info;
+  if (op_info.device().type().empty()) return false;
+
+  int64 output_bytes = 0;
+  for (const auto& output : op_info.outputs()) {
+    output_bytes += CalculateTensorSize(output);
+  }
+
+  auto it = profiles_.find(ProfileKey(op_info.device().type(), op_info.op(),
+                                      OutputSizeBucket(output_bytes)));
+  if (it == profiles_.end()) return false;
+  *compute_time_ns = static_cast<int64>(it->second.compute_time_ns);
+  return true;
+}
+
+Status DeviceProfileTable::Save(Env* env, const string& filename) const {
+  return WriteTextProto(env, filename, ToProto());
+}
+
+Status DeviceProfileTable::Load(Env* env, const string& filename) {
+  MeasuredOpPerformanceList profile;
+  TF_RETURN_IF_ERROR(ReadTextProto(env, filename, &profile));
+  MergeFromProto(profile);
+  return Status::OK();
+}
+
+MeasuredOpPerformanceList DeviceProfileTable::ToProto() const {
+  std::vector<string> keys;
+  keys.reserve(profiles_.size());
+  for (const auto& profile : profiles_) {
+    keys.push_back(profile.first);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  MeasuredOpPerformanceList profile_list;
+  for (const string& key : keys) {
+    const Measurements& measurements = profiles_.at(key);
+    std::vector<string> parts = str_util::Split(key, ';');
+    DCHECK_EQ(parts.size(), 3);
+    int32 output_size_bucket = 0;
+    if (!strings::safe_strto32(parts[2], &output_size_bucket)) continue;
+
+    MeasuredOpPerformance* measurement = profile_list.add_measurement();
+    measurement->set_device_type(parts[0]);
+    measurement->set_op(parts[1]);
+    measurement->set_output_size_bucket(output_size_bucket);
+    measurement->set_compute_time_ns(
+        static_cast<int64>(measurements.compute_time_ns));
+    measurement->set_count(measurements.count);
+  }
+  return profile_list;
+}
+
+void DeviceProfileTable::MergeFromProto(
+    const MeasuredOpPerformanceList& profile) {
+  for (const MeasuredOpPerformance& measurement : profile.measurement()) {
+    const string key =
+        ProfileKey(measurement.device_type(), measurement.op(),
+                   measurement.output_size_bucket());
+    Measurements& measurements = profiles_[key];
+    if (static_cast<int>(measurements.samples.size()) < kMaxSamples) {
+      measurements.samples.push_back(measurement.compute_time_ns());
+      measurements.compute_time_ns = RobustStats(measurements.samples).mean();
+    }
+    measurements.count += measurement.count();
+  }
+}
+
+int64 DeviceProfileTable::num_measurements() const {
+  int64 num_measurements = 0;
+  for (const auto& profile : profiles_) {
+    num_measurements += profile.second.count;
+  }
+  return num_measurements;
+}
+
+void DeviceProfileTable::AddSample(const string& key, double compute_time_ns) {
+  Measurements& measurements = profiles_[key];
+  ++measurements.count;
+  if (static_cast<int>(measurements.samples.size()) < kMaxSamples) {
+    measurements.samples.push_back(compute_time_ns);
+    measurements.compute_time_ns = RobustStats(measurements.samples).mean();
+  }
+}
+
+string DeviceProfileTable::ProfileKey(const string& device_type,
+                                      const string& op,
+                                      int output_size_bucket) {
+  return strings::StrCat(device_type, ";", op, ";", output_size_bucket);
+}
+
+int DeviceProfileTable::OutputSizeBucket(int64 output_bytes) {
+  if (output_bytes <= 0) return 0;
+  return 1 + Log2Floor64(output_bytes);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_DEVICE_PROFILE_TABLE_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_DEVICE_PROFILE_TABLE_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A table of measured per-op execution times, keyed by device type, op type,
+// and a logarithmic bucket of the total output size. When a table is attached
+// to an OpLevelCostEstimator, measured timings take precedence over the
+// analytic roofline estimates, so VirtualScheduler-based scheduling and
+// memory decisions can be calibrated to observed hardware behavior.
+//
+// The table is not thread-safe: populate it (AddStepStats, Load) before
+// sharing it with cost estimators, which only read it.
+class DeviceProfileTable {
+ public:
+  // Aggregates the per-node timings recorded in `step_stats` (e.g. by a
+  // StepStatsCollector during a profiled session run) into the table. `graph`
+  // is used to resolve node names in the step stats to op types; nodes and
+  // devices that can't be resolved are ignored.
+  void AddStepStats(const GraphDef& graph, const StepStats& step_stats);
+
+  // Returns true and sets `compute_time_ns` to the measured compute time if
+  // the table has a measurement matching the given op context.
+  bool EstimateComputeTime(const OpContext& op_context,
+                           int64* compute_time_ns) const;
+
+  // Saves/restores the table in text format, so profiles can be reused
+  // across processes.
+  Status Save(Env* env, const string& filename) const;
+  Status Load(Env* env, const string& filename);
+
+  // Proto conversion. Measurements are emitted in deterministic (sorted key)
+  // order. Merging a serialized profile only restores the aggregates: each
+  // restored measurement participates in further aggregation as a single
+  // sample.
+  MeasuredOpPerformanceList ToProto() const;
+  void MergeFromProto(const MeasuredOpPerformanceList& profile);
+
+  // Total number of measurements aggregated into the table.
+  int64 num_measurements() const;
+
+ private:
+  struct Measurements {
+    // Up to kMaxSamples measured compute times, in nanoseconds.
+    std::vector<double> samples;
+    // Total number of measurements, including those dropped from `samples`.
+    int64 count = 0;
+    // Robust average of `samples`, in nanoseconds.
+    double compute_time_ns = 0.0;
+  };
+
+  // Number of samples kept per key for computing the robust average.
+  static const int kMaxSamples = 64;
+
+  void AddSample(const string& key, double compute_time_ns);
+
+  static string ProfileKey(const string& device_type, const string& op,
+                           int output_size_bucket);
+  static int OutputSizeBucket(int64 output_bytes);
+
+  std::unordered_map<string, Measurements> profiles_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_DEVICE_PROFILE_TABLE_H_
@@ -0,0 +1,132 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/device_profile_table.h"
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Builds a single node graph and matching step stats where the node takes
+// `compute_micros` and produces a float tensor of shape [2, 2].
+void BuildGraphAndStepStats(GraphDef* graph, StepStats* step_stats,
+                            int64 compute_micros) {
+  NodeDef* node = graph->add_node();
+  node->set_name("out");
+  node->set_op("MatMul");
+
+  DeviceStepStats* dev_stats = step_stats->add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name("out");
+  node_stats->set_op_start_rel_micros(10);
+  node_stats->set_op_end_rel_micros(10 + compute_micros);
+  TensorDescription* tensor =
+      node_stats->add_output()->mutable_tensor_description();
+  tensor->set_dtype(DT_FLOAT);
+  tensor->mutable_shape()->add_dim()->set_size(2);
+  tensor->mutable_shape()->add_dim()->set_size(2);
+}
+
+// Returns an OpContext that matches the node built above: same op type,
+// device type, and output size bucket.
+OpContext MatchingOpContext() {
+  OpContext op_context;
+  op_context.op_info.set_op("MatMul");
+  op_context.op_info.mutable_device()->set_type("CPU");
+  auto* output = op_context.op_info.add_outputs();
+  output->set_dtype(DT_FLOAT);
+  output->mutable_shape()->add_dim()->set_size(2);
+  output->mutable_shape()->add_dim()->set_size(2);
+  return op_context;
+}
+
+TEST(DeviceProfileTableTest, EstimateFromStepStats) {
+  GraphDef graph;
+  StepStats step_stats;
+  BuildGraphAndStepStats(&graph, &step_stats, /*compute_micros=*/3);
+
+  DeviceProfileTable profile_table;
+  profile_table.AddStepStats(graph, step_stats);
+  EXPECT_EQ(1, profile_table.num_measurements());
+
+  int64 compute_time_ns = 0;
+  EXPECT_TRUE(
+      profile_table.EstimateComputeTime(MatchingOpContext(), &compute_time_ns));
+  EXPECT_EQ(3000, compute_time_ns);
+}
+
+TEST(DeviceProfileTableTest, MissesFallThrough) {
+  GraphDef graph;
+  StepStats step_stats;
+  BuildGraphAndStepStats(&graph, &step_stats, /*compute_micros=*/3);
+
+  DeviceProfileTable profile_table;
+  profile_table.AddStepStats(graph, step_stats);
+
+  int64 compute_time_ns = 0;
+
+  // Different op type.
+  OpContext other_op = MatchingOpContext();
+  other_op.op_info.set_op("Conv2D");
+  EXPECT_FALSE(profile_table.EstimateComputeTime(other_op, &compute_time_ns));
+
+  // Different device type.
+  OpContext other_device = MatchingOpContext();
+  other_device.op_info.mutable_device()->set_type("GPU");
+  EXPECT_FALSE(
+      profile_table.EstimateComputeTime(other_device, &compute_time_ns));
+
+  // Different output size bucket.
+  OpContext other_size = MatchingOpContext();
+  other_size.op_info.mutable_outputs(0)->mutable_shape()->mutable_dim(0)->
+      set_size(1024);
+  EXPECT_FALSE(profile_table.EstimateComputeTime(other_size, &compute_time_ns));
+}
+
+TEST(DeviceProfileTableTest, SaveAndLoad) {
+  GraphDef graph;
+  StepStats step_stats;
+  BuildGraphAndStepStats(&graph, &step_stats, /*compute_micros=*/3);
+
+  DeviceProfileTable profile_table;
+  profile_table.AddStepStats(graph, step_stats);
+
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "device_profile.pbtxt");
+  TF_ASSERT_OK(profile_table.Save(Env::Default(), filename));
+
+  DeviceProfileTable restored_table;
+  TF_ASSERT_OK(restored_table.Load(Env::Default(), filename));
+  EXPECT_EQ(profile_table.num_measurements(),
+            restored_table.num_measurements());
+
+  int64 compute_time_ns = 0;
+  EXPECT_TRUE(restored_table.EstimateComputeTime(MatchingOpContext(),
+                                                 &compute_time_ns));
+  EXPECT_EQ(3000, compute_time_ns);
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -372,6 +372,20 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
   const auto& op_info = op_context.op_info;
+
+  // In calibration mode, prefer measured timings over analytic estimates.
+  if (profile_table_ != nullptr) {
+    int64 measured_time_ns = 0;
+    if (profile_table_->EstimateComputeTime(op_context, &measured_time_ns)) {
+      Costs costs = Costs::ZeroCosts();
+      costs.compute_time = Costs::Duration(measured_time_ns);
+      costs.execution_time = costs.compute_time;
+      VLOG(1) << "Operation " << op_info.op() << " measured to take "
+              << costs.execution_time.count() << " ns.";
+      return costs;
+    }
+  }
+
   auto it = device_cost_impl_.find(op_info.op());
   if (it != device_cost_impl_.end()) {
     std::function<Costs(const OpContext&)> estimator = it->second;
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_LEVEL_COST_ESTIMATOR_H_
 
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/device_profile_table.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/util/padding.h"
@@ -39,6 +40,14 @@ class OpLevelCostEstimator {
   // Returns basic device performance info.
   virtual DeviceInfo GetDeviceInfo(const DeviceProperties& device) const;
 
+  // Enables calibration mode: measured timings from `profile_table` take
+  // precedence over the analytic estimates, and ops without a matching
+  // measurement fall back to the analytic models. The table is not owned and
+  // must outlive this estimator; pass nullptr to disable calibration.
+  void set_device_profile_table(const DeviceProfileTable* profile_table) {
+    profile_table_ = profile_table;
+  }
+
  protected:
   // Predict cost of an op for which no accurate estimator is defined.
   Costs PredictCostOfAnUnknownOp(const OpContext& op_context) const;
@@ -195,6 +204,9 @@ class OpLevelCostEstimator {
   // compute_time and memory_time, insteaf of sum of those two.
   bool compute_memory_overlap_;
   std::set<string> persistent_ops_;
+  // Measured device profile consulted before the analytic models. May be
+  // null. Not owned.
+  const DeviceProfileTable* profile_table_ = nullptr;
 
  private:
   friend class OpLevelCostEstimatorTest;
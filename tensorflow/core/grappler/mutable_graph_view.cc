@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
@@ -438,10 +439,15 @@ NodeDef* MutableGraphView::AddNode(NodeDef&& node) {
   AddUniqueNodeOrDie(node_in_graph);
 
   AddAndDedupFanouts(node_in_graph);
+  TopoOrderAddNode(node_in_graph);
   return node_in_graph;
 }
 
 Status MutableGraphView::AddSubgraph(GraphDef&& subgraph) {
+  // Subgraph nodes can have edges between each other in arbitrary order, so
+  // incrementally repairing the topological order is not worthwhile here.
+  InvalidateTopologicalOrder();
+
   // 1. Add all new functions and check that functions with the same name
   // have identical definition.
   const int function_size = subgraph.library().function_size();
@@ -614,6 +620,10 @@ Status MutableGraphView::SwapNodeNames(absl::string_view from_node_name,
     nodes().emplace(to_node->name(), to_node);
   };
 
+  // Swapping names rewires edges between the two nodes wholesale; fall back
+  // to a full re-sort of the cached topological order.
+  InvalidateTopologicalOrder();
+
   if (update_fanouts) {
     SwapFanoutInputs(*this, &fanouts(), &max_regular_output_port(), from_node,
                      to_node);
@@ -819,6 +829,7 @@ Status MutableGraphView::UpdateFanoutsInternal(NodeDef* from_node,
     remove_edge(output_port, input_port);
     // Add an edge between the `to_node` and new fanout node.
     add_edge(OutputPort(to_node, output_port.port_id), input_port);
+    TopoOrderAddEdge(to_node, input_port.node);
     // Dedup control dependency.
     if (CanDedupControlWithRegularInput(*this, *to_node)) {
       RemoveControllingFaninInternal(input_port.node, to_node);
@@ -872,6 +883,7 @@ bool MutableGraphView::AddFaninInternal(NodeDef* node,
   }
 
   fanouts()[fanin].insert(input);
+  TopoOrderAddEdge(fanin.node, node);
   if (max_regular_output_port()[fanin.node] < fanin.port_id) {
     max_regular_output_port()[fanin.node] = fanin.port_id;
   }
@@ -1312,6 +1324,7 @@ Status MutableGraphView::UpdateFanin(absl::string_view node_name,
 
   // Dedup control dependencies and update max regular output ports.
   if (modified) {
+    TopoOrderAddEdge(to_fanin_node, node);
     UpdateMaxRegularOutputPortForRemovedFanin(
         {from_fanin_node, from_fanin.index()}, *from_fanin_port_fanouts);
     if (max_regular_output_port()[to_fanin_node] < to_fanin.index()) {
@@ -1358,6 +1371,7 @@ Status MutableGraphView::UpdateRegularFaninByPort(absl::string_view node_name,
 
   OutputPort to_fanin_port(fanin_node, fanin.index());
   fanouts()[to_fanin_port].insert(input);
+  TopoOrderAddEdge(fanin_node, node);
   UpdateMaxRegularOutputPortForAddedFanin(to_fanin_port);
 
   node->set_input(port, TensorIdToString(fanin));
@@ -1463,6 +1477,7 @@ Status MutableGraphView::UpdateAllRegularFaninsToControlling(
     controls.insert(control->name());
     node->set_input(pos, AsControlDependency(control->name()));
     fanouts()[{control, Graph::kControlSlot}].insert(input_port);
+    TopoOrderAddEdge(control, node);
     ++pos;
   }
 
@@ -1557,6 +1572,7 @@ Status MutableGraphView::DeleteNodes(
     if (node != nullptr) {
       RemoveFaninsInternal(node, /*keep_controlling_fanins=*/false);
       RemoveFanoutsInternal(node);
+      TopoOrderRemoveNode(node);
     }
   }
   for (const string& node_name_to_delete : nodes_to_delete) {
@@ -1585,6 +1601,23 @@ Status MutableGraphView::DeleteNodes(
   return Status::OK();
 }
 
+Status MutableGraphView::GetTopologicalOrder(
+    std::vector<const NodeDef*>* topo_order) {
+  if (!topo_order_valid_) {
+    TF_RETURN_IF_ERROR(RecomputeTopologicalOrder());
+  } else if (topo_num_deleted_ * 2 > static_cast<int>(topo_order_.size())) {
+    CompactTopologicalOrder();
+  }
+  topo_order->clear();
+  topo_order->reserve(topo_order_.size() - topo_num_deleted_);
+  for (NodeDef* node : topo_order_) {
+    if (node != nullptr) {
+      topo_order->push_back(node);
+    }
+  }
+  return Status::OK();
+}
+
 void MutableGraphView::RemoveFaninsInternal(NodeDef* deleted_node,
                                             bool keep_controlling_fanins) {
   for (int i = 0; i < deleted_node->input_size(); ++i) {
@@ -1618,5 +1651,160 @@ void MutableGraphView::RemoveFanoutsInternal(NodeDef* deleted_node) {
   max_regular_output_port().erase(deleted_node);
 }
 
+void MutableGraphView::TopoOrderAddNode(NodeDef* node) {
+  if (!topo_order_valid_) {
+    return;
+  }
+  topo_index_.emplace(node, topo_order_.size());
+  topo_order_.push_back(node);
+}
+
+void MutableGraphView::TopoOrderAddEdge(NodeDef* from_node, NodeDef* to_node) {
+  if (!topo_order_valid_) {
+    return;
+  }
+  auto from_it = topo_index_.find(from_node);
+  auto to_it = topo_index_.find(to_node);
+  if (from_it == topo_index_.end() || to_it == topo_index_.end()) {
+    InvalidateTopologicalOrder();
+    return;
+  }
+  const int lower_bound = to_it->second;
+  const int upper_bound = from_it->second;
+  if (upper_bound < lower_bound) {
+    // The new edge does not violate the current order.
+    return;
+  }
+
+  // Pearce-Kelly: only nodes currently positioned in
+  // [lower_bound, upper_bound] can be affected by the new edge. Find the
+  // nodes reachable from `to_node` (delta_forward) and the nodes reaching
+  // `from_node` (delta_backward) within that window; all other nodes keep
+  // their positions.
+  std::vector<NodeDef*> delta_forward;
+  absl::flat_hash_set<const NodeDef*> visited;
+  std::vector<NodeDef*> stack = {to_node};
+  visited.insert(to_node);
+  while (!stack.empty()) {
+    NodeDef* node = stack.back();
+    stack.pop_back();
+    if (node == from_node) {
+      // `from_node` is reachable from `to_node`, so the new edge creates a
+      // cycle and no valid order exists. Let the next GetTopologicalOrder
+      // call report the error from the full sort.
+      InvalidateTopologicalOrder();
+      return;
+    }
+    delta_forward.push_back(node);
+    for (const InputPort& fanout :
+         GetFanouts(*node, /*include_controlled_nodes=*/true)) {
+      auto fanout_it = topo_index_.find(fanout.node);
+      if (fanout_it != topo_index_.end() && fanout_it->second <= upper_bound &&
+          visited.insert(fanout.node).second) {
+        stack.push_back(fanout.node);
+      }
+    }
+  }
+
+  std::vector<NodeDef*> delta_backward;
+  visited.clear();
+  stack.push_back(from_node);
+  visited.insert(from_node);
+  while (!stack.empty()) {
+    NodeDef* node = stack.back();
+    stack.pop_back();
+    delta_backward.push_back(node);
+    for (const OutputPort& fanin :
+         GetFanins(*node, /*include_controlling_nodes=*/true)) {
+      auto fanin_it = topo_index_.find(fanin.node);
+      if (fanin_it != topo_index_.end() && fanin_it->second >= lower_bound &&
+          visited.insert(fanin.node).second) {
+        stack.push_back(fanin.node);
+      }
+    }
+  }
+
+  // Reassign the union of the affected positions, placing the nodes that must
+  // precede the edge's tail before the nodes reachable from its head, with
+  // each group keeping its current relative order.
+  auto by_position = [this](const NodeDef* a, const NodeDef* b) {
+    return topo_index_.at(a) < topo_index_.at(b);
+  };
+  std::sort(delta_backward.begin(), delta_backward.end(), by_position);
+  std::sort(delta_forward.begin(), delta_forward.end(), by_position);
+  std::vector<int> positions;
+  positions.reserve(delta_backward.size() + delta_forward.size());
+  for (const NodeDef* node : delta_backward) {
+    positions.push_back(topo_index_.at(node));
+  }
+  for (const NodeDef* node : delta_forward) {
+    positions.push_back(topo_index_.at(node));
+  }
+  std::sort(positions.begin(), positions.end());
+  int pos = 0;
+  for (NodeDef* node : delta_backward) {
+    topo_order_[positions[pos]] = node;
+    topo_index_[node] = positions[pos];
+    ++pos;
+  }
+  for (NodeDef* node : delta_forward) {
+    topo_order_[positions[pos]] = node;
+    topo_index_[node] = positions[pos];
+    ++pos;
+  }
+}
+
+void MutableGraphView::TopoOrderRemoveNode(const NodeDef* node) {
+  if (!topo_order_valid_) {
+    return;
+  }
+  auto it = topo_index_.find(node);
+  if (it == topo_index_.end()) {
+    return;
+  }
+  // Removing a node (and its edges) can never reorder the remaining nodes, so
+  // leave a tombstone and compact lazily.
+  topo_order_[it->second] = nullptr;
+  topo_index_.erase(it);
+  ++topo_num_deleted_;
+}
+
+void MutableGraphView::InvalidateTopologicalOrder() {
+  topo_order_valid_ = false;
+  topo_order_.clear();
+  topo_index_.clear();
+  topo_num_deleted_ = 0;
+}
+
+Status MutableGraphView::RecomputeTopologicalOrder() {
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(*graph(), &topo_order));
+  topo_order_.clear();
+  topo_order_.reserve(topo_order.size());
+  topo_index_.clear();
+  topo_index_.reserve(topo_order.size());
+  for (const NodeDef* node : topo_order) {
+    topo_index_.emplace(node, topo_order_.size());
+    topo_order_.push_back(const_cast<NodeDef*>(node));
+  }
+  topo_num_deleted_ = 0;
+  topo_order_valid_ = true;
+  return Status::OK();
+}
+
+void MutableGraphView::CompactTopologicalOrder() {
+  int pos = 0;
+  for (NodeDef* node : topo_order_) {
+    if (node == nullptr) {
+      continue;
+    }
+    topo_order_[pos] = node;
+    topo_index_[node] = pos;
+    ++pos;
+  }
+  topo_order_.resize(pos);
+  topo_num_deleted_ = 0;
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <set>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -248,6 +250,17 @@ class MutableGraphView : public internal::GraphViewInternal<GraphDef, NodeDef> {
   // that can't be found are ignored.
   Status DeleteNodes(const absl::flat_hash_set<string>& nodes_to_delete);
 
+  // Populates `topo_order` with all nodes of the graph in topological order
+  // (every node appears after all of its fanins). The order is maintained
+  // incrementally across mutations: adding a node or removing fanins is O(1),
+  // and adding a fanin only re-sorts the region of the order between the two
+  // endpoints of the new edge (Pearce-Kelly), so repeated calls interleaved
+  // with edits do not re-sort the whole graph. Mutations that restructure the
+  // graph wholesale (AddSubgraph, SwapNodeNames) fall back to a full re-sort
+  // on the next call. If the graph contains a cycle, an error will be
+  // returned and `topo_order` will be left in an undefined state.
+  Status GetTopologicalOrder(std::vector<const NodeDef*>* topo_order);
+
  private:
   // Adds fanouts for fanins of node to graph, while deduping control
   // dependencies from existing control dependencies and regular fanins. Note,
@@ -323,6 +336,42 @@ class MutableGraphView : public internal::GraphViewInternal<GraphDef, NodeDef> {
 
   // Removes fanouts of the deleted node from internal state.
   void RemoveFanoutsInternal(NodeDef* deleted_node);
+
+  // Appends a newly added node to the cached topological order. As the node
+  // has no fanouts yet and all of its fanins precede it, the order stays
+  // valid. No-op if the cached order is already invalid.
+  void TopoOrderAddNode(NodeDef* node);
+
+  // Repairs the cached topological order after adding edge `from_node` ->
+  // `to_node`, by re-sorting only the nodes positioned between the two
+  // endpoints (Pearce-Kelly). If the edge introduces a cycle, the cached
+  // order is invalidated so the next GetTopologicalOrder call can report the
+  // error. No-op if the cached order is already invalid or the edge does not
+  // violate it.
+  void TopoOrderAddEdge(NodeDef* from_node, NodeDef* to_node);
+
+  // Removes a deleted node from the cached topological order by leaving a
+  // tombstone, compacted lazily. Removals never invalidate the relative order
+  // of the remaining nodes. No-op if the cached order is already invalid.
+  void TopoOrderRemoveNode(const NodeDef* node);
+
+  // Drops the cached topological order, forcing a full re-sort on the next
+  // GetTopologicalOrder call.
+  void InvalidateTopologicalOrder();
+
+  // Recomputes the cached topological order from scratch.
+  Status RecomputeTopologicalOrder();
+
+  // Removes tombstones of deleted nodes from topo_order_.
+  void CompactTopologicalOrder();
+
+  // Cached topological order of the graph, with nullptr tombstones for
+  // deleted nodes, and the position of each live node in it. Only meaningful
+  // while topo_order_valid_ is true.
+  std::vector<NodeDef*> topo_order_;
+  absl::flat_hash_map<const NodeDef*, int> topo_index_;
+  bool topo_order_valid_ = false;
+  int topo_num_deleted_ = 0;
 };
 
 }  // end namespace grappler
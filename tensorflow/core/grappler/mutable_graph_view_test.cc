@@ -2996,6 +2996,72 @@ TEST(MutableGraphViewTest, DeleteNodesWithLargeError) {
   CheckGraph(graph);
 }
 
+void CheckTopologicalOrder(MutableGraphView* graph) {
+  std::vector<const NodeDef*> topo_order;
+  TF_ASSERT_OK(graph->GetTopologicalOrder(&topo_order));
+  ASSERT_EQ(topo_order.size(), graph->graph()->node_size());
+  absl::flat_hash_map<const NodeDef*, int> topo_index;
+  for (int i = 0; i < topo_order.size(); ++i) {
+    topo_index.emplace(topo_order[i], i);
+  }
+  for (const NodeDef* node : topo_order) {
+    for (const auto& fanin :
+         graph->GetFanins(*node, /*include_controlling_nodes=*/true)) {
+      EXPECT_LT(topo_index[fanin.node], topo_index[node])
+          << "node '" << node->name() << "' precedes its fanin '"
+          << fanin.node->name() << "'";
+    }
+  }
+}
+
+TEST(MutableGraphViewTest, GetTopologicalOrder) {
+  GraphDef graph_def = SimpleDeleteNodeGraph();
+
+  MutableGraphView graph(&graph_def);
+  CheckTopologicalOrder(&graph);
+}
+
+TEST(MutableGraphViewTest, GetTopologicalOrderAfterMutations) {
+  GraphDef graph_def = SimpleDeleteNodeGraph();
+
+  MutableGraphView graph(&graph_def);
+  CheckTopologicalOrder(&graph);
+
+  // Appending a node with existing fanins keeps the order valid.
+  graph.AddNode(NDef("g", "NotImportant", {"f"}, {}));
+  CheckTopologicalOrder(&graph);
+
+  // Adding a fanin from the last node of the order to the first forces a
+  // local re-sort of the cached order.
+  TF_EXPECT_OK(graph.AddRegularFanin("a", {"g", 0}));
+  CheckTopologicalOrder(&graph);
+
+  TF_EXPECT_OK(graph.AddControllingFanin("c", {"d", Graph::kControlSlot}));
+  CheckTopologicalOrder(&graph);
+
+  TF_EXPECT_OK(graph.UpdateFanin("c", {"a", 5}, {"e", 0}));
+  CheckTopologicalOrder(&graph);
+
+  TF_EXPECT_OK(graph.DeleteNodes({"c"}));
+  CheckTopologicalOrder(&graph);
+}
+
+TEST(MutableGraphViewTest, GetTopologicalOrderWithCycle) {
+  GraphDef graph_def = test::function::GDef(
+      {NDef("a", "NotImportant", {}, {}), NDef("b", "NotImportant", {"a"}),
+       NDef("c", "NotImportant", {"b"})},
+      /*funcs=*/{});
+
+  MutableGraphView graph(&graph_def);
+  CheckTopologicalOrder(&graph);
+
+  // Adding an edge from 'c' to 'a' creates a cycle, so there is no valid
+  // topological order to maintain.
+  TF_EXPECT_OK(graph.AddRegularFanin("a", {"c", 0}));
+  std::vector<const NodeDef*> topo_order;
+  EXPECT_FALSE(graph.GetTopologicalOrder(&topo_order).ok());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -0,0 +1,155 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/buffer_reuse_planner.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/gtl/flat_set.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Elementwise ops whose kernels obtain their output buffer through
+// forward_input_or_allocate_output, i.e. run in place whenever the input
+// buffer is exclusively owned at execution time.  The binary ops forward
+// only when the output shape matches the forwarded operand; the kernel
+// checks that at run time, so listing them here is safe.
+bool IsInPlaceElementwise(const NodeDef& node) {
+  static const gtl::FlatSet<string>* const kOps = new gtl::FlatSet<string>{
+      // Unary cwise.
+      "Abs", "Ceil", "Cos", "Elu", "Erf", "Erfc", "Exp", "Expm1", "Floor",
+      "Inv", "Lgamma", "Log", "Log1p", "Neg", "Reciprocal", "Relu", "Relu6",
+      "Rint", "Round", "Rsqrt", "Selu", "Sigmoid", "Sign", "Sin", "Softplus",
+      "Softsign", "Sqrt", "Square", "Tan", "Tanh",
+      // Binary cwise.
+      "Add", "AddV2", "Div", "Maximum", "Minimum", "Mul", "RealDiv",
+      "SquaredDifference", "Sub",
+  };
+  return kOps->count(node.op()) > 0;
+}
+
+}  // namespace
+
+Status BufferReusePlanner::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* output) {
+  *output = item.graph;
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(*output, &topo_order));
+  std::unordered_map<string, int> topo_index;
+  for (int i = 0; i < static_cast<int>(topo_order.size()); ++i) {
+    topo_index[topo_order[i]->name()] = i;
+  }
+
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  NodeMap node_map(output);
+
+  int num_planned = 0;
+  for (const NodeDef* producer : topo_order) {
+    if (ModifiesFrameInfo(*producer)) continue;
+    // A fetched tensor stays referenced until the step ends, so no
+    // consumer could ever take its buffer over.
+    if (nodes_to_preserve.count(producer->name()) > 0) continue;
+
+    // Group the producer's data consumers by output port.  A consumer
+    // taking the same tensor through several inputs is recorded once per
+    // use; it holds that many references and can never forward.
+    std::unordered_map<int, std::unordered_map<NodeDef*, int>> uses_by_port;
+    for (NodeDef* consumer : node_map.GetOutputs(producer->name())) {
+      for (const string& input : consumer->input()) {
+        int port;
+        if (ParseNodeName(input, &port) == producer->name() && port >= 0) {
+          ++uses_by_port[port][consumer];
+        }
+      }
+    }
+
+    for (auto& port_and_uses : uses_by_port) {
+      std::unordered_map<NodeDef*, int>& uses = port_and_uses.second;
+      // A tensor with a single consumer is already forwarded at run time.
+      if (uses.size() < 2) continue;
+
+      // The receiver must come last in the fixed topological order so the
+      // serializing edges all point forward in that order; picking any
+      // other consumer could create a cycle.
+      NodeDef* receiver = nullptr;
+      int receiver_index = -1;
+      for (const auto& use : uses) {
+        const int index = topo_index[use.first->name()];
+        if (index > receiver_index) {
+          receiver_index = index;
+          receiver = use.first;
+        }
+      }
+      if (!IsInPlaceElementwise(*receiver)) continue;
+      if (uses[receiver] != 1) continue;
+      if (ModifiesFrameInfo(*receiver)) continue;
+      if (nodes_to_preserve.count(receiver->name()) > 0) continue;
+
+      bool consumers_ok = true;
+      for (const auto& use : uses) {
+        NodeDef* other = use.first;
+        if (other == receiver) continue;
+        // Frame-modifying consumers would put the serializing edge across
+        // frames, and cross-device edges would buy the reuse with a
+        // device synchronization; skip both.
+        if (ModifiesFrameInfo(*other) ||
+            other->device() != receiver->device()) {
+          consumers_ok = false;
+          break;
+        }
+      }
+      if (!consumers_ok) continue;
+
+      std::unordered_set<string> existing_inputs(receiver->input().begin(),
+                                                 receiver->input().end());
+      for (const auto& use : uses) {
+        NodeDef* other = use.first;
+        if (other == receiver) continue;
+        const string control_input = AsControlDependency(other->name());
+        if (existing_inputs.count(control_input) > 0) continue;
+        receiver->add_input(control_input);
+        node_map.AddOutput(other->name(), receiver->name());
+      }
+      ++num_planned;
+    }
+  }
+
+  VLOG(1) << "Planned in-place buffer reuse for " << num_planned
+          << " multi-consumer tensors.";
+  return Status::OK();
+}
+
+void BufferReusePlanner::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimize_output,
+                                  double result) {
+  // Nothing to do for BufferReusePlanner.
+}
+
+REGISTER_GRAPH_OPTIMIZER(BufferReusePlanner);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
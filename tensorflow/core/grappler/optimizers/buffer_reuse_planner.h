@@ -0,0 +1,66 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_BUFFER_REUSE_PLANNER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_BUFFER_REUSE_PLANNER_H_
+
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Plans in-place execution for elementwise chains.
+//
+// Elementwise kernels obtain their output buffer through
+// forward_input_or_allocate_output, which reuses the input buffer only if
+// it is exclusively owned when the kernel runs.  That proof already
+// succeeds for single-consumer tensors, but a tensor with several
+// consumers is referenced by every consumer's pending input entry, so
+// none of them can run in place and each allocates a fresh buffer.
+//
+// This pass picks, for each multi-consumer tensor, an elementwise
+// consumer that can take the buffer over and adds control dependencies
+// from the remaining consumers to it.  The chosen consumer then runs
+// after the others have finished and released their references, so the
+// executor's existing refcount check proves exclusive ownership and the
+// kernel reuses the buffer in place.  Receivers are always chosen
+// consistently with one topological order of the input graph, so the
+// added edges cannot introduce cycles.
+//
+// Registered as a custom graph optimizer; enable it by adding
+// "BufferReusePlanner" to the custom optimizers in RewriterConfig.
+class BufferReusePlanner : public CustomGraphOptimizer {
+ public:
+  BufferReusePlanner() {}
+  ~BufferReusePlanner() override {}
+
+  string name() const override { return "buffer_reuse_planner"; };
+
+  Status Init(const tensorflow::RewriterConfig_CustomGraphOptimizer* config =
+                  nullptr) override {
+    return Status::OK();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_BUFFER_REUSE_PLANNER_H_
@@ -0,0 +1,252 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/cpu_layout_optimizer.h"
+
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr char kDataFormat[] = "data_format";
+// Suffixes for the nodes created by this optimizer. The rewritten compute
+// node gets the kNHWCNodeSuffix; the transpose back to NCHW takes over the
+// original node name, so consumers outside the rewritten region are left
+// untouched.
+constexpr char kNHWCNodeSuffix[] = "-NHWC";
+constexpr char kInputTransposeSuffix[] = "-TransposeNCHWToNHWC";
+constexpr char kPermToNHWCSuffix[] = "-PermNCHWToNHWC";
+constexpr char kPermToNCHWSuffix[] = "-PermNHWCToNCHW";
+
+// Ops with a 'data_format' attribute whose non-MKL CPU kernels only implement
+// (or strongly prefer) the NHWC layout. Only input port 0 carries the
+// formatted tensor for all of these; the remaining inputs are filters or
+// 1-D per-channel vectors that are layout independent.
+bool IsRewritableLayoutSensitiveOp(const NodeDef& node) {
+  static const std::unordered_set<string>* ops = new std::unordered_set<string>{
+      "AvgPool",   "BiasAdd",        "Conv2D",           "DepthwiseConv2dNative",
+      "FusedBatchNorm", "FusedBatchNormV2", "MaxPool",
+  };
+  return ops->count(node.op()) > 0;
+}
+
+// Unary elementwise ops that commute with a layout change of their input, so
+// a transpose can be hoisted through them.
+bool IsLayoutAgnosticUnaryOp(const NodeDef& node) {
+  static const std::unordered_set<string>* ops = new std::unordered_set<string>{
+      "Abs",  "Ceil",       "Elu",   "Exp",     "Floor", "Identity",
+      "Log",  "Neg",        "Relu",  "Relu6",   "Rsqrt", "Sigmoid",
+      "Sqrt", "Square",     "Tanh",
+  };
+  return ops->count(node.op()) > 0;
+}
+
+// Permutes a 4 element list attribute (strides, ksize, dilations) from NCHW
+// to NHWC order.
+void PermuteNCHWToNHWC(AttrValue* attr) {
+  auto* list = attr->mutable_list();
+  if (list->i_size() != 4) return;
+  const int64 n = list->i(0);
+  const int64 c = list->i(1);
+  const int64 h = list->i(2);
+  const int64 w = list->i(3);
+  list->set_i(0, n);
+  list->set_i(1, h);
+  list->set_i(2, w);
+  list->set_i(3, c);
+}
+
+NodeDef* AddPermConstNode(const string& name, const std::vector<int32>& perm,
+                          const string& device, GraphDef* graph,
+                          NodeMap* node_map) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  (*node->mutable_attr())["dtype"].set_type(DT_INT32);
+  Tensor perm_tensor(DT_INT32, {4});
+  for (int i = 0; i < 4; ++i) {
+    perm_tensor.flat<int32>()(i) = perm[i];
+  }
+  perm_tensor.AsProtoTensorContent(
+      (*node->mutable_attr())["value"].mutable_tensor());
+  node_map->AddNode(name, node);
+  return node;
+}
+
+NodeDef* AddTransposeNode(const string& name, const string& input,
+                          const string& perm, const AttrValue& dtype,
+                          const string& device, GraphDef* graph,
+                          NodeMap* node_map) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Transpose");
+  node->set_device(device);
+  *node->add_input() = input;
+  *node->add_input() = perm;
+  (*node->mutable_attr())["T"] = dtype;
+  (*node->mutable_attr())["Tperm"].set_type(DT_INT32);
+  node_map->AddNode(name, node);
+  return node;
+}
+
+}  // namespace
+
+Status CpuLayoutOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* output) {
+  *output = item.graph;
+  NodeMap node_map(output);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  // Collect the nodes to rewrite before mutating the graph. Nodes without an
+  // assigned device are skipped: they may still end up on a GPU, where NCHW
+  // is the preferred layout.
+  std::vector<NodeDef*> nodes_to_rewrite;
+  for (int i = 0; i < output->node_size(); ++i) {
+    NodeDef* node = output->mutable_node(i);
+    if (!IsRewritableLayoutSensitiveOp(*node)) continue;
+    if (!NodeIsOnCpu(node)) continue;
+    const auto& attr = node->attr();
+    if (attr.count(kDataFormat) == 0 || attr.at(kDataFormat).s() != "NCHW")
+      continue;
+    if (node_map.NodeExists(strings::StrCat(node->name(), kNHWCNodeSuffix))) {
+      VLOG(1) << "Skipping " << node->name() << ": name collision";
+      continue;
+    }
+    nodes_to_rewrite.push_back(node);
+  }
+  if (nodes_to_rewrite.empty()) return Status::OK();
+
+  // Rewrite each node to NHWC, wrapped into a pair of layout conversions. The
+  // transpose back to NCHW takes over the original node name, so data and
+  // control consumers are rewired implicitly; only consumers of secondary
+  // outputs (e.g. FusedBatchNorm statistics, which are layout independent
+  // vectors) have to be pointed at the renamed compute node.
+  std::unordered_set<string> input_transposes;
+  std::unordered_set<string> output_transposes;
+  for (NodeDef* node : nodes_to_rewrite) {
+    const string original_name = node->name();
+    const string nhwc_name = strings::StrCat(original_name, kNHWCNodeSuffix);
+    const string& device = node->device();
+    const AttrValue& dtype = node->attr().at("T");
+
+    NodeDef* perm_to_nhwc = AddPermConstNode(
+        strings::StrCat(original_name, kPermToNHWCSuffix), {0, 2, 3, 1}, device,
+        output, &node_map);
+    NodeDef* perm_to_nchw = AddPermConstNode(
+        strings::StrCat(original_name, kPermToNCHWSuffix), {0, 3, 1, 2}, device,
+        output, &node_map);
+
+    NodeDef* input_transpose = AddTransposeNode(
+        strings::StrCat(original_name, kInputTransposeSuffix), node->input(0),
+        perm_to_nhwc->name(), dtype, device, output, &node_map);
+    input_transposes.insert(input_transpose->name());
+
+    // Rewire consumers of secondary outputs before renaming the node.
+    for (NodeDef* consumer : node_map.GetOutputs(original_name)) {
+      for (string& input : *consumer->mutable_input()) {
+        int position;
+        if (ParseNodeName(input, &position) == original_name && position > 0) {
+          input = strings::StrCat(nhwc_name, ":", position);
+        }
+      }
+    }
+
+    node->set_name(nhwc_name);
+    node->set_input(0, input_transpose->name());
+    auto* attr = node->mutable_attr();
+    (*attr)[kDataFormat].set_s("NHWC");
+    for (const char* list_attr : {"strides", "ksize", "dilations"}) {
+      if (attr->count(list_attr) > 0) PermuteNCHWToNHWC(&(*attr)[list_attr]);
+    }
+    node_map.RemoveNode(original_name);
+    node_map.AddNode(nhwc_name, node);
+
+    NodeDef* output_transpose =
+        AddTransposeNode(original_name, nhwc_name, perm_to_nchw->name(), dtype,
+                         device, output, &node_map);
+    output_transposes.insert(output_transpose->name());
+  }
+
+  // Hoist the NCHW->NHWC input conversions up through layout-agnostic
+  // elementwise chains. When a conversion reaches the inverse conversion
+  // created for an upstream rewritten node the pair cancels, which leaves
+  // transposes only at the boundaries of each connected NHWC region.
+  NodeMap rewritten_node_map(output);
+  for (const string& transpose_name : input_transposes) {
+    NodeDef* input_transpose = rewritten_node_map.GetNode(transpose_name);
+
+    std::vector<NodeDef*> chain;
+    NodeDef* source =
+        rewritten_node_map.GetNode(NodeName(input_transpose->input(0)));
+    while (source != nullptr && IsLayoutAgnosticUnaryOp(*source) &&
+           rewritten_node_map.GetOutputs(source->name()).size() == 1 &&
+           nodes_to_preserve.count(source->name()) == 0) {
+      chain.push_back(source);
+      source = rewritten_node_map.GetNode(NodeName(source->input(0)));
+    }
+    if (source == nullptr || output_transposes.count(source->name()) == 0) {
+      continue;
+    }
+
+    // "source" converts an NHWC region output back to NCHW, and every node on
+    // the chain is elementwise, so the whole chain can consume the NHWC
+    // tensor directly and both conversions can be bypassed.
+    const string& nhwc_tensor = source->input(0);
+    const string new_input = chain.empty() ? nhwc_tensor : chain.front()->name();
+    if (!chain.empty()) {
+      NodeDef* top = chain.back();
+      rewritten_node_map.UpdateInput(top->name(), top->input(0), nhwc_tensor);
+      top->set_input(0, nhwc_tensor);
+    }
+    const std::set<NodeDef*> consumers =
+        rewritten_node_map.GetOutputs(transpose_name);
+    for (NodeDef* consumer : consumers) {
+      for (string& input : *consumer->mutable_input()) {
+        if (NodeName(input) == transpose_name) {
+          input = new_input;
+        }
+      }
+      rewritten_node_map.UpdateInput(consumer->name(), transpose_name,
+                                     new_input);
+    }
+    // The bypassed transposes become dead and are cleaned up by the pruner.
+  }
+
+  return Status::OK();
+}
+
+void CpuLayoutOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimize_output,
+                                  double result) {
+  // Nothing to do for CpuLayoutOptimizer.
+}
+
+REGISTER_GRAPH_OPTIMIZER(CpuLayoutOptimizer);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
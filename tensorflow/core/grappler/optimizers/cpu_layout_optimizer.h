@@ -0,0 +1,56 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CPU_LAYOUT_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CPU_LAYOUT_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Rewrites NCHW-annotated nodes placed on CPU to the NHWC layout that the
+// non-MKL CPU kernels implement natively. Layout conversions are inserted
+// around each rewritten node and then hoisted through layout-agnostic
+// elementwise chains, so inside a connected region of rewritten nodes the
+// inverse conversion pairs cancel and transposes remain only at region
+// boundaries.
+//
+// This is the CPU counterpart of the GPU-oriented LayoutOptimizer. It is
+// registered as a custom graph optimizer and can be enabled by adding
+// "CpuLayoutOptimizer" to the custom optimizers in RewriterConfig.
+class CpuLayoutOptimizer : public CustomGraphOptimizer {
+ public:
+  CpuLayoutOptimizer() {}
+  ~CpuLayoutOptimizer() override {}
+
+  string name() const override { return "cpu_layout_optimizer"; };
+
+  Status Init(const tensorflow::RewriterConfig_CustomGraphOptimizer* config =
+                  nullptr) override {
+    return Status::OK();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CPU_LAYOUT_OPTIMIZER_H_
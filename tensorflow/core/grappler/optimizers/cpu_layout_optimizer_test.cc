@@ -0,0 +1,140 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/cpu_layout_optimizer.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class CpuLayoutOptimizerTest : public GrapplerTest {};
+
+TEST_F(CpuLayoutOptimizerTest, RewritesConnectedRegionToNHWC) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({2, 3, 4, 5});
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT, input_shape);
+  auto bias1 = Placeholder(s.WithOpName("bias1"), DT_FLOAT,
+                           ops::Placeholder::Shape({3}));
+  auto bias2 = Placeholder(s.WithOpName("bias2"), DT_FLOAT,
+                           ops::Placeholder::Shape({3}));
+
+  // Two NCHW BiasAdds connected through a layout-agnostic Relu.
+  ops::BiasAdd::Attrs attrs;
+  attrs = attrs.DataFormat("NCHW");
+  auto bias_add1 =
+      ops::BiasAdd(s.WithOpName("bias_add1"), input, bias1, attrs);
+  auto relu = ops::Relu(s.WithOpName("relu"), bias_add1);
+  auto bias_add2 = ops::BiasAdd(s.WithOpName("bias_add2"), relu, bias2, attrs);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), bias_add2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  CpuLayoutOptimizer optimizer;
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+
+  // Both BiasAdds are rewritten to NHWC.
+  const NodeDef* bias_add1_nhwc = node_map.GetNode("bias_add1-NHWC");
+  ASSERT_NE(nullptr, bias_add1_nhwc);
+  EXPECT_EQ("NHWC", bias_add1_nhwc->attr().at("data_format").s());
+  const NodeDef* bias_add2_nhwc = node_map.GetNode("bias_add2-NHWC");
+  ASSERT_NE(nullptr, bias_add2_nhwc);
+  EXPECT_EQ("NHWC", bias_add2_nhwc->attr().at("data_format").s());
+
+  // The region enters NHWC once, before the first BiasAdd...
+  const NodeDef* input_transpose =
+      node_map.GetNode("bias_add1-TransposeNCHWToNHWC");
+  ASSERT_NE(nullptr, input_transpose);
+  EXPECT_EQ("input", input_transpose->input(0));
+  EXPECT_EQ(input_transpose->name(), bias_add1_nhwc->input(0));
+
+  // ... the Relu between the two BiasAdds consumes NHWC directly ...
+  const NodeDef* transformed_relu = node_map.GetNode("relu");
+  ASSERT_NE(nullptr, transformed_relu);
+  EXPECT_EQ("bias_add1-NHWC", transformed_relu->input(0));
+  EXPECT_EQ("relu", bias_add2_nhwc->input(0));
+
+  // ... and leaves NHWC once, through the transpose that took over the name
+  // of the second BiasAdd.
+  const NodeDef* output_transpose = node_map.GetNode("bias_add2");
+  ASSERT_NE(nullptr, output_transpose);
+  EXPECT_EQ("Transpose", output_transpose->op());
+  EXPECT_EQ("bias_add2-NHWC", output_transpose->input(0));
+
+  auto input_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 4, 5});
+  auto bias1_t = GenerateRandomTensor<DT_FLOAT>({3});
+  auto bias2_t = GenerateRandomTensor<DT_FLOAT>({3});
+  std::vector<std::pair<string, Tensor>> feed = {
+      {"input", input_t}, {"bias1", bias1_t}, {"bias2", bias2_t}};
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, feed);
+  auto tensors = EvaluateNodes(output, item.fetch, feed);
+  EXPECT_EQ(1, tensors_expected.size());
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(CpuLayoutOptimizerTest, IgnoresNodesWithoutDevice) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 3, 4, 5}));
+  auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                          ops::Placeholder::Shape({3}));
+  ops::BiasAdd::Attrs attrs;
+  attrs = attrs.DataFormat("NCHW");
+  auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), input, bias, attrs);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), bias_add);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // Without assigned devices the nodes may still be placed on a GPU, where
+  // NCHW is the preferred layout, so the graph must be left unchanged.
+  CpuLayoutOptimizer optimizer;
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  NodeMap node_map(&output);
+  const NodeDef* transformed_bias_add = node_map.GetNode("bias_add");
+  ASSERT_NE(nullptr, transformed_bias_add);
+  EXPECT_EQ("BiasAdd", transformed_bias_add->op());
+  EXPECT_EQ("NCHW", transformed_bias_add->attr().at("data_format").s());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
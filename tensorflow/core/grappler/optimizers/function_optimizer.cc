@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -1960,6 +1961,179 @@ Status RestoreGraphInvariants(const FunctionOptimizerContext& ctx,
   return Status::OK();
 }
 
+// -------------------------------------------------------------------------- //
+// Deduplicate pure subgraphs stamped out by function instantiation.
+//
+// Inlining a function called from N call sites copies the function body N
+// times. Call sites invoked with the same inputs leave behind identical pure
+// subgraphs that downstream passes treat as unrelated nodes. We deduplicate
+// them here, right after inlining, with node-level common subexpression
+// elimination: identical pure nodes are merged bottom-up to a fixed point,
+// which collapses whole identical subgraphs one layer at a time.
+
+// Computes a fingerprint of the node computation: op, device, inputs and
+// attributes. Nodes with different fingerprints are guaranteed to be
+// different; candidates with equal fingerprints are compared field by field
+// with IsSameComputation before they are merged.
+uint64 ComputeNodeFingerprint(const NodeDef& node) {
+  uint64 h = Hash64(node.op());
+  h = Hash64Combine(Hash64(node.device()), h);
+
+  for (const string& input : node.input()) {
+    const TensorId input_tensor = ParseTensorName(input);
+    h = Hash64CombineUnordered(
+        Hash64(input_tensor.node().data(), input_tensor.node().size()), h);
+    h = Hash64CombineUnordered(std::hash<int>()(input_tensor.index()), h);
+  }
+  for (const auto& attr : node.attr()) {
+    h = Hash64CombineUnordered(Hash64(attr.first), h);
+    h = Hash64CombineUnordered(FastAttrValueHash(attr.second), h);
+  }
+  return h;
+}
+
+// Checks if two nodes with equal fingerprints indeed compute the same value:
+// same op on the same device, same data inputs in the same order, same
+// control inputs in any order, and equal attributes.
+bool IsSameComputation(const NodeDef& node1, const NodeDef& node2) {
+  if (node1.op() != node2.op()) return false;
+  if (node1.device() != node2.device()) return false;
+  if (node1.input_size() != node2.input_size()) return false;
+  if (node1.attr_size() != node2.attr_size()) return false;
+
+  // The order of data inputs matters; control inputs are an unordered set.
+  int index = 0;
+  for (; index < node1.input_size(); ++index) {
+    if (IsControlInput(node1.input(index))) break;
+    if (node1.input(index) != node2.input(index)) return false;
+  }
+  if (index < node1.input_size()) {
+    std::vector<string> ctrl_inputs1(node1.input().begin() + index,
+                                     node1.input().end());
+    std::vector<string> ctrl_inputs2(node2.input().begin() + index,
+                                     node2.input().end());
+    std::sort(ctrl_inputs1.begin(), ctrl_inputs1.end());
+    std::sort(ctrl_inputs2.begin(), ctrl_inputs2.end());
+    if (ctrl_inputs1 != ctrl_inputs2) return false;
+  }
+
+  for (const auto& attr1 : node1.attr()) {
+    auto it = node2.attr().find(attr1.first);
+    if (it == node2.attr().end()) return false;
+    if (!FastAreAttrValuesEqual(attr1.second, it->second)) return false;
+  }
+
+  return true;
+}
+
+void DedupInlinedComputations(const GrapplerItem& item,
+                              GraphDef* optimized_graph) {
+  GraphTopologyView graph_view;
+  if (!graph_view.InitializeFromGraph(*optimized_graph).ok()) {
+    VLOG(1) << "Skip deduplication: failed to initialize GraphTopologyView";
+    return;
+  }
+
+  // Nodes that feed an op modifying its inputs in place (directly, or through
+  // ops that may forward their inputs) must keep separate buffers: merging
+  // the initializers of two independent in-place accumulations would make
+  // them clobber each other's results.
+  absl::flat_hash_set<const NodeDef*> feeds_inplace_op;
+  for (const NodeDef& root : optimized_graph->node()) {
+    if (feeds_inplace_op.find(&root) != feeds_inplace_op.end()) continue;
+
+    if (ModifiesInputsInPlace(root)) {
+      const auto is_continue_traversal = [&](const NodeDef* node) -> bool {
+        return node->op() == root.op() || !NeverForwardsInputs(*node);
+      };
+
+      DfsTraversal(graph_view, {&root}, TraversalDirection::kFollowInputs,
+                   DfsPredicates::Advance(is_continue_traversal),
+                   DfsCallbacks::PreOrder([&](const NodeDef* node) {
+                     feeds_inplace_op.insert(node);
+                   }));
+    }
+  }
+
+  // Safety list: nodes that must keep every instance. Stateful ops and ops
+  // with side effects are never touched; Enter and Exit are pure but give
+  // control flow frames their identity.
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  const auto is_safe_to_dedup = [&](const NodeDef& node) -> bool {
+    if (nodes_to_preserve.find(node.name()) != nodes_to_preserve.end()) {
+      return false;
+    }
+    if (IsEnter(node) || IsExit(node)) return false;
+    return IsFreeOfSideEffect(node);
+  };
+
+  NodeMap node_map(optimized_graph);
+  absl::flat_hash_map<uint64, std::vector<NodeDef*>> representatives;
+  std::set<int> duplicates;
+
+  // Merging a node into its representative can make the fanout nodes of the
+  // two identical, so iterate to a fixed point.
+  bool stop = true;
+  do {
+    stop = true;
+    for (int i = 0; i < optimized_graph->node_size(); ++i) {
+      if (duplicates.find(i) != duplicates.end()) continue;
+      NodeDef* node = optimized_graph->mutable_node(i);
+      if (!is_safe_to_dedup(*node) ||
+          feeds_inplace_op.find(node) != feeds_inplace_op.end()) {
+        continue;
+      }
+
+      // Find a previously seen node computing the same value, or make this
+      // node the representative for its fingerprint.
+      NodeDef* rep = nullptr;
+      std::vector<NodeDef*>& candidates =
+          representatives[ComputeNodeFingerprint(*node)];
+      for (NodeDef* candidate : candidates) {
+        if (IsSameComputation(*candidate, *node)) {
+          rep = candidate;
+          break;
+        }
+      }
+      if (rep == nullptr) {
+        candidates.push_back(node);
+        continue;
+      }
+      if (feeds_inplace_op.find(rep) != feeds_inplace_op.end()) continue;
+
+      VLOG(3) << "Deduplicate node: node=" << node->name()
+              << " representative=" << rep->name();
+      const std::set<NodeDef*>& tmp = node_map.GetOutputs(node->name());
+      std::vector<NodeDef*> fanouts(tmp.begin(), tmp.end());
+      for (NodeDef* fanout : fanouts) {
+        for (int j = 0; j < fanout->input_size(); ++j) {
+          string* fanout_input = fanout->mutable_input(j);
+          const int position =
+              NodePositionIfSameNode(*fanout_input, node->name());
+          if (position < -1) {
+            continue;
+          } else if (position > 0) {
+            *fanout_input = strings::StrCat(rep->name(), ":", position);
+          } else if (position == 0) {
+            *fanout_input = rep->name();
+          } else {
+            *fanout_input = strings::StrCat("^", rep->name());
+          }
+          node_map.AddOutput(rep->name(), fanout->name());
+        }
+      }
+      duplicates.insert(i);
+      stop = false;
+    }
+  } while (!stop);
+
+  // With unknown fetch nodes the duplicates might still be requested by the
+  // caller, so they are only rewired, never removed.
+  if (!duplicates.empty() && !item.fetch.empty()) {
+    EraseNodesFromGraph(duplicates, optimized_graph);
+  }
+}
+
 }  // namespace
 
 Status FunctionOptimizer::RunFunctionOptimizerPass(
@@ -2177,6 +2351,17 @@ Status FunctionOptimizer::Optimize(Cluster*, const GrapplerItem& item,
         &graph_has_unoptimized_function_calls));
   }
 
+  // 3. Function call sites inlined with the same inputs leave behind
+  // identical pure subgraphs. Deduplicate them while the instantiation
+  // structure is still known, so that downstream optimizers and the executor
+  // see each computation only once. Deduplication merges nodes and removes
+  // the duplicates from the graph, so we do it only at the aggressive
+  // optimization level.
+  if (options_.enable_function_inlining &&
+      opt_level_ == RewriterConfig::AGGRESSIVE) {
+    DedupInlinedComputations(item, optimized_graph);
+  }
+
   return Status::OK();
 }
 
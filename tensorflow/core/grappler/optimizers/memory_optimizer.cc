@@ -420,9 +420,108 @@ void RecomputeSubgraph(
   }
 }
 
+// Candidate recompute subgraph ranked by the memory it frees at a device's
+// peak usage per recomputed node.
+struct RecomputeCandidate {
+  int index;       // index into the candidate subgraph vector
+  int64 savings;   // bytes freed at the device's peak memory usage
+  double fitness;  // savings per recomputed node
+
+  bool operator<(const RecomputeCandidate& other) const {
+    return fitness < other.fitness;
+  }
+};
+
+// Uses the per-tensor lifetime and size data inferred by the virtual
+// scheduler to keep only as many of the candidate recompute subgraphs as
+// needed to bring every device back under its memory capacity. Subgraphs
+// that free the most memory at the peak per recomputed node are preferred
+// (the candidates are cheap elementwise ops, so node count weighted by the
+// freed bytes is a reasonable proxy for the added flops), and subgraphs that
+// free no memory at any peak are dropped. Candidates are left untouched if
+// memory usage cannot be inferred.
+void SelectRecomputationsWithinBudget(
+    Cluster* cluster, const GrapplerItem& item,
+    std::vector<RecomputedSubGraph>* candidates) {
+  GraphMemory memory(item);
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  Status s = memory.InferStatically(devices);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return;
+  }
+
+  std::unordered_set<int> selected;
+  for (const auto& device : devices) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.memory_size() <= 0) {
+      VLOG(1) << "Available memory unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= prop.memory_size()) {
+      continue;
+    }
+    int64 required_savings = mem_usage.used_memory - prop.memory_size();
+
+    // Bytes held by each node's outputs at the peak memory usage.
+    std::unordered_map<string, int64> live_bytes;
+    for (const auto& live : mem_usage.live_tensors) {
+      live_bytes[live.node] += live.memory_used;
+    }
+
+    std::vector<RecomputeCandidate> ranked;
+    for (int i = 0; i < candidates->size(); ++i) {
+      int64 savings = 0;
+      for (const NodeDef* node : (*candidates)[i].recomputed_source_nodes) {
+        auto it = live_bytes.find(node->name());
+        if (it != live_bytes.end()) {
+          savings += it->second;
+        }
+      }
+      if (savings == 0) continue;
+      if (selected.count(i) > 0) {
+        // Already picked to relieve another device; it frees this memory
+        // regardless, so account for it without ranking it again.
+        required_savings -= savings;
+        continue;
+      }
+      RecomputeCandidate candidate;
+      candidate.index = i;
+      candidate.savings = savings;
+      candidate.fitness =
+          static_cast<double>(savings) /
+          (*candidates)[i].recomputed_source_nodes.size();
+      ranked.push_back(candidate);
+    }
+
+    std::sort(ranked.begin(), ranked.end());
+    for (int i = ranked.size() - 1; i >= 0 && required_savings > 0; --i) {
+      selected.insert(ranked[i].index);
+      required_savings -= ranked[i].savings;
+    }
+    if (required_savings > 0) {
+      VLOG(1) << "Recomputation frees too little memory to fit device " << name
+              << "; still " << required_savings << " bytes over capacity";
+    }
+  }
+
+  std::vector<RecomputedSubGraph> within_budget;
+  within_budget.reserve(selected.size());
+  for (int i = 0; i < candidates->size(); ++i) {
+    if (selected.count(i) > 0) {
+      within_budget.push_back(std::move((*candidates)[i]));
+    }
+  }
+  candidates->swap(within_budget);
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+                                Cluster* cluster, GraphDef* graph,
+                                const GrapplerItem& item) {
   if (optimization_level != RewriterConfig::RECOMPUTATION_HEURISTICS &&
       optimization_level != RewriterConfig::HEURISTICS &&
       optimization_level != RewriterConfig::MANUAL) {
@@ -481,6 +580,13 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
         },
         is_target);
   }
+  if (!recomputed_subgraphs.empty() && cluster != nullptr &&
+      optimization_level != RewriterConfig::MANUAL) {
+    // With a cluster we have per-tensor lifetime and size data, so instead of
+    // recomputing everything that is cheap we can recompute just enough to
+    // bring every device back under its memory capacity.
+    SelectRecomputationsWithinBudget(cluster, item, &recomputed_subgraphs);
+  }
   if (!recomputed_subgraphs.empty()) {
     std::unordered_map<const NodeDef*, int> topological_numbering;
     for (int node_number = 0; node_number < graph->node().size();
@@ -1341,7 +1447,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   GrapplerItem optimized_item(item);
 
   RecomputationRewritingPass(optimization_level_,
-                             recomputation_targets_name_scope_,
+                             recomputation_targets_name_scope_, cluster,
                              &optimized_item.graph, item);
 
   std::unordered_set<string> skip_list;
@@ -201,6 +201,51 @@ TEST_F(RecomputeSubgraphTest, MultiNode) {
   EXPECT_EQ("^gradients/BN1Grad", recompute_trigger_c->input(0));
 }
 
+TEST_F(RecomputeSubgraphTest, MemoryBudgetSelection) {
+  // Same graph as MultiNode, but optimized against a cluster that reports
+  // plenty of free memory: no device is over its capacity, so none of the
+  // recompute candidates should be rewritten.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  Output a = ops::Variable(s.WithOpName("Conv"), {2, 3, 4}, DT_FLOAT);
+  Output b = ops::Identity(s.WithOpName("BN"), a);
+  Output c = ops::Identity(s.WithOpName("ReLU"), b);
+  Output d = ops::Identity(s.WithOpName("Conv1"), c);
+
+  Output trigger = ops::AddN(s.WithOpName("gradients/BN1Grad"), {d});
+  Output e = ops::AddN(s.WithOpName("gradients/Conv1Grad"), {trigger, c});
+  Output f = ops::AddN(s.WithOpName("gradients/ReLUGrad"), {e, c});
+  Output g = ops::AddN(s.WithOpName("gradients/BNGrad"), {f, a});
+  Output h = ops::AddN(s.WithOpName("gradients/ConvGrad"), {g});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/ConvGrad"};
+  NodeMap pre_transform_node_map(&item.graph);
+  pre_transform_node_map.GetNode("BN")->set_op("FusedBatchNorm");
+  pre_transform_node_map.GetNode("ReLU")->set_op("Relu");
+
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  cpu_device.set_bandwidth(32);
+  cpu_device.set_memory_size(static_cast<int64>(1) << 40);
+  std::unordered_map<string, DeviceProperties> devices;
+  devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+  VirtualCluster cluster(devices);
+
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS);
+  GraphDef output;
+  Status status = optimizer.Optimize(&cluster, item, &output);
+
+  TF_EXPECT_OK(status);
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  NodeMap post_transform_node_map(&output);
+  EXPECT_EQ(nullptr, post_transform_node_map.GetNode("Recomputed/BN"));
+  EXPECT_EQ(nullptr, post_transform_node_map.GetNode("Recomputed/ReLU"));
+}
+
 class MemoryOptimizerTest : public GrapplerTest {
  public:
   static std::unique_ptr<VirtualCluster> CreateVirtualCluster() {
@@ -44,7 +44,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 
@@ -56,6 +61,30 @@ namespace {
 constexpr int kDefaultNumberOfIterations = 2;
 constexpr int kDefaultMinGraphNodes = 4;
 
+// Per-optimizer counters that attribute the total optimization time and the
+// graph growth/shrinkage to the individual Grappler passes.
+auto* optimizer_runs = monitoring::Counter<1>::New(
+    "/tensorflow/grappler/optimizer_runs",
+    "The number of times each Grappler optimizer pass has run.", "optimizer");
+
+auto* optimizer_time_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/grappler/optimizer_time_usecs",
+    "The cumulative wall-clock time spent in each Grappler optimizer pass in "
+    "microseconds.",
+    "optimizer");
+
+auto* optimizer_nodes_added = monitoring::Counter<1>::New(
+    "/tensorflow/grappler/optimizer_nodes_added",
+    "The cumulative number of nodes each Grappler optimizer pass has added to "
+    "the graphs it optimized.",
+    "optimizer");
+
+auto* optimizer_nodes_removed = monitoring::Counter<1>::New(
+    "/tensorflow/grappler/optimizer_nodes_removed",
+    "The cumulative number of nodes each Grappler optimizer pass has removed "
+    "from the graphs it optimized.",
+    "optimizer");
+
 int64 NumEdges(const GraphDef& graph) {
   int64 num_edges = 0;
   for (const auto& node : graph.node()) {
@@ -437,8 +466,12 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, const GrapplerItem& item,
                                      return result.status.ok();
                                    }) != optimization_result.results.end();
 
-  // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  // Record graph optimization result. Function items might be optimized
+  // concurrently, so the results vector must be guarded.
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -459,11 +492,13 @@ Status MetaOptimizer::RunOptimizer(
   // resets optimized_graph to an empty graph.
   optimized_graph->Swap(&optimized_item->graph);
   *optimized_graph = GraphDef();
+  const int nodes_before = optimized_item->graph.node_size();
   optimizer->set_deadline_usec(this->deadline_usec());
   Status status =
       optimizer->Optimize(cluster, *optimized_item, optimized_graph);
   uint64 end_us = Env::Default()->NowMicros();
-  float duration_ms = (end_us - start_us) / 1000.0f;
+  const uint64 duration_usecs = end_us - start_us;
+  float duration_ms = duration_usecs / 1000.0f;
 
   string message;
   if (!status.ok()) {
@@ -483,7 +518,25 @@ Status MetaOptimizer::RunOptimizer(
     VLOG(1) << optimizer->name() << ": " << message;
   }
 
-  OptimizerResult optimizer_result{optimizer->name(), message, status};
+  // On failure the original graph was swapped back into optimized_graph, so
+  // in both cases this is the node count the next optimizer will see.
+  const int nodes_after = optimized_graph->node_size();
+
+  // Export per-optimizer counters, so that slow passes and passes responsible
+  // for graph blow-up can be attributed without re-running the optimization
+  // with verbose logging.
+  optimizer_runs->GetCell(optimizer->name())->IncrementBy(1);
+  optimizer_time_usecs->GetCell(optimizer->name())->IncrementBy(duration_usecs);
+  if (nodes_after >= nodes_before) {
+    optimizer_nodes_added->GetCell(optimizer->name())
+        ->IncrementBy(nodes_after - nodes_before);
+  } else {
+    optimizer_nodes_removed->GetCell(optimizer->name())
+        ->IncrementBy(nodes_before - nodes_after);
+  }
+
+  OptimizerResult optimizer_result{optimizer->name(), message,      status,
+                                   duration_usecs,    nodes_before, nodes_after};
   optimization_result->results.push_back(optimizer_result);
 
   if (!status.ok() && cfg_.fail_on_optimizer_errors()) return status;
@@ -494,7 +547,10 @@ Status MetaOptimizer::RunOptimizer(
 Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -566,10 +622,13 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   while (optimize_function_library) {
     optimize_function_library = false;
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
+    // Collect the functions that can be optimized in this pass. They are all
+    // independent GrapplerItems, so their bodies can be optimized
+    // concurrently against the library as it is at the start of the pass.
+    std::vector<const FunctionDef*> funcs_to_optimize;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -584,20 +643,42 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       // the function optimizer, before we can optimize function body.
       if (IsParametrized(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name;
-
-      // Function optimization might specialize nested function calls, so we
-      // have to reset the flag and do at least one more pass over the library.
-      optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs_to_optimize.push_back(&func);
+    }
+    if (funcs_to_optimize.empty()) break;
 
-      // Make a GrapplerItem from a FunctionDef.
+    // Function optimization might specialize nested function calls, so we
+    // have to do at least one more pass over the function library.
+    optimize_function_library = true;
+
+    struct OptimizedFunction {
+      Status status;
       GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
-          func, flib, trimmed_item.graph.versions().producer(), &func_item));
+      GraphDef optimized_func_graph;
+    };
+    std::vector<OptimizedFunction> optimized_functions(
+        funcs_to_optimize.size());
+
+    // Optimizes the body of `funcs_to_optimize[idx]` into
+    // `optimized_functions[idx]`. Must not mutate `flib`, which is shared
+    // between concurrently optimized functions; new specialized functions are
+    // merged into the library sequentially below.
+    auto optimize_function = [&](int idx) {
+      const FunctionDef& func = *funcs_to_optimize[idx];
+      const string& func_name = func.signature().name();
+      OptimizedFunction& optimized = optimized_functions[idx];
 
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
+      VLOG(3) << "Optimize function: function=" << func_name;
+
+      // Make a GrapplerItem from a FunctionDef.
+      GrapplerFunctionItem& func_item = optimized.func_item;
+      optimized.status = MakeGrapplerFunctionItem(
+          func, flib, trimmed_item.graph.versions().producer(), &func_item);
+      if (!optimized.status.ok()) return;
+
+      // If we need to compute the gradient of optimized function at runtime,
+      // we can't perform non-differentiable rewrites.
       if (differentiable_functions.find(func_name) !=
           differentiable_functions.end()) {
         func_item.optimization_options().allow_non_differentiable_rewrites =
@@ -637,14 +718,36 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
 
       // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      TF_RETURN_IF_ERROR(
-          OptimizeGraph(cluster, func_item, &optimized_func_graph));
+      optimized.status =
+          OptimizeGraph(cluster, func_item, &optimized.optimized_func_graph);
+    };
+
+    const int num_functions = funcs_to_optimize.size();
+    const int num_threads =
+        std::min(num_functions, port::NumSchedulableCPUs());
+    if (num_threads <= 1) {
+      for (int i = 0; i < num_functions; ++i) optimize_function(i);
+    } else {
+      // The thread pool is joined at the end of the scope, so all scheduled
+      // function optimizations are done before the results are merged.
+      thread::ThreadPool pool(Env::Default(), "grappler_function_optimizer",
+                              num_threads);
+      for (int i = 0; i < num_functions; ++i) {
+        pool.Schedule([&optimize_function, i]() { optimize_function(i); });
+      }
+    }
+
+    // Merge the optimized functions back into the library in their original
+    // library order, so the resulting library does not depend on the relative
+    // timing of the concurrent function optimizations.
+    for (int i = 0; i < num_functions; ++i) {
+      OptimizedFunction& optimized = optimized_functions[i];
+      TF_RETURN_IF_ERROR(optimized.status);
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
       for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+           optimized.optimized_func_graph.library().function()) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
         }
@@ -652,17 +755,17 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
       // Convert optimized graph back to FunctionDef.
       FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
+      GrapplerFunctionItem& func_item = optimized.func_item;
+      func_item.SwapFunctionBody(std::move(optimized.optimized_func_graph));
       TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
 
       // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      TF_RETURN_IF_ERROR(flib.ReplaceFunction(
+          funcs_to_optimize[i]->signature().name(), optimized_func));
     }
 
-    // If optimized at least one function, update the graph library.
-    if (optimize_function_library) {
-      *optimized_graph->mutable_library() = flib.ToProto();
-    }
+    // Update the graph library with the optimized functions.
+    *optimized_graph->mutable_library() = flib.ToProto();
   }
 
   VLOG(1) << "Optimized " << optimized_funcs.size()
@@ -674,10 +777,76 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                         reinterpret_cast<uintptr_t>(optimized_graph)),
         *optimized_graph);
   }
+
+  // If graph dumping was requested, also dump the per-optimizer timing and
+  // node-delta results collected for this item, so that slow or exploding
+  // passes can be attributed offline.
+  const char* dump_prefix = getenv("TF_DUMP_GRAPH_PREFIX");
+  if (dump_prefix != nullptr) {
+    DumpOptimizationResultsToJson(
+        strings::StrCat(item.id, "_",
+                        reinterpret_cast<uintptr_t>(optimized_graph)),
+        dump_prefix);
+  }
+
   return Status::OK();
 }
 
+void MetaOptimizer::DumpOptimizationResultsToJson(const string& item_id,
+                                                  const string& dirname) {
+  Status status = Env::Default()->RecursivelyCreateDir(dirname);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to create " << dirname
+                 << " for dumping optimization results: " << status;
+    return;
+  }
+
+  string json = "[";
+  {
+    mutex_lock lock(optimization_results_mu_);
+    bool first_graph = true;
+    for (const GraphOptimizationResult& graph_result : optimization_results_) {
+      strings::StrAppend(&json, first_graph ? "" : ",", "\n  {\"id\": \"",
+                         str_util::CEscape(graph_result.id),
+                         "\", \"optimizers\": [");
+      first_graph = false;
+      bool first_result = true;
+      for (const OptimizerResult& result : graph_result.results) {
+        strings::StrAppend(
+            &json, first_result ? "" : ",", "\n    {\"optimizer\": \"",
+            str_util::CEscape(result.optimizer_name),
+            "\", \"duration_usecs\": ", result.duration_usecs,
+            ", \"nodes_before\": ", result.nodes_before,
+            ", \"nodes_after\": ", result.nodes_after, ", \"status\": \"",
+            str_util::CEscape(result.status.ToString()), "\"}");
+        first_result = false;
+      }
+      strings::StrAppend(&json, "\n  ]}");
+    }
+  }
+  strings::StrAppend(&json, "\n]\n");
+
+  // Remove the same illegal filename characters as the graph dumps.
+  string filename = strings::StrCat("metaoptimizer_results_", item_id);
+  for (int i = 0; i < filename.size(); ++i) {
+    char ch = filename[i];
+    if (ch == '/' || ch == '[' || ch == ']' || ch == '*' || ch == '?') {
+      filename[i] = '_';
+    }
+  }
+  const string filepath = strings::StrCat(dirname, "/", filename, ".json");
+
+  status = WriteStringToFile(Env::Default(), filepath, json);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to dump optimization results to file: " << filepath
+                 << " : " << status;
+  } else {
+    LOG(INFO) << "Dumped MetaOptimizer results to " << filepath;
+  }
+}
+
 void MetaOptimizer::PrintResult() {
+  mutex_lock lock(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     LOG(INFO) << "Optimization results for grappler item: " << graph_result.id;
     for (const OptimizerResult& result : graph_result.results) {
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -84,6 +85,10 @@ class MetaOptimizer : public GraphOptimizer {
     string optimizer_name;
     string message;
     Status status;
+    // Timing and node-delta attribution for the individual optimizer run.
+    uint64 duration_usecs;
+    int nodes_before;
+    int nodes_after;
   };
 
   struct GraphOptimizationResult {
@@ -96,7 +101,17 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  // Writes per-optimizer timing and node-delta results collected during the
+  // last optimization to a JSON file in `dirname`, so that slow optimizers
+  // can be attributed offline without re-running with verbose logging.
+  void DumpOptimizationResultsToJson(const string& item_id,
+                                     const string& dirname);
+
+  // Appended to concurrently when independent function items are optimized
+  // in parallel.
+  mutex optimization_results_mu_;
+  std::vector<GraphOptimizationResult> optimization_results_
+      GUARDED_BY(optimization_results_mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
@@ -33,6 +33,7 @@ namespace grappler {
 namespace {
 
 constexpr char kFusedConv2D[] = "_FusedConv2D";
+constexpr char kFusedMatMul[] = "_FusedMatMul";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
@@ -131,6 +132,57 @@ struct Conv2DWithBatchNormAndRelu {
   float epsilon = 0.0;
 };
 
+// IsMatMul in op_types.h also matches BatchMatMul, SparseMatMul and the
+// quantized variants; fused contraction output kernels support only the
+// plain MatMul.
+bool IsMatMulOnly(const NodeDef& node) { return node.op() == "MatMul"; }
+
+// Declarative description of a {Contraction, BiasAdd, <Activation>} chain
+// that can be rewritten into a single fused contraction node. New fusions
+// ship as data: a registry entry describing the chain, plus a kernel
+// implementing the matching `fused_ops` combination.
+struct ContractionFusion {
+  bool (*is_contraction)(const NodeDef& node);
+  // Optional activation consuming the BiasAdd output; nullptr if the chain
+  // ends at the BiasAdd.
+  bool (*is_activation)(const NodeDef& node);
+  // Activation op name recorded in the 'fused_ops' attribute.
+  const char* activation_name;
+  // Op the matched chain is rewritten to.
+  const char* fused_op;
+};
+
+const std::vector<ContractionFusion>& ContractionFusionRegistry() {
+  static const std::vector<ContractionFusion>* registry =
+      new std::vector<ContractionFusion>{
+          // clang-format off
+          {&IsMatMulOnly, nullptr,  nullptr, kFusedMatMul},
+          {&IsMatMulOnly, &IsRelu,  "Relu",  kFusedMatMul},
+          {&IsMatMulOnly, &IsRelu6, "Relu6", kFusedMatMul},
+          {&IsMatMulOnly, &IsElu,   "Elu",   kFusedMatMul},
+          // clang-format on
+      };
+  return *registry;
+}
+
+// Contraction node followed by a BiasAdd and an optional activation, matched
+// against one of the chains in the ContractionFusionRegistry().
+struct ContractionWithBiasAdd {
+  ContractionWithBiasAdd() = default;
+  ContractionWithBiasAdd(const ContractionFusion* fusion,
+                         const NodeDef* contraction, const NodeDef* bias_add,
+                         const NodeDef* activation)
+      : fusion(fusion),
+        contraction(contraction),
+        bias_add(bias_add),
+        activation(activation) {}
+
+  const ContractionFusion* fusion = nullptr;
+  const NodeDef* contraction = nullptr;
+  const NodeDef* bias_add = nullptr;
+  const NodeDef* activation = nullptr;  // nullptr if fusion has no activation
+};
+
 bool IsInPreserveSet(const RemapperContext& ctx, const NodeDef* node) {
   return ctx.nodes_to_preserve.count(node->name()) > 0;
 }
@@ -416,6 +468,62 @@ bool FindConv2DWithBatchNormAndRelu(const RemapperContext& ctx,
   return true;
 }
 
+bool FindContractionWithBiasAdd(const RemapperContext& ctx,
+                                const NodeDef* node,
+                                ContractionWithBiasAdd* matched) {
+  if (!EigenSupportsContractionOutputKernel()) return false;
+
+  // Root of the pattern must be a BiasAdd or an activation consuming one.
+  if (node == nullptr || HasControlFaninOrFanout(ctx.graph_view, node))
+    return false;
+
+  for (const ContractionFusion& fusion : ContractionFusionRegistry()) {
+    const NodeDef* activation = nullptr;
+    const NodeDef* bias_add = node;
+
+    if (fusion.is_activation != nullptr) {
+      // Root of the chain must be the activation, and its input a BiasAdd.
+      if (!fusion.is_activation(*node)) continue;
+      activation = node;
+
+      const auto activation_input_port = GraphView::InputPort(activation, 0);
+      bias_add = ctx.graph_view.GetRegularFanin(activation_input_port).node;
+
+      if (bias_add == nullptr ||
+          !HaveSameDataType(activation, bias_add) ||
+          HasControlFaninOrFanout(ctx.graph_view, bias_add) ||
+          !HasSingleFanoutNode(ctx.graph_view, bias_add) ||
+          IsInPreserveSet(ctx, bias_add))
+        continue;
+    }
+
+    if (!IsBiasAdd(*bias_add)) continue;
+
+    // Input to the BiasAdd must be the contraction.
+    const auto bias_input_port = GraphView::InputPort(bias_add, 0);
+    const NodeDef* contraction =
+        ctx.graph_view.GetRegularFanin(bias_input_port).node;
+
+    if (contraction == nullptr || !fusion.is_contraction(*contraction) ||
+        !HaveSameDataType(bias_add, contraction) ||
+        HasControlFaninOrFanout(ctx.graph_view, contraction) ||
+        !HasSingleFanoutNode(ctx.graph_view, contraction) ||
+        IsInPreserveSet(ctx, contraction))
+      continue;
+
+    // Fused contraction output kernels are CPU-only.
+    if (!NodeIsOnCpu(contraction) || !IsCpuCompatibleDataType(contraction))
+      continue;
+
+    // We successfully matched one of the registered contraction fusions.
+    *matched =
+        ContractionWithBiasAdd(&fusion, contraction, bias_add, activation);
+    return true;
+  }
+
+  return false;
+}
+
 // Check that given node meets some basic FusedBatchNorm optimization
 // preconditions. We use this check to lazily infer graph properties which is
 // rather expensive.
@@ -475,6 +583,15 @@ void CopyConv2DAttributes(const NodeDef* conv2d, NodeDef* fused_conv2d) {
   (*attr)["use_cudnn_on_gpu"] = src_attr.at("use_cudnn_on_gpu");
 }
 
+void CopyMatMulAttributes(const NodeDef* matmul, NodeDef* fused_matmul) {
+  auto* attr = fused_matmul->mutable_attr();
+  auto src_attr = matmul->attr();
+
+  (*attr)["T"] = src_attr.at("T");
+  (*attr)["transpose_a"] = src_attr.at("transpose_a");
+  (*attr)["transpose_b"] = src_attr.at("transpose_b");
+}
+
 void SetFusedConv2DAttributes(
     NodeDef* fused_conv2d, const absl::Span<const absl::string_view> fused_ops,
     int num_args = 1, float epsilon = 0.0) {
@@ -628,6 +745,54 @@ void AddFusedConv2DNode(
   invalidated_nodes->insert(matched.conv2d);
 }
 
+void AddFusedContractionNode(
+    const ContractionWithBiasAdd& matched, GraphDef* optimized_graph,
+    absl::flat_hash_set<const NodeDef*>* invalidated_nodes) {
+  const ContractionFusion& fusion = *matched.fusion;
+
+  if (matched.activation != nullptr) {
+    VLOG(2) << "Fuse " << matched.contraction->op() << " with BiasAdd and "
+            << matched.activation->op()
+            << ": activation=" << matched.activation->name()
+            << " bias_add=" << matched.bias_add->name()
+            << " contraction=" << matched.contraction->name();
+  } else {
+    VLOG(2) << "Fuse " << matched.contraction->op()
+            << " with BiasAdd: bias_add=" << matched.bias_add->name()
+            << " contraction=" << matched.contraction->name();
+  }
+
+  // The fused node takes over the name of the last node in the chain, so all
+  // its consumers are rewired automatically.
+  const NodeDef* output_node =
+      matched.activation != nullptr ? matched.activation : matched.bias_add;
+
+  NodeDef* fused_node = optimized_graph->add_node();
+  fused_node->set_name(output_node->name());
+  fused_node->set_op(fusion.fused_op);
+  fused_node->set_device(matched.contraction->device());
+  fused_node->add_input(matched.contraction->input(0));  // 0: a
+  fused_node->add_input(matched.contraction->input(1));  // 1: b
+  fused_node->add_input(matched.bias_add->input(1));     // 2: bias
+
+  DCHECK(IsMatMulOnly(*matched.contraction));
+  CopyMatMulAttributes(matched.contraction, fused_node);
+
+  std::vector<absl::string_view> fused_ops = {"BiasAdd"};
+  if (fusion.activation_name != nullptr) {
+    fused_ops.push_back(fusion.activation_name);
+  }
+  auto* attr = fused_node->mutable_attr();
+  SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+  SetAttrValue(1, &(*attr)["num_args"]);
+
+  if (matched.activation != nullptr) {
+    invalidated_nodes->insert(matched.activation);
+  }
+  invalidated_nodes->insert(matched.bias_add);
+  invalidated_nodes->insert(matched.contraction);
+}
+
 void AddBatchNormNodes(const FusedBatchNorm& matched,
                        GraphDef* optimized_graph) {
   const NodeDef& fused_node = *matched.fused_batch_norm;
@@ -782,6 +947,7 @@ Status Remapper::Optimize(Cluster* /*cluster*/, const GrapplerItem& item,
   Conv2DWithBatchNorm         conv2d_with_batch_norm;
   Conv2DWithBatchNormAndRelu  conv2d_with_batch_norm_and_relu;
   Conv2DWithSqueezeAndBiasAdd conv2d_with_squeeze_and_bias;
+  ContractionWithBiasAdd      contraction_with_bias_add;
   // clang-format on
 
   // Processing graph in reverse-topological sorted order allows to remap
@@ -842,6 +1008,14 @@ Status Remapper::Optimize(Cluster* /*cluster*/, const GrapplerItem& item,
                          &invalidated_nodes);
       continue;
     }
+
+    // Remap {MatMul}+BiasAdd+<Activation> chains into fused contraction
+    // nodes (see ContractionFusionRegistry).
+    if (FindContractionWithBiasAdd(ctx, &node, &contraction_with_bias_add)) {
+      AddFusedContractionNode(contraction_with_bias_add, optimized_graph,
+                              &invalidated_nodes);
+      continue;
+    }
 #endif  // !INTEL_MKL
 
     // Infer properties lazily in case they are not needed.
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -652,12 +653,268 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites an eligible ConcatV2 into a zero-copy view: the inputs are
+// allocated directly out of one ScopedAllocator backing tensor, and the
+// concat is replaced by a _ScopedAllocatorConcat that reinterprets the
+// backing with the concat's output shape.  Only axis-0 concats whose
+// inputs pack contiguously (no alignment gaps between fields) qualify.
+// Enabled by listing "ConcatV2" in ScopedAllocatorOptions.enable_op.
+class ConcatV2Rewriter : public ScopedAllocatorOptimizer::Rewriter {
+ public:
+  ~ConcatV2Rewriter() override {}
+
+  // Each ConcatV2 node is rewritten independently.
+  size_t MinGroupSize() const override { return 1; }
+
+  // Ops whose output may alias or forward another buffer; their outputs
+  // cannot be redirected into a ScopedAllocator field.
+  static bool MayForwardBuffer(const NodeDef& node) {
+    static const std::set<string>* const kForwardingOps = new std::set<string>(
+        {"Identity", "IdentityN", "Reshape", "Squeeze", "ExpandDims",
+         "Snapshot", "BroadcastTo", "StopGradient", "ReadVariableOp",
+         "_Arg", "Placeholder", "PlaceholderV2"});
+    return IsConstant(node) || IsVariable(node) || IsEnter(node) ||
+           IsExit(node) || IsSwitch(node) || IsMerge(node) ||
+           kForwardingOps->count(node.op()) > 0;
+  }
+
+  // Checks eligibility of 'concat' and gathers its input descriptions,
+  // shapes and output shape.  Returns non-OK (without logging) when the
+  // node should simply be left alone.
+  Status AnalyzeConcat(ScopedAllocatorOptimizer* sa_opti, NodeDef* concat,
+                       int* num_inputs, DataType* dtype,
+                       std::vector<InputDesc>* inputs,
+                       std::vector<TensorShape>* input_shapes,
+                       TensorShape* output_shape) {
+    NodeMap* node_map = sa_opti->node_map();
+    AttrSlice concat_attrs(*concat);
+    TF_RETURN_IF_ERROR(GetNodeAttr(concat_attrs, "N", num_inputs));
+    TF_RETURN_IF_ERROR(GetNodeAttr(concat_attrs, "T", dtype));
+    if (*num_inputs < 2 || concat->input_size() < *num_inputs + 1) {
+      return errors::Internal("Unexpected input arity on ", concat->name());
+    }
+    if (DataTypeSize(*dtype) == 0 ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return errors::Internal("Type ", DataTypeString(*dtype),
+                              " does not divide kAllocatorAlignment");
+    }
+
+    // The axis input must be a constant zero.
+    int axis_slot = 0;
+    const string axis_name =
+        ParseNodeName(concat->input(*num_inputs), &axis_slot);
+    NodeDef* axis_node = node_map->GetNode(axis_name);
+    if (axis_node == nullptr || !IsConstant(*axis_node)) {
+      return errors::Internal("Concat axis of ", concat->name(),
+                              " is not constant");
+    }
+    Tensor axis_tensor;
+    TF_RETURN_IF_ERROR(GetNodeAttr(AttrSlice(*axis_node), "value",
+                                   &axis_tensor));
+    if (axis_tensor.NumElements() != 1 ||
+        axis_tensor.dtype() != DT_INT32 ||
+        axis_tensor.scalar<int32>()() != 0) {
+      return errors::Internal("Concat axis of ", concat->name(),
+                              " is not zero");
+    }
+
+    if (!graph_properties_->HasOutputProperties(concat->name())) {
+      return errors::Internal("Node ", concat->name(), " lacks output shape");
+    }
+    const OpInfo::TensorProperties& concat_props =
+        graph_properties_->GetOutputProperties(concat->name())[0];
+    if (!TensorShape::IsValid(concat_props.shape()) ||
+        concat_props.shape().unknown_rank()) {
+      return errors::Internal("Complete shape not known for ", concat->name());
+    }
+    *output_shape = TensorShape(concat_props.shape());
+
+    for (int i = 0; i < *num_inputs; ++i) {
+      int output_slot = 0;
+      const string input_name = ParseNodeName(concat->input(i), &output_slot);
+      NodeDef* producer = node_map->GetNode(input_name);
+      if (producer == nullptr) {
+        return errors::Internal("Missing producer for ", concat->input(i));
+      }
+      if (producer->device() != concat->device()) {
+        return errors::Internal("Producer ", producer->name(),
+                                " not on concat's device");
+      }
+      if (MayForwardBuffer(*producer)) {
+        return errors::Internal("Producer ", producer->name(),
+                                " may forward another buffer");
+      }
+      if (HasNodeAttr(*producer, "_scoped_allocator")) {
+        return errors::Internal("Producer ", producer->name(),
+                                " is already assigned to a ScopedAllocator");
+      }
+      // The concat must be the producer's only consumer: the field view of
+      // the backing tensor replaces the producer's output entirely.
+      if (node_map->GetOutputs(producer->name()).size() != 1) {
+        return errors::Internal("Producer ", producer->name(),
+                                " has other consumers");
+      }
+      if (!graph_properties_->HasOutputProperties(producer->name())) {
+        return errors::Internal("Node ", producer->name(),
+                                " lacks output shape");
+      }
+      const std::vector<OpInfo::TensorProperties>& prop_list =
+          graph_properties_->GetOutputProperties(producer->name());
+      if (output_slot >= static_cast<int>(prop_list.size())) {
+        return errors::Internal("Missing properties for output slot ",
+                                output_slot, " of ", producer->name());
+      }
+      const OpInfo::TensorProperties& props = prop_list[output_slot];
+      if (props.dtype() != *dtype || !TensorShape::IsValid(props.shape()) ||
+          props.shape().unknown_rank()) {
+        return errors::Internal("Bad type or shape for input ", i, " of ",
+                                concat->name());
+      }
+      input_shapes->push_back(TensorShape(props.shape()));
+      inputs->emplace_back(producer, output_slot, concat);
+    }
+
+    // The backing tensor is only a valid concat view if the fields pack
+    // without alignment gaps.
+    std::vector<ScopedAllocator::Field> fields;
+    ScopedAllocatorMgr::PopulateFields(0 /*scope_id*/, *input_shapes, *dtype,
+                                       &fields);
+    int64 expected_offset = 0;
+    for (const auto& field : fields) {
+      if (field.offset != expected_offset) {
+        return errors::Internal("Inputs of ", concat->name(),
+                                " do not pack contiguously");
+      }
+      expected_offset += field.bytes;
+    }
+    return Status::OK();
+  }
+
+  // Performs the rewrite for one eligible ConcatV2 node.
+  Status RewriteOne(ScopedAllocatorOptimizer* sa_opti, int64 invocation_count,
+                    GraphDef* graph, NodeDef* concat) {
+    NodeMap* node_map = sa_opti->node_map();
+    int num_inputs;
+    DataType dtype;
+    std::vector<InputDesc> inputs;
+    std::vector<TensorShape> input_shapes;
+    TensorShape output_shape;
+    TF_RETURN_IF_ERROR(AnalyzeConcat(sa_opti, concat, &num_inputs, &dtype,
+                                     &inputs, &input_shapes, &output_shape));
+
+    const string& device_name = concat->device();
+    const int sa_id = sa_opti->NewScopedAllocatorId(num_inputs);
+    const string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    const string sac_name = strings::StrCat("scoped_allocator_concat_", sa_id,
+                                            "_", invocation_count);
+
+    // The backing tensor covers exactly the concatenated elements since
+    // AnalyzeConcat verified a gap-free layout.
+    TensorShape sa_shape({output_shape.num_elements()});
+    NodeDefBuilder sa_builder(sa_name, "_ScopedAllocator");
+    sa_builder.Device(device_name);
+    sa_builder.Attr("sa_name", sa_name);
+    sa_builder.Attr("T", dtype);
+    sa_builder.Attr("id", sa_id);
+    sa_builder.Attr("shapes", input_shapes);
+    sa_builder.Attr("shape", sa_shape);
+    sa_builder.Attr("expected_call_count", static_cast<int64>(num_inputs));
+    NodeDef* sa_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
+    node_map->AddNode(sa_name, sa_node);
+    for (int i = 0; i < num_inputs; ++i) {
+      const InputDesc& nd = inputs[i];
+      nd.from_node_def->add_input(strings::StrCat("^", sa_name));
+      ScopedAllocatorOptimizer::ExtendNodeAttr("_scoped_allocator",
+                                               {nd.output_slot, sa_id + 1 + i},
+                                               nd.from_node_def);
+      node_map->AddOutput(sa_name, nd.from_node_def->name());
+    }
+
+    NodeDefBuilder sac_builder(sac_name, "_ScopedAllocatorConcat");
+    sac_builder.Device(device_name);
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", dtype);
+    sac_builder.Attr("shape", output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", num_inputs);
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+    std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+    for (int i = 0; i < num_inputs; ++i) {
+      sac_inputs.push_back(NodeDefBuilder::NodeOut(concat->input(i), 0, dtype));
+    }
+    sac_builder.Input(sac_inputs);
+    NodeDef* sac_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(sac_node));
+    node_map->AddNode(sac_name, sac_node);
+    node_map->AddOutput(sa_name, sac_name);
+    for (int i = 0; i < num_inputs; ++i) {
+      node_map->AddOutput(inputs[i].from_node_def->name(), sac_name);
+    }
+    // Preserve any control inputs of the old concat.
+    for (int i = num_inputs + 1; i < concat->input_size(); ++i) {
+      if (IsControlInput(concat->input(i))) {
+        sac_node->add_input(concat->input(i));
+        int ctl_slot = 0;
+        const string ctl_name = ParseNodeName(concat->input(i), &ctl_slot);
+        node_map->AddOutput(ctl_name, sac_name);
+      }
+    }
+
+    // Route the concat's consumers to the new view node.
+    std::set<NodeDef*> output_nodes = node_map->GetOutputs(concat->name());
+    for (NodeDef* n : output_nodes) {
+      for (int i = 0; i < n->input_size(); ++i) {
+        int position = 0;
+        const string input_node = ParseNodeName(n->input(i), &position);
+        if (input_node != concat->name()) continue;
+        if (position == -1) {
+          *n->mutable_input(i) = strings::StrCat("^", sac_name);
+        } else {
+          CHECK_EQ(0, position) << "unexpected output slot on " << n->input(i);
+          *n->mutable_input(i) = sac_name;
+        }
+        node_map->RemoveOutput(concat->name(), n->name());
+        node_map->AddOutput(sac_name, n->name());
+      }
+    }
+
+    node_map->RemoveInputs(concat->name());
+    concat->clear_input();
+    node_map->RemoveOutputs(concat->name());
+    RemoveNode(concat, graph, node_map);
+    return Status::OK();
+  }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64 invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    for (NodeDef* n : ops) {
+      Status s = RewriteOne(sa_opti, invocation_count, graph, n);
+      if (s.ok()) {
+        VLOG(1) << "Rewrote ConcatV2 " << n->name()
+                << " into a ScopedAllocator view";
+        *applied = true;
+      } else {
+        // Ineligible nodes are simply left in place.
+        VLOG(1) << "Not rewriting ConcatV2 " << n->name() << ": "
+                << s.error_message();
+      }
+    }
+    return Status::OK();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatV2Rewriter();
+  to_delete_.push_back(concat_rewriter);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -667,7 +924,7 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = (op_name == "ConcatV2") ? concat_rewriter : r;
     }
   }
 }
@@ -762,16 +1019,25 @@ class Tree {
   string edge_;
   int depth_;
   std::vector<NodeDef*> nodes_;
+  // Nodes too few to fuse at this scope, offered up for fusion in the
+  // enclosing scope.
+  std::vector<NodeDef*> hoisted_;
   std::unordered_map<string, Tree*> subtrees_;
 };
 
 // Applies a function to every Tree in DFS order.  Terminates early
-// on any non-OK Status.
+// on any non-OK Status.  After a subtree has been processed, any nodes
+// it left in hoisted_ are adopted by the parent so that small tensors
+// scattered across sibling scopes get a chance to fuse together.
 Status ApplyToAll(Tree* tree, const std::function<Status(Tree*)>& func) {
   Status s;
   for (auto it : tree->subtrees_) {
     s = ApplyToAll(it.second, func);
     if (!s.ok()) return s;
+    Tree* subtree = it.second;
+    tree->nodes_.insert(tree->nodes_.end(), subtree->hoisted_.begin(),
+                        subtree->hoisted_.end());
+    subtree->hoisted_.clear();
   }
   s = func(tree);
   return s;
@@ -812,6 +1078,42 @@ void PartitionByLoopStructure(const FrameView& frame_view,
   }
 }
 
+// A tensor at most this large is worth hoisting into an enclosing scope
+// for fusion with tensors from sibling scopes, since per-op dispatch and
+// transfer overhead dominates its execution time.
+constexpr int64 kMaxBytesToHoist = 64 * 1024;
+
+// Returns true iff the single output of `n` has a known type and a fully
+// defined shape of at most kMaxBytesToHoist bytes.
+bool IsSmallFusibleTensor(const GraphProperties& graph_properties,
+                          const NodeDef& n) {
+  if (!graph_properties.HasOutputProperties(n.name())) return false;
+  const std::vector<OpInfo::TensorProperties>& prop_list =
+      graph_properties.GetOutputProperties(n.name());
+  if (prop_list.size() != 1) return false;
+  const OpInfo::TensorProperties& props = prop_list[0];
+  if (!TensorShape::IsValid(props.shape())) return false;
+  const int64 num_bytes =
+      TensorShape(props.shape()).num_elements() * DataTypeSize(props.dtype());
+  return num_bytes <= kMaxBytesToHoist;
+}
+
+// Partitions `nodes` by the value of their "T" attr.  Nodes gathered
+// from different scopes may have different types, and the rewriters
+// require each group to be homogeneous.
+void PartitionByDataType(std::vector<NodeDef*> nodes,
+                         std::vector<std::vector<NodeDef*>>* type_groups) {
+  std::map<int, std::vector<NodeDef*>> type_sets;
+  for (NodeDef* nd : nodes) {
+    DataType dtype = DT_INVALID;
+    GetNodeAttr(AttrSlice(*nd), "T", &dtype).IgnoreError();
+    type_sets[static_cast<int>(dtype)].push_back(nd);
+  }
+  for (auto& it : type_sets) {
+    type_groups->push_back(std::move(it.second));
+  }
+}
+
 }  // namespace
 
 Status ScopedAllocatorOptimizer::ProcessGraphDef(
@@ -849,22 +1151,37 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // Nodes with a common depth and root path are now grouped
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
-        status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
+        status = ApplyToAll(root.get(), [this, rewriter, graph,
+                                         &graph_properties, &frame_view,
                                          &op_name, invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
-          if (t->nodes_.size() > 1) {
-            std::vector<std::vector<NodeDef*>> loop_groups;
-            PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
-            for (auto& lg : loop_groups) {
-              if (lg.size() > 1) {
+          const size_t min_group_size = rewriter->MinGroupSize();
+          if (t->nodes_.empty()) return Status::OK();
+          std::vector<std::vector<NodeDef*>> loop_groups;
+          PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
+          for (auto& lg : loop_groups) {
+            std::vector<std::vector<NodeDef*>> type_groups;
+            PartitionByDataType(lg, &type_groups);
+            for (auto& tg : type_groups) {
+              if (tg.size() >= min_group_size) {
                 bool applied = false;
-                Status s = OrderNodeSet(&lg);
+                Status s = OrderNodeSet(&tg);
                 TF_RETURN_IF_ERROR(s);
                 VLOG(1) << "Applying Rewriter for " << op_name;
                 s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
+                                      tg, &applied);
                 LOG_WARNING_AND_RETURN_IF_ERROR(s);
+              } else if (t->depth_ > 0) {
+                // Too few ops of this type at this scope to fuse, as is
+                // typical for per-layer gradients.  Hoist small tensors
+                // into the enclosing scope, where they may fuse with
+                // leftovers from sibling scopes into a single transfer.
+                for (NodeDef* n : tg) {
+                  if (IsSmallFusibleTensor(graph_properties, *n)) {
+                    t->hoisted_.push_back(n);
+                  }
+                }
               }
             }
           }
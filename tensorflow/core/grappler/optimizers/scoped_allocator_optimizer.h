@@ -82,6 +82,11 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Minimum number of op instances a group must contain before Rewrite
+    // is invoked on it.  Rewriters that coalesce parallel instances need
+    // at least 2; rewriters that transform nodes individually return 1.
+    virtual size_t MinGroupSize() const { return 2; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
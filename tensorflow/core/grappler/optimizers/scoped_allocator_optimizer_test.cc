@@ -94,6 +94,27 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs the same graph as BuildAbsGraph, but places a1 and a2 in
+  // separate name scopes, the way per-layer gradient ops are scoped.
+  void BuildAbsGraphInScopes(GraphDef* graph_def) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Output a =
+        ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+    Output b =
+        ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    Output c =
+        ops::Const<float>(s.WithOpName("c"), {-5.0, -2.0, 0.0, -2.0}, {2, 2});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), b, c);
+    Output a1 = ops::Abs(s.WithOpName("sub1/a1"), s1);
+    Output a2 = ops::Abs(s.WithOpName("sub2/a2"), s2);
+    Output r1 = ops::Reshape(s.WithOpName("r1"), a1, {1, 4});
+    Output r2 = ops::Reshape(s.WithOpName("r2"), a2, {4, 1});
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -163,6 +184,37 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteOnly) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, CrossScopeRewrite) {
+  // Each name scope holds only one Abs, too few to fuse in place.  The
+  // small tensors should be hoisted to the enclosing scope and fused
+  // there into a single ScopedAllocator group.
+  GrapplerItem item;
+  BuildAbsGraphInScopes(&item.graph);
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  ScopedAllocatorOptimizer::OpNameSet ons;
+  ons.insert("Abs");
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  // The two Abs ops should have been replaced by one fused Abs reading
+  // from a single ScopedAllocator-backed buffer.
+  int num_sa = 0;
+  int num_abs = 0;
+  for (const NodeDef& n : optimized_graph.node()) {
+    if (n.op() == "_ScopedAllocator") ++num_sa;
+    if (n.op() == "Abs") ++num_abs;
+    EXPECT_NE("sub1/a1", n.name());
+    EXPECT_NE("sub2/a2", n.name());
+  }
+  EXPECT_EQ(1, num_sa);
+  EXPECT_EQ(1, num_abs);
+}
+
 TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   // Constructs the same graph as UnaryRewriteOnly, but actually executes it.
   GrapplerItem item;
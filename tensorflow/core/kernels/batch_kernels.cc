@@ -209,6 +209,7 @@ class BatchResource : public ResourceBase {
  public:
   static Status Create(int32 num_batch_threads, int32 max_batch_size,
                        int32 batch_timeout_micros, int32 max_enqueued_batches,
+                       int32 target_latency_micros,
                        const std::vector<int32>& allowed_batch_sizes,
                        FunctionLibraryRuntime::Handle fhandle,
                        std::unique_ptr<BatchResource>* resource) {
@@ -224,6 +225,8 @@ class BatchResource : public ResourceBase {
         max_enqueued_batches;
     new_resource->batcher_queue_options_.batch_timeout_micros =
         batch_timeout_micros;
+    new_resource->batcher_queue_options_.target_latency_micros =
+        target_latency_micros;
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
 
@@ -705,6 +708,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
                    c->GetAttr("batch_timeout_micros", &batch_timeout_micros_));
     OP_REQUIRES_OK(c,
                    c->GetAttr("max_enqueued_batches", &max_enqueued_batches_));
+    OP_REQUIRES_OK(c,
+                   c->GetAttr("target_latency_micros", &target_latency_micros_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
 
@@ -722,10 +727,10 @@ class BatchFunctionKernel : public AsyncOpKernel {
     BatchResource* br;
     std::function<Status(BatchResource**)> creator = [this](BatchResource** r) {
       std::unique_ptr<BatchResource> new_resource;
-      TF_RETURN_IF_ERROR(
-          BatchResource::Create(num_batch_threads_, max_batch_size_,
-                                batch_timeout_micros_, max_enqueued_batches_,
-                                allowed_batch_sizes_, fhandle_, &new_resource));
+      TF_RETURN_IF_ERROR(BatchResource::Create(
+          num_batch_threads_, max_batch_size_, batch_timeout_micros_,
+          max_enqueued_batches_, target_latency_micros_, allowed_batch_sizes_,
+          fhandle_, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -770,6 +775,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
   int32 max_batch_size_;
   int32 batch_timeout_micros_;
   int32 max_enqueued_batches_;
+  int32 target_latency_micros_;
   std::vector<int32> allowed_batch_sizes_;
   FunctionLibraryRuntime::Handle fhandle_;
 };
@@ -794,6 +800,8 @@ class BatchKernel : public AsyncOpKernel {
                    c->GetAttr("batch_timeout_micros", &batch_timeout_micros_));
     OP_REQUIRES_OK(c,
                    c->GetAttr("max_enqueued_batches", &max_enqueued_batches_));
+    OP_REQUIRES_OK(c,
+                   c->GetAttr("target_latency_micros", &target_latency_micros_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
   }
@@ -804,8 +812,8 @@ class BatchKernel : public AsyncOpKernel {
       std::unique_ptr<BatchResource> new_resource;
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
-          max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle,
-          &new_resource));
+          max_enqueued_batches_, target_latency_micros_, allowed_batch_sizes_,
+          kInvalidHandle, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -850,6 +858,7 @@ class BatchKernel : public AsyncOpKernel {
   int32 max_batch_size_;
   int32 batch_timeout_micros_;
   int32 max_enqueued_batches_;
+  int32 target_latency_micros_;
   std::vector<int32> allowed_batch_sizes_;
 };
 
@@ -219,6 +219,35 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
         std::min(in_x.dim_size(1), in_x.dim_size(2)), out->dim_size(2));
     const int64 kMaxCostOuterParallelism = 128 * 128 * 256;  // heuristic.
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    // A batch of products against a single shared right-hand side is one
+    // large matrix product in disguise: with the batch and row dimensions of
+    // x flattened together, z = x * y computes every slice at once, and the
+    // threaded GEMM packs the shared y panels once for the whole batch
+    // instead of once per slice. This is the common projection shape (many
+    // small activations against one broadcast weight matrix), where the
+    // per-slice packing overhead dwarfs the arithmetic. Flattening requires
+    // adj_x == false so that the batch and row dimensions stay adjacent;
+    // vector products keep the sequential path below, which handles them
+    // better.
+    if (batch_size > 1 && bcast.y_batch_size() == 1 && !adj_x &&
+        in_x.dim_size(0) == batch_size &&
+        std::min(in_x.dim_size(2), out->dim_size(2)) > 1) {
+      const int64 flat_rows = batch_size * in_x.dim_size(1);
+      Tensor x_flat;
+      Tensor out_flat;
+      if (x_flat.CopyFrom(in_x, TensorShape({1, flat_rows, in_x.dim_size(2)})) &&
+          out_flat.CopyFrom(*out,
+                            TensorShape({1, flat_rows, out->dim_size(2)}))) {
+        MatMulBCast flat_bcast({1, flat_rows, in_x.dim_size(2)},
+                               {1, in_y.dim_size(1), in_y.dim_size(2)});
+        // adj_x is false here, so ParallelMatMulKernel conjugates y directly
+        // and no final conjugation of the result is needed for complex
+        // types.
+        ParallelMatMulKernel::Run(context, x_flat, in_y, /*adj_x=*/false,
+                                  adj_y, flat_bcast, &out_flat, 0, 1);
+        return;
+      }
+    }
     if (small_dim > 1 &&
         (batch_size == 1 || cost_per_unit > kMaxCostOuterParallelism)) {
       // Parallelize over inner dims.
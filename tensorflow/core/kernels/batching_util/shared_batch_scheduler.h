@@ -17,11 +17,13 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_SHARED_BATCH_SCHEDULER_H_
 
 #include <stddef.h>
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -158,6 +160,17 @@ class SharedBatchScheduler
     // See the class documentation above for guidelines on how to tune this
     // parameter.
     size_t max_enqueued_batches = 10;
+
+    // If positive, the queue adapts its effective batch size and timeout
+    // online so that the estimated p99 task latency (the time from
+    // Schedule() until the batch containing the task has been processed)
+    // tracks this target. When the estimate exceeds the target, the queue
+    // batches less aggressively; when there is latency headroom and tasks
+    // are queuing up, it batches more aggressively, up to 'max_batch_size'
+    // and 'batch_timeout_micros', which act as ceilings. This removes the
+    // need to re-tune the static parameters as traffic levels change over
+    // the day. Zero disables adaptation.
+    int64 target_latency_micros = 0;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -285,6 +298,12 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Folds the observed latency of a processed batch into the p99 estimate,
+  // and adjusts the effective batch size and timeout to steer the estimate
+  // toward 'options_.target_latency_micros'.
+  void UpdateAdaptiveParameters(uint64 observed_latency_micros)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -312,6 +331,25 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ GUARDED_BY(mu_);
 
+  // The start times of the closed batches in 'batches_', oldest first. Kept
+  // in sync with 'batches_': its size is always batches_.size() - 1.
+  std::deque<uint64> closed_batch_start_times_micros_ GUARDED_BY(mu_);
+
+  // The start times of batches handed out by ScheduleBatch() and not yet
+  // fully processed, keyed by batch.
+  std::unordered_map<const Batch<TaskType>*, uint64>
+      processing_batch_start_times_micros_ GUARDED_BY(mu_);
+
+  // The batch size and timeout currently in force. Equal to the configured
+  // values unless 'options_.target_latency_micros' is positive, in which
+  // case they are adjusted online by UpdateAdaptiveParameters().
+  size_t adaptive_max_batch_size_ GUARDED_BY(mu_);
+  int64 adaptive_batch_timeout_micros_ GUARDED_BY(mu_);
+
+  // A running estimate of the p99 task latency in microseconds, across the
+  // batches processed so far.
+  double estimated_p99_latency_micros_ GUARDED_BY(mu_) = 0;
+
   // Whether this queue contains a batch that is eligible to be scheduled. Used
   // to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ GUARDED_BY(mu_) = false;
@@ -408,6 +446,11 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
 
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
@@ -510,7 +553,9 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      adaptive_max_batch_size_(options.max_batch_size),
+      adaptive_batch_timeout_micros_(options.batch_timeout_micros) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
 }
@@ -526,6 +571,9 @@ Queue<TaskType>::~Queue() {
 
 template <typename TaskType>
 Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
+  // Tasks are validated against the configured maximum, not the adaptive
+  // one, so that shrinking the effective batch size never causes previously
+  // legal task sizes to be rejected.
   if ((*task)->size() > options_.max_batch_size) {
     return errors::InvalidArgument("Task size ", (*task)->size(),
                                    " is larger than maximum batch size ",
@@ -538,7 +586,11 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
+    // (The open batch can only be empty here if the task is larger than the
+    // adaptive batch size; in that case the task joins the open batch and is
+    // scheduled on its own, rather than closing an empty batch.)
+    if (!batches_.back()->empty() &&
+        batches_.back()->size() + (*task)->size() > adaptive_max_batch_size_) {
       if (batches_.size() >= options_.max_enqueued_batches) {
         return errors::Unavailable(
             "The batch scheduling queue to which this task was submitted is "
@@ -581,9 +633,11 @@ size_t Queue<TaskType>::SchedulingCapacity() const {
   mutex_lock l(mu_);
   const int num_new_batches_schedulable =
       options_.max_enqueued_batches - batches_.size();
-  const int open_batch_capacity =
-      options_.max_batch_size - batches_.back()->size();
-  return (num_new_batches_schedulable * options_.max_batch_size) +
+  // The open batch can exceed the adaptive maximum if it holds a single
+  // task larger than it; report zero capacity for it in that case.
+  const int open_batch_capacity = std::max<int>(
+      0, adaptive_max_batch_size_ - batches_.back()->size());
+  return (num_new_batches_schedulable * adaptive_max_batch_size_) +
          open_batch_capacity;
 }
 
@@ -606,6 +660,9 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+      processing_batch_start_times_micros_[batch_to_schedule.get()] =
+          closed_batch_start_times_micros_.front();
+      closed_batch_start_times_micros_.pop_front();
     } else {
       schedulable_batch_ = false;
     }
@@ -616,10 +673,29 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
 
 template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
+  uint64 batch_start_time_micros = 0;
+  bool have_batch_start_time = false;
+  {
+    mutex_lock l(mu_);
+    auto it = processing_batch_start_times_micros_.find(batch.get());
+    if (it != processing_batch_start_times_micros_.end()) {
+      batch_start_time_micros = it->second;
+      have_batch_start_time = true;
+      processing_batch_start_times_micros_.erase(it);
+    }
+  }
+  // The latency of the batch's oldest task spans both its time in the queue
+  // and its processing time, making it a good proxy for tail latency.
+  const bool observe_latency = options_.target_latency_micros > 0 &&
+                               have_batch_start_time && !batch->empty();
+
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (observe_latency) {
+      UpdateAdaptiveParameters(env_->NowMicros() - batch_start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -658,6 +734,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
   batches_.back()->Close();
+  closed_batch_start_times_micros_.push_back(open_batch_start_time_micros_);
   batches_.emplace_back(new Batch<TaskType>);
 }
 
@@ -667,9 +744,44 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= options_.max_batch_size ||
+  return closed_ || open_batch->size() >= adaptive_max_batch_size_ ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + adaptive_batch_timeout_micros_;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateAdaptiveParameters(
+    uint64 observed_latency_micros) {
+  // Stochastic update of the p99 estimate: a sample above the estimate pulls
+  // it up 99 times harder than a sample below pulls it down, so the estimate
+  // settles near the 99th percentile of the observed latencies.
+  const double kEstimatorStep = 0.05;
+  const double error =
+      static_cast<double>(observed_latency_micros) -
+      estimated_p99_latency_micros_;
+  estimated_p99_latency_micros_ +=
+      kEstimatorStep * (error > 0 ? 0.99 * error : 0.01 * error);
+
+  const double target = options_.target_latency_micros;
+  if (estimated_p99_latency_micros_ > target) {
+    // Over the latency target: batch less aggressively. Shrinking the
+    // timeout reduces time spent waiting in the queue; shrinking the batch
+    // size reduces the processing time of each batch.
+    adaptive_batch_timeout_micros_ =
+        static_cast<int64>(adaptive_batch_timeout_micros_ * 0.8);
+    adaptive_max_batch_size_ = std::max<size_t>(
+        1, static_cast<size_t>(adaptive_max_batch_size_ * 0.9));
+  } else if (estimated_p99_latency_micros_ < 0.8 * target &&
+             batches_.size() > 1) {
+    // Comfortably under the target while tasks are queuing up behind the
+    // open batch: batch more aggressively for throughput, up to the
+    // configured ceilings.
+    adaptive_max_batch_size_ =
+        std::min(options_.max_batch_size, adaptive_max_batch_size_ * 11 / 10 + 1);
+    adaptive_batch_timeout_micros_ =
+        std::min(options_.batch_timeout_micros,
+                 adaptive_batch_timeout_micros_ * 11 / 10 + 1);
+  }
 }
 
 template <typename TaskType>
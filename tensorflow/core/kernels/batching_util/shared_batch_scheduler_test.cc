@@ -591,6 +591,83 @@ TEST(SharedBatchSchedulerTest, QueueDestructorBlocksUntilAllTasksProcessed) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, AdaptsBatchSizeTowardLatencyTarget) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    mutex mu;
+    std::vector<std::vector<size_t>> batches;
+    auto callback = [&mu, &batches,
+                     &env](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      // Simulate slow processing, so that every observed latency lands far
+      // above the 1 microsecond target and the queue keeps shrinking its
+      // effective batch size.
+      env.AdvanceByMicroseconds(1000);
+      std::vector<size_t> sizes;
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        sizes.push_back(batch->task(i).size());
+      }
+      mutex_lock l(mu);
+      batches.push_back(sizes);
+    };
+    auto wait_for_batches = [&mu, &batches](size_t count) {
+      for (;;) {
+        {
+          mutex_lock l(mu);
+          if (batches.size() >= count) {
+            return;
+          }
+        }
+        Env::Default()->SleepForMicroseconds(100);
+      }
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 2;
+    queue_options.batch_timeout_micros = 1 * 1000 * 1000;  // 1 second
+    queue_options.max_enqueued_batches = 2;
+    queue_options.target_latency_micros = 1;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Fill up a batch, which gets scheduled right away. Its observed latency
+    // blows the target, so the effective batch size shrinks from 2 to 1.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    wait_for_batches(1);
+
+    // A single task now fills a (shrunken) batch, and gets processed without
+    // waiting out the 1 second timeout. (The fake clock only advances inside
+    // the process-batch callback, so the timeout can never fire on its own.)
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    wait_for_batches(2);
+
+    // A task bigger than the shrunken batch size but within the configured
+    // maximum is still accepted, and processed in a batch of its own.
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    wait_for_batches(3);
+
+    {
+      mutex_lock l(mu);
+      ASSERT_EQ(3, batches.size());
+      EXPECT_EQ((std::vector<size_t>{1, 1}), batches[0]);
+      EXPECT_EQ((std::vector<size_t>{1}), batches[1]);
+      EXPECT_EQ((std::vector<size_t>{2}), batches[2]);
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
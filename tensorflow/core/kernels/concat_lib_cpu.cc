@@ -20,23 +20,73 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/concat_lib.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace tensorflow {
 
 namespace {
+
+// Outputs at least this large use non-temporal stores for long spans: such
+// an output cannot stay resident in cache anyway, so bypassing the cache on
+// the store side avoids evicting lines that are still useful.
+const int64 kNonTemporalOutputBytes = 8 << 20;  // 8 MB
+
+// Only spans at least this long are streamed; shorter ones do not amortize
+// the alignment head/tail handling and the store fence.
+const size_t kNonTemporalSpanBytes = 4096;
+
+#if defined(__SSE2__)
+// Copies `bytes` bytes from src to dst with non-temporal (streaming) stores
+// for the aligned bulk of the destination.
+inline void NonTemporalCopy(char* dst, const char* src, size_t bytes) {
+  // Streaming stores require a 16-byte aligned destination.
+  const size_t head = std::min<size_t>(
+      bytes, (16 - reinterpret_cast<uintptr_t>(dst) % 16) % 16);
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  bytes -= head;
+  const size_t vec = bytes & ~size_t{15};
+  for (size_t i = 0; i < vec; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), v);
+  }
+  if (vec > 0) {
+    // Order the streaming stores before any subsequent reads of the output.
+    _mm_sfence();
+  }
+  memcpy(dst + vec, src + vec, bytes - vec);
+}
+#endif  // __SSE2__
+
 template <typename T>
 struct MemCpyCopier {
+  explicit MemCpyCopier(bool use_nt_stores) : use_nt_stores(use_nt_stores) {}
   inline void Copy(T* dst, const T* src, int input_index, size_t n) {
     if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
-      memcpy(dst, src, n * sizeof(T));
+      const size_t bytes = n * sizeof(T);
+#if defined(__SSE2__)
+      if (use_nt_stores && bytes >= kNonTemporalSpanBytes) {
+        NonTemporalCopy(reinterpret_cast<char*>(dst),
+                        reinterpret_cast<const char*>(src), bytes);
+        return;
+      }
+#endif  // __SSE2__
+      memcpy(dst, src, bytes);
     } else {
       for (size_t k = 0; k < n; ++k) {
         *dst++ = *src++;
       }
     }
   }
+  bool use_nt_stores;
 };
 template <>
 struct MemCpyCopier<ResourceHandle> {
+  explicit MemCpyCopier(bool use_nt_stores) {}
   inline void Copy(ResourceHandle* dst, const ResourceHandle* src,
                    int input_index, size_t n) {
     for (size_t k = 0; k < n; ++k) {
@@ -55,10 +105,14 @@ void ConcatCPU(
     typename TTypes<T, 2>::Matrix* output) {
   if (std::is_same<T, string>::value) {
     // use a large cost here to force strings to be handled by separate threads
-    ConcatCPUImpl<T>(d, inputs, 100000, MemCpyCopier<T>(), output);
+    ConcatCPUImpl<T>(d, inputs, 100000, MemCpyCopier<T>(/*use_nt_stores=*/false),
+                     output);
   } else {
+    const bool use_nt_stores =
+        output->size() * static_cast<int64>(sizeof(T)) >=
+        kNonTemporalOutputBytes;
     ConcatCPUImpl<T>(d, inputs, sizeof(T) /* cost_per_unit */,
-                     MemCpyCopier<T>(), output);
+                     MemCpyCopier<T>(use_nt_stores), output);
   }
 }
 
@@ -91,8 +145,8 @@ void ConcatSYCL(
     const std::vector<std::unique_ptr<typename TTypes<T, 2>::ConstMatrix>>&
         inputs,
     typename TTypes<T, 2>::Matrix* output) {
-  ConcatSYCLImpl<T>(d, inputs, sizeof(T) /* cost_per_unit */, MemCpyCopier<T>(),
-                    output);
+  ConcatSYCLImpl<T>(d, inputs, sizeof(T) /* cost_per_unit */,
+                    MemCpyCopier<T>(/*use_nt_stores=*/false), output);
 }
 #define REGISTER_SYCL(T)                                                       \
   template void ConcatSYCL<T>(                                                 \
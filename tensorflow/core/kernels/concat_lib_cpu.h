@@ -74,59 +74,60 @@ void ConcatCPUImpl(
     return;
   }
 
-  // Sharded mode.
-  auto work = [&row_size, &sizes, &inputs, &output, &copier, &num_inputs](
-                  int64 start, int64 end) {
-    int64 skipped_rows = start / row_size;
-    T* out = output->data() + skipped_rows * row_size;
-    T* out_start = output->data() + start;
-    T* out_end = output->data() + end;
-
-    // Handle partial row at start
-    if (out < out_start) {
-      for (size_t j = 0; j < num_inputs; ++j) {
-        ptrdiff_t size = sizes[j];
-        ptrdiff_t offset = out_start - out;
-        if (size <= offset) {
-          out += size;
-          continue;
-        }
-        const T* inp = &(*inputs[j])(skipped_rows, 0);
-        if (offset > 0) {
-          out += offset;
-          inp += offset;
-          size -= offset;
-        }
-        size = std::min(size, out_end - out);
-        if (size <= 0) break;
-        copier.Copy(out, inp, j, size);
-        out += size;
-      }
-      ++skipped_rows;
-    }
-    if (out == out_end) return;
-    CHECK(out >= out_start);
-    CHECK(out < out_end);
+  // Sharded mode: build a copy plan. Every input is contiguous in memory, so
+  // the work is split into chunks of consecutive rows of a single input,
+  // sized to roughly equal cost regardless of how narrow each input is, and
+  // the chunks are executed across the intra-op pool. Each chunk writes a
+  // disjoint strided span of the output, so no synchronization is needed.
+  struct CopyChunk {
+    int input_index;
+    int64 row_start;
+    int64 row_limit;
+  };
+  // Target cost of one chunk; at sizeof(T) cost per element this is roughly
+  // a 256KB copy of floats. Small enough to balance load across the pool,
+  // large enough that per-chunk bookkeeping is negligible.
+  const int64 kTargetChunkCost = 1 << 20;
 
-    // Copy remaining data.
-    std::vector<const T*> inp;
-    inp.reserve(num_inputs);
-    for (const auto& input : inputs) {
-      inp.push_back(&(*input)(skipped_rows, 0));
+  const int64 dim0 = output->dimension(0);
+  std::vector<int64> col_start(num_inputs);
+  int64 col = 0;
+  for (size_t j = 0; j < num_inputs; ++j) {
+    col_start[j] = col;
+    col += sizes[j];
+  }
+
+  std::vector<CopyChunk> plan;
+  for (size_t j = 0; j < num_inputs; ++j) {
+    const int64 row_cost = std::max<int64>(1, sizes[j] * cost_per_unit);
+    const int64 rows_per_chunk =
+        std::max<int64>(1, kTargetChunkCost / row_cost);
+    for (int64 row = 0; row < dim0; row += rows_per_chunk) {
+      CopyChunk chunk;
+      chunk.input_index = static_cast<int>(j);
+      chunk.row_start = row;
+      chunk.row_limit = std::min(dim0, row + rows_per_chunk);
+      plan.push_back(chunk);
     }
-    const int64 dim0 = output->dimension(0);
-    for (int64 i = skipped_rows; i < dim0; ++i) {
-      for (int64 j = 0; j < num_inputs; ++j) {
-        ptrdiff_t size = std::min(sizes[j], out_end - out);
-        copier.Copy(out, inp[j], j, size);
-        out += size;
-        inp[j] += size;
-        if (out == out_end) return;
+  }
+
+  auto work = [&plan, &sizes, &col_start, &inputs, &output, &copier, row_size](
+                  int64 start, int64 limit) {
+    for (int64 c = start; c < limit; ++c) {
+      const CopyChunk& chunk = plan[c];
+      const ptrdiff_t size = sizes[chunk.input_index];
+      const T* inp = &(*inputs[chunk.input_index])(chunk.row_start, 0);
+      T* out = output->data() + chunk.row_start * row_size +
+               col_start[chunk.input_index];
+      for (int64 i = chunk.row_start; i < chunk.row_limit; ++i) {
+        copier.Copy(out, inp, chunk.input_index, size);
+        out += row_size;
+        inp += size;
       }
     }
   };
-  Shard(worker_threads->num_threads, worker_threads->workers, output->size(),
-        cost_per_unit, work);
+  Shard(worker_threads->num_threads, worker_threads->workers, plan.size(),
+        kTargetChunkCost, work);
 }
 
 #ifdef TENSORFLOW_USE_SYCL
@@ -23,6 +23,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/constant_op.h"
 
+#include <unordered_map>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -34,7 +36,10 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
@@ -65,11 +70,106 @@ std::unique_ptr<const NodeDef> StripTensorDataFromNodeDef(
   return std::unique_ptr<const NodeDef>(ret);
 }
 
+// Process-wide store of immutable host constant tensors, content-addressed
+// by a fingerprint of dtype, shape and buffer bytes.  Sessions build their
+// own ConstantOp kernels, so identical constants in related models are
+// otherwise materialized once per session; when
+// TF_CONST_TENSOR_SHARING=1 is set, those kernels share one buffer through
+// this store instead.
+//
+// Sharing is safe because Const outputs are already reused across Run calls
+// of one session, so nothing may mutate them, and the store's own reference
+// keeps the buffer's refcount above one, which stops downstream kernels from
+// forwarding it as an in-place output.  An entry is dropped when the last
+// kernel referencing it is destroyed.
+class ConstTensorStore {
+ public:
+  // Returns true iff TF_CONST_TENSOR_SHARING=1 is set in the environment.
+  static bool IsEnabled() {
+    static const bool enabled = []() {
+      bool val = false;
+      Status status = ReadBoolFromEnvVar("TF_CONST_TENSOR_SHARING", false,
+                                         &val);
+      if (!status.ok()) {
+        LOG(ERROR) << status.error_message();
+        return false;
+      }
+      return val;
+    }();
+    return enabled;
+  }
+
+  static ConstTensorStore* Global() {
+    static ConstTensorStore* store = new ConstTensorStore;
+    return store;
+  }
+
+  // If the store holds a tensor identical to *tensor, repoints *tensor at
+  // the shared copy; otherwise inserts *tensor.  In both cases the entry's
+  // refcount is incremented, *fingerprint is set, and true is returned; the
+  // caller must balance with Release().  Returns false, leaving *tensor
+  // untouched, for tensors the store does not handle (non-POD element types,
+  // empty tensors, or a fingerprint collision with a different tensor).
+  bool Deduplicate(Tensor* tensor, uint64* fingerprint) {
+    if (!DataTypeCanUseMemcpy(tensor->dtype()) || tensor->NumElements() == 0) {
+      return false;
+    }
+    const StringPiece data = tensor->tensor_data();
+    uint64 fp = Hash64Combine(Hash64(data.data(), data.size()),
+                              static_cast<uint64>(tensor->dtype()));
+    for (int d = 0; d < tensor->dims(); ++d) {
+      fp = Hash64Combine(fp, static_cast<uint64>(tensor->dim_size(d)));
+    }
+    mutex_lock l(mu_);
+    auto it = entries_.find(fp);
+    if (it == entries_.end()) {
+      entries_.emplace(fp, Entry{*tensor, 1});
+      *fingerprint = fp;
+      return true;
+    }
+    Entry& entry = it->second;
+    if (entry.tensor.dtype() != tensor->dtype() ||
+        entry.tensor.shape() != tensor->shape() ||
+        entry.tensor.tensor_data() != data) {
+      // Fingerprint collision between different tensors; leave this one
+      // unshared rather than chaining entries for a vanishingly rare case.
+      return false;
+    }
+    ++entry.refs;
+    *tensor = entry.tensor;
+    *fingerprint = fp;
+    return true;
+  }
+
+  void Release(uint64 fingerprint) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(fingerprint);
+    if (it != entries_.end() && --it->second.refs == 0) {
+      entries_.erase(it);
+    }
+  }
+
+ private:
+  ConstTensorStore() {}
+
+  struct Entry {
+    Tensor tensor;
+    int64 refs;
+  };
+
+  mutex mu_;
+  std::unordered_map<uint64, Entry> entries_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ConstTensorStore);
+};
+
 }  // namespace
 
 ConstantOp::ConstantOp(OpKernelConstruction* ctx)
     : OpKernel(ctx, StripTensorDataFromNodeDef(ctx)),
-      tensor_(ctx->output_type(0)) {
+      tensor_(ctx->output_type(0)),
+      shared_in_store_(false),
+      store_fingerprint_(0) {
   const TensorProto* proto = nullptr;
   OP_REQUIRES_OK(ctx, ctx->GetAttr("value", &proto));
   OP_REQUIRES_OK(ctx, ctx->device()->MakeTensorFromProto(
@@ -79,6 +179,13 @@ ConstantOp::ConstantOp(OpKernelConstruction* ctx)
       errors::InvalidArgument("Type mismatch between value (",
                               DataTypeString(tensor_.dtype()), ") and dtype (",
                               DataTypeString(ctx->output_type(0)), ")"));
+  // Only host tensors can share buffers through the store; device kernels
+  // have already copied the value into device memory above.
+  if (ctx->device_type() == DeviceType(DEVICE_CPU) &&
+      ConstTensorStore::IsEnabled()) {
+    shared_in_store_ =
+        ConstTensorStore::Global()->Deduplicate(&tensor_, &store_fingerprint_);
+  }
 }
 
 void ConstantOp::Compute(OpKernelContext* ctx) {
@@ -88,7 +195,11 @@ void ConstantOp::Compute(OpKernelContext* ctx) {
   }
 }
 
-ConstantOp::~ConstantOp() {}
+ConstantOp::~ConstantOp() {
+  if (shared_in_store_) {
+    ConstTensorStore::Global()->Release(store_fingerprint_);
+  }
+}
 
 REGISTER_KERNEL_BUILDER(Name("Const").Device(DEVICE_CPU), ConstantOp);
 
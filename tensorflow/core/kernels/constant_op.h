@@ -33,6 +33,10 @@ class ConstantOp : public OpKernel {
 
  private:
   Tensor tensor_;
+  // Set when tensor_ is shared through the process-wide constant store, in
+  // which case the destructor must drop the store's reference.
+  bool shared_in_store_;
+  uint64 store_fingerprint_;
   TF_DISALLOW_COPY_AND_ASSIGN(ConstantOp);
 };
 
@@ -51,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/conv_2d.h"
 #include "tensorflow/core/kernels/conv_ops.h"
+#include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -96,146 +97,6 @@ struct LaunchFusedConv2DOp {
                   const Conv2DDimensions& dimensions, Tensor* output);
 };
 
-// Type aliases for the unaligned tensors (tensor maps) used in output kernels.
-template <typename T>
-struct Unaligned {
-  // There is no guarantee that the output block passed to the output kernel
-  // will be aligned.
-
-  using Tensor =
-      Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor, Eigen::DenseIndex>,
-                       Eigen::Unaligned>;
-
-  using ConstTensor = Eigen::TensorMap<
-      Eigen::Tensor<const T, 1, Eigen::RowMajor, Eigen::DenseIndex>,
-      Eigen::Unaligned>;
-};
-
-// Type alias for the tensor contraction output mapper.
-template <typename Scalar, typename Index>
-using ContractionOutputMapper =
-    Eigen::internal::blas_data_mapper<Scalar, Index, Eigen::ColMajor>;
-
-// Returns input expression without any transformations.
-struct Identity {
-  template <typename XprType>
-  static auto apply(XprType expr) -> XprType {
-    return expr;
-  };
-};
-
-// Applies `Relu` to the passed input expression.
-struct Relu {
-  template <typename XprType>
-  static auto apply(XprType expr)
-      -> decltype(expr.cwiseMax(std::declval<typename XprType::Scalar>())) {
-    return expr.cwiseMax(static_cast<typename XprType::Scalar>(0));
-  };
-};
-
-// TensorContraction swaps lhs with rhs, and changes layout from RowMajor
-// (default in Tensorflow) to ColMajor (preferred in Eigen), and computes matmul
-// using these tensors.
-//
-// TensorContraction output matrix (before reshape) has a ColMajor layout, and
-// has dimensions:
-//  - rows: output_channels
-//  - cols: all other dimensions
-//
-// First element in every column is:
-//   [batch ??, height ??, width ??, out_channel = i]
-//
-// We do not know what are the values of the 'batch', 'height', and 'width' here
-// (if we know original dimensions, they can be computed from 'j').
-//
-// Each column of an output block is a continuous slice along the output channel
-// dimension, so we can use it to efficiently compute any transformation that
-// depends only on a channel value (e.g. add channel bias).
-
-// Output kernel that fuses BiasAdd operation into the output of tensor
-// contraction + activation function defined by Activation.
-template <typename T, typename Activation = Identity>
-struct BiasAddOutputKernel {
-  explicit BiasAddOutputKernel(const T* bias_data) : bias_data(bias_data) {}
-
-  template <typename Index, typename Scalar>
-  EIGEN_ALWAYS_INLINE void operator()(
-      const ContractionOutputMapper<Scalar, Index>& output_mapper,
-      const Eigen::TensorContractionParams& params, Index i, Index j,
-      Index num_rows, Index num_cols) const {
-    DCHECK(params.swapped_arguments);
-
-    const T* bias_base = bias_data + i;
-    typename Unaligned<T>::ConstTensor bias(bias_base, num_rows);
-
-    for (int col = 0; col < num_cols; ++col) {
-      T* output_base = &output_mapper(0, col);
-      typename Unaligned<T>::Tensor output(output_base, num_rows);
-      const auto expr = output + bias;
-      output = Activation::template apply<decltype(expr)>(expr);
-    }
-  }
-
- private:
-  const T* bias_data;
-};
-
-// Output kernel that fuses FusedBatchNorm operation into the output of tensor
-// contraction + activation function defined by Activation.
-template <typename T, typename Activation = Identity>
-struct FusedBatchNormOutputKernel {
-  FusedBatchNormOutputKernel(T epsilon, const T* scaling_factor_data,
-                             const T* offset_data, const T* estimated_mean_data)
-      : epsilon(epsilon),
-        scaling_factor_data(scaling_factor_data),
-        offset_data(offset_data),
-        estimated_mean_data(estimated_mean_data) {}
-
-  template <typename Index, typename Scalar>
-  EIGEN_ALWAYS_INLINE void operator()(
-      const ContractionOutputMapper<Scalar, Index>& output_mapper,
-      const Eigen::TensorContractionParams& params, Index i, Index j,
-      Index num_rows, Index num_cols) const {
-    DCHECK(params.swapped_arguments);
-
-    const T* scaling_factor_base = scaling_factor_data + i;
-    const T* offset_base = offset_data + i;
-    const T* mean_base = estimated_mean_data + i;
-
-    typename Unaligned<T>::ConstTensor scaling_factor(scaling_factor_base,
-                                                      num_rows);
-    typename Unaligned<T>::ConstTensor offset(offset_base, num_rows);
-    typename Unaligned<T>::ConstTensor mean(mean_base, num_rows);
-
-    for (int col = 0; col < num_cols; ++col) {
-      T* output_base = &output_mapper(0, col);
-      typename Unaligned<T>::Tensor output(output_base, num_rows);
-
-      auto scaled = (output - mean) * scaling_factor;
-      auto shifted = scaled + offset;
-
-      output = Activation::template apply<decltype(shifted)>(shifted);
-    }
-  }
-
- private:
-  T epsilon;
-  const T* scaling_factor_data;
-  const T* offset_data;
-  const T* estimated_mean_data;
-};
-
-// Type aliases for the output kernels, purely for the sake of better launch
-// dispatching code readability.
-template <typename T>
-using WithBiasAdd = BiasAddOutputKernel<T>;
-template <typename T>
-using WithBiasAddAndRelu = BiasAddOutputKernel<T, Relu>;
-template <typename T>
-using WithFusedBatchNorm = FusedBatchNormOutputKernel<T>;
-template <typename T>
-using WithFusedBatchNormAndRelu = FusedBatchNormOutputKernel<T, Relu>;
-
 // This is CPU-only implementation that uses Eigen contraction output kernels.
 //
 // Dispatch 2D convolution to the appropriate primitive operation:
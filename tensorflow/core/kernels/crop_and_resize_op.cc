@@ -21,6 +21,8 @@ limitations under the License.
 
 #include <functional>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -116,6 +118,21 @@ class CropAndResizeOp : public AsyncOpKernel {
                     "method must be 'bilinear' or 'nearest'", method_));
     OP_REQUIRES_OK(context, context->GetAttr("extrapolation_value",
                                              &extrapolation_value_));
+    OP_REQUIRES_OK(context, context->GetAttr("normalization_mean",
+                                             &normalization_mean_));
+    OP_REQUIRES_OK(
+        context, context->GetAttr("normalization_std", &normalization_std_));
+    OP_REQUIRES(
+        context, normalization_mean_.size() == normalization_std_.size(),
+        errors::InvalidArgument(
+            "normalization_mean and normalization_std must have the same "
+            "number of elements, got ",
+            normalization_mean_.size(), " and ", normalization_std_.size()));
+    for (const float std_value : normalization_std_) {
+      OP_REQUIRES(context, std_value != 0,
+                  errors::InvalidArgument(
+                      "normalization_std must not contain zeros"));
+    }
   }
 
   void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
@@ -163,6 +180,21 @@ class CropAndResizeOp : public AsyncOpKernel {
         context, crop_height > 0 && crop_width > 0,
         errors::InvalidArgument("crop dimensions must be positive"), done);
 
+    OP_REQUIRES_ASYNC(
+        context,
+        normalization_mean_.empty() ||
+            static_cast<int>(normalization_mean_.size()) == depth,
+        errors::InvalidArgument(
+            "normalization_mean must have one value per channel, got ",
+            normalization_mean_.size(), " values for depth ", depth),
+        done);
+    OP_REQUIRES_ASYNC(
+        context,
+        normalization_mean_.empty() || !std::is_same<Device, GPUDevice>::value,
+        errors::Unimplemented(
+            "normalization_mean/normalization_std are only supported on CPU"),
+        done);
+
     // Allocate output tensor.
     Tensor* output = nullptr;
     OP_REQUIRES_OK_ASYNC(
@@ -179,6 +211,7 @@ class CropAndResizeOp : public AsyncOpKernel {
       const bool status = functor::CropAndResize<Device, T>()(
           context, image.tensor<T, 4>(), boxes.tensor<float, 2>(),
           box_index.tensor<int32, 1>(), method_, extrapolation_value_,
+          normalization_mean_, normalization_std_,
           output->tensor<float, 4>());
 
       if (!status) {
@@ -195,6 +228,8 @@ class CropAndResizeOp : public AsyncOpKernel {
  private:
   float extrapolation_value_;
   string method_;
+  std::vector<float> normalization_mean_;
+  std::vector<float> normalization_std_;
 };
 
 // Partial specialization of CropAndResize functor for a CPUDevice.
@@ -206,6 +241,8 @@ struct CropAndResize<CPUDevice, T> {
                   typename TTypes<float, 2>::ConstTensor boxes,
                   typename TTypes<int32, 1>::ConstTensor box_index,
                   const string& method_name, float extrapolation_value,
+                  const std::vector<float>& normalization_mean,
+                  const std::vector<float>& normalization_std,
                   typename TTypes<float, 4>::Tensor crops) {
     const int batch_size = image.dimension(0);
     const int image_height = image.dimension(1);
@@ -216,9 +253,47 @@ struct CropAndResize<CPUDevice, T> {
     const int crop_width = crops.dimension(2);
     const int depth = crops.dimension(3);
 
-    // Sharding across boxes.
-    auto CropAndResizePerBox = [&](int start_box, int limit_box) {
-      for (int b = start_box; b < limit_box; ++b) {
+    const bool use_bilinear = (method_name == "bilinear");
+    const bool normalize = !normalization_mean.empty();
+
+    // Rewrite (value - mean) / std as value * scale + shift so the fused
+    // normalization is a single multiply-add per output element.  The
+    // extrapolation fill is normalized the same way, so the whole output
+    // tensor is on the normalized scale.
+    std::vector<float> norm_scale(depth, 1.0f);
+    std::vector<float> norm_shift(depth, 0.0f);
+    std::vector<float> extrapolation(depth, extrapolation_value);
+    if (normalize) {
+      for (int d = 0; d < depth; ++d) {
+        norm_scale[d] = 1.0f / normalization_std[d];
+        norm_shift[d] = -normalization_mean[d] / normalization_std[d];
+        extrapolation[d] =
+            extrapolation_value * norm_scale[d] + norm_shift[d];
+      }
+    }
+
+    const T* image_data = image.data();
+    float* crops_data = crops.data();
+    const int64 image_row_elements = static_cast<int64>(image_width) * depth;
+    const int64 image_slice_elements =
+        static_cast<int64>(image_height) * image_row_elements;
+    const int64 crop_row_elements = static_cast<int64>(crop_width) * depth;
+
+    // Sharding across output rows rather than boxes, so that small crops
+    // from many boxes still spread across the pool.  Shards see contiguous
+    // row ranges, so the horizontal sampling coordinates of a box are
+    // computed once and reused for all of its rows within a shard.
+    auto CropAndResizePerRow = [&](int64 start_row, int64 limit_row) {
+      int64 cached_box = -1;
+      std::vector<int> left_x_index(crop_width);
+      std::vector<int> right_x_index(crop_width);
+      std::vector<float> x_lerp(crop_width);
+      std::vector<char> x_in_bounds(crop_width);
+
+      for (int64 row = start_row; row < limit_row; ++row) {
+        const int64 b = row / crop_height;
+        const int y = static_cast<int>(row % crop_height);
+
         const float y1 = boxes(b, 0);
         const float x1 = boxes(b, 1);
         const float y2 = boxes(b, 2);
@@ -237,93 +312,130 @@ struct CropAndResize<CPUDevice, T> {
             (crop_width > 1) ? (x2 - x1) * (image_width - 1) / (crop_width - 1)
                              : 0;
 
-        for (int y = 0; y < crop_height; ++y) {
-          const float in_y = (crop_height > 1)
-                                 ? y1 * (image_height - 1) + y * height_scale
-                                 : 0.5 * (y1 + y2) * (image_height - 1);
-          if (in_y < 0 || in_y > image_height - 1) {
-            for (int x = 0; x < crop_width; ++x) {
-              for (int d = 0; d < depth; ++d) {
-                crops(b, y, x, d) = extrapolation_value;
-              }
+        if (b != cached_box) {
+          for (int x = 0; x < crop_width; ++x) {
+            const float in_x = (crop_width > 1)
+                                   ? x1 * (image_width - 1) + x * width_scale
+                                   : 0.5 * (x1 + x2) * (image_width - 1);
+            x_in_bounds[x] = (in_x >= 0 && in_x <= image_width - 1);
+            if (!x_in_bounds[x]) {
+              continue;
+            }
+            if (use_bilinear) {
+              left_x_index[x] = floorf(in_x);
+              right_x_index[x] = ceilf(in_x);
+              x_lerp[x] = in_x - left_x_index[x];
+            } else {
+              left_x_index[x] = roundf(in_x);
             }
-            continue;
           }
-          if (method_name == "bilinear") {
-            const int top_y_index = floorf(in_y);
-            const int bottom_y_index = ceilf(in_y);
-            const float y_lerp = in_y - top_y_index;
-
-            for (int x = 0; x < crop_width; ++x) {
-              const float in_x = (crop_width > 1)
-                                     ? x1 * (image_width - 1) + x * width_scale
-                                     : 0.5 * (x1 + x2) * (image_width - 1);
-              if (in_x < 0 || in_x > image_width - 1) {
-                for (int d = 0; d < depth; ++d) {
-                  crops(b, y, x, d) = extrapolation_value;
-                }
-                continue;
-              }
-              const int left_x_index = floorf(in_x);
-              const int right_x_index = ceilf(in_x);
-              const float x_lerp = in_x - left_x_index;
+          cached_box = b;
+        }
 
+        float* crops_row = crops_data + row * crop_row_elements;
+        const float in_y = (crop_height > 1)
+                               ? y1 * (image_height - 1) + y * height_scale
+                               : 0.5 * (y1 + y2) * (image_height - 1);
+        if (in_y < 0 || in_y > image_height - 1) {
+          for (int x = 0; x < crop_width; ++x) {
+            for (int d = 0; d < depth; ++d) {
+              crops_row[x * depth + d] = extrapolation[d];
+            }
+          }
+          continue;
+        }
+        const T* image_slice = image_data + b_in * image_slice_elements;
+        if (use_bilinear) {
+          const int top_y_index = floorf(in_y);
+          const int bottom_y_index = ceilf(in_y);
+          const float y_lerp = in_y - top_y_index;
+          const T* top_row = image_slice + top_y_index * image_row_elements;
+          const T* bottom_row =
+              image_slice + bottom_y_index * image_row_elements;
+
+          for (int x = 0; x < crop_width; ++x) {
+            float* crops_pixel = crops_row + x * depth;
+            if (!x_in_bounds[x]) {
               for (int d = 0; d < depth; ++d) {
-                const float top_left(static_cast<float>(
-                    image(b_in, top_y_index, left_x_index, d)));
-                const float top_right(static_cast<float>(
-                    image(b_in, top_y_index, right_x_index, d)));
-                const float bottom_left(static_cast<float>(
-                    image(b_in, bottom_y_index, left_x_index, d)));
-                const float bottom_right(static_cast<float>(
-                    image(b_in, bottom_y_index, right_x_index, d)));
-                const float top = top_left + (top_right - top_left) * x_lerp;
-                const float bottom =
-                    bottom_left + (bottom_right - bottom_left) * x_lerp;
-                crops(b, y, x, d) = top + (bottom - top) * y_lerp;
+                crops_pixel[d] = extrapolation[d];
               }
+              continue;
             }
-          } else {  // method == "nearest"
-            for (int x = 0; x < crop_width; ++x) {
-              const float in_x = (crop_width > 1)
-                                     ? x1 * (image_width - 1) + x * width_scale
-                                     : 0.5 * (x1 + x2) * (image_width - 1);
-              if (in_x < 0 || in_x > image_width - 1) {
-                for (int d = 0; d < depth; ++d) {
-                  crops(b, y, x, d) = extrapolation_value;
-                }
-                continue;
+            // The four corner pixels are contiguous depth vectors, so the
+            // interpolation below vectorizes along the channel dimension.
+            const T* top_left = top_row + left_x_index[x] * depth;
+            const T* top_right = top_row + right_x_index[x] * depth;
+            const T* bottom_left = bottom_row + left_x_index[x] * depth;
+            const T* bottom_right = bottom_row + right_x_index[x] * depth;
+            const float lerp = x_lerp[x];
+
+            for (int d = 0; d < depth; ++d) {
+              const float top_left_value(static_cast<float>(top_left[d]));
+              const float top_right_value(static_cast<float>(top_right[d]));
+              const float bottom_left_value(
+                  static_cast<float>(bottom_left[d]));
+              const float bottom_right_value(
+                  static_cast<float>(bottom_right[d]));
+              const float top =
+                  top_left_value + (top_right_value - top_left_value) * lerp;
+              const float bottom =
+                  bottom_left_value +
+                  (bottom_right_value - bottom_left_value) * lerp;
+              float result = top + (bottom - top) * y_lerp;
+              if (normalize) {
+                result = result * norm_scale[d] + norm_shift[d];
               }
-              const int closest_x_index = roundf(in_x);
-              const int closest_y_index = roundf(in_y);
+              crops_pixel[d] = result;
+            }
+          }
+        } else {  // method == "nearest"
+          const int closest_y_index = roundf(in_y);
+          const T* image_row =
+              image_slice + closest_y_index * image_row_elements;
+          for (int x = 0; x < crop_width; ++x) {
+            float* crops_pixel = crops_row + x * depth;
+            if (!x_in_bounds[x]) {
               for (int d = 0; d < depth; ++d) {
-                crops(b, y, x, d) = static_cast<float>(
-                    image(b_in, closest_y_index, closest_x_index, d));
+                crops_pixel[d] = extrapolation[d];
               }
+              continue;
+            }
+            const T* closest_pixel = image_row + left_x_index[x] * depth;
+            for (int d = 0; d < depth; ++d) {
+              float result = static_cast<float>(closest_pixel[d]);
+              if (normalize) {
+                result = result * norm_scale[d] + norm_shift[d];
+              }
+              crops_pixel[d] = result;
             }
           }
         }
       }
     };
 
-    // A rough estimation of the cost for each cropped box.
+    // A rough estimation of the cost for each cropped output row.
     double cost_per_pixel =
         depth * (Eigen::TensorOpCost::AddCost<float>() * 6 +
                  Eigen::TensorOpCost::MulCost<float>() * 3 +
                  Eigen::TensorOpCost::CastCost<T, float>() * 4) +
         (Eigen::TensorOpCost::AddCost<float>() * 2 +
          Eigen::TensorOpCost::AddCost<float>() * 3);
-    if (method_name == "nearest") {
+    if (!use_bilinear) {
       cost_per_pixel = depth * Eigen::TensorOpCost::CastCost<T, float>() +
                        Eigen::TensorOpCost::AddCost<float>() * 4 +
                        Eigen::TensorOpCost::MulCost<float>() * 4;
     }
-    const double cost_per_box = crop_height * crop_width * cost_per_pixel;
+    if (normalize) {
+      cost_per_pixel += depth * (Eigen::TensorOpCost::AddCost<float>() +
+                                 Eigen::TensorOpCost::MulCost<float>());
+    }
+    const double cost_per_row = crop_width * cost_per_pixel;
 
+    const int64 total_rows = static_cast<int64>(num_boxes) * crop_height;
     const DeviceBase::CpuWorkerThreads& worker_threads =
         *(context->device()->tensorflow_cpu_worker_threads());
-    Shard(worker_threads.num_threads, worker_threads.workers, num_boxes,
-          cost_per_box, CropAndResizePerBox);
+    Shard(worker_threads.num_threads, worker_threads.workers, total_rows,
+          cost_per_row, CropAndResizePerRow);
 
     return true;
   }
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_CROP_AND_RESIZE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_CROP_AND_RESIZE_OP_H_
 
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -26,12 +28,17 @@ namespace functor {
 
 template <typename Device, typename T>
 struct CropAndResize {
-  // We assume that the tensor sizes are correct.
+  // We assume that the tensor sizes are correct.  When non-empty,
+  // normalization_mean and normalization_std hold one value per image
+  // channel and the sampled output is rewritten as
+  // (value - mean) / std before it is stored.
   bool operator()(const OpKernelContext* context,
                   typename TTypes<T, 4>::ConstTensor image,
                   typename TTypes<float, 2>::ConstTensor boxes,
                   typename TTypes<int32, 1>::ConstTensor box_ind,
                   const string& method_name, float extrapolation_value,
+                  const std::vector<float>& normalization_mean,
+                  const std::vector<float>& normalization_std,
                   typename TTypes<float, 4>::Tensor crops);
 };
 
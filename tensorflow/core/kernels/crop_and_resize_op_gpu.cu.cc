@@ -351,7 +351,14 @@ struct CropAndResize<GPUDevice, T> {
                   typename TTypes<float, 2>::ConstTensor boxes,
                   typename TTypes<int32, 1>::ConstTensor box_ind,
                   const string& method_name, float extrapolation_value,
+                  const std::vector<float>& normalization_mean,
+                  const std::vector<float>& normalization_std,
                   typename TTypes<float, 4>::Tensor crops) {
+    // Fused normalization is CPU-only; the kernel rejects non-empty
+    // normalization attrs before this functor is reached.
+    if (!normalization_mean.empty() || !normalization_std.empty()) {
+      return false;
+    }
     const int batch = image.dimension(0);
     const int image_height = image.dimension(1);
     const int image_width = image.dimension(2);
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <vector>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -45,6 +47,23 @@ class CropAndResizeOpTest : public OpsTestBase {
                      .Finalize(node_def()));
     TF_EXPECT_OK(InitOp());
   }
+
+  template <typename T>
+  void MakeNormalizedOp(float extrapolation_value, const string& method,
+                        const std::vector<float>& normalization_mean,
+                        const std::vector<float>& normalization_std) {
+    TF_EXPECT_OK(NodeDefBuilder("crop_and_resize_op", "CropAndResize")
+                     .Input(FakeInput(DataTypeToEnum<T>::value))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("extrapolation_value", extrapolation_value)
+                     .Attr("method", method)
+                     .Attr("normalization_mean", normalization_mean)
+                     .Attr("normalization_std", normalization_std)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
 };
 
 #define REGISTER_TEST(T)                                               \
@@ -373,6 +392,59 @@ TEST_F(CropAndResizeOpTest, TestCropAndResize2x2To3x3NoCrop) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(CropAndResizeOpTest, TestCropAndResize2x2To1x1Normalized) {
+  MakeNormalizedOp<float>(0, "bilinear", {2.0f}, {0.5f});
+  // Input:
+  //  1, 2
+  //  3, 4
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 1, 1, 1}));
+  // The bilinear sample is 2.5; normalized: (2.5 - 2.0) / 0.5 = 1.0.
+  test::FillValues<float>(&expected, {1.0});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(CropAndResizeOpTest, TestCropAndResize2x2To3x3ExtrapolatedNormalized) {
+  MakeNormalizedOp<float>(-1, "bilinear", {1.0f}, {2.0f});
+  // Input:
+  //  1, 2
+  //  3, 4
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 4}), {-1, -1, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 3});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The extrapolation value is normalized too: (-1 - 1) / 2 = -1.
+  const float v = -1;
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 3, 3, 1}));
+  // clang-format off
+  test::FillValues<float>(&expected,
+    {v,  v,    v,
+     v,  0,  0.5,
+     v,  1,  1.5});
+  // clang-format on
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(CropAndResizeOpTest, TestInvalidNormalizationDepth) {
+  MakeNormalizedOp<float>(0, "bilinear", {1.0f, 2.0f}, {1.0f, 1.0f});
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 1});
+  Status s = RunOpKernel();
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(str_util::StrContains(
+      s.ToString(), "normalization_mean must have one value per channel"))
+      << s;
+}
+
 TEST_F(CropAndResizeOpTest, TestInvalidInputShape) {
   MakeOp<float>(0, "bilinear");
   AddInputFromArray<float>(TensorShape({2, 2, 1}), {1, 2, 3, 4});
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/platform/cpu_feature_dispatch.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/bcast.h"
 
@@ -278,6 +279,75 @@ void Assign(const D& d, Out out, Rhs rhs) {
   out.device(d) = rhs;
 }
 
+// Runtime-dispatched same-shape fast path for a binary cwise functor. The
+// primary template is a no-op; specializations below hand the flat loop to
+// an ISA variant selected once per process via port::SelectCpuVariant.
+template <typename Functor>
+struct SimdBinaryLoop {
+  template <typename Out, typename In>
+  static bool Run(const CPUDevice& d, Out out, In in0, In in1) {
+    return false;
+  }
+};
+
+// The generic Eigen path is compiled against the build's baseline ISA, so a
+// fleet that mixes AVX2 and AVX-512 hosts runs the lowest common denominator
+// everywhere. For the most common float binary ops we compile the scalar
+// loop several times with per-function target attributes (the compiler
+// auto-vectorizes each copy for its ISA) and latch the widest variant the
+// host supports on first use. Add, subtract, multiply and divide round
+// identically on every ISA, so the variants are bit-exact. Builds that
+// already target AVX-512 skip all of this since the Eigen path then uses the
+// widest vectors anyway.
+#if defined(TF_CPU_FEATURE_DISPATCH_SUPPORTED) && !defined(__AVX512F__)
+
+typedef void (*SimdBinaryLoopFn)(const float* in0, const float* in1,
+                                 float* out, int64 n);
+
+#define TF_DEFINE_SIMD_BINARY_LOOP(NAME, FUNCTOR, EXPR)                       \
+  TF_TARGET_AVX512F inline void NAME##Avx512(const float* in0,                \
+                                             const float* in1, float* out,    \
+                                             int64 n) {                       \
+    for (int64 i = 0; i < n; ++i) out[i] = EXPR;                              \
+  }                                                                           \
+  TF_TARGET_AVX2 inline void NAME##Avx2(const float* in0, const float* in1,   \
+                                        float* out, int64 n) {                \
+    for (int64 i = 0; i < n; ++i) out[i] = EXPR;                              \
+  }                                                                           \
+  template <>                                                                 \
+  struct SimdBinaryLoop<FUNCTOR<float>> {                                     \
+    static bool Run(const CPUDevice& d, TTypes<float>::Flat out,              \
+                    TTypes<float>::ConstFlat in0,                             \
+                    TTypes<float>::ConstFlat in1) {                           \
+      static const SimdBinaryLoopFn fn =                                      \
+          port::SelectCpuVariant<SimdBinaryLoopFn>(                           \
+              {{port::CPUFeature::AVX512F, &NAME##Avx512},                    \
+               {port::CPUFeature::AVX2, &NAME##Avx2}},                        \
+              nullptr);                                                       \
+      if (fn == nullptr) return false;                                        \
+      const float* in0_ptr = in0.data();                                      \
+      const float* in1_ptr = in1.data();                                      \
+      float* out_ptr = out.data();                                            \
+      d.parallelFor(                                                          \
+          out.size(),                                                         \
+          Eigen::TensorOpCost(2 * sizeof(float), sizeof(float), 1),           \
+          [in0_ptr, in1_ptr, out_ptr](Eigen::Index first, Eigen::Index last) {\
+            fn(in0_ptr + first, in1_ptr + first, out_ptr + first,             \
+               last - first);                                                 \
+          });                                                                 \
+      return true;                                                            \
+    }                                                                         \
+  };
+
+TF_DEFINE_SIMD_BINARY_LOOP(AddFloat, add, in0[i] + in1[i])
+TF_DEFINE_SIMD_BINARY_LOOP(SubFloat, sub, in0[i] - in1[i])
+TF_DEFINE_SIMD_BINARY_LOOP(MulFloat, mul, in0[i] * in1[i])
+TF_DEFINE_SIMD_BINARY_LOOP(DivFloat, div, in0[i] / in1[i])
+
+#undef TF_DEFINE_SIMD_BINARY_LOOP
+
+#endif  // TF_CPU_FEATURE_DISPATCH_SUPPORTED && !__AVX512F__
+
 // Partial specialization of BinaryFunctor<Device=CPUDevice, Functor, NDIMS>
 // for functors with with no error checking.
 template <typename Functor, int NDIMS>
@@ -285,6 +355,7 @@ struct BinaryFunctor<CPUDevice, Functor, NDIMS, false> {
   void operator()(const CPUDevice& d, typename Functor::tout_type out,
                   typename Functor::tin_type in0,
                   typename Functor::tin_type in1, bool* error) {
+    if (SimdBinaryLoop<Functor>::Run(d, out, in0, in1)) return;
     Assign(d, out, in0.binaryExpr(in1, typename Functor::func()));
   }
 
@@ -341,6 +412,7 @@ struct BinaryFunctor<CPUDevice, Functor, 2, false> {
   void operator()(const CPUDevice& d, typename Functor::tout_type out,
                   typename Functor::tin_type in0,
                   typename Functor::tin_type in1, bool* error) {
+    if (SimdBinaryLoop<Functor>::Run(d, out, in0, in1)) return;
     Assign(d, out, in0.binaryExpr(in1, typename Functor::func()));
   }
 
@@ -12,10 +12,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
+
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -27,6 +31,95 @@ namespace {
 // See documentation in ../../ops/dataset_ops.cc for a high-level description of
 // the following op.
 
+// When every component of the cached dataset has a fully defined shape and a
+// dtype whose representation is a flat byte array, the file cache writes a
+// sidecar next to the tensor bundle laid out for memory mapping: a single
+// aligned header block followed by one fixed-size record of raw tensor bytes
+// per element, each tensor slice padded to `kMmapCacheAlignment`. Repeated
+// epochs are then served as alignment-preserving slices of the mapped region,
+// with no memcpy and no proto decode. The bundle remains the portable source
+// of truth; the sidecar stores host-endian bytes and is only ever read back
+// on the machine that wrote it. Caches with variable-shape or string
+// components, and caches whose sidecar is missing or invalid, go through the
+// bundle path as before.
+
+// Alignment, in bytes, of each tensor slice in the sidecar. Matches
+// `Allocator::kAllocatorAlignment` so that slices handed out by
+// `MmapSliceAllocator` satisfy the alignment `Tensor` requests.
+constexpr size_t kMmapCacheAlignment = 64;
+
+constexpr uint64 kMmapCacheMagic = 0x70616d6568636163ULL;  // "cachemap"
+constexpr uint64 kMmapCacheVersion = 1;
+// The header holds the magic number, format version, element count, and
+// record size as fixed64s; the remainder of the block is zero.
+constexpr size_t kMmapCacheHeaderSize = kMmapCacheAlignment;
+
+// Buffer size used when coalescing sidecar shards into the final file.
+constexpr size_t kMmapCacheCopyBufferSize = 1 << 20;
+
+size_t AlignMmapCacheOffset(size_t offset) {
+  return (offset + kMmapCacheAlignment - 1) & ~(kMmapCacheAlignment - 1);
+}
+
+string MmapCacheFilename(const string& prefix) {
+  return strings::StrCat(prefix, ".mmap");
+}
+
+// Serves a single tensor slice out of a shared memory-mapped cache file.
+// Modeled after `MemmappedTensorAllocator` in immutable_constant_op.cc: the
+// tensor "allocation" returns a pointer into the mapped region, and the
+// shared_ptr keeps the region alive for as long as any slice references it.
+class MmapSliceAllocator : public Allocator {
+ public:
+  MmapSliceAllocator(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const void* data, size_t num_bytes)
+      : region_(std::move(region)), data_(data), num_bytes_(num_bytes) {}
+
+  string Name() override { return "MmapSliceAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    if (reinterpret_cast<intptr_t>(data_) % alignment != 0) {
+      allocation_status_ =
+          errors::Internal("Memory-mapped cache slice has wrong alignment");
+      return nullptr;
+    }
+    if (num_bytes > num_bytes_) {
+      allocation_status_ =
+          errors::Internal("Memory-mapped cache slice has wrong length (",
+                           num_bytes_, ") when allocating ", num_bytes);
+      return nullptr;
+    }
+    return const_cast<void*>(data_);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (ptr != data_) {
+      LOG(ERROR) << "Deallocating a slice that was not allocated from this "
+                    "memory-mapped cache file";
+    }
+    if (delete_on_deallocate_) {
+      delete this;
+    }
+  }
+
+  const Status& allocation_status() const { return allocation_status_; }
+
+  void set_delete_on_deallocate() { delete_on_deallocate_ = true; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const void* const data_;
+  const size_t num_bytes_;
+  // If there is an error during allocation we keep it in this status.
+  Status allocation_status_;
+
+  // When the allocator is owned by the tensor buffer it will be deleted on
+  // de-allocation.
+  bool delete_on_deallocate_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MmapSliceAllocator);
+};
+
 class CacheDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit CacheDatasetOp(OpKernelConstruction* ctx)
@@ -63,6 +156,32 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                                                 tensor_index_padding_size_)) {
       input_->Ref();
       DCHECK_EQ(item_index_padding_size_, 7);
+      // Determine whether the cache can carry the memory-mapped sidecar and,
+      // if so, compute the fixed record layout.
+      mmap_compatible_ = num_tensors_ > 0;
+      size_t offset = 0;
+      for (size_t i = 0; i < num_tensors_ && mmap_compatible_; ++i) {
+        const DataType dtype = input_->output_dtypes()[i];
+        TensorShape shape;
+        if (!DataTypeCanUseMemcpy(dtype) ||
+            !input_->output_shapes()[i].AsTensorShape(&shape)) {
+          mmap_compatible_ = false;
+          break;
+        }
+        mmap_tensor_shapes_.push_back(shape);
+        mmap_tensor_offsets_.push_back(offset);
+        mmap_tensor_bytes_.push_back(shape.num_elements() *
+                                     DataTypeSize(dtype));
+        offset = AlignMmapCacheOffset(offset + mmap_tensor_bytes_.back());
+      }
+      if (mmap_compatible_ && offset > 0) {
+        mmap_record_size_ = offset;
+      } else {
+        mmap_compatible_ = false;
+        mmap_tensor_shapes_.clear();
+        mmap_tensor_offsets_.clear();
+        mmap_tensor_bytes_.clear();
+      }
     }
 
     ~FileDataset() override { input_->Unref(); }
@@ -109,6 +228,44 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                              tensor_index);
     }
 
+    // Maps the sidecar written next to the bundle and validates its header
+    // against the record layout this dataset expects. Returns NotFound if no
+    // sidecar was written for this cache.
+    Status OpenMmapRegion(std::shared_ptr<ReadOnlyMemoryRegion>* region,
+                          int64* num_elements) const {
+      std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+      TF_RETURN_IF_ERROR(env_->NewReadOnlyMemoryRegionFromFile(
+          MmapCacheFilename(filename_), &mapped));
+      if (mapped->length() < kMmapCacheHeaderSize) {
+        return errors::DataLoss("Memory-mapped cache file ",
+                                MmapCacheFilename(filename_),
+                                " is shorter than its header.");
+      }
+      const char* header = static_cast<const char*>(mapped->data());
+      if (core::DecodeFixed64(header) != kMmapCacheMagic) {
+        return errors::DataLoss("Memory-mapped cache file ",
+                                MmapCacheFilename(filename_),
+                                " has a bad magic number.");
+      }
+      if (core::DecodeFixed64(header + 8) != kMmapCacheVersion) {
+        return errors::DataLoss(
+            "Memory-mapped cache file ", MmapCacheFilename(filename_),
+            " has unsupported version ", core::DecodeFixed64(header + 8), ".");
+      }
+      const uint64 elements = core::DecodeFixed64(header + 16);
+      const uint64 record_size = core::DecodeFixed64(header + 24);
+      if (record_size != mmap_record_size_ ||
+          mapped->length() !=
+              kMmapCacheHeaderSize + elements * mmap_record_size_) {
+        return errors::DataLoss(
+            "Memory-mapped cache file ", MmapCacheFilename(filename_),
+            " does not match the signature of this dataset.");
+      }
+      *num_elements = static_cast<int64>(elements);
+      region->reset(mapped.release());
+      return Status::OK();
+    }
+
     class FileIterator : public DatasetIterator<FileDataset> {
      public:
       explicit FileIterator(const Params& params)
@@ -202,7 +359,8 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                   strings::StrCat(params.dataset->filename_, "_", shard_id_)),
               lockfile_(strings::StrCat(filename_, ".lockfile")),
               lockfile_created_(false),
-              iteration_completed_(false) {}
+              iteration_completed_(false),
+              mmap_enabled_(params.dataset->mmap_compatible_) {}
 
         Status Initialize(IteratorContext* ctx) override {
           return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
@@ -244,6 +402,15 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             string key = dataset()->FormatName(cur_index_, tensor_index++);
             TF_RETURN_IF_ERROR(writer_->Add(key, t));
           }
+          if (mmap_enabled_) {
+            Status s = AppendMmapRecord(*out_tensors);
+            if (!s.ok()) {
+              LOG(WARNING) << "Abandoning the memory-mapped cache file; this "
+                              "cache will be read through the tensor bundle: "
+                           << s;
+              AbandonMmapCache();
+            }
+          }
           if (*end_of_sequence) {
             TF_RETURN_IF_ERROR(Finish());
           }
@@ -274,6 +441,12 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           if (lockfile_created_) {
             // Flush the current bundle.
             TF_RETURN_IF_ERROR(writer_->Finish());
+            if (mmap_writer_) {
+              // Flush the sidecar shard alongside it; a new shard gets
+              // created together with the next bundle shard.
+              TF_RETURN_IF_ERROR(mmap_writer_->Close());
+              mmap_writer_.reset();
+            }
 
             // Note: We do not delete the lockfile here. We keep lockfiles of
             // all shards around until the entire cache has been written to
@@ -290,6 +463,10 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
               writer->WriteScalar(full_name("cur_index"), cur_index_));
           TF_RETURN_IF_ERROR(
               writer->WriteScalar(full_name("shard_id"), shard_id_));
+          if (!mmap_enabled_) {
+            TF_RETURN_IF_ERROR(
+                writer->WriteScalar(full_name("mmap_abandoned"), ""));
+          }
           return Status::OK();
         }
 
@@ -326,6 +503,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
           lockfile_ = strings::StrCat(filename_, ".lockfile");
           writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+          if (reader->Contains(full_name("mmap_abandoned"))) {
+            mmap_enabled_ = false;
+          }
           return Status::OK();
         }
 
@@ -387,6 +567,17 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             // BundleWriter in another Session.
             writer_ =
                 absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+            if (mmap_enabled_) {
+              Status s = dataset()->env_->NewWritableFile(
+                  MmapCacheFilename(filename_), &mmap_writer_);
+              if (!s.ok()) {
+                LOG(WARNING) << "Abandoning the memory-mapped cache file; "
+                                "this cache will be read through the tensor "
+                                "bundle: "
+                             << s;
+                AbandonMmapCache();
+              }
+            }
             lockfile_created_ = true;
             return Status::OK();
           }
@@ -418,6 +609,129 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(
                 strings::StrCat(dataset()->filename_, "_", i, ".lockfile")));
           }
+          if (mmap_enabled_) {
+            // The sidecar is an optimization on top of the bundle; failing
+            // to build it must not fail the cache.
+            Status s = FinalizeMmapCache();
+            if (!s.ok()) {
+              LOG(WARNING) << "Abandoning the memory-mapped cache file; this "
+                              "cache will be read through the tensor bundle: "
+                           << s;
+              AbandonMmapCache();
+              dataset()
+                  ->env_->DeleteFile(MmapCacheFilename(dataset()->filename_))
+                  .IgnoreError();
+            }
+          }
+          return Status::OK();
+        }
+
+        // Appends `element` to the sidecar shard as one fixed-size record of
+        // raw tensor bytes, zero-padded so that every slice stays aligned.
+        Status AppendMmapRecord(const std::vector<Tensor>& element)
+            EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          if (!mmap_writer_) {
+            return errors::Internal("Sidecar shard writer is not open.");
+          }
+          mmap_buffer_.assign(dataset()->mmap_record_size_, '\0');
+          for (size_t i = 0; i < element.size(); ++i) {
+            const Tensor& t = element[i];
+            if (t.dtype() != dataset()->output_dtypes()[i] ||
+                t.shape() != dataset()->mmap_tensor_shapes_[i]) {
+              return errors::FailedPrecondition(
+                  "Component ", i, " has dtype ", DataTypeString(t.dtype()),
+                  " and shape ", t.shape().DebugString(),
+                  " but the dataset signature promises dtype ",
+                  DataTypeString(dataset()->output_dtypes()[i]),
+                  " and shape ",
+                  dataset()->mmap_tensor_shapes_[i].DebugString(), ".");
+            }
+            StringPiece data = t.tensor_data();
+            memcpy(&mmap_buffer_[dataset()->mmap_tensor_offsets_[i]],
+                   data.data(), data.size());
+          }
+          return mmap_writer_->Append(mmap_buffer_);
+        }
+
+        // Stops writing the sidecar and removes any shards of it written so
+        // far. The bundle is unaffected; readers of this cache will go
+        // through the bundle path.
+        void AbandonMmapCache() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          mmap_enabled_ = false;
+          mmap_writer_.reset();
+          for (size_t i = 0; i <= shard_id_; ++i) {
+            dataset()
+                ->env_
+                ->DeleteFile(MmapCacheFilename(
+                    strings::StrCat(dataset()->filename_, "_", i)))
+                .IgnoreError();
+          }
+        }
+
+        // Coalesces the sidecar shards into <filename>.mmap, prefixed by a
+        // header recording the element count and record size, mirroring the
+        // bundle merge in `Finish`.
+        Status FinalizeMmapCache() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          if (mmap_writer_) {
+            TF_RETURN_IF_ERROR(mmap_writer_->Close());
+            mmap_writer_.reset();
+          }
+          const size_t record_size = dataset()->mmap_record_size_;
+          std::vector<string> shards;
+          shards.reserve(shard_id_ + 1);
+          uint64 total_bytes = 0;
+          for (size_t i = 0; i <= shard_id_; ++i) {
+            shards.push_back(MmapCacheFilename(
+                strings::StrCat(dataset()->filename_, "_", i)));
+            uint64 shard_bytes;
+            TF_RETURN_IF_ERROR(
+                dataset()->env_->GetFileSize(shards.back(), &shard_bytes));
+            if (shard_bytes % record_size != 0) {
+              return errors::DataLoss(
+                  "Sidecar shard ", shards.back(), " has size ", shard_bytes,
+                  " which is not a multiple of the record size ", record_size,
+                  ".");
+            }
+            total_bytes += shard_bytes;
+          }
+          std::unique_ptr<WritableFile> merged;
+          TF_RETURN_IF_ERROR(dataset()->env_->NewWritableFile(
+              MmapCacheFilename(dataset()->filename_), &merged));
+          char header[kMmapCacheHeaderSize] = {};
+          core::EncodeFixed64(header, kMmapCacheMagic);
+          core::EncodeFixed64(header + 8, kMmapCacheVersion);
+          core::EncodeFixed64(header + 16, total_bytes / record_size);
+          core::EncodeFixed64(header + 24, record_size);
+          TF_RETURN_IF_ERROR(
+              merged->Append(StringPiece(header, kMmapCacheHeaderSize)));
+          std::unique_ptr<char[]> scratch(
+              new char[kMmapCacheCopyBufferSize]);
+          for (const string& shard : shards) {
+            std::unique_ptr<RandomAccessFile> file;
+            TF_RETURN_IF_ERROR(
+                dataset()->env_->NewRandomAccessFile(shard, &file));
+            uint64 offset = 0;
+            while (true) {
+              StringPiece chunk;
+              Status s = file->Read(offset, kMmapCacheCopyBufferSize, &chunk,
+                                    scratch.get());
+              if (!s.ok() && !errors::IsOutOfRange(s)) {
+                return s;
+              }
+              if (!chunk.empty()) {
+                TF_RETURN_IF_ERROR(merged->Append(chunk));
+                offset += chunk.size();
+              }
+              if (errors::IsOutOfRange(s)) {
+                // Reached the end of the shard.
+                break;
+              }
+            }
+          }
+          TF_RETURN_IF_ERROR(merged->Close());
+          for (const string& shard : shards) {
+            TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(shard));
+          }
           return Status::OK();
         }
 
@@ -434,6 +748,14 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
         string lockfile_ GUARDED_BY(mu_);
         bool lockfile_created_ GUARDED_BY(mu_);
         bool iteration_completed_ GUARDED_BY(mu_);
+        // Whether the memory-mapped sidecar is still being written. Starts
+        // out as `dataset()->mmap_compatible_` and drops to false if any
+        // element deviates from the declared signature or a sidecar write
+        // fails.
+        bool mmap_enabled_ GUARDED_BY(mu_);
+        std::unique_ptr<WritableFile> mmap_writer_ GUARDED_BY(mu_);
+        // Scratch space for building sidecar records, reused across elements.
+        string mmap_buffer_ GUARDED_BY(mu_);
       };  // FileWriterIterator
 
       class FileReaderIterator : public DatasetIterator<FileDataset> {
@@ -527,6 +849,93 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
         bool iterator_restored_ GUARDED_BY(mu_);
       };  // FileReaderIterator
 
+      // Variant of `FileReaderIterator` that serves elements out of the
+      // memory-mapped sidecar written by `FileWriterIterator`. Every tensor
+      // it produces is an aligned slice of the mapped region; no bytes are
+      // copied and no protos are decoded. It is only constructed once the
+      // sidecar has been mapped and validated against the dataset signature.
+      // It uses the same `cur_index` checkpoint key as `FileReaderIterator`
+      // so that checkpoints are interchangeable between the two readers.
+      class MmapReaderIterator : public DatasetIterator<FileDataset> {
+       public:
+        explicit MmapReaderIterator(
+            const Params& params,
+            std::shared_ptr<ReadOnlyMemoryRegion> region, int64 num_elements)
+            : DatasetIterator<FileDataset>(params),
+              region_(std::move(region)),
+              num_elements_(num_elements),
+              cur_index_(0) {}
+
+        Status GetNextInternal(IteratorContext* ctx,
+                               std::vector<Tensor>* out_tensors,
+                               bool* end_of_sequence) override {
+          mutex_lock l(mu_);
+          if (cur_index_ >= num_elements_) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          *end_of_sequence = false;
+          out_tensors->clear();
+          out_tensors->reserve(dataset()->num_tensors_);
+          const char* record = static_cast<const char*>(region_->data()) +
+                               kMmapCacheHeaderSize +
+                               cur_index_ * dataset()->mmap_record_size_;
+          for (size_t i = 0; i < dataset()->num_tensors_; ++i) {
+            const DataType dtype = dataset()->output_dtypes()[i];
+            const TensorShape& shape = dataset()->mmap_tensor_shapes_[i];
+            const size_t num_bytes = dataset()->mmap_tensor_bytes_[i];
+            if (num_bytes == 0) {
+              // `Tensor` does not go through the allocator for empty
+              // tensors.
+              out_tensors->emplace_back(dtype, shape);
+              continue;
+            }
+            std::unique_ptr<MmapSliceAllocator> allocator(
+                new MmapSliceAllocator(
+                    region_, record + dataset()->mmap_tensor_offsets_[i],
+                    num_bytes));
+            out_tensors->emplace_back(allocator.get(), dtype, shape);
+            TF_RETURN_IF_ERROR(allocator->allocation_status());
+            // The tensor buffer owns the allocator from this point.
+            allocator.release()->set_delete_on_deallocate();
+          }
+          cur_index_++;
+          return Status::OK();
+        }
+
+       protected:
+        std::shared_ptr<model::Node> CreateNode(
+            IteratorContext* ctx, model::Node::Args args) const override {
+          return model::MakeKnownRatioNode(std::move(args),
+                                           /*ratio=*/1);
+        }
+
+        Status SaveInternal(IteratorStateWriter* writer) override {
+          mutex_lock l(mu_);
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("cur_index"), cur_index_));
+          return Status::OK();
+        }
+
+        Status RestoreInternal(IteratorContext* ctx,
+                               IteratorStateReader* reader) override {
+          mutex_lock l(mu_);
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("cur_index"), &cur_index_));
+          if (cur_index_ < 0 || cur_index_ > num_elements_) {
+            return errors::Internal("Invalid value for cur_index ",
+                                    cur_index_);
+          }
+          return Status::OK();
+        }
+
+       private:
+        mutex mu_;
+        const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+        const int64 num_elements_;
+        int64 cur_index_ GUARDED_BY(mu_);
+      };  // MmapReaderIterator
+
       void InitializeIterator() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         // We intentionally use the same prefix for both `FileReaderIterator`
         // and `FileWriterIterator`. Since at any time there will be at most
@@ -538,6 +947,24 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
         // `FileReaderIterator` and seek to the `cur_index`.
         switch (mode_) {
           case Mode::read:
+            if (dataset()->mmap_compatible_) {
+              std::shared_ptr<ReadOnlyMemoryRegion> region;
+              int64 num_elements;
+              Status s = dataset()->OpenMmapRegion(&region, &num_elements);
+              if (s.ok()) {
+                iterator_ = absl::make_unique<MmapReaderIterator>(
+                    MmapReaderIterator::Params{
+                        dataset(), strings::StrCat(prefix(), "Impl")},
+                    std::move(region), num_elements);
+                break;
+              }
+              if (!errors::IsNotFound(s)) {
+                LOG(WARNING) << "Ignoring the memory-mapped cache file; this "
+                                "cache will be read through the tensor "
+                                "bundle: "
+                             << s;
+              }
+            }
             iterator_ = absl::make_unique<FileReaderIterator>(
                 FileReaderIterator::Params{dataset(),
                                            strings::StrCat(prefix(), "Impl")});
@@ -563,6 +990,14 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     static const size_t kMaxItems = 10000000;  // 10 million
     const size_t item_index_padding_size_;
     const string tensor_format_string_;
+    // Fixed record layout of the memory-mapped sidecar. Only meaningful when
+    // `mmap_compatible_` is true, i.e. when every component has a fully
+    // defined shape and a dtype that can be served by memcpy.
+    bool mmap_compatible_ = false;
+    std::vector<TensorShape> mmap_tensor_shapes_;
+    std::vector<size_t> mmap_tensor_offsets_;
+    std::vector<size_t> mmap_tensor_bytes_;
+    size_t mmap_record_size_ = 0;
   };  // FileDataset
 
   class MemoryDataset : public DatasetBase {
@@ -0,0 +1,413 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Microbenchmarks for the tf.data iterator hot paths.
+//
+// Each dataset op is driven standalone on top of a RangeDataset source, so
+// the per-stage cost of a pipeline can be read off by comparing a stage's
+// throughput against BM_RangeDataset. The composed pipeline benchmark at the
+// bottom exercises the stages together the way input pipelines use them.
+// Every benchmark reports elements/s and bytes/s, and labels the run with
+// the p50/p95/p99 latency of a single GetNext() call in microseconds.
+
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/iterator_ops.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+const int kNumThreads = 4;
+
+// Harness that reuses the kernel and iterator plumbing from the dataset op
+// tests to build pipelines outside of a TEST_F body. The gtest machinery in
+// the base class is inert here; TestBody() is never invoked.
+class DatasetBenchmark : public DatasetOpsTestBase {
+ public:
+  void TestBody() override {}
+
+  Status Init(const std::vector<FunctionDef>& flib) {
+    TF_RETURN_IF_ERROR(InitThreadPool(kNumThreads));
+    return InitFunctionLibraryRuntime(flib, kNumThreads);
+  }
+
+  // Runs the dataset op described by `node_def` on `input_dataset` (may be
+  // nullptr for source datasets) and the scalar arguments in `args`, and
+  // returns the produced dataset with one reference owned by the caller.
+  // Consumes one reference on `input_dataset`. The kernel and argument
+  // tensors are kept alive for the lifetime of the harness, since the
+  // iterator context below refers back to the last kernel invocation.
+  Status MakeDatasetFromNodeDef(const NodeDef& node_def,
+                                DatasetBase* input_dataset,
+                                const std::vector<Tensor>& args,
+                                DatasetBase** out_dataset) {
+    input_vectors_.emplace_back();
+    gtl::InlinedVector<TensorValue, 4>& inputs = input_vectors_.back();
+    if (input_dataset != nullptr) {
+      arg_tensors_.emplace_back(DT_VARIANT, TensorShape({}));
+      TF_RETURN_IF_ERROR(
+          StoreDatasetInVariantTensor(input_dataset, &arg_tensors_.back()));
+      inputs.emplace_back(&arg_tensors_.back());
+    }
+    for (const Tensor& arg : args) {
+      arg_tensors_.push_back(arg);
+      inputs.emplace_back(&arg_tensors_.back());
+    }
+    kernels_.emplace_back();
+    TF_RETURN_IF_ERROR(CreateOpKernel(node_def, &kernels_.back()));
+    TF_RETURN_IF_ERROR(CheckOpKernelInput(*kernels_.back(), inputs));
+    // The base class owns a single OpKernelContext::Params; destroy the
+    // previous context before the params underneath it are replaced.
+    op_context_.reset();
+    TF_RETURN_IF_ERROR(
+        CreateOpKernelContext(kernels_.back().get(), &inputs, &op_context_));
+    return CreateDataset(kernels_.back().get(), op_context_.get(),
+                         out_dataset);
+  }
+
+  Status MakeRange(int64 start, int64 stop, int64 step,
+                   DatasetBase** out_dataset) {
+    NodeDef node_def = test::function::NDef(
+        "range", "RangeDataset", {"start", "stop", "step"},
+        {{"output_types", DataTypeVector({DT_INT64})},
+         {"output_shapes", gtl::ArraySlice<TensorShape>{{}}}});
+    return MakeDatasetFromNodeDef(
+        node_def, nullptr,
+        {CreateTensor<int64>(TensorShape({}), {start}),
+         CreateTensor<int64>(TensorShape({}), {stop}),
+         CreateTensor<int64>(TensorShape({}), {step})},
+        out_dataset);
+  }
+
+  // Creates an iterator over `dataset`, using the context of the most recent
+  // kernel invocation.
+  Status MakeIteratorFromDataset(DatasetBase* dataset,
+                                 std::unique_ptr<IteratorBase>* iterator) {
+    TF_RETURN_IF_ERROR(
+        CreateIteratorContext(op_context_.get(), &iterator_context_));
+    return dataset->MakeIterator(iterator_context_.get(), "Iterator",
+                                 iterator);
+  }
+
+  IteratorContext* iterator_context() { return iterator_context_.get(); }
+
+ private:
+  // Deques keep tensor addresses stable across stages.
+  std::deque<Tensor> arg_tensors_;
+  std::deque<gtl::InlinedVector<TensorValue, 4>> input_vectors_;
+  std::vector<std::unique_ptr<OpKernel>> kernels_;
+  std::unique_ptr<OpKernelContext> op_context_;
+  std::unique_ptr<IteratorContext> iterator_context_;
+};
+
+// Drives `iterator` for `iters` GetNext() calls and reports throughput. The
+// datasets used by the benchmarks never reach end-of-sequence.
+void PumpIterator(int iters, DatasetBenchmark* bm, IteratorBase* iterator,
+                  int64 elements_per_call) {
+  histogram::Histogram latency_us;
+  int64 bytes = 0;
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    out_tensors.clear();
+    const uint64 start_ns = Env::Default()->NowNanos();
+    Status s = iterator->GetNext(bm->iterator_context(), &out_tensors,
+                                 &end_of_sequence);
+    latency_us.Add((Env::Default()->NowNanos() - start_ns) / 1000.0);
+    TF_CHECK_OK(s);
+    CHECK(!end_of_sequence);
+    for (const Tensor& t : out_tensors) {
+      bytes += t.TotalBytes();
+    }
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters) * elements_per_call);
+  testing::BytesProcessed(bytes);
+  testing::SetLabel(strings::StrCat(
+      "get_next_us p50: ", latency_us.Percentile(50),
+      " p95: ", latency_us.Percentile(95),
+      " p99: ", latency_us.Percentile(99)));
+}
+
+NodeDef MapNodeDef(const string& input_dataset, const string& func_name) {
+  FunctionDefHelper::AttrValueWrapper func =
+      FunctionDefHelper::FunctionRef(func_name, {{"T", DT_INT64}});
+  return test::function::NDef(
+      "map", "MapDataset", {input_dataset},
+      {{"f", func},
+       {"Targuments", {}},
+       {"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+       {"output_types", gtl::ArraySlice<DataType>{DT_INT64}},
+       {"use_inter_op_parallelism", true},
+       {"preserve_cardinality", false}});
+}
+
+// A function that ignores its argument and returns RangeDataset(0, 10, 1),
+// used to exercise the InterleaveDataset cycle machinery.
+FunctionDef MakeRangeDatasetFunction() {
+  return FunctionDefHelper::Create(
+      "MakeRangeDataset", {"x: int64"}, {"y: variant"}, {},
+      {FunctionDefHelper::Const<int64>("start", 0),
+       FunctionDefHelper::Const<int64>("stop", 10),
+       FunctionDefHelper::Const<int64>("step", 1),
+       {{"range"},
+        "RangeDataset",
+        {"start:output:0", "stop:output:0", "step:output:0"},
+        {{"output_types", DataTypeVector({DT_INT64})},
+         {"output_shapes", gtl::ArraySlice<TensorShape>{{}}}}}},
+      {{"y", "range:handle:0"}});
+}
+
+void BM_RangeDataset(int iters) {
+  testing::StopTiming();
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({}));
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeRange(0, kint64max, 1, &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(), /*elements_per_call=*/1);
+}
+BENCHMARK(BM_RangeDataset);
+
+void BM_MapDataset(int iters) {
+  testing::StopTiming();
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({test::function::XTimesTwo()}));
+  DatasetBase* range_dataset;
+  TF_CHECK_OK(bm.MakeRange(0, kint64max, 1, &range_dataset));
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      MapNodeDef(range_dataset->node_name(), "XTimesTwo"), range_dataset, {},
+      &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(), /*elements_per_call=*/1);
+}
+BENCHMARK(BM_MapDataset);
+
+void BM_BatchDataset(int iters, int batch_size) {
+  testing::StopTiming();
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({}));
+  DatasetBase* range_dataset;
+  TF_CHECK_OK(bm.MakeRange(0, kint64max, 1, &range_dataset));
+  NodeDef node_def = test::function::NDef(
+      "batch", "BatchDatasetV2",
+      {range_dataset->node_name(), "batch_size", "drop_remainder"},
+      {{"output_types", DataTypeVector({DT_INT64})},
+       {"output_shapes", gtl::ArraySlice<PartialTensorShape>{{batch_size}}}});
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      node_def, range_dataset,
+      {DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {batch_size}),
+       DatasetOpsTestBase::CreateTensor<bool>(TensorShape({}), {true})},
+      &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(),
+               /*elements_per_call=*/batch_size);
+}
+BENCHMARK(BM_BatchDataset)->Arg(16)->Arg(256);
+
+void BM_ShuffleDataset(int iters, int buffer_size) {
+  testing::StopTiming();
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({}));
+  DatasetBase* range_dataset;
+  TF_CHECK_OK(bm.MakeRange(0, kint64max, 1, &range_dataset));
+  NodeDef node_def = test::function::NDef(
+      "shuffle", "ShuffleDataset",
+      {range_dataset->node_name(), "buffer_size", "seed", "seed2"},
+      {{"reshuffle_each_iteration", true},
+       {"output_types", DataTypeVector({DT_INT64})},
+       {"output_shapes", gtl::ArraySlice<TensorShape>{{}}}});
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      node_def, range_dataset,
+      {DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}),
+                                               {buffer_size}),
+       DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {1}),
+       DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {2})},
+      &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(), /*elements_per_call=*/1);
+}
+BENCHMARK(BM_ShuffleDataset)->Arg(64)->Arg(1024);
+
+void BM_PrefetchDataset(int iters, int buffer_size) {
+  testing::StopTiming();
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({}));
+  DatasetBase* range_dataset;
+  TF_CHECK_OK(bm.MakeRange(0, kint64max, 1, &range_dataset));
+  NodeDef node_def = test::function::NDef(
+      "prefetch", "PrefetchDataset",
+      {range_dataset->node_name(), "buffer_size"},
+      {{"output_types", DataTypeVector({DT_INT64})},
+       {"output_shapes", gtl::ArraySlice<TensorShape>{{}}}});
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      node_def, range_dataset,
+      {DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}),
+                                               {buffer_size})},
+      &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(), /*elements_per_call=*/1);
+}
+BENCHMARK(BM_PrefetchDataset)->Arg(1)->Arg(16);
+
+void BM_InterleaveDataset(int iters) {
+  testing::StopTiming();
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({MakeRangeDatasetFunction()}));
+  DatasetBase* range_dataset;
+  TF_CHECK_OK(bm.MakeRange(0, kint64max, 1, &range_dataset));
+  FunctionDefHelper::AttrValueWrapper func =
+      FunctionDefHelper::FunctionRef("MakeRangeDataset");
+  NodeDef node_def = test::function::NDef(
+      "interleave", "InterleaveDataset",
+      {range_dataset->node_name(), "cycle_length", "block_length"},
+      {{"f", func},
+       {"Targuments", {}},
+       {"output_types", DataTypeVector({DT_INT64})},
+       {"output_shapes", gtl::ArraySlice<TensorShape>{{}}}});
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      node_def, range_dataset,
+      {DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {2}),
+       DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {2})},
+      &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(), /*elements_per_call=*/1);
+}
+BENCHMARK(BM_InterleaveDataset);
+
+void BM_TFRecordDataset(int iters, int record_bytes) {
+  testing::StopTiming();
+  const int kNumRecords = 1024;
+  const string filename =
+      strings::StrCat(testing::TmpDir(), "/tfrecord_benchmark_",
+                      record_bytes);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(Env::Default()->NewWritableFile(filename, &file));
+    io::RecordWriter writer(file.get());
+    string record(record_bytes, 'x');
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_CHECK_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({}));
+  NodeDef source_node_def = test::function::NDef(
+      "tf_record", "TFRecordDataset",
+      {"filenames", "compression_type", "buffer_size"}, {});
+  DatasetBase* source_dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      source_node_def, nullptr,
+      {DatasetOpsTestBase::CreateTensor<string>(TensorShape({1}),
+                                                {filename}),
+       DatasetOpsTestBase::CreateTensor<string>(TensorShape({}), {""}),
+       DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {256 << 10})},
+      &source_dataset));
+  // Repeat indefinitely so that the file length does not cap `iters`.
+  NodeDef repeat_node_def = test::function::NDef(
+      "repeat", "RepeatDataset", {source_dataset->node_name(), "count"},
+      {{"output_types", DataTypeVector({DT_STRING})},
+       {"output_shapes", gtl::ArraySlice<TensorShape>{{}}}});
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      repeat_node_def, source_dataset,
+      {DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {-1})},
+      &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(), /*elements_per_call=*/1);
+}
+BENCHMARK(BM_TFRecordDataset)->Arg(16)->Arg(1024)->Arg(64 << 10);
+
+// Range -> Map -> Batch -> Prefetch, the shape of a typical input pipeline.
+void BM_MapBatchPrefetchPipeline(int iters, int batch_size) {
+  testing::StopTiming();
+  DatasetBenchmark bm;
+  TF_CHECK_OK(bm.Init({test::function::XTimesTwo()}));
+  DatasetBase* range_dataset;
+  TF_CHECK_OK(bm.MakeRange(0, kint64max, 1, &range_dataset));
+  DatasetBase* map_dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      MapNodeDef(range_dataset->node_name(), "XTimesTwo"), range_dataset, {},
+      &map_dataset));
+  NodeDef batch_node_def = test::function::NDef(
+      "batch", "BatchDatasetV2",
+      {map_dataset->node_name(), "batch_size", "drop_remainder"},
+      {{"output_types", DataTypeVector({DT_INT64})},
+       {"output_shapes", gtl::ArraySlice<PartialTensorShape>{{batch_size}}}});
+  DatasetBase* batch_dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      batch_node_def, map_dataset,
+      {DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {batch_size}),
+       DatasetOpsTestBase::CreateTensor<bool>(TensorShape({}), {true})},
+      &batch_dataset));
+  NodeDef prefetch_node_def = test::function::NDef(
+      "prefetch", "PrefetchDataset",
+      {batch_dataset->node_name(), "buffer_size"},
+      {{"output_types", DataTypeVector({DT_INT64})},
+       {"output_shapes", gtl::ArraySlice<PartialTensorShape>{{batch_size}}}});
+  DatasetBase* dataset;
+  TF_CHECK_OK(bm.MakeDatasetFromNodeDef(
+      prefetch_node_def, batch_dataset,
+      {DatasetOpsTestBase::CreateTensor<int64>(TensorShape({}), {1})},
+      &dataset));
+  core::ScopedUnref unref(dataset);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_CHECK_OK(bm.MakeIteratorFromDataset(dataset, &iterator));
+  PumpIterator(iters, &bm, iterator.get(),
+               /*elements_per_call=*/batch_size);
+}
+BENCHMARK(BM_MapBatchPrefetchPipeline)->Arg(16)->Arg(256);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
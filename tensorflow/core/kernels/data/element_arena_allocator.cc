@@ -0,0 +1,158 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/element_arena_allocator.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Rounds `num_bytes` up to a multiple of `Allocator::kAllocatorAlignment`,
+// so that every bump-allocated buffer within a slab remains aligned.
+size_t RoundUpToAlignment(size_t num_bytes) {
+  static constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+  return (num_bytes + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+}  // namespace
+
+constexpr size_t ElementArenaAllocator::kDefaultSlabBytes;
+constexpr size_t ElementArenaAllocator::kLargeAllocationBytes;
+constexpr int ElementArenaAllocator::kMaxSlabs;
+
+ElementArenaAllocator::ElementArenaAllocator(Allocator* base,
+                                             size_t slab_bytes)
+    : base_(base), slab_bytes_(slab_bytes) {}
+
+ElementArenaAllocator::~ElementArenaAllocator() {
+  for (const auto& slab : slabs_) {
+    DCHECK_EQ(slab->outstanding, 0);
+    base_->DeallocateRaw(slab->data);
+  }
+}
+
+void* ElementArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes == 0 || num_bytes > kLargeAllocationBytes ||
+      alignment > kAllocatorAlignment) {
+    void* result = base_->AllocateRaw(alignment, num_bytes);
+    if (result != nullptr) {
+      mutex_lock l(mu_);
+      ++total_outstanding_;
+    }
+    return result;
+  }
+  const size_t padded_bytes = RoundUpToAlignment(num_bytes);
+  {
+    mutex_lock l(mu_);
+    if (current_slab_ == nullptr ||
+        slab_bytes_ - current_slab_->offset < padded_bytes) {
+      Slab* slab = AcquireSlabLocked(padded_bytes);
+      if (slab != nullptr) {
+        current_slab_ = slab;
+      }
+    }
+    if (current_slab_ != nullptr &&
+        slab_bytes_ - current_slab_->offset >= padded_bytes) {
+      void* result = current_slab_->data + current_slab_->offset;
+      current_slab_->offset += padded_bytes;
+      ++current_slab_->outstanding;
+      ++total_outstanding_;
+      return result;
+    }
+  }
+  // All slabs are pinned by live buffers; fall back to the base allocator.
+  void* result = base_->AllocateRaw(alignment, num_bytes);
+  if (result != nullptr) {
+    mutex_lock l(mu_);
+    ++total_outstanding_;
+  }
+  return result;
+}
+
+void ElementArenaAllocator::DeallocateRaw(void* ptr) {
+  bool pass_through = true;
+  bool delete_self = false;
+  {
+    mutex_lock l(mu_);
+    for (const auto& slab : slabs_) {
+      if (ptr >= slab->data && ptr < slab->data + slab_bytes_) {
+        pass_through = false;
+        DCHECK_GT(slab->outstanding, 0);
+        if (--slab->outstanding == 0) {
+          // Every buffer carved from this slab has been released; reclaim
+          // the whole slab at once.
+          slab->offset = 0;
+          if (slab.get() != current_slab_) {
+            free_slabs_.push_back(slab.get());
+          }
+        }
+        break;
+      }
+    }
+    --total_outstanding_;
+    delete_self = delete_on_idle_ && total_outstanding_ == 0;
+  }
+  if (pass_through) {
+    base_->DeallocateRaw(ptr);
+  }
+  if (delete_self) {
+    delete this;
+  }
+}
+
+void ElementArenaAllocator::Release() {
+  bool delete_self = false;
+  {
+    mutex_lock l(mu_);
+    delete_on_idle_ = true;
+    delete_self = total_outstanding_ == 0;
+  }
+  if (delete_self) {
+    delete this;
+  }
+}
+
+size_t ElementArenaAllocator::NumSlabsForTesting() {
+  mutex_lock l(mu_);
+  return slabs_.size();
+}
+
+ElementArenaAllocator::Slab* ElementArenaAllocator::AcquireSlabLocked(
+    size_t num_bytes) {
+  if (!free_slabs_.empty()) {
+    // Reclaimed slabs always have their watermark reset, so any of them can
+    // satisfy a small request.
+    Slab* slab = free_slabs_.back();
+    free_slabs_.pop_back();
+    DCHECK_GE(slab_bytes_ - slab->offset, num_bytes);
+    return slab;
+  }
+  if (slabs_.size() >= kMaxSlabs) {
+    return nullptr;
+  }
+  void* data = base_->AllocateRaw(kAllocatorAlignment, slab_bytes_);
+  if (data == nullptr) {
+    return nullptr;
+  }
+  slabs_.push_back(absl::make_unique<Slab>());
+  Slab* slab = slabs_.back().get();
+  slab->data = static_cast<char*>(data);
+  return slab;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,116 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_ELEMENT_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_ELEMENT_ARENA_ALLOCATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// An `ElementArenaAllocator` carves small, short-lived tensor buffers out of
+// large slabs obtained from a base allocator, so that an iterator producing
+// millions of small elements does not pay a round trip through the global
+// allocator for each of them. Within a slab, allocation is a bump of an
+// offset; a slab is reclaimed en masse (and reused for subsequent elements)
+// once every buffer carved from it has been released. Requests that are
+// large, unusually aligned, or arrive while all slabs are pinned by live
+// tensors fall through to the base allocator, so the arena is never a
+// correctness constraint, only a fast path.
+//
+// Buffers allocated from the arena may outlive the iterator that produced
+// them, so the arena manages its own lifetime: the owner calls `Release()`
+// instead of deleting it, and the arena deletes itself once the last
+// outstanding buffer has been returned.
+//
+// This class is thread-safe.
+class ElementArenaAllocator : public Allocator {
+ public:
+  // The size of each slab requested from the base allocator.
+  static constexpr size_t kDefaultSlabBytes = 1 << 20;  // 1MB
+
+  // Requests larger than this bypass the arena. Chosen so that a slab
+  // amortizes the base allocator across at least ~32 allocations.
+  static constexpr size_t kLargeAllocationBytes = kDefaultSlabBytes / 32;
+
+  // The maximum number of slabs the arena will hold. Once this many slabs
+  // are pinned by live buffers, further small requests fall through to the
+  // base allocator rather than growing the arena.
+  static constexpr int kMaxSlabs = 16;
+
+  // Constructs an arena that draws slabs from `base`, which must outlive
+  // this allocator and all buffers allocated from it. `base` is not owned.
+  explicit ElementArenaAllocator(Allocator* base,
+                                 size_t slab_bytes = kDefaultSlabBytes);
+
+  string Name() override { return "tf_data_element_arena"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  // Returns whether this arena draws its slabs from `allocator`. Used to
+  // decide whether the arena can stand in for the allocator that an
+  // `AllocatorAttributes` lookup would otherwise return.
+  bool WrapsBase(const Allocator* allocator) const {
+    return allocator == base_;
+  }
+
+  // Relinquishes ownership: the arena deletes itself once all outstanding
+  // buffers have been deallocated (possibly immediately). The caller must
+  // not use the arena after calling this.
+  void Release();
+
+  // Returns the current number of slabs. For testing only.
+  size_t NumSlabsForTesting();
+
+ private:
+  struct Slab {
+    char* data = nullptr;
+    size_t offset = 0;        // Bump-allocation watermark.
+    int64 outstanding = 0;    // Buffers carved from this slab and still live.
+  };
+
+  ~ElementArenaAllocator() override;
+
+  // Returns a slab with at least `num_bytes` of headroom, or nullptr if the
+  // arena is at capacity and no reusable slab is available.
+  Slab* AcquireSlabLocked(size_t num_bytes) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;  // Not owned.
+  const size_t slab_bytes_;
+
+  mutex mu_;
+  std::vector<std::unique_ptr<Slab>> slabs_ GUARDED_BY(mu_);
+  // Slabs whose buffers have all been released, ready for reuse.
+  std::vector<Slab*> free_slabs_ GUARDED_BY(mu_);
+  Slab* current_slab_ GUARDED_BY(mu_) = nullptr;
+  // All live allocations, including those passed through to `base_`.
+  int64 total_outstanding_ GUARDED_BY(mu_) = 0;
+  bool delete_on_idle_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ElementArenaAllocator);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_ELEMENT_ARENA_ALLOCATOR_H_
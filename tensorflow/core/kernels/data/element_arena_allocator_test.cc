@@ -0,0 +1,147 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/element_arena_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// A base allocator that counts its live allocations, so tests can observe
+// which requests reached it.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    ++num_deallocations_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int64 num_allocations() const { return num_allocations_; }
+  int64 num_deallocations() const { return num_deallocations_; }
+
+ private:
+  int64 num_allocations_ = 0;
+  int64 num_deallocations_ = 0;
+};
+
+TEST(ElementArenaAllocatorTest, SmallAllocationsShareASlab) {
+  CountingAllocator base;
+  auto* arena = new ElementArenaAllocator(&base);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) %
+                  Allocator::kAllocatorAlignment,
+              0);
+    ptrs.push_back(ptr);
+  }
+  // All 100 requests fit in the first slab, so the base allocator saw
+  // exactly one allocation.
+  EXPECT_EQ(base.num_allocations(), 1);
+  EXPECT_EQ(arena->NumSlabsForTesting(), 1);
+  for (void* ptr : ptrs) {
+    arena->DeallocateRaw(ptr);
+  }
+  // The slab is retained for reuse, not returned to the base allocator.
+  EXPECT_EQ(base.num_deallocations(), 0);
+  arena->Release();
+  EXPECT_EQ(base.num_deallocations(), 1);
+}
+
+TEST(ElementArenaAllocatorTest, SlabIsReusedAfterMassRelease) {
+  CountingAllocator base;
+  auto* arena = new ElementArenaAllocator(&base);
+  for (int round = 0; round < 10; ++round) {
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 50; ++i) {
+      ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 1000));
+    }
+    for (void* ptr : ptrs) {
+      arena->DeallocateRaw(ptr);
+    }
+  }
+  // Each round fits in one slab and releases it in full, so the arena never
+  // needs a second slab.
+  EXPECT_EQ(arena->NumSlabsForTesting(), 1);
+  EXPECT_EQ(base.num_allocations(), 1);
+  arena->Release();
+}
+
+TEST(ElementArenaAllocatorTest, LargeAllocationsPassThrough) {
+  CountingAllocator base;
+  auto* arena = new ElementArenaAllocator(&base);
+  void* ptr = arena->AllocateRaw(
+      Allocator::kAllocatorAlignment,
+      ElementArenaAllocator::kLargeAllocationBytes + 1);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(base.num_allocations(), 1);
+  EXPECT_EQ(arena->NumSlabsForTesting(), 0);
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(base.num_deallocations(), 1);
+  arena->Release();
+}
+
+TEST(ElementArenaAllocatorTest, FallsBackWhenAllSlabsArePinned) {
+  CountingAllocator base;
+  auto* arena = new ElementArenaAllocator(&base);
+  // Pin every slab the arena is willing to create.
+  std::vector<void*> ptrs;
+  const size_t request = ElementArenaAllocator::kLargeAllocationBytes;
+  const int allocations_per_slab =
+      ElementArenaAllocator::kDefaultSlabBytes / request;
+  for (int i = 0;
+       i < ElementArenaAllocator::kMaxSlabs * allocations_per_slab; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, request));
+  }
+  EXPECT_EQ(arena->NumSlabsForTesting(), ElementArenaAllocator::kMaxSlabs);
+  const int64 base_allocations = base.num_allocations();
+  // The next request cannot grow the arena and must reach the base
+  // allocator instead.
+  void* overflow = arena->AllocateRaw(Allocator::kAllocatorAlignment, request);
+  ASSERT_NE(overflow, nullptr);
+  EXPECT_EQ(base.num_allocations(), base_allocations + 1);
+  arena->DeallocateRaw(overflow);
+  for (void* ptr : ptrs) {
+    arena->DeallocateRaw(ptr);
+  }
+  arena->Release();
+}
+
+TEST(ElementArenaAllocatorTest, DeletionIsDeferredUntilIdle) {
+  CountingAllocator base;
+  auto* arena = new ElementArenaAllocator(&base);
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  ASSERT_NE(ptr, nullptr);
+  arena->Release();
+  // The slab must remain valid while `ptr` is live.
+  EXPECT_EQ(base.num_deallocations(), 0);
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(base.num_deallocations(), 1);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/indexed_record_reader.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
@@ -542,6 +544,168 @@ REGISTER_KERNEL_BUILDER(
     Name("ExperimentalIdentityIndexedDataset").Device(DEVICE_CPU),
     IdentityIndexedDatasetOp);
 
+// An IndexedDataset over the records of an indexed TFRecord file (a file
+// written with RecordWriterOptions::build_index set). Materialization reads
+// the offset table from the index footer, after which Get() retrieves any
+// record in O(1) without scanning the file. Combined with an index
+// permutation this provides a true global shuffle, and resuming a pipeline
+// mid-file is a single seek instead of a scan.
+class IndexedTFRecordDatasetOp : public IndexedDatasetOpKernel {
+ public:
+  using IndexedDatasetOpKernel::IndexedDatasetOpKernel;
+
+  void MakeIndexedDataset(OpKernelContext* ctx,
+                          IndexedDataset** output) override {
+    string filename;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<string>(ctx, "filename", &filename));
+    *output = new Dataset(ctx, ctx->env(), filename);
+  }
+
+  class Dataset : public IndexedDataset {
+   public:
+    Dataset(OpKernelContext* ctx, Env* env, const string& filename)
+        : IndexedDataset(DatasetContext(ctx)), env_(env), filename_(filename) {}
+
+    Status MaterializeDataset(
+        std::shared_ptr<MaterializedIndexedDataset>* materialized) override {
+      std::unique_ptr<RandomAccessFile> file;
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &file));
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env_->GetFileSize(filename_, &file_size));
+      std::unique_ptr<io::IndexedRecordReader> reader(
+          new io::IndexedRecordReader(file.get()));
+      TF_RETURN_IF_ERROR(reader->Init(file_size));
+      (*materialized) = std::make_shared<Materialized>(this, std::move(file),
+                                                       std::move(reader));
+      return Status::OK();
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(Iterator::Params{
+          this, strings::StrCat(prefix, "::IndexedTFRecordDataset")});
+    }
+
+    string DebugString() const override {
+      return "IndexedTFRecordDataset::Dataset";
+    }
+
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** node) const override {
+      return errors::Unimplemented(
+          "indexed_tf_record_dataset.AsGraphDefInternal");
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (!materialized_) {
+          TF_RETURN_IF_ERROR(
+              dataset()->MaterializeDataset(&materialized_));
+          TF_RETURN_IF_ERROR(materialized_->Size(&num_records_));
+        }
+        if (cur_ < num_records_) {
+          TF_RETURN_IF_ERROR(materialized_->Get(
+              IteratorContext(IteratorContext::Params(ctx)), cur_++,
+              out_tensors));
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+     private:
+      mutex mu_;
+      std::shared_ptr<MaterializedIndexedDataset> materialized_
+          GUARDED_BY(mu_);
+      uint64 num_records_ GUARDED_BY(mu_) = 0;
+      uint64 cur_ GUARDED_BY(mu_) = 0;
+    };
+
+    class Materialized : public MaterializedIndexedDataset {
+     public:
+      Materialized(Dataset* dataset, std::unique_ptr<RandomAccessFile> file,
+                   std::unique_ptr<io::IndexedRecordReader> reader)
+          : dataset_(dataset),
+            file_(std::move(file)),
+            reader_(std::move(reader)) {
+        dataset->Ref();
+      }
+
+      ~Materialized() override { dataset_->Unref(); }
+
+      const DataTypeVector& output_dtypes() const override {
+        return dataset_->output_dtypes();
+      }
+
+      const std::vector<PartialTensorShape>& output_shapes() const override {
+        return dataset_->output_shapes();
+      }
+
+      Status Get(IteratorContext&& ctx, uint64 index,
+                 std::vector<Tensor>* out_tensors) const override {
+        if (index >= reader_->NumRecords()) {
+          // Note: use InvalidArgument instead of OutOfRange error because many
+          // things consider OutOfRange to be a "clean termination" error.
+          return errors::InvalidArgument(
+              "Index ", index, " is out of range for this dataset. (Size is: ",
+              reader_->NumRecords(), ".)");
+        }
+        string record;
+        TF_RETURN_IF_ERROR(reader_->ReadRecord(index, &record));
+        out_tensors->emplace_back(ctx.allocator({}), DT_STRING,
+                                  TensorShape({}));
+        out_tensors->back().scalar<string>()() = std::move(record);
+        return Status::OK();
+      }
+
+      Status Size(uint64* size) const override {
+        *size = reader_->NumRecords();
+        return Status::OK();
+      }
+
+     private:
+      const Dataset* const dataset_;  // Owns one reference.
+      const std::unique_ptr<RandomAccessFile> file_;
+      const std::unique_ptr<io::IndexedRecordReader> reader_;
+    };
+
+    Env* const env_;
+    const string filename_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("ExperimentalIndexedTFRecordDataset").Device(DEVICE_CPU),
+    IndexedTFRecordDatasetOp);
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -448,9 +448,9 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                       offset);
                   break;
                 }
-                // TODO(mrry): Add a version of DoParallelConcat that allows us
-                // to move `tensor` where possible, to speed up string tensor
-                // batching.
+                // Writes the tensor into its slice of the preallocated
+                // batch: a memcpy for simple dtypes and a move for string
+                // tensors whose buffer is not shared.
                 Status copy_status = batch_util::CopyElementToSlice(
                     std::move(tensor), batch, offset);
                 if (!copy_status.ok()) {
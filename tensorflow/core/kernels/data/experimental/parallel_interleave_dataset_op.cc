@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -226,7 +227,8 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
             workers_(dataset()->num_threads()),
-            worker_thread_states_(dataset()->num_threads()) {}
+            worker_thread_states_(dataset()->num_threads()),
+            work_stealing_(dataset()->sloppy_ && WorkStealingEnabled()) {}
 
       ~Iterator() override {
         mutex_lock l(mu_);
@@ -298,8 +300,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                 block_count_ = 0;
               }
               break;
-            } else if (!current_worker->is_producing) {
-              // This iterator has reached end of input.
+            } else if (!current_worker->MayHaveElements()) {
+              // This iterator has reached end of input and no stolen element
+              // for it is in transit.
               interleave_indices_[index] = -1;
               if (input_impl_) {
                 // Start prefetching a new iterator.
@@ -359,6 +362,14 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       }
 
       Status SaveInternal(IteratorStateWriter* writer) override {
+        // A stolen element held by a stealing thread would not be captured in
+        // the checkpoint and would be lost on restore.
+        if (work_stealing_) {
+          return errors::Unimplemented(
+              dataset()->DebugString(),
+              " does not support checkpointing when "
+              "TF_DATA_PARALLEL_INTERLEAVE_WORK_STEALING is enabled");
+        }
         // The order of locking is important here to avoid deadlock.
         mutex_lock l(mu_);
         mutex_lock ckpt_l(ckpt_mu_);
@@ -514,6 +525,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         // Concretely, all output elements will have been consumed only when:
         // is_producing == false && outputs.empty();
         bool is_producing = false;
+        // Number of elements that stealing threads have read from this
+        // worker's iterator but not yet appended to `outputs`.  Keeps the
+        // client from retiring the worker while a stolen element is in
+        // transit.
+        int64 stolen_in_flight = 0;
         // Condition variable used to coordinate between threads. The worker
         // thread waits on this condition variable when it is either (1) waiting
         // for the main thread to add arguments to `input`, or (2) waiting for
@@ -523,7 +539,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         condition_variable cond_var;
 
         inline bool MayHaveElements() const {
-          return is_producing || !outputs.empty();
+          return is_producing || stolen_in_flight > 0 || !outputs.empty();
         }
 
         // Sets inputs for a worker thread and notifies it to start processing.
@@ -560,6 +576,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         // The arguments to be used to construct `iterator`.
         std::vector<Tensor> input;
 
+        // Serializes replacement and destruction of `iterator` against
+        // stealing threads that borrow it; concurrent `GetNext()` calls on a
+        // live iterator are safe and intentionally not serialized here.
+        mutex iterator_mu;
+
         std::unique_ptr<IteratorBase> iterator;
 
         WorkerThreadState() : output_elem(Status::OK()) {}
@@ -658,39 +679,64 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
             }
 
             if (read_new_input) {
-              mutex_lock l(mu_);
-              while (!cancelled_ && !workers_[thread_index].is_producing) {
-                RecordStop(ctx.get());
-                workers_[thread_index].cond_var.wait(l);
-                RecordStart(ctx.get());
+              while (true) {
+                int64 victim_index = -1;
+                {
+                  mutex_lock l(mu_);
+                  if (cancelled_) return;
+                  if (workers_[thread_index].is_producing) {
+                    // Copy the input tensors so that we do not need to block
+                    // on `mu_` when building the iterator.
+                    // We keep a copy of the input tensors in
+                    // `WorkerThreadState.input` till the iterator is in use.
+                    // This is used in `RestoreInternal` to re-build the
+                    // iterator.
+                    // TODO(b/78046638): Explore ways to avoid tracking the
+                    // input tensors.
+                    tf_shared_lock ckpt_l(ckpt_mu_);
+                    worker_thread_states_[thread_index].input.swap(
+                        workers_[thread_index].input);
+                    // CHECKPOINT_MARKER_A
+                    // We have the input tensors but have not built the
+                    // iterator yet.
+                    break;
+                  }
+                  // In work-stealing mode, a worker with no input element of
+                  // its own helps drain another worker's open iterator
+                  // instead of blocking; this removes the straggler tail when
+                  // input elements (e.g. file shards) are heavily skewed.
+                  if (work_stealing_ && !input_impl_) {
+                    victim_index = StartStealLocked(thread_index);
+                  }
+                  if (victim_index < 0) {
+                    RecordStop(ctx.get());
+                    workers_[thread_index].cond_var.wait(l);
+                    RecordStart(ctx.get());
+                    continue;
+                  }
+                }
+                StealFromWorker(ctx.get(), victim_index);
               }
-              if (cancelled_) return;
-              // Copy the input tensors so that we do not need to block on `mu_`
-              // when building the iterator.
-              // We keep a copy of the input tensors in
-              // `WorkerThreadState.input` till the iterator is in use. This is
-              // used in `RestoreInternal` to re-build the iterator.
-              // TODO(b/78046638): Explore ways to avoid tracking the input
-              // tensors.
-              tf_shared_lock ckpt_l(ckpt_mu_);
-              worker_thread_states_[thread_index].input.swap(
-                  workers_[thread_index].input);
-              // CHECKPOINT_MARKER_A
-              // We have the input tensors but have not built the iterator yet.
             }
 
             // 1b. Run the user defined function to produce a new iterator.
             {
               tf_shared_lock l(ckpt_mu_);
+              std::unique_ptr<IteratorBase> iterator;
               worker_thread_states_[thread_index].iterator_creation_status =
                   MakeIteratorFromInputElement(
                       ctx.get(), worker_thread_states_[thread_index].input,
                       thread_index, *instantiated_captured_func_, prefix(),
-                      &worker_thread_states_[thread_index].iterator);
+                      &iterator);
               iterator_creation_status =
                   worker_thread_states_[thread_index].iterator_creation_status;
               if (!iterator_creation_status.ok()) {
                 worker_thread_states_[thread_index].input.clear();
+              } else {
+                mutex_lock iterator_l(
+                    worker_thread_states_[thread_index].iterator_mu);
+                worker_thread_states_[thread_index].iterator =
+                    std::move(iterator);
               }
               // CHECKPOINT_MARKER_B
               // Either an iterator has been successfully built and placed in
@@ -777,7 +823,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                 // Move the temporary state in WorkerThreadState to WorkerState
                 // and mark it as used.
                 if (end_of_sequence) {
-                  worker_thread_states_[thread_index].iterator.reset();
+                  {
+                    mutex_lock iterator_l(
+                        worker_thread_states_[thread_index].iterator_mu);
+                    worker_thread_states_[thread_index].iterator.reset();
+                  }
                   worker_thread_states_[thread_index].input.clear();
                   worker_thread_states_[thread_index].end_of_sequence = false;
                 } else {
@@ -802,6 +852,74 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         }
       }
 
+      static bool WorkStealingEnabled() {
+        bool enabled;
+        TF_CHECK_OK(ReadBoolFromEnvVar(
+            "TF_DATA_PARALLEL_INTERLEAVE_WORK_STEALING", false, &enabled));
+        return enabled;
+      }
+
+      // Picks the worker whose open iterator an idle thread should help
+      // drain, approximating "busiest" as the producing worker with the
+      // fewest buffered outputs (i.e. the one furthest behind its consumer).
+      // Increments the victim's `stolen_in_flight` count so the client does
+      // not retire it while the stolen element is in transit.  Returns -1 if
+      // no producing worker has buffer space.
+      int64 StartStealLocked(int64 thread_index)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        int64 victim_index = -1;
+        size_t min_buffered = dataset()->buffer_output_elements_;
+        for (int64 i = 0; i < workers_.size(); ++i) {
+          if (i == thread_index || !workers_[i].is_producing) {
+            continue;
+          }
+          if (workers_[i].outputs.size() < min_buffered) {
+            min_buffered = workers_[i].outputs.size();
+            victim_index = i;
+          }
+        }
+        if (victim_index >= 0) {
+          ++workers_[victim_index].stolen_in_flight;
+        }
+        return victim_index;
+      }
+
+      // Reads one element from the victim's iterator and appends it to the
+      // victim's output buffer, from which the client consumes it like any
+      // other element of that stream.  Called without locks held;
+      // `StartStealLocked` must have accounted for the in-flight element.
+      void StealFromWorker(IteratorContext* ctx, int64 victim_index) {
+        OutputElem elem(Status::OK());
+        bool produced = false;
+        {
+          tf_shared_lock ckpt_l(ckpt_mu_);
+          mutex_lock iterator_l(
+              worker_thread_states_[victim_index].iterator_mu);
+          IteratorBase* iterator =
+              worker_thread_states_[victim_index].iterator.get();
+          if (iterator != nullptr) {
+            bool end_of_sequence = false;
+            elem.status = iterator->GetNext(ctx, &elem.output,
+                                            &end_of_sequence);
+            // The victim observes end_of_sequence from its own read and
+            // winds the stream down; errors are delivered like any other
+            // element.
+            produced = !end_of_sequence;
+          }
+        }
+        mutex_lock l(mu_);
+        --workers_[victim_index].stolen_in_flight;
+        if (!cancelled_ && produced) {
+          // The buffer may momentarily exceed `buffer_output_elements_` by
+          // the number of concurrent stealers; the cap is a prefetch bound
+          // and dropping the element would lose data.
+          workers_[victim_index].outputs.push_back(std::move(elem));
+        }
+        // Wake the client in either case: it may be blocked on an element
+        // from this worker, or waiting to learn that none is coming.
+        sloppy_cond_var_.notify_one();
+      }
+
       Status WriteWorkerStateLocked(IteratorStateWriter* writer, int index)
           EXCLUSIVE_LOCKS_REQUIRED(mu_, ckpt_mu_) {
         string prefix = strings::StrCat("worker_", index);
@@ -1034,6 +1152,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       // WorkerState. This is used for checkpointing purposes only.
       std::vector<WorkerThreadState> worker_thread_states_ GUARDED_BY(ckpt_mu_);
 
+      // Whether idle workers may steal elements from other workers' open
+      // iterators (sloppy mode only; see
+      // TF_DATA_PARALLEL_INTERLEAVE_WORK_STEALING).
+      const bool work_stealing_;
+
       // Indices in `workers_` of iterators to interleave.
       std::vector<int64> interleave_indices_ GUARDED_BY(mu_);
       // Indices in `workers_` of prefetched iterators.
@@ -0,0 +1,337 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+
+#include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// See documentation in ../../../ops/experimental_dataset_ops.cc for a
+// high-level description of the following op.
+
+constexpr char kParallelTFRecordDatasetName[] = "ParallelTFRecord";
+
+// Number of buffered records each reader thread may have outstanding.  The
+// overall record buffer is bounded by this times `num_parallel_reads`, so a
+// slow consumer cannot accumulate unbounded memory while readers run ahead.
+constexpr int64 kBufferedRecordsPerReader = 64;
+
+// Default per-file readahead when the caller passes `buffer_size == 0`.
+// Record reads are sequential, so a large readahead keeps fast storage (e.g.
+// NVMe) busy with few syscalls.
+constexpr int64 kDefaultReadaheadBytes = 16 << 20;  // 16 MB
+
+class ParallelTFRecordDatasetOp : public DatasetOpKernel {
+ public:
+  using DatasetOpKernel::DatasetOpKernel;
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    string compression_type;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "compression_type",
+                                                    &compression_type));
+
+    int64 buffer_size = -1;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(ctx, buffer_size >= 0,
+                errors::InvalidArgument(
+                    "`buffer_size` must be >= 0 (0 == default)"));
+    if (buffer_size == 0) {
+      buffer_size = kDefaultReadaheadBytes;
+    }
+
+    int64 num_parallel_reads = -1;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "num_parallel_reads",
+                                                   &num_parallel_reads));
+    OP_REQUIRES(ctx, num_parallel_reads > 0,
+                errors::InvalidArgument("`num_parallel_reads` must be > 0"));
+
+    *output = new Dataset(ctx, std::move(filenames), compression_type,
+                          buffer_size, num_parallel_reads);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+                     const string& compression_type, int64 buffer_size,
+                     int64 num_parallel_reads)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          compression_type_(compression_type),
+          buffer_size_(buffer_size),
+          num_parallel_reads_(num_parallel_reads),
+          options_(io::RecordReaderOptions::CreateRecordReaderOptions(
+              compression_type)) {
+      options_.buffer_size = buffer_size;
+    }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(Iterator::Params{
+          this, strings::StrCat(prefix, "::", kParallelTFRecordDatasetName)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    string DebugString() const override {
+      return "ParallelTFRecordDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* compression_type = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
+      Node* buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+      Node* num_parallel_reads = nullptr;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(num_parallel_reads_, &num_parallel_reads));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, compression_type, buffer_size, num_parallel_reads},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            num_readers_(std::max<int64>(
+                1, std::min<int64>(params.dataset->num_parallel_reads_,
+                                   params.dataset->filenames_.size()))),
+            buffer_limit_(num_readers_ * kBufferedRecordsPerReader) {}
+
+      ~Iterator() override {
+        // Signal the reader threads to terminate; they are joined when
+        // `reader_threads_` is destroyed.
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsureReaderThreadsStarted(ctx);
+        // Wait until a reader has produced a record, or all readers have
+        // finished their files.
+        while (!cancelled_ && buffer_.empty() && num_active_readers_ > 0) {
+          RecordStop(ctx);
+          cond_var_.wait(l);
+          RecordStart(ctx);
+        }
+
+        if (cancelled_) {
+          return errors::Cancelled(
+              "ParallelTFRecordDatasetOp::Dataset::Iterator::GetNext");
+        }
+
+        if (!buffer_.empty()) {
+          Status s = std::move(buffer_.front().status);
+          if (s.ok()) {
+            metrics::RecordTFDataBytesRead(
+                kParallelTFRecordDatasetName,
+                buffer_.front().value.scalar<string>()().size());
+            out_tensors->push_back(std::move(buffer_.front().value));
+          }
+          buffer_.pop_front();
+          *end_of_sequence = false;
+          // Wake a reader that may be waiting for buffer space.
+          cond_var_.notify_all();
+          return s;
+        }
+
+        DCHECK_EQ(num_active_readers_, 0);
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented(dataset()->DebugString(),
+                                     " does not support checkpointing");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(dataset()->DebugString(),
+                                     " does not support checkpointing");
+      }
+
+     private:
+      // A record produced by a reader thread, or the error encountered while
+      // producing it.
+      struct BufferElement {
+        Status status;
+        Tensor value;
+      };
+
+      void EnsureReaderThreadsStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (reader_threads_.empty()) {
+          num_active_readers_ = num_readers_;
+          std::shared_ptr<IteratorContext> new_ctx =
+              std::make_shared<IteratorContext>(*ctx);
+          reader_threads_.reserve(num_readers_);
+          for (int64 i = 0; i < num_readers_; ++i) {
+            reader_threads_.emplace_back(ctx->StartThread(
+                strings::StrCat("tf_data_parallel_tf_record_", i),
+                [this, new_ctx]() { ReaderThread(new_ctx); }));
+          }
+        }
+      }
+
+      // Claims files off the shared `next_file_index_` counter and reads them
+      // to completion, depositing one buffer element per record.  Record
+      // framing and CRC verification happen here, off the consumer thread.
+      // Records from concurrently-read files are interleaved in
+      // non-deterministic order.
+      void ReaderThread(const std::shared_ptr<IteratorContext>& ctx) {
+        RecordStart(ctx.get());
+        auto cleanup = gtl::MakeCleanup([this, ctx] {
+          {
+            mutex_lock l(mu_);
+            --num_active_readers_;
+            cond_var_.notify_all();
+          }
+          RecordStop(ctx.get());
+        });
+        while (true) {
+          size_t file_index;
+          {
+            mutex_lock l(mu_);
+            if (cancelled_ ||
+                next_file_index_ >= dataset()->filenames_.size()) {
+              return;
+            }
+            file_index = next_file_index_++;
+          }
+
+          std::unique_ptr<RandomAccessFile> file;
+          Status s = ctx->env()->NewRandomAccessFile(
+              dataset()->filenames_[file_index], &file);
+          if (!s.ok()) {
+            if (!ProduceElement({s, Tensor()})) {
+              return;
+            }
+            continue;
+          }
+          io::SequentialRecordReader reader(file.get(), dataset()->options_);
+          while (true) {
+            BufferElement element;
+            element.value =
+                Tensor(ctx->allocator({}), DT_STRING, TensorShape({}));
+            s = reader.ReadRecord(&element.value.scalar<string>()());
+            if (errors::IsOutOfRange(s)) {
+              // End of file; move on to the next one.
+              break;
+            }
+            element.status = s;
+            bool error = !s.ok();
+            if (!ProduceElement(std::move(element))) {
+              return;
+            }
+            if (error) {
+              // Like the serial TFRecord reader, surface the error and skip
+              // to the next file so that `ignore_errors` makes progress.
+              break;
+            }
+          }
+        }
+      }
+
+      // Blocks until there is space in `buffer_` and deposits `element`.
+      // Returns false if the iterator was cancelled.
+      bool ProduceElement(BufferElement element) {
+        mutex_lock l(mu_);
+        while (!cancelled_ &&
+               buffer_.size() >= static_cast<size_t>(buffer_limit_)) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_) {
+          return false;
+        }
+        buffer_.push_back(std::move(element));
+        cond_var_.notify_all();
+        return true;
+      }
+
+      const int64 num_readers_;
+      const int64 buffer_limit_;
+
+      mutex mu_;
+      condition_variable cond_var_;
+      std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
+      size_t next_file_index_ GUARDED_BY(mu_) = 0;
+      int64 num_active_readers_ GUARDED_BY(mu_) = 0;
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      std::vector<std::unique_ptr<Thread>> reader_threads_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const string compression_type_;
+    const int64 buffer_size_;
+    const int64 num_parallel_reads_;
+    io::RecordReaderOptions options_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("ExperimentalParallelTFRecordDataset").Device(DEVICE_CPU),
+    ParallelTFRecordDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
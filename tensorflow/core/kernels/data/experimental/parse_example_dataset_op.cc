@@ -143,11 +143,17 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       it->second = i++;
     }
 
+    // Compile the feature name -> config slot table once here, so that the
+    // per-batch parse does not rebuild it.
+    example::FastParseExampleConfigIndex config_index;
+    OP_REQUIRES_OK(ctx, config_index.Build(config));
+
     *output =
         new Dataset(ctx, input, dense_defaults, sparse_keys_, dense_keys_,
                     std::move(key_to_output_index), std::move(config),
-                    num_parallel_calls, sparse_types_, dense_types_,
-                    dense_shapes_, output_types_, output_shapes_, sloppy_);
+                    std::move(config_index), num_parallel_calls, sparse_types_,
+                    dense_types_, dense_shapes_, output_types_, output_shapes_,
+                    sloppy_);
   }
 
  private:
@@ -157,8 +163,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
             std::vector<Tensor> dense_defaults, std::vector<string> sparse_keys,
             std::vector<string> dense_keys,
             std::map<string, int> key_to_output_index,
-            example::FastParseExampleConfig config, int32 num_parallel_calls,
-            const DataTypeVector& sparse_types,
+            example::FastParseExampleConfig config,
+            example::FastParseExampleConfigIndex config_index,
+            int32 num_parallel_calls, const DataTypeVector& sparse_types,
             const DataTypeVector& dense_types,
             const std::vector<PartialTensorShape>& dense_shapes,
             const DataTypeVector& output_types,
@@ -170,6 +177,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           dense_keys_(std::move(dense_keys)),
           key_to_output_index_(std::move(key_to_output_index)),
           config_(std::move(config)),
+          config_index_(std::move(config_index)),
           num_parallel_calls_(num_parallel_calls),
           sparse_types_(sparse_types),
           dense_types_(dense_types),
@@ -268,23 +276,36 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         (*ctx->runner())([this, ctx, prefix, input, output, callback]() {
           thread::ThreadPool* device_threadpool =
               ctx->lib()->device()->tensorflow_cpu_worker_threads()->workers;
+          // In the common single-component case, parse straight out of the
+          // input tensor's buffer (kept alive by the `input` capture); only
+          // fall back to copying when the strings span several tensors.
+          gtl::ArraySlice<string> serialized;
           std::vector<string> slice_vec;
-          for (const Tensor& t : input) {
-            auto serialized_t = t.flat<string>();
-            gtl::ArraySlice<string> slice(serialized_t.data(),
-                                          serialized_t.size());
-            for (auto it = slice.begin(); it != slice.end(); it++)
-              slice_vec.push_back(*it);
+          if (input.size() == 1) {
+            auto serialized_t = input[0].flat<string>();
+            serialized =
+                gtl::ArraySlice<string>(serialized_t.data(), serialized_t.size());
+          } else {
+            for (const Tensor& t : input) {
+              auto serialized_t = t.flat<string>();
+              slice_vec.insert(slice_vec.end(), serialized_t.data(),
+                               serialized_t.data() + serialized_t.size());
+            }
+            serialized = slice_vec;
           }
-          example::FastParseExampleConfig config = dataset_->config_;
-          // local copy of config_ for modification.
+          const example::FastParseExampleConfig* config = &dataset_->config_;
+          example::FastParseExampleConfig stats_config;
           auto stats_aggregator = ctx->stats_aggregator();
           if (stats_aggregator) {
-            config.collect_feature_stats = true;
+            // local copy of config_ for modification.
+            stats_config = dataset_->config_;
+            stats_config.collect_feature_stats = true;
+            config = &stats_config;
           }
           example::Result example_result;
-          Status s = FastParseExample(config, slice_vec, {}, device_threadpool,
-                                      &example_result);
+          Status s = FastParseExample(*config, serialized, {},
+                                      device_threadpool, &example_result,
+                                      dataset_->config_index_);
           if (s.ok()) {
             (*output).resize(dataset_->key_to_output_index_.size());
             for (int d = 0; d < dataset_->dense_keys_.size(); ++d) {
@@ -374,6 +395,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     const std::vector<string> dense_keys_;
     const std::map<string, int> key_to_output_index_;
     const example::FastParseExampleConfig config_;
+    const example::FastParseExampleConfigIndex config_index_;
     const int64 num_parallel_calls_;
     const DataTypeVector sparse_types_;
     const DataTypeVector dense_types_;
@@ -0,0 +1,655 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <deque>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// See documentation in ../../../ops/experimental_dataset_ops.cc for a
+// high-level description of the following op.
+//
+// The snapshot of a pipeline lives in `<path>/<fingerprint>/`, where the
+// fingerprint is a hash of the serialized input pipeline graph, so that a
+// changed preprocessing function materializes into a fresh directory. A run
+// writes its elements to sharded, ZLIB-compressed record files named
+// `<run_id>.<shard>.snapshot` and, once the input is exhausted, publishes
+// them by writing the run id into `snapshot.done`. Runs that start before
+// the done-file exists each write their own set of shards; the first run to
+// finish wins and the others discard their files. Later iterations find the
+// done-file and read the published shards back in parallel instead of
+// re-running the input pipeline.
+
+constexpr char kSnapshotDatasetName[] = "Snapshot";
+
+// Name of the file whose presence marks a snapshot as complete. It contains
+// the run id whose shards make up the snapshot.
+constexpr char kSnapshotDoneFileName[] = "snapshot.done";
+
+// Compression applied to the record files.
+constexpr char kSnapshotCompression[] = "ZLIB";
+
+// A shard file is rotated once its uncompressed payload exceeds this size.
+constexpr uint64 kMaxShardSizeBytes = 10LL * 1024 * 1024 * 1024;  // 10GB
+
+// Number of elements the writer thread may have queued behind the consumer.
+// Writing proceeds off the critical path until the queue fills up, at which
+// point the pipeline is throttled to the speed of the file system.
+constexpr int64 kWriterQueueSize = 64;
+
+// Number of shard files read concurrently on subsequent runs, and the number
+// of decoded elements each reader may have buffered.
+constexpr int64 kSnapshotReaderThreads = 4;
+constexpr int64 kBufferedElementsPerReader = 16;
+
+// Serializes `element` as a length-prefixed sequence of `TensorProto`s.
+void EncodeElement(const std::vector<Tensor>& element, string* record) {
+  record->clear();
+  core::PutFixed64(record, element.size());
+  for (const Tensor& t : element) {
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    core::PutFixed64(record, proto.ByteSizeLong());
+    proto.AppendToString(record);
+  }
+}
+
+// Inverse of `EncodeElement`. Returns `DataLoss` if `record` is corrupt or
+// does not match the expected element arity.
+Status DecodeElement(const string& record, size_t num_components,
+                     std::vector<Tensor>* element) {
+  const char* data = record.data();
+  size_t remaining = record.size();
+  if (remaining < sizeof(uint64)) {
+    return errors::DataLoss("Snapshot record is truncated.");
+  }
+  uint64 num_tensors = core::DecodeFixed64(data);
+  data += sizeof(uint64);
+  remaining -= sizeof(uint64);
+  if (num_tensors != num_components) {
+    return errors::DataLoss("Snapshot record has ", num_tensors,
+                            " components but the dataset expects ",
+                            num_components, ".");
+  }
+  element->reserve(num_tensors);
+  for (uint64 i = 0; i < num_tensors; ++i) {
+    if (remaining < sizeof(uint64)) {
+      return errors::DataLoss("Snapshot record is truncated.");
+    }
+    uint64 proto_size = core::DecodeFixed64(data);
+    data += sizeof(uint64);
+    remaining -= sizeof(uint64);
+    if (remaining < proto_size) {
+      return errors::DataLoss("Snapshot record is truncated.");
+    }
+    TensorProto proto;
+    if (!proto.ParseFromArray(data, proto_size)) {
+      return errors::DataLoss("Failed to parse tensor in snapshot record.");
+    }
+    Tensor t;
+    if (!t.FromProto(proto)) {
+      return errors::DataLoss("Failed to decode tensor in snapshot record.");
+    }
+    element->push_back(std::move(t));
+    data += proto_size;
+    remaining -= proto_size;
+  }
+  if (remaining != 0) {
+    return errors::DataLoss("Snapshot record has ", remaining,
+                            " trailing bytes.");
+  }
+  return Status::OK();
+}
+
+class SnapshotDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  using UnaryDatasetOpKernel::UnaryDatasetOpKernel;
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    string path;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "path", &path));
+
+    // Key the snapshot by the input pipeline graph, so that snapshots taken
+    // of different preprocessing pipelines do not collide under one path.
+    GraphDef graph_def;
+    OP_REQUIRES_OK(ctx, AsGraphDef(ctx, input, &graph_def));
+    uint64 graph_fingerprint = Hash64(graph_def.SerializeAsString());
+
+    *output = new Dataset(ctx, input, path, graph_fingerprint);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    explicit Dataset(OpKernelContext* ctx, const DatasetBase* input,
+                     const string& path, uint64 graph_fingerprint)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          path_(path),
+          snapshot_dir_(io::JoinPath(
+              path, strings::StrCat(strings::Hex(graph_fingerprint,
+                                                 strings::kZeroPad16)))),
+          env_(ctx->env()) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(Iterator::Params{
+          this, strings::StrCat(prefix, "::", kSnapshotDatasetName)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return "SnapshotDatasetOp::Dataset";
+    }
+
+    int64 Cardinality() const override { return input_->Cardinality(); }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+      Node* path = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(path_, &path));
+      TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph_node, path}, output));
+      return Status::OK();
+    }
+
+   private:
+    string DoneFilePath() const {
+      return io::JoinPath(snapshot_dir_, kSnapshotDoneFileName);
+    }
+
+    string ShardFilePath(const string& run_id, int64 shard_index) const {
+      return io::JoinPath(
+          snapshot_dir_,
+          strings::StrCat(
+              run_id, ".",
+              strings::Printf("%08lld", static_cast<long long>(shard_index)),
+              ".snapshot"));
+    }
+
+    // The `Iterator` decides at construction time whether this run reads a
+    // published snapshot or writes a new one, and delegates to the
+    // corresponding inner iterator. The decision is made once per iterator:
+    // a run that starts writing keeps writing even if a concurrent run
+    // publishes first; the slower run's shards are discarded when it
+    // finishes.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {
+        string done_contents;
+        if (ReadFileToString(dataset()->env_, dataset()->DoneFilePath(),
+                             &done_contents)
+                .ok()) {
+          iterator_ = absl::make_unique<ReaderIterator>(
+              Params{dataset(), prefix()}, done_contents);
+        } else {
+          iterator_ =
+              absl::make_unique<WriterIterator>(Params{dataset(), prefix()});
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        return iterator_->Initialize(ctx);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented(dataset()->DebugString(),
+                                     " does not support checkpointing");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(dataset()->DebugString(),
+                                     " does not support checkpointing");
+      }
+
+     private:
+      // Passes elements of the input pipeline through while writing them to
+      // shard files on a background thread. The consumer only blocks on the
+      // file system when the write queue is full. Once the input is
+      // exhausted, the writer drains the queue, closes its shards and
+      // attempts to publish them via the done-file.
+      class WriterIterator : public DatasetIterator<Dataset> {
+       public:
+        explicit WriterIterator(const Params& params)
+            : DatasetIterator<Dataset>(params),
+              run_id_(strings::StrCat(
+                  strings::Hex(random::New64(), strings::kZeroPad16))) {}
+
+        ~WriterIterator() override {
+          mutex_lock l(mu_);
+          cancelled_ = true;
+          cond_var_.notify_all();
+        }
+
+        Status Initialize(IteratorContext* ctx) override {
+          TF_RETURN_IF_ERROR(
+              ctx->env()->RecursivelyCreateDir(dataset()->snapshot_dir_));
+          return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+        }
+
+        Status GetNextInternal(IteratorContext* ctx,
+                               std::vector<Tensor>* out_tensors,
+                               bool* end_of_sequence) override {
+          EnsureWriterThreadStarted(ctx);
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+          mutex_lock l(mu_);
+          if (*end_of_sequence) {
+            // Wait for the writer to drain the queue and publish the run.
+            end_of_input_ = true;
+            cond_var_.notify_all();
+            while (!writing_completed_) {
+              RecordStop(ctx);
+              cond_var_.wait(l);
+              RecordStart(ctx);
+            }
+            return writer_status_;
+          }
+          TF_RETURN_IF_ERROR(writer_status_);
+          while (queue_.size() >= kWriterQueueSize && !writing_completed_) {
+            RecordStop(ctx);
+            cond_var_.wait(l);
+            RecordStart(ctx);
+          }
+          TF_RETURN_IF_ERROR(writer_status_);
+          queue_.push_back(*out_tensors);
+          cond_var_.notify_all();
+          return Status::OK();
+        }
+
+       protected:
+        std::shared_ptr<model::Node> CreateNode(
+            IteratorContext* ctx, model::Node::Args args) const override {
+          return model::MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+        }
+
+        Status SaveInternal(IteratorStateWriter* writer) override {
+          return errors::Unimplemented(dataset()->DebugString(),
+                                       " does not support checkpointing");
+        }
+
+        Status RestoreInternal(IteratorContext* ctx,
+                               IteratorStateReader* reader) override {
+          return errors::Unimplemented(dataset()->DebugString(),
+                                       " does not support checkpointing");
+        }
+
+       private:
+        void EnsureWriterThreadStarted(IteratorContext* ctx) {
+          mutex_lock l(mu_);
+          if (!writer_thread_) {
+            std::shared_ptr<IteratorContext> new_ctx =
+                std::make_shared<IteratorContext>(*ctx);
+            writer_thread_ = ctx->StartThread(
+                "tf_data_snapshot_write",
+                [this, new_ctx]() { WriterThread(new_ctx); });
+          }
+        }
+
+        void WriterThread(const std::shared_ptr<IteratorContext>& ctx) {
+          RecordStart(ctx.get());
+          Status status = WriteLoop(ctx->env());
+          mutex_lock l(mu_);
+          writer_status_ = status;
+          writing_completed_ = true;
+          // Drop whatever is still queued so the consumer never blocks on a
+          // writer that is gone.
+          queue_.clear();
+          cond_var_.notify_all();
+          RecordStop(ctx.get());
+        }
+
+        // Consumes the queue until the input ends, writing one record per
+        // element and rotating shard files as they fill up. On success the
+        // run is published unless a concurrent run finished first, in which
+        // case (as on cancellation) this run's shards are discarded.
+        Status WriteLoop(Env* env) {
+          int64 shard_index = 0;
+          uint64 shard_bytes = 0;
+          std::vector<string> written_shards;
+          std::unique_ptr<WritableFile> shard_file;
+          std::unique_ptr<io::RecordWriter> record_writer;
+          string record;
+          auto close_shard = [&]() -> Status {
+            if (record_writer) {
+              TF_RETURN_IF_ERROR(record_writer->Close());
+              record_writer.reset();
+              TF_RETURN_IF_ERROR(shard_file->Close());
+              shard_file.reset();
+            }
+            return Status::OK();
+          };
+          auto discard_shards = [&]() {
+            close_shard().IgnoreError();
+            for (const string& shard : written_shards) {
+              env->DeleteFile(shard).IgnoreError();
+            }
+          };
+          while (true) {
+            std::vector<Tensor> element;
+            {
+              mutex_lock l(mu_);
+              while (!cancelled_ && queue_.empty() && !end_of_input_) {
+                cond_var_.wait(l);
+              }
+              if (cancelled_) {
+                // The iterator went away before the input was exhausted;
+                // the partial run will never be published.
+                discard_shards();
+                return Status::OK();
+              }
+              if (queue_.empty() && end_of_input_) {
+                break;
+              }
+              element = std::move(queue_.front());
+              queue_.pop_front();
+              cond_var_.notify_all();
+            }
+            if (!record_writer) {
+              const string shard_path =
+                  dataset()->ShardFilePath(run_id_, shard_index);
+              TF_RETURN_IF_ERROR(env->NewWritableFile(shard_path, &shard_file));
+              record_writer = absl::make_unique<io::RecordWriter>(
+                  shard_file.get(),
+                  io::RecordWriterOptions::CreateRecordWriterOptions(
+                      kSnapshotCompression));
+              written_shards.push_back(shard_path);
+            }
+            EncodeElement(element, &record);
+            TF_RETURN_IF_ERROR(record_writer->WriteRecord(record));
+            shard_bytes += record.size();
+            if (shard_bytes >= kMaxShardSizeBytes) {
+              TF_RETURN_IF_ERROR(close_shard());
+              ++shard_index;
+              shard_bytes = 0;
+            }
+          }
+          TF_RETURN_IF_ERROR(close_shard());
+          if (env->FileExists(dataset()->DoneFilePath()).ok()) {
+            // A concurrent run published first; its shards serve all future
+            // readers, so this run's copies are redundant.
+            LOG(INFO) << "Snapshot at " << dataset()->snapshot_dir_
+                      << " was already published by a concurrent run; "
+                      << "discarding run " << run_id_ << ".";
+            discard_shards();
+            return Status::OK();
+          }
+          return WriteStringToFile(env, dataset()->DoneFilePath(), run_id_);
+        }
+
+        const string run_id_;
+
+        mutex mu_;
+        condition_variable cond_var_;
+        std::unique_ptr<IteratorBase> input_impl_;
+        std::deque<std::vector<Tensor>> queue_ GUARDED_BY(mu_);
+        Status writer_status_ GUARDED_BY(mu_);
+        bool end_of_input_ GUARDED_BY(mu_) = false;
+        bool writing_completed_ GUARDED_BY(mu_) = false;
+        bool cancelled_ GUARDED_BY(mu_) = false;
+        std::unique_ptr<Thread> writer_thread_ GUARDED_BY(mu_);
+      };  // WriterIterator
+
+      // Serves a published snapshot by reading its shard files concurrently,
+      // one reader thread per file, into a bounded element buffer. Elements
+      // from concurrently-read shards are interleaved in non-deterministic
+      // order, like `ExperimentalParallelTFRecordDataset`.
+      class ReaderIterator : public DatasetIterator<Dataset> {
+       public:
+        explicit ReaderIterator(const Params& params, const string& run_id)
+            : DatasetIterator<Dataset>(params), run_id_(run_id) {}
+
+        ~ReaderIterator() override {
+          mutex_lock l(mu_);
+          cancelled_ = true;
+          cond_var_.notify_all();
+        }
+
+        Status Initialize(IteratorContext* ctx) override {
+          // An empty shard list is legitimate: a snapshot of an empty input
+          // consists of the done-file alone.
+          TF_RETURN_IF_ERROR(ctx->env()->GetMatchingPaths(
+              io::JoinPath(dataset()->snapshot_dir_,
+                           strings::StrCat(run_id_, ".*.snapshot")),
+              &shards_));
+          std::sort(shards_.begin(), shards_.end());
+          num_readers_ = std::min<int64>(kSnapshotReaderThreads,
+                                         static_cast<int64>(shards_.size()));
+          buffer_limit_ = std::max<int64>(num_readers_, 1) *
+                          kBufferedElementsPerReader;
+          return Status::OK();
+        }
+
+        Status GetNextInternal(IteratorContext* ctx,
+                               std::vector<Tensor>* out_tensors,
+                               bool* end_of_sequence) override {
+          mutex_lock l(mu_);
+          EnsureReaderThreadsStarted(ctx);
+          while (!cancelled_ && buffer_.empty() && num_active_readers_ > 0) {
+            RecordStop(ctx);
+            cond_var_.wait(l);
+            RecordStart(ctx);
+          }
+          if (cancelled_) {
+            return errors::Cancelled(
+                "SnapshotDatasetOp::Dataset::Iterator::ReaderIterator");
+          }
+          if (!buffer_.empty()) {
+            Status s = std::move(buffer_.front().status);
+            if (s.ok()) {
+              *out_tensors = std::move(buffer_.front().element);
+            }
+            buffer_.pop_front();
+            *end_of_sequence = false;
+            // Wake a reader that may be waiting for buffer space.
+            cond_var_.notify_all();
+            return s;
+          }
+          DCHECK_EQ(num_active_readers_, 0);
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+       protected:
+        std::shared_ptr<model::Node> CreateNode(
+            IteratorContext* ctx, model::Node::Args args) const override {
+          return model::MakeSourceNode(std::move(args));
+        }
+
+        Status SaveInternal(IteratorStateWriter* writer) override {
+          return errors::Unimplemented(dataset()->DebugString(),
+                                       " does not support checkpointing");
+        }
+
+        Status RestoreInternal(IteratorContext* ctx,
+                               IteratorStateReader* reader) override {
+          return errors::Unimplemented(dataset()->DebugString(),
+                                       " does not support checkpointing");
+        }
+
+       private:
+        struct BufferElement {
+          Status status;
+          std::vector<Tensor> element;
+        };
+
+        void EnsureReaderThreadsStarted(IteratorContext* ctx)
+            EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          if (threads_started_) {
+            return;
+          }
+          threads_started_ = true;
+          num_active_readers_ = num_readers_;
+          std::shared_ptr<IteratorContext> new_ctx =
+              std::make_shared<IteratorContext>(*ctx);
+          reader_threads_.reserve(num_readers_);
+          for (int64 i = 0; i < num_readers_; ++i) {
+            reader_threads_.emplace_back(ctx->StartThread(
+                strings::StrCat("tf_data_snapshot_read_", i),
+                [this, new_ctx]() { ReaderThread(new_ctx); }));
+          }
+        }
+
+        // Claims shard files off the shared `next_shard_index_` counter and
+        // reads them to completion, decoding one buffer element per record.
+        void ReaderThread(const std::shared_ptr<IteratorContext>& ctx) {
+          RecordStart(ctx.get());
+          auto cleanup = gtl::MakeCleanup([this, ctx] {
+            {
+              mutex_lock l(mu_);
+              --num_active_readers_;
+              cond_var_.notify_all();
+            }
+            RecordStop(ctx.get());
+          });
+          const size_t num_components = dataset()->output_dtypes().size();
+          while (true) {
+            size_t shard_index;
+            {
+              mutex_lock l(mu_);
+              if (cancelled_ || next_shard_index_ >= shards_.size()) {
+                return;
+              }
+              shard_index = next_shard_index_++;
+            }
+            std::unique_ptr<RandomAccessFile> file;
+            Status s =
+                ctx->env()->NewRandomAccessFile(shards_[shard_index], &file);
+            if (!s.ok()) {
+              ProduceElement({s, {}});
+              return;
+            }
+            io::SequentialRecordReader reader(
+                file.get(),
+                io::RecordReaderOptions::CreateRecordReaderOptions(
+                    kSnapshotCompression));
+            while (true) {
+              string record;
+              s = reader.ReadRecord(&record);
+              if (errors::IsOutOfRange(s)) {
+                // End of shard; move on to the next one.
+                break;
+              }
+              BufferElement buffer_element;
+              buffer_element.status = s;
+              if (s.ok()) {
+                buffer_element.status = DecodeElement(
+                    record, num_components, &buffer_element.element);
+              }
+              bool error = !buffer_element.status.ok();
+              if (!ProduceElement(std::move(buffer_element)) || error) {
+                // A snapshot is all-or-nothing: a corrupt shard fails the
+                // iterator rather than silently dropping elements.
+                return;
+              }
+            }
+          }
+        }
+
+        // Blocks until there is space in `buffer_` and deposits `element`.
+        // Returns false if the iterator was cancelled.
+        bool ProduceElement(BufferElement element) {
+          mutex_lock l(mu_);
+          while (!cancelled_ &&
+                 buffer_.size() >= static_cast<size_t>(buffer_limit_)) {
+            cond_var_.wait(l);
+          }
+          if (cancelled_) {
+            return false;
+          }
+          buffer_.push_back(std::move(element));
+          cond_var_.notify_all();
+          return true;
+        }
+
+        const string run_id_;
+        std::vector<string> shards_;
+        int64 num_readers_ = 0;
+        int64 buffer_limit_ = 0;
+
+        mutex mu_;
+        condition_variable cond_var_;
+        std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
+        size_t next_shard_index_ GUARDED_BY(mu_) = 0;
+        int64 num_active_readers_ GUARDED_BY(mu_) = 0;
+        bool threads_started_ GUARDED_BY(mu_) = false;
+        bool cancelled_ GUARDED_BY(mu_) = false;
+        std::vector<std::unique_ptr<Thread>> reader_threads_ GUARDED_BY(mu_);
+      };  // ReaderIterator
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> iterator_ GUARDED_BY(mu_);
+    };  // Iterator
+
+    const DatasetBase* const input_;
+    const string path_;
+    const string snapshot_dir_;
+    Env* const env_;  // Not owned.
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("ExperimentalSnapshotDataset").Device(DEVICE_CPU),
+                        SnapshotDatasetOp);
+
+}  // namespace data
+}  // namespace tensorflow
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/iterator_ops.h"
+#include <atomic>
 #include <memory>
 
 #include "absl/memory/memory.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/element_arena_allocator.h"
 #include "tensorflow/core/kernels/data/optional_ops.h"
 #include "tensorflow/core/kernels/data/unbounded_thread_pool.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -38,7 +40,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -49,6 +53,36 @@ namespace {
 
 const char kIteratorVariantTypeName[] = "tensorflow::Iterator";
 
+// Returns whether output tensors produced through an `IteratorResource`
+// should be carved from a per-iterator arena instead of being allocated
+// individually. Off by default; set the `TF_DATA_ELEMENT_ARENA` environment
+// variable to `true` to opt in.
+bool ElementArenaEnabled() {
+  bool enabled;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_DATA_ELEMENT_ARENA", false, &enabled));
+  return enabled;
+}
+
+// Returns the NUMA node that background threads of a new `IteratorResource`
+// should be pinned to, or kNUMANoAffinity if NUMA-aware execution is not
+// enabled or not applicable. Off by default; set the `TF_DATA_NUMA_AWARE`
+// environment variable to `true` to opt in. Iterator resources are assigned
+// to nodes round-robin, so concurrent pipelines spread across the sockets
+// while each individual pipeline stays node-local.
+int ChooseNumaNode() {
+  bool enabled;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_DATA_NUMA_AWARE", false, &enabled));
+  if (!enabled || !port::NUMAEnabled()) {
+    return port::kNUMANoAffinity;
+  }
+  const int num_nodes = port::NUMANumNodes();
+  if (num_nodes <= 1) {
+    return port::kNUMANoAffinity;
+  }
+  static std::atomic<int> next_node(0);
+  return next_node.fetch_add(1) % num_nodes;
+}
+
 }  // namespace
 
 class IteratorResource : public ResourceBase {
@@ -61,11 +95,26 @@ class IteratorResource : public ResourceBase {
                    std::unique_ptr<ProcessFunctionLibraryRuntime> pflr,
                    FunctionLibraryRuntime* lib)
       : unbounded_thread_pool_(env, "tf_data_iterator_resource"),
+        numa_node_(ChooseNumaNode()),
         device_mgr_(std::move(device_mgr)),
         iterator_state_(std::make_shared<State>(
             std::move(flib_def), std::move(pflr), lib, nullptr /* iterator */)),
         output_dtypes_(output_dtypes),
-        output_shapes_(output_shapes) {}
+        output_shapes_(output_shapes) {
+    if (ElementArenaEnabled()) {
+      DeviceBase* device = lib->device();
+      element_arena_ = new ElementArenaAllocator(
+          device->GetAllocator(AllocatorAttributes()));
+    }
+  }
+
+  ~IteratorResource() override {
+    if (element_arena_ != nullptr) {
+      // The arena deletes itself once the last tensor allocated from it has
+      // been destroyed, which may be after this resource is gone.
+      element_arena_->Release();
+    }
+  }
 
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) {
@@ -81,6 +130,20 @@ class IteratorResource : public ResourceBase {
           captured_state->function_handle_cache.get();
       params.resource_mgr = &captured_state->resource_mgr;
       params.thread_factory = unbounded_thread_pool_.get_thread_factory();
+      params.numa_node = numa_node_;
+      if (element_arena_ != nullptr && params.allocator_getter != nullptr) {
+        // Serve element allocations from the per-iterator arena; requests
+        // for memory the arena does not manage resolve as before.
+        std::function<Allocator*(AllocatorAttributes)> base_getter =
+            params.allocator_getter;
+        ElementArenaAllocator* arena = element_arena_;
+        params.allocator_getter = [base_getter,
+                                   arena](AllocatorAttributes attrs) {
+          Allocator* base = base_getter(attrs);
+          return arena->WrapsBase(base) ? static_cast<Allocator*>(arena)
+                                        : base;
+        };
+      }
       return captured_state->iterator->GetNext(
           IteratorContext(std::move(params)), out_tensors, end_of_sequence);
     } else {
@@ -158,6 +221,7 @@ class IteratorResource : public ResourceBase {
     params.function_handle_cache = new_state->function_handle_cache.get();
     params.resource_mgr = &new_state->resource_mgr;
     params.thread_factory = unbounded_thread_pool_.get_thread_factory();
+    params.numa_node = numa_node_;
 
     TF_RETURN_IF_ERROR(dataset->MakeIterator(IteratorContext(std::move(params)),
                                              "Iterator", &new_state->iterator));
@@ -176,6 +240,7 @@ class IteratorResource : public ResourceBase {
         return device->GetAllocator(attrs);
       };
       params.thread_factory = unbounded_thread_pool_.get_thread_factory();
+      params.numa_node = numa_node_;
       IteratorContext iter_ctx(std::move(params));
       TF_RETURN_IF_ERROR(new_state->iterator->Restore(&iter_ctx, reader));
     }
@@ -231,6 +296,7 @@ class IteratorResource : public ResourceBase {
     params.function_handle_cache = new_state->function_handle_cache.get();
     params.resource_mgr = &new_state->resource_mgr;
     params.thread_factory = unbounded_thread_pool_.get_thread_factory();
+    params.numa_node = numa_node_;
     TF_RETURN_IF_ERROR(dataset->MakeIterator(IteratorContext(std::move(params)),
                                              "Iterator", &iterator));
     TF_RETURN_IF_ERROR(
@@ -283,6 +349,12 @@ class IteratorResource : public ResourceBase {
   };
 
   UnboundedThreadPool unbounded_thread_pool_;
+  // NUMA node that this iterator's background threads are pinned to, or
+  // kNUMANoAffinity. Assigned round-robin when `TF_DATA_NUMA_AWARE` is set.
+  const int numa_node_;
+  // Self-owned; released in the destructor. Null unless enabled via the
+  // `TF_DATA_ELEMENT_ARENA` environment variable.
+  ElementArenaAllocator* element_arena_ = nullptr;
   mutex mu_;
   const std::unique_ptr<DeviceMgr> device_mgr_ GUARDED_BY(mu_);
   std::shared_ptr<State> iterator_state_ GUARDED_BY(mu_);
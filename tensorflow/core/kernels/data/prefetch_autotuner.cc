@@ -15,25 +15,105 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "tensorflow/core/util/env_var.h"
+
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Determines what strategy to use for increasing the buffer size limit. For
+// limits less than the threshold, an exponential increase is used, while for
+// limits greater than or equal to the threshold, a linear increase is used.
+size_t kBufferLimitThreshold = 2048;
+
+// Weight given to history in the rate-tracking EWMAs.
+constexpr double kEwmaDecay = 0.9;
+
+// Number of produced elements between recomputations of the rate-based limit.
+constexpr int64 kRetuneInterval = 32;
+
+// Upper bound on the rate-based limit, matching the point at which the
+// default mode switches from exponential to linear growth.
+constexpr int64 kMaxRateBasedLimit = 2048;
+
+// Bytes that rate-tracking autotuners in this process may collectively hold
+// in their buffers.  Zero means unlimited.
+struct PrefetchBufferBudget {
+  int64 budget_bytes;
+  std::atomic<int64> reserved_bytes;
+};
+
+PrefetchBufferBudget* SharedBudget() {
+  static PrefetchBufferBudget* budget = [] {
+    PrefetchBufferBudget* b = new PrefetchBufferBudget;
+    int64 budget_mb;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_DATA_PREFETCH_BUFFER_BUDGET_MB", 0,
+                                    &budget_mb));
+    b->budget_bytes = budget_mb << 20;
+    b->reserved_bytes = 0;
+    return b;
+  }();
+  return budget;
+}
+
+// Updates `*ewma` towards `sample`, treating an exactly-zero EWMA as
+// uninitialized.
+void UpdateEwma(double sample, double* ewma) {
+  if (*ewma == 0.0) {
+    *ewma = sample;
+  } else {
+    *ewma = kEwmaDecay * *ewma + (1.0 - kEwmaDecay) * sample;
+  }
+}
+
+}  // namespace
 
 PrefetchAutotuner::PrefetchAutotuner(int64 initial_buffer_size)
     : buffer_limit_(initial_buffer_size) {
   if (initial_buffer_size == kAutoTune) {
-    mode_ = Mode::kUpswing;
+    bool rate_based;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_DATA_PREFETCH_AUTOTUNE_RATE_BASED",
+                                   false, &rate_based));
+    mode_ = rate_based ? Mode::kRateTracking : Mode::kUpswing;
     buffer_limit_ = 1;
   }
 }
 
-namespace {
-// Determines what strategy to use for increasing the buffer size limit. For
-// limits less than the threshold, an exponential increase is used, while for
-// limits greater than or equal to the threshold, a linear increase is used.
-size_t kBufferLimitThreshold = 2048;
-}  // namespace
+PrefetchAutotuner::~PrefetchAutotuner() {
+  if (reserved_bytes_ > 0) {
+    SharedBudget()->reserved_bytes.fetch_sub(reserved_bytes_,
+                                             std::memory_order_relaxed);
+  }
+}
 
-void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
+void PrefetchAutotuner::RecordProduction(int64 bytes, int64 now_micros) {
+  if (mode_ != Mode::kRateTracking) {
+    return;
+  }
+  if (bytes > 0) {
+    UpdateEwma(static_cast<double>(bytes), &element_bytes_ewma_);
+  }
+  if (last_production_micros_ != 0 && now_micros > last_production_micros_) {
+    const double interval =
+        static_cast<double>(now_micros - last_production_micros_);
+    if (producer_interval_ewma_ != 0.0) {
+      const double deviation = interval - producer_interval_ewma_;
+      UpdateEwma(deviation * deviation, &producer_interval_var_ewma_);
+    }
+    UpdateEwma(interval, &producer_interval_ewma_);
+  }
+  last_production_micros_ = now_micros;
+  if (++num_productions_ % kRetuneInterval == 0) {
+    UpdateRateBasedLimit();
+  }
+}
+
+void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size,
+                                          int64 now_micros) {
   switch (mode_) {
     case Mode::kDisabled:
       return;
@@ -52,7 +132,61 @@ void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
         mode_ = Mode::kUpswing;
       }
       return;
+    case Mode::kRateTracking:
+      if (now_micros > last_consumption_micros_ &&
+          last_consumption_micros_ != 0) {
+        UpdateEwma(static_cast<double>(now_micros - last_consumption_micros_),
+                   &consumer_interval_ewma_);
+      }
+      if (now_micros != 0) {
+        last_consumption_micros_ = now_micros;
+      }
+      return;
+  }
+}
+
+void PrefetchAutotuner::UpdateRateBasedLimit() {
+  if (producer_interval_ewma_ <= 0.0 || consumer_interval_ewma_ <= 0.0) {
+    return;
+  }
+  // Cover the mean production interval plus two standard deviations with
+  // elements drained at the observed consumption rate, so the consumer stays
+  // busy across producer bursts.  A producer that is simply slower than the
+  // consumer yields a small limit: buffering cannot fix a throughput-bound
+  // pipeline.
+  const double producer_stddev = std::sqrt(producer_interval_var_ewma_);
+  const double target = (producer_interval_ewma_ + 2.0 * producer_stddev) /
+                            consumer_interval_ewma_ +
+                        1.0;
+  int64 new_limit = static_cast<int64>(std::ceil(target));
+  new_limit = std::max<int64>(1, std::min<int64>(new_limit, kMaxRateBasedLimit));
+
+  // Respect the process-wide byte budget, claiming (or returning) the
+  // difference between what this stage holds and what the new limit needs.
+  PrefetchBufferBudget* budget = SharedBudget();
+  const int64 element_bytes = static_cast<int64>(element_bytes_ewma_);
+  if (budget->budget_bytes > 0 && element_bytes > 0) {
+    int64 want_bytes = new_limit * element_bytes;
+    const int64 delta = want_bytes - reserved_bytes_;
+    if (delta > 0) {
+      const int64 prev =
+          budget->reserved_bytes.fetch_add(delta, std::memory_order_relaxed);
+      if (prev + delta > budget->budget_bytes) {
+        // Over budget: keep only what remains and shrink the limit to match.
+        // Every stage retains a floor of one element so pipelines never
+        // deadlock, even if that overshoots a very small budget.
+        const int64 granted = std::max<int64>(0, budget->budget_bytes - prev);
+        budget->reserved_bytes.fetch_sub(delta - granted,
+                                         std::memory_order_relaxed);
+        want_bytes = reserved_bytes_ + granted;
+        new_limit = std::max<int64>(1, want_bytes / element_bytes);
+      }
+    } else if (delta < 0) {
+      budget->reserved_bytes.fetch_sub(-delta, std::memory_order_relaxed);
+    }
+    reserved_bytes_ = want_bytes;
   }
+  buffer_limit_ = new_limit;
 }
 
 }  // namespace data
@@ -33,8 +33,17 @@ namespace data {
 // if the prefetching thread is able to successfully fill the buffer at its
 // current size.
 //
-// Note: in the current implementation, we never decrease the buffer_limit().
-// This should change in the future!
+// In the default mode the limit only ever grows, doubling whenever the
+// consumer finds the buffer empty.  Setting
+// TF_DATA_PREFETCH_AUTOTUNE_RATE_BASED=true selects a rate-tracking mode
+// instead: the autotuner maintains exponentially-weighted moving averages of
+// the producer and consumer rates (and of the producer's latency variance) and
+// sets the limit to cover the measured rate gap directly, which converges in
+// tens of elements rather than thousands and can also shrink the buffer.  In
+// that mode, TF_DATA_PREFETCH_BUFFER_BUDGET_MB bounds the total bytes
+// buffered across all rate-tracking prefetch stages in the process.
+//
+// Note: in the default mode, we never decrease the buffer_limit().
 //
 // PrefetchAutotuner is NOT thread safe.
 class PrefetchAutotuner {
@@ -42,10 +51,18 @@ class PrefetchAutotuner {
   static const int64 kAutoTune = -1;
 
   explicit PrefetchAutotuner(int64 initial_buffer_size);
+  ~PrefetchAutotuner();
 
   int64 buffer_limit() const { return buffer_limit_; }
 
-  void RecordConsumption(size_t current_buffer_size);
+  // Records that the producer added an element of `bytes` bytes to the buffer
+  // at time `now_micros`.  Only used in rate-tracking mode.
+  void RecordProduction(int64 bytes, int64 now_micros);
+
+  // Records that the consumer observed `current_buffer_size` buffered
+  // elements.  `now_micros` feeds the consumer-rate estimate in rate-tracking
+  // mode; callers that only use the default mode may omit it.
+  void RecordConsumption(size_t current_buffer_size, int64 now_micros = 0);
   void RecordEmpty() { RecordConsumption(0); }
 
  private:
@@ -61,10 +78,30 @@ class PrefetchAutotuner {
     // We have successfully filled a buffer of this size. If we ever block the
     // downstream iterator, we should increase the buffer size.
     kDownswing,
+
+    // Tracks producer/consumer rate EWMAs and derives the limit from the
+    // measured rate gap instead of walking the state machine.
+    kRateTracking,
   };
 
+  // Recomputes `buffer_limit_` from the rate estimates, claiming or releasing
+  // bytes from the process-wide buffer budget as needed.
+  void UpdateRateBasedLimit();
+
   int64 buffer_limit_;
   Mode mode_ = Mode::kDisabled;
+
+  // Rate-tracking state; only used in Mode::kRateTracking.  Intervals are in
+  // microseconds.
+  double producer_interval_ewma_ = 0.0;
+  double producer_interval_var_ewma_ = 0.0;
+  double consumer_interval_ewma_ = 0.0;
+  double element_bytes_ewma_ = 0.0;
+  int64 last_production_micros_ = 0;
+  int64 last_consumption_micros_ = 0;
+  int64 num_productions_ = 0;
+  // Bytes this autotuner currently holds from the shared buffer budget.
+  int64 reserved_bytes_ = 0;
 };
 
 }  // namespace data
@@ -79,6 +79,45 @@ TEST(PrefetchAutotuner, EnabledSteady) {
   }
 }
 
+TEST(PrefetchAutotuner, RateBased) {
+  setenv("TF_DATA_PREFETCH_AUTOTUNE_RATE_BASED", "true", 1);
+  setenv("TF_DATA_PREFETCH_BUFFER_BUDGET_MB", "1", 1);
+  PrefetchAutotuner t(PrefetchAutotuner::kAutoTune);
+  EXPECT_EQ(1, t.buffer_limit());
+  // Consumer requests every 50us; producer delivers a 1kB element every
+  // 100us.
+  int64 now = 1000000;
+  for (int i = 0; i < 64; ++i) {
+    t.RecordConsumption(1, now);
+    t.RecordConsumption(1, now + 50);
+    t.RecordProduction(1024, now + 100);
+    now += 100;
+  }
+  // A producer twice as slow as the consumer needs ~3 buffered elements.
+  EXPECT_EQ(3, t.buffer_limit());
+  unsetenv("TF_DATA_PREFETCH_AUTOTUNE_RATE_BASED");
+  unsetenv("TF_DATA_PREFETCH_BUFFER_BUDGET_MB");
+}
+
+TEST(PrefetchAutotuner, RateBasedRespectsBudget) {
+  setenv("TF_DATA_PREFETCH_AUTOTUNE_RATE_BASED", "true", 1);
+  setenv("TF_DATA_PREFETCH_BUFFER_BUDGET_MB", "1", 1);
+  PrefetchAutotuner t(PrefetchAutotuner::kAutoTune);
+  // Consumer requests every 10us; producer delivers a 512kB element every
+  // 1000us, so the rate gap alone asks for ~101 elements.
+  int64 now = 1000000;
+  for (int i = 0; i < 64; ++i) {
+    t.RecordConsumption(1, now);
+    t.RecordConsumption(1, now + 10);
+    t.RecordProduction(512 << 10, now + 1000);
+    now += 1000;
+  }
+  // The 1MB budget only covers two 512kB elements.
+  EXPECT_EQ(2, t.buffer_limit());
+  unsetenv("TF_DATA_PREFETCH_AUTOTUNE_RATE_BASED");
+  unsetenv("TF_DATA_PREFETCH_BUFFER_BUDGET_MB");
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
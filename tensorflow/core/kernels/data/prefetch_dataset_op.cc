@@ -251,7 +251,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         *out_tensors = std::move(buffer_.front().value);
         RecordBufferDequeue(ctx, *out_tensors);
       }
-      auto_tuner_.RecordConsumption(buffer_.size());
+      auto_tuner_.RecordConsumption(buffer_.size(), ctx->env()->NowMicros());
       buffer_.pop_front();
       *end_of_sequence = false;
 
@@ -318,6 +318,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         // 3. Signal that the element has been produced.
         {
           mutex_lock l(mu_);
+          auto_tuner_.RecordProduction(GetAllocatedBytes(buffer_element.value),
+                                       ctx->env()->NowMicros());
           RecordBufferEnqueue(ctx.get(), buffer_element.value);
           buffer_.push_back(std::move(buffer_element));
           cond_var_.notify_all();
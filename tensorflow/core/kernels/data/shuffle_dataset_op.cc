@@ -20,9 +20,14 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -32,6 +37,19 @@ const int64 kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 
 const int64 kMaxEpochsInBuffer = 3;
 
+// Returns the directory in which shuffle iterators spill buffered element
+// payloads to disk, or the empty string to keep the buffer fully in memory
+// (the default). When spilling is enabled, only a (offset, length) index
+// entry per buffered element is held in memory; payloads live in an
+// append-only spill file and are read back with positional reads, so the
+// memory cost of a large shuffle buffer no longer scales with element size.
+string ShuffleSpillDirectory() {
+  string result;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_DATA_SHUFFLE_SPILL_DIRECTORY",
+                                   /*default_val=*/"", &result));
+  return result;
+}
+
 // See documentation in ../../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
@@ -74,16 +92,31 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
           : DatasetIterator<T>(params),
             seed_(seed),
             seed2_(seed2),
+            spill_dir_(ShuffleSpillDirectory()),
             input_impl_(nullptr),
             epoch_(0),
             num_elements_(0),
             parent_generator_(seed, seed2),
             generator_(&parent_generator_) {
-        buffer_ = absl::make_unique<std::vector<Tensor>[]>(
-            params.dataset->buffer_size_);
+        if (spill_dir_.empty()) {
+          buffer_ = absl::make_unique<std::vector<Tensor>[]>(
+              params.dataset->buffer_size_);
+        } else {
+          spill_index_ =
+              absl::make_unique<SpillEntry[]>(params.dataset->buffer_size_);
+        }
         slices_.push_back(absl::make_unique<Slice>(0, 0));
       }
 
+      ~Iterator() override {
+        mutex_lock l(mu_);
+        if (spill_env_ != nullptr) {
+          spill_writer_.reset();
+          spill_reader_.reset();
+          spill_env_->DeleteFile(spill_path_).IgnoreError();
+        }
+      }
+
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
@@ -134,8 +167,13 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
                       << this->dataset()->buffer_size_;
             }
             this->RecordBufferEnqueue(ctx, input_element);
-            buffer_[slices_.back()->end % this->dataset()->buffer_size_] =
-                std::move(input_element);
+            size_t slot = slices_.back()->end % this->dataset()->buffer_size_;
+            if (spill_dir_.empty()) {
+              buffer_[slot] = std::move(input_element);
+            } else {
+              TF_RETURN_IF_ERROR(SpillElement(ctx->env(), input_element,
+                                              &spill_index_[slot]));
+            }
             num_elements_++;
             slices_.back()->end++;
           } else {
@@ -168,11 +206,18 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               Random() % (slices_.front()->end - slices_.front()->start);
           int64 index =
               (slices_.front()->start + offset) % this->dataset()->buffer_size_;
-          *out_tensors = std::move(buffer_[index]);
-          this->RecordBufferDequeue(ctx, *out_tensors);
-          std::swap(
-              buffer_[index],
-              buffer_[slices_.front()->start % this->dataset()->buffer_size_]);
+          int64 front_index =
+              slices_.front()->start % this->dataset()->buffer_size_;
+          if (spill_dir_.empty()) {
+            *out_tensors = std::move(buffer_[index]);
+            this->RecordBufferDequeue(ctx, *out_tensors);
+            std::swap(buffer_[index], buffer_[front_index]);
+          } else {
+            TF_RETURN_IF_ERROR(
+                ReadSpilledElement(spill_index_[index], out_tensors));
+            this->RecordBufferDequeue(ctx, *out_tensors);
+            std::swap(spill_index_[index], spill_index_[front_index]);
+          }
           slices_.front()->start++;
           num_elements_--;
         } else {
@@ -231,13 +276,24 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               slices_[i]->end));
           for (size_t j = slices_[i]->start; j < slices_[i]->end; ++j) {
             size_t index = j % this->dataset()->buffer_size_;
+            // When spilling is enabled, buffered payloads live on disk;
+            // read them back so that checkpoints stay interchangeable with
+            // the in-memory mode.
+            std::vector<Tensor> spilled_element;
+            const std::vector<Tensor>* element = &spilled_element;
+            if (spill_dir_.empty()) {
+              element = &buffer_[index];
+            } else {
+              TF_RETURN_IF_ERROR(
+                  ReadSpilledElement(spill_index_[index], &spilled_element));
+            }
             TF_RETURN_IF_ERROR(writer->WriteScalar(
                 this->full_name(strings::StrCat("buffer_", index, "_size")),
-                buffer_[index].size()));
-            for (size_t k = 0; k < buffer_[index].size(); ++k) {
+                element->size()));
+            for (size_t k = 0; k < element->size(); ++k) {
               TF_RETURN_IF_ERROR(writer->WriteTensor(
                   this->full_name(strings::StrCat("buffer_", index, "_", k)),
-                  buffer_[index][k]));
+                  (*element)[k]));
             }
           }
         }
@@ -277,8 +333,22 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               reader->ReadScalar(this->full_name("slices_size"), &temp));
           slices_size = static_cast<size_t>(temp);
         }
-        buffer_ = absl::make_unique<std::vector<Tensor>[]>(
-            this->dataset()->buffer_size_);
+        if (spill_dir_.empty()) {
+          buffer_ = absl::make_unique<std::vector<Tensor>[]>(
+              this->dataset()->buffer_size_);
+        } else {
+          spill_index_ = absl::make_unique<SpillEntry[]>(
+              this->dataset()->buffer_size_);
+          // Start over with a fresh spill file; the buffered payloads are
+          // re-spilled from the checkpoint below.
+          if (spill_env_ != nullptr) {
+            spill_writer_.reset();
+            spill_reader_.reset();
+            spill_env_->DeleteFile(spill_path_).IgnoreError();
+            spill_env_ = nullptr;
+          }
+          spill_size_ = 0;
+        }
         for (size_t i = 0; i < slices_size; ++i) {
           int64 start;
           TF_RETURN_IF_ERROR(reader->ReadScalar(
@@ -293,11 +363,17 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
             TF_RETURN_IF_ERROR(reader->ReadScalar(
                 this->full_name(strings::StrCat("buffer_", index, "_size")),
                 &list_size));
-            buffer_[index] = std::vector<Tensor>(list_size);
+            std::vector<Tensor> element(list_size);
             for (int k = 0; k < list_size; ++k) {
               TF_RETURN_IF_ERROR(reader->ReadTensor(
                   this->full_name(strings::StrCat("buffer_", index, "_", k)),
-                  &buffer_[index][k]));
+                  &element[k]));
+            }
+            if (spill_dir_.empty()) {
+              buffer_[index] = std::move(element);
+            } else {
+              TF_RETURN_IF_ERROR(
+                  SpillElement(ctx->env(), element, &spill_index_[index]));
             }
           }
         }
@@ -329,7 +405,120 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
         return out;
       }
 
+      // Location of a buffered element's payload in the spill file.
+      struct SpillEntry {
+        uint64 offset = 0;
+        uint64 length = 0;
+      };
+
+      Status EnsureSpillFileOpened(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_writer_) {
+          return Status::OK();
+        }
+        spill_path_ = io::JoinPath(
+            spill_dir_, strings::StrCat("tf_data_shuffle_spill_",
+                                        random::New64(), ".tmp"));
+        TF_RETURN_IF_ERROR(env->NewWritableFile(spill_path_, &spill_writer_));
+        TF_RETURN_IF_ERROR(
+            env->NewRandomAccessFile(spill_path_, &spill_reader_));
+        spill_env_ = env;
+        spill_size_ = 0;
+        spill_dirty_ = false;
+        return Status::OK();
+      }
+
+      // Appends `element` to the spill file as a length-prefixed sequence of
+      // serialized tensor protos, recording its location in `entry`. Only
+      // the (offset, length) entry stays in memory.
+      Status SpillElement(Env* env, const std::vector<Tensor>& element,
+                          SpillEntry* entry) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        TF_RETURN_IF_ERROR(EnsureSpillFileOpened(env));
+        spill_buffer_.clear();
+        core::PutFixed64(&spill_buffer_, element.size());
+        for (const Tensor& t : element) {
+          TensorProto proto;
+          t.AsProtoTensorContent(&proto);
+          core::PutFixed64(&spill_buffer_, proto.ByteSizeLong());
+          proto.AppendToString(&spill_buffer_);
+        }
+        TF_RETURN_IF_ERROR(spill_writer_->Append(spill_buffer_));
+        entry->offset = spill_size_;
+        entry->length = spill_buffer_.size();
+        spill_size_ += spill_buffer_.size();
+        spill_dirty_ = true;
+        return Status::OK();
+      }
+
+      // Reads the payload recorded by `entry` back from the spill file.
+      Status ReadSpilledElement(const SpillEntry& entry,
+                                std::vector<Tensor>* element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_dirty_) {
+          TF_RETURN_IF_ERROR(spill_writer_->Flush());
+          spill_dirty_ = false;
+        }
+        spill_buffer_.resize(entry.length);
+        StringPiece data;
+        TF_RETURN_IF_ERROR(spill_reader_->Read(entry.offset, entry.length,
+                                               &data, &spill_buffer_[0]));
+        if (data.size() != entry.length) {
+          return errors::DataLoss("Short read from shuffle spill file ",
+                                  spill_path_);
+        }
+        const char* p = data.data();
+        const char* limit = p + data.size();
+        if (limit - p < static_cast<int64>(sizeof(uint64))) {
+          return errors::DataLoss("Corrupt record in shuffle spill file ",
+                                  spill_path_);
+        }
+        const uint64 num_tensors = core::DecodeFixed64(p);
+        p += sizeof(uint64);
+        element->clear();
+        element->reserve(num_tensors);
+        for (uint64 i = 0; i < num_tensors; ++i) {
+          if (limit - p < static_cast<int64>(sizeof(uint64))) {
+            return errors::DataLoss("Corrupt record in shuffle spill file ",
+                                    spill_path_);
+          }
+          const uint64 proto_size = core::DecodeFixed64(p);
+          p += sizeof(uint64);
+          if (static_cast<uint64>(limit - p) < proto_size) {
+            return errors::DataLoss("Corrupt record in shuffle spill file ",
+                                    spill_path_);
+          }
+          TensorProto proto;
+          if (!proto.ParseFromArray(p, proto_size)) {
+            return errors::DataLoss(
+                "Failed to parse tensor proto from shuffle spill file ",
+                spill_path_);
+          }
+          p += proto_size;
+          element->emplace_back();
+          if (!element->back().FromProto(proto)) {
+            return errors::DataLoss(
+                "Failed to restore tensor from shuffle spill file ",
+                spill_path_);
+          }
+        }
+        return Status::OK();
+      }
+
       std::unique_ptr<std::vector<Tensor>[]> buffer_ GUARDED_BY(mu_);
+      // Spill-to-disk state, used instead of `buffer_` when `spill_dir_` is
+      // non-empty. `spill_index_` holds one entry per buffer slot and is
+      // indexed exactly like `buffer_`.
+      const string spill_dir_;
+      std::unique_ptr<SpillEntry[]> spill_index_ GUARDED_BY(mu_);
+      Env* spill_env_ GUARDED_BY(mu_) = nullptr;
+      string spill_path_ GUARDED_BY(mu_);
+      std::unique_ptr<WritableFile> spill_writer_ GUARDED_BY(mu_);
+      std::unique_ptr<RandomAccessFile> spill_reader_ GUARDED_BY(mu_);
+      // Number of bytes appended to the spill file so far.
+      uint64 spill_size_ GUARDED_BY(mu_) = 0;
+      // Whether appended bytes may not have been flushed to the file yet.
+      bool spill_dirty_ GUARDED_BY(mu_) = false;
+      // Scratch space for encoding and decoding spill records.
+      string spill_buffer_ GUARDED_BY(mu_);
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
       int64 epoch_ GUARDED_BY(mu_);
       int64 num_elements_ GUARDED_BY(mu_);
@@ -91,6 +91,12 @@ class SingleThreadedExecutorImpl : public Executor {
 
       KernelState& kernel_state = kernels_[i];
       TF_RETURN_IF_ERROR(params_.create_kernel(n->def(), &kernel_state.kernel));
+      if (kernel_state.kernel->AsAsync() != nullptr) {
+        return errors::Unimplemented(
+            "Single-threaded executor does not support asynchronous kernels.  "
+            "But saw async kernel in node ",
+            n->name());
+      }
       kernel_state.num_inputs = n->num_inputs();
       kernel_state.num_outputs = n->num_outputs();
 
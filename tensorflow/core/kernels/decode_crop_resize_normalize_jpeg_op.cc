@@ -0,0 +1,213 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image_resizer_state.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Interpolation indices and weight for one output coordinate, computed once
+// per output row/column instead of once per pixel.
+struct CachedInterpolation {
+  int64 lower;  // Lower source index used in the interpolation
+  int64 upper;  // Upper source index used in the interpolation
+  float lerp;   // 1-D linear interpolation weight
+};
+
+template <typename Scaler>
+void ComputeInterpolationWeights(const Scaler scaler, const int64 out_size,
+                                 const int64 in_size, const float scale,
+                                 std::vector<CachedInterpolation>* out) {
+  out->resize(out_size);
+  for (int64 i = 0; i < out_size; ++i) {
+    const float in = scaler(i, scale);
+    const float in_f = std::floor(in);
+    (*out)[i].lower =
+        std::max(static_cast<int64>(in_f), static_cast<int64>(0));
+    (*out)[i].upper =
+        std::min(static_cast<int64>(std::ceil(in)), in_size - 1);
+    (*out)[i].lerp = in - in_f;
+  }
+}
+
+}  // namespace
+
+// Decodes only the requested JPEG crop window, bilinearly resizes it and
+// applies a per-channel affine normalization, all in a single pass with no
+// intermediate image tensors. The only scratch allocation is the decoded
+// crop window, which libjpeg produces directly via its partial-decode path.
+class DecodeCropResizeNormalizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeCropResizeNormalizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(
+        context, channels_ == 1 || channels_ == 3,
+        errors::InvalidArgument("channels must be 1 or 3, got ", channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("mean", &mean_));
+    OP_REQUIRES(context,
+                mean_.empty() || static_cast<int>(mean_.size()) == channels_,
+                errors::InvalidArgument(
+                    "mean must be empty or have one value per channel, got ",
+                    mean_.size(), " values for ", channels_, " channels"));
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    OP_REQUIRES(context,
+                scale_.empty() || static_cast<int>(scale_.size()) == channels_,
+                errors::InvalidArgument(
+                    "scale must be empty or have one value per channel, got ",
+                    scale_.size(), " values for ", channels_, " channels"));
+    if (mean_.empty()) mean_.resize(channels_, 0.0f);
+    if (scale_.empty()) scale_.resize(channels_, 1.0f);
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(
+        context, context->GetAttr("half_pixel_centers", &half_pixel_centers_));
+
+    flags_.components = channels_;
+    flags_.crop = true;
+    // Match the DecodeJpeg default of the fast integer DCT.
+    flags_.dct_method = JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<string>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument(
+                    "JPEG contents are too large for int: ", input.size()));
+
+    // Use local copy of flags to avoid race condition as the class member is
+    // shared among different invocations.
+    jpeg::UncompressFlags flags = flags_;
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context, crop_window.dims() == 1,
+                errors::InvalidArgument("crop_window must be 1-D, got shape ",
+                                        crop_window.shape().DebugString()));
+    OP_REQUIRES(context, crop_window.dim_size(0) == 4,
+                errors::InvalidArgument("crop_size must have four elements ",
+                                        crop_window.shape().DebugString()));
+    auto crop_window_vec = crop_window.vec<int32>();
+    flags.crop_y = crop_window_vec(0);
+    flags.crop_x = crop_window_vec(1);
+    flags.crop_height = crop_window_vec(2);
+    flags.crop_width = crop_window_vec(3);
+
+    const Tensor& size_tensor = context->input(2);
+    OP_REQUIRES(context,
+                size_tensor.dims() == 1 && size_tensor.dim_size(0) == 2,
+                errors::InvalidArgument("size must have two elements, got ",
+                                        size_tensor.shape().DebugString()));
+    auto size_vec = size_tensor.vec<int32>();
+    const int64 out_height = size_vec(0);
+    const int64 out_width = size_vec(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    // Decode only the crop window; libjpeg skips the other scanlines and
+    // discards the rest of each retained scanline before IDCT output.
+    int in_width = 0;
+    int in_height = 0;
+    int components = 0;
+    std::unique_ptr<uint8[]> decoded(
+        jpeg::Uncompress(input.data(), input.size(), flags, &in_width,
+                         &in_height, &components, nullptr /* nwarn */));
+    OP_REQUIRES(
+        context, decoded != nullptr,
+        errors::InvalidArgument("Invalid JPEG data or crop window, data size ",
+                                input.size()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0,
+                                TensorShape({out_height, out_width, channels_}),
+                                &output));
+
+    const float height_scale =
+        CalculateResizeScale(in_height, out_height, align_corners_);
+    const float width_scale =
+        CalculateResizeScale(in_width, out_width, align_corners_);
+
+    std::vector<CachedInterpolation> ys;
+    std::vector<CachedInterpolation> xs;
+    if (half_pixel_centers_) {
+      ComputeInterpolationWeights(HalfPixelScaler(), out_height, in_height,
+                                  height_scale, &ys);
+      ComputeInterpolationWeights(HalfPixelScaler(), out_width, in_width,
+                                  width_scale, &xs);
+    } else {
+      ComputeInterpolationWeights(LegacyScaler(), out_height, in_height,
+                                  height_scale, &ys);
+      ComputeInterpolationWeights(LegacyScaler(), out_width, in_width,
+                                  width_scale, &xs);
+    }
+
+    // Single fused pass: gather the four source pixels, lerp, then apply
+    // (value - mean) * scale, writing straight into the output.
+    const int64 in_row_size = static_cast<int64>(in_width) * channels_;
+    float* out = output->flat<float>().data();
+    for (int64 y = 0; y < out_height; ++y) {
+      const uint8* row_lower = decoded.get() + ys[y].lower * in_row_size;
+      const uint8* row_upper = decoded.get() + ys[y].upper * in_row_size;
+      const float ys_lerp = ys[y].lerp;
+      for (int64 x = 0; x < out_width; ++x) {
+        const int64 xs_lower = xs[x].lower * channels_;
+        const int64 xs_upper = xs[x].upper * channels_;
+        const float xs_lerp = xs[x].lerp;
+        for (int c = 0; c < channels_; ++c) {
+          const float top_left = row_lower[xs_lower + c];
+          const float top_right = row_lower[xs_upper + c];
+          const float bottom_left = row_upper[xs_lower + c];
+          const float bottom_right = row_upper[xs_upper + c];
+          const float top = top_left + (top_right - top_left) * xs_lerp;
+          const float bottom =
+              bottom_left + (bottom_right - bottom_left) * xs_lerp;
+          const float value = top + (bottom - top) * ys_lerp;
+          *out++ = (value - mean_[c]) * scale_[c];
+        }
+      }
+    }
+  }
+
+ private:
+  int channels_;
+  std::vector<float> mean_;
+  std::vector<float> scale_;
+  bool align_corners_;
+  bool half_pixel_centers_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeCropResizeNormalizeJpeg").Device(DEVICE_CPU),
+                        DecodeCropResizeNormalizeJpegOp);
+
+}  // namespace tensorflow
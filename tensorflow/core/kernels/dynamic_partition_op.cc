@@ -15,12 +15,16 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <atomic>
+#include <functional>
 #include <vector>
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
 
@@ -40,8 +44,9 @@ class DynamicPartitionOp_Shared : public OpKernel {
   }
 
   void ValidateAndAllocateOutputs(OpKernelContext* c, const Tensor** data,
-                                  const Tensor** partitions,
-                                  OpOutputList* Tout) {
+                                  const Tensor** partitions, OpOutputList* Tout,
+                                  std::vector<int64>* shard_bounds,
+                                  std::vector<std::vector<int64> >* shard_offsets) {
     OP_REQUIRES_OK(c, c->input("data", data));
     OP_REQUIRES_OK(c, c->input("partitions", partitions));
     OP_REQUIRES(
@@ -52,17 +57,88 @@ class DynamicPartitionOp_Shared : public OpKernel {
             "got data.shape = ", (*data)->shape().DebugString(),
             ", partitions.shape = ", (*partitions)->shape().DebugString()));
 
-    // Count how many occurrences of each partition id we have in partitions
-    gtl::InlinedVector<int, 32> partition_count(num_partitions_);
     auto e_partitions = (*partitions)->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    for (int64 i = 0; i < N; i++) {
-      const int32 p = internal::SubtleMustCopy(e_partitions(i));
-      OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
-                  errors::InvalidArgument(
-                      "partitions", SliceDebugString((*partitions)->shape(), i),
-                      " = ", p, " is not in [0, ", num_partitions_, ")"));
-      partition_count[p]++;
+
+    // First pass: count how many occurrences of each partition id we
+    // have in partitions, sharding the count over the input.  Sharding
+    // over the input rather than over partitions keeps the per-thread
+    // work balanced even when the partition sizes are heavily skewed.
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    int64 num_shards = 1;
+    if (worker_threads->num_threads > 1) {
+      num_shards = std::max<int64>(
+          1, std::min<int64>(worker_threads->num_threads,
+                             N / kMinElementsPerShard));
+    }
+    shard_bounds->resize(num_shards + 1);
+    for (int64 s = 0; s <= num_shards; ++s) {
+      (*shard_bounds)[s] = N * s / num_shards;
+    }
+    shard_offsets->assign(num_shards, std::vector<int64>(num_partitions_, 0));
+
+    int64 bad_index = -1;
+    if (num_shards == 1) {
+      std::vector<int64>* counts = &(*shard_offsets)[0];
+      for (int64 i = 0; i < N; i++) {
+        const int32 p = internal::SubtleMustCopy(e_partitions(i));
+        if (!FastBoundsCheck(p, num_partitions_)) {
+          bad_index = i;
+          break;
+        }
+        (*counts)[p]++;
+      }
+    } else {
+      BlockingCounter pending(num_shards);
+      std::vector<int64> shard_bad_index(num_shards, -1);
+      for (int64 s = 0; s < num_shards; ++s) {
+        const int64 begin = (*shard_bounds)[s];
+        const int64 end = (*shard_bounds)[s + 1];
+        std::vector<int64>* counts = &(*shard_offsets)[s];
+        int64* bad = &shard_bad_index[s];
+        worker_threads->workers->Schedule(
+            [this, &e_partitions, &pending, counts, bad, begin, end]() {
+              for (int64 i = begin; i < end; i++) {
+                const int32 p = internal::SubtleMustCopy(e_partitions(i));
+                if (!FastBoundsCheck(p, num_partitions_)) {
+                  *bad = i;
+                  break;
+                }
+                (*counts)[p]++;
+              }
+              pending.DecrementCount();
+            });
+      }
+      pending.Wait();
+      for (int64 s = 0; s < num_shards; ++s) {
+        if (shard_bad_index[s] >= 0) {
+          bad_index = shard_bad_index[s];
+          break;
+        }
+      }
+    }
+    if (bad_index >= 0) {
+      const int32 p = internal::SubtleMustCopy(e_partitions(bad_index));
+      OP_REQUIRES(
+          c, false,
+          errors::InvalidArgument(
+              "partitions", SliceDebugString((*partitions)->shape(), bad_index),
+              " = ", p, " is not in [0, ", num_partitions_, ")"));
+    }
+
+    // An exclusive prefix sum across shards within each partition
+    // converts the per-shard counts into the start offset of each
+    // shard's contiguous range in that partition's output, preserving
+    // the input order of the sequential implementation.
+    gtl::InlinedVector<int64, 32> partition_count(num_partitions_);
+    for (int p = 0; p < num_partitions_; p++) {
+      int64 running = 0;
+      for (int64 s = 0; s < num_shards; ++s) {
+        const int64 count = (*shard_offsets)[s][p];
+        (*shard_offsets)[s][p] = running;
+        running += count;
+      }
+      partition_count[p] = running;
     }
 
     // Allocate output tensors of the right size
@@ -79,6 +155,39 @@ class DynamicPartitionOp_Shared : public OpKernel {
   }
 
  protected:
+  // Second pass: runs scatter_shard for shards [0, num_shards), in
+  // parallel when there is more than one shard.  Each shard writes only
+  // the output ranges reserved for it by the counting pass, so shards
+  // touch disjoint output elements.  scatter_shard must return false if
+  // the partition ids are no longer consistent with the counting pass.
+  void RunScatter(OpKernelContext* c, int64 num_shards,
+                  const std::function<bool(int64)>& scatter_shard) {
+    bool ok = true;
+    if (num_shards == 1) {
+      ok = scatter_shard(0);
+    } else {
+      BlockingCounter pending(num_shards);
+      std::atomic<bool> all_ok(true);
+      auto workers = c->device()->tensorflow_cpu_worker_threads()->workers;
+      for (int64 s = 0; s < num_shards; ++s) {
+        workers->Schedule([&scatter_shard, &pending, &all_ok, s]() {
+          if (!scatter_shard(s)) all_ok = false;
+          pending.DecrementCount();
+        });
+      }
+      pending.Wait();
+      ok = all_ok.load();
+    }
+    OP_REQUIRES(c, ok,
+                errors::InvalidArgument(
+                    "partitions have been asynchronously overwritten and are "
+                    "no longer consistent with the counting pass"));
+  }
+
+  // Below this many input elements per shard the fork/join overhead
+  // dominates the counting and scatter passes.
+  static const int64 kMinElementsPerShard = 1 << 13;
+
   int num_partitions_;
 };
 
@@ -91,13 +200,16 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
     const Tensor* data;
     const Tensor* partitions;
     OpOutputList outputs;
-    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs);
+    std::vector<int64> shard_bounds;
+    std::vector<std::vector<int64> > shard_offsets;
+    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs, &shard_bounds,
+                               &shard_offsets);
     if (!c->status().ok()) return;
     if (num_partitions_ == 0 || data->NumElements() == 0) return;
 
     auto e_partitions = partitions->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    gtl::InlinedVector<int, 32> output_index(num_partitions_);
+    const int64 num_shards = shard_offsets.size();
 
     if (partitions->dims() == data->dims()) {
       // Walk through data and copy the data to the appropriate output tensor
@@ -109,19 +221,19 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       for (int p = 0; p < num_partitions_; p++) {
         out_vec.push_back(outputs[p]->vec<T>());
       }
-      for (int64 i = 0; i < N; i++) {
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i, "] is out of range"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
-                    errors::InvalidArgument(
-                        "out_vec[", p, "] size: ", out_vec[p].size(),
-                        " is not LTE output_index[", p, "] : ", oi));
-        out_vec[p](oi) = data_flat(i);
-        output_index[p]++;
-      }
+      auto scatter_shard = [&](int64 shard) -> bool {
+        std::vector<int64> output_index = shard_offsets[shard];
+        for (int64 i = shard_bounds[shard]; i < shard_bounds[shard + 1]; i++) {
+          const int32 p = internal::SubtleMustCopy(e_partitions(i));
+          if (!FastBoundsCheck(p, num_partitions_)) return false;
+          const int64 oi = output_index[p];
+          if (!FastBoundsCheck(oi, out_vec[p].size())) return false;
+          out_vec[p](oi) = data_flat(i);
+          output_index[p]++;
+        }
+        return true;
+      };
+      RunScatter(c, num_shards, scatter_shard);
     } else {
       // If data has extra dimensions, use Eigen slices
       std::vector<Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
@@ -136,24 +248,23 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       const int64 slice_size = data->NumElements() / N;
       const auto data_flat = data->shaped<T, 2>({N, slice_size});
       Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-      for (int64 i = 0; i < N; i++) {
-        // outputs[p][output_index[p]++] = data[i]
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i,
-                                    "] has been asynchronously overwritten and "
-                                    "is no longer in range!"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
-                    errors::InvalidArgument("Size of output_index: ", oi,
-                                            " is no longer in range."));
-        Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
-        Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-        out_flat[p].slice(out_indices, sizes) =
-            data_flat.slice(data_indices, sizes);
-        output_index[p]++;
-      }
+      auto scatter_shard = [&](int64 shard) -> bool {
+        std::vector<int64> output_index = shard_offsets[shard];
+        for (int64 i = shard_bounds[shard]; i < shard_bounds[shard + 1]; i++) {
+          // outputs[p][output_index[p]++] = data[i]
+          const int32 p = internal::SubtleMustCopy(e_partitions(i));
+          if (!FastBoundsCheck(p, num_partitions_)) return false;
+          const int64 oi = output_index[p];
+          if (!FastBoundsCheck(oi, out_flat[p].dimension(0))) return false;
+          Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
+          Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
+          out_flat[p].slice(out_indices, sizes) =
+              data_flat.slice(data_indices, sizes);
+          output_index[p]++;
+        }
+        return true;
+      };
+      RunScatter(c, num_shards, scatter_shard);
     }
   }
 };
@@ -15,6 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -251,7 +254,7 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       auto merged_flat = merged->flat_outer_dims<T>();
       const int slice_size = merged_flat.dimension(1);
       const size_t slice_bytes = slice_size * sizeof(T);
-      auto OnInputNumber = [&](int input_num) {
+      auto OnInputRange = [&](int input_num, int64 begin, int64 end) {
         const Tensor& indices = indices_inputs[input_num];
         auto indices_vec = indices.flat<int32>();
         const Tensor& data = data_inputs[input_num];
@@ -261,7 +264,7 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
         if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
           T* merged_base = merged_flat.data();
           const T* data_base = data_flat.data();
-          for (int i = 0; i < indices_vec.size(); i++) {
+          for (int64 i = begin; i < end; i++) {
             int32 index = internal::SubtleMustCopy(indices_vec(i));
             OP_REQUIRES(
                 c, FastBoundsCheck(index, first_dim_size),
@@ -271,7 +274,7 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
           }
         } else {
           Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-          for (int i = 0; i < indices_vec.size(); i++) {
+          for (int64 i = begin; i < end; i++) {
             // Copy slice data[i] to merged[indices[i]]
             Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
             int32 index = internal::SubtleMustCopy(indices_vec(i));
@@ -284,6 +287,9 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
           }
         }
       };
+      auto OnInputNumber = [&](int input_num) {
+        OnInputRange(input_num, 0, indices_inputs[input_num].NumElements());
+      };
       if (Parallel) {
         auto thread_pool =
             c->device()->tensorflow_cpu_worker_threads()->workers;
@@ -292,16 +298,53 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
              ++input_num) {
           total_indices_size += indices_inputs[input_num].NumElements();
         }
-        const double avg_indices_size =
-            static_cast<double>(total_indices_size) / indices_inputs.size();
-        auto bytes_processed = slice_bytes * avg_indices_size;
-        auto LoopBody = [&](int first, int last) {
-          for (int input_num = first; input_num < last; ++input_num) {
-            OnInputNumber(input_num);
+        if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+          // Split the work inside the inputs as well as across them, so
+          // a single large input can still use every thread.  Repeated
+          // indices may then be copied by different threads, which is
+          // within this op's contract: it does not define the merged
+          // result when an index is repeated.
+          struct Chunk {
+            int input_num;
+            int64 begin;
+            int64 end;
+          };
+          std::vector<Chunk> chunks;
+          const int64 chunk_size = std::max<int64>(
+              1, total_indices_size / (4 * thread_pool->NumThreads()));
+          for (int input_num = 0; input_num < indices_inputs.size();
+               ++input_num) {
+            const int64 size = indices_inputs[input_num].NumElements();
+            for (int64 begin = 0; begin < size; begin += chunk_size) {
+              Chunk chunk;
+              chunk.input_num = input_num;
+              chunk.begin = begin;
+              chunk.end = std::min(begin + chunk_size, size);
+              chunks.push_back(chunk);
+            }
           }
-        };
-        thread_pool->ParallelFor(indices_inputs.size(), bytes_processed,
-                                 LoopBody);
+          auto bytes_per_chunk = slice_bytes * chunk_size;
+          auto LoopBody = [&](int64 first, int64 last) {
+            for (int64 ci = first; ci < last; ++ci) {
+              OnInputRange(chunks[ci].input_num, chunks[ci].begin,
+                           chunks[ci].end);
+            }
+          };
+          thread_pool->ParallelFor(chunks.size(), bytes_per_chunk, LoopBody);
+        } else {
+          // Non-POD slices are not safe to copy concurrently to the same
+          // destination, so only parallelize across inputs.
+          const double avg_indices_size =
+              static_cast<double>(total_indices_size) / indices_inputs.size();
+          auto bytes_processed = slice_bytes * avg_indices_size;
+          auto LoopBody = [&](int first, int last) {
+            for (int input_num = first; input_num < last; ++input_num) {
+              OnInputNumber(input_num);
+            }
+          };
+          thread_pool->ParallelFor(indices_inputs.size(), bytes_processed,
+                                   LoopBody);
+        }
       } else {
         for (int input_num = 0; input_num < indices_inputs.size();
              input_num++) {
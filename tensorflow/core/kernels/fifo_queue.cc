@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fifo_queue.h"
+#include "tensorflow/core/kernels/lock_free_fifo_queue.h"
 #include "tensorflow/core/kernels/queue_base.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -376,6 +377,15 @@ FIFOQueueOp::FIFOQueueOp(OpKernelConstruction* context)
 }
 
 Status FIFOQueueOp::CreateResource(QueueInterface** ret) {
+  // The FIFOQueue op carries no attr selecting an implementation, so the
+  // lock-free variant is opted into via the environment.  It preallocates
+  // its ring, so it is only used for reasonably bounded capacities.
+  if (LockFreeFIFOQueue::IsEnabled() && capacity_ > 0 &&
+      capacity_ <= LockFreeFIFOQueue::kMaxCapacity) {
+    LockFreeFIFOQueue* queue = new LockFreeFIFOQueue(
+        capacity_, component_types_, component_shapes_, cinfo_.name());
+    return CreateTypedQueue(queue, ret);
+  }
   FIFOQueue* queue = new FIFOQueue(capacity_, component_types_,
                                    component_shapes_, cinfo_.name());
   return CreateTypedQueue(queue, ret);
@@ -0,0 +1,196 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Performs N embedding-table lookups with sparse segment combining and
+// writes each table's combined rows directly into its column slice of the
+// concatenated [num_segments, sum of table widths] output. This replaces a
+// Gather -> SparseSegment{Sum,Mean,SqrtN} -> ConcatV2 chain per table with a
+// single dispatch and no intermediate tensors; the tables are processed in
+// parallel on the intra-op pool, which is safe because each table owns a
+// disjoint column range of the output.
+template <typename T, typename Tidx>
+class FusedEmbeddingLookupOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    is_mean_ = (combiner == "mean");
+    is_sqrtn_ = (combiner == "sqrtn");
+  }
+
+  void Compute(OpKernelContext* context) override {
+    OpInputList params;
+    OpInputList indices;
+    OpInputList segment_ids;
+    OP_REQUIRES_OK(context, context->input_list("params", &params));
+    OP_REQUIRES_OK(context, context->input_list("indices", &indices));
+    OP_REQUIRES_OK(context, context->input_list("segment_ids", &segment_ids));
+    const Tensor* num_segments_t = nullptr;
+    OP_REQUIRES_OK(context, context->input("num_segments", &num_segments_t));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsScalar(num_segments_t->shape()),
+                errors::InvalidArgument(
+                    "num_segments should be a scalar, not shape ",
+                    num_segments_t->shape().DebugString()));
+    const int64 num_segments =
+        internal::SubtleMustCopy(num_segments_t->scalar<int32>()());
+    OP_REQUIRES(context, num_segments >= 0,
+                errors::InvalidArgument("num_segments must be >= 0"));
+
+    const int num_tables = params.size();
+    std::vector<int64> col_offsets(num_tables + 1, 0);
+    int64 total_indices = 0;
+    for (int t = 0; t < num_tables; ++t) {
+      OP_REQUIRES(context, TensorShapeUtils::IsMatrix(params[t].shape()),
+                  errors::InvalidArgument("params[", t,
+                                          "] must be a matrix, got shape ",
+                                          params[t].shape().DebugString()));
+      OP_REQUIRES(context, TensorShapeUtils::IsVector(indices[t].shape()),
+                  errors::InvalidArgument("indices[", t,
+                                          "] must be a vector, got shape ",
+                                          indices[t].shape().DebugString()));
+      OP_REQUIRES(
+          context,
+          indices[t].NumElements() == segment_ids[t].NumElements(),
+          errors::InvalidArgument(
+              "indices[", t, "] and segment_ids[", t,
+              "] should have same size, got ", indices[t].NumElements(),
+              " and ", segment_ids[t].NumElements()));
+      col_offsets[t + 1] = col_offsets[t] + params[t].dim_size(1);
+      total_indices += indices[t].NumElements();
+    }
+    const int64 total_cols = col_offsets[num_tables];
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({num_segments, total_cols}), &output));
+    if (output->NumElements() == 0) return;
+    T* out_base = output->matrix<T>().data();
+
+    // Each worker handles a range of tables: it zeroes its tables' column
+    // slices, accumulates the gathered rows into them, and applies the
+    // combiner scaling. Segments that receive no rows stay zero, matching
+    // the SparseSegment*WithNumSegments ops. Errors found by workers are
+    // recorded and reported after the parallel phase.
+    mutex mu;
+    Status status;
+    auto work = [&](int64 table_begin, int64 table_end) {
+      for (int64 t = table_begin; t < table_end; ++t) {
+        const auto table = params[t].matrix<T>();
+        const int64 table_rows = params[t].dim_size(0);
+        const int64 width = params[t].dim_size(1);
+        const int64 col_begin = col_offsets[t];
+        const auto indices_vec = indices[t].vec<Tidx>();
+        const auto segment_vec = segment_ids[t].vec<int32>();
+        const int64 num_lookups = indices_vec.size();
+        for (int64 s = 0; s < num_segments; ++s) {
+          T* dst = out_base + s * total_cols + col_begin;
+          std::fill(dst, dst + width, T(0));
+        }
+        std::vector<int32> counts(num_segments, 0);
+        for (int64 i = 0; i < num_lookups; ++i) {
+          const Tidx index = internal::SubtleMustCopy(indices_vec(i));
+          const int32 segment = internal::SubtleMustCopy(segment_vec(i));
+          if (!FastBoundsCheck(index, table_rows)) {
+            mutex_lock l(mu);
+            if (status.ok()) {
+              status = errors::InvalidArgument(
+                  "indices[", t, "][", i, "] == ", index, " out of range [0, ",
+                  table_rows, ")");
+            }
+            return;
+          }
+          if (!FastBoundsCheck(segment, num_segments)) {
+            mutex_lock l(mu);
+            if (status.ok()) {
+              status = errors::InvalidArgument(
+                  "segment_ids[", t, "][", i, "] == ", segment,
+                  " out of range [0, ", num_segments, ")");
+            }
+            return;
+          }
+          const T* src = &table(index, 0);
+          T* dst = out_base + segment * total_cols + col_begin;
+          for (int64 j = 0; j < width; ++j) {
+            dst[j] += src[j];
+          }
+          ++counts[segment];
+        }
+        if (is_mean_ || is_sqrtn_) {
+          for (int64 s = 0; s < num_segments; ++s) {
+            if (counts[s] < 2) continue;
+            const T scale =
+                is_mean_ ? T(1) / static_cast<T>(counts[s])
+                         : T(1) / static_cast<T>(
+                                      std::sqrt(static_cast<double>(counts[s])));
+            T* dst = out_base + s * total_cols + col_begin;
+            for (int64 j = 0; j < width; ++j) {
+              dst[j] *= scale;
+            }
+          }
+        }
+      }
+    };
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64 avg_table_cost = std::max<int64>(
+        1, ((total_indices / num_tables) + num_segments) * (total_cols / num_tables) *
+               sizeof(T));
+    Shard(worker_threads.num_threads, worker_threads.workers, num_tables,
+          avg_table_cost, work);
+    OP_REQUIRES_OK(context, status);
+  }
+
+ private:
+  bool is_mean_;
+  bool is_sqrtn_;
+};
+
+#define REGISTER_CPU_KERNELS(type)                            \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookup")        \
+                              .Device(DEVICE_CPU)             \
+                              .TypeConstraint<type>("T")      \
+                              .TypeConstraint<int32>("Tidx"), \
+                          FusedEmbeddingLookupOp<type, int32>); \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookup")        \
+                              .Device(DEVICE_CPU)             \
+                              .TypeConstraint<type>("T")      \
+                              .TypeConstraint<int64>("Tidx"), \
+                          FusedEmbeddingLookupOp<type, int64>)
+
+REGISTER_CPU_KERNELS(float);
+REGISTER_CPU_KERNELS(double);
+#undef REGISTER_CPU_KERNELS
+
+}  // namespace tensorflow
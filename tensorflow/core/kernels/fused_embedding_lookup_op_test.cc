@@ -0,0 +1,95 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class FusedEmbeddingLookupOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int num_tables, const string& combiner) {
+    TF_ASSERT_OK(
+        NodeDefBuilder("fused_lookup", "FusedEmbeddingLookup")
+            .Input(FakeInput(num_tables, DT_FLOAT))
+            .Input(FakeInput(num_tables, DT_INT32))
+            .Input(FakeInput(num_tables, DT_INT32))
+            .Input(FakeInput(DT_INT32))
+            .Attr("combiner", combiner)
+            .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedEmbeddingLookupOpTest, TwoTablesMean) {
+  MakeOp(2, "mean");
+
+  // Table 0 is 3x2, table 1 is 4x3; the output rows concatenate a width-2
+  // and a width-3 combined lookup.
+  AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 10, 11, 20, 21});
+  AddInputFromArray<float>(TensorShape({4, 3}),
+                           {0, 1, 2, 10, 11, 12, 20, 21, 22, 30, 31, 32});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 2, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 1});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int32>(TensorShape({}), {3});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Segment 1 has no rows from table 1 and segment 2 none from table 0;
+  // those slices stay zero.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 5}));
+  test::FillValues<float>(&expected, {10, 11, 30, 31, 32,  //
+                                      10, 11, 0,  0,  0,   //
+                                      0,  0,  10, 11, 12});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupOpTest, SumCombinerUnsortedSegments) {
+  MakeOp(1, "sum");
+
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({4}), {2, 0, 1, 0});
+  AddInputFromArray<int32>(TensorShape({4}), {1, 0, 1, 0});
+  AddInputFromArray<int32>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {2, 4, 8, 10});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupOpTest, Error_IndexOutOfRange) {
+  MakeOp(1, "mean");
+
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 7});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({}), {2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(str_util::StrContains(s.ToString(),
+                                    "indices[0][1] == 7 out of range [0, 3)"))
+      << s;
+}
+
+}  // namespace tensorflow
@@ -162,6 +162,40 @@ TEST_F(GatherOpTest, HighRank) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(GatherOpTest, ConsecutiveIndices_TwoD32) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // Runs of consecutive indices are coalesced into single copies, so mix
+  // runs with non-consecutive indices and repeats.
+  AddInputFromArray<float>(TensorShape({5, 3}),
+                           {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14});
+  AddInputFromArray<int32>(TensorShape({7}), {1, 2, 3, 0, 3, 4, 4});
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Check the output.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({7, 3}));
+  test::FillValues<float>(&expected,
+                          {3, 4, 5, 6, 7, 8, 9, 10, 11, 0, 1, 2, 9, 10, 11, 12,
+                           13, 14, 12, 13, 14});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(GatherOpTest, Error_IndexOutOfRangeAfterRun) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // The out-of-range index terminates a run of consecutive indices, and must
+  // still be reported with its position.
+  AddInputFromArray<float>(TensorShape({5, 3}),
+                           {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14});
+  AddInputFromArray<int32>(TensorShape({4}), {3, 4, 5, 0});
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(
+      str_util::StrContains(s.ToString(), "indices[2] = 5 is not in [0, 5)"))
+      << s;
+}
+
 TEST_F(GatherOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32);
 
@@ -17,10 +17,17 @@ limitations under the License.
 
 #if GOOGLE_CUDA
 
+#include <stdlib.h>
+
 #include "google/protobuf/any.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logger.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
 #include "tensorflow/core/protobuf/conv_autotuning.pb.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
@@ -53,8 +60,125 @@ tensorflow::ComputeCapability GetComputeCapability(
   return cc;
 }
 
+// Default AutotuneCacheStore that keeps one text file per autotune group
+// under a user-supplied directory. Lines hold "<params>\t<config>"; neither
+// side contains a tab. Saves write to a temporary file first and rename it
+// into place so concurrent processes never observe a partial cache.
+class FileAutotuneCacheStore : public AutotuneCacheStore {
+ public:
+  explicit FileAutotuneCacheStore(const string& dir) : dir_(dir) {}
+
+  Status Load(const string& group,
+              std::unordered_map<string, string>* entries) override {
+    entries->clear();
+    string contents;
+    Status s = ReadFileToString(Env::Default(), GroupPath(group), &contents);
+    if (errors::IsNotFound(s)) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(s);
+    for (const string& line : str_util::Split(contents, '\n')) {
+      if (line.empty()) continue;
+      size_t tab = line.find('\t');
+      if (tab == string::npos) {
+        return errors::DataLoss("Malformed autotune cache line: ", line);
+      }
+      (*entries)[line.substr(0, tab)] = line.substr(tab + 1);
+    }
+    return Status::OK();
+  }
+
+  Status Save(const string& group,
+              const std::unordered_map<string, string>& entries) override {
+    string contents;
+    for (const auto& entry : entries) {
+      strings::StrAppend(&contents, entry.first, "\t", entry.second, "\n");
+    }
+    TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(dir_));
+    const string path = GroupPath(group);
+    const string tmp_path = strings::StrCat(path, ".tmp");
+    TF_RETURN_IF_ERROR(WriteStringToFile(Env::Default(), tmp_path, contents));
+    return Env::Default()->RenameFile(tmp_path, path);
+  }
+
+ private:
+  string GroupPath(const string& group) const {
+    return io::JoinPath(dir_, strings::StrCat(group, ".txt"));
+  }
+
+  const string dir_;
+};
+
+static mutex autotune_cache_store_mu(LINKER_INITIALIZED);
+static AutotuneCacheStore* autotune_cache_store
+    GUARDED_BY(autotune_cache_store_mu) = nullptr;
+static bool autotune_cache_store_set GUARDED_BY(autotune_cache_store_mu) =
+    false;
+
 }  // namespace
 
+void SetAutotuneCacheStore(AutotuneCacheStore* store) {
+  mutex_lock lock(autotune_cache_store_mu);
+  delete autotune_cache_store;
+  autotune_cache_store = store;
+  autotune_cache_store_set = true;
+}
+
+AutotuneCacheStore* GetAutotuneCacheStore() {
+  mutex_lock lock(autotune_cache_store_mu);
+  if (!autotune_cache_store_set) {
+    autotune_cache_store_set = true;
+    const char* dir = getenv("TF_AUTOTUNE_CACHE_DIR");
+    if (dir != nullptr && dir[0] != '\0') {
+      autotune_cache_store = new FileAutotuneCacheStore(dir);
+    }
+  }
+  return autotune_cache_store;
+}
+
+// Serialized as four space-separated integers: the scratch algorithm's id and
+// tensor-ops flag, then the no-scratch algorithm's, with id -1 standing for
+// an unset optional.
+bool AutotuneConfigSerializer<se::dnn::AlgorithmConfig>::Serialize(
+    const se::dnn::AlgorithmConfig& config, string* out) {
+  if (!config.algorithm().has_value()) {
+    return false;
+  }
+  const se::dnn::AlgorithmDesc& algorithm = *config.algorithm();
+  int64 no_scratch_id = -1;
+  bool no_scratch_tensor_ops = false;
+  if (config.algorithm_no_scratch().has_value()) {
+    no_scratch_id = config.algorithm_no_scratch()->algo_id();
+    no_scratch_tensor_ops = config.algorithm_no_scratch()->tensor_ops_enabled();
+  }
+  *out = strings::StrCat(algorithm.algo_id(), " ",
+                         algorithm.tensor_ops_enabled() ? 1 : 0, " ",
+                         no_scratch_id, " ", no_scratch_tensor_ops ? 1 : 0);
+  return true;
+}
+
+bool AutotuneConfigSerializer<se::dnn::AlgorithmConfig>::Deserialize(
+    const string& in, se::dnn::AlgorithmConfig* config) {
+  std::vector<string> fields = str_util::Split(in, ' ');
+  if (fields.size() != 4) {
+    return false;
+  }
+  int64 algo_id, algo_tensor_ops, no_scratch_id, no_scratch_tensor_ops;
+  if (!strings::safe_strto64(fields[0], &algo_id) ||
+      !strings::safe_strto64(fields[1], &algo_tensor_ops) ||
+      !strings::safe_strto64(fields[2], &no_scratch_id) ||
+      !strings::safe_strto64(fields[3], &no_scratch_tensor_ops)) {
+    return false;
+  }
+  *config = se::dnn::AlgorithmConfig(
+      se::dnn::AlgorithmDesc(algo_id, algo_tensor_ops != 0));
+  if (no_scratch_id >= 0) {
+    config->set_algorithm_no_scratch(
+        se::dnn::AlgorithmDesc(no_scratch_id, no_scratch_tensor_ops != 0));
+  }
+  return true;
+}
+
 void LogConvAutotuneResults(const NodeDef& node, const Tensor& input,
                             const Tensor& filter, const Tensor& output,
                             se::StreamExecutor* stream_exec,
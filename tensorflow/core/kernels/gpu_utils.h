@@ -41,6 +41,52 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
   return typed;
 }
 
+// Pluggable backing store used by AutoTuneMap to persist accepted autotune
+// results across process restarts, so warm restarts can skip the exhaustive
+// algorithm sweeps. Entries are keyed by the parameter's ToString()
+// representation and hold a serialized config.
+class AutotuneCacheStore {
+ public:
+  virtual ~AutotuneCacheStore() {}
+
+  // Loads all persisted entries for the named autotune group into *entries
+  // (parameter string -> serialized config). A group with no persisted state
+  // is not an error; implementations should return OK with *entries empty.
+  virtual Status Load(const string& group,
+                      std::unordered_map<string, string>* entries) = 0;
+
+  // Replaces the persisted entries for the named group.
+  virtual Status Save(const string& group,
+                      const std::unordered_map<string, string>& entries) = 0;
+};
+
+// Installs `store` as the process-wide autotune cache store, taking ownership.
+// Pass nullptr to disable persistence. Must be called before the first
+// autotuned op runs; entries loaded by earlier AutoTuneMap instances are
+// unaffected.
+void SetAutotuneCacheStore(AutotuneCacheStore* store);
+
+// Returns the active store: one installed via SetAutotuneCacheStore, else a
+// file-backed store rooted at $TF_AUTOTUNE_CACHE_DIR if that is set, else
+// nullptr (persistence disabled).
+AutotuneCacheStore* GetAutotuneCacheStore();
+
+// Converts autotune configs to and from the strings held by an
+// AutotuneCacheStore. The primary template marks a config type as not
+// persistable; AutoTuneMap instances with such configs skip persistence
+// entirely. Specialized below for se::dnn::AlgorithmConfig.
+template <typename Config>
+struct AutotuneConfigSerializer {
+  static bool Serialize(const Config& config, string* out) { return false; }
+  static bool Deserialize(const string& in, Config* config) { return false; }
+};
+
+template <>
+struct AutotuneConfigSerializer<se::dnn::AlgorithmConfig> {
+  static bool Serialize(const se::dnn::AlgorithmConfig& config, string* out);
+  static bool Deserialize(const string& in, se::dnn::AlgorithmConfig* config);
+};
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -60,6 +106,15 @@ class AutoTuneMap {
     if (iter == params_config_map_.end() ||
         (iter->second.score < min_score_threshold_ &&
          iter->second.count <= max_autotune_count_)) {
+      // Fall back to configs persisted by a previous process, so warm
+      // restarts skip the autotune sweep for shapes they have seen before.
+      if (!persisted_config_map_.empty()) {
+        auto persisted_iter = persisted_config_map_.find(params.ToString());
+        if (persisted_iter != persisted_config_map_.end()) {
+          *config = persisted_iter->second;
+          return true;
+        }
+      }
       return false;
     }
     *config = iter->second.config;
@@ -96,6 +151,7 @@ class AutoTuneMap {
     }
     if (new_score >= min_score_threshold_) {
       VLOG(1) << GetActionSummary("accepts", params, config);
+      PersistEntry(params, config);
     }
   }
 
@@ -115,6 +171,61 @@ class AutoTuneMap {
     min_score_threshold_ = std::max(min_score_threshold_, 1);
     max_autotune_count_ = std::max(
         5 * min_score_threshold_ * min_score_threshold_, min_warmup_iterations);
+    LoadPersistedEntries();
+  }
+
+  void LoadPersistedEntries() {
+    AutotuneCacheStore* store = GetAutotuneCacheStore();
+    if (store == nullptr) {
+      return;
+    }
+    std::unordered_map<string, string> entries;
+    Status s = store->Load(name_, &entries);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to load autotune cache for " << name_ << ": "
+                   << s;
+      return;
+    }
+    mutex_lock lock(mu_);
+    for (const auto& entry : entries) {
+      Config config;
+      if (AutotuneConfigSerializer<Config>::Deserialize(entry.second,
+                                                        &config)) {
+        persisted_config_map_.emplace(entry.first, config);
+      }
+    }
+    if (!persisted_config_map_.empty()) {
+      VLOG(1) << "Loaded " << persisted_config_map_.size()
+              << " persisted autotune configs for " << name_;
+    }
+  }
+
+  // Records an accepted config in the persisted map and writes the map back
+  // to the store. Accepts are rare (once per unique shape), so rewriting the
+  // whole group is cheap.
+  void PersistEntry(const Parameters& params, const Config& config)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    AutotuneCacheStore* store = GetAutotuneCacheStore();
+    if (store == nullptr) {
+      return;
+    }
+    string serialized;
+    if (!AutotuneConfigSerializer<Config>::Serialize(config, &serialized)) {
+      return;
+    }
+    persisted_config_map_[params.ToString()] = config;
+    std::unordered_map<string, string> entries;
+    for (const auto& entry : persisted_config_map_) {
+      string value;
+      if (AutotuneConfigSerializer<Config>::Serialize(entry.second, &value)) {
+        entries.emplace(entry.first, value);
+      }
+    }
+    Status s = store->Save(name_, entries);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to persist autotune cache for " << name_ << ": "
+                   << s;
+    }
   }
 
   template <class Group, class Params, class Cfg>
@@ -141,6 +252,10 @@ class AutoTuneMap {
   };
   std::unordered_map<Parameters, ValueType, Hasher> params_config_map_
       GUARDED_BY(mu_);
+  // Configs loaded from or written to the AutotuneCacheStore, keyed by
+  // Parameters::ToString(). The string key lets entries from a previous
+  // process be matched without reconstructing a Parameters object.
+  std::unordered_map<string, Config> persisted_config_map_ GUARDED_BY(mu_);
   string name_;
   int32 min_score_threshold_;
   int32 max_autotune_count_;
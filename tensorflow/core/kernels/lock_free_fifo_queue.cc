@@ -0,0 +1,543 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/data_flow_ops.cc.
+
+#include "tensorflow/core/kernels/lock_free_fifo_queue.h"
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/queue_base.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+const int32 LockFreeFIFOQueue::kMaxCapacity;
+
+/* static */
+bool LockFreeFIFOQueue::IsEnabled() {
+  static const bool enabled = []() {
+    bool val = false;
+    Status status = ReadBoolFromEnvVar("TF_FIFO_QUEUE_LOCK_FREE", false, &val);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      return false;
+    }
+    return val;
+  }();
+  return enabled;
+}
+
+LockFreeFIFOQueue::LockFreeFIFOQueue(
+    int32 capacity, const DataTypeVector& component_dtypes,
+    const std::vector<TensorShape>& component_shapes, const string& name)
+    : QueueBase(capacity, component_dtypes, component_shapes, name),
+      enqueue_pos_(0),
+      dequeue_pos_(0),
+      closed_for_fast_path_(false),
+      has_pending_attempts_(false) {}
+
+Status LockFreeFIFOQueue::Initialize() {
+  if (component_dtypes_.empty()) {
+    return errors::InvalidArgument("Empty component types for queue ", name_);
+  }
+  if (!component_shapes_.empty() &&
+      component_dtypes_.size() != component_shapes_.size()) {
+    return errors::InvalidArgument(
+        "Different number of component types.  ",
+        "Types: ", DataTypeSliceString(component_dtypes_),
+        ", Shapes: ", ShapeListString(component_shapes_));
+  }
+  if (capacity_ <= 0 || capacity_ > kMaxCapacity) {
+    return errors::InvalidArgument(
+        "LockFreeFIFOQueue requires a bounded capacity in (0, ", kMaxCapacity,
+        "], got ", capacity_, " for queue ", name_);
+  }
+  cells_.reset(new Cell[capacity_]);
+  for (int64 i = 0; i < capacity_; ++i) {
+    cells_[i].seq.store(i);
+  }
+  return Status::OK();
+}
+
+/* static */
+LockFreeFIFOQueue::Element LockFreeFIFOQueue::MakeElement(const Tuple& tuple) {
+  Element element;
+  element.reserve(tuple.size());
+  for (const Tensor& t : tuple) {
+    element.push_back(PersistentTensor(t));
+  }
+  return element;
+}
+
+bool LockFreeFIFOQueue::TryPush(Element element) {
+  int64 pos = enqueue_pos_.load();
+  Cell* cell;
+  for (;;) {
+    cell = &cells_[pos % capacity_];
+    const int64 dif = cell->seq.load() - pos;
+    if (dif == 0) {
+      // The cell is free for this position; claim it.
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1)) break;
+    } else if (dif < 0) {
+      // The cell still holds the element from one lap ago: the ring is full
+      // (or a consumer is momentarily between claiming the cell and
+      // releasing it, which looks the same and is handled the same way).
+      return false;
+    } else {
+      // Another producer claimed this position; reload and retry.
+      pos = enqueue_pos_.load();
+    }
+  }
+  cell->element = std::move(element);
+  cell->seq.store(pos + 1);
+  return true;
+}
+
+bool LockFreeFIFOQueue::TryPop(OpKernelContext* ctx, Tuple* tuple) {
+  int64 pos = dequeue_pos_.load();
+  Cell* cell;
+  for (;;) {
+    cell = &cells_[pos % capacity_];
+    const int64 dif = cell->seq.load() - (pos + 1);
+    if (dif == 0) {
+      // The cell holds the element for this position; claim it.
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1)) break;
+    } else if (dif < 0) {
+      // The ring is empty (or a producer is momentarily between claiming the
+      // cell and publishing its element).
+      return false;
+    } else {
+      // Another consumer claimed this position; reload and retry.
+      pos = dequeue_pos_.load();
+    }
+  }
+  tuple->clear();
+  tuple->reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    tuple->push_back(*cell->element[i].AccessTensor(ctx));
+  }
+  cell->element.clear();
+  cell->seq.store(pos + capacity_);
+  return true;
+}
+
+int64 LockFreeFIFOQueue::RingSize() const {
+  const int64 size = enqueue_pos_.load() - dequeue_pos_.load();
+  return std::max(int64{0}, std::min(size, static_cast<int64>(capacity_)));
+}
+
+bool LockFreeFIFOQueue::PopElementLocked(OpKernelContext* ctx, Tuple* tuple) {
+  if (!restored_.empty()) {
+    Element& element = restored_.front();
+    tuple->clear();
+    tuple->reserve(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      tuple->push_back(*element[i].AccessTensor(ctx));
+    }
+    restored_.pop_front();
+    return true;
+  }
+  return TryPop(ctx, tuple);
+}
+
+int64 LockFreeFIFOQueue::TotalSizeLocked() const {
+  return RingSize() + restored_.size();
+}
+
+void LockFreeFIFOQueue::RefreshPendingAttempts() {
+  mutex_lock l(mu_);
+  if (enqueue_attempts_.empty() && dequeue_attempts_.empty()) {
+    has_pending_attempts_.store(false);
+  }
+}
+
+void LockFreeFIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
+                                   DoneCallback callback) {
+  // Fast path: no attempt is blocked and the queue is not closing, so an
+  // enqueue that finds a free cell needs no mutex, no cancellation
+  // registration and no attempt closure.
+  if (!has_pending_attempts_.load() && !closed_for_fast_path_.load() &&
+      TryPush(MakeElement(tuple))) {
+    // An attempt may have been registered while we were pushing.  The
+    // sequentially consistent ordering of the push and this load against the
+    // registration's store and its flush guarantees that at least one side
+    // observes the other, so no dequeue attempt can sleep forever on the
+    // element we just published.
+    if (has_pending_attempts_.load()) {
+      FlushUnlocked();
+      RefreshPendingAttempts();
+    }
+    callback();
+    return;
+  }
+  SlowEnqueue(tuple, ctx, callback);
+}
+
+void LockFreeFIFOQueue::SlowEnqueue(const Tuple& tuple, OpKernelContext* ctx,
+                                    DoneCallback callback) {
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
+    if (!already_cancelled) {
+      has_pending_attempts_.store(true);
+      enqueue_attempts_.emplace_back(
+          1, callback, ctx, cm, token,
+          [tuple, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            if (closed_) {
+              attempt->context->SetStatus(
+                  errors::Cancelled("FIFOQueue '", name_, "' is closed."));
+              return kComplete;
+            }
+            if (TryPush(MakeElement(tuple))) {
+              return kComplete;
+            }
+            return kNoProgress;
+          });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+    RefreshPendingAttempts();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Enqueue operation was cancelled"));
+    callback();
+  }
+}
+
+/* static */
+Status LockFreeFIFOQueue::GetElementComponentFromBatch(
+    const Tuple& tuple, int64 index, int component, OpKernelContext* ctx,
+    PersistentTensor* out_tensor) {
+  TensorShape element_shape(tuple[component].shape());
+  element_shape.RemoveDim(0);
+  Tensor* element_access = nullptr;
+  TF_RETURN_IF_ERROR(ctx->allocate_persistent(
+      tuple[component].dtype(), element_shape, out_tensor, &element_access));
+  TF_RETURN_IF_ERROR(
+      batch_util::CopySliceToElement(tuple[component], element_access, index));
+  return Status::OK();
+}
+
+void LockFreeFIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
+                                       DoneCallback callback) {
+  const int64 batch_size = tuple[0].dim_size(0);
+  if (batch_size == 0) {
+    callback();
+    return;
+  }
+
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
+    if (!already_cancelled) {
+      has_pending_attempts_.store(true);
+      enqueue_attempts_.emplace_back(
+          batch_size, callback, ctx, cm, token,
+          [tuple, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            if (closed_) {
+              attempt->context->SetStatus(
+                  errors::Cancelled("FIFOQueue '", name_, "' is closed."));
+              return kComplete;
+            }
+            // The whole remainder of the batch is pushed under this one
+            // wakeup; TryPush only fails when the ring is full.
+            RunResult result = kNoProgress;
+            while (attempt->elements_requested > 0) {
+              const int64 index =
+                  tuple[0].dim_size(0) - attempt->elements_requested;
+              Element element(num_components());
+              for (int i = 0; i < num_components(); ++i) {
+                attempt->context->SetStatus(GetElementComponentFromBatch(
+                    tuple, index, i, attempt->context, &element[i]));
+                if (!attempt->context->status().ok()) return kComplete;
+              }
+              if (!TryPush(std::move(element))) break;
+              result = kProgress;
+              --attempt->elements_requested;
+              if (attempt->elements_requested == 0) {
+                return kComplete;
+              }
+            }
+            return result;
+          });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+    RefreshPendingAttempts();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Enqueue operation was cancelled"));
+    callback();
+  }
+}
+
+void LockFreeFIFOQueue::TryDequeue(OpKernelContext* ctx,
+                                   CallbackWithTuple callback) {
+  // Fast path: see TryEnqueue.  A pop that finds an element does not need
+  // the attempt machinery; a pop from an empty or closing queue falls
+  // through to the slow path, which also handles draining after close.
+  if (!has_pending_attempts_.load() && !closed_for_fast_path_.load()) {
+    Tuple tuple;
+    if (TryPop(ctx, &tuple)) {
+      if (has_pending_attempts_.load()) {
+        FlushUnlocked();
+        RefreshPendingAttempts();
+      }
+      callback(tuple);
+      return;
+    }
+  }
+  SlowDequeue(ctx, callback);
+}
+
+void LockFreeFIFOQueue::SlowDequeue(OpKernelContext* ctx,
+                                    CallbackWithTuple callback) {
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
+    if (!already_cancelled) {
+      has_pending_attempts_.store(true);
+      dequeue_attempts_.emplace_back(
+          1, [callback]() { callback(Tuple()); }, ctx, cm, token,
+          [callback, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            const int64 queue_size = TotalSizeLocked();
+            if (closed_ && queue_size == 0) {
+              attempt->context->SetStatus(errors::OutOfRange(
+                  "FIFOQueue '", name_, "' is closed and has ",
+                  "insufficient elements (requested ", 1, ", current size ",
+                  queue_size, ")"));
+              return kComplete;
+            }
+            Tuple tuple;
+            if (PopElementLocked(attempt->context, &tuple)) {
+              attempt->done_callback = [callback, tuple]() { callback(tuple); };
+              return kComplete;
+            }
+            return kNoProgress;
+          });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+    RefreshPendingAttempts();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Dequeue operation was cancelled"));
+    callback(Tuple());
+  }
+}
+
+void LockFreeFIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
+                                       bool allow_small_batch,
+                                       CallbackWithTuple callback) {
+  if (!specified_shapes()) {
+    ctx->SetStatus(errors::InvalidArgument(
+        "FIFOQueue's DequeueMany and DequeueUpTo require the "
+        "components to have specified shapes."));
+    callback(Tuple());
+    return;
+  }
+  if (num_elements == 0) {
+    Tuple tuple;
+    tuple.reserve(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      Tensor element;
+      Status status = ctx->allocate_temp(component_dtypes_[i],
+                                         ManyOutShape(i, 0), &element);
+      if (!status.ok()) {
+        ctx->SetStatus(status);
+        callback(Tuple());
+        return;
+      }
+      tuple.emplace_back(element);
+    }
+    callback(tuple);
+    return;
+  }
+
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
+    if (!already_cancelled) {
+      has_pending_attempts_.store(true);
+      dequeue_attempts_.emplace_back(
+          num_elements, [callback]() { callback(Tuple()); }, ctx, cm, token,
+          [callback, allow_small_batch,
+           this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            int64 queue_size = TotalSizeLocked();
+
+            if (closed_ && queue_size < attempt->elements_requested) {
+              // If we don't have enough for a full dequeue, we have
+              // to reset the attempt tuple.
+              if (!attempt->tuple.empty()) {
+                // Restore already-dequeued elements to the front of the
+                // queue.  A ring buffer has no push_front, so restored
+                // elements go to a side deque that PopElementLocked
+                // consumes before the ring; at this point the queue is
+                // closed, so no lock-free dequeue can bypass it.
+                for (int64 i = attempt->tuple[0].dim_size(0) -
+                               attempt->elements_requested - 1;
+                     i >= 0; --i) {
+                  Element element(num_components());
+                  for (int j = 0; j < num_components(); ++j) {
+                    Status s = GetElementComponentFromBatch(
+                        attempt->tuple, i, j, attempt->context, &element[j]);
+                    if (!s.ok()) {
+                      attempt->context->SetStatus(
+                          errors::DataLoss("Failed to restore element from "
+                                           "partially-dequeued batch "
+                                           "to FIFOQueue: ",
+                                           s.error_message()));
+                    }
+                  }
+                  restored_.push_front(std::move(element));
+                }
+              }
+              if (allow_small_batch && TotalSizeLocked() > 0) {
+                // Request all remaining elements in the queue.
+                queue_size = TotalSizeLocked();
+                attempt->tuple.clear();
+                attempt->elements_requested = queue_size;
+              } else {
+                if (allow_small_batch) {
+                  // There may be some other attempts containing
+                  // values.  If so, we'll yield and wait for them
+                  // to add elements to the queue.
+                  if (!enqueue_attempts_.empty()) return kProgress;
+                }
+                if (attempt->context->status().ok()) {
+                  attempt->context->SetStatus(errors::OutOfRange(
+                      "FIFOQueue '", name_, "' is closed and has ",
+                      "insufficient elements (requested ",
+                      attempt->elements_requested, ", current size ",
+                      queue_size, ")"));
+                }
+                return kComplete;
+              }
+            }
+
+            // The whole remainder of the batch is collected under this one
+            // wakeup.
+            RunResult result = kNoProgress;
+            for (; queue_size > 0; --queue_size) {
+              if (attempt->tuple.empty()) {
+                // Only allocate tuple when we have something to dequeue
+                // so we don't use excessive memory when there are many
+                // blocked dequeue attempts waiting.
+                attempt->tuple.reserve(num_components());
+                for (int i = 0; i < num_components(); ++i) {
+                  const TensorShape shape =
+                      ManyOutShape(i, attempt->elements_requested);
+                  Tensor element;
+                  attempt->context->SetStatus(attempt->context->allocate_temp(
+                      component_dtypes_[i], shape, &element));
+                  if (!attempt->context->status().ok()) return kComplete;
+                  attempt->tuple.emplace_back(element);
+                }
+              }
+              Tuple tuple;
+              if (!PopElementLocked(attempt->context, &tuple)) {
+                // A lock-free operation that started before this attempt
+                // registered is still publishing its element; retry on the
+                // next flush.
+                break;
+              }
+              result = kProgress;
+              const int64 index =
+                  attempt->tuple[0].dim_size(0) - attempt->elements_requested;
+              for (int i = 0; i < num_components(); ++i) {
+                attempt->context->SetStatus(batch_util::CopyElementToSlice(
+                    std::move(tuple[i]), &attempt->tuple[i], index));
+                if (!attempt->context->status().ok()) return kComplete;
+              }
+              tuple.clear();
+              --attempt->elements_requested;
+              if (attempt->elements_requested == 0) {
+                tuple = attempt->tuple;
+                attempt->done_callback = [callback, tuple]() {
+                  callback(tuple);
+                };
+                return kComplete;
+              }
+            }
+            return result;
+          });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+    RefreshPendingAttempts();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Dequeue operation was cancelled"));
+    callback(Tuple());
+  }
+}
+
+void LockFreeFIFOQueue::Close(OpKernelContext* ctx,
+                              bool cancel_pending_enqueues,
+                              DoneCallback callback) {
+  // Disable the fast path before taking mu_; from here on every operation
+  // goes through the attempt machinery, which checks closed_ under the lock.
+  // Setting the flag early is harmless: it only diverts fast operations to
+  // the slow path.
+  closed_for_fast_path_.store(true);
+  QueueBase::Close(ctx, cancel_pending_enqueues, callback);
+}
+
+Status LockFreeFIFOQueue::MatchesNodeDef(const NodeDef& node_def) {
+  if (!MatchesNodeDefOp(node_def, "FIFOQueue").ok() &&
+      !MatchesNodeDefOp(node_def, "FIFOQueueV2").ok()) {
+    return errors::InvalidArgument("Expected FIFOQueue, found ", node_def.op());
+  }
+  TF_RETURN_IF_ERROR(MatchesNodeDefCapacity(node_def, capacity_));
+  TF_RETURN_IF_ERROR(MatchesNodeDefTypes(node_def));
+  TF_RETURN_IF_ERROR(MatchesNodeDefShapes(node_def));
+  return Status::OK();
+}
+
+int32 LockFreeFIFOQueue::size() const {
+  mutex_lock lock(mu_);
+  return static_cast<int32>(TotalSizeLocked());
+}
+
+}  // namespace tensorflow
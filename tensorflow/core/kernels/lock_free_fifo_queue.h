@@ -0,0 +1,151 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOCK_FREE_FIFO_QUEUE_H_
+#define TENSORFLOW_CORE_KERNELS_LOCK_FREE_FIFO_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/queue_base.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bounded FIFO queue whose storage is a lock-free MPMC ring buffer
+// (Vyukov's bounded queue: one sequence counter per cell).  It implements the
+// same semantics as FIFOQueue and is substituted for it by FIFOQueueOp when
+// TF_FIFO_QUEUE_LOCK_FREE=1 is set and the capacity is bounded.
+//
+// The common case - enqueue on a queue that is neither full nor closed,
+// dequeue on a queue that is neither empty nor closed, with no blocked
+// operations - completes with a handful of atomic operations and no mutex or
+// cancellation bookkeeping.  Everything else (blocking, batched
+// enqueue-many/dequeue-many, closing, cancellation) goes through the
+// QueueBase attempt machinery under mu_, exactly like FIFOQueue; while any
+// attempt is pending the fast path is disabled so attempts are served in
+// FIFO order.  A batched operation synchronizes once for the whole batch.
+class LockFreeFIFOQueue : public QueueBase {
+ public:
+  // Ring cells are allocated eagerly, so cap the capacity this
+  // implementation accepts; FIFOQueueOp falls back to FIFOQueue beyond it.
+  static const int32 kMaxCapacity = 1 << 20;
+
+  // Returns true iff TF_FIFO_QUEUE_LOCK_FREE=1 is set in the environment.
+  static bool IsEnabled();
+
+  LockFreeFIFOQueue(int32 capacity, const DataTypeVector& component_dtypes,
+                    const std::vector<TensorShape>& component_shapes,
+                    const string& name);
+
+  Status Initialize();  // Must be called before any other method.
+
+  // Implementations of QueueInterface methods --------------------------------
+
+  void TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
+                  DoneCallback callback) override;
+  void TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
+                      DoneCallback callback) override;
+  void TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) override;
+  void TryDequeueMany(int num_elements, OpKernelContext* ctx,
+                      bool allow_small_batch,
+                      CallbackWithTuple callback) override;
+  void Close(OpKernelContext* ctx, bool cancel_pending_enqueues,
+             DoneCallback callback) override;
+  Status MatchesNodeDef(const NodeDef& node_def) override;
+
+  int32 size() const override;
+
+ protected:
+  ~LockFreeFIFOQueue() override {}
+
+ private:
+  // One element of the queue: one PersistentTensor per component.
+  typedef std::vector<PersistentTensor> Element;
+
+  // One ring cell.  'seq' implements the bounded MPMC protocol: a cell is
+  // free for the producer of position 'pos' iff seq == pos, and holds the
+  // element of position 'pos' for its consumer iff seq == pos + 1.  After
+  // consumption seq becomes pos + capacity, freeing the cell for the
+  // producer one lap later.
+  struct Cell {
+    std::atomic<int64> seq;
+    Element element;
+  };
+
+  // Lock-free ring operations.  Safe to call with or without mu_ held; all
+  // atomics use sequentially consistent ordering so a fast-path operation
+  // and a concurrently registered attempt are guaranteed to observe each
+  // other (see TryEnqueue/TryDequeue).
+  bool TryPush(Element element);
+  bool TryPop(OpKernelContext* ctx, Tuple* tuple);
+
+  // Number of elements currently in the ring (approximate while lock-free
+  // operations are in flight, exact under mu_ with no attempts pending).
+  int64 RingSize() const;
+
+  // Pops from restored_ first, then from the ring.  restored_ holds elements
+  // that a partially-satisfied DequeueMany returned when the queue was
+  // closed; it is only ever non-empty after closing, when the fast path is
+  // already disabled, so consuming it under mu_ preserves FIFO order.
+  bool PopElementLocked(OpKernelContext* ctx, Tuple* tuple)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  int64 TotalSizeLocked() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Converts a tuple to the ring's element representation.
+  static Element MakeElement(const Tuple& tuple);
+
+  // Extracts element 'index' of a batched tuple as an Element.
+  static Status GetElementComponentFromBatch(const Tuple& tuple, int64 index,
+                                             int component,
+                                             OpKernelContext* ctx,
+                                             PersistentTensor* out_tensor);
+
+  // Slow paths, structured like FIFOQueue's implementations but operating on
+  // the ring.
+  void SlowEnqueue(const Tuple& tuple, OpKernelContext* ctx,
+                   DoneCallback callback);
+  void SlowDequeue(OpKernelContext* ctx, CallbackWithTuple callback);
+
+  // Clears has_pending_attempts_ if both attempt queues are empty.
+  void RefreshPendingAttempts();
+
+  std::unique_ptr<Cell[]> cells_;
+  std::atomic<int64> enqueue_pos_;
+  std::atomic<int64> dequeue_pos_;
+
+  // Mirrors of state guarded by mu_, readable without the lock.  Both only
+  // ever disable the fast path conservatively: a stale 'true' costs a trip
+  // through the attempt machinery, never correctness.
+  std::atomic<bool> closed_for_fast_path_;
+  std::atomic<bool> has_pending_attempts_;
+
+  std::deque<Element> restored_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LockFreeFIFOQueue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOCK_FREE_FIFO_QUEUE_H_
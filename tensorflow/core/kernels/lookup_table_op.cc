@@ -16,26 +16,322 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <type_traits>
+#include <unordered_set>
 #include <utility>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace lookup {
 
+// Open-addressing hash table representation optimized for read-mostly
+// concurrent access, used as an alternative backing store for
+// MutableHashTableOfScalars when TF_MUTABLE_HASH_TABLE_READ_OPTIMIZED=1.
+//
+// Slots are organized in groups of eight; each group has an eight-byte tag
+// word (one byte per slot: zero for empty, otherwise the high bit plus seven
+// hash bits) that is probed with word-wide bitwise arithmetic, so a group is
+// rejected with a single load and a handful of ALU ops instead of one pointer
+// chase per entry.  For eight-byte keys a group's keys span one cache line.
+//
+// Readers never take a lock: they atomically grab a shared_ptr snapshot of
+// the representation and probe it.  Writers are externally serialized (by
+// the table's mutex).  Inserting a brand-new key fills the first empty slot
+// in its probe sequence and then publishes the slot with a release store of
+// the tag word, which readers observe with an acquire load.  Operations that
+// would mutate a published slot - updates, removals, clears, growth -
+// instead build a fresh representation and atomically swap it in; the old
+// one is reclaimed when the last reader drops its snapshot.  Since no
+// published slot is ever emptied in place, a reader may stop probing at the
+// first group containing an empty slot.
+template <class K, class V>
+class ReadMostlyFlatTable {
+ public:
+  // Returns true iff TF_MUTABLE_HASH_TABLE_READ_OPTIMIZED=1 is set in the
+  // environment.
+  static bool IsEnabled() {
+    static const bool enabled = []() {
+      bool val = false;
+      Status status = ReadBoolFromEnvVar("TF_MUTABLE_HASH_TABLE_READ_OPTIMIZED",
+                                         false, &val);
+      if (!status.ok()) {
+        LOG(ERROR) << status.error_message();
+        return false;
+      }
+      return val;
+    }();
+    return enabled;
+  }
+
+  ReadMostlyFlatTable() { std::atomic_store(&rep_, MakeRep(kInitialGroups)); }
+
+  // Lock-free.  Returns true and sets *value if the key is present.
+  bool Find(const K& key, V* value) const {
+    std::shared_ptr<Rep> rep = std::atomic_load(&rep_);
+    const uint64 h = HashKey(key);
+    const uint64 pattern = BroadcastByte(TagOfHash(h));
+    uint64 group = h & rep->group_mask;
+    for (uint64 probes = 0; probes <= rep->group_mask; ++probes) {
+      const uint64 tags = rep->tags[group].load(std::memory_order_acquire);
+      uint64 match = MatchTag(tags, pattern);
+      while (match != 0) {
+        const int64 index = group * kGroupSize + SlotOfMatchBit(match);
+        if (rep->keys[index] == key) {
+          *value = rep->values[index];
+          return true;
+        }
+        match &= match - 1;
+      }
+      if (MatchEmpty(tags) != 0) {
+        return false;
+      }
+      group = (group + 1) & rep->group_mask;
+    }
+    return false;
+  }
+
+  size_t size() const {
+    return std::atomic_load(&rep_)->num_entries.load(std::memory_order_relaxed);
+  }
+
+  // Writer methods; callers must be externally serialized.  Concurrent
+  // readers remain safe.
+
+  void Insert(const K* keys, const V* values, int64 n) {
+    std::shared_ptr<Rep> rep = std::atomic_load(&rep_);
+    int64 i = 0;
+    for (; i < n; ++i) {
+      // In-place publication only works for keys the table does not contain
+      // yet; stop at the first update (or when the load factor is reached)
+      // and fold the remainder into a rebuild.
+      if (!InsertNewKeyInPlace(rep.get(), keys[i], values[i])) break;
+    }
+    if (i == n) return;
+    const int64 remaining = n - i;
+    std::shared_ptr<Rep> new_rep = MakeRep(NumGroupsFor(
+        rep->num_entries.load(std::memory_order_relaxed) + remaining));
+    CopyEntries(*rep, new_rep.get());
+    for (; i < n; ++i) {
+      InsertOrUpdateUnpublished(new_rep.get(), keys[i], values[i]);
+    }
+    std::atomic_store(&rep_, new_rep);
+  }
+
+  void Remove(const K* keys, int64 n) {
+    std::shared_ptr<Rep> rep = std::atomic_load(&rep_);
+    const std::unordered_set<K> removed(keys, keys + n);
+    std::shared_ptr<Rep> new_rep = MakeRep(
+        NumGroupsFor(rep->num_entries.load(std::memory_order_relaxed)));
+    ForEachIn(*rep, [&removed, &new_rep](const K& key, const V& value) {
+      if (removed.count(key) == 0) {
+        InsertOrUpdateUnpublished(new_rep.get(), key, value);
+      }
+    });
+    std::atomic_store(&rep_, new_rep);
+  }
+
+  void Clear() { std::atomic_store(&rep_, MakeRep(kInitialGroups)); }
+
+  // Calls fn(key, value) for every entry.  Must not race with writers.
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    ForEachIn(*std::atomic_load(&rep_), fn);
+  }
+
+  int64 MemoryUsed() const {
+    std::shared_ptr<Rep> rep = std::atomic_load(&rep_);
+    return sizeof(ReadMostlyFlatTable) +
+           rep->capacity * (1 + sizeof(K) + sizeof(V));
+  }
+
+ private:
+  static const int64 kGroupSize = 8;
+  static const uint64 kInitialGroups = 4;
+  static const uint64 kHighBits = 0x8080808080808080ULL;
+  static const uint64 kLowBits = 0x0101010101010101ULL;
+
+  struct Rep {
+    explicit Rep(uint64 num_groups)
+        : tags(new std::atomic<uint64>[num_groups]),
+          keys(num_groups * kGroupSize),
+          values(num_groups * kGroupSize),
+          group_mask(num_groups - 1),
+          capacity(num_groups * kGroupSize),
+          num_entries(0) {
+      for (uint64 i = 0; i < num_groups; ++i) {
+        tags[i].store(0, std::memory_order_relaxed);
+      }
+    }
+    std::unique_ptr<std::atomic<uint64>[]> tags;
+    std::vector<K> keys;
+    std::vector<V> values;
+    const uint64 group_mask;
+    const int64 capacity;
+    std::atomic<int64> num_entries;
+  };
+
+  static std::shared_ptr<Rep> MakeRep(uint64 num_groups) {
+    return std::make_shared<Rep>(num_groups);
+  }
+
+  // Smallest power-of-two group count keeping the load factor below 3/4.
+  static uint64 NumGroupsFor(int64 entries) {
+    uint64 num_groups = kInitialGroups;
+    while (static_cast<int64>(num_groups * kGroupSize) -
+               static_cast<int64>(num_groups * kGroupSize) / 4 <
+           entries + 1) {
+      num_groups <<= 1;
+    }
+    return num_groups;
+  }
+
+  static uint64 HashKey(const string& key) {
+    return Hash64(key.data(), key.size());
+  }
+  template <typename T>
+  static uint64 HashKey(const T& key) {
+    // Integer keys are often sequential ids; a multiplicative mix spreads
+    // them over both the group index (low bits) and the tag (high bits).
+    uint64 h = static_cast<uint64>(key) * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 29);
+  }
+
+  // An occupied slot's tag has the high bit set plus seven hash bits, so an
+  // empty slot (zero) can never match an occupied pattern.
+  static uint8 TagOfHash(uint64 h) { return 0x80 | (h >> 57); }
+
+  static uint64 BroadcastByte(uint8 b) { return kLowBits * b; }
+
+  // Returns a word with bit 7 set in every byte of 'tags' equal to the
+  // broadcast byte 'pattern' (the classic SWAR zero-byte test).
+  static uint64 MatchTag(uint64 tags, uint64 pattern) {
+    const uint64 x = tags ^ pattern;
+    return (x - kLowBits) & ~x & kHighBits;
+  }
+
+  static uint64 MatchEmpty(uint64 tags) { return ~tags & kHighBits; }
+
+  static int SlotOfMatchBit(uint64 match) {
+    return Log2Floor64(match & (0 - match)) / 8;
+  }
+
+  // Inserts a key the representation does not contain, publishing the slot
+  // to concurrent readers.  Returns false if the key is already present or
+  // the load factor has been reached.
+  static bool InsertNewKeyInPlace(Rep* rep, const K& key, const V& value) {
+    const int64 capacity = rep->capacity;
+    if (rep->num_entries.load(std::memory_order_relaxed) >=
+        capacity - capacity / 4) {
+      return false;
+    }
+    const uint64 h = HashKey(key);
+    const uint8 tag = TagOfHash(h);
+    const uint64 pattern = BroadcastByte(tag);
+    uint64 group = h & rep->group_mask;
+    for (;;) {
+      const uint64 tags = rep->tags[group].load(std::memory_order_relaxed);
+      uint64 match = MatchTag(tags, pattern);
+      while (match != 0) {
+        const int64 index = group * kGroupSize + SlotOfMatchBit(match);
+        if (rep->keys[index] == key) {
+          return false;  // Existing key; the caller must rebuild to update.
+        }
+        match &= match - 1;
+      }
+      const uint64 empty = MatchEmpty(tags);
+      if (empty != 0) {
+        const int slot = SlotOfMatchBit(empty);
+        const int64 index = group * kGroupSize + slot;
+        rep->keys[index] = key;
+        rep->values[index] = value;
+        rep->num_entries.fetch_add(1, std::memory_order_relaxed);
+        // Publish the slot; readers acquire the tag word before touching
+        // the key or value.
+        rep->tags[group].store(tags | (static_cast<uint64>(tag) << (slot * 8)),
+                               std::memory_order_release);
+        return true;
+      }
+      group = (group + 1) & rep->group_mask;
+    }
+  }
+
+  // Insert-or-update into a representation no reader can see yet, so slots
+  // may be overwritten and tag stores need no ordering.
+  static void InsertOrUpdateUnpublished(Rep* rep, const K& key,
+                                        const V& value) {
+    const uint64 h = HashKey(key);
+    const uint8 tag = TagOfHash(h);
+    const uint64 pattern = BroadcastByte(tag);
+    uint64 group = h & rep->group_mask;
+    for (;;) {
+      const uint64 tags = rep->tags[group].load(std::memory_order_relaxed);
+      uint64 match = MatchTag(tags, pattern);
+      while (match != 0) {
+        const int64 index = group * kGroupSize + SlotOfMatchBit(match);
+        if (rep->keys[index] == key) {
+          rep->values[index] = value;
+          return;
+        }
+        match &= match - 1;
+      }
+      const uint64 empty = MatchEmpty(tags);
+      if (empty != 0) {
+        const int slot = SlotOfMatchBit(empty);
+        const int64 index = group * kGroupSize + slot;
+        rep->keys[index] = key;
+        rep->values[index] = value;
+        rep->num_entries.fetch_add(1, std::memory_order_relaxed);
+        rep->tags[group].store(tags | (static_cast<uint64>(tag) << (slot * 8)),
+                               std::memory_order_relaxed);
+        return;
+      }
+      group = (group + 1) & rep->group_mask;
+    }
+  }
+
+  static void CopyEntries(const Rep& from, Rep* to) {
+    ForEachIn(from, [to](const K& key, const V& value) {
+      InsertOrUpdateUnpublished(to, key, value);
+    });
+  }
+
+  template <typename Fn>
+  static void ForEachIn(const Rep& rep, Fn fn) {
+    for (uint64 group = 0; group <= rep.group_mask; ++group) {
+      uint64 occupied =
+          rep.tags[group].load(std::memory_order_acquire) & kHighBits;
+      while (occupied != 0) {
+        const int64 index = group * kGroupSize + SlotOfMatchBit(occupied);
+        fn(rep.keys[index], rep.values[index]);
+        occupied &= occupied - 1;
+      }
+    }
+  }
+
+  std::shared_ptr<Rep> rep_;
+};
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
 //
+// When TF_MUTABLE_HASH_TABLE_READ_OPTIMIZED=1 is set, the unordered_map is
+// replaced by a ReadMostlyFlatTable, which serves Find without taking the
+// lock at all; see its comment for the trade-offs.
+//
 // Sample use case:
 //
 // MutableHashTableOfScalars<int64, int64> table;  // int64 -> int64.
@@ -47,9 +343,16 @@ namespace lookup {
 template <class K, class V>
 class MutableHashTableOfScalars final : public LookupInterface {
  public:
-  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
+  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {
+    if (ReadMostlyFlatTable<K, V>::IsEnabled()) {
+      flat_.reset(new ReadMostlyFlatTable<K, V>());
+    }
+  }
 
   size_t size() const override {
+    if (flat_) {
+      return flat_->size();
+    }
     tf_shared_lock l(mu_);
     return table_.size();
   }
@@ -60,6 +363,16 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
+    if (flat_) {
+      // Lock-free: probes a snapshot of the flat representation.
+      for (int64 i = 0; i < key_values.size(); ++i) {
+        V result = default_val;
+        flat_->Find(SubtleMustCopyIfIntegral(key_values(i)), &result);
+        value_values(i) = result;
+      }
+      return Status::OK();
+    }
+
     tf_shared_lock l(mu_);
     for (int64 i = 0; i < key_values.size(); ++i) {
       value_values(i) = gtl::FindWithDefault(
@@ -74,6 +387,13 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto value_values = values.flat<V>();
 
     mutex_lock l(mu_);
+    if (flat_) {
+      if (clear) {
+        flat_->Clear();
+      }
+      flat_->Insert(key_values.data(), value_values.data(), key_values.size());
+      return Status::OK();
+    }
     if (clear) {
       table_.clear();
     }
@@ -93,6 +413,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
 
     mutex_lock l(mu_);
+    if (flat_) {
+      flat_->Remove(key_values.data(), key_values.size());
+      return Status::OK();
+    }
     for (int64 i = 0; i < key_values.size(); ++i) {
       table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
     }
@@ -106,7 +430,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   Status ExportValues(OpKernelContext* ctx) override {
     tf_shared_lock l(mu_);
-    int64 size = table_.size();
+    int64 size = flat_ ? flat_->size() : table_.size();
 
     Tensor* keys;
     Tensor* values;
@@ -118,6 +442,15 @@ class MutableHashTableOfScalars final : public LookupInterface {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64 i = 0;
+    if (flat_) {
+      flat_->ForEach([&keys_data, &values_data, &i](const K& key,
+                                                    const V& value) {
+        keys_data(i) = key;
+        values_data(i) = value;
+        ++i;
+      });
+      return Status::OK();
+    }
     for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
       keys_data(i) = it->first;
       values_data(i) = it->second;
@@ -134,6 +467,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64 MemoryUsed() const override {
+    if (flat_) {
+      return sizeof(MutableHashTableOfScalars) + flat_->MemoryUsed();
+    }
     int64 ret = 0;
     tf_shared_lock l(mu_);
     for (unsigned i = 0; i < table_.bucket_count(); ++i) {
@@ -150,6 +486,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
  private:
   mutable mutex mu_;
   std::unordered_map<K, V> table_ GUARDED_BY(mu_);
+  // Non-null iff the read-optimized flat representation is selected; then
+  // table_ stays unused and mu_ only serializes writers.
+  std::unique_ptr<ReadMostlyFlatTable<K, V>> flat_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
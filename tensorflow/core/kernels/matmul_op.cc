@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/util/matmul_autotune.h"
+#include "tensorflow/core/util/work_sharder.h"
 #if GOOGLE_CUDA
 #include "cuda/include/cuda.h"
 #include "tensorflow/core/kernels/gpu_utils.h"
@@ -435,6 +436,91 @@ struct LaunchMatMul<GPUDevice, T, true /* USE_CUBLAS */> {
 
 #endif  // GOOGLE_CUDA
 
+namespace {
+
+// Number of floats of converted right-hand-side panel kept per worker. The
+// panel is sized so that it stays resident in the L2 cache between its
+// conversion and its use by the contraction kernel.
+constexpr int64 kBfloat16PanelBudgetFloats = 1 << 16;  // 256KB
+
+// Computes a bfloat16 matmul by converting cache-sized panels of the inputs
+// to float and contracting them with Eigen's vectorized float kernels.
+//
+// Unlike a whole-tensor conversion, which writes a float copy of each
+// operand to memory and reads it back, the converted panel is consumed
+// while it is still cache-resident, so each bfloat16 operand is read from
+// memory exactly once and the bandwidth advantage of the narrow type is
+// preserved. Panels of output columns are distributed across the intra-op
+// thread pool.
+void LaunchBfloat16MatMul(
+    OpKernelContext* ctx, const Tensor& a, const Tensor& b,
+    const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+    bool transpose_b, Tensor* out) {
+  const int64 m = out->dim_size(0);
+  const int64 n = out->dim_size(1);
+  const int64 k = a.dim_size(dim_pair[0].first);
+
+  // The left operand is typically the small one (activations), so convert
+  // it once up front; the panels of the large right operand are converted
+  // on the fly below.
+  Tensor a_float;
+  OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, a.shape(), &a_float));
+  BFloat16ToFloat(a.flat<bfloat16>().data(), a_float.flat<float>().data(),
+                  a.NumElements());
+
+  const int64 panel_cols = std::min<int64>(
+      n, std::max<int64>(16, kBfloat16PanelBudgetFloats / std::max<int64>(
+                                                              k, int64{1})));
+  const int64 num_panels = (n + panel_cols - 1) / panel_cols;
+
+  const float* a_data = a_float.flat<float>().data();
+  const bfloat16* b_data = b.flat<bfloat16>().data();
+  bfloat16* out_data = out->flat<bfloat16>().data();
+  const int64 a_rows = a.dim_size(0);
+  const int64 a_cols = a.dim_size(1);
+
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  // Approximate FMA count per panel, so small problems stay single-threaded.
+  const int64 cost_per_panel = m * k * panel_cols;
+  Shard(
+      worker_threads.num_threads, worker_threads.workers, num_panels,
+      cost_per_panel, [&](int64 panel_begin, int64 panel_end) {
+        std::unique_ptr<float[]> b_panel(new float[k * panel_cols]);
+        std::unique_ptr<float[]> out_panel(new float[m * panel_cols]);
+        typedef Eigen::TensorMap<
+            Eigen::Tensor<const float, 2, Eigen::RowMajor>, Eigen::Aligned>
+            ConstTensorMap;
+        typedef Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor>>
+            TensorMapType;
+        for (int64 p = panel_begin; p < panel_end; ++p) {
+          const int64 col_begin = p * panel_cols;
+          const int64 cols = std::min(panel_cols, n - col_begin);
+          if (transpose_b) {
+            // `b` is [n, k]: the panel's rows are contiguous in memory.
+            BFloat16ToFloat(b_data + col_begin * k, b_panel.get(), cols * k);
+          } else {
+            // `b` is [k, n]: convert the column slice row by row.
+            for (int64 r = 0; r < k; ++r) {
+              BFloat16ToFloat(b_data + r * n + col_begin,
+                              b_panel.get() + r * cols, cols);
+            }
+          }
+          ConstTensorMap a_map(a_data, a_rows, a_cols);
+          Eigen::TensorMap<Eigen::Tensor<const float, 2, Eigen::RowMajor>>
+              b_map(b_panel.get(), transpose_b ? cols : k,
+                    transpose_b ? k : cols);
+          TensorMapType out_map(out_panel.get(), m, cols);
+          out_map = a_map.contract(b_map, dim_pair);
+          for (int64 r = 0; r < m; ++r) {
+            FloatToBFloat16(out_panel.get() + r * cols,
+                            out_data + r * n + col_begin, cols);
+          }
+        }
+      });
+}
+
+}  // namespace
+
 template <typename Device, typename T, bool USE_CUBLAS>
 class MatMulOp : public OpKernel {
  public:
@@ -496,23 +582,7 @@ class MatMulOp : public OpKernel {
       bool is_cpu = std::is_same<Device, CPUDevice>::value;
       OP_REQUIRES(ctx, is_cpu,
                   errors::Internal("bfloat16 matmul is not supported by GPU"));
-      Tensor a_float, b_float, out_float;
-      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, a.shape(), &a_float));
-      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, b.shape(), &b_float));
-      OP_REQUIRES_OK(ctx,
-                     ctx->allocate_temp(DT_FLOAT, out->shape(), &out_float));
-
-      // TODO: Avoid extra copy to make bfloat16 matmul efficient on CPU.
-      BFloat16ToFloat(a.flat<bfloat16>().data(), a_float.flat<float>().data(),
-                      a.NumElements());
-      BFloat16ToFloat(b.flat<bfloat16>().data(), b_float.flat<float>().data(),
-                      b.NumElements());
-
-      LaunchMatMul<Device, float, USE_CUBLAS>::launch(
-          ctx, a_float, b_float, dim_pair, &algorithms_, use_autotune_,
-          &out_float);
-      FloatToBFloat16(out_float.flat<float>().data(),
-                      out->flat<bfloat16>().data(), out->NumElements());
+      LaunchBfloat16MatMul(ctx, a, b, dim_pair, transpose_b_, out);
     } else {
       LaunchMatMul<Device, T, USE_CUBLAS>::launch(
           ctx, a, b, dim_pair, &algorithms_, use_autotune_, out);
@@ -0,0 +1,212 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements matmul operations with other kernels baked into the processing,
+// to optimize latency and memory usage:
+//  - MatMul + BiasAdd + <Activation>
+//
+// Activation: Relu, Relu6, Elu.
+//
+// Fusion is implemented with an Eigen tensor contraction output kernel, so
+// the fused term is applied to each output block while it is still hot in
+// cache; there is no second pass over the output matrix. CPU only.
+
+#define EIGEN_USE_THREADS
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Supported _FusedMatMul fusions. CPU only for now.
+enum class FusedMatMulComputation {
+  kBiasAdd,
+  kBiasAddWithRelu,
+  kBiasAddWithRelu6,
+  kBiasAddWithElu,
+};
+
+bool FusedOpsMatch(const std::vector<string>& fused_ops,
+                   const std::vector<string>& expected) {
+  return fused_ops == expected;
+}
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedMatMulOp;
+
+template <typename T>
+class FusedMatMulOp<CPUDevice, T> : public OpKernel {
+ public:
+  explicit FusedMatMulOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+
+    // 'fused_ops' and 'num_args' attributes are specified by the Grappler
+    // Remapper optimizer (see grappler/optimizers/remapper.cc).
+
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument(
+                    "Fused MatMul must have at least one fused op."));
+
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+
+    // Match combination of fused ops to one of the supported fusions.
+    if (FusedOpsMatch(fused_ops, {"BiasAdd"})) {
+      fused_computation_ = FusedMatMulComputation::kBiasAdd;
+    } else if (FusedOpsMatch(fused_ops, {"BiasAdd", "Relu"})) {
+      fused_computation_ = FusedMatMulComputation::kBiasAddWithRelu;
+    } else if (FusedOpsMatch(fused_ops, {"BiasAdd", "Relu6"})) {
+      fused_computation_ = FusedMatMulComputation::kBiasAddWithRelu6;
+    } else if (FusedOpsMatch(fused_ops, {"BiasAdd", "Elu"})) {
+      fused_computation_ = FusedMatMulComputation::kBiasAddWithElu;
+    } else {
+      OP_REQUIRES(context, false,
+                  errors::Unimplemented("Fusion is not implemented: [",
+                                        absl::StrJoin(fused_ops, ","), "]"));
+    }
+
+    OP_REQUIRES(context, num_args == 1,
+                errors::InvalidArgument(
+                    "Fused MatMul must have one extra argument: bias."));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& bias = context->input(2);
+
+    // Check that the dimensions of the two matrices are valid.
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsMatrix(a.shape()),
+        errors::InvalidArgument("In[0] is not a matrix. Instead it has shape ",
+                                a.shape().DebugString()));
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsMatrix(b.shape()),
+        errors::InvalidArgument("In[1] is not a matrix. Instead it has shape ",
+                                b.shape().DebugString()));
+
+    Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> dim_pair;
+    dim_pair[0].first = transpose_a_ ? 0 : 1;
+    dim_pair[0].second = transpose_b_ ? 1 : 0;
+
+    OP_REQUIRES(context,
+                a.dim_size(dim_pair[0].first) == b.dim_size(dim_pair[0].second),
+                errors::InvalidArgument(
+                    "Matrix size-incompatible: In[0]: ", a.shape().DebugString(),
+                    ", In[1]: ", b.shape().DebugString()));
+
+    const int a_dim_remaining = 1 - dim_pair[0].first;
+    const int b_dim_remaining = 1 - dim_pair[0].second;
+    TensorShape out_shape(
+        {a.dim_size(a_dim_remaining), b.dim_size(b_dim_remaining)});
+
+    // Bias of the following dimensions: [ output_cols ]
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(bias.shape()),
+                errors::InvalidArgument("bias must be 1-dimensional",
+                                        bias.shape().DebugString()));
+    OP_REQUIRES(context, bias.dim_size(0) == out_shape.dim_size(1),
+                errors::InvalidArgument(
+                    "bias has an incompatible size: ",
+                    bias.shape().DebugString(),
+                    " vs. output shape: ", out_shape.DebugString()));
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, &out));
+
+    if (out->NumElements() == 0) {
+      // If a has shape [0, x] or b has shape [x, 0], the output shape
+      // is a 0-element matrix, so there is nothing to do.
+      return;
+    }
+
+    if (a.NumElements() == 0 || b.NumElements() == 0) {
+      // If a has shape [x, 0] and b has shape [0, y], the
+      // output shape is [x, y] where x and y are non-zero, so we fill
+      // the output with zeros.
+      functor::SetZeroFunctor<CPUDevice, T> f;
+      f(context->eigen_device<CPUDevice>(), out->flat<T>());
+      return;
+    }
+
+    const T* bias_data = bias.template flat<T>().data();
+
+    switch (fused_computation_) {
+      case FusedMatMulComputation::kBiasAdd:
+        ContractWithOutputKernel(context, a, b, dim_pair,
+                                 WithBiasAdd<T>(bias_data), out);
+        break;
+      case FusedMatMulComputation::kBiasAddWithRelu:
+        ContractWithOutputKernel(context, a, b, dim_pair,
+                                 WithBiasAddAndRelu<T>(bias_data), out);
+        break;
+      case FusedMatMulComputation::kBiasAddWithRelu6:
+        ContractWithOutputKernel(context, a, b, dim_pair,
+                                 WithBiasAddAndRelu6<T>(bias_data), out);
+        break;
+      case FusedMatMulComputation::kBiasAddWithElu:
+        ContractWithOutputKernel(context, a, b, dim_pair,
+                                 WithBiasAddAndElu<T>(bias_data), out);
+        break;
+    }
+  }
+
+ private:
+  template <typename OutputKernel>
+  void ContractWithOutputKernel(
+      OpKernelContext* context, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      const OutputKernel& output_kernel, Tensor* out) {
+    auto& d = context->eigen_device<CPUDevice>();
+    out->matrix<T>().device(d) =
+        a.matrix<T>().contract(b.matrix<T>(), dim_pair, output_kernel);
+  }
+
+  bool transpose_a_;
+  bool transpose_b_;
+  FusedMatMulComputation fused_computation_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedMatMulOp);
+};
+
+#define REGISTER_FUSED_CPU_MATMUL(T)                                  \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedMatMulOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_FUSED_CPU_MATMUL);
+TF_CALL_double(REGISTER_FUSED_CPU_MATMUL);
+
+#undef REGISTER_FUSED_CPU_MATMUL
+
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/mfcc.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -76,28 +77,39 @@ class MfccOp : public OpKernel {
     const float* spectrogram_flat = spectrogram.flat<float>().data();
     float* output_flat = output_tensor->flat<float>().data();
 
-    for (int audio_channel = 0; audio_channel < audio_channels;
-         ++audio_channel) {
-      for (int spectrogram_sample = 0; spectrogram_sample < spectrogram_samples;
-           ++spectrogram_sample) {
+    // Each spectrogram frame is independent and Mfcc::Compute is const, so
+    // one instance (whose filterbank and DCT tables were built once above,
+    // amortized over the whole batch) is shared by all shards while the
+    // frames are spread across the intra-op pool.
+    const int64 total_frames =
+        static_cast<int64>(audio_channels) * spectrogram_samples;
+    if (total_frames == 0) {
+      return;
+    }
+    auto compute_frames = [&](int64 start, int64 limit) {
+      std::vector<double> mfcc_input(spectrogram_channels);
+      std::vector<double> mfcc_output;
+      for (int64 idx = start; idx < limit; ++idx) {
         const float* sample_data =
-            spectrogram_flat +
-            (audio_channel * spectrogram_samples * spectrogram_channels) +
-            (spectrogram_sample * spectrogram_channels);
-        std::vector<double> mfcc_input(sample_data,
-                                       sample_data + spectrogram_channels);
-        std::vector<double> mfcc_output;
+            spectrogram_flat + (idx * spectrogram_channels);
+        mfcc_input.assign(sample_data, sample_data + spectrogram_channels);
         mfcc.Compute(mfcc_input, &mfcc_output);
         DCHECK_EQ(dct_coefficient_count_, mfcc_output.size());
-        float* output_data =
-            output_flat +
-            (audio_channel * spectrogram_samples * dct_coefficient_count_) +
-            (spectrogram_sample * dct_coefficient_count_);
+        float* output_data = output_flat + (idx * dct_coefficient_count_);
         for (int i = 0; i < dct_coefficient_count_; ++i) {
           output_data[i] = mfcc_output[i];
         }
       }
-    }
+    };
+    const DeviceBase::CpuWorkerThreads* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    // Rough per-frame cost: the filterbank touches every spectrogram bin
+    // and the DCT is filterbank channels x output coefficients.
+    const int64 cost_per_frame =
+        spectrogram_channels +
+        static_cast<int64>(filterbank_channel_count_) * dct_coefficient_count_;
+    Shard(worker_threads->num_threads, worker_threads->workers, total_frames,
+          cost_per_frame, compute_frames);
   }
 
  private:
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/non_max_suppression_op.h"
 
+#include <algorithm>
 #include <functional>
 #include <queue>
 #include <vector>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -102,61 +104,148 @@ static inline void ParseAndCheckCombinedNMSBoxSizes(OpKernelContext* context,
   OP_REQUIRES(context, boxes.dim_size(3) == 4,
               errors::InvalidArgument("boxes must have 4 columns"));
 }
-// Return intersection-over-union overlap between boxes i and j
+// Number of selected boxes a candidate is tested against per branch-free
+// pass in IouSuppressionChecker::Suppressed().
+constexpr int kIouCheckBlockSize = 16;
+
+// Box count below which sharding the score pre-filter across the intra-op
+// pool is not worthwhile; also used as the per-shard block size.
+constexpr int kParallelScoreFilterThreshold = 4096;
+
+// Checks whether a candidate box overlaps any already-selected box by more
+// than the IOU threshold. Coordinates are canonicalized once up front and
+// the selected boxes are kept in structure-of-arrays form, so a candidate is
+// tested against a whole block of selected boxes with straight-line
+// arithmetic over contiguous arrays that the compiler can vectorize, instead
+// of a branchy scalar check per pair.
 template <typename T>
-static inline bool IOUGreaterThanThreshold(
-    typename TTypes<T, 2>::ConstTensor boxes, int i, int j, T iou_threshold) {
-  const T ymin_i = std::min<T>(boxes(i, 0), boxes(i, 2));
-  const T xmin_i = std::min<T>(boxes(i, 1), boxes(i, 3));
-  const T ymax_i = std::max<T>(boxes(i, 0), boxes(i, 2));
-  const T xmax_i = std::max<T>(boxes(i, 1), boxes(i, 3));
-  const T ymin_j = std::min<T>(boxes(j, 0), boxes(j, 2));
-  const T xmin_j = std::min<T>(boxes(j, 1), boxes(j, 3));
-  const T ymax_j = std::max<T>(boxes(j, 0), boxes(j, 2));
-  const T xmax_j = std::max<T>(boxes(j, 1), boxes(j, 3));
-  const T area_i = (ymax_i - ymin_i) * (xmax_i - xmin_i);
-  const T area_j = (ymax_j - ymin_j) * (xmax_j - xmin_j);
-  if (area_i <= static_cast<T>(0) || area_j <= static_cast<T>(0)) return 0;
-  const T intersection_ymin = std::max<T>(ymin_i, ymin_j);
-  const T intersection_xmin = std::max<T>(xmin_i, xmin_j);
-  const T intersection_ymax = std::min<T>(ymax_i, ymax_j);
-  const T intersection_xmax = std::min<T>(xmax_i, xmax_j);
-  const T intersection_area =
-      std::max<T>(intersection_ymax - intersection_ymin, static_cast<T>(0.0)) *
-      std::max<T>(intersection_xmax - intersection_xmin, static_cast<T>(0.0));
-  const T iou = intersection_area / (area_i + area_j - intersection_area);
-  return iou > iou_threshold;
-}
+class IouSuppressionChecker {
+ public:
+  // Boxes is a [num_boxes, 4] tensor of (y1, x1, y2, x2) corners in either
+  // order.
+  IouSuppressionChecker(const Tensor& boxes, float iou_threshold)
+      : iou_threshold_(iou_threshold) {
+    typename TTypes<T, 2>::ConstTensor data = boxes.tensor<T, 2>();
+    const int num_boxes = data.dimension(0);
+    Reserve(num_boxes);
+    for (int i = 0; i < num_boxes; ++i) {
+      PushBox(static_cast<float>(data(i, 0)), static_cast<float>(data(i, 1)),
+              static_cast<float>(data(i, 2)), static_cast<float>(data(i, 3)));
+    }
+  }
 
-static inline bool OverlapsGreaterThanThreshold(
-    typename TTypes<float, 2>::ConstTensor overlaps, int i, int j,
-    float overlap_threshold) {
-  return overlaps(i, j) > overlap_threshold;
-}
+  // As above, for a flat row-major [num_boxes, 4] array.
+  IouSuppressionChecker(const float* boxes, int num_boxes, float iou_threshold)
+      : iou_threshold_(iou_threshold) {
+    Reserve(num_boxes);
+    for (int i = 0; i < num_boxes; ++i) {
+      PushBox(boxes[i * 4], boxes[i * 4 + 1], boxes[i * 4 + 2],
+              boxes[i * 4 + 3]);
+    }
+  }
 
-template <typename T>
-static inline std::function<bool(int, int)> CreateIOUSuppressCheckFn(
-    const Tensor& boxes, float threshold) {
-  typename TTypes<T, 2>::ConstTensor boxes_data = boxes.tensor<T, 2>();
-  return std::bind(&IOUGreaterThanThreshold<T>, boxes_data,
-                   std::placeholders::_1, std::placeholders::_2,
-                   static_cast<T>(threshold));
-}
+  // Marks box `index` as selected.
+  void Add(int index) {
+    sel_ymin_.push_back(ymin_[index]);
+    sel_xmin_.push_back(xmin_[index]);
+    sel_ymax_.push_back(ymax_[index]);
+    sel_xmax_.push_back(xmax_[index]);
+    sel_area_.push_back(area_[index]);
+  }
 
-static inline std::function<bool(int, int)> CreateOverlapsSuppressCheckFn(
-    const Tensor& overlaps, float threshold) {
-  typename TTypes<float, 2>::ConstTensor overlaps_data =
-      overlaps.tensor<float, 2>();
-  return std::bind(&OverlapsGreaterThanThreshold, overlaps_data,
-                   std::placeholders::_1, std::placeholders::_2, threshold);
-}
+  // Returns true iff box `candidate` overlaps a selected box by more than
+  // the IOU threshold.
+  bool Suppressed(int candidate) const {
+    const float ymin = ymin_[candidate];
+    const float xmin = xmin_[candidate];
+    const float ymax = ymax_[candidate];
+    const float xmax = xmax_[candidate];
+    const float area = area_[candidate];
+    if (area <= 0) return false;
+    // Overlapping boxes are likely to have similar scores, so the selected
+    // boxes are scanned backwards, one block at a time.
+    for (int end = static_cast<int>(sel_area_.size()); end > 0;
+         end -= kIouCheckBlockSize) {
+      const int begin = std::max(0, end - kIouCheckBlockSize);
+      int over_threshold = 0;
+      for (int j = begin; j < end; ++j) {
+        const float intersection_h =
+            std::min(ymax, sel_ymax_[j]) - std::max(ymin, sel_ymin_[j]);
+        const float intersection_w =
+            std::min(xmax, sel_xmax_[j]) - std::max(xmin, sel_xmin_[j]);
+        const float intersection_area = std::max(intersection_h, 0.0f) *
+                                        std::max(intersection_w, 0.0f);
+        const float iou =
+            intersection_area / (area + sel_area_[j] - intersection_area);
+        over_threshold += iou > iou_threshold_ ? 1 : 0;
+      }
+      if (over_threshold > 0) return true;
+    }
+    return false;
+  }
 
-template <typename T>
-void DoNonMaxSuppressionOp(
-    OpKernelContext* context, const Tensor& scores, int num_boxes,
-    const Tensor& max_output_size, const float score_threshold,
-    const std::function<bool(int, int)>& suppress_check_fn,
-    bool pad_to_max_output_size = false, int* ptr_num_valid_outputs = nullptr) {
+ private:
+  void Reserve(int num_boxes) {
+    ymin_.reserve(num_boxes);
+    xmin_.reserve(num_boxes);
+    ymax_.reserve(num_boxes);
+    xmax_.reserve(num_boxes);
+    area_.reserve(num_boxes);
+  }
+
+  void PushBox(float y1, float x1, float y2, float x2) {
+    const float ymin = std::min(y1, y2);
+    const float xmin = std::min(x1, x2);
+    const float ymax = std::max(y1, y2);
+    const float xmax = std::max(x1, x2);
+    ymin_.push_back(ymin);
+    xmin_.push_back(xmin);
+    ymax_.push_back(ymax);
+    xmax_.push_back(xmax);
+    area_.push_back((ymax - ymin) * (xmax - xmin));
+  }
+
+  const float iou_threshold_;
+  // Canonicalized coordinates and area of every box.
+  std::vector<float> ymin_, xmin_, ymax_, xmax_, area_;
+  // Coordinates and area of the selected boxes, in selection order.
+  std::vector<float> sel_ymin_, sel_xmin_, sel_ymax_, sel_xmax_, sel_area_;
+};
+
+// Suppression check against a precomputed pairwise overlap matrix, for
+// NonMaxSuppressionWithOverlaps.
+class OverlapsSuppressionChecker {
+ public:
+  OverlapsSuppressionChecker(const Tensor& overlaps, float overlap_threshold)
+      : overlaps_(overlaps.tensor<float, 2>()),
+        overlap_threshold_(overlap_threshold) {}
+
+  void Add(int index) { selected_.push_back(index); }
+
+  bool Suppressed(int candidate) const {
+    // Overlapping boxes are likely to have similar scores, so the selected
+    // boxes are scanned backwards.
+    for (int j = static_cast<int>(selected_.size()) - 1; j >= 0; --j) {
+      if (overlaps_(candidate, selected_[j]) > overlap_threshold_) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  TTypes<float, 2>::ConstTensor overlaps_;
+  const float overlap_threshold_;
+  std::vector<int> selected_;
+};
+
+template <typename T, typename SuppressionChecker>
+void DoNonMaxSuppressionOp(OpKernelContext* context, const Tensor& scores,
+                           int num_boxes, const Tensor& max_output_size,
+                           const float score_threshold,
+                           SuppressionChecker* suppress_checker,
+                           bool pad_to_max_output_size = false,
+                           int* ptr_num_valid_outputs = nullptr) {
   const int output_size = max_output_size.scalar<int>()();
 
   std::vector<T> scores_data(num_boxes);
@@ -168,16 +257,48 @@ void DoNonMaxSuppressionOp(
     T score;
   };
 
+  // Filter out boxes below the score threshold. For large inputs the filter
+  // is sharded across the intra-op pool; the per-block candidates are merged
+  // back in index order so the result matches the serial scan.
+  std::vector<Candidate> filtered;
+  const DeviceBase::CpuWorkerThreads* worker_threads =
+      context->device()->tensorflow_cpu_worker_threads();
+  if (num_boxes >= kParallelScoreFilterThreshold && worker_threads != nullptr &&
+      worker_threads->num_threads > 1) {
+    const int64 block_size = kParallelScoreFilterThreshold;
+    const int64 num_blocks = (num_boxes + block_size - 1) / block_size;
+    std::vector<std::vector<Candidate>> block_candidates(num_blocks);
+    auto filter_blocks = [&](int64 begin, int64 limit) {
+      for (int64 block = begin; block < limit; ++block) {
+        const int start = block * block_size;
+        const int end = std::min<int>(start + block_size, num_boxes);
+        std::vector<Candidate>* out = &block_candidates[block];
+        for (int i = start; i < end; ++i) {
+          if (static_cast<float>(scores_data[i]) > score_threshold) {
+            out->push_back(Candidate({i, scores_data[i]}));
+          }
+        }
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          block_size, filter_blocks);
+    for (const std::vector<Candidate>& block : block_candidates) {
+      filtered.insert(filtered.end(), block.begin(), block.end());
+    }
+  } else {
+    for (int i = 0; i < num_boxes; ++i) {
+      if (static_cast<float>(scores_data[i]) > score_threshold) {
+        filtered.push_back(Candidate({i, scores_data[i]}));
+      }
+    }
+  }
+
   auto cmp = [](const Candidate bs_i, const Candidate bs_j) {
     return bs_i.score < bs_j.score;
   };
   std::priority_queue<Candidate, std::deque<Candidate>, decltype(cmp)>
-      candidate_priority_queue(cmp);
-  for (int i = 0; i < scores_data.size(); ++i) {
-    if (static_cast<float>(scores_data[i]) > score_threshold) {
-      candidate_priority_queue.emplace(Candidate({i, scores_data[i]}));
-    }
-  }
+      candidate_priority_queue(
+          cmp, std::deque<Candidate>(filtered.begin(), filtered.end()));
 
   std::vector<int> selected;
   std::vector<T> selected_scores;
@@ -187,19 +308,8 @@ void DoNonMaxSuppressionOp(
     next_candidate = candidate_priority_queue.top();
     candidate_priority_queue.pop();
 
-    // Overlapping boxes are likely to have similar scores,
-    // therefore we iterate through the previously selected boxes backwards
-    // in order to see if `next_candidate` should be suppressed.
-    bool should_select = true;
-
-    for (int j = static_cast<int>(selected.size()) - 1; j >= 0; --j) {
-      if (suppress_check_fn(next_candidate.box_index, selected[j])) {
-        should_select = false;
-        break;
-      }
-    }
-
-    if (should_select) {
+    if (!suppress_checker->Suppressed(next_candidate.box_index)) {
+      suppress_checker->Add(next_candidate.box_index);
       selected.push_back(next_candidate.box_index);
       selected_scores.push_back(next_candidate.score);
     }
@@ -223,6 +333,80 @@ void DoNonMaxSuppressionOp(
   std::copy_n(selected.begin(), selected.size(), output_indices_data.data());
 }
 
+// A box selected by per-class NMS, pending the final cross-class merge.
+struct ResultCandidate {
+  int box_index;
+  float score;
+  int class_idx;
+  float box_coord[4];
+};
+
+// Runs single-class NMS over one (batch, class) slice of the inputs and
+// appends the selected boxes to *result_candidates, best score first.
+// boxes_data points at the [num_boxes, q, 4] boxes of one batch and
+// scores_data at its [num_boxes, num_classes] scores.
+void DoNMSPerClass(int class_idx, const float* boxes_data,
+                   const float* scores_data, int num_boxes, int q,
+                   int num_classes, const int size_per_class,
+                   const float score_threshold, const float iou_threshold,
+                   std::vector<ResultCandidate>* result_candidates) {
+  std::vector<float> class_scores_data;
+  class_scores_data.reserve(num_boxes);
+  std::vector<float> class_boxes_data;
+  class_boxes_data.reserve(num_boxes * 4);
+
+  for (int box = 0; box < num_boxes; ++box) {
+    // Get the scores per class
+    // class_scores_data dim is [num_boxes].
+    class_scores_data.push_back(scores_data[box * num_classes + class_idx]);
+    for (int cid = 0; cid < 4; ++cid) {
+      if (q > 1) {
+        // Get the boxes per class. class_boxes_data dims is [num_boxes, 4]
+        class_boxes_data.push_back(boxes_data[(box * q + class_idx) * 4 + cid]);
+      } else {
+        class_boxes_data.push_back(boxes_data[box * 4 + cid]);
+      }
+    }
+  }
+
+  // Do NMS, get the candidate indices of form vector<int>
+  // Data structure for selection candidate in NMS.
+  struct Candidate {
+    int box_index;
+    float score;
+  };
+  auto cmp = [](const Candidate bs_i, const Candidate bs_j) {
+    return bs_i.score > bs_j.score;
+  };
+  std::vector<Candidate> candidate_vector;
+  for (int i = 0; i < num_boxes; ++i) {
+    if (class_scores_data[i] > score_threshold) {
+      candidate_vector.emplace_back(Candidate({i, class_scores_data[i]}));
+    }
+  }
+  std::sort(candidate_vector.begin(), candidate_vector.end(), cmp);
+
+  IouSuppressionChecker<float> suppress_checker(class_boxes_data.data(),
+                                                num_boxes, iou_threshold);
+  int num_selected = 0;
+  for (int candidate_idx = 0;
+       num_selected < size_per_class &&
+       candidate_idx < static_cast<int>(candidate_vector.size());
+       ++candidate_idx) {
+    const Candidate& next_candidate = candidate_vector[candidate_idx];
+    if (suppress_checker.Suppressed(next_candidate.box_index)) continue;
+    suppress_checker.Add(next_candidate.box_index);
+    ++num_selected;
+    // Add the selected box to the result candidates. Sorted by score
+    const float* box = &class_boxes_data[next_candidate.box_index * 4];
+    ResultCandidate rc = {next_candidate.box_index,
+                          next_candidate.score,
+                          class_idx,
+                          {box[0], box[1], box[2], box[3]}};
+    result_candidates->push_back(rc);
+  }
+}
+
 void BatchedNonMaxSuppressionOp(
     OpKernelContext* context, const Tensor& inp_boxes, const Tensor& inp_scores,
     int num_boxes, const int max_size_per_class, const int total_size_per_batch,
@@ -246,107 +430,42 @@ void BatchedNonMaxSuppressionOp(
 
   int per_batch_size = total_size_per_batch;
 
-  // perform non_max_suppression operation for each batch independently
+  const float* boxes_data = inp_boxes.flat<float>().data();
+  const float* scores_data = inp_scores.flat<float>().data();
+  const int size_per_class = std::min(max_size_per_class, num_boxes);
+
+  // Every (batch, class) pair is suppressed independently of the others, so
+  // shard the per-class NMS across the intra-op pool and merge per batch
+  // afterwards.
+  std::vector<std::vector<ResultCandidate>> result_candidates(num_batches *
+                                                              num_classes);
+  auto nms_shard = [&](int64 begin, int64 limit) {
+    for (int64 idx = begin; idx < limit; ++idx) {
+      const int batch = idx / num_classes;
+      const int class_idx = idx % num_classes;
+      DoNMSPerClass(class_idx, boxes_data + batch * num_boxes * q * 4,
+                    scores_data + batch * num_boxes * num_classes, num_boxes, q,
+                    num_classes, size_per_class, score_threshold, iou_threshold,
+                    &result_candidates[idx]);
+    }
+  };
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  // Rough per-pair cost: gathering the class slice plus checking each
+  // candidate against the boxes selected before it.
+  const int64 cost_per_pair = int64{16} * num_boxes;
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        static_cast<int64>(num_batches) * num_classes, cost_per_pair,
+        nms_shard);
+
+  // merge the per-class results for each batch independently
   for (int batch = 0; batch < num_batches; ++batch) {
-    // dims of per_batch_boxes [num_boxes, q, 4]
-    Tensor per_batch_boxes = inp_boxes.Slice(batch, batch + 1);
-    // dims of per_batch_scores [num_boxes, num_classes]
-    Tensor per_batch_scores = inp_scores.Slice(batch, batch + 1);
-
-    struct ResultCandidate {
-      int box_index;
-      float score;
-      int class_idx;
-      float box_coord[4];
-    };
-
     std::vector<ResultCandidate> result_candidate_vec;
-
-    float* scores_data = per_batch_scores.unaligned_flat<float>().data();
-    float* boxes_data = per_batch_boxes.unaligned_flat<float>().data();
-
-    // Iterate through all classes
     for (int class_idx = 0; class_idx < num_classes; ++class_idx) {
-      std::vector<float> class_scores_data;
-      class_scores_data.reserve(num_boxes);
-      std::vector<float> class_boxes_data;
-      class_boxes_data.reserve(num_boxes * 4);
-
-      for (int box = 0; box < num_boxes; ++box) {
-        // Get the scores per class
-        // class_scores_data dim is [num_boxes].
-        class_scores_data.push_back(scores_data[box * num_classes + class_idx]);
-        for (int cid = 0; cid < 4; ++cid) {
-          if (q > 1) {
-            // Get the boxes per class. class_boxes_data dims is [num_boxes, 4]
-            class_boxes_data.push_back(
-                boxes_data[(box * q + class_idx) * 4 + cid]);
-          } else {
-            class_boxes_data.push_back(boxes_data[box * 4 + cid]);
-          }
-        }
-      }
-
-      // Copy class_boxes_data to a tensor
-      TensorShape boxesShape({num_boxes, 4});
-      Tensor boxes(per_batch_boxes.dtype(), boxesShape);
-      std::copy_n(class_boxes_data.begin(), class_boxes_data.size(),
-                  boxes.unaligned_flat<float>().data());
-
-      const int size_per_class = std::min(max_size_per_class, num_boxes);
-      // Do NMS, get the candidate indices of form vector<int>
-      // Data structure for selection candidate in NMS.
-      struct Candidate {
-        int box_index;
-        float score;
-      };
-      auto cmp = [](const Candidate bs_i, const Candidate bs_j) {
-        return bs_i.score > bs_j.score;
-      };
-      std::vector<Candidate> candidate_vector;
-      for (int i = 0; i < class_scores_data.size(); ++i) {
-        if (class_scores_data[i] > score_threshold) {
-          candidate_vector.emplace_back(Candidate({i, class_scores_data[i]}));
-        }
-      }
-
-      std::vector<int> selected;
-      std::vector<float> selected_boxes;
-      Candidate next_candidate;
-
-      std::sort(candidate_vector.begin(), candidate_vector.end(), cmp);
-      const Tensor const_boxes = boxes;
-      typename TTypes<float, 2>::ConstTensor boxes_data =
-          const_boxes.tensor<float, 2>();
-      int candidate_idx = 0;
-      while (selected.size() < size_per_class &&
-             candidate_idx < candidate_vector.size()) {
-        next_candidate = candidate_vector[candidate_idx++];
-
-        // Overlapping boxes are likely to have similar scores,
-        // therefore we iterate through the previously selected boxes backwards
-        // in order to see if `next_candidate` should be suppressed.
-        bool should_select = true;
-        for (int j = selected.size() - 1; j >= 0; --j) {
-          if (IOUGreaterThanThreshold(boxes_data, next_candidate.box_index,
-                                      selected[j], iou_threshold)) {
-            should_select = false;
-            break;
-          }
-        }
-
-        if (should_select) {
-          selected.push_back(next_candidate.box_index);
-          // Add the selected box to the result candidate. Sorted by score
-          int id = next_candidate.box_index;
-          ResultCandidate rc = {next_candidate.box_index,
-                                next_candidate.score,
-                                class_idx,
-                                {boxes_data(id, 0), boxes_data(id, 1),
-                                 boxes_data(id, 2), boxes_data(id, 3)}};
-          result_candidate_vec.push_back(rc);
-        }
-      }
+      const std::vector<ResultCandidate>& rc =
+          result_candidates[batch * num_classes + class_idx];
+      result_candidate_vec.insert(result_candidate_vec.end(), rc.begin(),
+                                  rc.end());
     }
 
     auto rc_cmp = [](const ResultCandidate rc_i, const ResultCandidate rc_j) {
@@ -463,12 +582,11 @@ class NonMaxSuppressionOp : public OpKernel {
     if (!context->status().ok()) {
       return;
     }
-    auto suppress_check_fn =
-        CreateIOUSuppressCheckFn<float>(boxes, iou_threshold_);
+    IouSuppressionChecker<float> suppress_checker(boxes, iou_threshold_);
 
     const float score_threshold_val = std::numeric_limits<float>::lowest();
     DoNonMaxSuppressionOp<float>(context, scores, num_boxes, max_output_size,
-                                 score_threshold_val, suppress_check_fn);
+                                 score_threshold_val, &suppress_checker);
   }
 
  private:
@@ -507,12 +625,11 @@ class NonMaxSuppressionV2Op : public OpKernel {
     if (!context->status().ok()) {
       return;
     }
-    auto suppress_check_fn =
-        CreateIOUSuppressCheckFn<T>(boxes, iou_threshold_val);
+    IouSuppressionChecker<T> suppress_checker(boxes, iou_threshold_val);
 
     const float score_threshold_val = std::numeric_limits<float>::lowest();
     DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
-                             score_threshold_val, suppress_check_fn);
+                             score_threshold_val, &suppress_checker);
   }
 };
 
@@ -556,11 +673,10 @@ class NonMaxSuppressionV3Op : public OpKernel {
       return;
     }
 
-    auto suppress_check_fn =
-        CreateIOUSuppressCheckFn<T>(boxes, iou_threshold_val);
+    IouSuppressionChecker<T> suppress_checker(boxes, iou_threshold_val);
 
     DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
-                             score_threshold_val, suppress_check_fn);
+                             score_threshold_val, &suppress_checker);
   }
 };
 
@@ -607,12 +723,11 @@ class NonMaxSuppressionV4Op : public OpKernel {
       return;
     }
 
-    auto suppress_check_fn =
-        CreateIOUSuppressCheckFn<T>(boxes, iou_threshold_val);
+    IouSuppressionChecker<T> suppress_checker(boxes, iou_threshold_val);
     int num_valid_outputs;
 
     DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
-                             score_threshold_val, suppress_check_fn,
+                             score_threshold_val, &suppress_checker,
                              pad_to_max_output_size_, &num_valid_outputs);
 
     // Allocate scalar output tensor for number of indices computed.
@@ -665,11 +780,11 @@ class NonMaxSuppressionWithOverlapsOp : public OpKernel {
     if (!context->status().ok()) {
       return;
     }
-    auto suppress_check_fn =
-        CreateOverlapsSuppressCheckFn(overlaps, overlap_threshold_val);
+    OverlapsSuppressionChecker suppress_checker(overlaps,
+                                                overlap_threshold_val);
 
     DoNonMaxSuppressionOp<float>(context, scores, num_boxes, max_output_size,
-                                 score_threshold_val, suppress_check_fn);
+                                 score_threshold_val, &suppress_checker);
   }
 };
 
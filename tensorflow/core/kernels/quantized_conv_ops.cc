@@ -16,6 +16,7 @@ limitations under the License.
 // Implements quantized eight-bit versions of the convolution operations.
 
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 #define EIGEN_USE_THREADS
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/util/padding.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -584,6 +586,266 @@ class QuantizedConv2DOp : public OpKernel {
   Padding padding_;
 };
 
+// Implements the fused QuantizedConv2DWithBias and
+// QuantizedConv2DWithBiasAndRelu kernels. The convolution core is shared
+// with QuantizedConv2D above; the bias addition and activation are then
+// applied directly to the 32-bit accumulators, so no intermediate tensor is
+// materialized between the three stages and the quantized graph does not
+// pay separate BiasAdd and Relu dispatches per layer.
+//
+// Unlike the unfused kernel, the filter quantization range may be given
+// per output channel (`min_filter`/`max_filter` of shape [out_depth]). The
+// shared convolution core assumes a single filter zero point, so in the
+// per-channel case the convolution runs with a zero filter offset and the
+// per-channel offset contribution - the patch sum times the channel's zero
+// point - is subtracted during the fused epilogue.
+template <class T1, class T2, class T3,
+          template <class TF1, class TF2, class TF3> class ConvFunctor,
+          bool apply_relu>
+class QuantizedConv2DWithBiasOp : public OpKernel {
+ public:
+  explicit QuantizedConv2DWithBiasOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("strides", &strides_));
+    OP_REQUIRES(context, strides_.size() == 4,
+                errors::InvalidArgument("Sliding window strides field must "
+                                        "specify 4 dimensions"));
+    OP_REQUIRES(context, strides_[1] == strides_[2],
+                errors::InvalidArgument(
+                    "Current implementation only supports equal length "
+                    "strides in the row and column dimensions."));
+    OP_REQUIRES(
+        context, (strides_[0] == 1 && strides_[3] == 1),
+        errors::InvalidArgument("Current implementation does not yet support "
+                                "strides in the batch and depth dimensions."));
+    std::vector<int32> dilations;
+    OP_REQUIRES_OK(context, context->GetAttr("dilations", &dilations));
+    OP_REQUIRES(context, dilations.size() == 4,
+                errors::InvalidArgument("Dilations field must "
+                                        "specify 4 dimensions"));
+    OP_REQUIRES(context,
+                dilations[0] == 1 && dilations[1] == 1 && dilations[2] == 1 &&
+                    dilations[3] == 1,
+                errors::InvalidArgument(
+                    "Current implementation only supports dilated rate as 1."));
+    std::vector<int32> padding_list;
+    OP_REQUIRES_OK(context, context->GetAttr("padding_list", &padding_list));
+    OP_REQUIRES(context, padding_list.empty(),
+                errors::Unimplemented(
+                    "Current implementation does not support explicit "
+                    "padding via `padding_list`."));
+    OP_REQUIRES_OK(context, context->GetAttr("padding", &padding_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& filter = context->input(1);
+    const Tensor& bias = context->input(2);
+    OP_REQUIRES(context, input.dims() == 4,
+                errors::InvalidArgument("input must be 4-dimensional",
+                                        input.shape().DebugString()));
+    OP_REQUIRES(context, filter.dims() == 4,
+                errors::InvalidArgument("filter must be 4-dimensional: ",
+                                        filter.shape().DebugString()));
+
+    const float min_input = context->input(3).flat<float>()(0);
+    const float max_input = context->input(4).flat<float>()(0);
+    const Tensor& min_filter_tensor = context->input(5);
+    const Tensor& max_filter_tensor = context->input(6);
+
+    const int64 in_depth = input.dim_size(3);
+    OP_REQUIRES(context, in_depth == filter.dim_size(2),
+                errors::InvalidArgument(
+                    "input and filter must have the same depth: ", in_depth,
+                    " vs ", filter.dim_size(2)));
+    const int64 out_depth = filter.dim_size(3);
+
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(bias.shape()) &&
+                    bias.dim_size(0) == out_depth,
+                errors::InvalidArgument(
+                    "bias must be a vector of size out_depth (", out_depth,
+                    "), got shape ", bias.shape().DebugString()));
+    const int64 num_filter_ranges = min_filter_tensor.NumElements();
+    OP_REQUIRES(context,
+                max_filter_tensor.NumElements() == num_filter_ranges &&
+                    (num_filter_ranges == 1 || num_filter_ranges == out_depth),
+                errors::InvalidArgument(
+                    "min_filter and max_filter must both be scalars or both "
+                    "vectors of size out_depth (",
+                    out_depth, "), got ", num_filter_ranges, " and ",
+                    max_filter_tensor.NumElements(), " elements"));
+    const bool per_channel = num_filter_ranges > 1;
+    const float* min_filter_data = min_filter_tensor.flat<float>().data();
+    const float* max_filter_data = max_filter_tensor.flat<float>().data();
+
+    const int32 offset_input =
+        FloatToQuantizedUnclamped<T1>(0.0f, min_input, max_input);
+
+    const int64 input_rows = input.dim_size(1);
+    const int64 filter_rows = filter.dim_size(0);
+    const int64 input_cols = input.dim_size(2);
+    const int64 filter_cols = filter.dim_size(1);
+    const int64 batch = input.dim_size(0);
+    const int stride = strides_[1];
+
+    int64 out_rows = 0, out_cols = 0, pad_rows = 0, pad_cols = 0;
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSize(input_rows, filter_rows, stride,
+                                         padding_, &out_rows, &pad_rows));
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSize(input_cols, filter_cols, stride,
+                                         padding_, &out_cols, &pad_cols));
+    TensorShape out_shape({batch, out_rows, out_cols, out_depth});
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, &output));
+    if (out_shape.num_elements() == 0) {
+      return;
+    }
+
+    // In the per-channel case the convolution core runs with a zero filter
+    // offset; the per-channel contribution is folded into the epilogue.
+    const int32 offset_filter =
+        per_channel ? 0
+                    : FloatToQuantizedUnclamped<T2>(0.0f, min_filter_data[0],
+                                                    max_filter_data[0]);
+
+    ConvFunctor<T1, T2, T3> conv_functor;
+    conv_functor(context, input.flat<T1>().data(), batch, input_rows,
+                 input_cols, in_depth, offset_input, filter.flat<T2>().data(),
+                 filter_rows, filter_cols, out_depth, offset_filter, stride,
+                 padding_, output->flat<T3>().data(), out_rows, out_cols,
+                 0 /* shift_output */, 0 /* offset_output */,
+                 1 /* mult_output */);
+    if (!context->status().ok()) {
+      return;
+    }
+
+    // Per-channel quantization parameters of the 32-bit accumulators. The
+    // bias is converted into accumulator units of its channel, so the
+    // addition is a plain integer add.
+    const float input_level =
+        FloatForOneQuantizedLevel<T1>(min_input, max_input);
+    std::vector<int32> bias_int32(out_depth);
+    std::vector<int32> filter_zero(per_channel ? out_depth : 0);
+    Tensor* output_min = nullptr;
+    Tensor* output_max = nullptr;
+    const TensorShape range_shape =
+        per_channel ? TensorShape({out_depth}) : TensorShape({});
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, range_shape, &output_min));
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(2, range_shape, &output_max));
+    const float* bias_data = bias.flat<float>().data();
+    for (int64 c = 0; c < out_depth; ++c) {
+      const int64 range_index = per_channel ? c : 0;
+      const float min_filter = min_filter_data[range_index];
+      const float max_filter = max_filter_data[range_index];
+      const float accumulator_level =
+          input_level * FloatForOneQuantizedLevel<T2>(min_filter, max_filter);
+      bias_int32[c] = static_cast<int32>(
+          std::lround(bias_data[c] / accumulator_level));
+      if (per_channel) {
+        filter_zero[c] = static_cast<int32>(
+            FloatToQuantizedUnclamped<T2>(0.0f, min_filter, max_filter));
+      }
+      if (per_channel || c == 0) {
+        float min_output_value;
+        float max_output_value;
+        QuantizationRangeForMultiplication<T1, T2, T3>(
+            min_input, max_input, min_filter, max_filter, &min_output_value,
+            &max_output_value);
+        output_min->flat<float>()(range_index) = min_output_value;
+        output_max->flat<float>()(range_index) = max_output_value;
+      }
+    }
+
+    // Fused epilogue: walk the accumulators once, applying the per-channel
+    // offset correction, the bias and the activation in place.
+    const int64 patch_count = batch * out_rows * out_cols;
+    int32* accumulators = &(output->flat<T3>().data()->value);
+    const T1* input_data = input.flat<T1>().data();
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64 patch_size = filter_rows * filter_cols * in_depth;
+    const int64 cost_per_patch =
+        out_depth + (per_channel ? patch_size : 0);
+    auto epilogue = [&](int64 patch_begin, int64 patch_end) {
+      for (int64 patch = patch_begin; patch < patch_end; ++patch) {
+        int32 patch_sum = 0;
+        if (per_channel) {
+          patch_sum = PatchSum(input_data, input_rows, input_cols, in_depth,
+                               offset_input, filter_rows, filter_cols, stride,
+                               padding_, out_rows, out_cols, patch);
+        }
+        int32* patch_accumulators = accumulators + patch * out_depth;
+        for (int64 c = 0; c < out_depth; ++c) {
+          int32 value = patch_accumulators[c];
+          if (per_channel) {
+            value -= filter_zero[c] * patch_sum;
+          }
+          value += bias_int32[c];
+          if (apply_relu) {
+            value = std::max(value, 0);
+          }
+          patch_accumulators[c] = value;
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, patch_count,
+          cost_per_patch, epilogue);
+  }
+
+ private:
+  // Returns the sum of `input - offset_input` over the receptive field of
+  // output `patch`. Out-of-bounds (padding) locations contribute zero,
+  // matching the convolution core.
+  static int32 PatchSum(const T1* input_data, int64 input_rows,
+                        int64 input_cols, int64 in_depth, int32 offset_input,
+                        int64 filter_rows, int64 filter_cols, int stride,
+                        Padding padding, int64 out_rows, int64 out_cols,
+                        int64 patch) {
+    // Mirrors the origin computation of the convolution functors above.
+    int64 filter_left_offset;
+    int64 filter_top_offset;
+    if (padding == VALID) {
+      filter_left_offset =
+          ((out_cols - 1) * stride + filter_cols - input_cols + 1) / 2;
+      filter_top_offset =
+          ((out_rows - 1) * stride + filter_rows - input_rows + 1) / 2;
+    } else {
+      filter_left_offset =
+          ((out_cols - 1) * stride + filter_cols - input_cols) / 2;
+      filter_top_offset =
+          ((out_rows - 1) * stride + filter_rows - input_rows) / 2;
+    }
+    const int64 b = patch / (out_rows * out_cols);
+    const int64 out_y = (patch / out_cols) % out_rows;
+    const int64 out_x = patch % out_cols;
+    const int64 in_y_origin = (out_y * stride) - filter_top_offset;
+    const int64 in_x_origin = (out_x * stride) - filter_left_offset;
+    const T1* input_batch =
+        input_data + b * input_rows * input_cols * in_depth;
+    int32 sum = 0;
+    int64 in_bounds_count = 0;
+    for (int64 filter_y = 0; filter_y < filter_rows; ++filter_y) {
+      const int64 in_y = in_y_origin + filter_y;
+      if (in_y < 0 || in_y >= input_rows) continue;
+      const int64 x_begin = std::max<int64>(0, in_x_origin);
+      const int64 x_end = std::min<int64>(input_cols, in_x_origin + filter_cols);
+      const T1* row = input_batch + (in_y * input_cols + x_begin) * in_depth;
+      const int64 count = (x_end - x_begin) * in_depth;
+      for (int64 i = 0; i < count; ++i) {
+        sum += static_cast<int32>(row[i]);
+      }
+      in_bounds_count += count;
+    }
+    return sum - static_cast<int32>(in_bounds_count) * offset_input;
+  }
+
+  std::vector<int32> strides_;
+  Padding padding_;
+};
+
 // Right now we only support taking two eight bit inputs, and returning the
 // results as signed 32-bit integers.
 REGISTER_KERNEL_BUILDER(
@@ -594,4 +856,25 @@ REGISTER_KERNEL_BUILDER(
         .TypeConstraint<qint32>("out_type"),
     QuantizedConv2DOp<quint8, quint8, qint32, Im2ColConvFunctor>);
 
+// The MKL graph rewrite registers placeholder kernels for these ops with
+// qint8 filters; the quint8-filter variants below are real implementations
+// that follow the same type convention as QuantizedConv2D.
+REGISTER_KERNEL_BUILDER(
+    Name("QuantizedConv2DWithBias")
+        .Device(DEVICE_CPU)
+        .TypeConstraint<quint8>("Tinput")
+        .TypeConstraint<quint8>("Tfilter")
+        .TypeConstraint<qint32>("out_type"),
+    QuantizedConv2DWithBiasOp<quint8, quint8, qint32, Im2ColConvFunctor,
+                              false /* apply_relu */>);
+
+REGISTER_KERNEL_BUILDER(
+    Name("QuantizedConv2DWithBiasAndRelu")
+        .Device(DEVICE_CPU)
+        .TypeConstraint<quint8>("Tinput")
+        .TypeConstraint<quint8>("Tfilter")
+        .TypeConstraint<qint32>("out_type"),
+    QuantizedConv2DWithBiasOp<quint8, quint8, qint32, Im2ColConvFunctor,
+                              true /* apply_relu */>);
+
 }  // namespace tensorflow
@@ -322,4 +322,162 @@ TEST_F(QuantizedConv2DTest, SmallWithNoZero) {
   test::ExpectTensorNear<float>(expected_float, output_float, 1.0);
 }
 
+TEST_F(QuantizedConv2DTest, SmallWithBiasAndRelu) {
+  const int stride = 1;
+  TF_ASSERT_OK(
+      NodeDefBuilder("quantized_conv_op", "QuantizedConv2DWithBiasAndRelu")
+          .Input(FakeInput(DT_QUINT8))
+          .Input(FakeInput(DT_QUINT8))
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_FLOAT))
+          .Attr("out_type", DataTypeToEnum<qint32>::v())
+          .Attr("strides", {1, stride, stride, 1})
+          .Attr("padding", "SAME")
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  // The same image and filter as in the Small test above, so without the bias
+  // the convolution results would be:
+  // |  105  |  150  |  183  |   95  |
+  // |  235  |  312  |  357  |  178  |
+  // |  187  |  234  |  261  |  121  |
+  const int depth = 1;
+  const int image_width = 4;
+  const int image_height = 3;
+  const int image_batch_count = 1;
+  const float image_min = 0.0f;
+  const float image_max = 12.0f;
+  Tensor image_float(DT_FLOAT,
+                     {image_batch_count, image_height, image_width, depth});
+  test::FillValues<float>(&image_float,
+                          {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+  Tensor image_quantized =
+      FloatTensorToQuantized<quint8>(image_float, image_min, image_max);
+
+  const int filter_size = 3;
+  const int filter_count = 1;
+  const float filter_min = 1.0f;
+  const float filter_max = 9.0f;
+  Tensor filter_float(DT_FLOAT,
+                      {filter_size, filter_size, depth, filter_count});
+  test::FillValues<float>(&filter_float, {1, 4, 7, 2, 5, 8, 3, 6, 9});
+  Tensor filter_quantized =
+      FloatTensorToQuantized<quint8>(filter_float, filter_min, filter_max);
+
+  AddInputFromArray<quint8>(image_quantized.shape(),
+                            image_quantized.flat<quint8>());
+  AddInputFromArray<quint8>(filter_quantized.shape(),
+                            filter_quantized.flat<quint8>());
+  // A bias large enough to push several results below zero, so that the
+  // fused relu has something to clamp.
+  AddInputFromArray<float>(TensorShape({filter_count}), {-200.0f});
+  AddInputFromArray<float>(TensorShape({1}), {image_min});
+  AddInputFromArray<float>(TensorShape({1}), {image_max});
+  AddInputFromArray<float>(TensorShape({1}), {filter_min});
+  AddInputFromArray<float>(TensorShape({1}), {filter_max});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Expected results are max(conv_result - 200, 0).
+  const int expected_width = image_width;
+  const int expected_height = image_height * filter_count;
+  Tensor expected_float(
+      DT_FLOAT, TensorShape({image_batch_count, expected_height, expected_width,
+                             filter_count}));
+  test::FillValues<float>(&expected_float,
+                          {0, 0, 0, 0, 35, 112, 157, 0, 0, 34, 61, 0});
+  const Tensor& output_quantized = *GetOutput(0);
+  const float output_min = GetOutput(1)->flat<float>()(0);
+  const float output_max = GetOutput(2)->flat<float>()(0);
+  Tensor output_float =
+      QuantizedTensorToFloat<qint32>(output_quantized, output_min, output_max);
+  test::ExpectTensorNear<float>(expected_float, output_float, 1.0);
+}
+
+TEST_F(QuantizedConv2DTest, SmallWithBiasPerChannel) {
+  const int stride = 1;
+  TF_ASSERT_OK(NodeDefBuilder("quantized_conv_op", "QuantizedConv2DWithBias")
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("out_type", DataTypeToEnum<qint32>::v())
+                   .Attr("strides", {1, stride, stride, 1})
+                   .Attr("padding", "SAME")
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  const int depth = 1;
+  const int image_width = 4;
+  const int image_height = 3;
+  const int image_batch_count = 1;
+  const float image_min = 0.0f;
+  const float image_max = 12.0f;
+  Tensor image_float(DT_FLOAT,
+                     {image_batch_count, image_height, image_width, depth});
+  test::FillValues<float>(&image_float,
+                          {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+  Tensor image_quantized =
+      FloatTensorToQuantized<quint8>(image_float, image_min, image_max);
+
+  // Two output channels holding the same float filter values, but quantized
+  // with different ranges. The first channel's range doesn't include zero, so
+  // its zero point is non-trivial and exercises the per-channel offset
+  // correction.
+  const int filter_size = 3;
+  const int filter_count = 2;
+  const std::vector<float> filter_values = {1, 4, 7, 2, 5, 8, 3, 6, 9};
+  const std::vector<float> filter_mins = {1.0f, 0.0f};
+  const std::vector<float> filter_maxs = {9.0f, 9.0f};
+  Tensor filter_quantized(
+      DT_QUINT8, TensorShape({filter_size, filter_size, depth, filter_count}));
+  auto filter_quantized_flat = filter_quantized.flat<quint8>();
+  for (int i = 0; i < filter_values.size(); ++i) {
+    for (int channel = 0; channel < filter_count; ++channel) {
+      filter_quantized_flat(i * filter_count + channel) =
+          FloatToQuantized<quint8>(filter_values[i], filter_mins[channel],
+                                   filter_maxs[channel]);
+    }
+  }
+
+  AddInputFromArray<quint8>(image_quantized.shape(),
+                            image_quantized.flat<quint8>());
+  AddInputFromArray<quint8>(filter_quantized.shape(),
+                            filter_quantized.flat<quint8>());
+  AddInputFromArray<float>(TensorShape({filter_count}), {10.0f, -20.0f});
+  AddInputFromArray<float>(TensorShape({1}), {image_min});
+  AddInputFromArray<float>(TensorShape({1}), {image_max});
+  AddInputFromArray<float>(TensorShape({filter_count}),
+                           {filter_mins[0], filter_mins[1]});
+  AddInputFromArray<float>(TensorShape({filter_count}),
+                           {filter_maxs[0], filter_maxs[1]});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Both channels should see the same convolution results as the Small test
+  // above, shifted by the channel's bias.
+  const std::vector<float> conv_results = {105, 150, 183, 95,  235, 312,
+                                           357, 178, 187, 234, 261, 121};
+  const std::vector<float> biases = {10.0f, -20.0f};
+  const Tensor& output_quantized = *GetOutput(0);
+  const Tensor& output_min = *GetOutput(1);
+  const Tensor& output_max = *GetOutput(2);
+  ASSERT_EQ(filter_count, output_min.NumElements());
+  ASSERT_EQ(filter_count, output_max.NumElements());
+  auto output_flat = output_quantized.flat<qint32>();
+  for (int i = 0; i < conv_results.size(); ++i) {
+    for (int channel = 0; channel < filter_count; ++channel) {
+      const float output_value = QuantizedToFloat<qint32>(
+          output_flat(i * filter_count + channel),
+          output_min.flat<float>()(channel), output_max.flat<float>()(channel));
+      EXPECT_NEAR(conv_results[i] + biases[channel], output_value, 1.0)
+          << "i = " << i << ", channel = " << channel;
+    }
+  }
+}
+
 }  // namespace tensorflow
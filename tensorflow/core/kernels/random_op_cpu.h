@@ -86,12 +86,40 @@ struct FillPhiloxRandomTask<Distribution, false> {
                   int64 start_group, int64 limit_group, Distribution dist) {
     const int kGroupSize = Distribution::kResultElementCount;
 
+    // Each output group consumes exactly one 128-bit Philox sample, and
+    // successive samples of a generator form a serial dependency chain
+    // through its counter. Interleaving a few generators with staggered
+    // counters breaks that chain, so a superscalar core can keep several
+    // Philox pipelines in flight at once (and the compiler may vectorize
+    // across them). This is only a reassignment of group indices to
+    // streams: the bits written at every output position are identical to
+    // those of the single-stream code.
+    static const int kStreamCount = 4;
+
     gen.Skip(start_group);
     int64 offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64 limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64 index = start_group; index < limit_group_full; ++index) {
+    int64 index = start_group;
+    if (limit_group_full - index >= kStreamCount) {
+      PhiloxRandom streams[kStreamCount];
+      for (int i = 0; i < kStreamCount; ++i) {
+        streams[i] = gen;
+        streams[i].Skip(i);
+      }
+      for (; index + kStreamCount <= limit_group_full; index += kStreamCount) {
+        for (int i = 0; i < kStreamCount; ++i) {
+          auto samples = dist(&streams[i]);
+          std::copy(&samples[0], &samples[0] + kGroupSize,
+                    data + offset + i * kGroupSize);
+          streams[i].Skip(kStreamCount - 1);
+        }
+        offset += kStreamCount * kGroupSize;
+      }
+      gen.Skip(index - start_group);
+    }
+    for (; index < limit_group_full; ++index) {
       auto samples = dist(&gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
@@ -14,11 +14,14 @@ limitations under the License.
 ==============================================================================*/
 
 #include <random>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/math/math_util.h"
+#include "tensorflow/core/kernels/random_op_cpu.h"
 #include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -93,6 +96,32 @@ void BM_cpu_RandomGamma(int iters, int nsamp, int nalpha) {
 }
 BENCHMARK(BM_cpu_RandomGamma)->RangePair(1 << 14, 4 << 15, 2, 50);
 
+TEST(FillPhiloxRandomTest, PartitionedFillMatchesSingleShard) {
+  using random::PhiloxRandom;
+  typedef random::UniformDistribution<PhiloxRandom, float> Distribution;
+  Distribution dist;
+  const int kGroupSize = Distribution::kResultElementCount;
+  const int64 size = kGroupSize * 1037 + 3;  // Exercise the partial tail group.
+  const int64 total_groups = (size + kGroupSize - 1) / kGroupSize;
+  PhiloxRandom gen(0x12345);
+
+  std::vector<float> expected(size);
+  functor::FillPhiloxRandomTask<Distribution, false>::Run(
+      gen, expected.data(), size, 0, total_groups, dist);
+
+  // Every partitioning must produce the same bits at every position,
+  // regardless of whether a shard's range hits the interleaved main loop,
+  // its scalar tail, or the final partial group.
+  for (int64 split : {int64{1}, int64{5}, int64{64}, total_groups - 1}) {
+    std::vector<float> actual(size, 0.f);
+    functor::FillPhiloxRandomTask<Distribution, false>::Run(
+        gen, actual.data(), size, 0, split, dist);
+    functor::FillPhiloxRandomTask<Distribution, false>::Run(
+        gen, actual.data(), size, split, total_groups, dist);
+    EXPECT_EQ(expected, actual) << "split at group " << split;
+  }
+}
+
 void BM_PhiloxRandom(int iters) {
   // Fill 2M random numbers
   int count = 2 << 20;
@@ -23,6 +23,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -266,9 +269,138 @@ struct ReduceFunctorBase {
   }
 };
 
+// Inputs below this size stay on the single Eigen reduction expression;
+// for them the cost of scheduling shards outweighs any extra parallelism.
+static const int64 kMinShardedReduceElements = 1 << 14;
+
+// True for reducers whose per-block partial results can be combined by
+// reducing the partials again with the same reducer.  The MeanReducer and
+// EuclideanNormReducer specializations of ReduceEigenImpl post-process the
+// reduced value (rescaling, sqrt), so their partials do not compose.
+template <typename Reducer>
+struct ReducerPartialsCompose : std::true_type {};
+template <typename Scalar>
+struct ReducerPartialsCompose<MeanReducer<Scalar>> : std::false_type {};
+template <typename Scalar>
+struct ReducerPartialsCompose<EuclideanNormReducer<Scalar>> : std::false_type {
+};
+
+// Shape-specialized CPU reduction paths that shard the work across the
+// intra-op pool.  Each shard is still evaluated with an Eigen reduction
+// expression, so the per-row inner loops keep Eigen's vectorization.  Run()
+// returns false when a case does not apply (wrong axis, too small, or pool
+// unavailable); the caller then falls back on the single Eigen expression.
+// The primary template declines every shape it has no specialization for.
+template <typename Reducer, int IN_RANK, int OUT_RANK>
+struct ShardedReduceImpl {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool Run(OpKernelContext* ctx, OUT_T out, IN_T in,
+                  const ReductionAxes& reduction_axes, const Reducer& reducer) {
+    return false;
+  }
+};
+
+// Reduction of a matrix along the inner (2nd) dimension: shards the rows,
+// with each worker reducing a contiguous block of rows into the matching
+// block of outputs.  Per-row semantics are unchanged, so this is safe for
+// every reducer, including MeanReducer and EuclideanNormReducer.
+template <typename Reducer>
+struct ShardedReduceImpl<Reducer, 2, 1> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool Run(OpKernelContext* ctx, OUT_T out, IN_T in,
+                  const ReductionAxes& reduction_axes, const Reducer& reducer) {
+    typedef typename OUT_T::Scalar T;
+    typedef typename TTypes<T>::Tensor::Index Index;
+    if (reduction_axes[0] != 1) return false;  // Column reduction.
+    const Index num_rows = in.dimension(0);
+    const Index num_cols = in.dimension(1);
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    if (worker_threads.num_threads <= 1 || num_rows < 2 ||
+        num_rows * num_cols < kMinShardedReduceElements) {
+      return false;
+    }
+    const T* in_data = in.data();
+    T* out_data = out.data();
+    auto work = [&](int64 begin, int64 end) {
+      typename TTypes<T, 2>::UnalignedConstTensor in_block(
+          in_data + begin * num_cols, end - begin, num_cols);
+      typename TTypes<T, 1>::UnalignedTensor out_block(out_data + begin,
+                                                       end - begin);
+      Eigen::DefaultDevice d;
+      ReduceEigenImpl<Eigen::DefaultDevice, decltype(out_block),
+                      decltype(in_block), ReductionAxes, Reducer>()(
+          d, out_block, in_block, reduction_axes, reducer);
+    };
+    // Each row loads num_cols elements and stores one; the per-element
+    // arithmetic of the supported reducers is on the order of a cycle.
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          num_cols, work);
+    return true;
+  }
+};
+
+// Full reduction to a scalar: two-pass tree reduction.  The first pass
+// reduces equal-sized blocks of the input into one partial per block in
+// parallel; the second pass reduces the (tiny) vector of partials.  Only
+// valid for reducers whose partials compose (see ReducerPartialsCompose).
+template <typename Reducer>
+struct ShardedReduceImpl<Reducer, 1, 0> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool Run(OpKernelContext* ctx, OUT_T out, IN_T in,
+                  const ReductionAxes& reduction_axes, const Reducer& reducer) {
+    typedef typename OUT_T::Scalar T;
+    typedef typename TTypes<T>::Tensor::Index Index;
+    if (!ReducerPartialsCompose<Reducer>::value) return false;
+    const Index num_elems = in.size();
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    const int64 num_blocks =
+        std::min<int64>(worker_threads.num_threads,
+                        num_elems / kMinShardedReduceElements);
+    if (num_blocks < 2) return false;
+    const Index block_size = num_elems / num_blocks;
+    Eigen::Tensor<T, 1, Eigen::RowMajor, Index> partials(num_blocks);
+    const T* in_data = in.data();
+    auto work = [&](int64 begin, int64 end) {
+      for (int64 b = begin; b < end; ++b) {
+        const Index start = b * block_size;
+        const Index limit =
+            (b == num_blocks - 1) ? num_elems : start + block_size;
+        typename TTypes<T, 1>::UnalignedConstTensor in_block(in_data + start,
+                                                             limit - start);
+        typename TTypes<T, 0>::UnalignedTensor partial(partials.data() + b);
+        Eigen::DefaultDevice d;
+        ReduceEigenImpl<Eigen::DefaultDevice, decltype(partial),
+                        decltype(in_block), ReductionAxes, Reducer>()(
+            d, partial, in_block, reduction_axes, reducer);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          block_size, work);
+    typename TTypes<T, 1>::UnalignedConstTensor partials_map(partials.data(),
+                                                             num_blocks);
+    Eigen::DefaultDevice d;
+    ReduceEigenImpl<Eigen::DefaultDevice, OUT_T, decltype(partials_map),
+                    ReductionAxes, Reducer>()(d, out, partials_map,
+                                              reduction_axes, reducer);
+    return true;
+  }
+};
+
 template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
-    : ReduceFunctorBase<CPUDevice, Reducer> {};
+    : ReduceFunctorBase<CPUDevice, Reducer> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(OpKernelContext* ctx, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Reducer& reducer) {
+    if (ShardedReduceImpl<Reducer, IN_T::NumIndices, OUT_T::NumIndices>::Run(
+            ctx, out, in, reduction_axes, reducer)) {
+      return;
+    }
+    ReduceFunctorBase<CPUDevice, Reducer>::Reduce(ctx, out, in, reduction_axes,
+                                                  reducer);
+  }
+};
 #if TENSORFLOW_USE_SYCL
 template <typename Reducer>
 struct ReduceFunctor<SYCLDevice, Reducer>
@@ -21,6 +21,7 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <atomic>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -86,6 +87,10 @@ class UpdateExecutor<Input, Update, Output, scatter_nd_op::UpdateOp::SUB> {
 
 namespace functor {
 
+// Below this many update elements the scatter runs single-threaded; the
+// partitioned version pays one extra pass over the indices.
+static const Eigen::DenseIndex kMinUpdateElementsForParallelScatter = 1 << 14;
+
 // Implementation of update functor for CPU.
 template <typename T, typename Index, scatter_nd_op::UpdateOp OP, int IXDIM>
 struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
@@ -112,6 +117,14 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       }
     }
 
+    const Eigen::DenseIndex num_output_rows = Toutput.dimension(0);
+    if (d.numThreads() > 1 && num_output_rows > 1 &&
+        batch_size * slice_size >= kMinUpdateElementsForParallelScatter) {
+      return ExecutePartitioned(d, batch_size, num_output_rows, batch_strides,
+                                output_shape_prefix, Tindices, Tupdates,
+                                Toutput);
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -135,6 +148,78 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
 
     return error_loc;
   }
+
+ private:
+  // Parallel scatter partitioned on the target row, so colliding updates are
+  // applied by the same worker and, within a row, in index order: the result
+  // is bit-identical to the sequential loop.  Every index is validated and
+  // flattened up front; on an out-of-bounds index the first offending
+  // location is returned and nothing is applied (the sequential path applies
+  // the updates preceding it, but the op fails either way).
+  Index ExecutePartitioned(
+      const CPUDevice& d, const Eigen::DenseIndex batch_size,
+      const Eigen::DenseIndex num_output_rows, const Index* batch_strides,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    std::vector<Index> target_rows(batch_size);
+    std::atomic<Eigen::DenseIndex> first_error_loc(batch_size);
+    d.parallelFor(
+        batch_size, Eigen::TensorOpCost(sizeof(Index) * IXDIM, sizeof(Index),
+                                        2 * IXDIM),
+        [&](Eigen::DenseIndex start, Eigen::DenseIndex end) {
+          for (Eigen::DenseIndex loc = start; loc < end; ++loc) {
+            Index i = 0;
+            bool out_of_bounds = false;
+            for (int dim = 0; dim < IXDIM; ++dim) {
+              const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+              out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+              i += ix_d * batch_strides[dim];
+            }
+            if (TF_PREDICT_FALSE(out_of_bounds)) {
+              Eigen::DenseIndex expected = first_error_loc.load();
+              while (loc < expected &&
+                     !first_error_loc.compare_exchange_weak(expected, loc)) {
+              }
+            }
+            target_rows[loc] = i;
+          }
+        });
+    if (first_error_loc.load() < batch_size) {
+      return static_cast<Index>(first_error_loc.load());
+    }
+
+    const Eigen::DenseIndex num_partitions =
+        Eigen::numext::mini<Eigen::DenseIndex>(d.numThreads(),
+                                               num_output_rows);
+    const Eigen::DenseIndex rows_per_partition =
+        (num_output_rows + num_partitions - 1) / num_partitions;
+    const double cost_per_partition =
+        static_cast<double>(batch_size) * Tupdates.dimension(1) * sizeof(T) /
+        num_partitions;
+    d.parallelFor(
+        num_partitions,
+        Eigen::TensorOpCost(cost_per_partition, cost_per_partition,
+                            cost_per_partition),
+        [&](Eigen::DenseIndex pstart, Eigen::DenseIndex pend) {
+          const Eigen::DenseIndex row_begin = pstart * rows_per_partition;
+          const Eigen::DenseIndex row_end = Eigen::numext::mini(
+              pend * rows_per_partition, num_output_rows);
+          for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+            const Index row = target_rows[loc];
+            if (row < row_begin || row >= row_end) continue;
+            // No .device(d) here: each worker applies its own rows inline.
+            auto input_chip = Toutput.template chip<0>(row);
+            auto update_chip = Tupdates.template chip<0>(loc);
+            update_executor::UpdateExecutor<
+                decltype(input_chip), decltype(update_chip),
+                decltype(input_chip)&, OP>::Execute(input_chip, update_chip,
+                                                    input_chip);
+          }
+        });
+    return -1;
+  }
 };
 
 #define REGISTER_SCATTER_ND_FULL(T, Index, op)                               \
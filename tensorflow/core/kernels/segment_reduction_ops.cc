@@ -35,7 +35,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -693,65 +695,86 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    OutputRow uninitialized_index = 0;
-    OutputRow out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      OutputRow next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
-
+    // First locate the segment boundaries and validate the segment ids, so
+    // that the per-segment reductions below can run in parallel without any
+    // coordination. The scan is cheap compared to the reductions, which each
+    // touch num_col values per input row.
+    std::vector<int64> segment_starts;
+    OutputRow prev_id = -1;
+    for (int64 i = 0; i < num_indices; ++i) {
+      const OutputRow id = internal::SubtleMustCopy(segment_vec(i));
+      if (id == prev_id) continue;
       OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
+          context, FastBoundsCheck(id, output_rows),
           errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
+              "Segment id ", id, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
-
-      auto out = output_flat.template chip<0>(out_index);
-      const int bad_offset =
-          Reduce(input_flat, indices_vec, start, end - start, out);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
+      // We have a new segment here.  Verify that the segment ids are growing.
+      OP_REQUIRES(context, id > prev_id,
+                  errors::InvalidArgument("segment ids are not increasing"));
+      segment_starts.push_back(i);
+      prev_id = id;
     }
+    const int64 num_segments_present = segment_starts.size();
+    segment_starts.push_back(num_indices);
+
+    // Each worker reduces a contiguous range of segments into their output
+    // rows, and fills any gap of missing segment ids immediately before each
+    // of its segments with the default value, so the ranges written by
+    // different workers are disjoint. Invalid indices are recorded and
+    // reported after the parallel phase; we keep the smallest offending
+    // position so the error message matches the sequential implementation.
+    mutex mu;
+    int64 bad_pos = -1;
+    auto work = [&](int64 seg_begin, int64 seg_end) {
+      for (int64 s = seg_begin; s < seg_end; ++s) {
+        const int64 start = segment_starts[s];
+        const int64 end = segment_starts[s + 1];
+        const OutputRow out_index =
+            internal::SubtleMustCopy(segment_vec(start));
+        const OutputRow gap_begin =
+            (s == 0) ? 0
+                     : internal::SubtleMustCopy(
+                           segment_vec(segment_starts[s - 1])) +
+                           1;
+        if (out_index > gap_begin) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - gap_begin, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(gap_begin, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+        auto out = output_flat.template chip<0>(out_index);
+        const int64 bad_offset =
+            Reduce(input_flat, indices_vec, start, end - start, out);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          if (bad_pos < 0 || start + bad_offset < bad_pos) {
+            bad_pos = start + bad_offset;
+          }
+          return;
+        }
+      }
+    };
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 avg_reduce_cost = std::max<int64>(
+        1, (num_indices / num_segments_present) * num_col * sizeof(T));
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_segments_present, avg_reduce_cost, work);
+    OP_REQUIRES(
+        context, bad_pos < 0,
+        errors::InvalidArgument("Bad: indices[", bad_pos,
+                                "] == ", indices_vec(bad_pos),
+                                " out of range [0, ", input_flat.dimension(0),
+                                ")"));
 
     // Fill the gap at the end with the default value.
-    if (uninitialized_index < output_rows) {
+    if (last_segment_id_plus_one < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-          output_rows - uninitialized_index, num_col);
+          output_rows - last_segment_id_plus_one, num_col);
       Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-          gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice(&output_flat(last_segment_id_plus_one, 0), gap_slice_shape);
       gap_slice.setConstant(default_value_);
     }
   }
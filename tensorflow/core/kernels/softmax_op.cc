@@ -43,8 +43,17 @@ struct SoftmaxFunctorBase {
     SoftmaxEigenImpl<Device, T>::Compute(d, logits, softmax, log);
   }
 };
+// The CPU specialization uses the blocked row-wise implementation rather
+// than the tensor-wide reduce-and-broadcast expressions; see the NOTE in
+// SoftmaxEigenImpl about the BM_ImageNetSoftmaxFwd benchmark before
+// changing it.
 template <typename T>
-struct SoftmaxFunctor<CPUDevice, T> : SoftmaxFunctorBase<CPUDevice, T> {};
+struct SoftmaxFunctor<CPUDevice, T> {
+  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
+                  typename TTypes<T>::Matrix softmax, const bool log) {
+    SoftmaxRowBlockedImpl<CPUDevice, T>::Compute(d, logits, softmax, log);
+  }
+};
 
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T>
@@ -94,6 +94,69 @@ struct SoftmaxEigenImpl {
   }
 };
 
+// Blocked row-at-a-time implementation used by the CPU specialization of
+// SoftmaxFunctor.  Each row is processed while it is still resident in
+// cache, so the max/exp/sum/normalize steps read the data from L1/L2
+// instead of streaming the whole tensor through memory once per step the
+// way the reduce-and-broadcast expressions above do.  Rows are sharded
+// across the device's thread pool.  An additive mask (e.g. the large
+// negative padding mask of attention layers) can be folded into the same
+// traversal.
+//
+// Device must be an Eigen::ThreadPoolDevice; the template exists only so
+// this header stays compilable without EIGEN_USE_THREADS.
+template <typename Device, typename T>
+struct SoftmaxRowBlockedImpl {
+  // logits and softmax are both [batch_size, num_classes].  mask, when
+  // non-null, points to row-major [mask_rows, num_classes] additive mask
+  // values; mask_rows must be 1 (one mask shared by every row) or
+  // batch_size (a mask per row).
+  static void Compute(const Device& d, typename TTypes<T>::ConstMatrix logits,
+                      typename TTypes<T>::Matrix softmax, const bool log,
+                      const T* mask = nullptr,
+                      Eigen::DenseIndex mask_rows = 0) {
+    const Eigen::DenseIndex batch_size = logits.dimension(0);
+    const Eigen::DenseIndex num_classes = logits.dimension(1);
+
+    typedef Eigen::Array<T, Eigen::Dynamic, 1> ArrayType;
+    typedef Eigen::Map<const ArrayType, Eigen::Unaligned> ConstArrayMap;
+    typedef Eigen::Map<ArrayType, Eigen::Unaligned> ArrayMap;
+
+    const double compute_cycles =
+        static_cast<double>(num_classes) *
+        (Eigen::internal::functor_traits<
+             Eigen::internal::scalar_exp_op<T>>::Cost +
+         6);
+    const Eigen::TensorOpCost cost_per_row(2 * num_classes * sizeof(T),
+                                           num_classes * sizeof(T),
+                                           compute_cycles);
+    d.parallelFor(
+        batch_size, cost_per_row,
+        [&](Eigen::DenseIndex begin, Eigen::DenseIndex end) {
+          for (Eigen::DenseIndex row = begin; row < end; ++row) {
+            ConstArrayMap in(logits.data() + row * num_classes, num_classes);
+            ArrayMap out(softmax.data() + row * num_classes, num_classes);
+            if (mask != nullptr) {
+              ConstArrayMap mask_row(
+                  mask + (mask_rows == 1 ? 0 : row) * num_classes,
+                  num_classes);
+              out = in + mask_row;
+            } else {
+              out = in;
+            }
+            const T row_max = out.maxCoeff();
+            out -= row_max;
+            if (log) {
+              out -= Eigen::numext::log(out.exp().sum());
+            } else {
+              out = out.exp();
+              out *= T(1) / out.sum();
+            }
+          }
+        });
+  }
+};
+
 }  // namespace functor
 }  // namespace tensorflow
 
@@ -35,6 +35,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <atomic>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -44,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/cwise_ops.h"
 #include "tensorflow/core/kernels/cwise_ops_common.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 using Eigen::TensorRef;
 using tensorflow::gtl::ArraySlice;
@@ -116,30 +119,39 @@ class SparseDenseBinaryOpShared : public OpKernel {
     //
     // We can directly use the sparse indices to look up dense side, because
     // "b.y_reshape()" and "b.y_bcast()" are guaranteed to have rank "ndims".
+    // The gathered entries are independent of each other, so the gather
+    // is sharded across the worker threads.  Out-of-bounds indices only
+    // set a flag (and skip the read); the error is raised once below.
     auto dense_gathered_flat = dense_gathered.flat<T>();
     const int ndims = lhs_dims.size();
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    const int64 kCostPerUnit = 20 * ndims;
+    std::atomic<bool> indices_valid(true);
     switch (ndims) {
-#define CASE(NDIM)                                                             \
-  case NDIM: {                                                                 \
-    TensorRef<Eigen::Tensor<const T, NDIM, Eigen::RowMajor>> rhs_ref =         \
-        dense_t->shaped<T, NDIM>(b.y_reshape())                                \
-            .broadcast(BCast::ToIndexArray<NDIM>(b.y_bcast()));                \
-    Eigen::array<Eigen::DenseIndex, NDIM> idx;                                 \
-    bool indices_valid = true;                                                 \
-    for (int i = 0; i < nnz; ++i) {                                            \
-      for (int d = 0; d < NDIM; ++d) {                                         \
-        idx[d] = internal::SubtleMustCopy(indices_mat(i, d));                  \
-        if (!FastBoundsCheck(idx[d], rhs_ref.dimension(d))) {                  \
-          indices_valid = false;                                               \
-        }                                                                      \
-      }                                                                        \
-      OP_REQUIRES(                                                             \
-          ctx, indices_valid,                                                  \
-          errors::InvalidArgument("Provided indices are out-of-bounds w.r.t. " \
-                                  "dense side with broadcasted shape"));       \
-      dense_gathered_flat(i) = rhs_ref.coeff(idx);                             \
-    }                                                                          \
-    break;                                                                     \
+#define CASE(NDIM)                                                         \
+  case NDIM: {                                                             \
+    TensorRef<Eigen::Tensor<const T, NDIM, Eigen::RowMajor>> rhs_ref =     \
+        dense_t->shaped<T, NDIM>(b.y_reshape())                            \
+            .broadcast(BCast::ToIndexArray<NDIM>(b.y_bcast()));            \
+    Shard(worker_threads.num_threads, worker_threads.workers, nnz,         \
+          kCostPerUnit, [&](int64 begin, int64 end) {                      \
+            Eigen::array<Eigen::DenseIndex, NDIM> idx;                     \
+            for (int64 i = begin; i < end; ++i) {                          \
+              bool valid = true;                                           \
+              for (int d = 0; d < NDIM; ++d) {                             \
+                idx[d] = internal::SubtleMustCopy(indices_mat(i, d));      \
+                if (!FastBoundsCheck(idx[d], rhs_ref.dimension(d))) {      \
+                  valid = false;                                           \
+                }                                                          \
+              }                                                            \
+              if (!valid) {                                                \
+                indices_valid = false;                                     \
+                continue;                                                  \
+              }                                                            \
+              dense_gathered_flat(i) = rhs_ref.coeff(idx);                 \
+            }                                                              \
+          });                                                              \
+    break;                                                                 \
   }
 
       CASE(1);
@@ -155,6 +167,10 @@ class SparseDenseBinaryOpShared : public OpKernel {
                                     ndims));
 #undef CASE
     }
+    OP_REQUIRES(
+        ctx, indices_valid.load(),
+        errors::InvalidArgument("Provided indices are out-of-bounds w.r.t. "
+                                "dense side with broadcasted shape"));
 
     output_values->flat<T>().device(ctx->eigen_device<Device>()) =
         values_t->flat<T>().binaryExpr(dense_gathered_flat,
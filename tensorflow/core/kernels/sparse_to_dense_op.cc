@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -128,11 +129,46 @@ class SparseToDense : public OpKernel {
       OP_REQUIRES_OK(c, st.IndicesValid());
     }
 
-    output->flat<T>().setConstant(default_value.scalar<T>()());
-    OP_REQUIRES(c, st.template ToDense<T>(output, false /* initialize */),
-                errors::InvalidArgument(
-                    "Indices are not valid (out of bounds).  Shape: ",
-                    output->shape().DebugString()));
+    // Fill the default value with the threaded Eigen device so large
+    // outputs are initialized by all workers (and with packet stores
+    // where the type supports them).
+    output->flat<T>().device(c->eigen_device<Eigen::ThreadPoolDevice>()) =
+        output->flat<T>().constant(default_value.scalar<T>()());
+
+    if (validate_indices_) {
+      // Validated indices are unique and in bounds, so every entry
+      // scatters to a distinct output element and the scatter can be
+      // sharded across the worker threads without races.
+      auto ix_mat = indices_shaped.matrix<int64>();
+      auto vals_vec = sparse_values_b.vec<T>();
+      auto output_flat = output->flat<T>();
+      gtl::InlinedVector<int64, 8> strides(num_dims);
+      int64 stride = 1;
+      for (int64 d = num_dims - 1; d >= 0; --d) {
+        strides[d] = stride;
+        stride *= output->shape().dim_size(d);
+      }
+      auto worker_threads = *(c->device()->tensorflow_cpu_worker_threads());
+      const int64 kCostPerUnit = 20 * num_dims;
+      Shard(worker_threads.num_threads, worker_threads.workers, num_elems,
+            kCostPerUnit, [&](int64 begin, int64 end) {
+              for (int64 i = begin; i < end; ++i) {
+                int64 ix = 0;
+                for (int64 d = 0; d < num_dims; ++d) {
+                  ix += strides[d] * ix_mat(i, d);
+                }
+                output_flat(ix) = vals_vec(i);
+              }
+            });
+    } else {
+      // Without validation we cannot assume unique indices; fall back to
+      // the sequential scatter, which bounds-checks and keeps the
+      // deterministic last-writer-wins behavior for repeated indices.
+      OP_REQUIRES(c, st.template ToDense<T>(output, false /* initialize */),
+                  errors::InvalidArgument(
+                      "Indices are not valid (out of bounds).  Shape: ",
+                      output->shape().DebugString()));
+    }
   }
 
  private:
@@ -190,6 +190,35 @@ bool Spectrogram::GetNextWindowOfSamples(const std::vector<InputSample>& input,
   }
 }
 
+template <class InputSample, class OutputSample>
+bool Spectrogram::ComputeSquaredMagnitudeFrame(const InputSample* input,
+                                               OutputSample* output) {
+  if (!initialized_) {
+    LOG(ERROR) << "ComputeSquaredMagnitudeFrame() called before successful "
+               << "call to Initialize().";
+    return false;
+  }
+  for (int j = 0; j < window_length_; ++j) {
+    fft_input_output_[j] = input[j] * window_[j];
+  }
+  // Zero-pad the rest of the input buffer.
+  for (int j = window_length_; j < fft_length_; ++j) {
+    fft_input_output_[j] = 0.0;
+  }
+  RunFFT();
+  for (int i = 0; i < output_frequency_channels_; ++i) {
+    const double re = fft_input_output_[2 * i];
+    const double im = fft_input_output_[2 * i + 1];
+    output[i] = re * re + im * im;
+  }
+  return true;
+}
+// Instantiate it two ways:
+template bool Spectrogram::ComputeSquaredMagnitudeFrame(const float* input,
+                                                        float* output);
+template bool Spectrogram::ComputeSquaredMagnitudeFrame(const double* input,
+                                                        double* output);
+
 void Spectrogram::ProcessCoreFFT() {
   for (int j = 0; j < window_length_; ++j) {
     fft_input_output_[j] = input_queue_[j] * window_[j];
@@ -198,6 +227,10 @@ void Spectrogram::ProcessCoreFFT() {
   for (int j = window_length_; j < fft_length_; ++j) {
     fft_input_output_[j] = 0.0;
   }
+  RunFFT();
+}
+
+void Spectrogram::RunFFT() {
   const int kForwardFFT = 1;  // 1 means forward; -1 reverse.
   // This real FFT is a fair amount faster than using cdft here.
   rdft(fft_length_, kForwardFFT, &fft_input_output_[0],
@@ -77,6 +77,16 @@ class Spectrogram {
       const std::vector<InputSample>& input,
       std::vector<std::vector<OutputSample>>* output);
 
+  // Computes the squared-magnitude spectrum of one window of samples,
+  // addressed directly instead of through the streaming input queue.
+  // input must hold exactly the window length of samples and output must
+  // have room for output_frequency_channels() values.  Because this does
+  // not touch the queue, independent frames may be processed in any order,
+  // but still only from one thread at a time per instance.
+  template <class InputSample, class OutputSample>
+  bool ComputeSquaredMagnitudeFrame(const InputSample* input,
+                                    OutputSample* output);
+
   // Return reference to the window function used internally.
   const std::vector<double>& GetWindow() const { return window_; }
 
@@ -88,6 +98,7 @@ class Spectrogram {
   bool GetNextWindowOfSamples(const std::vector<InputSample>& input,
                               int* input_start);
   void ProcessCoreFFT();
+  void RunFFT();
 
   int fft_length_;
   int output_frequency_channels_;
@@ -15,6 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/audio_ops.cc
 
+#include <atomic>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -22,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/spectrogram.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -70,44 +74,59 @@ class AudioSpectrogramOp : public OpKernel {
             &output_tensor));
     auto output_flat = output_tensor->flat<float>().data();
 
-    std::vector<float> input_for_channel(sample_count);
-    for (int64 channel = 0; channel < channel_count; ++channel) {
-      float* output_slice =
-          output_flat + (channel * output_height * output_width);
-      for (int i = 0; i < sample_count; ++i) {
-        input_for_channel[i] = input_as_matrix(i, channel);
+    const int64 total_frames = output_slices * output_height;
+    if (total_frames == 0) {
+      return;
+    }
+
+    // Deinterleave the input so that each channel's samples are contiguous;
+    // the windowing loop inside the frame computation then runs over plain
+    // float spans the compiler can vectorize.
+    std::vector<float> deinterleaved(channel_count * sample_count);
+    for (int64 i = 0; i < sample_count; ++i) {
+      for (int64 channel = 0; channel < channel_count; ++channel) {
+        deinterleaved[channel * sample_count + i] = input_as_matrix(i, channel);
       }
-      std::vector<std::vector<float>> spectrogram_output;
-      OP_REQUIRES(context,
-                  spectrogram.ComputeSquaredMagnitudeSpectrogram(
-                      input_for_channel, &spectrogram_output),
-                  errors::InvalidArgument("Spectrogram compute failed"));
-      OP_REQUIRES(context, (spectrogram_output.size() == output_height),
-                  errors::InvalidArgument(
-                      "Spectrogram size calculation failed: Expected height ",
-                      output_height, " but got ", spectrogram_output.size()));
-      OP_REQUIRES(context,
-                  spectrogram_output.empty() ||
-                      (spectrogram_output[0].size() == output_width),
-                  errors::InvalidArgument(
-                      "Spectrogram size calculation failed: Expected width ",
-                      output_width, " but got ", spectrogram_output[0].size()));
-      for (int row_index = 0; row_index < output_height; ++row_index) {
-        const std::vector<float>& spectrogram_row =
-            spectrogram_output[row_index];
-        DCHECK_EQ(spectrogram_row.size(), output_width);
-        float* output_row = output_slice + (row_index * output_width);
-        if (magnitude_squared_) {
-          for (int i = 0; i < output_width; ++i) {
-            output_row[i] = spectrogram_row[i];
-          }
-        } else {
-          for (int i = 0; i < output_width; ++i) {
-            output_row[i] = sqrtf(spectrogram_row[i]);
+    }
+
+    // Every frame reads an independent span of samples, so frames are
+    // sharded across the intra-op pool, covering both the frames within a
+    // clip and the clips within a batch.  Each shard sets up its own FFT
+    // tables once and amortizes them over all of its frames.
+    std::atomic<bool> compute_ok(true);
+    auto compute_frames = [&](int64 start, int64 limit) {
+      Spectrogram shard_spectrogram;
+      if (!shard_spectrogram.Initialize(window_size_, stride_)) {
+        compute_ok = false;
+        return;
+      }
+      for (int64 idx = start; idx < limit; ++idx) {
+        const int64 channel = idx / output_height;
+        const int64 frame = idx % output_height;
+        const float* frame_input =
+            deinterleaved.data() + (channel * sample_count) + (frame * stride_);
+        float* output_row = output_flat + (idx * output_width);
+        if (!shard_spectrogram.ComputeSquaredMagnitudeFrame(frame_input,
+                                                            output_row)) {
+          compute_ok = false;
+          return;
+        }
+        if (!magnitude_squared_) {
+          for (int64 i = 0; i < output_width; ++i) {
+            output_row[i] = sqrtf(output_row[i]);
           }
         }
       }
-    }
+    };
+    const DeviceBase::CpuWorkerThreads* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    // Rough per-frame cost: the FFT dominates at a few tens of operations
+    // per input sample.
+    const int64 cost_per_frame = int64{50} * window_size_;
+    Shard(worker_threads->num_threads, worker_threads->workers, total_frames,
+          cost_per_frame, compute_frames);
+    OP_REQUIRES(context, compute_ok.load(),
+                errors::InvalidArgument("Spectrogram compute failed"));
   }
 
  private:
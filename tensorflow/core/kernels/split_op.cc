@@ -85,19 +85,35 @@ class SplitOpBase : public OpKernel {
       return;
     }
 
-    // Special case 2: split along the 1st dimension. We can share the
-    // underlying buffer.
+    // Special case 2: split along the first non-degenerate dimension. Every
+    // dimension in front of split_dim has size 1, so the slices are
+    // contiguous and we can share the underlying buffer, exactly as for a
+    // split along the 1st dimension.
     //
     // Apply this optimization conservatively: if input is aligned,
     // the resulting tensors must be aligned. It's conservative
     // because if the immediate consumer of the resulting tensors are
     // not using eigen for computation, its perfectly fine to avoid
     // the copying.
-    if ((split_dim == 0) && IsInnerDimsSizeAligned<T>(input_shape)) {
-      VLOG(1) << "Slice dim 0: " << input_shape.DebugString();
-      const int64 delta = input_shape.dim_size(0) / num_split;
+    const int64 split_dim_size = input_shape.dim_size(split_dim);
+    const TensorShape input_2d_shape(
+        {split_dim_size, split_dim_size == 0
+                             ? 0
+                             : input_shape.num_elements() / split_dim_size});
+    if (IsSliceDimContiguous(input_shape, split_dim) &&
+        IsInnerDimsSizeAligned<T>(input_2d_shape)) {
+      VLOG(1) << "Slice dim " << split_dim << ": "
+              << input_shape.DebugString();
+      Tensor input_2d;
+      CHECK(input_2d.CopyFrom(input, input_2d_shape));
+      const int64 delta = split_dim_size / num_split;
+      TensorShape output_shape = input_shape;
+      output_shape.set_dim(split_dim, delta);
       for (int i = 0; i < num_split; ++i) {
-        context->set_output(i, input.Slice(i * delta, (i + 1) * delta));
+        Tensor output;
+        CHECK(output.CopyFrom(input_2d.Slice(i * delta, (i + 1) * delta),
+                              output_shape));
+        context->set_output(i, output);
       }
       *done = true;
       return;
@@ -138,19 +138,34 @@ class SplitVOpBase : public OpKernel {
       (*split_sizes_vec)[neg_one_dim] = input_size_split_dim - determined_size;
     }
 
-    // Special case 2: split along the 1st dimension. We can share the
-    // underlying buffer.
+    // Special case 2: split along the first non-degenerate dimension. Every
+    // dimension in front of split_dim has size 1, so the slices are
+    // contiguous and we can share the underlying buffer, exactly as for a
+    // split along the 1st dimension.
     //
     // Apply this optimization conservatively: if input is aligned,
     // the resulting tensors must be aligned. It's conservative
     // because if the immediate consumer of the resulting tensors are
     // not using eigen for computation, its perfectly fine to avoid
     // the copying.
-    if ((split_dim == 0) && IsInnerDimsSizeAligned<T>(input_shape)) {
+    const int64 split_dim_size = input_shape.dim_size(split_dim);
+    const TensorShape input_2d_shape(
+        {split_dim_size, split_dim_size == 0
+                             ? 0
+                             : input_shape.num_elements() / split_dim_size});
+    if (IsSliceDimContiguous(input_shape, split_dim) &&
+        IsInnerDimsSizeAligned<T>(input_2d_shape)) {
+      Tensor input_2d;
+      CHECK(input_2d.CopyFrom(input, input_2d_shape));
       Tlen start = 0;
       for (int i = 0; i < num_split; ++i) {
-        context->set_output(i,
-                            input.Slice(start, start + (*split_sizes_vec)[i]));
+        TensorShape output_shape = input_shape;
+        output_shape.set_dim(split_dim, (*split_sizes_vec)[i]);
+        Tensor output;
+        CHECK(output.CopyFrom(
+            input_2d.Slice(start, start + (*split_sizes_vec)[i]),
+            output_shape));
+        context->set_output(i, output);
         start += (*split_sizes_vec)[i];
       }
       *done = true;
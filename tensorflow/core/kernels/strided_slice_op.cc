@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/strided_slice_op.h"
@@ -42,23 +43,38 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Below this many bytes the row copy runs inline; sharding the rows over the
+// thread pool costs more than the copy itself.
+const int64 kMinBytesForParallelCopy = 1 << 16;
+
 template <typename T>
 struct MemCpyFunctor {
   // Returns true if the copy was made with memcpy, false otherwise.
-  bool Copy(const Tensor& input, const gtl::InlinedVector<int64, 4>& begin,
+  bool Copy(OpKernelContext* context, const Tensor& input,
+            const gtl::InlinedVector<int64, 4>& begin,
             const gtl::InlinedVector<int64, 4>& end, Tensor* result) {
     if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
       auto in = input.tensor<T, 2>();
       auto output = result->tensor<T, 2>();
-      // TODO(agarwal): Consider multi-threading if size[0] is large
-      for (int row_in = begin[0], row_out = 0; row_in < end[0];
-           ++row_in, ++row_out) {
-        if (row_in + 1 < end[0]) {
-          port::prefetch<port::PREFETCH_HINT_T0>(&output(row_in + 1, 0));
-          port::prefetch<port::PREFETCH_HINT_T0>(&in(row_in + 1, begin[1]));
+      const int64 num_rows = end[0] - begin[0];
+      const int64 row_bytes = (end[1] - begin[1]) * sizeof(T);
+      auto copy_rows = [&](int64 start_row, int64 limit_row) {
+        for (int64 row_in = begin[0] + start_row, row_out = start_row;
+             row_in < begin[0] + limit_row; ++row_in, ++row_out) {
+          if (row_in + 1 < end[0]) {
+            port::prefetch<port::PREFETCH_HINT_T0>(&output(row_out + 1, 0));
+            port::prefetch<port::PREFETCH_HINT_T0>(&in(row_in + 1, begin[1]));
+          }
+          memcpy(&output(row_out, 0), &in(row_in, begin[1]), row_bytes);
         }
-        memcpy(&output(row_out, 0), &in(row_in, begin[1]),
-               (end[1] - begin[1]) * sizeof(T));
+      };
+      thread::ThreadPool* pool =
+          context->device()->tensorflow_cpu_worker_threads()->workers;
+      if (pool->NumThreads() > 0 &&
+          num_rows * row_bytes >= kMinBytesForParallelCopy) {
+        pool->ParallelFor(num_rows, row_bytes /* cost per row */, copy_rows);
+      } else {
+        copy_rows(0, num_rows);
       }
       return true;
     }
@@ -68,12 +84,68 @@ struct MemCpyFunctor {
 
 template <>
 struct MemCpyFunctor<ResourceHandle> {
-  bool Copy(const Tensor& input, const gtl::InlinedVector<int64, 4>& begin,
+  bool Copy(OpKernelContext* context, const Tensor& input,
+            const gtl::InlinedVector<int64, 4>& begin,
             const gtl::InlinedVector<int64, 4>& end, Tensor* result) {
     return false;
   }
 };
 
+// Reads a 1-D int32 or int64 index tensor into *out.  Returns false for any
+// other dtype or rank; the caller then falls back to full validation, which
+// produces the proper error.
+bool TryConvertSpecTensor(const Tensor& t, gtl::InlinedVector<int64, 4>* out) {
+  if (t.dims() != 1) return false;
+  out->resize(t.NumElements());
+  if (t.dtype() == DT_INT32) {
+    auto v = t.vec<int32>();
+    for (int64 i = 0; i < v.size(); ++i) (*out)[i] = v(i);
+  } else if (t.dtype() == DT_INT64) {
+    auto v = t.vec<int64>();
+    for (int64 i = 0; i < v.size(); ++i) (*out)[i] = v(i);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns true if the unit-stride slice [begin, end) selects a contiguous,
+// non-empty range of the input's row-major buffer: every dimension inside
+// the outermost partially-sliced dimension is taken in full and every
+// dimension outside it selects a single index.  On success *slice_begin and
+// *slice_end hold the flat element range.
+bool IsContiguousSlice(const TensorShape& input_shape,
+                       const gtl::InlinedVector<int64, 4>& begin,
+                       const gtl::InlinedVector<int64, 4>& end,
+                       int64* slice_begin, int64* slice_end) {
+  const int dims = input_shape.dims();
+  int64 elements = 1;
+  int partial = -1;
+  for (int d = dims - 1; d >= 0; --d) {
+    const int64 extent = end[d] - begin[d];
+    if (extent <= 0) return false;
+    if (extent == input_shape.dim_size(d)) {
+      elements *= extent;
+      continue;
+    }
+    partial = d;
+    break;
+  }
+  if (partial >= 0) {
+    elements *= end[partial] - begin[partial];
+    for (int d = 0; d < partial; ++d) {
+      if (end[d] - begin[d] != 1) return false;
+    }
+  }
+  int64 offset = 0;
+  for (int d = 0; d < dims; ++d) {
+    offset = offset * input_shape.dim_size(d) + begin[d];
+  }
+  *slice_begin = offset;
+  *slice_end = offset + elements;
+  return true;
+}
+
 }  // namespace
 
 template <typename Device, typename T>
@@ -97,13 +169,57 @@ class StridedSliceOp : public OpKernel {
     gtl::InlinedVector<int64, 4> end;
     gtl::InlinedVector<int64, 4> strides;
 
-    OP_REQUIRES_OK(
-        context, ValidateStridedSliceOp(
-                     &context->input(1), &context->input(2), context->input(3),
-                     context->input(0).shape(), begin_mask, end_mask,
-                     ellipsis_mask, new_axis_mask, shrink_axis_mask,
-                     &processing_shape, &final_shape, &is_identity,
-                     &is_simple_slice, &slice_dim0, &begin, &end, &strides));
+    // For static shapes the dense spec derived by ValidateStridedSliceOp is
+    // the same on every execution, so reuse the memo of the last successful
+    // validation when the input shape and slice parameters are unchanged.
+    gtl::InlinedVector<int64, 4> begin_spec, end_spec, strides_spec;
+    const bool specs_converted =
+        TryConvertSpecTensor(context->input(1), &begin_spec) &&
+        TryConvertSpecTensor(context->input(2), &end_spec) &&
+        TryConvertSpecTensor(context->input(3), &strides_spec);
+    bool cache_hit = false;
+    if (specs_converted) {
+      mutex_lock l(spec_mu_);
+      if (spec_.valid && spec_.input_shape == context->input(0).shape() &&
+          spec_.begin_spec == begin_spec && spec_.end_spec == end_spec &&
+          spec_.strides_spec == strides_spec) {
+        processing_shape = spec_.processing_shape;
+        final_shape = spec_.final_shape;
+        is_identity = spec_.is_identity;
+        is_simple_slice = spec_.is_simple_slice;
+        slice_dim0 = spec_.slice_dim0;
+        begin = spec_.begin;
+        end = spec_.end;
+        strides = spec_.strides;
+        cache_hit = true;
+      }
+    }
+    if (!cache_hit) {
+      OP_REQUIRES_OK(
+          context,
+          ValidateStridedSliceOp(
+              &context->input(1), &context->input(2), context->input(3),
+              context->input(0).shape(), begin_mask, end_mask, ellipsis_mask,
+              new_axis_mask, shrink_axis_mask, &processing_shape, &final_shape,
+              &is_identity, &is_simple_slice, &slice_dim0, &begin, &end,
+              &strides));
+      if (specs_converted) {
+        mutex_lock l(spec_mu_);
+        spec_.valid = true;
+        spec_.input_shape = context->input(0).shape();
+        spec_.begin_spec = begin_spec;
+        spec_.end_spec = end_spec;
+        spec_.strides_spec = strides_spec;
+        spec_.processing_shape = processing_shape;
+        spec_.final_shape = final_shape;
+        spec_.is_identity = is_identity;
+        spec_.is_simple_slice = is_simple_slice;
+        spec_.slice_dim0 = slice_dim0;
+        spec_.begin = begin;
+        spec_.end = end;
+        spec_.strides = strides;
+      }
+    }
     const Tensor& input = context->input(0);
 
     // Optimization #1, slice is a no-op plus reshape
@@ -132,6 +248,30 @@ class StridedSliceOp : public OpKernel {
       return;
     }
 
+    // Optimization #2A, slice is contiguous in the flat buffer but not in
+    // dim 0 (a single partially-sliced dimension with all inner dimensions
+    // taken in full), so the output can still alias the input.
+    if (is_simple_slice && new_axis_mask == 0 &&
+        processing_shape.dims() == input.dims() &&
+        processing_shape.num_elements() > 0) {
+      int64 slice_begin, slice_end;
+      TensorShape flat_shape({input.NumElements()});
+      if (IsContiguousSlice(input.shape(), begin, end, &slice_begin,
+                            &slice_end) &&
+          IsDim0SliceAligned<T>(flat_shape, slice_begin, slice_end)) {
+        VLOG(1) << "Strided slice contiguous: " << input.shape().DebugString();
+        Tensor flat;
+        OP_REQUIRES(context, flat.CopyFrom(input, flat_shape),
+                    errors::Internal("Copy failed"));
+        Tensor slice = flat.Slice(slice_begin, slice_end);
+        Tensor tmp;
+        OP_REQUIRES(context, tmp.CopyFrom(slice, final_shape),
+                    errors::Internal("Copy failed"));
+        context->set_output(0, tmp);
+        return;
+      }
+    }
+
     Tensor* result = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, final_shape, &result));
     const int input_dims = input.dims();
@@ -148,7 +288,7 @@ class StridedSliceOp : public OpKernel {
           input_dims == 2 && processing_shape.dims() == 2 &&
           final_shape.dims() == 2 && new_axis_mask == 0) {
         MemCpyFunctor<T> functor;
-        if (functor.Copy(input, begin, end, result)) {
+        if (functor.Copy(context, input, begin, end, result)) {
           return;
         }
       }
@@ -178,6 +318,20 @@ class StridedSliceOp : public OpKernel {
   }
 
  private:
+  // Memo of the most recent successful ValidateStridedSliceOp call.  The
+  // masks are kernel attributes, so the derived spec only depends on the
+  // input shape and the begin/end/strides values recorded here.
+  struct ValidatedSpec {
+    bool valid = false;
+    TensorShape input_shape;
+    gtl::InlinedVector<int64, 4> begin_spec, end_spec, strides_spec;
+    TensorShape processing_shape, final_shape;
+    bool is_identity, is_simple_slice, slice_dim0;
+    gtl::InlinedVector<int64, 4> begin, end, strides;
+  };
+  mutex spec_mu_;
+  ValidatedSpec spec_ GUARDED_BY(spec_mu_);
+
   int32 begin_mask, end_mask;
   int32 ellipsis_mask, new_axis_mask, shrink_axis_mask;
 };
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -190,25 +191,37 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<string>();
     const string& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
+    //
+    // The tokens are offset/length views into the input strings, so every
+    // row can be processed independently; both the tokenization and the copy
+    // into the output tensor are sharded over the batch.
+    std::vector<std::vector<StringPiece>> row_tokens(batch_size);
+    int64 total_bytes = 0;
+    for (int64 i = 0; i < batch_size; ++i) {
+      total_bytes += input_vec(i).size();
+    }
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    const int64 cost_per_row =
+        std::max<int64>(1, total_bytes / std::max<int64>(1, batch_size));
+    auto split_work = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        row_tokens[i] =
+            skip_empty_
+                ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
+                : Split(input_vec(i), delimiter, str_util::AllowEmpty());
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_row, split_work);
 
-    int64 output_size = 0;
     int64 max_num_entries = 0;
-    std::vector<int64> num_indices(batch_size);
+    std::vector<int64> row_offsets(batch_size + 1, 0);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts =
-          skip_empty_ ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
-                      : Split(input_vec(i), delimiter, str_util::AllowEmpty());
-      int64 n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
+      const int64 n_entries = row_tokens[i].size();
+      row_offsets[i + 1] = row_offsets[i] + n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), std::make_move_iterator(parts.begin()),
-                    std::make_move_iterator(parts.end()));
     }
+    const int64 output_size = row_offsets[batch_size];
 
     Tensor* sp_indices_t;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
@@ -224,15 +237,20 @@ class StringSplitOp : public OpKernel {
     auto sp_shape = sp_shape_t->vec<int64>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
+    auto copy_work = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        int64 c = row_offsets[i];
+        const int64 n_entries = row_tokens[i].size();
+        for (int64 j = 0; j < n_entries; ++j) {
+          sp_indices(c, 0) = i;
+          sp_indices(c, 1) = j;
+          sp_tokens(c).assign(row_tokens[i][j].data(), row_tokens[i][j].size());
+          ++c;
+        }
       }
-    }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_row, copy_work);
   }
 
  private:
@@ -263,22 +281,34 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<string>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
 
-    int64 output_size = 0;
+    // As in StringSplitOp above, the tokens are views into the input
+    // strings, so the tokenization and the output copy are both sharded
+    // over the batch.
+    std::vector<std::vector<StringPiece>> row_tokens(batch_size);
+    int64 total_bytes = 0;
+    for (int64 i = 0; i < batch_size; ++i) {
+      total_bytes += input_vec(i).size();
+    }
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    const int64 cost_per_row =
+        std::max<int64>(1, total_bytes / std::max<int64>(1, batch_size));
+    auto split_work = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        row_tokens[i] = SplitV2(input_vec(i), sep, maxsplit_);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_row, split_work);
+
     int64 max_num_entries = 0;
-    std::vector<int64> num_indices(batch_size);
+    std::vector<int64> row_offsets(batch_size + 1, 0);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64 n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
+      const int64 n_entries = row_tokens[i].size();
+      row_offsets[i + 1] = row_offsets[i] + n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
+    const int64 output_size = row_offsets[batch_size];
 
     Tensor* sp_indices_t;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
@@ -294,15 +324,20 @@ class StringSplitV2Op : public OpKernel {
     auto sp_shape = sp_shape_t->vec<int64>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
+    auto copy_work = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        int64 c = row_offsets[i];
+        const int64 n_entries = row_tokens[i].size();
+        for (int64 j = 0; j < n_entries; ++j) {
+          sp_indices(c, 0) = i;
+          sp_indices(c, 1) = j;
+          sp_tokens(c).assign(row_tokens[i][j].data(), row_tokens[i][j].size());
+          ++c;
+        }
       }
-    }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_row, copy_work);
   }
 
  private:
@@ -134,6 +134,93 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // Minimum number of columns assigned to each partition when splitting a
+    // single row across threads; below this the heap selection is cheap
+    // enough that the sharding overhead dominates.
+    constexpr int64 kMinColsPerPartition = 1 << 16;
+
+    // When there are fewer rows than threads and the rows are very wide
+    // (e.g. retrieval models selecting the top k of millions of scores in
+    // one row), sharding over rows leaves most of the pool idle. Split each
+    // row into column partitions, select each partition's local top k in
+    // parallel, and merge the candidates. Every element of the true top k is
+    // necessarily in its partition's local top k, and the merge only sees
+    // partitions * k entries - a tiny fraction of the row.
+    if (k < num_cols && num_rows < worker_threads.num_threads &&
+        num_cols / 2 >= kMinColsPerPartition) {
+      const int64 num_parts =
+          std::min<int64>(worker_threads.num_threads,
+                          num_cols / kMinColsPerPartition);
+      const int64 cols_per_part = (num_cols + num_parts - 1) / num_parts;
+      std::vector<int32> candidates(num_parts * k);
+      std::vector<int64> candidate_counts(num_parts);
+      for (int64 b = 0; b < num_rows; ++b) {
+        const T* input_data = &input(b, 0);
+        const auto stable_comp = [input_data](const int32 a, const int32 b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        auto part_work = [&, input_data](int64 part_begin, int64 part_end) {
+          for (int64 p = part_begin; p < part_end; ++p) {
+            const int32 col_begin = static_cast<int32>(p * cols_per_part);
+            const int32 col_end = static_cast<int32>(
+                std::min<int64>(num_cols, (p + 1) * cols_per_part));
+            const int64 local_k = std::min<int64>(k, col_end - col_begin);
+            gtl::TopN<int32, decltype(stable_comp)> filter(local_k,
+                                                           stable_comp);
+            filter.reserve(col_end - col_begin);
+            for (int32 c = col_begin; c < col_end; ++c) {
+              filter.push(c);
+            }
+            int64 i = 0;
+            for (auto it = filter.unsorted_begin(); it != filter.unsorted_end();
+                 ++it, ++i) {
+              candidates[p * k + i] = *it;
+            }
+            candidate_counts[p] = i;
+          }
+        };
+        const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
+                                Eigen::TensorOpCost::AddCost<T>();
+        const int64 part_cost = static_cast<int64>(
+            cmp_cost * cols_per_part *
+            Eigen::numext::log2(static_cast<float>(k + 1)));
+        Shard(worker_threads.num_threads, worker_threads.workers, num_parts,
+              part_cost, part_work);
+
+        gtl::TopN<int32, decltype(stable_comp)> merge(k, stable_comp);
+        merge.reserve(num_parts * k);
+        for (int64 p = 0; p < num_parts; ++p) {
+          for (int64 i = 0; i < candidate_counts[p]; ++i) {
+            merge.push(candidates[p * k + i]);
+          }
+        }
+        int32 i = 0;
+        if (sorted) {
+          std::unique_ptr<std::vector<int32>> top_k(merge.Extract());
+          for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
+               ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        } else {
+          for (auto top_k_it = merge.unsorted_begin();
+               top_k_it != merge.unsorted_end(); ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        }
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const int32 loc) { return input(b, loc); });
+      }
+      return Status::OK();
+    }
+
     auto SortIndices = [&](int start_batch, int limit_batch) {
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -219,7 +306,6 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
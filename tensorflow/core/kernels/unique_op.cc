@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
 namespace tensorflow {
@@ -106,26 +109,14 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
 
-      std::unordered_map<T, TIndex> uniq;
-      uniq.reserve(2 * N);
-      for (Eigen::Index i = 0, j = 0; i < N; ++i) {
-        auto it = uniq.insert(std::make_pair(Tin(i), j));
-        idx_vec(i) = it.first->second;
-        if (it.second) {
-          ++j;
-        }
-      }
-
-      uniq_size = static_cast<int64>(uniq.size());
-      TensorShape output_shape(input.shape());
-      output_shape.set_dim(axis, uniq_size);
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context,
-                     context->allocate_output(0, output_shape, &output));
-      auto Tout = output->flat<T>();
-
-      for (auto it : uniq) {
-        Tout(it.second) = it.first;
+      thread::ThreadPool* thread_pool =
+          context->device()->tensorflow_cpu_worker_threads()->workers;
+      if (thread_pool->NumThreads() > 0 && N >= kMinElementsForShardedUnique) {
+        ComputeShardedScalar(context, thread_pool, axis, idx_vec, &uniq_size);
+        if (!context->status().ok()) return;
+      } else {
+        ComputeSerialScalar(context, axis, idx_vec, &uniq_size);
+        if (!context->status().ok()) return;
       }
     } else {
       // General implementation when unique is run over multiple elements.
@@ -192,6 +183,136 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Inputs below this size are deduplicated with the single-threaded code;
+  // the sharded version only pays off once the hash maps stop fitting in
+  // cache.
+  static const int64 kMinElementsForShardedUnique = 1 << 15;
+  static const int64 kMaxUniqueShards = 64;
+
+  // Original single-map implementation of the 1-D case.
+  void ComputeSerialScalar(OpKernelContext* context, int64 axis,
+                           typename TTypes<TIndex>::Vec idx_vec,
+                           int64* uniq_size) {
+    const Tensor& input = context->input(0);
+    auto Tin = input.flat<T>();
+    const int64 N = static_cast<int64>(Tin.size());
+
+    std::unordered_map<T, TIndex> uniq;
+    uniq.reserve(2 * N);
+    for (Eigen::Index i = 0, j = 0; i < N; ++i) {
+      auto it = uniq.insert(std::make_pair(Tin(i), j));
+      idx_vec(i) = it.first->second;
+      if (it.second) {
+        ++j;
+      }
+    }
+
+    *uniq_size = static_cast<int64>(uniq.size());
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+
+    for (auto it : uniq) {
+      Tout(it.second) = it.first;
+    }
+  }
+
+  // Sharded implementation of the 1-D case: elements are routed to shards by
+  // hash, each shard builds its own map from value to first occurrence in
+  // parallel, and the merge step assigns ids in order of first appearance so
+  // the outputs are identical to the single-map implementation.
+  void ComputeShardedScalar(OpKernelContext* context,
+                            thread::ThreadPool* thread_pool, int64 axis,
+                            typename TTypes<TIndex>::Vec idx_vec,
+                            int64* uniq_size) {
+    const Tensor& input = context->input(0);
+    auto Tin = input.flat<T>();
+    const int64 N = static_cast<int64>(Tin.size());
+
+    struct Occurrence {
+      int64 first_index;
+      TIndex id;
+    };
+    typedef std::unordered_map<T, Occurrence> ShardMap;
+
+    int64 num_shards = 1;
+    while (num_shards < thread_pool->NumThreads() &&
+           num_shards < kMaxUniqueShards) {
+      num_shards <<= 1;
+    }
+    const uint64 shard_mask = num_shards - 1;
+
+    // Route each element to the shard owning its hash bucket.
+    std::vector<uint8> shard_of(N);
+    thread_pool->ParallelFor(
+        N, 10 /* cost */,
+        [shard_mask, &shard_of, &Tin](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) {
+            shard_of[i] = std::hash<T>{}(Tin(i)) & shard_mask;
+          }
+        });
+
+    // Each shard maps its values to their first occurrence.  A shard scans
+    // the whole routing array but only hashes the elements it owns.
+    std::vector<ShardMap> shards(num_shards);
+    thread_pool->ParallelFor(
+        num_shards, std::max<int64>(10 * N / num_shards, 1),
+        [N, num_shards, &shards, &shard_of, &Tin](int64 shard_begin,
+                                                  int64 shard_end) {
+          for (int64 s = shard_begin; s < shard_end; ++s) {
+            ShardMap& shard = shards[s];
+            shard.reserve(2 * N / num_shards);
+            for (int64 i = 0; i < N; ++i) {
+              if (shard_of[i] != s) continue;
+              shard.emplace(Tin(i), Occurrence{i, TIndex(0)});
+            }
+          }
+        });
+
+    // Merge: order the distinct values by first appearance to assign their
+    // ids and fill the values output.
+    int64 total = 0;
+    for (const ShardMap& shard : shards) {
+      total += static_cast<int64>(shard.size());
+    }
+    std::vector<typename ShardMap::value_type*> entries;
+    entries.reserve(total);
+    for (ShardMap& shard : shards) {
+      for (auto& entry : shard) {
+        entries.push_back(&entry);
+      }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const typename ShardMap::value_type* lhs,
+                 const typename ShardMap::value_type* rhs) {
+                return lhs->second.first_index < rhs->second.first_index;
+              });
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, total);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    for (int64 r = 0; r < total; ++r) {
+      entries[r]->second.id = static_cast<TIndex>(r);
+      Tout(r) = entries[r]->first;
+    }
+
+    // Translate every element to its id; the lookups race with nothing.
+    thread_pool->ParallelFor(
+        N, 20 /* cost */,
+        [&idx_vec, &shards, &shard_of, &Tin](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) {
+            idx_vec(i) = shards[shard_of[i]].find(Tin(i))->second.id;
+          }
+        });
+
+    *uniq_size = total;
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                    \
@@ -72,18 +72,22 @@ class UnpackOp : public OpKernel {
 
 // This optimization is currently not applicable for SYCL devices
 #ifndef TENSORFLOW_USE_SYCL
-    // Special case: Aligned, so we can share the underlying buffer.
+    // Special case: the slices are contiguous (every dimension in front of
+    // axis has size 1) and aligned, so we can share the underlying buffer.
     //
     // Apply this optimization conservatively: if input is aligned,
     // the resulting tensors must be aligned. It's conservative
     // because if the immediate consumer of the resulting tensors are
     // not using eigen for computation, its perfectly fine to avoid
     // the copying.
-    if (axis == 0 &&
-        (output_size == 0 || IsInnerDimsSizeAligned<T>(input_shape))) {
+    const TensorShape input_2d_shape({num, output_size});
+    if (IsSliceDimContiguous(input_shape, axis) &&
+        (output_size == 0 || IsInnerDimsSizeAligned<T>(input_2d_shape))) {
+      Tensor input_2d;
+      CHECK(input_2d.CopyFrom(input, input_2d_shape));
       for (int i = 0; i < num; ++i) {
         Tensor output;
-        CHECK(output.CopyFrom(input.Slice(i, i + 1), output_shape));
+        CHECK(output.CopyFrom(input_2d.Slice(i, i + 1), output_shape));
         context->set_output(i, output);
       }
       return;
@@ -23,8 +23,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/where_op.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -33,9 +36,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -50,9 +55,13 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
-namespace functor {
-
 namespace {
+
+// Number of input elements covered by one counting/writing block in the
+// two-pass CPU implementation below. Blocks are the unit of sharding across
+// the intra-op pool.
+constexpr int64 kWhereBlockSize = 1 << 16;
+
 template <typename T>
 int64 CountAccumulator(const T* begin, const T* end) {
   return std::accumulate(begin, end, 0LL, [](int64 accum, const T& val) {
@@ -67,59 +76,6 @@ int64 CountAccumulator<bool>(const bool* begin, const bool* end) {
 
 }  // namespace
 
-template <typename T>
-struct NumTrue<CPUDevice, T, int64> {
-  static Status Compute(OpKernelContext* ctx, const CPUDevice& d,
-                        typename TTypes<T>::ConstFlat input,
-                        TTypes<int64>::Scalar num_true) {
-    num_true() = CountAccumulator<T>(input.data(), input.data() + input.size());
-    return Status::OK();
-  }
-};
-
-template <int DIMS, typename T, typename TIndex>
-struct Where<CPUDevice, DIMS, T, TIndex> {
-  EIGEN_ALWAYS_INLINE static void WriteIndexRowMajor(
-      typename TTypes<int64>::Matrix output,
-      const typename Eigen::DSizes<TIndex, DIMS>& strides, TIndex true_n,
-      TIndex index) {
-    for (int i = 0; i < DIMS; ++i) {
-      output(true_n, i) = index / strides[i];
-      index -= output(true_n, i) * strides[i];
-    }
-  }
-
-  EIGEN_ALWAYS_INLINE static Status Compute(
-      OpKernelContext* ctx, const CPUDevice& d,
-      typename TTypes<T, DIMS>::ConstTensor input,
-      typename TTypes<int64>::Matrix output, TIndex* found_true) {
-    Eigen::DSizes<Eigen::DenseIndex, DIMS> dims = input.dimensions();
-    Eigen::DSizes<TIndex, DIMS> strides;
-
-    EIGEN_STATIC_ASSERT((static_cast<int>(decltype(input)::Layout) ==
-                         static_cast<int>(Eigen::RowMajor)),
-                        INTERNAL_ERROR_INPUT_SHOULD_BE_ROWMAJOR);
-
-    strides[DIMS - 1] = 1;
-    for (int i = DIMS - 2; i >= 0; --i) {
-      strides[i] = strides[i + 1] * dims[i + 1];
-    }
-
-    Eigen::DenseIndex output_size = output.dimension(0);
-    for (Eigen::DenseIndex n = 0; n < input.size(); ++n) {
-      if (input.data()[n] != T(0)) {
-        if (FastBoundsCheck(*found_true, output_size)) {
-          WriteIndexRowMajor(output, strides, *found_true, n);
-        }
-        ++*found_true;
-      }
-    }
-    return Status::OK();
-  }
-};
-
-}  // namespace functor
-
 template <typename T>
 class WhereCPUOp : public OpKernel {
  public:
@@ -135,56 +91,95 @@ class WhereCPUOp : public OpKernel {
                               "creating costly copies from device."));
 
     const int input_dims = input.dims();
+    OP_REQUIRES(context, input_dims >= 1,
+                errors::InvalidArgument(
+                    "WhereOp : Unhandled input dimensions: ", input_dims));
+
+    const int64 num_elems = input.NumElements();
+    const T* input_data = input.flat<T>().data();
+    const int64 num_blocks = (num_elems + kWhereBlockSize - 1) / kWhereBlockSize;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+
+    // Pass 1: count the true elements of each block in parallel. The
+    // per-block loop is a branch-free compare-and-accumulate that the
+    // compiler vectorizes.
+    std::vector<int64> block_counts(num_blocks);
+    auto count_blocks = [&](int64 begin, int64 limit) {
+      for (int64 block = begin; block < limit; ++block) {
+        const int64 start = block * kWhereBlockSize;
+        const int64 end = std::min(start + kWhereBlockSize, num_elems);
+        block_counts[block] =
+            CountAccumulator<T>(input_data + start, input_data + end);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          kWhereBlockSize, count_blocks);
+
+    // An exclusive prefix sum turns the counts into per-block output offsets.
+    int64 num_true = 0;
+    std::vector<int64> block_offsets(num_blocks);
+    for (int64 block = 0; block < num_blocks; ++block) {
+      block_offsets[block] = num_true;
+      num_true += block_counts[block];
+    }
 
-    Tensor num_true;
-    AllocatorAttributes attr;
-    attr.set_on_host(true);
-    OP_REQUIRES_OK(context, context->allocate_temp(DT_INT64, TensorShape({}),
-                                                   &num_true, attr));
-    auto num_true_t = num_true.scalar<int64>();
-
-    Status s = functor::NumTrue<CPUDevice, T, int64>::Compute(
-        context, context->eigen_device<CPUDevice>(), input.flat<T>(),
-        num_true_t);
-    OP_REQUIRES_OK(context, s);
-    TensorShape output_shape({num_true_t(), input_dims});
+    TensorShape output_shape({num_true, input_dims});
     Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto output_mat = output->matrix<int64>();
+
+    // Row-major strides for decomposing a flat index into per-dimension
+    // coordinates.
+    gtl::InlinedVector<int64, 8> strides(input_dims);
+    strides[input_dims - 1] = 1;
+    for (int i = input_dims - 2; i >= 0; --i) {
+      strides[i] = strides[i + 1] * input.dim_size(i + 1);
+    }
 
-    // TODO(ebrevdo): Replace single-threaded copy with a
-    // multithreaded block copy by getting block counts above instead
-    // of a global NumTrue, then having each block filled in in
-    // separate threads below.
-    int64 found_true = 0;
-
-#define HANDLE_DIM(NDIM)                                                      \
-  case NDIM: {                                                                \
-    Status s = functor::Where<CPUDevice, NDIM, T, int64>::Compute(            \
-        context, context->eigen_device<CPUDevice>(), input.tensor<T, NDIM>(), \
-        output->matrix<int64>(), &found_true);                                \
-    OP_REQUIRES_OK(context, s);                                               \
-  } break;
+    // Pass 2: each block writes the coordinates of its true elements into
+    // its own span of the preallocated output, so the blocks are
+    // independent. A block never writes past the span it was assigned in
+    // pass 1, but keeps counting so that concurrent modification of the
+    // input is still detected below.
+    std::vector<int64> block_found(num_blocks, 0);
+    auto write_blocks = [&](int64 begin, int64 limit) {
+      for (int64 block = begin; block < limit; ++block) {
+        const int64 start = block * kWhereBlockSize;
+        const int64 end = std::min(start + kWhereBlockSize, num_elems);
+        const int64 out_capacity = block_counts[block];
+        int64 out_n = block_offsets[block];
+        int64 found = 0;
+        for (int64 n = start; n < end; ++n) {
+          if (input_data[n] != T(0)) {
+            if (FastBoundsCheck(found, out_capacity)) {
+              int64 index = n;
+              for (int i = 0; i < input_dims; ++i) {
+                const int64 coord = index / strides[i];
+                output_mat(out_n, i) = coord;
+                index -= coord * strides[i];
+              }
+              ++out_n;
+            }
+            ++found;
+          }
+        }
+        block_found[block] = found;
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          3 * kWhereBlockSize, write_blocks);
 
-    switch (input_dims) {
-      HANDLE_DIM(1);
-      HANDLE_DIM(2);
-      HANDLE_DIM(3);
-      HANDLE_DIM(4);
-      HANDLE_DIM(5);
-
-      default:
-        OP_REQUIRES(context, false,
-                    errors::InvalidArgument(
-                        "WhereOp : Unhandled input dimensions: ", input_dims));
+    int64 found_true = 0;
+    for (int64 block = 0; block < num_blocks; ++block) {
+      found_true += block_found[block];
     }
-#undef HANDLE_DIM
-
     OP_REQUIRES(
-        context, found_true == num_true_t(),
+        context, found_true == num_true,
         errors::InvalidArgument(
             "WhereOp: Race condition between counting the number of true "
             "elements and writing them.  When counting, saw ",
-            num_true_t(), " elements; but when writing their indices, saw ",
+            num_true, " elements; but when writing their indices, saw ",
             found_true, " elements."));
   }
 
@@ -128,6 +128,19 @@ void ThreadPool::Schedule(std::function<void()> fn) {
   impl_->Schedule(std::move(fn));
 }
 
+void ThreadPool::Schedule(const SchedulingOptions& options,
+                          std::function<void()> fn) {
+  CHECK(fn != nullptr);
+  if (options.allow_caller_runs && impl_->CurrentThreadId() != -1) {
+    // The calling thread is one of our workers, so running fn() inline is
+    // indistinguishable from its queue serving fn() next, and avoids both
+    // the queue round-trip and the wakeup of an idle worker.
+    fn();
+    return;
+  }
+  impl_->Schedule(std::move(fn));
+}
+
 int ThreadPool::NumShardsUsedByTransformRangeConcurrently(
     const int64 block_size, const int64 total) {
   if (block_size <= 0 || total <= 1 || total <= block_size ||
@@ -60,9 +60,25 @@ class ThreadPool {
   // set of threads.
   ~ThreadPool();
 
+  // Options controlling how Schedule() submits a closure to the pool.
+  struct SchedulingOptions {
+    // If true and Schedule() is called from a thread that belongs to this
+    // pool, fn() runs immediately on the calling thread instead of being
+    // pushed onto a work queue. This skips the queue round-trip and the
+    // wakeup of an idle worker, which matters for fine-grained closures,
+    // but blocks the caller until fn() returns. Only use this for
+    // short-running closures; long-running ones would stall whatever the
+    // calling worker was going to do next.
+    bool allow_caller_runs = false;
+  };
+
   // Schedules fn() for execution in the pool of threads.
   void Schedule(std::function<void()> fn);
 
+  // Schedules fn() for execution in the pool of threads, subject to
+  // "options". See SchedulingOptions.
+  void Schedule(const SchedulingOptions& options, std::function<void()> fn);
+
   void SetStealPartitions(
       const std::vector<std::pair<unsigned, unsigned>>& partitions);
 
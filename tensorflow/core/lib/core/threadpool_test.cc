@@ -61,6 +61,40 @@ TEST(ThreadPool, DoWork) {
   }
 }
 
+TEST(ThreadPool, CallerRuns) {
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads++) {
+    fprintf(stderr, "Testing with %d threads\n", num_threads);
+    ThreadPool pool(Env::Default(), "test", num_threads);
+    ThreadPool::SchedulingOptions options;
+    options.allow_caller_runs = true;
+
+    // Submitted from outside the pool, the closure must still run on a pool
+    // thread.
+    mutex mu;
+    condition_variable cv;
+    bool done = false;
+    pool.Schedule(options, [&pool, &options, &mu, &cv, &done]() {
+      const int worker_id = pool.CurrentThreadId();
+      ASSERT_NE(worker_id, -1);
+      // Submitted from a pool thread, the closure runs inline on that same
+      // thread.
+      bool inner_done = false;
+      pool.Schedule(options, [&pool, worker_id, &inner_done]() {
+        ASSERT_EQ(worker_id, pool.CurrentThreadId());
+        inner_done = true;
+      });
+      ASSERT_TRUE(inner_done);
+      mutex_lock l(mu);
+      done = true;
+      cv.notify_all();
+    });
+    mutex_lock l(mu);
+    while (!done) {
+      cv.wait(l);
+    }
+  }
+}
+
 void RunSharding(int64 block_size, int64 total, ThreadPool* threads) {
   mutex mu;
   int64 num_shards = 0;
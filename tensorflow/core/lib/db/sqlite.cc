@@ -133,6 +133,12 @@ Status Sqlite::Open(const string& path, int flags, Sqlite** db) {
   // Up until 2016 the default SQLite page_size was 1024. This ensures
   // the new default regardless of linkage unless configured otherwise.
   s.Update(SetPragma(*db, "page_size", "4096"));
+  // Write-ahead logging avoids the auto-commit fsync on every write and
+  // lets readers proceed concurrently with a writer, which matters for
+  // high-rate summary ingestion. TF_SQLITE_JOURNAL_MODE below can still
+  // override this (e.g. back to "delete"). Best effort: in-memory and
+  // read-only databases ignore it.
+  s.Update(SetPragma(*db, "journal_mode", "wal"));
   // TensorFlow is designed to work well in all SQLite modes. However
   // users might find tuning some these pragmas rewarding, depending on
   // various considerations. Pragmas are set on a best-effort basis and
@@ -15,21 +15,35 @@ limitations under the License.
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
-// SSE4.2 accelerated CRC32c.
+// Hardware-accelerated CRC32c using the SSE4.2 or ARMv8 CRC instructions.
+//
+// On x86 the crc32 instruction is compiled with a per-function target
+// attribute, so the fast path is available at runtime on capable hosts even
+// when the rest of the binary is built for a baseline ISA; the caller
+// (crc32c.cc) falls back to the table-based loop when CanAccelerate()
+// returns false.
+//
+// Large buffers are additionally split into three equal chunks checksummed
+// on independent dependency chains. The crc32 instruction has multi-cycle
+// latency but single-cycle throughput, so three interleaved streams run
+// close to three times faster than one; the per-chunk results are merged
+// with a precomputed GF(2) shift operator.
 
 // See if the SSE4.2 crc32c instruction is available.
 #undef USE_SSE_CRC32C
-#ifdef __SSE4_2__
-#if defined(__x86_64__) && defined(__GNUC__) && \
-    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
-#define USE_SSE_CRC32C 1
-#elif defined(__x86_64__) && defined(__clang__)
+#if defined(__x86_64__)
+#if defined(__clang__)
 #if __has_builtin(__builtin_cpu_supports)
 #define USE_SSE_CRC32C 1
 #endif
+#elif defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+// GCC needs 4.9+ for the crc32 builtins under a target attribute.
+#define USE_SSE_CRC32C 1
 #endif
-#endif /* __SSE4_2__ */
+#endif /* __x86_64__ */
 
 // This version of Apple clang has a bug:
 // https://llvm.org/bugs/show_bug.cgi?id=25510
@@ -37,14 +51,18 @@ limitations under the License.
 #undef USE_SSE_CRC32C
 #endif
 
-#ifdef USE_SSE_CRC32C
-#include <nmmintrin.h>
+// ARMv8 CRC extension; only available when the build targets it, in which
+// case no runtime probe is needed.
+#undef USE_ARM_CRC32C
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define USE_ARM_CRC32C 1
+#include <arm_acle.h>
 #endif
 
 namespace tensorflow {
 namespace crc32c {
 
-#ifndef USE_SSE_CRC32C
+#if !defined(USE_SSE_CRC32C) && !defined(USE_ARM_CRC32C)
 
 bool CanAccelerate() { return false; }
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
@@ -54,45 +72,193 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
 
 #else
 
-// SSE4.2 optimized crc32c computation.
+#if defined(USE_SSE_CRC32C)
+
+#define TF_TARGET_CRC32C __attribute__((target("sse4.2")))
+
 bool CanAccelerate() { return __builtin_cpu_supports("sse4.2"); }
 
-uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
-  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
-  const uint8_t *e = p + size;
+TF_TARGET_CRC32C static inline uint32_t HwCrcByte(uint32_t crc, uint8_t b) {
+  return __builtin_ia32_crc32qi(crc, b);
+}
+
+TF_TARGET_CRC32C static inline uint32_t HwCrcWord(uint32_t crc, uint64_t w) {
+  return static_cast<uint32_t>(__builtin_ia32_crc32di(crc, w));
+}
+
+#else  // USE_ARM_CRC32C
+
+#define TF_TARGET_CRC32C
+
+bool CanAccelerate() { return true; }
+
+static inline uint32_t HwCrcByte(uint32_t crc, uint8_t b) {
+  return __crc32cb(crc, b);
+}
+
+static inline uint32_t HwCrcWord(uint32_t crc, uint64_t w) {
+  return __crc32cd(crc, w);
+}
+
+#endif
+
+namespace {
+
+// Bytes checksummed per stream in one interleaved block; three streams run
+// per block, so buffers shorter than 3 * kInterleaveBlockSize use the
+// single-stream loop.
+const size_t kInterleaveBlockSize = 1024;
+
+// The CRC-32C (Castagnoli) polynomial, reflected.
+const uint32_t kPolynomial = 0x82f63b78u;
+
+inline uint64_t LoadUnaligned64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Multiplies the GF(2) operator "mat" (32 rows, one per state bit) by the
+// state vector "vec".
+uint32_t Gf2MatrixTimes(const uint32_t *mat, uint32_t vec) {
+  uint32_t sum = 0;
+  int i = 0;
+  while (vec) {
+    if (vec & 1) sum ^= mat[i];
+    vec >>= 1;
+    i++;
+  }
+  return sum;
+}
+
+void Gf2MatrixSquare(uint32_t *square, const uint32_t *mat) {
+  for (int n = 0; n < 32; n++) {
+    square[n] = Gf2MatrixTimes(mat, mat[n]);
+  }
+}
+
+// The linear operator that advances a CRC by kInterleaveBlockSize zero
+// bytes: crc(A || B) == Gf2MatrixTimes(shift, crc(A)) ^ crc(B) when B is
+// kInterleaveBlockSize bytes long. The pre/post conditioning terms cancel,
+// so the identity holds for fully conditioned CRC values.
+struct CrcShiftOperator {
+  uint32_t mat[32];
+};
+
+CrcShiftOperator ComputeBlockShift() {
+  uint32_t even[32];
+  uint32_t odd[32];
+
+  // Operator for appending one zero bit.
+  odd[0] = kPolynomial;
+  uint32_t row = 1;
+  for (int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+
+  // Square until the operator covers 8 * kInterleaveBlockSize zero bits;
+  // each squaring doubles the number of bits.
+  size_t bits = 1;
+  const size_t target_bits = 8 * kInterleaveBlockSize;
+  uint32_t *src = odd;
+  uint32_t *dst = even;
+  while (bits < target_bits) {
+    Gf2MatrixSquare(dst, src);
+    uint32_t *tmp = src;
+    src = dst;
+    dst = tmp;
+    bits <<= 1;
+  }
+
+  CrcShiftOperator result;
+  memcpy(result.mat, src, sizeof(result.mat));
+  return result;
+}
+
+const CrcShiftOperator &BlockShift() {
+  static const CrcShiftOperator shift = ComputeBlockShift();
+  return shift;
+}
+
+// Checksums three adjacent kInterleaveBlockSize chunks starting at p on
+// independent dependency chains. Each result is a fully conditioned CRC of
+// its chunk.
+TF_TARGET_CRC32C void HwCrc3WayBlock(const uint8_t *p, uint32_t *v0,
+                                     uint32_t *v1, uint32_t *v2) {
+  uint32_t l0 = 0xffffffffu;
+  uint32_t l1 = 0xffffffffu;
+  uint32_t l2 = 0xffffffffu;
+  for (size_t i = 0; i < kInterleaveBlockSize; i += 8) {
+    l0 = HwCrcWord(l0, LoadUnaligned64(p + i));
+    l1 = HwCrcWord(l1, LoadUnaligned64(p + kInterleaveBlockSize + i));
+    l2 = HwCrcWord(l2, LoadUnaligned64(p + 2 * kInterleaveBlockSize + i));
+  }
+  *v0 = l0 ^ 0xffffffffu;
+  *v1 = l1 ^ 0xffffffffu;
+  *v2 = l2 ^ 0xffffffffu;
+}
+
+// Single-stream hardware loop, handling arbitrary alignment and length.
+TF_TARGET_CRC32C uint32_t HwExtend(uint32_t crc, const uint8_t *p,
+                                   const uint8_t *e) {
   uint32_t l = crc ^ 0xffffffffu;
 
-  // Advance p until aligned to 8-bytes..
-  // Point x at first 7-byte aligned byte in string.  This might be
+  // Point x at first 8-byte aligned byte in string.  This might be
   // just past the end of the string.
   const uintptr_t pval = reinterpret_cast<uintptr_t>(p);
   const uint8_t *x = reinterpret_cast<const uint8_t *>(((pval + 7) >> 3) << 3);
   if (x <= e) {
-    // Process bytes until finished or p is 8-byte aligned
+    // Process bytes until finished or p is 8-byte aligned.
     while (p != x) {
-      l = _mm_crc32_u8(l, *p);
+      l = HwCrcByte(l, *p);
       p++;
     }
   }
 
-  // Process bytes 16 at a time
-  uint64_t l64 = l;
+  // Process bytes 16 at a time.
   while ((e - p) >= 16) {
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p));
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p + 8));
+    l = HwCrcWord(l, *reinterpret_cast<const uint64_t *>(p));
+    l = HwCrcWord(l, *reinterpret_cast<const uint64_t *>(p + 8));
     p += 16;
   }
 
+  // Process bytes 8 at a time.
+  while ((e - p) >= 8) {
+    l = HwCrcWord(l, *reinterpret_cast<const uint64_t *>(p));
+    p += 8;
+  }
+
   // Process remaining bytes one at a time.
-  l = l64;
   while (p < e) {
-    l = _mm_crc32_u8(l, *p);
+    l = HwCrcByte(l, *p);
     p++;
   }
 
   return l ^ 0xffffffffu;
 }
 
+}  // namespace
+
+uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+  const uint8_t *e = p + size;
+
+  if (size >= 3 * kInterleaveBlockSize) {
+    const CrcShiftOperator &shift = BlockShift();
+    while (static_cast<size_t>(e - p) >= 3 * kInterleaveBlockSize) {
+      uint32_t v0, v1, v2;
+      HwCrc3WayBlock(p, &v0, &v1, &v2);
+      crc = Gf2MatrixTimes(shift.mat, crc) ^ v0;
+      crc = Gf2MatrixTimes(shift.mat, crc) ^ v1;
+      crc = Gf2MatrixTimes(shift.mat, crc) ^ v2;
+      p += 3 * kInterleaveBlockSize;
+    }
+  }
+
+  return HwExtend(crc, p, e);
+}
+
 #endif
 
 }  // namespace crc32c
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include <algorithm>
+#include <string>
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -62,6 +64,31 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, LargeBuffers) {
+  // Buffers this size take the chunk-interleaved hardware path; checksumming
+  // the same bytes in small increments takes the single-stream path, so the
+  // two must agree around the chunking thresholds.
+  std::string data(1 << 18, 0);
+  uint32 seed = 1;
+  for (size_t i = 0; i < data.size(); i++) {
+    seed = seed * 1664525 + 1013904223;
+    data[i] = static_cast<char>(seed >> 24);
+  }
+  for (size_t len : {size_t(3071), size_t(3072), size_t(3073), size_t(6144),
+                     size_t(10000), data.size()}) {
+    uint32 expected = 0;
+    for (size_t i = 0; i < len; i += 97) {
+      size_t n = std::min(size_t(97), len - i);
+      expected = Extend(expected, data.data() + i, n);
+    }
+    ASSERT_EQ(expected, Value(data.data(), len)) << "len=" << len;
+    // Unaligned start.
+    ASSERT_EQ(Extend(Value(data.data(), 3), data.data() + 3, len - 3),
+              Value(data.data(), len))
+        << "len=" << len;
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -0,0 +1,92 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_cache.h"
+
+#include <string.h>
+
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/block.h"
+
+namespace tensorflow {
+namespace table {
+
+size_t BlockCache::KeyHash::operator()(const Key& key) const {
+  char buf[sizeof(uint64) * 2];
+  memcpy(buf, &key.cache_id, sizeof(uint64));
+  memcpy(buf + sizeof(uint64), &key.offset, sizeof(uint64));
+  return Hash64(buf, sizeof(buf));
+}
+
+BlockCache::BlockCache(size_t capacity_bytes)
+    : capacity_per_shard_((capacity_bytes + kNumShards - 1) / kNumShards) {}
+
+BlockCache::~BlockCache() {}
+
+uint64 BlockCache::NewId() {
+  mutex_lock l(id_mu_);
+  return next_id_++;
+}
+
+BlockCache::Shard* BlockCache::GetShard(const Key& key) {
+  return &shards_[KeyHash()(key) & (kNumShards - 1)];
+}
+
+std::shared_ptr<Block> BlockCache::Lookup(uint64 cache_id, uint64 offset) {
+  const Key key = {cache_id, offset};
+  Shard* shard = GetShard(key);
+  mutex_lock l(shard->mu);
+  auto it = shard->index.find(key);
+  if (it == shard->index.end()) {
+    return nullptr;
+  }
+  // Move the entry to the front of the LRU list.
+  shard->lru.splice(shard->lru.begin(), shard->lru, it->second);
+  return shard->lru.front().block;
+}
+
+void BlockCache::Insert(uint64 cache_id, uint64 offset,
+                        const std::shared_ptr<Block>& block, size_t charge) {
+  const Key key = {cache_id, offset};
+  Shard* shard = GetShard(key);
+  mutex_lock l(shard->mu);
+  auto it = shard->index.find(key);
+  if (it != shard->index.end()) {
+    shard->usage -= it->second->charge;
+    shard->lru.erase(it->second);
+    shard->index.erase(it);
+  }
+  shard->lru.push_front(Entry{key, block, charge});
+  shard->index[key] = shard->lru.begin();
+  shard->usage += charge;
+  while (shard->usage > capacity_per_shard_ && shard->lru.size() > 1) {
+    const Entry& oldest = shard->lru.back();
+    shard->usage -= oldest.charge;
+    shard->index.erase(oldest.key);
+    shard->lru.pop_back();
+  }
+}
+
+size_t BlockCache::Usage() const {
+  size_t usage = 0;
+  for (int i = 0; i < kNumShards; i++) {
+    mutex_lock l(shards_[i].mu);
+    usage += shards_[i].usage;
+  }
+  return usage;
+}
+
+}  // namespace table
+}  // namespace tensorflow
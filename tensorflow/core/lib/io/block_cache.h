@@ -0,0 +1,112 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_BLOCK_CACHE_H_
+#define TENSORFLOW_CORE_LIB_IO_BLOCK_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace table {
+
+class Block;
+
+// A sharded LRU cache of decoded table blocks, keyed by (table id, block
+// offset within the table file). The configured capacity is split evenly
+// across shards, each guarded by its own mutex, so concurrent readers (e.g.
+// sharded bundle restores) mostly take disjoint locks.
+//
+// The cache does not own the tables it serves; blocks are held by
+// shared_ptr, so a block evicted while a lookup result is still in use stays
+// alive until the last reader releases it.
+//
+// Safe for concurrent use by multiple threads.
+class BlockCache {
+ public:
+  // Creates a cache holding up to approximately `capacity_bytes` of decoded
+  // block data.
+  explicit BlockCache(size_t capacity_bytes);
+  ~BlockCache();
+
+  // Returns a new id. Tables sharing this cache use the id to partition the
+  // key space, so blocks of different tables never collide.
+  uint64 NewId();
+
+  // Returns the block cached under (cache_id, offset), or nullptr on a miss.
+  // A hit moves the block to the front of its shard's LRU list.
+  std::shared_ptr<Block> Lookup(uint64 cache_id, uint64 offset);
+
+  // Inserts `block` under (cache_id, offset), charging `charge` bytes
+  // against the cache capacity and evicting least recently used blocks as
+  // needed. An existing entry with the same key is replaced.
+  void Insert(uint64 cache_id, uint64 offset,
+              const std::shared_ptr<Block>& block, size_t charge);
+
+  // Total bytes currently charged across all shards.
+  size_t Usage() const;
+
+ private:
+  static const int kNumShardBits = 4;
+  static const int kNumShards = 1 << kNumShardBits;
+
+  struct Key {
+    uint64 cache_id;
+    uint64 offset;
+
+    bool operator==(const Key& other) const {
+      return cache_id == other.cache_id && offset == other.offset;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<Block> block;
+    size_t charge;
+  };
+
+  // Most recently used entries are at the front of `lru`.
+  struct Shard {
+    mutable mutex mu;
+    size_t usage GUARDED_BY(mu) = 0;
+    std::list<Entry> lru GUARDED_BY(mu);
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index
+        GUARDED_BY(mu);
+  };
+
+  Shard* GetShard(const Key& key);
+
+  const size_t capacity_per_shard_;
+  Shard shards_[kNumShards];
+
+  mutex id_mu_;
+  uint64 next_id_ GUARDED_BY(id_mu_) = 1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockCache);
+};
+
+}  // namespace table
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_BLOCK_CACHE_H_
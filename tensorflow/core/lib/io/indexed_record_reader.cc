@@ -0,0 +1,137 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/indexed_record_reader.h"
+
+#include <string.h>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+
+namespace {
+
+// Reads exactly "n" bytes at "offset" into "scratch", moving the data into
+// place if the file returned a pointer into its own buffer.
+Status ReadExactly(const RandomAccessFile* file, uint64 offset, size_t n,
+                   char* scratch) {
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(offset, n, &result, scratch));
+  if (result.data() != scratch) {
+    memmove(scratch, result.data(), n);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+IndexedRecordReader::IndexedRecordReader(RandomAccessFile* file)
+    : file_(file) {}
+
+Status IndexedRecordReader::Init(uint64 file_size) {
+  // Format of the index footer (see record_writer.h):
+  //  uint64    offset[i] for each of the n records
+  //  uint64    n
+  //  uint32    masked crc of the offsets and of n
+  //  uint64    kIndexMagicNumber
+  if (file_size < RecordWriter::kIndexTrailerSize) {
+    return errors::NotFound("File is too small to contain an index footer");
+  }
+  char trailer[RecordWriter::kIndexTrailerSize];
+  TF_RETURN_IF_ERROR(ReadExactly(file_, file_size - sizeof(trailer),
+                                 sizeof(trailer), trailer));
+  const uint64 magic =
+      core::DecodeFixed64(trailer + sizeof(uint64) + sizeof(uint32));
+  if (magic != RecordWriter::kIndexMagicNumber) {
+    return errors::NotFound("File does not contain an index footer");
+  }
+  const uint64 num_records = core::DecodeFixed64(trailer);
+  const uint32 masked_crc = core::DecodeFixed32(trailer + sizeof(uint64));
+
+  // The checksummed region covers the offset table and the record count.
+  const uint64 table_size = (num_records + 1) * sizeof(uint64);
+  if (num_records >= file_size / sizeof(uint64) ||
+      table_size + sizeof(uint32) + sizeof(uint64) > file_size) {
+    return errors::DataLoss("Corrupted index footer: implausible record count ",
+                            num_records);
+  }
+  string table;
+  table.resize(table_size);
+  const uint64 table_offset =
+      file_size - sizeof(uint32) - sizeof(uint64) - table_size;
+  TF_RETURN_IF_ERROR(ReadExactly(file_, table_offset, table_size, &table[0]));
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(table.data(), table.size())) {
+    return errors::DataLoss("Corrupted index footer at offset ", table_offset);
+  }
+
+  data_end_ = table_offset;
+  offsets_.clear();
+  offsets_.reserve(num_records);
+  for (uint64 i = 0; i < num_records; ++i) {
+    const uint64 offset =
+        core::DecodeFixed64(table.data() + i * sizeof(uint64));
+    if (offset >= data_end_ || (i > 0 && offset <= offsets_.back())) {
+      return errors::DataLoss("Corrupted index footer: record ", i,
+                              " has invalid offset ", offset);
+    }
+    offsets_.push_back(offset);
+  }
+  return Status::OK();
+}
+
+Status IndexedRecordReader::ReadRecord(uint64 index, string* record) const {
+  if (index >= offsets_.size()) {
+    return errors::InvalidArgument("Record index ", index,
+                                   " is out of range. (File contains ",
+                                   offsets_.size(), " records.)");
+  }
+  const uint64 offset = offsets_[index];
+
+  // Read and verify the record header.
+  char header[RecordReader::kHeaderSize];
+  TF_RETURN_IF_ERROR(ReadExactly(file_, offset, sizeof(header), header));
+  const uint32 masked_length_crc =
+      core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_length_crc) !=
+      crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  const uint64 length = core::DecodeFixed64(header);
+  if (offset + RecordReader::kHeaderSize + length + RecordReader::kFooterSize >
+      data_end_) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+
+  // Read the payload together with its checksum footer, then verify.
+  record->resize(length + RecordReader::kFooterSize);
+  TF_RETURN_IF_ERROR(ReadExactly(file_, offset + RecordReader::kHeaderSize,
+                                 record->size(), &(*record)[0]));
+  const uint32 masked_data_crc = core::DecodeFixed32(record->data() + length);
+  if (crc32c::Unmask(masked_data_crc) !=
+      crc32c::Value(record->data(), length)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  record->resize(length);
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,70 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_INDEXED_RECORD_READER_H_
+#define TENSORFLOW_CORE_LIB_IO_INDEXED_RECORD_READER_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class RandomAccessFile;
+
+namespace io {
+
+// Reads individual records from a TFRecord file that was written with
+// RecordWriterOptions::build_index set, using the offset table in the index
+// footer for O(1) random access by record number. See record_writer.h for
+// the footer format.
+//
+// Note: after a successful Init(), ReadRecord() is thread-safe; concurrent
+// reads of different (or the same) indices are permitted.
+class IndexedRecordReader {
+ public:
+  // Create a reader for records of "*file". "*file" must remain live while
+  // this Reader is in use.
+  explicit IndexedRecordReader(RandomAccessFile* file);
+
+  // Reads and verifies the index footer. "file_size" must be the total size
+  // of the file in bytes. Returns NOT_FOUND if the file does not end in an
+  // index footer, or DATA_LOSS if the footer fails its checksum.
+  Status Init(uint64 file_size);
+
+  // Returns the number of records in the file. Requires a successful Init().
+  uint64 NumRecords() const { return offsets_.size(); }
+
+  // Reads the record at position "index" into *record. Returns OK on
+  // success, INVALID_ARGUMENT if "index" is out of range, or DATA_LOSS if
+  // the record fails its checksum. Requires a successful Init().
+  Status ReadRecord(uint64 index, string* record) const;
+
+ private:
+  RandomAccessFile* file_;  // Not owned.
+  // Byte offset of each record, decoded from the index footer.
+  std::vector<uint64> offsets_;
+  // Offset one past the end of the last record (where the footer begins).
+  uint64 data_end_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IndexedRecordReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_INDEXED_RECORD_READER_H_
@@ -17,17 +17,212 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <deque>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 
 namespace tensorflow {
 namespace io {
 
+// Reads the file sequentially in large chunks on a background thread, parses
+// and CRC-verifies the records as the chunks arrive, and hands the validated
+// records to ReadRecord() through a bounded queue.
+class RecordReader::ReadaheadWorker {
+ public:
+  ReadaheadWorker(RandomAccessFile* file, uint64 offset, size_t chunk_size)
+      : file_(file), chunk_size_(chunk_size), start_offset_(offset) {
+    thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tf_record_readahead", [this]() { Work(); }));
+  }
+
+  ~ReadaheadWorker() {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      queue_not_full_.notify_all();
+    }
+    // Joins the readahead thread.
+    thread_.reset();
+  }
+
+  // Blocks until the next sequential record, an error, or end of file.
+  Status ReadRecord(uint64* offset, string* record) {
+    mutex_lock l(mu_);
+    while (queue_.empty() && !done_) {
+      queue_not_empty_.wait(l);
+    }
+    if (queue_.empty()) return status_;
+    ParsedRecord& front = queue_.front();
+    *record = std::move(front.data);
+    *offset = front.next_offset;
+    queued_bytes_ -= record->size();
+    queue_.pop_front();
+    queue_not_full_.notify_all();
+    return Status::OK();
+  }
+
+ private:
+  struct ParsedRecord {
+    uint64 next_offset;
+    string data;
+  };
+
+  // A chunk read handed to RandomAccessFile::ReadAsync(); `done` is notified
+  // once `status` and `result` are filled in.
+  struct PendingChunk {
+    Notification done;
+    Status status;
+    StringPiece result;
+  };
+
+  // Starts an asynchronous read of chunk_size_ bytes at `offset` into
+  // `scratch`.
+  std::unique_ptr<PendingChunk> IssueRead(char* scratch, uint64 offset) {
+    std::unique_ptr<PendingChunk> chunk(new PendingChunk);
+    PendingChunk* c = chunk.get();
+    file_->ReadAsync(offset, chunk_size_, scratch,
+                     [c](const Status& status, StringPiece result) {
+                       c->status = status;
+                       c->result = result;
+                       c->done.Notify();
+                     });
+    return chunk;
+  }
+
+  void Work() {
+    uint64 file_offset = start_offset_;
+    // Bytes read from the file but not yet parsed into complete records,
+    // starting at file offset `pending_offset`.
+    string pending;
+    uint64 pending_offset = start_offset_;
+    // Double-buffered chunk reads: while one chunk is parsed and
+    // CRC-verified, the read of the next chunk is already in flight.
+    std::unique_ptr<char[]> scratch[2] = {
+        std::unique_ptr<char[]>(new char[chunk_size_]),
+        std::unique_ptr<char[]>(new char[chunk_size_])};
+    std::unique_ptr<PendingChunk> in_flight[2];
+    // Whichever way Work() returns, wait for any read still in flight before
+    // the scratch buffers go out of scope.
+    auto drain = gtl::MakeCleanup([&in_flight] {
+      for (int i = 0; i < 2; ++i) {
+        if (in_flight[i] != nullptr) in_flight[i]->done.WaitForNotification();
+      }
+    });
+    bool at_eof = false;
+    int cur = 0;
+    in_flight[cur] = IssueRead(scratch[cur].get(), file_offset);
+
+    while (!at_eof) {
+      PendingChunk* current = in_flight[cur].get();
+      current->done.WaitForNotification();
+      if (errors::IsOutOfRange(current->status)) {
+        at_eof = true;
+      } else if (!current->status.ok()) {
+        Finish(current->status);
+        return;
+      } else {
+        // An OK status implies a full chunk (Read() reports OUT_OF_RANGE for
+        // short reads), so the offset of the chunk after this one is already
+        // known; issue its read before parsing this chunk.
+        in_flight[1 - cur] =
+            IssueRead(scratch[1 - cur].get(), file_offset + chunk_size_);
+      }
+      const StringPiece chunk = current->result;
+      file_offset += chunk.size();
+      pending.append(chunk.data(), chunk.size());
+      cur = 1 - cur;
+
+      // Parse and verify all complete records in the pending buffer.
+      size_t parsed = 0;
+      while (pending.size() - parsed >= kHeaderSize) {
+        const char* header = pending.data() + parsed;
+        const uint64 length = core::DecodeFixed64(header);
+        const uint32 masked_length_crc =
+            core::DecodeFixed32(header + sizeof(uint64));
+        if (crc32c::Unmask(masked_length_crc) !=
+            crc32c::Value(header, sizeof(uint64))) {
+          Finish(
+              errors::DataLoss("corrupted record at ", pending_offset + parsed));
+          return;
+        }
+        if (length >= SIZE_MAX - kHeaderSize - kFooterSize) {
+          Finish(errors::DataLoss("record size too large"));
+          return;
+        }
+        const size_t record_size = kHeaderSize + length + kFooterSize;
+        if (pending.size() - parsed < record_size) break;
+        const char* data = header + kHeaderSize;
+        const uint32 masked_data_crc = core::DecodeFixed32(data + length);
+        if (crc32c::Unmask(masked_data_crc) != crc32c::Value(data, length)) {
+          Finish(
+              errors::DataLoss("corrupted record at ", pending_offset + parsed));
+          return;
+        }
+        ParsedRecord record;
+        record.data.assign(data, length);
+        record.next_offset = pending_offset + parsed + record_size;
+        parsed += record_size;
+        if (!Push(std::move(record))) return;  // Cancelled.
+      }
+      pending.erase(0, parsed);
+      pending_offset += parsed;
+    }
+
+    if (pending.empty()) {
+      Finish(errors::OutOfRange("eof"));
+    } else {
+      Finish(errors::DataLoss("truncated record at ", pending_offset));
+    }
+  }
+
+  // Appends a validated record to the queue, blocking while a chunk's worth
+  // of records is already queued. Returns false if the worker was cancelled.
+  bool Push(ParsedRecord record) {
+    mutex_lock l(mu_);
+    while (queued_bytes_ >= chunk_size_ && !cancelled_) {
+      queue_not_full_.wait(l);
+    }
+    if (cancelled_) return false;
+    queued_bytes_ += record.data.size();
+    queue_.push_back(std::move(record));
+    queue_not_empty_.notify_all();
+    return true;
+  }
+
+  void Finish(Status status) {
+    mutex_lock l(mu_);
+    status_ = status;
+    done_ = true;
+    queue_not_empty_.notify_all();
+  }
+
+  RandomAccessFile* file_;  // Not owned.
+  const size_t chunk_size_;
+  const uint64 start_offset_;
+
+  mutex mu_;
+  condition_variable queue_not_empty_;
+  condition_variable queue_not_full_;
+  std::deque<ParsedRecord> queue_ GUARDED_BY(mu_);
+  size_t queued_bytes_ GUARDED_BY(mu_) = 0;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+  bool done_ GUARDED_BY(mu_) = false;
+  Status status_ GUARDED_BY(mu_);
+
+  // Must be declared last so the worker starts after all other members are
+  // initialized.
+  std::unique_ptr<Thread> thread_;
+};
+
 RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     const string& compression_type) {
   RecordReaderOptions options;
@@ -46,6 +241,12 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -57,8 +258,14 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
     : options_(options),
+      file_(file),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
+  if (options.readahead_buffer_size > 0 &&
+      options.compression_type != RecordReaderOptions::NONE) {
+    LOG(WARNING) << "Readahead is not supported for compressed records and "
+                 << "will be ignored.";
+  }
   if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
@@ -71,6 +278,20 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
+#endif  // IS_SLIM_BUILD
+  } else if (options.compression_type ==
+             RecordReaderOptions::SNAPPY_COMPRESSION) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    // SnappyInputBuffer reads and buffers the file itself. The input buffer
+    // must be able to hold a whole compressed block; the writer compresses
+    // blocks of at most 1 MB of input (see record_writer.cc), which may
+    // expand slightly when incompressible, so double that is always enough.
+    static const int kSnappyInputBufferSizeBytes = 2 << 20;   // 2 MB
+    static const int kSnappyOutputBufferSizeBytes = 1 << 20;  // 1 MB
+    input_stream_.reset(new SnappyInputBuffer(file, kSnappyInputBufferSizeBytes,
+                                              kSnappyOutputBufferSizeBytes));
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
@@ -161,7 +382,27 @@ Status RecordReader::GetMetadata(Metadata* md) {
   return Status::OK();
 }
 
+RecordReader::~RecordReader() {}
+
 Status RecordReader::ReadRecord(uint64* offset, string* record) {
+  if (options_.readahead_buffer_size > 0 &&
+      options_.compression_type == RecordReaderOptions::NONE) {
+    if (readahead_ == nullptr || *offset != readahead_next_offset_) {
+      // (Re)start the readahead at the requested offset.
+      readahead_.reset(new ReadaheadWorker(
+          file_, *offset, static_cast<size_t>(options_.readahead_buffer_size)));
+    }
+    Status s = readahead_->ReadRecord(offset, record);
+    if (s.ok()) {
+      readahead_next_offset_ = *offset;
+    } else {
+      // Drop the worker so a retry at the same offset (e.g. on a growing
+      // file) re-reads the file instead of re-reporting the same status.
+      readahead_.reset();
+    }
+    return s;
+  }
+
   // Position the input stream.
   int64 curr_pos = input_stream_->Tell();
   int64 desired_pos = static_cast<int64>(*offset);
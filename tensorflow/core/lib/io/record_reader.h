@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/snappy/snappy_inputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
@@ -34,7 +35,12 @@ namespace io {
 
 class RecordReaderOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    // See RecordWriterOptions; decodes several times faster than ZLIB.
+    SNAPPY_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
   // If buffer_size is non-zero, then all reads must be sequential, and no
@@ -42,6 +48,14 @@ class RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If non-zero and no compression is in use, the reader issues large
+  // background reads of approximately this many bytes (e.g. 16 MB) and
+  // verifies record checksums on the readahead thread, so sequential scans
+  // are not bottlenecked on per-record synchronous I/O. Reads should then be
+  // sequential: reading at an unexpected offset restarts the readahead
+  // there.
+  int64 readahead_buffer_size = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -84,7 +98,7 @@ class RecordReader {
       RandomAccessFile* file,
       const RecordReaderOptions& options = RecordReaderOptions());
 
-  virtual ~RecordReader() = default;
+  virtual ~RecordReader();
 
   // Read the record at "*offset" into *record and update *offset to
   // point to the offset of the next record.  Returns OK on success,
@@ -103,12 +117,20 @@ class RecordReader {
   Status GetMetadata(Metadata* md);
 
  private:
+  class ReadaheadWorker;
+
   Status ReadChecksummed(uint64 offset, size_t n, string* result);
 
   RecordReaderOptions options_;
+  RandomAccessFile* file_;  // Not owned.
   std::unique_ptr<InputStreamInterface> input_stream_;
   bool last_read_failed_;
 
+  // Non-null iff readahead mode is active.
+  std::unique_ptr<ReadaheadWorker> readahead_;
+  // Offset at which the next sequential readahead record starts.
+  uint64 readahead_next_offset_ = 0;
+
   std::unique_ptr<Metadata> cached_metadata_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordReader);
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/lib/io/indexed_record_reader.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 
@@ -158,6 +159,121 @@ TEST(RecordReaderWriterTest, TestBasics) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadahead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_readahead_test";
+
+  const int kNumRecords = 100;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < kNumRecords; i++) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record-", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  // Use small chunks so records regularly straddle chunk boundaries.
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.readahead_buffer_size = buf_size;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    string record;
+    for (int i = 0; i < kNumRecords; i++) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record-", i), record);
+    }
+    CHECK_EQ(reader.ReadRecord(&offset, &record).code(), error::OUT_OF_RANGE);
+  }
+
+  // Re-reading from an already consumed offset restarts the readahead.
+  {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.readahead_buffer_size = 1 << 20;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    string record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("record-0", record);
+    offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("record-0", record);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndexedRandomAccess) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_indexed_test";
+
+  const int kNumRecords = 100;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+    io::RecordWriterOptions options;
+    options.build_index = true;
+    io::RecordWriter writer(file.get(), options);
+    for (int i = 0; i < kNumRecords; i++) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record-", i)));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+
+  // The footer does not disturb a plain sequential read of the records.
+  {
+    io::RecordReader reader(read_file.get());
+    uint64 offset = 0;
+    string record;
+    for (int i = 0; i < kNumRecords; i++) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record-", i), record);
+    }
+  }
+
+  io::IndexedRecordReader reader(read_file.get());
+  TF_CHECK_OK(reader.Init(GetFileSize(fname)));
+  EXPECT_EQ(kNumRecords, reader.NumRecords());
+
+  // Records can be read in any order.
+  string record;
+  for (int i = kNumRecords - 1; i >= 0; i--) {
+    TF_CHECK_OK(reader.ReadRecord(i, &record));
+    EXPECT_EQ(strings::StrCat("record-", i), record);
+  }
+  CHECK_EQ(reader.ReadRecord(kNumRecords, &record).code(),
+           error::INVALID_ARGUMENT);
+}
+
+TEST(RecordReaderWriterTest, TestIndexMissing) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_unindexed_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::IndexedRecordReader reader(read_file.get());
+  CHECK_EQ(reader.Init(GetFileSize(fname)).code(), error::NOT_FOUND);
+}
+
 TEST(RecordReaderWriterTest, TestZlib) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_zlib_test";
@@ -196,6 +312,43 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestSnappy) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+    io::RecordWriterOptions options;
+    options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+    io::RecordWriter writer(file.get(), options);
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    // A record large enough to span compressed blocks.
+    string big(1 << 21, 'x');
+    TF_EXPECT_OK(writer.WriteRecord(big));
+    TF_CHECK_OK(writer.Close());
+  }
+
+  {
+    std::unique_ptr<RandomAccessFile> read_file;
+    // Read it back with the RecordReader.
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    string record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("abc", record);
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("defg", record);
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(string(1 << 21, 'x'), record);
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
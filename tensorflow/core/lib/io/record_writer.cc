@@ -26,6 +26,17 @@ namespace {
 bool IsZlibCompressed(RecordWriterOptions options) {
   return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION;
 }
+
+bool IsSnappyCompressed(RecordWriterOptions options) {
+  return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
+}
+
+// Snappy does its own framing, so there are no tunable codec options; these
+// buffer sizes bound the uncompressed block size in the output file. The
+// reader's input buffer must be able to hold a whole compressed block (see
+// record_reader.cc), so keep these in sync with the reader's constants.
+const int kSnappyInputBufferSizeBytes = 1 << 20;   // 1 MB
+const int kSnappyOutputBufferSizeBytes = 1 << 20;  // 1 MB
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -46,6 +57,12 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -71,12 +88,25 @@ RecordWriter::RecordWriter(WritableFile* dest,
                  << s.ToString();
     }
     dest_ = zlib_output_buffer;
+#endif  // IS_SLIM_BUILD
+  } else if (IsSnappyCompressed(options)) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    dest_ = new SnappyOutputBuffer(dest, kSnappyInputBufferSizeBytes,
+                                   kSnappyOutputBufferSizeBytes);
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
+  if (options_.build_index &&
+      options_.compression_type != RecordWriterOptions::NONE) {
+    LOG(ERROR) << "An offset index cannot be built for a compressed record "
+               << "file. No index will be written.";
+    options_.build_index = false;
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -102,15 +132,44 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
   PopulateFooter(footer, data.data(), data.size());
+  if (options_.build_index) {
+    record_offsets_.push_back(bytes_written_);
+    bytes_written_ += kHeaderSize + data.size() + kFooterSize;
+  }
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
 }
 
+Status RecordWriter::WriteIndexFooter() {
+  // Format of the index footer:
+  //  uint64    offset[i] for each of the n records
+  //  uint64    n
+  //  uint32    masked crc of the offsets and of n
+  //  uint64    kIndexMagicNumber
+  string table;
+  table.reserve((record_offsets_.size() + 1) * sizeof(uint64));
+  for (uint64 offset : record_offsets_) {
+    core::PutFixed64(&table, offset);
+  }
+  core::PutFixed64(&table, record_offsets_.size());
+  char trailer[sizeof(uint32) + sizeof(uint64)];
+  core::EncodeFixed32(trailer, MaskedCrc(table.data(), table.size()));
+  core::EncodeFixed64(trailer + sizeof(uint32), kIndexMagicNumber);
+  TF_RETURN_IF_ERROR(dest_->Append(table));
+  return dest_->Append(StringPiece(trailer, sizeof(trailer)));
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
+  if (options_.build_index) {
+    // Disable index building so a second Close() does not append the footer
+    // again.
+    options_.build_index = false;
+    TF_RETURN_IF_ERROR(WriteIndexFooter());
+  }
 #if !defined(IS_SLIM_BUILD)
-  if (IsZlibCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -125,7 +184,7 @@ Status RecordWriter::Flush() {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
                   "Writer not initialized or previously closed");
   }
-  if (IsZlibCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     return dest_->Flush();
   }
   return Status::OK();
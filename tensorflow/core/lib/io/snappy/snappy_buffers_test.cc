@@ -55,7 +55,8 @@ Status TestMultipleWrites(size_t compress_input_buf_size,
                           size_t uncompress_input_buf_size,
                           size_t uncompress_output_buf_size, int num_writes = 1,
                           bool with_flush = false, int num_copies = 1,
-                          bool corrupt_compressed_file = false) {
+                          bool corrupt_compressed_file = false,
+                          int num_decompression_threads = 0) {
   Env* env = Env::Default();
 
   string fname = testing::TmpDir() + "/snappy_buffers_test";
@@ -115,7 +116,8 @@ Status TestMultipleWrites(size_t compress_input_buf_size,
   std::unique_ptr<RandomAccessFile> file_reader;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(fname, &file_reader));
   io::SnappyInputBuffer in(file_reader.get(), uncompress_input_buf_size,
-                           uncompress_output_buf_size);
+                           uncompress_output_buf_size,
+                           num_decompression_threads);
 
   // Run the test twice, resetting the stream after the first attempt.
   for (int attempt = 0; attempt < 2; ++attempt) {
@@ -156,6 +158,27 @@ TEST(SnappyBuffers, MultipleWriteCallsWithFlush) {
   TF_CHECK_OK(TestMultipleWrites(10000, 10000, 10000, 10000, 2, true));
 }
 
+TEST(SnappyBuffers, MultipleWritesParallelDecompression) {
+  if (!SnappyCompressionSupported()) {
+    fprintf(stderr, "skipping compression tests\n");
+    return;
+  }
+  // Many small blocks keep several decompression jobs in flight at once.
+  TF_CHECK_OK(TestMultipleWrites(1000, 1000, 10000, 10000, 20, true, 1, false,
+                                 4 /* num_decompression_threads */));
+}
+
+TEST(SnappyBuffers, CorruptBlockParallelDecompression) {
+  if (!SnappyCompressionSupported()) {
+    fprintf(stderr, "skipping compression tests\n");
+    return;
+  }
+  CHECK_EQ(TestMultipleWrites(10000, 10000, 700, 10000, 2, true, 1, true,
+                              4 /* num_decompression_threads */),
+           errors::DataLoss("Failed to read ", COMPRESSED_RECORD_SIZE,
+                            " bytes from file. ", "Possible data corruption."));
+}
+
 TEST(SnappyBuffers, SmallUncompressInputBuffer) {
   if (!SnappyCompressionSupported()) {
     fprintf(stderr, "skipping compression tests\n");
@@ -20,14 +20,22 @@ namespace io {
 SnappyInputBuffer::SnappyInputBuffer(
     RandomAccessFile* file,
     size_t input_buffer_bytes,  // size of input_buffer_
-    size_t output_buffer_bytes  // size of output_buffer_
-    )
+    size_t output_buffer_bytes,  // size of output_buffer_
+    int num_decompression_threads)
     : file_(file),
       input_buffer_capacity_(input_buffer_bytes),
       output_buffer_capacity_(output_buffer_bytes),
       input_buffer_(new char[input_buffer_capacity_]),
       output_buffer_(new char[output_buffer_capacity_]),
-      next_in_(input_buffer_.get()) {}
+      next_in_(input_buffer_.get()),
+      num_decompression_threads_(num_decompression_threads) {
+  if (num_decompression_threads_ > 0) {
+    decode_pool_.reset(new thread::ThreadPool(Env::Default(), "snappy_decode",
+                                              num_decompression_threads_));
+  }
+}
+
+SnappyInputBuffer::~SnappyInputBuffer() { DrainDecompressionPipeline(); }
 
 Status SnappyInputBuffer::ReadNBytes(int64 bytes_to_read, string* result) {
   result->clear();
@@ -39,7 +47,11 @@ Status SnappyInputBuffer::ReadNBytes(int64 bytes_to_read, string* result) {
     DCHECK(avail_out_ == 0);
 
     // Now that the cache is empty we need to inflate more data.
-    TF_RETURN_IF_ERROR(Inflate());
+    if (decode_pool_ != nullptr) {
+      TF_RETURN_IF_ERROR(InflateParallel());
+    } else {
+      TF_RETURN_IF_ERROR(Inflate());
+    }
 
     bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
   }
@@ -53,6 +65,9 @@ int64 SnappyInputBuffer::Tell() const {
 }
 
 Status SnappyInputBuffer::Reset() {
+  DrainDecompressionPipeline();
+  current_job_.reset();
+  pending_status_ = Status::OK();
   file_pos_ = 0;
   avail_in_ = 0;
   avail_out_ = 0;
@@ -119,6 +134,95 @@ Status SnappyInputBuffer::Inflate() {
   return Status::OK();
 }
 
+Status SnappyInputBuffer::InflateParallel() {
+  FillDecompressionPipeline();
+  if (inflight_.empty()) {
+    // The pipeline could not be filled at all, so the error that stopped it
+    // is due now.
+    return pending_status_;
+  }
+  current_job_ = std::move(inflight_.front());
+  inflight_.pop_front();
+  current_job_->done.WaitForNotification();
+  TF_RETURN_IF_ERROR(current_job_->status);
+
+  // Output buffer must have been cleared before uncompressing more input.
+  DCHECK_EQ(avail_out_, 0);
+  avail_out_ = current_job_->uncompressed.size();
+  next_out_ = avail_out_ > 0 ? &current_job_->uncompressed[0] : nullptr;
+
+  // Top the pipeline back up so decompression overlaps with the caller
+  // consuming this block.
+  FillDecompressionPipeline();
+  return Status::OK();
+}
+
+void SnappyInputBuffer::FillDecompressionPipeline() {
+  while (pending_status_.ok() &&
+         static_cast<int>(inflight_.size()) < num_decompression_threads_) {
+    uint32 compressed_block_length;
+    Status s = ReadCompressedBlockLength(&compressed_block_length);
+    if (!s.ok()) {
+      pending_status_ = s;
+      return;
+    }
+
+    // If the entire block is not in cache do a read from file.
+    if (avail_in_ < compressed_block_length) {
+      s = ReadFromFile();
+      if (s.ok() && avail_in_ < compressed_block_length) {
+        if (compressed_block_length > input_buffer_capacity_) {
+          s = errors::ResourceExhausted(
+              "Input buffer(size: ", input_buffer_capacity_,
+              " bytes) too small. Should be larger ", "than ",
+              compressed_block_length, " bytes.");
+        } else {
+          s = errors::DataLoss(
+              strings::StrCat("Failed to read ", compressed_block_length,
+                              " bytes from file. Possible data corruption."));
+        }
+      }
+      if (!s.ok()) {
+        pending_status_ = s;
+        return;
+      }
+    }
+
+    std::unique_ptr<DecompressionJob> job(new DecompressionJob);
+    job->compressed.assign(next_in_, compressed_block_length);
+    next_in_ += compressed_block_length;
+    avail_in_ -= compressed_block_length;
+
+    DecompressionJob* job_ptr = job.get();
+    decode_pool_->Schedule([job_ptr]() {
+      size_t uncompressed_length;
+      if (!port::Snappy_GetUncompressedLength(job_ptr->compressed.data(),
+                                              job_ptr->compressed.size(),
+                                              &uncompressed_length)) {
+        job_ptr->status =
+            errors::DataLoss("Parsing error in Snappy_GetUncompressedLength");
+      } else {
+        job_ptr->uncompressed.resize(uncompressed_length);
+        if (!port::Snappy_Uncompress(
+                job_ptr->compressed.data(), job_ptr->compressed.size(),
+                uncompressed_length > 0 ? &job_ptr->uncompressed[0]
+                                        : nullptr)) {
+          job_ptr->status = errors::DataLoss("Snappy_Uncompress failed");
+        }
+      }
+      job_ptr->done.Notify();
+    });
+    inflight_.push_back(std::move(job));
+  }
+}
+
+void SnappyInputBuffer::DrainDecompressionPipeline() {
+  for (auto& job : inflight_) {
+    job->done.WaitForNotification();
+  }
+  inflight_.clear();
+}
+
 Status SnappyInputBuffer::ReadCompressedBlockLength(uint32* length) {
   *length = 0;
   size_t bytes_to_read = 4;
@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_LIB_IO_SNAPPY_INPUTBUFFER_H_
 #define TENSORFLOW_LIB_IO_SNAPPY_INPUTBUFFER_H_
 
+#include <deque>
+#include <memory>
 #include <string>
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -38,8 +42,18 @@ class SnappyInputBuffer : public InputStreamInterface {
   // `input_buffer_bytes` bytes for reading contents from `file` and another
   // buffer with size `output_buffer_bytes` for caching decompressed contents.
   // Does *not* take ownership of "file".
+  //
+  // If `num_decompression_threads` is greater than zero, up to that many
+  // compressed blocks are decompressed concurrently on a private thread pool
+  // and delivered in order, so sequential scans are not bound to a single
+  // decompression thread. Zero (the default) decompresses serially on the
+  // reading thread.
   SnappyInputBuffer(RandomAccessFile* file, size_t input_buffer_bytes,
-                    size_t output_buffer_bytes);
+                    size_t output_buffer_bytes,
+                    int num_decompression_threads = 0);
+
+  // Waits for any in-flight decompression work before destroying the pool.
+  ~SnappyInputBuffer() override;
 
   // Reads bytes_to_read bytes into *result, overwriting *result.
   //
@@ -92,6 +106,29 @@ class SnappyInputBuffer : public InputStreamInterface {
   // The length is stored in 4 bytes in little endian notation.
   Status ReadCompressedBlockLength(uint32* length);
 
+  // A compressed block being decompressed on `decode_pool_`.
+  struct DecompressionJob {
+    string compressed;
+    string uncompressed;
+    Status status;
+    Notification done;
+  };
+
+  // Delivers the next decompressed block when running with a decode pool.
+  // Waits for the oldest in-flight block, makes its output readable through
+  // `next_out_`/`avail_out_`, and tops the pipeline back up.
+  Status InflateParallel();
+
+  // Reads compressed blocks off `input_buffer_`/`file_` and schedules their
+  // decompression until `num_decompression_threads_` blocks are in flight or
+  // an error (including EOF) is hit. The error is stored in
+  // `pending_status_` and reported once all in-flight blocks have been
+  // consumed, matching the serial mode's error ordering.
+  void FillDecompressionPipeline();
+
+  // Waits for all in-flight blocks and discards them.
+  void DrainDecompressionPipeline();
+
   RandomAccessFile* file_;         // Not owned
   int64 file_pos_ = 0;             // Next position to read from in `file_`
   size_t input_buffer_capacity_;   // Size of `input_buffer_`.
@@ -119,6 +156,24 @@ class SnappyInputBuffer : public InputStreamInterface {
   // Number of unread bytes bytes available at `next_out_` in `output_buffer_`.
   size_t avail_out_ = 0;
 
+  // Maximum number of blocks decompressed concurrently. Zero means serial
+  // decompression on the reading thread.
+  const int num_decompression_threads_;
+
+  // Non-null iff `num_decompression_threads_` > 0.
+  std::unique_ptr<thread::ThreadPool> decode_pool_;
+
+  // Blocks scheduled on `decode_pool_`, oldest first.
+  std::deque<std::unique_ptr<DecompressionJob>> inflight_;
+
+  // Block currently being consumed; `next_out_` points into its
+  // `uncompressed` string.
+  std::unique_ptr<DecompressionJob> current_job_;
+
+  // First error hit while filling the pipeline; delivered after all
+  // in-flight blocks have been consumed.
+  Status pending_status_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(SnappyInputBuffer);
 };
 
@@ -57,25 +57,54 @@ Status SnappyOutputBuffer::Write(StringPiece data) {
 
   // `data` is too large to fit in input buffer so we deflate it directly.
   // Note that at this point we have already deflated all existing input so
-  // we do not need to backup next_in and avail_in.
-  next_in_ = const_cast<char*>(data.data());
-  avail_in_ = bytes_to_write;
+  // we do not need to backup next_in and avail_in. We compress at most
+  // input_buffer_capacity_ bytes at a time so that no block in the output
+  // stream has an uncompressed length larger than readers expect (see
+  // SnappyInputBuffer).
+  while (bytes_to_write > 0) {
+    const size_t chunk = std::min(bytes_to_write, input_buffer_capacity_);
+    next_in_ = const_cast<char*>(data.data());
+    avail_in_ = chunk;
 
-  TF_RETURN_IF_ERROR(Deflate());
+    TF_RETURN_IF_ERROR(Deflate());
+
+    DCHECK(avail_in_ == 0);  // All input will be used up.
 
-  DCHECK(avail_in_ == 0);  // All input will be used up.
+    data.remove_prefix(chunk);
+    bytes_to_write -= chunk;
+  }
 
   next_in_ = input_buffer_.get();
 
   return Status::OK();
 }
 
+Status SnappyOutputBuffer::Append(StringPiece data) { return Write(data); }
+
 Status SnappyOutputBuffer::Flush() {
   TF_RETURN_IF_ERROR(DeflateBuffered());
   TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
   return Status::OK();
 }
 
+Status SnappyOutputBuffer::Close() {
+  // Given that we do not own `file`, we don't close it.
+  return Flush();
+}
+
+Status SnappyOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status SnappyOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status SnappyOutputBuffer::Tell(int64* position) {
+  return file_->Tell(position);
+}
+
 int32 SnappyOutputBuffer::AvailableInputSpace() const {
   return input_buffer_capacity_ - avail_in_;
 }
@@ -43,7 +43,11 @@ namespace io {
 // _compressed_ block _excluding_ this header. The compressed
 // block (excluding the 4 byte header) is a valid snappy block and can directly
 // be uncompressed using Snappy_Uncompress.
-class SnappyOutputBuffer {
+//
+// SnappyOutputBuffer is itself a WritableFile, so it can be stacked in front
+// of another WritableFile (e.g. by RecordWriter) the same way
+// ZlibOutputBuffer can.
+class SnappyOutputBuffer : public WritableFile {
  public:
   // Create an SnappyOutputBuffer for `file` with two buffers that cache the
   // 1. input data to be deflated
@@ -63,9 +67,26 @@ class SnappyOutputBuffer {
   // To immediately write contents to file call `Flush()`.
   Status Write(StringPiece data);
 
+  // Equivalent to `Write()`; implements the WritableFile interface.
+  Status Append(StringPiece data) override;
+
   // Compresses any cached input and writes all output to file. This must be
   // called before the destructor to avoid any data loss.
-  Status Flush();
+  Status Flush() override;
+
+  // Compresses any cached input and writes all output to file. Does *not*
+  // close `file`, which stays owned by the caller.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes this buffer and syncs the underlying file.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
 
  private:
   // Appends `data` to `input_buffer_`.
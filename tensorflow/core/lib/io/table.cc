@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/table.h"
 
+#include <memory>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
+#include "tensorflow/core/lib/io/block_cache.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/table_options.h"
 #include "tensorflow/core/lib/io/two_level_iterator.h"
@@ -32,7 +35,7 @@ struct Table::Rep {
   Options options;
   Status status;
   RandomAccessFile* file;
-  // XXX  uint64 cache_id;
+  uint64 cache_id;
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
@@ -73,8 +76,8 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     rep->file = file;
     rep->metaindex_handle = footer.metaindex_handle();
     rep->index_block = index_block;
-    // XXX    rep->cache_id = (options.block_cache ?
-    // options.block_cache->NewId() : 0);
+    rep->cache_id =
+        (options.block_cache ? options.block_cache->NewId() : 0);
     *table = new Table(rep);
   } else {
     if (index_block) delete index_block;
@@ -89,13 +92,17 @@ static void DeleteBlock(void* arg, void* ignored) {
   delete reinterpret_cast<Block*>(arg);
 }
 
+static void ReleaseSharedBlock(void* arg, void* ignored) {
+  delete reinterpret_cast<std::shared_ptr<Block>*>(arg);
+}
+
 // Convert an index iterator value (i.e., an encoded BlockHandle)
 // into an iterator over the contents of the corresponding block.
 Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
   Table* table = reinterpret_cast<Table*>(arg);
-  //  Cache* block_cache = table->rep_->options.block_cache;
+  BlockCache* block_cache = table->rep_->options.block_cache;
   Block* block = nullptr;
-  //  Cache::Handle* cache_handle = NULL;
+  std::shared_ptr<Block> shared_block;
 
   BlockHandle handle;
   StringPiece input = index_value;
@@ -104,15 +111,38 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
   // can add more features in the future.
 
   if (s.ok()) {
-    BlockContents contents;
-    s = ReadBlock(table->rep_->file, handle, &contents);
-    if (s.ok()) {
-      block = new Block(contents);
+    if (block_cache != nullptr) {
+      shared_block =
+          block_cache->Lookup(table->rep_->cache_id, handle.offset());
+      if (shared_block == nullptr) {
+        BlockContents contents;
+        s = ReadBlock(table->rep_->file, handle, &contents);
+        if (s.ok()) {
+          const bool cachable = contents.cachable;
+          shared_block.reset(new Block(contents));
+          if (cachable) {
+            block_cache->Insert(table->rep_->cache_id, handle.offset(),
+                                shared_block, shared_block->size());
+          }
+        }
+      }
+    } else {
+      BlockContents contents;
+      s = ReadBlock(table->rep_->file, handle, &contents);
+      if (s.ok()) {
+        block = new Block(contents);
+      }
     }
   }
 
   Iterator* iter;
-  if (block != nullptr) {
+  if (shared_block != nullptr) {
+    iter = shared_block->NewIterator();
+    // Keep a reference alive until the iterator is destroyed, even if the
+    // block gets evicted from the cache in the meantime.
+    iter->RegisterCleanup(&ReleaseSharedBlock,
+                          new std::shared_ptr<Block>(shared_block), nullptr);
+  } else if (block != nullptr) {
     iter = block->NewIterator();
     iter->RegisterCleanup(&DeleteBlock, block, nullptr);
   } else {
@@ -21,6 +21,8 @@ limitations under the License.
 namespace tensorflow {
 namespace table {
 
+class BlockCache;
+
 // DB contents are stored in a set of blocks, each of which holds a
 // sequence of key,value pairs.  Each block may be compressed before
 // being stored in a file.  The following enum describes which
@@ -60,6 +62,12 @@ struct Options {
   // incompressible, the kSnappyCompression implementation will
   // efficiently detect that and will switch to uncompressed mode.
   CompressionType compression = kSnappyCompression;
+
+  // If non-null, use the specified cache for blocks, so repeated reads of
+  // the same block hit memory instead of re-reading and decompressing from
+  // the file. The cache is not owned and must outlive any table using it; it
+  // may be shared between tables.
+  BlockCache* block_cache = nullptr;
 };
 
 }  // namespace table
@@ -0,0 +1,201 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_MONITORING_SHARDED_COUNTER_H_
+#define TENSORFLOW_CORE_LIB_MONITORING_SHARDED_COUNTER_H_
+
+#include <array>
+#include <atomic>
+#include <map>
+
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/monitoring/metric_def.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+namespace internal {
+
+// Number of shards in sharded metric cells. A power of two so the shard for
+// a thread can be picked with a mask.
+const int kCellShards = 16;
+
+// Returns the shard index for the calling thread. Threads are assigned
+// shards round-robin the first time they touch any sharded cell, so a given
+// thread always updates the same shard of every cell.
+inline int CurrentCellShard() {
+  static std::atomic<int> next_shard(0);
+  static thread_local int shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) & (kCellShards - 1);
+  return shard;
+}
+
+}  // namespace internal
+
+// ShardedCounterCell is a drop-in alternative to CounterCell for hot paths.
+//
+// A plain CounterCell is a single atomic, so concurrent increments from many
+// threads bounce one cache line between cores. ShardedCounterCell spreads
+// increments over per-thread shards, each on its own cache line, making
+// IncrementBy contention-free; value() sums the shards lazily, so reads are
+// proportionally more expensive and each cell costs a kilobyte of storage.
+// Use it for cells updated on kernel-dispatch-grade hot paths and the plain
+// Counter everywhere else.
+//
+// This class is thread-safe.
+class ShardedCounterCell {
+ public:
+  explicit ShardedCounterCell(int64 value) {
+    for (int i = 0; i < internal::kCellShards; ++i) {
+      shards_[i].value.store(0, std::memory_order_relaxed);
+    }
+    shards_[0].value.store(value, std::memory_order_relaxed);
+  }
+  ~ShardedCounterCell() {}
+
+  // Atomically increments the value by step.
+  // REQUIRES: Step be non-negative.
+  void IncrementBy(int64 step);
+
+  // Retrieves the current value by summing all shards.
+  int64 value() const;
+
+ private:
+  // Each shard occupies its own cache line so increments from different
+  // threads do not contend.
+  struct Shard {
+    std::atomic<int64> value;
+    char padding[64 - sizeof(std::atomic<int64>)];
+  };
+
+  Shard shards_[internal::kCellShards];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedCounterCell);
+};
+
+// A Counter variant whose cells are ShardedCounterCells.
+//
+// Identical to Counter in registration, labeling and collection semantics;
+// only the per-cell update path differs. See ShardedCounterCell above for
+// the cost trade-off.
+//
+// This class is thread-safe.
+template <int NumLabels>
+class ShardedCounter {
+ public:
+  ~ShardedCounter() {
+    // Deleted here, before the metric_def is destroyed.
+    registration_handle_.reset();
+  }
+
+  // Creates the metric based on the metric-definition arguments.
+  //
+  // Example;
+  // auto* counter_with_label = ShardedCounter<1>::New(
+  //   "/tensorflow/counter", "Tensorflow counter", "MyLabelName");
+  template <typename... MetricDefArgs>
+  static ShardedCounter* New(MetricDefArgs&&... metric_def_args);
+
+  // Retrieves the cell for the specified labels, creating it on demand if
+  // not already present.
+  template <typename... Labels>
+  ShardedCounterCell* GetCell(const Labels&... labels) LOCKS_EXCLUDED(mu_);
+
+ private:
+  explicit ShardedCounter(
+      const MetricDef<MetricKind::kCumulative, int64, NumLabels>& metric_def)
+      : metric_def_(metric_def),
+        registration_handle_(CollectionRegistry::Default()->Register(
+            &metric_def_, [&](MetricCollectorGetter getter) {
+              auto metric_collector = getter.Get(&metric_def_);
+
+              mutex_lock l(mu_);
+              for (const auto& cell : cells_) {
+                metric_collector.CollectValue(cell.first, cell.second.value());
+              }
+            })) {}
+
+  mutable mutex mu_;
+
+  // The metric definition. This will be used to identify the metric when we
+  // register it for collection.
+  const MetricDef<MetricKind::kCumulative, int64, NumLabels> metric_def_;
+
+  std::unique_ptr<CollectionRegistry::RegistrationHandle> registration_handle_;
+
+  using LabelArray = std::array<string, NumLabels>;
+  std::map<LabelArray, ShardedCounterCell> cells_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedCounter);
+};
+
+////
+//  Implementation details follow. API readers may skip.
+////
+
+inline void ShardedCounterCell::IncrementBy(const int64 step) {
+  DCHECK_LE(0, step) << "Must not decrement cumulative metrics.";
+  shards_[internal::CurrentCellShard()].value.fetch_add(
+      step, std::memory_order_relaxed);
+}
+
+inline int64 ShardedCounterCell::value() const {
+  int64 sum = 0;
+  for (int i = 0; i < internal::kCellShards; ++i) {
+    sum += shards_[i].value.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+template <int NumLabels>
+template <typename... MetricDefArgs>
+ShardedCounter<NumLabels>* ShardedCounter<NumLabels>::New(
+    MetricDefArgs&&... metric_def_args) {
+  return new ShardedCounter<NumLabels>(
+      MetricDef<MetricKind::kCumulative, int64, NumLabels>(
+          std::forward<MetricDefArgs>(metric_def_args)...));
+}
+
+template <int NumLabels>
+template <typename... Labels>
+ShardedCounterCell* ShardedCounter<NumLabels>::GetCell(const Labels&... labels)
+    LOCKS_EXCLUDED(mu_) {
+  // Provides a more informative error message than the one during array
+  // construction below.
+  static_assert(sizeof...(Labels) == NumLabels,
+                "Mismatch between ShardedCounter<NumLabels> and number of "
+                "labels provided in GetCell(...).");
+
+  const LabelArray& label_array = {{labels...}};
+  mutex_lock l(mu_);
+  const auto found_it = cells_.find(label_array);
+  if (found_it != cells_.end()) {
+    return &(found_it->second);
+  }
+  return &(cells_
+               .emplace(std::piecewise_construct,
+                        std::forward_as_tuple(label_array),
+                        std::forward_as_tuple(0))
+               .first->second);
+}
+
+}  // namespace monitoring
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_MONITORING_SHARDED_COUNTER_H_
@@ -0,0 +1,206 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_MONITORING_SHARDED_SAMPLER_H_
+#define TENSORFLOW_CORE_LIB_MONITORING_SHARDED_SAMPLER_H_
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/monitoring/metric_def.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/lib/monitoring/sharded_counter.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+// ShardedSamplerCell is a drop-in alternative to SamplerCell for hot paths.
+//
+// A plain SamplerCell serializes every Add on one histogram mutex.
+// ShardedSamplerCell keeps a histogram per shard; threads are spread over
+// shards (see CurrentCellShard in sharded_counter.h), so the per-shard
+// mutexes are mostly uncontended. value() merges the shard histograms, which
+// is fine at collection frequency.
+//
+// This class is thread-safe.
+class ShardedSamplerCell {
+ public:
+  explicit ShardedSamplerCell(const std::vector<double>& bucket_limits) {
+    shards_.reserve(internal::kCellShards);
+    for (int i = 0; i < internal::kCellShards; ++i) {
+      shards_.emplace_back(
+          new histogram::ThreadSafeHistogram(bucket_limits));
+    }
+  }
+
+  ~ShardedSamplerCell() {}
+
+  // Atomically adds a sample to the calling thread's shard.
+  void Add(double sample);
+
+  // Returns the merged histogram value of all shards as a proto.
+  HistogramProto value() const;
+
+ private:
+  std::vector<std::unique_ptr<histogram::ThreadSafeHistogram>> shards_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedSamplerCell);
+};
+
+// A Sampler variant whose cells are ShardedSamplerCells.
+//
+// Identical to Sampler in registration, labeling, bucketing and collection
+// semantics; only the per-cell update path differs.
+//
+// This class is thread-safe.
+template <int NumLabels>
+class ShardedSampler {
+ public:
+  ~ShardedSampler() {
+    // Deleted here, before the metric_def is destroyed.
+    registration_handle_.reset();
+  }
+
+  // Creates the metric based on the metric-definition arguments and buckets.
+  //
+  // Example;
+  // auto* sampler_with_label = ShardedSampler<1>::New(
+  //   {"/tensorflow/sampler", "Tensorflow sampler", "MyLabelName"},
+  //   Buckets::Exponential(1, 2, 10));
+  static ShardedSampler* New(
+      const MetricDef<MetricKind::kCumulative, HistogramProto, NumLabels>&
+          metric_def,
+      std::unique_ptr<Buckets> buckets);
+
+  // Retrieves the cell for the specified labels, creating it on demand if
+  // not already present.
+  template <typename... Labels>
+  ShardedSamplerCell* GetCell(const Labels&... labels) LOCKS_EXCLUDED(mu_);
+
+ private:
+  ShardedSampler(const MetricDef<MetricKind::kCumulative, HistogramProto,
+                                 NumLabels>& metric_def,
+                 std::unique_ptr<Buckets> buckets)
+      : metric_def_(metric_def),
+        buckets_(std::move(buckets)),
+        registration_handle_(CollectionRegistry::Default()->Register(
+            &metric_def_, [&](MetricCollectorGetter getter) {
+              auto metric_collector = getter.Get(&metric_def_);
+
+              mutex_lock l(mu_);
+              for (const auto& cell : cells_) {
+                metric_collector.CollectValue(cell.first, cell.second.value());
+              }
+            })) {}
+
+  mutable mutex mu_;
+
+  // The metric definition. This will be used to identify the metric when we
+  // register it for collection.
+  const MetricDef<MetricKind::kCumulative, HistogramProto, NumLabels>
+      metric_def_;
+
+  // Bucket limits for the histograms in the cells.
+  std::unique_ptr<Buckets> buckets_;
+
+  // Registration handle with the CollectionRegistry.
+  std::unique_ptr<CollectionRegistry::RegistrationHandle> registration_handle_;
+
+  using LabelArray = std::array<string, NumLabels>;
+  // we need a container here that guarantees pointer stability of the value,
+  // namely, the pointer of the value should remain valid even after more cells
+  // are inserted.
+  std::map<LabelArray, ShardedSamplerCell> cells_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedSampler);
+};
+
+////
+//  Implementation details follow. API readers may skip.
+////
+
+inline void ShardedSamplerCell::Add(const double sample) {
+  shards_[internal::CurrentCellShard()]->Add(sample);
+}
+
+inline HistogramProto ShardedSamplerCell::value() const {
+  HistogramProto merged;
+  shards_[0]->EncodeToProto(&merged, true /* preserve_zero_buckets */);
+  for (int i = 1; i < internal::kCellShards; ++i) {
+    HistogramProto shard_pb;
+    shards_[i]->EncodeToProto(&shard_pb, true /* preserve_zero_buckets */);
+    if (shard_pb.num() > 0) {
+      if (merged.num() == 0) {
+        merged.set_min(shard_pb.min());
+        merged.set_max(shard_pb.max());
+      } else {
+        merged.set_min(std::min(merged.min(), shard_pb.min()));
+        merged.set_max(std::max(merged.max(), shard_pb.max()));
+      }
+    }
+    merged.set_num(merged.num() + shard_pb.num());
+    merged.set_sum(merged.sum() + shard_pb.sum());
+    merged.set_sum_squares(merged.sum_squares() + shard_pb.sum_squares());
+    // All shards share the same bucket boundaries.
+    for (int b = 0; b < shard_pb.bucket_size(); ++b) {
+      merged.set_bucket(b, merged.bucket(b) + shard_pb.bucket(b));
+    }
+  }
+  return merged;
+}
+
+template <int NumLabels>
+ShardedSampler<NumLabels>* ShardedSampler<NumLabels>::New(
+    const MetricDef<MetricKind::kCumulative, HistogramProto, NumLabels>&
+        metric_def,
+    std::unique_ptr<Buckets> buckets) {
+  return new ShardedSampler<NumLabels>(metric_def, std::move(buckets));
+}
+
+template <int NumLabels>
+template <typename... Labels>
+ShardedSamplerCell* ShardedSampler<NumLabels>::GetCell(const Labels&... labels)
+    LOCKS_EXCLUDED(mu_) {
+  // Provides a more informative error message than the one during array
+  // construction below.
+  static_assert(sizeof...(Labels) == NumLabels,
+                "Mismatch between ShardedSampler<NumLabels> and number of "
+                "labels provided in GetCell(...).");
+
+  const LabelArray& label_array = {{labels...}};
+  mutex_lock l(mu_);
+  const auto found_it = cells_.find(label_array);
+  if (found_it != cells_.end()) {
+    return &(found_it->second);
+  }
+  return &(cells_
+               .emplace(std::piecewise_construct,
+                        std::forward_as_tuple(label_array),
+                        std::forward_as_tuple(buckets_->explicit_bounds()))
+               .first->second);
+}
+
+}  // namespace monitoring
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_MONITORING_SHARDED_SAMPLER_H_
@@ -0,0 +1,93 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/sharded_sampler.h"
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace monitoring {
+namespace {
+
+using histogram::Histogram;
+
+void EqHistograms(const Histogram& expected,
+                  const HistogramProto& actual_proto) {
+  Histogram actual;
+  ASSERT_TRUE(actual.DecodeFromProto(actual_proto));
+
+  EXPECT_EQ(expected.ToString(), actual.ToString());
+}
+
+auto* sampler_with_labels =
+    ShardedSampler<1>::New({"/tensorflow/test/sharded_sampler_with_labels",
+                            "Sharded sampler with one label.", "MyLabel"},
+                           Buckets::Explicit({10.0, 20.0}));
+
+TEST(LabeledShardedSamplerTest, InitializedEmpty) {
+  Histogram empty;
+  EqHistograms(empty, sampler_with_labels->GetCell("Empty")->value());
+}
+
+TEST(LabeledShardedSamplerTest, ExplicitBucketBoundaries) {
+  // Sampler automatically adds DBL_MAX to the list of buckets.
+  Histogram expected({10.0, 20.0, DBL_MAX});
+  auto* cell = sampler_with_labels->GetCell("BucketBoundaries");
+  cell->Add(-1.0);
+  expected.Add(-1.0);
+  cell->Add(10.0);
+  expected.Add(10.0);
+  cell->Add(20.0);
+  expected.Add(20.0);
+  cell->Add(31.0);
+  expected.Add(31.0);
+
+  EqHistograms(expected, cell->value());
+}
+
+auto* sampler_without_labels =
+    ShardedSampler<0>::New({"/tensorflow/test/sharded_sampler_without_labels",
+                            "Sharded sampler without labels."},
+                           Buckets::Explicit({1.0}));
+
+TEST(UnlabeledShardedSamplerTest, ConcurrentAddsMerge) {
+  auto* cell = sampler_without_labels->GetCell();
+
+  // Add from many threads so samples land in different shards, then check
+  // that the merged histogram accounts for every sample.
+  const int kNumThreads = 8;
+  const int kSamplesPerThread = 100;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([cell]() {
+        for (int j = 0; j < kSamplesPerThread; ++j) {
+          cell->Add(2.0);
+        }
+      });
+    }
+  }
+  const HistogramProto merged = cell->value();
+  EXPECT_EQ(kNumThreads * kSamplesPerThread, merged.num());
+  EXPECT_EQ(2.0 * kNumThreads * kSamplesPerThread, merged.sum());
+  EXPECT_EQ(2.0, merged.min());
+  EXPECT_EQ(2.0, merged.max());
+}
+
+}  // namespace
+}  // namespace monitoring
+}  // namespace tensorflow
@@ -28,6 +28,7 @@ REGISTER_OP("BatchFunction")
     .Attr("max_batch_size: int")
     .Attr("batch_timeout_micros: int")
     .Attr("max_enqueued_batches: int = 10")
+    .Attr("target_latency_micros: int = 0")
     .Attr("allowed_batch_sizes: list(int) = []")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
@@ -48,6 +49,7 @@ REGISTER_OP("Batch")
     .Attr("max_batch_size: int")
     .Attr("max_enqueued_batches: int = 10")
     .Attr("batch_timeout_micros: int")
+    .Attr("target_latency_micros: int = 0")
     .Attr("allowed_batch_sizes: list(int) = []")
     .Attr("grad_timeout_micros: int")
     .Attr("container: string = ''")
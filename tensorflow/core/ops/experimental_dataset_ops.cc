@@ -277,6 +277,29 @@ REGISTER_OP("ExperimentalParallelInterleaveDataset")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn(shape_inference::ScalarShape);
 
+// A TFRecord source that reads up to `num_parallel_reads` files concurrently,
+// with `buffer_size` bytes of readahead per file, and interleaves their
+// records in non-deterministic order.
+REGISTER_OP("ExperimentalParallelTFRecordDataset")
+    .Input("filenames: string")
+    .Input("compression_type: string")
+    .Input("buffer_size: int64")
+    .Input("num_parallel_reads: int64")
+    .Output("handle: variant")
+    .SetIsStateful()  // TODO(b/123753214): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // `compression_type`, `buffer_size` and `num_parallel_reads` must be
+      // scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("ExperimentalParseExampleDataset")
     .Input("input_dataset: variant")
     .Input("num_parallel_calls: int64")
@@ -364,6 +387,20 @@ REGISTER_OP("ExperimentalSlidingWindowDataset")
       return shape_inference::ScalarShape(c);
     });
 
+REGISTER_OP("ExperimentalSnapshotDataset")
+    .Input("input_dataset: variant")
+    .Input("path: string")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetIsStateful()  // The first run writes the snapshot to the file system.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `path` should be a scalar.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("ExperimentalSqlDataset")
     .Input("driver_name: string")
     .Input("data_source_name: string")
@@ -526,6 +563,13 @@ REGISTER_OP("ExperimentalIdentityIndexedDataset")
     .SetShapeFn(
         shape_inference::ScalarShape);  // TODO(saeta): check input shapes.
 
+REGISTER_OP("ExperimentalIndexedTFRecordDataset")
+    .Input("filename: string")
+    .Output("handle: variant")
+    .SetIsStateful()
+    .SetShapeFn(
+        shape_inference::ScalarShape);  // TODO(saeta): check input shapes.
+
 ///////////////////////////////////////////////////////////////////////////////
 //     IndexedDataset Internals
 ///////////////////////////////////////////////////////////////////////////////
@@ -124,6 +124,32 @@ TEST(ImageOpsTest, DecodeAndCropJpeg_ShapeFn) {
   INFER_ERROR("channels must be non-negative, got -1", op, "[];[]");
 }
 
+TEST(ImageOpsTest, DecodeCropResizeNormalizeJpeg_ShapeFn) {
+  const char* op_name = "DecodeCropResizeNormalizeJpeg";
+  ShapeInferenceTestOp op(op_name);
+  op.input_tensors.resize(3);
+
+  // Rank checks on contents and crop_window.
+  INFER_ERROR("Shape must be rank 0 but is rank 1", op, "[1];?;?");
+  INFER_ERROR("Dimension must be 4 but is 3", op, "[];[3];?");
+
+  // When the size tensor is not a constant, height and width are unknown.
+  INFER_OK(op, "[];[?];[2]", "[?,?,3]");
+
+  Tensor size_tensor = test::AsTensor<int32>({20, 30});
+  op.input_tensors[2] = &size_tensor;
+  INFER_OK(op, "[];[?];[2]", "[20,30,3]");
+
+  // Invalid channel count is rejected.
+  TF_ASSERT_OK(NodeDefBuilder("test", op_name)
+                   .Input({"img", 0, DT_STRING})
+                   .Input({"crop_window", 1, DT_INT32})
+                   .Input({"size", 2, DT_INT32})
+                   .Attr("channels", 4)
+                   .Finalize(&op.node_def));
+  INFER_ERROR("channels must be 1 or 3, got 4", op, "[];[?];[2]");
+}
+
 TEST(ImageOpsTest, DecodeAndCropJpeg_InvalidCropWindow) {
   const char* op_name = "DecodeAndCropJpeg";
   ShapeInferenceTestOp op(op_name);
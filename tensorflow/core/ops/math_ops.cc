@@ -844,6 +844,22 @@ REGISTER_OP("MatMul")
         "complex128}")
     .SetShapeFn(shape_inference::MatMulShape);
 
+REGISTER_OP("_FusedMatMul")
+    .Input("a: T")
+    .Input("b: T")
+    .Input("args: num_args * T")
+    .Output("product: T")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string) = []")
+    .SetShapeFn(shape_inference::MatMulShape)
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("SparseMatMul")
     .Input("a: Ta")
     .Input("b: Tb")
@@ -1302,6 +1318,45 @@ REGISTER_OP("SparseSegmentSqrtNGrad")
     .Attr("Tidx: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradShapeFn);
 
+// Fuses N Gather -> sparse segment combine -> ConcatV2 chains into a single
+// op, writing each table's combined rows directly into its column slice of
+// the concatenated output. Unlike the SparseSegment* ops, the segment ids do
+// not need to be sorted.
+REGISTER_OP("FusedEmbeddingLookup")
+    .Input("params: N * T")
+    .Input("indices: N * Tidx")
+    .Input("segment_ids: N * int32")
+    .Input("num_segments: int32")
+    .Output("output: T")
+    .Attr("N: int >= 1")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      int num_tables;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &num_tables));
+      DimensionHandle total_cols = c->MakeDim(0);
+      for (int i = 0; i < num_tables; ++i) {
+        ShapeHandle params_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 2, &params_shape));
+        TF_RETURN_IF_ERROR(
+            c->Add(total_cols, c->Dim(params_shape, 1), &total_cols));
+        ShapeHandle indices_shape;
+        TF_RETURN_IF_ERROR(
+            c->WithRank(c->input(num_tables + i), 1, &indices_shape));
+        ShapeHandle segment_ids_shape;
+        TF_RETURN_IF_ERROR(
+            c->WithRank(c->input(2 * num_tables + i), 1, &segment_ids_shape));
+        ShapeHandle unused;
+        TF_RETURN_IF_ERROR(
+            c->Merge(indices_shape, segment_ids_shape, &unused));
+      }
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3 * num_tables), 0, &unused));
+      c->set_output(0, c->Matrix(c->UnknownDim(), total_cols));
+      return Status::OK();
+    });
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
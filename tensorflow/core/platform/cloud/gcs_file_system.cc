@@ -83,6 +83,16 @@ constexpr size_t kDefaultMaxCacheSize = kDefaultBlockSize;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the number of concurrent HTTP range
+// requests issued for a single read that spans multiple cache blocks. The
+// default of 1 fetches the blocks of a read one at a time.
+constexpr char kFetchParallelism[] = "GCS_READ_CACHE_FETCH_PARALLELISM";
+constexpr size_t kDefaultFetchParallelism = 1;
+// The environment variable that overrides the number of blocks prefetched
+// ahead of a reader that is detected to be reading a file sequentially. The
+// default of 0 disables readahead.
+constexpr char kReadaheadBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
+constexpr size_t kDefaultReadaheadBlocks = 0;
 // The environment variable that overrides the maximum age of entries in the
 // Stat cache. A value of 0 (the default) means nothing is cached.
 constexpr char kStatCacheMaxAge[] = "GCS_STAT_CACHE_MAX_AGE";
@@ -685,9 +695,20 @@ GcsFileSystem::GcsFileSystem() {
     // Setting either to 0 disables the cache; set both for good measure.
     block_size = max_bytes = 0;
   }
+  // Apply the overrides for the fetch parallelism and readahead, if provided.
+  fetch_parallelism_ = kDefaultFetchParallelism;
+  readahead_blocks_ = kDefaultReadaheadBlocks;
+  if (GetEnvVar(kFetchParallelism, strings::safe_strtou64, &value)) {
+    fetch_parallelism_ = value;
+  }
+  if (GetEnvVar(kReadaheadBlocks, strings::safe_strtou64, &value)) {
+    readahead_blocks_ = value;
+  }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "fetch parallelism = " << fetch_parallelism_ << " ; "
+          << "readahead blocks = " << readahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -886,7 +907,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), fetch_parallelism_, readahead_blocks_));
   return file_block_cache;
 }
 
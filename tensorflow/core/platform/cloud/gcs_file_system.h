@@ -308,6 +308,12 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<AuthProvider> auth_provider_ GUARDED_BY(mu_);
   std::shared_ptr<HttpRequest::Factory> http_request_factory_;
   std::unique_ptr<ZoneProvider> zone_provider_;
+  // The number of parallel block fetches issued for a read that spans several
+  // cache blocks, and the number of blocks fetched ahead of a sequential
+  // reader. Declared before file_block_cache_, which is built from them via
+  // MakeFileBlockCache.
+  size_t fetch_parallelism_ = 1;
+  size_t readahead_blocks_ = 0;
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
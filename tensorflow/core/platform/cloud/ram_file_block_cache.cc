@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include <cstring>
 #include <memory>
+#include <vector>
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 
@@ -76,15 +78,21 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
     block->lru_iterator = lru_list_.begin();
   }
 
-  // Check for inconsistent state. If there is a block later in the same file
-  // in the cache, and our current block is not block size, this likely means
-  // we have inconsistent state within the cache. Note: it's possible some
-  // incomplete reads may still go undetected.
+  // Check for inconsistent state. A partial block signals EOF at its upper
+  // bound, so if a block of the same file at a higher offset holds data, this
+  // likely means we have inconsistent state within the cache (e.g. from an
+  // interrupted read). Blocks at higher offsets that hold no data are
+  // consistent with EOF; the parallel fetch and readahead paths may cache
+  // such blocks when they probe past the end of the file. Note: it's possible
+  // some incomplete reads may still go undetected.
   if (block->data.size() < block_size_) {
-    Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
-    auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    for (auto it = std::next(block_map_.find(key));
+         it != block_map_.end() && it->first.first == key.first; ++it) {
+      mutex_lock block_lock(it->second->mu);
+      if (it->second->state == FetchState::FINISHED &&
+          !it->second->data.empty()) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -172,15 +180,47 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
-  size_t total_bytes_transferred = 0;
-  // Now iterate through the blocks, reading them one at a time.
+  // Look up every block the read spans up front, inserting any missing
+  // entries, so that misses on distinct blocks can be fetched in parallel.
+  std::vector<Key> keys;
+  std::vector<std::shared_ptr<Block>> blocks;
+  keys.reserve((finish - start) / block_size_);
+  blocks.reserve((finish - start) / block_size_);
   for (size_t pos = start; pos < finish; pos += block_size_) {
-    Key key = std::make_pair(filename, pos);
-    // Look up the block, fetching and inserting it if necessary, and update the
-    // LRU iterator for the key and block.
-    std::shared_ptr<Block> block = Lookup(key);
-    DCHECK(block) << "No block for key " << key.first << "@" << key.second;
-    TF_RETURN_IF_ERROR(MaybeFetch(key, block));
+    keys.emplace_back(filename, pos);
+    blocks.push_back(Lookup(keys.back()));
+    DCHECK(blocks.back()) << "No block for key " << filename << "@" << pos;
+  }
+  // If the read spans multiple blocks and parallel fetching is enabled, issue
+  // all of the fetches now, so that the blocks are filled by concurrent range
+  // requests. The first block is fetched on the calling thread; the thread
+  // pool caps the number of fetches that are actually in flight at once.
+  std::vector<Status> fetch_status(keys.size());
+  bool prefetched = false;
+  if (fetch_pool_ != nullptr && fetch_parallelism_ > 1 && keys.size() > 1) {
+    BlockingCounter counter(keys.size() - 1);
+    for (size_t i = 1; i < keys.size(); ++i) {
+      fetch_pool_->Schedule([this, &keys, &blocks, &fetch_status, &counter, i] {
+        fetch_status[i] = MaybeFetch(keys[i], blocks[i]);
+        counter.DecrementCount();
+      });
+    }
+    fetch_status[0] = MaybeFetch(keys[0], blocks[0]);
+    counter.Wait();
+    prefetched = true;
+  }
+  size_t total_bytes_transferred = 0;
+  // Now iterate through the blocks, copying them into the result buffer.
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const Key& key = keys[i];
+    const std::shared_ptr<Block>& block = blocks[i];
+    const size_t pos = key.second;
+    // Fetch the block if necessary, and update the LRU iterator for the key
+    // and block.
+    if (!prefetched) {
+      fetch_status[i] = MaybeFetch(key, block);
+    }
+    TF_RETURN_IF_ERROR(fetch_status[i]);
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
     const auto& data = block->data;
@@ -214,9 +254,45 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  // A fully satisfied read may be part of a sequential scan of the file, in
+  // which case warm the cache with the blocks that follow it. Reads that hit
+  // EOF are excluded; there is nothing past them to read ahead.
+  if (readahead_blocks_ > 0 && total_bytes_transferred == n) {
+    MaybeReadahead(filename, offset, n, finish);
+  }
   return Status::OK();
 }
 
+void RamFileBlockCache::MaybeReadahead(const string& filename, size_t offset,
+                                       size_t n, size_t finish) {
+  bool sequential;
+  {
+    mutex_lock lock(seq_mu_);
+    if (seq_read_end_.size() >= kMaxSequentialStates &&
+        seq_read_end_.count(filename) == 0) {
+      seq_read_end_.clear();
+    }
+    auto it = seq_read_end_.find(filename);
+    sequential = (it != seq_read_end_.end() && it->second == offset);
+    seq_read_end_[filename] = offset + n;
+  }
+  if (!sequential || fetch_pool_ == nullptr) {
+    return;
+  }
+  // The fetches are best-effort: errors are swallowed here, and a reader that
+  // does reach one of these offsets will retry the fetch itself. Blocks that
+  // are already cached are deduplicated by MaybeFetch.
+  for (size_t i = 0; i < readahead_blocks_; ++i) {
+    const Key key = std::make_pair(filename, finish + i * block_size_);
+    fetch_pool_->Schedule([this, key] {
+      std::shared_ptr<Block> block = Lookup(key);
+      if (MaybeFetch(key, block).ok()) {
+        UpdateLRU(key, block).IgnoreError();
+      }
+    });
+  }
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64 file_signature) {
   mutex_lock lock(mu_);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -49,17 +51,30 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// `fetch_parallelism` is the maximum number of concurrent block fetches
+  /// issued on behalf of a single Read that spans several blocks; 1 fetches
+  /// the blocks of a read one at a time. `readahead_blocks` is the number of
+  /// blocks fetched asynchronously ahead of a reader that is detected to be
+  /// reading the file sequentially; 0 disables readahead.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t fetch_parallelism = 1, size_t readahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
+        fetch_parallelism_(fetch_parallelism),
+        readahead_blocks_(readahead_blocks),
         block_fetcher_(block_fetcher),
         env_(env) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (IsCacheEnabled() && (fetch_parallelism_ > 1 || readahead_blocks_ > 0)) {
+      fetch_pool_.reset(new thread::ThreadPool(
+          env_, "TF_fetch_FBC",
+          static_cast<int>(std::max<size_t>(fetch_parallelism_, 1))));
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
@@ -126,6 +141,10 @@ class RamFileBlockCache : public FileBlockCache {
   const size_t max_bytes_;
   /// The maximum staleness of any block in the LRU cache, in seconds.
   const uint64 max_staleness_;
+  /// The maximum number of concurrent block fetches per spanning read.
+  const size_t fetch_parallelism_;
+  /// The number of blocks fetched ahead of a sequential reader.
+  const size_t readahead_blocks_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
@@ -213,6 +232,13 @@ class RamFileBlockCache : public FileBlockCache {
   /// cache size accordingly.
   void RemoveBlock(BlockMap::iterator entry) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Record the end position of the read [offset, offset + n) on `filename`,
+  /// and if the read continued a sequential access pattern, schedule
+  /// asynchronous fetches of the `readahead_blocks_` blocks starting at
+  /// `finish` (the block-aligned end of the read).
+  void MaybeReadahead(const string& filename, size_t offset, size_t n,
+                      size_t finish) LOCKS_EXCLUDED(seq_mu_);
+
   /// The cache pruning thread that removes files with expired blocks.
   std::unique_ptr<Thread> pruning_thread_;
 
@@ -241,6 +267,23 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ GUARDED_BY(mu_);
+
+  /// The maximum number of files whose last read position is tracked for
+  /// sequential-access detection. The tracking map is reset when it fills up.
+  static const size_t kMaxSequentialStates = 1024;
+
+  /// Guards the sequential-access tracking map. This is a leaf lock; it is
+  /// never held while acquiring mu_ or any block's mu.
+  mutable mutex seq_mu_;
+
+  /// Maps a filename to the end position of the last read of that file, for
+  /// detecting sequential access patterns.
+  std::map<string, size_t> seq_read_end_ GUARDED_BY(seq_mu_);
+
+  /// The thread pool used for parallel block fetches and readahead. Declared
+  /// last so that in-flight fetches are drained before any other member is
+  /// destroyed.
+  std::unique_ptr<thread::ThreadPool> fetch_pool_;
 };
 
 }  // namespace tensorflow
@@ -507,6 +507,111 @@ TEST(RamFileBlockCacheTest, ParallelReads) {
   // executed, or 10 seconds have passed).
 }
 
+TEST(RamFileBlockCacheTest, ParallelFetchSpanningRead) {
+  // This fetcher won't respond until all four blocks of a spanning read are
+  // being fetched concurrently (at which point it will respond with success
+  // to all callers), or 10 seconds have elapsed (at which point it will
+  // respond with an error).
+  const int fetch_parallelism = 4;
+  BlockingCounter counter(fetch_parallelism);
+  auto fetcher = [&counter](const string& filename, size_t offset, size_t n,
+                            char* buffer, size_t* bytes_transferred) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      // This avoids having the test time out, which is harder to debug.
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const size_t block_size = 8;
+  RamFileBlockCache cache(block_size, fetch_parallelism * block_size, 0,
+                          fetcher, Env::Default(), fetch_parallelism);
+  // A single read spanning four blocks should fetch all of them in parallel.
+  std::vector<char> out;
+  TF_EXPECT_OK(
+      ReadCache(&cache, "a", 0, fetch_parallelism * block_size, &out));
+  std::vector<char> x(fetch_parallelism * block_size, 'x');
+  EXPECT_EQ(out, x);
+}
+
+TEST(RamFileBlockCacheTest, SequentialReadahead) {
+  const size_t block_size = 8;
+  mutex mu;
+  std::vector<size_t> fetched;  // Guarded by mu.
+  Notification readahead_issued;
+  auto fetcher = [&mu, &fetched, &readahead_issued, block_size](
+                     const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock lock(mu);
+      fetched.push_back(offset);
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    if (offset == 2 * block_size) {
+      readahead_issued.Notify();
+    }
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 8 * block_size, 0, fetcher,
+                          Env::Default(), /* fetch_parallelism = */ 1,
+                          /* readahead_blocks = */ 1);
+  std::vector<char> out;
+  // The first read of the file is not known to be sequential, so it should
+  // only fetch its own block.
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, block_size, &out));
+  // The second read continues where the first left off, which makes the
+  // access pattern sequential; the block at 2 * block_size should now be
+  // fetched asynchronously.
+  TF_EXPECT_OK(ReadCache(&cache, "", block_size, block_size, &out));
+  readahead_issued.WaitForNotification();
+  // Reading the prefetched block must not trigger another fetch of it; the
+  // fetch of each offset happened exactly once. (A read that overlaps the
+  // readahead in flight is coalesced by the cache.)
+  TF_EXPECT_OK(ReadCache(&cache, "", 2 * block_size, block_size, &out));
+  std::vector<char> x(block_size, 'x');
+  EXPECT_EQ(out, x);
+  mutex_lock lock(mu);
+  std::vector<size_t> want({0, block_size, 2 * block_size});
+  EXPECT_EQ(fetched, want);
+}
+
+TEST(RamFileBlockCacheTest, EmptyBlocksAreConsistent) {
+  // Tests reads of a 12-byte file with block size 8. A cached empty block
+  // past the end of the file (e.g. from a read probing beyond EOF, or from
+  // readahead) must not make an earlier partial block look inconsistent.
+  const size_t block_size = 8;
+  const size_t file_size = 12;
+  auto fetcher = [block_size, file_size](const string& filename, size_t offset,
+                                         size_t n, char* buffer,
+                                         size_t* bytes_transferred) {
+    EXPECT_EQ(n, block_size);
+    EXPECT_EQ(offset % block_size, 0);
+    if (offset < file_size) {
+      size_t bytes_to_copy = std::min(file_size - offset, n);
+      memset(buffer, 'x', bytes_to_copy);
+      *bytes_transferred = bytes_to_copy;
+    } else {
+      *bytes_transferred = 0;
+    }
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 4 * block_size, 0, fetcher);
+  std::vector<char> out;
+  // Reading past EOF returns OutOfRange, and leaves an empty block at offset
+  // 16 in the cache.
+  Status status = ReadCache(&cache, "", 2 * block_size, 1, &out);
+  EXPECT_EQ(status.code(), error::OUT_OF_RANGE);
+  // Reading the whole file afterwards ends with a partial block at offset 8.
+  // The empty block cached at offset 16 is consistent with that EOF, so the
+  // read should succeed.
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, file_size, &out));
+  std::vector<char> x(file_size, 'x');
+  EXPECT_EQ(out, x);
+}
+
 TEST(RamFileBlockCacheTest, CoalesceConcurrentReads) {
   // Concurrent reads to the same file blocks should be de-duplicated.
   const size_t block_size = 16;
@@ -0,0 +1,93 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CPU_FEATURE_DISPATCH_H_
+#define TENSORFLOW_CORE_PLATFORM_CPU_FEATURE_DISPATCH_H_
+
+// Support for compiling multiple ISA-specific variants of a hot loop in a
+// single translation unit and selecting the best one at runtime based on the
+// features of the host CPU. The binary itself stays runnable on the baseline
+// ISA it was configured for; only the annotated functions use the wider
+// instruction sets, and they are only ever called after a successful
+// port::TestCPUFeature check.
+//
+// Typical usage:
+//
+//   TF_TARGET_AVX512F void ScaleAvx512(const float* in, float* out, int n);
+//   TF_TARGET_AVX2 void ScaleAvx2(const float* in, float* out, int n);
+//   void ScaleGeneric(const float* in, float* out, int n);
+//
+//   typedef void (*ScaleFn)(const float*, float*, int);
+//   static const ScaleFn scale_fn = port::SelectCpuVariant<ScaleFn>(
+//       {{port::AVX512F, &ScaleAvx512}, {port::AVX2, &ScaleAvx2}},
+//       &ScaleGeneric);
+//
+// The selection is typically latched in a function-local or namespace-level
+// static so the feature probe runs once per process.
+
+#include <initializer_list>
+
+#include "tensorflow/core/platform/cpu_info.h"
+
+// TF_TARGET_AVX2 / TF_TARGET_AVX512F annotate a function definition so the
+// compiler may use the named instruction sets (and auto-vectorize
+// accordingly) for that function only, independent of the baseline -m flags
+// the translation unit was built with. On toolchains without the target
+// attribute they expand to nothing and TF_CPU_FEATURE_DISPATCH_SUPPORTED is
+// left undefined, in which case callers should compile only the generic
+// variant.
+// AVX-512 target support requires clang or GCC 4.9+.
+#if (defined(__clang__) ||                                     \
+     (defined(__GNUC__) &&                                     \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define TF_CPU_FEATURE_DISPATCH_SUPPORTED 1
+#define TF_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TF_TARGET_AVX512F __attribute__((target("avx512f")))
+#else
+#define TF_TARGET_AVX2
+#define TF_TARGET_AVX512F
+#endif
+
+namespace tensorflow {
+namespace port {
+
+// A candidate implementation of a routine, usable only on CPUs that support
+// the given feature.
+template <typename FnPtr>
+struct CpuVariant {
+  CPUFeature required_feature;
+  FnPtr fn;
+};
+
+// Returns the first variant whose required feature is available on the host
+// CPU, or "generic" if none is. List variants from most to least specialized.
+// The function-pointer type cannot be deduced from a braced initializer list,
+// so call this with an explicit template argument (see the example above).
+template <typename FnPtr>
+FnPtr SelectCpuVariant(std::initializer_list<CpuVariant<FnPtr>> variants,
+                       FnPtr generic) {
+  for (const CpuVariant<FnPtr>& variant : variants) {
+    if (TestCPUFeature(variant.required_feature)) {
+      return variant.fn;
+    }
+  }
+  return generic;
+}
+
+}  // namespace port
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CPU_FEATURE_DISPATCH_H_
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <sys/stat.h>
 #include <deque>
+#include <limits>
 #include <utility>
 #include <vector>
 #if defined(__APPLE__)
@@ -504,18 +505,35 @@ Status WriteBinaryProto(Env* env, const string& fname,
 
 Status ReadBinaryProto(Env* env, const string& fname,
                        ::tensorflow::protobuf::MessageLite* proto) {
+  // When the filesystem supports it, parse straight out of a read-only
+  // memory mapping of the file.  This avoids staging the bytes through a
+  // read buffer, and the pages stream in on demand, so loading a large
+  // proto (e.g. a multi-GB GraphDef) is bounded by I/O rather than by
+  // copies.  The wire format caps any parseable message at 2GB, so files
+  // larger than that take the streaming path below and fail at the limit
+  // with a proper error.
+  const int64 kMaxParseBytes = std::numeric_limits<int>::max();
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  if (env->NewReadOnlyMemoryRegionFromFile(fname, &region).ok() &&
+      static_cast<int64>(region->length()) <= kMaxParseBytes) {
+    ::tensorflow::protobuf::io::ArrayInputStream array_stream(
+        region->data(), static_cast<int>(region->length()));
+    ::tensorflow::protobuf::io::CodedInputStream coded_stream(&array_stream);
+    coded_stream.SetTotalBytesLimit(kMaxParseBytes, 512LL << 20);
+    if (!proto->ParseFromCodedStream(&coded_stream)) {
+      return errors::DataLoss("Can't parse ", fname, " as binary proto");
+    }
+    return Status::OK();
+  }
+
   std::unique_ptr<RandomAccessFile> file;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(fname, &file));
   std::unique_ptr<FileStream> stream(new FileStream(file.get()));
 
-  // TODO(jiayq): the following coded stream is for debugging purposes to allow
-  // one to parse arbitrarily large messages for MessageLite. One most likely
-  // doesn't want to put protobufs larger than 64MB on Android, so we should
-  // eventually remove this and quit loud when a large protobuf is passed in.
   ::tensorflow::protobuf::io::CodedInputStream coded_stream(stream.get());
-  // Total bytes hard limit / warning limit are set to 1GB and 512MB
-  // respectively.
-  coded_stream.SetTotalBytesLimit(1024LL << 20, 512LL << 20);
+  // Total bytes hard limit is set to the wire-format maximum; the warning
+  // limit stays at 512MB.
+  coded_stream.SetTotalBytesLimit(kMaxParseBytes, 512LL << 20);
 
   if (!proto->ParseFromCodedStream(&coded_stream)) {
     TF_RETURN_IF_ERROR(stream->status());
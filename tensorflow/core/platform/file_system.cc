@@ -51,6 +51,14 @@ void FileSystem::FlushCaches() {}
 
 RandomAccessFile::~RandomAccessFile() {}
 
+void RandomAccessFile::ReadAsync(
+    uint64 offset, size_t n, char* scratch,
+    std::function<void(const Status&, StringPiece)> done) const {
+  StringPiece result;
+  Status status = Read(offset, n, &result, scratch);
+  done(status, result);
+}
+
 WritableFile::~WritableFile() {}
 
 FileSystemRegistry::~FileSystemRegistry() {}
@@ -260,6 +260,23 @@ class RandomAccessFile {
   virtual Status Read(uint64 offset, size_t n, StringPiece* result,
                       char* scratch) const = 0;
 
+  /// \brief Asynchronously reads up to `n` bytes from the file starting at
+  /// `offset`.
+  ///
+  /// `done` is invoked exactly once with the status of the read and the
+  /// result StringPiece, with the same semantics as the outputs of Read().
+  /// It may be invoked on a different thread. `scratch[0..n-1]` and the file
+  /// itself must stay live until `done` has been invoked.
+  ///
+  /// The default implementation performs the read synchronously and invokes
+  /// `done` before returning. Filesystems that can keep multiple reads in
+  /// flight without consuming a thread per request should override it.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(
+      uint64 offset, size_t n, char* scratch,
+      std::function<void(const Status&, StringPiece)> done) const;
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <condition_variable>
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_feature_dispatch.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -85,5 +86,25 @@ TEST(TestCPUFeature, TestFeature) {
   LOG(INFO) << "has_avx2 = " << has_avx2;
 }
 
+namespace {
+int VariantGeneric() { return 0; }
+int VariantAvx2() { return 2; }
+int VariantAvx512() { return 512; }
+}  // namespace
+
+TEST(CpuFeatureDispatch, SelectsMostSpecializedSupportedVariant) {
+  typedef int (*VariantFn)();
+  const VariantFn fn = SelectCpuVariant<VariantFn>(
+      {{CPUFeature::AVX512F, &VariantAvx512}, {CPUFeature::AVX2, &VariantAvx2}},
+      &VariantGeneric);
+  if (TestCPUFeature(CPUFeature::AVX512F)) {
+    EXPECT_EQ(512, fn());
+  } else if (TestCPUFeature(CPUFeature::AVX2)) {
+    EXPECT_EQ(2, fn());
+  } else {
+    EXPECT_EQ(0, fn());
+  }
+}
+
 }  // namespace port
 }  // namespace tensorflow
@@ -29,6 +29,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system_helper.h"
@@ -41,6 +42,16 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+// The pool that executes ReadAsync() requests for all PosixRandomAccessFile
+// instances. A shared bounded pool lets callers keep many reads in flight
+// without dedicating a thread to each outstanding request. The pool is
+// intentionally leaked to avoid destruction-order problems at shutdown.
+static thread::ThreadPool* ReadAsyncPool() {
+  static thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "tf_read_async", 16);
+  return pool;
+}
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -78,6 +89,16 @@ class PosixRandomAccessFile : public RandomAccessFile {
     *result = StringPiece(scratch, dst - scratch);
     return s;
   }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 std::function<void(const Status&, StringPiece)> done)
+      const override {
+    ReadAsyncPool()->Schedule([this, offset, n, scratch, done]() {
+      StringPiece result;
+      Status status = Read(offset, n, &result, scratch);
+      done(status, result);
+    });
+  }
 };
 
 class PosixWritableFile : public WritableFile {
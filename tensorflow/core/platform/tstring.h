@@ -0,0 +1,38 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_TSTRING_H_
+#define TENSORFLOW_CORE_PLATFORM_TSTRING_H_
+
+#include <string>
+
+namespace tensorflow {
+
+// tstring is the element type of DT_STRING tensors.
+//
+// It is currently an alias of std::string. The intent is to replace it with
+// a small-string-optimized, view-capable type so that short feature strings
+// fit inline in the tensor buffer and parse ops can alias their input
+// instead of copying; swapping the storage type is only feasible once call
+// sites spell the element type through this alias. New code that touches
+// tensor string storage (kernels, feature parsers, Tensor::flat<...> and
+// Tensor::scalar<...> call sites) should therefore use tstring rather than
+// string, and should not rely on std::string-specific API surface beyond
+// what a string type with data/size/assign/append semantics provides.
+typedef std::string tstring;
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_TSTRING_H_
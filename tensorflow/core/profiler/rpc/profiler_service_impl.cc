@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/rpc/profiler_service_impl.h"
 #include "grpcpp/support/status.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/kernel_timing.h"
 #include "tensorflow/core/platform/grpc_services.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
 #include "tensorflow/core/util/ptr_util.h"
@@ -31,7 +32,18 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
 
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    // Serves the flight-recorder ring of sampled kernel timings and step
+    // durations collected by KernelTimingCollector. Unlike Profile, this
+    // does not start a tracing session, so it can be polled without
+    // perturbing the workload.
+    KernelTimingCollector* collector = KernelTimingCollector::Get();
+    if (collector == nullptr) {
+      return ::grpc::Status(::grpc::StatusCode::UNAVAILABLE,
+                            "Kernel timing collection is disabled; start the "
+                            "server with TF_KERNEL_TIMING=1 to enable it.");
+    }
+    response->set_data(collector->Export());
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
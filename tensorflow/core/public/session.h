@@ -223,6 +223,26 @@ class Session {
         "RunCallable is not supported for this session.");
   }
 
+  /// \brief Invokes the subgraph named by `handle` without blocking the
+  /// caller.
+  ///
+  /// Identical to `RunCallable()` except that `done` is invoked with the
+  /// step's status once execution finishes instead of the caller blocking.
+  /// The caller must keep `fetch_tensors` and `run_metadata` alive until
+  /// `done` has been invoked. Multiple invocations may be in flight at
+  /// once, so a caller can pipeline independent requests through one
+  /// session: the host-side work of step N+1 overlaps the device work of
+  /// step N.
+  /// NOTE: This API is still experimental and may change.
+  virtual void RunCallableAsync(CallableHandle handle,
+                                const std::vector<Tensor>& feed_tensors,
+                                std::vector<Tensor>* fetch_tensors,
+                                RunMetadata* run_metadata,
+                                StatusCallback done) {
+    done(errors::Unimplemented(
+        "RunCallableAsync is not supported for this session."));
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
@@ -230,6 +250,17 @@ class Session {
     return errors::Unimplemented(
         "ReleaseCallable is not supported for this session.");
   }
+
+  /// \brief Prepares the session to run the subgraph described by
+  /// `callable_options` without executing it: constructs the executors and
+  /// all of their kernels, primes the session's thread pools, and
+  /// optionally pre-grows device allocators (see TF_SESSION_WARMUP_ALLOC_MB)
+  /// so that the first Run() call does not pay cold-start costs.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status Warmup(const CallableOptions& callable_options) {
+    return errors::Unimplemented(
+        "Warmup is not supported for this session.");
+  }
 };
 
 /// \brief Create a new session with the given options.
@@ -79,6 +79,12 @@ const int64 kPreallocateRows = 1000;
 // allow writers in other processes a chance to schedule.
 const uint64 kFlushBytes = 1024 * 1024;
 
+// Number of tensor writes grouped into a single commit. Auto-commit
+// mode pays a transaction per statement; batching amortizes that cost
+// across a step's worth of summaries. Flush() and the destructor commit
+// whatever is pending, so nothing is held longer than the caller allows.
+const size_t kMaxPendingWrites = 64;
+
 double DoubleTime(uint64 micros) {
   // TODO(@jart): Follow precise definitions for time laid out in schema.
   // TODO(@jart): Use monotonic clock from gRPC codebase.
@@ -168,12 +174,14 @@ class IdAllocator {
   Status CreateNewId(int64* id) LOCKS_EXCLUDED(mu_) {
     mutex_lock lock(mu_);
     Status s;
-    SqliteStatement stmt;
-    TF_RETURN_IF_ERROR(db_->Prepare("INSERT INTO Ids (id) VALUES (?)", &stmt));
+    if (!insert_) {
+      TF_RETURN_IF_ERROR(
+          db_->Prepare("INSERT INTO Ids (id) VALUES (?)", &insert_));
+    }
     for (int i = 0; i < kMaxIdCollisions; ++i) {
       int64 tid = MakeRandomId();
-      stmt.BindInt(1, tid);
-      s = stmt.StepAndReset();
+      insert_.BindInt(1, tid);
+      s = insert_.StepAndReset();
       if (s.ok()) {
         *id = tid;
         break;
@@ -209,6 +217,7 @@ class IdAllocator {
   Env* const env_;
   Sqlite* const db_;
   int tier_ GUARDED_BY(mu_) = 0;
+  SqliteStatement insert_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(IdAllocator);
 };
@@ -431,35 +440,38 @@ class RunMetadata {
     tag_ids_[tag_name] = *tag_id;
     TF_RETURN_IF_ERROR(
         SetDescription(db, *tag_id, metadata.summary_description()));
-    const char* sql = R"sql(
-      INSERT INTO Tags (
-        run_id,
-        tag_id,
-        tag_name,
-        inserted_time,
-        display_name,
-        plugin_name,
-        plugin_data
-      ) VALUES (
-        :run_id,
-        :tag_id,
-        :tag_name,
-        :inserted_time,
-        :display_name,
-        :plugin_name,
-        :plugin_data
-      )
-    )sql";
-    SqliteStatement insert;
-    TF_RETURN_IF_ERROR(db->Prepare(sql, &insert));
-    if (run_id_ != kAbsent) insert.BindInt(":run_id", run_id_);
-    insert.BindInt(":tag_id", *tag_id);
-    insert.BindTextUnsafe(":tag_name", tag_name);
-    insert.BindDouble(":inserted_time", DoubleTime(now));
-    insert.BindTextUnsafe(":display_name", metadata.display_name());
-    insert.BindTextUnsafe(":plugin_name", metadata.plugin_data().plugin_name());
-    insert.BindBlobUnsafe(":plugin_data", metadata.plugin_data().content());
-    return insert.StepAndReset();
+    if (!insert_tag_) {
+      const char* sql = R"sql(
+        INSERT INTO Tags (
+          run_id,
+          tag_id,
+          tag_name,
+          inserted_time,
+          display_name,
+          plugin_name,
+          plugin_data
+        ) VALUES (
+          :run_id,
+          :tag_id,
+          :tag_name,
+          :inserted_time,
+          :display_name,
+          :plugin_name,
+          :plugin_data
+        )
+      )sql";
+      TF_RETURN_IF_ERROR(db->Prepare(sql, &insert_tag_));
+    }
+    if (run_id_ != kAbsent) insert_tag_.BindInt(":run_id", run_id_);
+    insert_tag_.BindInt(":tag_id", *tag_id);
+    insert_tag_.BindTextUnsafe(":tag_name", tag_name);
+    insert_tag_.BindDouble(":inserted_time", DoubleTime(now));
+    insert_tag_.BindTextUnsafe(":display_name", metadata.display_name());
+    insert_tag_.BindTextUnsafe(":plugin_name",
+                               metadata.plugin_data().plugin_name());
+    insert_tag_.BindBlobUnsafe(":plugin_data",
+                               metadata.plugin_data().content());
+    return insert_tag_.StepAndReset();
   }
 
  private:
@@ -616,6 +628,7 @@ class RunMetadata {
   double experiment_started_time_ GUARDED_BY(mu_) = 0.0;
   double run_started_time_ GUARDED_BY(mu_) = 0.0;
   std::unordered_map<string, int64> tag_ids_ GUARDED_BY(mu_);
+  SqliteStatement insert_tag_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(RunMetadata);
 };
@@ -629,12 +642,15 @@ class SeriesWriter {
     DCHECK(series_ > 0);
   }
 
-  Status Append(Sqlite* db, int64 step, uint64 now, double computed_time,
-                const Tensor& t) SQLITE_TRANSACTIONS_EXCLUDED(*db)
-      LOCKS_EXCLUDED(mu_) {
+  // The caller's transaction is used for everything, so a batch of
+  // appends across many series costs a single commit; txn->Commit() may
+  // still be called along the way to bound the WAL read penalty.
+  Status Append(Sqlite* db, SqliteTransaction* txn, int64 step, uint64 now,
+                double computed_time, const Tensor& t)
+      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db) LOCKS_EXCLUDED(mu_) {
     mutex_lock lock(mu_);
     if (rowids_.empty()) {
-      Status s = Reserve(db, t);
+      Status s = Reserve(db, txn, t);
       if (!s.ok()) {
         rowids_.clear();
         return s;
@@ -673,16 +689,15 @@ class SeriesWriter {
 
  private:
   Status Write(Sqlite* db, int64 rowid, int64 step, double computed_time,
-               const Tensor& t) SQLITE_TRANSACTIONS_EXCLUDED(*db) {
+               const Tensor& t) SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (t.dtype() == DT_STRING) {
       if (t.dims() == 0) {
         return Update(db, step, computed_time, t, t.scalar<string>()(), rowid);
       } else {
-        SqliteTransaction txn(*db);
         TF_RETURN_IF_ERROR(
             Update(db, step, computed_time, t, StringPiece(), rowid));
-        TF_RETURN_IF_ERROR(UpdateNdString(db, t, rowid));
-        return txn.Commit();
+        return UpdateNdString(db, t, rowid);
       }
     } else {
       return Update(db, step, computed_time, t, t.tensor_data(), rowid);
@@ -690,75 +705,80 @@ class SeriesWriter {
   }
 
   Status Update(Sqlite* db, int64 step, double computed_time, const Tensor& t,
-                const StringPiece& data, int64 rowid) {
-    const char* sql = R"sql(
-      UPDATE OR REPLACE
-        Tensors
-      SET
-        step = ?,
-        computed_time = ?,
-        dtype = ?,
-        shape = ?,
-        data = ?
-      WHERE
-        rowid = ?
-    )sql";
-    SqliteStatement stmt;
-    TF_RETURN_IF_ERROR(db->Prepare(sql, &stmt));
-    stmt.BindInt(1, step);
-    stmt.BindDouble(2, computed_time);
-    stmt.BindInt(3, t.dtype());
-    stmt.BindText(4, StringifyShape(t.shape()));
-    stmt.BindBlobUnsafe(5, data);
-    stmt.BindInt(6, rowid);
-    TF_RETURN_IF_ERROR(stmt.StepAndReset());
+                const StringPiece& data, int64 rowid)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!update_) {
+      const char* sql = R"sql(
+        UPDATE OR REPLACE
+          Tensors
+        SET
+          step = ?,
+          computed_time = ?,
+          dtype = ?,
+          shape = ?,
+          data = ?
+        WHERE
+          rowid = ?
+      )sql";
+      TF_RETURN_IF_ERROR(db->Prepare(sql, &update_));
+    }
+    update_.BindInt(1, step);
+    update_.BindDouble(2, computed_time);
+    update_.BindInt(3, t.dtype());
+    update_.BindText(4, StringifyShape(t.shape()));
+    update_.BindBlobUnsafe(5, data);
+    update_.BindInt(6, rowid);
+    TF_RETURN_IF_ERROR(update_.StepAndReset());
     return Status::OK();
   }
 
   Status UpdateNdString(Sqlite* db, const Tensor& t, int64 tensor_rowid)
-      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db) {
+      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     DCHECK_EQ(t.dtype(), DT_STRING);
     DCHECK_GT(t.dims(), 0);
-    const char* deleter_sql = R"sql(
-      DELETE FROM TensorStrings WHERE tensor_rowid = ?
-    )sql";
-    SqliteStatement deleter;
-    TF_RETURN_IF_ERROR(db->Prepare(deleter_sql, &deleter));
-    deleter.BindInt(1, tensor_rowid);
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(deleter.StepAndReset(), tensor_rowid);
-    const char* inserter_sql = R"sql(
-      INSERT INTO TensorStrings (
-        tensor_rowid,
-        idx,
-        data
-      ) VALUES (?, ?, ?)
-    )sql";
-    SqliteStatement inserter;
-    TF_RETURN_IF_ERROR(db->Prepare(inserter_sql, &inserter));
+    if (!nds_deleter_) {
+      const char* deleter_sql = R"sql(
+        DELETE FROM TensorStrings WHERE tensor_rowid = ?
+      )sql";
+      TF_RETURN_IF_ERROR(db->Prepare(deleter_sql, &nds_deleter_));
+    }
+    nds_deleter_.BindInt(1, tensor_rowid);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(nds_deleter_.StepAndReset(), tensor_rowid);
+    if (!nds_inserter_) {
+      const char* inserter_sql = R"sql(
+        INSERT INTO TensorStrings (
+          tensor_rowid,
+          idx,
+          data
+        ) VALUES (?, ?, ?)
+      )sql";
+      TF_RETURN_IF_ERROR(db->Prepare(inserter_sql, &nds_inserter_));
+    }
     auto flat = t.flat<string>();
     for (int64 i = 0; i < flat.size(); ++i) {
-      inserter.BindInt(1, tensor_rowid);
-      inserter.BindInt(2, i);
-      inserter.BindBlobUnsafe(3, flat(i));
-      TF_RETURN_WITH_CONTEXT_IF_ERROR(inserter.StepAndReset(), "i=", i);
+      nds_inserter_.BindInt(1, tensor_rowid);
+      nds_inserter_.BindInt(2, i);
+      nds_inserter_.BindBlobUnsafe(3, flat(i));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(nds_inserter_.StepAndReset(), "i=", i);
     }
     return Status::OK();
   }
 
-  Status Reserve(Sqlite* db, const Tensor& t) SQLITE_TRANSACTIONS_EXCLUDED(*db)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    SqliteTransaction txn(*db);  // only for performance
+  Status Reserve(Sqlite* db, SqliteTransaction* txn, const Tensor& t)
+      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     unflushed_bytes_ = 0;
     if (t.dtype() == DT_STRING) {
       if (t.dims() == 0) {
-        TF_RETURN_IF_ERROR(ReserveData(db, &txn, t.scalar<string>()().size()));
+        TF_RETURN_IF_ERROR(ReserveData(db, txn, t.scalar<string>()().size()));
       } else {
-        TF_RETURN_IF_ERROR(ReserveTensors(db, &txn, kReserveMinBytes));
+        TF_RETURN_IF_ERROR(ReserveTensors(db, txn, kReserveMinBytes));
       }
     } else {
-      TF_RETURN_IF_ERROR(ReserveData(db, &txn, t.tensor_data().size()));
+      TF_RETURN_IF_ERROR(ReserveData(db, txn, t.tensor_data().size()));
     }
-    return txn.Commit();
+    return Status::OK();
   }
 
   Status ReserveData(Sqlite* db, SqliteTransaction* txn, size_t size)
@@ -774,21 +794,22 @@ class SeriesWriter {
                         int64 reserved_bytes)
       SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const char* sql = R"sql(
-      INSERT INTO Tensors (
-        series,
-        data
-      ) VALUES (?, ZEROBLOB(?))
-    )sql";
-    SqliteStatement insert;
-    TF_RETURN_IF_ERROR(db->Prepare(sql, &insert));
+    if (!reserve_insert_) {
+      const char* sql = R"sql(
+        INSERT INTO Tensors (
+          series,
+          data
+        ) VALUES (?, ZEROBLOB(?))
+      )sql";
+      TF_RETURN_IF_ERROR(db->Prepare(sql, &reserve_insert_));
+    }
     // TODO(jart): Maybe preallocate index pages by setting step. This
     //             is tricky because UPDATE OR REPLACE can have a side
     //             effect of deleting preallocated rows.
     for (int64 i = 0; i < kPreallocateRows; ++i) {
-      insert.BindInt(1, series_);
-      insert.BindInt(2, reserved_bytes);
-      TF_RETURN_WITH_CONTEXT_IF_ERROR(insert.StepAndReset(), "i=", i);
+      reserve_insert_.BindInt(1, series_);
+      reserve_insert_.BindInt(2, reserved_bytes);
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(reserve_insert_.StepAndReset(), "i=", i);
       rowids_.push_back(db->last_insert_rowid());
       unflushed_bytes_ += reserved_bytes;
       TF_RETURN_IF_ERROR(MaybeFlush(db, txn));
@@ -813,6 +834,10 @@ class SeriesWriter {
   uint64 count_ GUARDED_BY(mu_) = 0;
   std::deque<int64> rowids_ GUARDED_BY(mu_);
   uint64 unflushed_bytes_ GUARDED_BY(mu_) = 0;
+  SqliteStatement update_ GUARDED_BY(mu_);
+  SqliteStatement nds_deleter_ GUARDED_BY(mu_);
+  SqliteStatement nds_inserter_ GUARDED_BY(mu_);
+  SqliteStatement reserve_insert_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(SeriesWriter);
 };
@@ -828,11 +853,11 @@ class RunWriter {
  public:
   explicit RunWriter(RunMetadata* meta) : meta_{meta} {}
 
-  Status Append(Sqlite* db, int64 tag_id, int64 step, uint64 now,
-                double computed_time, const Tensor& t)
-      SQLITE_TRANSACTIONS_EXCLUDED(*db) LOCKS_EXCLUDED(mu_) {
+  Status Append(Sqlite* db, SqliteTransaction* txn, int64 tag_id, int64 step,
+                uint64 now, double computed_time, const Tensor& t)
+      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db) LOCKS_EXCLUDED(mu_) {
     SeriesWriter* writer = GetSeriesWriter(tag_id);
-    return writer->Append(db, step, now, computed_time, t);
+    return writer->Append(db, txn, step, now, computed_time, t);
   }
 
   Status Finish(Sqlite* db) SQLITE_TRANSACTIONS_EXCLUDED(*db)
@@ -888,6 +913,13 @@ class SummaryDbWriter : public SummaryWriterInterface {
 
   ~SummaryDbWriter() override {
     core::ScopedUnref unref(db_);
+    {
+      mutex_lock lock(buffer_mu_);
+      Status flush_status = FlushPendingLocked();
+      if (!flush_status.ok()) {
+        LOG(ERROR) << flush_status.ToString();
+      }
+    }
     Status s = run_.Finish(db_);
     if (!s.ok()) {
       // TODO(jart): Retry on transient errors here.
@@ -911,7 +943,10 @@ class SummaryDbWriter : public SummaryWriterInterface {
     }
   }
 
-  Status Flush() override { return Status::OK(); }
+  Status Flush() override LOCKS_EXCLUDED(buffer_mu_) {
+    mutex_lock lock(buffer_mu_);
+    return FlushPendingLocked();
+  }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
@@ -975,6 +1010,15 @@ class SummaryDbWriter : public SummaryWriterInterface {
   string DebugString() const override { return "SummaryDbWriter"; }
 
  private:
+  // A single tensor write queued for the next batched commit.
+  struct PendingWrite {
+    int64 tag_id;
+    int64 step;
+    uint64 now;
+    double computed_time;
+    Tensor tensor;
+  };
+
   Status Write(int64 step, const Tensor& t, const string& tag,
                const SummaryMetadata& metadata) {
     uint64 now = env_->NowMicros();
@@ -982,13 +1026,49 @@ class SummaryDbWriter : public SummaryWriterInterface {
     int64 tag_id;
     TF_RETURN_IF_ERROR(
         meta_.GetTagId(db_, now, computed_time, tag, &tag_id, metadata));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        run_.Append(db_, tag_id, step, now, computed_time, t),
-        meta_.user_name(), "/", meta_.experiment_name(), "/", meta_.run_name(),
-        "/", tag, "@", step);
+    return EnqueueWrite(tag_id, step, now, computed_time, t);
+  }
+
+  // Queues the tensor; the batch is committed once kMaxPendingWrites
+  // writes or kFlushBytes of data accumulate, or on Flush()/destruction.
+  // Note errors for a queued write surface on the flushing call.
+  Status EnqueueWrite(int64 tag_id, int64 step, uint64 now,
+                      double computed_time, const Tensor& t)
+      LOCKS_EXCLUDED(buffer_mu_) {
+    mutex_lock lock(buffer_mu_);
+    pending_.push_back(PendingWrite{tag_id, step, now, computed_time, t});
+    pending_bytes_ += t.TotalBytes();
+    if (pending_.size() >= kMaxPendingWrites || pending_bytes_ >= kFlushBytes) {
+      return FlushPendingLocked();
+    }
     return Status::OK();
   }
 
+  Status FlushPendingLocked() EXCLUSIVE_LOCKS_REQUIRED(buffer_mu_)
+      SQLITE_TRANSACTIONS_EXCLUDED(*db_) {
+    if (pending_.empty()) return Status::OK();
+    Status s;
+    {
+      SqliteTransaction txn(*db_);
+      for (const PendingWrite& w : pending_) {
+        s = run_.Append(db_, &txn, w.tag_id, w.step, w.now, w.computed_time,
+                        w.tensor);
+        if (!s.ok()) {
+          errors::AppendToMessage(&s, meta_.user_name(), "/",
+                                  meta_.experiment_name(), "/",
+                                  meta_.run_name(), " tag_id=", w.tag_id, "@",
+                                  w.step);
+          break;
+        }
+      }
+      if (s.ok()) s = txn.Commit();
+    }  // Rolls back on error.
+    // Drop the batch either way so one poison write can't wedge the buffer.
+    pending_.clear();
+    pending_bytes_ = 0;
+    return s;
+  }
+
   Status MigrateEvent(std::unique_ptr<Event> e) {
     switch (e->what_case()) {
       case Event::WhatCase::kSummary: {
@@ -1055,7 +1135,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     int64 tag_id;
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return EnqueueWrite(tag_id, e->step(), now, e->wall_time(), t);
   }
 
   // TODO(jart): Refactor Summary -> Tensor logic into separate file.
@@ -1068,7 +1148,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kScalarPluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return EnqueueWrite(tag_id, e->step(), now, e->wall_time(), t);
   }
 
   Status MigrateHistogram(const Event* e, Summary::Value* s, uint64 now) {
@@ -1099,7 +1179,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kHistogramPluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return EnqueueWrite(tag_id, e->step(), now, e->wall_time(), t);
   }
 
   Status MigrateImage(const Event* e, Summary::Value* s, uint64 now) {
@@ -1113,7 +1193,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kImagePluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return EnqueueWrite(tag_id, e->step(), now, e->wall_time(), t);
   }
 
   Status MigrateAudio(const Event* e, Summary::Value* s, uint64 now) {
@@ -1126,7 +1206,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kAudioPluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return EnqueueWrite(tag_id, e->step(), now, e->wall_time(), t);
   }
 
   Env* const env_;
@@ -1134,6 +1214,9 @@ class SummaryDbWriter : public SummaryWriterInterface {
   IdAllocator ids_;
   RunMetadata meta_;
   RunWriter run_;
+  mutex buffer_mu_;
+  std::vector<PendingWrite> pending_ GUARDED_BY(buffer_mu_);
+  uint64 pending_bytes_ GUARDED_BY(buffer_mu_) = 0;
 };
 
 }  // namespace
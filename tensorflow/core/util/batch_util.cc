@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/util/batch_util.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -41,43 +44,54 @@ Status ValidateInput(const Tensor& parent, const Tensor& element, int64 index) {
   return Status::OK();
 }
 
+// Copies `element` into a (0th dimension) slice of `parent`. The slice of
+// `parent` starts at `dest` and the flattened contents of `element` start at
+// `src`. Both slices are contiguous, so for simple (memcpy-able) dtypes the
+// copy is a single memcpy; reference-counted dtypes are moved element-wise
+// when this call holds the last reference to `element`.
 template <typename T>
-Status HandleElementToSlice(Tensor element, Tensor* parent, int64 index,
-                            bool /* can_move */) {
-  parent->flat_outer_dims<T>().chip(index, 0) = element.flat<T>();
+Status HandleElementToSlice(const Tensor& /* element */, T* src, T* dest,
+                            int64 num_values) {
+  static_assert(is_simple_type<T>::value, "Memcpy requires a simple type.");
+  memcpy(dest, src, num_values * sizeof(T));
   return Status::OK();
 }
 
 template <>
-Status HandleElementToSlice<string>(Tensor element, Tensor* parent, int64 index,
-                                    bool can_move) {
-  auto parent_as_matrix = parent->flat_outer_dims<string>();
-  auto element_flat = element.flat<string>();
-  if (can_move) {
-    for (int64 i = 0; i < element.NumElements(); ++i) {
-      parent_as_matrix(index, i) = std::move(element_flat(i));
+Status HandleElementToSlice<string>(const Tensor& element, string* src,
+                                    string* dest, int64 num_values) {
+  if (element.RefCountIsOne()) {
+    for (int64 i = 0; i < num_values; ++i) {
+      *dest++ = std::move(*src++);
     }
   } else {
-    parent_as_matrix.chip(index, 0) = element_flat;
+    std::copy_n(src, num_values, dest);
   }
   return Status::OK();
 }
 
 template <>
-Status HandleElementToSlice<Variant>(Tensor element, Tensor* parent,
-                                     int64 index, bool can_move) {
-  auto parent_as_matrix = parent->flat_outer_dims<Variant>();
-  auto element_flat = element.flat<Variant>();
-  if (can_move) {
-    for (int64 i = 0; i < element.NumElements(); ++i) {
-      parent_as_matrix(index, i) = std::move(element_flat(i));
+Status HandleElementToSlice<Variant>(const Tensor& element, Variant* src,
+                                     Variant* dest, int64 num_values) {
+  if (element.RefCountIsOne()) {
+    for (int64 i = 0; i < num_values; ++i) {
+      *dest++ = std::move(*src++);
     }
   } else {
-    parent_as_matrix.chip(index, 0) = element_flat;
+    std::copy_n(src, num_values, dest);
   }
   return Status::OK();
 }
 
+template <>
+Status HandleElementToSlice<ResourceHandle>(const Tensor& /* element */,
+                                            ResourceHandle* src,
+                                            ResourceHandle* dest,
+                                            int64 num_values) {
+  std::copy_n(src, num_values, dest);
+  return Status::OK();
+}
+
 // TODO(b/78245576): Consider removing this overload.
 template <typename T>
 void HandleSliceToElement(const Tensor& parent, Tensor* element, int64 index) {
@@ -123,12 +137,12 @@ void HandleSliceToElement<Variant>(Tensor* parent, Tensor* element, int64 index,
 // Copies element into the index^th slice of parent (in the 0th dimension).
 Status CopyElementToSlice(Tensor element, Tensor* parent, int64 index) {
   TF_RETURN_IF_ERROR(ValidateInput(*parent, element, index));
-
-  bool can_move = element.RefCountIsOne();
-#define HANDLE_TYPE(T)                                                \
-  case DataTypeToEnum<T>::value: {                                    \
-    return HandleElementToSlice<T>(std::move(element), parent, index, \
-                                   can_move);                         \
+  const int64 num_values = element.NumElements();
+#define HANDLE_TYPE(T)                                              \
+  case DataTypeToEnum<T>::value: {                                  \
+    T* src = element.base<T>();                                     \
+    T* dest = parent->base<T>() + (num_values * index);             \
+    return HandleElementToSlice<T>(element, src, dest, num_values); \
   }
 
   switch (element.dtype()) {
@@ -18,6 +18,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_CTC_CTC_BEAM_ENTRY_H_
 
 #include <algorithm>
+#include <deque>
 #include <memory>
 #include <vector>
 
@@ -59,8 +60,10 @@ class BeamRoot;
 template <class CTCBeamState = EmptyBeamState>
 struct BeamEntry {
   // BeamRoot<CTCBeamState>::AddEntry() serves as the factory method.
-  friend BeamEntry<CTCBeamState>* BeamRoot<CTCBeamState>::AddEntry(
-      BeamEntry<CTCBeamState>* p, int l);
+  // The object pointed to by p cannot be copied and should not be moved,
+  // otherwise parent will become invalid.
+  BeamEntry(BeamEntry* p, int l, BeamRoot<CTCBeamState>* beam_root)
+      : parent(p), label(l), beam_root(beam_root) {}
   inline bool Active() const { return newp.total != kLogZero; }
   // Return the child at the given index, or construct a new one in-place if
   // none was found.
@@ -97,19 +100,15 @@ struct BeamEntry {
   CTCBeamState state;
 
  private:
-  // Constructor giving parent, label, and the beam_root.
-  // The object pointed to by p cannot be copied and should not be moved,
-  // otherwise parent will become invalid.
-  // This private constructor is only called through the factory method
-  // BeamRoot<CTCBeamState>::AddEntry().
-  BeamEntry(BeamEntry* p, int l, BeamRoot<CTCBeamState>* beam_root)
-      : parent(p), label(l), beam_root(beam_root) {}
   BeamRoot<CTCBeamState>* beam_root;
   TF_DISALLOW_COPY_AND_ASSIGN(BeamEntry);
 };
 
 // This class owns all instances of BeamEntry.  This is used to avoid recursive
-// destructor call during destruction.
+// destructor call during destruction.  Entries are stored in deque chunks
+// rather than allocated one at a time, which amortizes the allocation cost of
+// growing the beam tree; a deque never relocates existing elements, so the
+// parent/child pointers between entries stay valid.
 template <class CTCBeamState = EmptyBeamState>
 class BeamRoot {
  public:
@@ -118,15 +117,14 @@ class BeamRoot {
   BeamRoot& operator=(const BeamRoot&) = delete;
 
   BeamEntry<CTCBeamState>* AddEntry(BeamEntry<CTCBeamState>* p, int l) {
-    auto* new_entry = new BeamEntry<CTCBeamState>(p, l, this);
-    beam_entries_.emplace_back(new_entry);
-    return new_entry;
+    beam_entries_.emplace_back(p, l, this);
+    return &beam_entries_.back();
   }
   BeamEntry<CTCBeamState>* RootEntry() const { return root_entry_; }
 
  private:
   BeamEntry<CTCBeamState>* root_entry_ = nullptr;
-  std::vector<std::unique_ptr<BeamEntry<CTCBeamState>>> beam_entries_;
+  std::deque<BeamEntry<CTCBeamState>> beam_entries_;
 };
 
 // BeamComparer is the default beam comparer provided in CTCBeamSearch.
@@ -33,45 +33,70 @@ void CTCLossCalculator::CalculateForwardVariables(
 
   CHECK_EQ(U, log_alpha->rows());
 
+  // Gather the activations for every l_prime position up front so that the
+  // log() below runs vectorized over the whole U x T block instead of once
+  // per cell inside the recursion.
+  Matrix log_y_prime(U, T);
+  for (int u = 0; u < U; ++u) {
+    log_y_prime.row(u) = y.row(l_prime[u]).segment(output_delay_, T);
+  }
+  log_y_prime.array() = log_y_prime.array().log();
+
+  // Additive masks encoding the transition structure of (GravesTh) Eq 7.9;
+  // adding kLogZero knocks a term out of the log-sum-exp. They only depend
+  // on l_prime, so they are computed once outside the time loop.
+  Array self_mask(U);  // the (u, t - 1) term
+  Array skip_mask(U);  // the (u - 2, t - 1) term
+  for (int u = 0; u < U; ++u) {
+    self_mask(u) =
+        (ctc_merge_repeated || l_prime[u] == blank_index_) ? 0.0f : kLogZero;
+    const bool matching_labels_merge =
+        ctc_merge_repeated && u > 1 && (l_prime[u] == l_prime[u - 2]);
+    skip_mask(u) =
+        (u > 1 && l_prime[u] != blank_index_ && !matching_labels_merge)
+            ? 0.0f
+            : kLogZero;
+  }
+
   // Initial alpha values in (GravesTh) Eq 7.5 and Eq 7.6.
-  log_alpha->coeffRef(0, 0) = log(y(blank_index_, output_delay_));
-  // Below, l_prime[1] == labels[0]
-  auto label_0 = (l_prime.size() > 1) ? l_prime[1] : blank_index_;
-  log_alpha->coeffRef(1, 0) = log(y(label_0, output_delay_));
+  log_alpha->coeffRef(0, 0) = log_y_prime(0, 0);
+  if (U > 1) log_alpha->coeffRef(1, 0) = log_y_prime(1, 0);
+
+  // Work array holding the previous column, padded with two leading
+  // kLogZero entries so the shifted (u - 1) and (u - 2) reads below never
+  // have to branch on u.
+  Array work(U + 2);
+  work(0) = kLogZero;
+  work(1) = kLogZero;
 
   for (int t = 1; t < T; ++t) {
     // If there is not enough time to output the remaining labels or
     // some labels have been skipped, then let log_alpha(u, t) continue to
     // be kLogZero.
-    for (int u = std::max(0, U - (2 * (T - t))); u < std::min(U, 2 * (t + 1));
-         ++u) {
-      // Begin (GravesTh) Eq 7.9
-      // Add in the u, t - 1 term.
-      float sum_log_alpha = kLogZero;
-      if (ctc_merge_repeated || l_prime[u] == blank_index_) {
-        sum_log_alpha = log_alpha->coeff(u, t - 1);
-      }
-
-      // Add in the u - 1, t - 1 term.
-      if (u > 0) {
-        sum_log_alpha =
-            LogSumExp(sum_log_alpha, log_alpha->coeff(u - 1, t - 1));
-      }
-
-      // Add in the u - 2, t - 1 term if l_prime(u) != blank or l_prime(u-2).
-      if (u > 1) {
-        const bool matching_labels_merge =
-            ctc_merge_repeated && (l_prime[u] == l_prime[u - 2]);
-        if (l_prime[u] != blank_index_ && !matching_labels_merge) {
-          sum_log_alpha =
-              LogSumExp(sum_log_alpha, log_alpha->coeff(u - 2, t - 1));
-        }
-      }
-      // Multiply the summed alphas with the activation log probability.
-      log_alpha->coeffRef(u, t) =
-          log(y(l_prime[u], output_delay_ + t)) + sum_log_alpha;
-    }  // End (GravesTh) Eq 7.9.
-  }
+    const int lo = std::max(0, U - (2 * (T - t)));
+    const int hi = std::min(U, 2 * (t + 1));
+    const int len = hi - lo;
+
+    work.segment(2, U) = log_alpha->col(t - 1).array();
+
+    // The three terms of (GravesTh) Eq 7.9, evaluated for all u at once.
+    auto prev_self = work.segment(lo + 2, len) + self_mask.segment(lo, len);
+    auto prev_down1 = work.segment(lo + 1, len);
+    auto prev_down2 = work.segment(lo, len) + skip_mask.segment(lo, len);
+
+    // Vectorized log-sum-exp of the three terms, then multiply the summed
+    // alphas with the activation log probability. Where all terms are
+    // kLogZero the cell stays kLogZero.
+    Array max3 = prev_self.max(prev_down1).max(prev_down2);
+    log_alpha->col(t).segment(lo, len).array() =
+        (max3 != kLogZero)
+            .select(max3 +
+                        ((prev_self - max3).exp() + (prev_down1 - max3).exp() +
+                         (prev_down2 - max3).exp())
+                            .log() +
+                        log_y_prime.col(t).segment(lo, len).array(),
+                    kLogZero);
+  }  // End (GravesTh) Eq 7.9.
 }
 
 // Calculates the beta(t, u) as described in (GravesTh) Section 7.3.
@@ -87,46 +112,63 @@ void CTCLossCalculator::CalculateBackwardVariables(
   int U = l_prime.size();
   CHECK_EQ(U, log_beta->rows());
 
+  // As in CalculateForwardVariables: gather the per-position activations
+  // once so the log() is vectorized over the whole block.
+  Matrix log_y_prime(U, T);
+  for (int u = 0; u < U; ++u) {
+    log_y_prime.row(u) = y.row(l_prime[u]).segment(output_delay_, T);
+  }
+  log_y_prime.array() = log_y_prime.array().log();
+
+  // Additive masks for the transition structure of (GravesTh) Eq 7.15.
+  Array self_mask(U);  // the (u, t + 1) term
+  Array skip_mask(U);  // the (u + 2, t + 1) term
+  for (int u = 0; u < U; ++u) {
+    self_mask(u) =
+        (ctc_merge_repeated || l_prime[u] == blank_index_) ? 0.0f : kLogZero;
+    const bool matching_labels_merge =
+        ctc_merge_repeated && u + 2 < U && (l_prime[u] == l_prime[u + 2]);
+    skip_mask(u) = (l_prime[u] != blank_index_ && !matching_labels_merge)
+                       ? 0.0f
+                       : kLogZero;
+  }
+
   // Initial beta values in (GravesTh) Eq 7.13: log of probability 1.
-  for (int u = U - 2; u < U; ++u) log_beta->coeffRef(u, T - 1) = 0;
+  for (int u = std::max(0, U - 2); u < U; ++u) {
+    log_beta->coeffRef(u, T - 1) = 0;
+  }
+
+  // Work array holding beta(., t + 1) + log y'(., t + 1), padded with two
+  // trailing kLogZero entries so the shifted (u + 1) and (u + 2) reads
+  // below never have to branch on u.
+  Array work(U + 2);
+  work(U) = kLogZero;
+  work(U + 1) = kLogZero;
 
   for (int t = T - 1 - 1; t >= 0; --t) {
     // If there is not enough time to output the remaining labels or
     // some labels have been skipped, then let log_beta(u, t) continue to
     // be kLogZero.
-    for (int u = std::max(0, U - (2 * (T - t))); u < std::min(U, 2 * (t + 1));
-         ++u) {
-      // Begin (GravesTh) Eq 7.15
-      // Add in the u, t + 1 term.
-      if (ctc_merge_repeated || l_prime[u] == blank_index_) {
-        log_beta->coeffRef(u, t) =
-            LogSumExp(log_beta->coeff(u, t),
-                      log_beta->coeff(u, t + 1) +
-                          log(y(l_prime[u], output_delay_ + t + 1)));
-      }
-
-      // Add in the u + 1, t + 1 term.
-      if (u + 1 < U) {
-        log_beta->coeffRef(u, t) =
-            LogSumExp(log_beta->coeff(u, t),
-                      log_beta->coeff(u + 1, t + 1) +
-                          log(y(l_prime[u + 1], output_delay_ + t + 1)));
-      }
-
-      // Add in the u + 2, t + 1 term if l_prime(u) != blank or l_prime(u+2).
-      if (u + 2 < U) {
-        const bool matching_labels_merge =
-            ctc_merge_repeated && (l_prime[u] == l_prime[u + 2]);
-        if (l_prime[u] != blank_index_ && !matching_labels_merge) {
-          // Add in u + 2 term.
-          log_beta->coeffRef(u, t) =
-              LogSumExp(log_beta->coeff(u, t),
-                        log_beta->coeff(u + 2, t + 1) +
-                            log(y(l_prime[u + 2], output_delay_ + t + 1)));
-        }
-      }  // End (GravesTh) Eq. 7.15
-    }
-  }
+    const int lo = std::max(0, U - (2 * (T - t)));
+    const int hi = std::min(U, 2 * (t + 1));
+    const int len = hi - lo;
+
+    work.head(U) =
+        log_beta->col(t + 1).array() + log_y_prime.col(t + 1).array();
+
+    // The three terms of (GravesTh) Eq 7.15, evaluated for all u at once.
+    auto next_self = work.segment(lo, len) + self_mask.segment(lo, len);
+    auto next_up1 = work.segment(lo + 1, len);
+    auto next_up2 = work.segment(lo + 2, len) + skip_mask.segment(lo, len);
+
+    Array max3 = next_self.max(next_up1).max(next_up2);
+    log_beta->col(t).segment(lo, len).array() =
+        (max3 != kLogZero)
+            .select(max3 + ((next_self - max3).exp() + (next_up1 - max3).exp() +
+                            (next_up2 - max3).exp())
+                               .log(),
+                    kLogZero);
+  }  // End (GravesTh) Eq. 7.15
 }
 
 // Using (GravesTh) Eq 7.26 & 7.34.
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <stddef.h>  // for NULL
 
+#include <utility>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -26,23 +28,63 @@ limitations under the License.
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
+namespace {
+
+// Bound on each of the two pending-event buffers; a writer blocks once the
+// active buffer is full and the background thread is still busy.
+const size_t kMaxPendingEvents = 4096;
+
+// Read per writer instance rather than latched process-wide, so tests and
+// long-lived processes can toggle the mode between writers.
+bool AsyncModeEnabled() {
+  bool enabled = false;
+  Status status =
+      ReadBoolFromEnvVar("TF_EVENTS_WRITER_ASYNC", false, &enabled);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+    return false;
+  }
+  return enabled;
+}
+
+}  // namespace
 
 EventsWriter::EventsWriter(const string& file_prefix)
     // TODO(jeff,sanjay): Pass in env and use that here instead of Env::Default
     : env_(Env::Default()),
       file_prefix_(file_prefix),
-      num_outstanding_events_(0) {}
+      num_outstanding_events_(0),
+      async_(AsyncModeEnabled()),
+      active_buffer_(0),
+      worker_busy_(false),
+      worker_stop_(false) {
+  if (async_) {
+    worker_thread_.reset(env_->StartThread(ThreadOptions(), "events_writer",
+                                           [this]() { AsyncWorkerLoop(); }));
+  }
+}
 
 EventsWriter::~EventsWriter() {
+  if (worker_thread_ != nullptr) {
+    {
+      mutex_lock l(queue_mu_);
+      worker_stop_ = true;
+      pending_available_cv_.notify_all();
+    }
+    // Joins the thread; the worker writes out any remaining events first.
+    worker_thread_.reset();
+  }
   Close().IgnoreError();  // Autoclose in destructor.
 }
 
 Status EventsWriter::Init() { return InitWithSuffix(""); }
 
 Status EventsWriter::InitWithSuffix(const string& suffix) {
+  mutex_lock l(file_mu_);
   file_suffix_ = suffix;
   return InitIfNeeded();
 }
@@ -89,20 +131,23 @@ Status EventsWriter::InitIfNeeded() {
     Event event;
     event.set_wall_time(time_in_seconds);
     event.set_file_version(strings::StrCat(kVersionPrefix, kCurrentVersion));
-    WriteEvent(event);
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(Flush(), "Flushing first event.");
+    string record;
+    event.AppendToString(&record);
+    WriteSerializedEventLocked(record);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(FlushLocked(), "Flushing first event.");
   }
   return Status::OK();
 }
 
 string EventsWriter::FileName() {
+  mutex_lock l(file_mu_);
   if (filename_.empty()) {
     InitIfNeeded().IgnoreError();
   }
   return filename_;
 }
 
-void EventsWriter::WriteSerializedEvent(StringPiece event_str) {
+void EventsWriter::WriteSerializedEventLocked(StringPiece event_str) {
   if (recordio_writer_ == nullptr) {
     if (!InitIfNeeded().ok()) {
       LOG(ERROR) << "Write failed because file could not be opened.";
@@ -113,15 +158,104 @@ void EventsWriter::WriteSerializedEvent(StringPiece event_str) {
   recordio_writer_->WriteRecord(event_str).IgnoreError();
 }
 
+void EventsWriter::WriteSerializedEvent(StringPiece event_str) {
+  if (async_) {
+    PendingEvent pending;
+    pending.is_serialized = true;
+    pending.record.assign(event_str.data(), event_str.size());
+    EnqueuePending(&pending);
+    return;
+  }
+  mutex_lock l(file_mu_);
+  WriteSerializedEventLocked(event_str);
+}
+
 // NOTE(touts); This is NOT the function called by the Python code.
 // Python calls WriteSerializedEvent(), see events_writer.i.
 void EventsWriter::WriteEvent(const Event& event) {
+  if (async_) {
+    // Serialization is deferred to the background thread.
+    PendingEvent pending;
+    pending.is_serialized = false;
+    pending.event = event;
+    EnqueuePending(&pending);
+    return;
+  }
   string record;
   event.AppendToString(&record);
-  WriteSerializedEvent(record);
+  mutex_lock l(file_mu_);
+  WriteSerializedEventLocked(record);
+}
+
+void EventsWriter::EnqueuePending(PendingEvent* pending) {
+  mutex_lock l(queue_mu_);
+  while (pending_buffers_[active_buffer_].size() >= kMaxPendingEvents &&
+         !worker_stop_) {
+    pending_space_cv_.wait(l);
+  }
+  pending_buffers_[active_buffer_].push_back(std::move(*pending));
+  pending_available_cv_.notify_one();
+}
+
+void EventsWriter::DrainPendingEvents() {
+  mutex_lock l(queue_mu_);
+  while (worker_busy_ || !pending_buffers_[active_buffer_].empty()) {
+    pending_drained_cv_.wait(l);
+  }
+}
+
+void EventsWriter::AsyncWorkerLoop() {
+  std::vector<PendingEvent> batch;
+  while (true) {
+    {
+      mutex_lock l(queue_mu_);
+      while (pending_buffers_[active_buffer_].empty() && !worker_stop_) {
+        pending_available_cv_.wait(l);
+      }
+      if (pending_buffers_[active_buffer_].empty()) {
+        return;  // Stopped with nothing left to write.
+      }
+      // Take the filled buffer; writers keep appending to the other one.
+      batch.swap(pending_buffers_[active_buffer_]);
+      active_buffer_ = 1 - active_buffer_;
+      worker_busy_ = true;
+      pending_space_cv_.notify_all();
+    }
+    {
+      mutex_lock l(file_mu_);
+      for (PendingEvent& pending : batch) {
+        if (!pending.is_serialized) {
+          pending.record.clear();
+          pending.event.AppendToString(&pending.record);
+        }
+        WriteSerializedEventLocked(pending.record);
+      }
+      // One buffered flush per batch instead of per event; durability is
+      // still provided by Flush() and Close(), which sync.
+      if (recordio_writer_ != nullptr) {
+        recordio_writer_->Flush().IgnoreError();
+      }
+    }
+    batch.clear();
+    {
+      mutex_lock l(queue_mu_);
+      worker_busy_ = false;
+      if (pending_buffers_[active_buffer_].empty()) {
+        pending_drained_cv_.notify_all();
+      }
+    }
+  }
 }
 
 Status EventsWriter::Flush() {
+  if (async_) {
+    DrainPendingEvents();
+  }
+  mutex_lock l(file_mu_);
+  return FlushLocked();
+}
+
+Status EventsWriter::FlushLocked() {
   if (num_outstanding_events_ == 0) return Status::OK();
   CHECK(recordio_file_ != nullptr) << "Unexpected NULL file";
 
@@ -149,7 +283,11 @@ Status EventsWriter::Flush() {
 }
 
 Status EventsWriter::Close() {
-  Status status = Flush();
+  if (async_) {
+    DrainPendingEvents();
+  }
+  mutex_lock l(file_mu_);
+  Status status = FlushLocked();
   if (recordio_file_ != nullptr) {
     Status close_status = recordio_file_->Close();
     if (!close_status.ok()) {
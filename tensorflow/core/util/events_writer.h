@@ -18,11 +18,14 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/event.pb.h"
 
@@ -80,16 +83,59 @@ class EventsWriter {
   Status Close();
 
  private:
-  Status FileStillExists();  // OK if event_file_path_ exists.
-  Status InitIfNeeded();
+  // An event waiting for the background thread, either as a proto still to
+  // be serialized (WriteEvent) or as an already serialized record
+  // (WriteSerializedEvent).
+  struct PendingEvent {
+    bool is_serialized;
+    Event event;
+    string record;
+  };
+
+  Status FileStillExists() EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  Status InitIfNeeded() EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  void WriteSerializedEventLocked(StringPiece event_str)
+      EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  Status FlushLocked() EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+
+  // Async mode: appends the event to the active buffer, blocking while the
+  // buffer is full.
+  void EnqueuePending(PendingEvent* pending);
+  // Async mode: blocks until both buffers are empty and the background
+  // thread is idle.
+  void DrainPendingEvents();
+  // Body of the background thread: repeatedly swaps out the filled buffer,
+  // then serializes and writes its events with one buffered flush per batch.
+  void AsyncWorkerLoop();
 
   Env* env_;
   const string file_prefix_;
   string file_suffix_;
   string filename_;
-  std::unique_ptr<WritableFile> recordio_file_;
-  std::unique_ptr<io::RecordWriter> recordio_writer_;
-  int num_outstanding_events_;
+
+  // Serializes access to the underlying file between callers and the
+  // background thread.  In synchronous mode it is only ever taken by the
+  // calling thread.
+  mutex file_mu_;
+  std::unique_ptr<WritableFile> recordio_file_ GUARDED_BY(file_mu_);
+  std::unique_ptr<io::RecordWriter> recordio_writer_ GUARDED_BY(file_mu_);
+  int num_outstanding_events_ GUARDED_BY(file_mu_);
+
+  // Async mode (enabled with TF_EVENTS_WRITER_ASYNC): writers append events
+  // to a bounded double buffer and a background thread serializes and writes
+  // them in batches.  Flush() and Close() drain the buffers first, so their
+  // guarantees and the file format are unchanged.
+  const bool async_;
+  mutex queue_mu_;
+  condition_variable pending_available_cv_;
+  condition_variable pending_space_cv_;
+  condition_variable pending_drained_cv_;
+  std::vector<PendingEvent> pending_buffers_[2] GUARDED_BY(queue_mu_);
+  int active_buffer_ GUARDED_BY(queue_mu_);
+  bool worker_busy_ GUARDED_BY(queue_mu_);
+  bool worker_stop_ GUARDED_BY(queue_mu_);
+  std::unique_ptr<Thread> worker_thread_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(EventsWriter);
 };
 
@@ -191,6 +191,33 @@ TEST(EventWriter, NameClose) {
   TF_ASSERT_OK(env()->DeleteFile(filename));
 }
 
+TEST(EventWriter, AsyncWriteFlush) {
+  setenv("TF_EVENTS_WRITER_ASYNC", "1", 1);
+  {
+    string file_prefix = GetDirName("/asyncwriteflush_test");
+    EventsWriter writer(file_prefix);
+    WriteFile(&writer);
+    TF_EXPECT_OK(writer.Flush());
+    string filename = writer.FileName();
+    VerifyFile(filename);
+  }
+  unsetenv("TF_EVENTS_WRITER_ASYNC");
+}
+
+TEST(EventWriter, AsyncWriteDelete) {
+  setenv("TF_EVENTS_WRITER_ASYNC", "1", 1);
+  {
+    string file_prefix = GetDirName("/asyncwritedelete_test");
+    EventsWriter* writer = new EventsWriter(file_prefix);
+    WriteFile(writer);
+    string filename = writer->FileName();
+    // The destructor must drain the pending events before closing.
+    delete writer;
+    VerifyFile(filename);
+  }
+  unsetenv("TF_EVENTS_WRITER_ASYNC");
+}
+
 TEST(EventWriter, FileDeletionBeforeWriting) {
   string file_prefix = GetDirName("/fdbw_test");
   EventsWriter writer(file_prefix);
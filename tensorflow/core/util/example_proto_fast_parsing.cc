@@ -1000,47 +1000,90 @@ class TensorVector {
 
 }  // namespace
 
-Status FastParseExample(const Config& config,
-                        gtl::ArraySlice<string> serialized,
-                        gtl::ArraySlice<string> example_names,
-                        thread::ThreadPool* thread_pool, Result* result) {
-  DCHECK(result != nullptr);
-  // Check config so we can safely CHECK(false) in switches on config.*.dtype
-  for (auto& c : config.sparse) {
-    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
-  }
-  for (auto& c : config.dense) {
-    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
-  }
+namespace internal {
 
-  if (config.collect_feature_stats) {
-    result->feature_stats.resize(serialized.size());
-  }
+// Holds the feature-name-to-config-slot table for a config, together with
+// the hash seed for which the table was built collision-free.
+struct FastParseExampleConfigIndexImpl {
+  explicit FastParseExampleConfigIndexImpl(size_t config_size)
+      : config_index(config_size) {}
 
-  size_t config_size = config.dense.size() + config.sparse.size();
+  PresizedCuckooMap<std::pair<size_t, Type>> config_index;
   SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
+};
+
+}  // namespace internal
+
+FastParseExampleConfigIndex::FastParseExampleConfigIndex() = default;
+FastParseExampleConfigIndex::~FastParseExampleConfigIndex() = default;
+FastParseExampleConfigIndex::FastParseExampleConfigIndex(
+    FastParseExampleConfigIndex&&) = default;
+FastParseExampleConfigIndex& FastParseExampleConfigIndex::operator=(
+    FastParseExampleConfigIndex&&) = default;
+
+Status FastParseExampleConfigIndex::Build(const Config& config) {
+  const size_t config_size = config.dense.size() + config.sparse.size();
+  auto impl = std::unique_ptr<internal::FastParseExampleConfigIndexImpl>(
+      new internal::FastParseExampleConfigIndexImpl(config_size));
   bool ok = true;
   for (size_t i = 0; i < 1000; ++i) {
     for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
+      ok &= impl->config_index.InsertUnique(
+          impl->hasher(config.dense[d].feature_name), {d, Type::Dense});
     }
     for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
+      ok &= impl->config_index.InsertUnique(
+          impl->hasher(config.sparse[d].feature_name), {d, Type::Sparse});
     }
     if (ok) break;
     LOG(WARNING) << "Collision found. This should happen only if you have "
                     "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
+    impl->hasher.seed++;
+    impl->config_index.Clear(config_size);
   }
   if (!ok) {
     return errors::Internal(
         "Could not avoid collision. This should not happen.");
   }
+  impl_ = std::move(impl);
+  return Status::OK();
+}
+
+Status FastParseExample(const Config& config,
+                        gtl::ArraySlice<string> serialized,
+                        gtl::ArraySlice<string> example_names,
+                        thread::ThreadPool* thread_pool, Result* result) {
+  FastParseExampleConfigIndex index;
+  TF_RETURN_IF_ERROR(index.Build(config));
+  return FastParseExample(config, serialized, example_names, thread_pool,
+                          result, index);
+}
+
+Status FastParseExample(const Config& config,
+                        gtl::ArraySlice<string> serialized,
+                        gtl::ArraySlice<string> example_names,
+                        thread::ThreadPool* thread_pool, Result* result,
+                        const FastParseExampleConfigIndex& index) {
+  DCHECK(result != nullptr);
+  if (!index.initialized()) {
+    return errors::Internal(
+        "FastParseExample called with an uninitialized config index.");
+  }
+  // Check config so we can safely CHECK(false) in switches on config.*.dtype
+  for (auto& c : config.sparse) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+  for (auto& c : config.dense) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+
+  if (config.collect_feature_stats) {
+    result->feature_stats.resize(serialized.size());
+  }
+
+  const PresizedCuckooMap<std::pair<size_t, Type>>& config_index =
+      index.impl()->config_index;
+  const SeededHasher& hasher = index.impl()->hasher;
 
   // Allocate dense output for fixed length dense values
   // (variable-length dense and sparse have to be buffered).
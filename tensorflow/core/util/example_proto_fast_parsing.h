@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 #define TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -94,6 +95,38 @@ struct Result {
   std::vector<PerExampleFeatureStats> feature_stats;
 };
 
+namespace internal {
+struct FastParseExampleConfigIndexImpl;
+}  // namespace internal
+
+// Precomputed feature-name-to-config-slot hash table for a
+// `FastParseExampleConfig`. `FastParseExample` rebuilds this table on every
+// call unless one is supplied; callers that parse many batches with an
+// unchanging config (e.g. input pipelines) should build the index once at
+// setup time and pass it alongside the config. An index is only valid for
+// the exact config it was built from.
+class FastParseExampleConfigIndex {
+ public:
+  FastParseExampleConfigIndex();
+  ~FastParseExampleConfigIndex();
+  FastParseExampleConfigIndex(FastParseExampleConfigIndex&&);
+  FastParseExampleConfigIndex& operator=(FastParseExampleConfigIndex&&);
+
+  // Builds the index for `config`, replacing any previous contents.
+  Status Build(const FastParseExampleConfig& config);
+
+  // Returns whether `Build` has completed successfully.
+  bool initialized() const { return impl_ != nullptr; }
+
+  // Opaque; the implementation is private to example_proto_fast_parsing.cc.
+  const internal::FastParseExampleConfigIndexImpl* impl() const {
+    return impl_.get();
+  }
+
+ private:
+  std::unique_ptr<internal::FastParseExampleConfigIndexImpl> impl_;
+};
+
 // Parses a batch of serialized Example protos and converts them into result
 // according to given config.
 // Given example names have to either be empty or the same size as serialized.
@@ -103,7 +136,14 @@ Status FastParseExample(const FastParseExampleConfig& config,
                         gtl::ArraySlice<string> example_names,
                         thread::ThreadPool* thread_pool, Result* result);
 
-// TODO(mrry): Move the hash table construction into the config object.
+// Like the above, but reuses a prebuilt feature-name index instead of
+// rebuilding it for every batch. `index` must have been built from `config`.
+Status FastParseExample(const FastParseExampleConfig& config,
+                        gtl::ArraySlice<string> serialized,
+                        gtl::ArraySlice<string> example_names,
+                        thread::ThreadPool* thread_pool, Result* result,
+                        const FastParseExampleConfigIndex& index);
+
 typedef FastParseExampleConfig FastParseSingleExampleConfig;
 
 Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
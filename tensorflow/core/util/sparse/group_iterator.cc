@@ -66,5 +66,58 @@ TTypes<int64>::UnalignedConstMatrix Group::indices() const {
                                              next_loc_ - loc_, iter_->dims_);
 }
 
+void PermutedGroupIterable::IteratorStep::UpdateEndOfGroup() {
+  ++next_loc_;
+  const auto& ix_t = iter_->ix_matrix_;
+  const int64 N = iter_->permutation_.size();
+  while (next_loc_ < N && iter_->GroupMatches(ix_t, loc_, next_loc_)) {
+    ++next_loc_;
+  }
+}
+
+bool PermutedGroupIterable::IteratorStep::operator!=(
+    const IteratorStep& rhs) const {
+  CHECK_EQ(rhs.iter_, iter_) << "Can't compare steps from different iterators";
+  return (rhs.loc_ != loc_);
+}
+
+bool PermutedGroupIterable::IteratorStep::operator==(
+    const IteratorStep& rhs) const {
+  CHECK_EQ(rhs.iter_, iter_) << "Can't compare steps from different iterators";
+  return (rhs.loc_ == loc_);
+}
+
+PermutedGroupIterable::IteratorStep& PermutedGroupIterable::IteratorStep::
+operator++() {  // prefix ++
+  loc_ = next_loc_;
+  UpdateEndOfGroup();
+  return *this;
+}
+
+PermutedGroupIterable::IteratorStep PermutedGroupIterable::IteratorStep::
+operator++(int) {  // postfix ++
+  IteratorStep lhs(*this);
+  ++(*this);
+  return lhs;
+}
+
+std::vector<int64> PermutedGroup::group() const {
+  std::vector<int64> g;
+  const auto& ix_t = iter_->ix_matrix_;
+  const int64 row = iter_->permutation_[loc_];
+  for (const int d : iter_->group_dims_) {
+    g.push_back(ix_t(row, d));
+  }
+  return g;
+}
+
+int64 PermutedGroup::index(int64 n, int d) const {
+  DCHECK_GE(n, 0);
+  DCHECK_LT(n, num_entries());
+  DCHECK_GE(d, 0);
+  DCHECK_LT(d, iter_->dims_);
+  return iter_->ix_matrix_(iter_->permutation_[loc_ + n], d);
+}
+
 }  // namespace sparse
 }  // namespace tensorflow
@@ -142,6 +142,123 @@ typename TTypes<T>::UnalignedVec Group::values() const {
                                           next_loc_ - loc_);
 }
 
+class PermutedGroupIterable;  // Predeclare PermutedGroupIterable.
+
+// This class is returned when dereferencing a PermutedGroupIterable
+// iterator.  The rows of the group are generally not contiguous in the
+// underlying tensors, so indices and values are exposed one entry at a
+// time instead of as Eigen maps; no copies of the underlying data are
+// made.
+class PermutedGroup {
+ public:
+  PermutedGroup(PermutedGroupIterable* iter, int64 loc, int64 next_loc)
+      : iter_(iter), loc_(loc), next_loc_(next_loc) {}
+
+  std::vector<int64> group() const;
+  int64 num_entries() const { return next_loc_ - loc_; }
+  // Returns dimension d of entry n of this group's indices.
+  int64 index(int64 n, int d) const;
+  // Returns entry n of this group's values.
+  template <typename T>
+  const T& value(int64 n) const;
+
+ private:
+  PermutedGroupIterable* iter_;
+  int64 loc_;
+  int64 next_loc_;
+};
+
+//////////////////////
+// PermutedGroupIterable
+//////////////////////
+//
+// Like GroupIterable, but visits the rows of the SparseTensor through a
+// permutation of its rows (typically the result of
+// SparseTensor::SortOrder()), so the tensor itself does not need to be
+// reordered before grouping.
+//
+// Please note: the permutation must sort the rows according to an order
+// whose prefix is {dim0, dim1, ...}.  Otherwise this iteration will
+// return invalid groups.
+//
+class PermutedGroupIterable {
+ public:
+  typedef gtl::ArraySlice<int64> VarDimArray;
+
+  PermutedGroupIterable(Tensor ix, Tensor vals, int dims,
+                        const VarDimArray& group_dims,
+                        std::vector<int64> permutation)
+      : ix_(ix),
+        ix_matrix_(ix_.matrix<int64>()),
+        vals_(vals),
+        dims_(dims),
+        group_dims_(group_dims.begin(), group_dims.end()),
+        permutation_(std::move(permutation)) {
+    DCHECK_EQ(permutation_.size(), ix_.dim_size(0));
+  }
+
+  class IteratorStep;
+
+  IteratorStep begin() { return IteratorStep(this, 0); }
+  IteratorStep at(int64 loc) {
+    CHECK(loc >= 0 && loc <= static_cast<int64>(permutation_.size()))
+        << "loc provided must lie between 0 and " << permutation_.size();
+    return IteratorStep(this, loc);
+  }
+  IteratorStep end() { return IteratorStep(this, permutation_.size()); }
+
+  template <typename TIX>
+  inline bool GroupMatches(const TIX& ix, int64 loc_a, int64 loc_b) const {
+    bool matches = true;
+    for (int d : group_dims_) {
+      if (ix(permutation_[loc_a], d) != ix(permutation_[loc_b], d)) {
+        matches = false;
+      }
+    }
+    return matches;
+  }
+
+  class IteratorStep {
+   public:
+    IteratorStep(PermutedGroupIterable* iter, int64 loc)
+        : iter_(iter), loc_(loc), next_loc_(loc_) {
+      UpdateEndOfGroup();
+    }
+
+    void UpdateEndOfGroup();
+    bool operator!=(const IteratorStep& rhs) const;
+    bool operator==(const IteratorStep& rhs) const;
+    IteratorStep& operator++();    // prefix ++
+    IteratorStep operator++(int);  // postfix ++
+    PermutedGroup operator*() const {
+      return PermutedGroup(iter_, loc_, next_loc_);
+    }
+    int64 loc() const { return loc_; }
+
+   private:
+    PermutedGroupIterable* iter_;
+    int64 loc_;
+    int64 next_loc_;
+  };
+
+ private:
+  friend class PermutedGroup;
+  const Tensor ix_;
+  const TTypes<int64>::ConstMatrix ix_matrix_;
+  Tensor vals_;
+  const int dims_;
+  const gtl::InlinedVector<int64, 8> group_dims_;
+  const std::vector<int64> permutation_;
+};
+
+// Implementation of PermutedGroup::value<T>()
+template <typename T>
+const T& PermutedGroup::value(int64 n) const {
+  DCHECK_GE(n, 0);
+  DCHECK_LT(n, num_entries());
+  return iter_->vals_.vec<T>()(iter_->permutation_[loc_ + n]);
+}
+
 }  // namespace sparse
 }  // namespace tensorflow
 
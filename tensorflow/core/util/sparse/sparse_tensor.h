@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_SPARSE_SPARSE_TENSOR_H_
 #define TENSORFLOW_CORE_UTIL_SPARSE_SPARSE_TENSOR_H_
 
+#include <algorithm>
 #include <limits>
 #include <numeric>
 #include <vector>
@@ -27,8 +28,10 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -188,6 +191,21 @@ class SparseTensor {
   template <typename T>
   void Reorder(const VarDimArray& order);
 
+  // Like Reorder(), but shards the sort of the index matrix across
+  // thread_pool when one is provided.
+  template <typename T>
+  void Reorder(const VarDimArray& order, thread::ThreadPool* thread_pool);
+
+  // Computes the row permutation that sorts the indices according to the
+  // dimensions in order, without modifying the indices or values.  The
+  // result can be passed to group() to iterate groups in sorted order
+  // without physically reordering the tensor.  If thread_pool is
+  // non-null, the sort of the index matrix is sharded across its
+  // threads.
+  std::vector<int64> SortOrder(const VarDimArray& order,
+                               thread::ThreadPool* thread_pool = nullptr)
+      const;
+
   // Returns a group iterable that can be used for clumping indices
   // and values according to the group indices of interest.
   //
@@ -205,6 +223,25 @@ class SparseTensor {
     return GroupIterable(ix_, vals_, dims_, group_ix);
   }
 
+  // Like group(), but iterates the tensor through `permutation` (as
+  // returned by SortOrder() for an order whose prefix is group_ix), so
+  // the indices and values need not be reordered first.  No copies of
+  // the indices or values are made.
+  //
+  // Precondition: permutation sorts the rows of indices() according to
+  // an order whose prefix is group_ix.
+  PermutedGroupIterable group(const VarDimArray& group_ix,
+                              std::vector<int64> permutation) const {
+    DCHECK_LE(group_ix.size(), dims_);
+    DCHECK_EQ(permutation.size(), num_entries());
+    for (std::size_t di = 0; di < group_ix.size(); ++di) {
+      DCHECK_GE(group_ix[di], 0) << "Group dimension out of range";
+      DCHECK_LT(group_ix[di], dims_) << "Group dimension out of range";
+    }
+    return PermutedGroupIterable(ix_, vals_, dims_, group_ix,
+                                 std::move(permutation));
+  }
+
   // Stores the sparse indices into the dense tensor out.
   // Preconditions:
   //   out->shape().dims() == shape().dims()
@@ -325,6 +362,13 @@ class SparseTensor {
   template <typename T>
   bool ValidateAndInitializeToDense(Tensor* out, bool initialize);
 
+  // Helper for SortOrder(): sorts the row numbers in reorder with
+  // sorter, sharding the sort across thread_pool when one is provided
+  // and the input is large enough to amortize the fork/join overhead.
+  template <typename Sorter>
+  static void SortRowIndices(std::vector<int64>* reorder, const Sorter& sorter,
+                             thread::ThreadPool* thread_pool);
+
   // Helper for Split() that returns the slice index.
   static inline int GetSliceIndex(const int dim, const int split_size,
                                   const int residual) {
@@ -373,16 +417,68 @@ class SparseTensor {
   int dims_;
 };
 
-// This operation updates the indices and values Tensor rows, so it is
-// an in-place algorithm.  It requires O(N log N) time and O(N)
-// temporary space.
-template <typename T>
-void SparseTensor::Reorder(const VarDimArray& order) {
-  DCHECK_EQ(DataTypeToEnum<T>::v(), dtype())
-      << "Reorder requested with the wrong datatype";
+template <typename Sorter>
+void SparseTensor::SortRowIndices(std::vector<int64>* reorder,
+                                  const Sorter& sorter,
+                                  thread::ThreadPool* thread_pool) {
+  const int64 num_rows = reorder->size();
+  // Below this many rows per shard the fork/join overhead dominates the
+  // sort itself.
+  static const int64 kMinShardSize = 1 << 14;
+  int64 num_shards = 1;
+  if (thread_pool != nullptr) {
+    num_shards = std::min<int64>(thread_pool->NumThreads(),
+                                 num_rows / kMinShardSize);
+  }
+  if (num_shards < 2) {
+    std::sort(reorder->begin(), reorder->end(), sorter);
+    return;
+  }
+
+  // Sort equal-sized shards in parallel, then merge neighboring sorted
+  // runs, doubling the run length each round.  The merges within a
+  // round are independent, so they also run on the pool.
+  std::vector<int64> bounds(num_shards + 1);
+  for (int64 i = 0; i <= num_shards; ++i) {
+    bounds[i] = num_rows * i / num_shards;
+  }
+  {
+    BlockingCounter counter(num_shards);
+    for (int64 i = 0; i < num_shards; ++i) {
+      const int64 lo = bounds[i];
+      const int64 hi = bounds[i + 1];
+      thread_pool->Schedule([reorder, &sorter, &counter, lo, hi]() {
+        std::sort(reorder->begin() + lo, reorder->begin() + hi, sorter);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  for (int64 width = 1; width < num_shards; width *= 2) {
+    int64 num_merges = 0;
+    for (int64 i = 0; i + width < num_shards; i += 2 * width) ++num_merges;
+    BlockingCounter counter(num_merges);
+    for (int64 i = 0; i + width < num_shards; i += 2 * width) {
+      const int64 lo = bounds[i];
+      const int64 mid = bounds[i + width];
+      const int64 hi = bounds[std::min(i + 2 * width, num_shards)];
+      thread_pool->Schedule([reorder, &sorter, &counter, lo, mid, hi]() {
+        std::inplace_merge(reorder->begin() + lo, reorder->begin() + mid,
+                           reorder->begin() + hi, sorter);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+}
+
+inline std::vector<int64> SparseTensor::SortOrder(
+    const VarDimArray& order, thread::ThreadPool* thread_pool) const {
   DCHECK_EQ(order.size(), dims_) << "Order length must be SparseTensor rank";
-  auto ix_t = ix_.matrix<int64>();
-  auto vals_t = vals_.vec<T>();
+  // Tensor copies share the underlying buffer; this one only exists to
+  // get a mutable-typed view of the indices for the comparators.
+  Tensor ix(ix_);
+  auto ix_t = ix.matrix<int64>();
 
   std::vector<int64> reorder(num_entries());
   std::iota(reorder.begin(), reorder.end(), 0);
@@ -392,7 +488,7 @@ void SparseTensor::Reorder(const VarDimArray& order) {
 #define CASE_SORT(ORDER_SIZE)                                    \
   case ORDER_SIZE: {                                             \
     FixedDimComparator<ORDER_SIZE> sorter(ix_t, order, shape()); \
-    std::sort(reorder.begin(), reorder.end(), sorter);           \
+    SortRowIndices(&reorder, sorter, thread_pool);               \
     break;                                                       \
   }
     CASE_SORT(0);
@@ -404,9 +500,30 @@ void SparseTensor::Reorder(const VarDimArray& order) {
 #undef CASE_SORT
     default: {
       DimComparator sorter(ix_t, order, shape());
-      std::sort(reorder.begin(), reorder.end(), sorter);
+      SortRowIndices(&reorder, sorter, thread_pool);
     }
   }
+  return reorder;
+}
+
+// This operation updates the indices and values Tensor rows, so it is
+// an in-place algorithm.  It requires O(N log N) time and O(N)
+// temporary space.
+template <typename T>
+void SparseTensor::Reorder(const VarDimArray& order) {
+  Reorder<T>(order, nullptr /* thread_pool */);
+}
+
+template <typename T>
+void SparseTensor::Reorder(const VarDimArray& order,
+                           thread::ThreadPool* thread_pool) {
+  DCHECK_EQ(DataTypeToEnum<T>::v(), dtype())
+      << "Reorder requested with the wrong datatype";
+  auto ix_t = ix_.matrix<int64>();
+  auto vals_t = vals_.vec<T>();
+
+  // Sort to get order of indices
+  std::vector<int64> reorder = SortOrder(order, thread_pool);
 
   // We have a forward reordering, but what we'll need is a
   // permutation (the inverse).  This can be calculated with O(1)
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -266,6 +267,36 @@ TEST(SparseTensorTest, SortingWorksCorrectly) {
   }
 }
 
+TEST(SparseTensorTest, ParallelSortOrderMatchesSerial) {
+  const int64 N = 1 << 17;
+  const int NDIM = 2;
+
+  Tensor ix(DT_INT64, TensorShape({N, NDIM}));
+  Tensor vals(DT_FLOAT, TensorShape({N}));
+  TensorShape shape({N, N});
+
+  // Multiplying by an odd constant modulo a power of two is a bijection,
+  // so the first dimension holds each row number exactly once and there
+  // are no ties for the sort to break.
+  auto ix_t = ix.matrix<int64>();
+  for (int64 i = 0; i < N; ++i) {
+    ix_t(i, 0) = (i * 48271) & (N - 1);
+    ix_t(i, 1) = i;
+  }
+
+  SparseTensor st;
+  TF_ASSERT_OK(SparseTensor::Create(ix, vals, shape, &st));
+
+  thread::ThreadPool thread_pool(Env::Default(), "sort", 4);
+  std::vector<int64> order{0, 1};
+  std::vector<int64> serial = st.SortOrder(order);
+  std::vector<int64> parallel = st.SortOrder(order, &thread_pool);
+  EXPECT_EQ(serial, parallel);
+
+  st.Reorder<float>(order, &thread_pool);
+  TF_EXPECT_OK(st.IndicesValid());
+}
+
 TEST(SparseTensorTest, ValidateIndicesFindsInvalid) {
   int N = 2;
   const int NDIM = 3;
@@ -530,6 +561,78 @@ TEST(SparseTensorTest, SparseTensorGroup) {
   }
 }
 
+TEST(SparseTensorTest, SparseTensorPermutedGroup) {
+  int N = 5;
+  const int NDIM = 3;
+
+  Tensor ix(DT_INT64, TensorShape({N, NDIM}));
+  Tensor vals(DT_INT32, TensorShape({N}));
+
+  auto ix_t = ix.matrix<int64>();
+  auto vals_t = vals.vec<int32>();
+
+  ix_t = GetSimpleIndexTensor(N, NDIM);
+
+  vals_t(0) = 1;  // associated with ix (000)
+  vals_t(1) = 2;  // associated with ix (300)
+  vals_t(2) = 3;  // associated with ix (200)
+  vals_t(3) = 4;  // associated with ix (010)
+  vals_t(4) = 5;  // associated with ix (002)
+
+  TensorShape shape({10, 10, 10});
+  std::vector<int64> order{0, 1, 2};
+
+  SparseTensor st;
+  TF_ASSERT_OK(SparseTensor::Create(ix, vals, shape, order, &st));
+
+  // Group by dimension 0 through the sort permutation; the tensor
+  // itself stays in its original (unsorted) order.
+  std::vector<int64> perm = st.SortOrder(order);
+
+  std::vector<std::vector<int64> > groups;
+  std::vector<std::vector<int64> > group_indices;
+  std::vector<std::vector<int32> > group_values;
+
+  auto gi = st.group({0}, perm);
+  for (const auto& g : gi) {
+    groups.push_back(g.group());
+    std::vector<int64> indices;
+    std::vector<int32> values;
+    for (int64 n = 0; n < g.num_entries(); ++n) {
+      for (int d = 0; d < NDIM; ++d) indices.push_back(g.index(n, d));
+      values.push_back(g.value<int32>(n));
+    }
+    group_indices.push_back(indices);
+    group_values.push_back(values);
+  }
+
+  // Group by dimension 0, we have groups: 0--, 2--, 3--
+  EXPECT_EQ(groups.size(), 3);
+  EXPECT_EQ(groups[0], std::vector<int64>({0}));
+  EXPECT_EQ(groups[1], std::vector<int64>({2}));
+  EXPECT_EQ(groups[2], std::vector<int64>({3}));
+
+  // First group: 000, 002, 010
+  EXPECT_EQ(group_indices[0], std::vector<int64>({0, 0, 0, 0, 0, 2, 0, 1, 0}));
+  EXPECT_EQ(group_values[0], std::vector<int32>({1, 5, 4}));
+
+  // Second group: 200
+  EXPECT_EQ(group_indices[1], std::vector<int64>({2, 0, 0}));
+  EXPECT_EQ(group_values[1], std::vector<int32>({3}));
+
+  // Third group: 300
+  EXPECT_EQ(group_indices[2], std::vector<int64>({3, 0, 0}));
+  EXPECT_EQ(group_values[2], std::vector<int32>({2}));
+
+  // The underlying tensors were not reordered.
+  auto expected_ix = GetSimpleIndexTensor(N, NDIM);
+  for (int n = 0; n < N; ++n) {
+    for (int d = 0; d < NDIM; ++d) {
+      EXPECT_EQ(st.indices().matrix<int64>()(n, d), expected_ix(n, d));
+    }
+  }
+}
+
 TEST(SparseTensorTest, Concat) {
   int N = 5;
   const int NDIM = 3;
@@ -0,0 +1,214 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/tensor_slice_util.h"
+
+namespace tensorflow {
+
+const char* const kDeltaBaseSuffix = ".delta_base";
+
+namespace {
+
+// Upper bound on the number of chained delta bundles; anything longer is
+// almost certainly a reference cycle.
+const int kMaxDeltaChainLength = 1024;
+
+string DeltaBaseFilename(StringPiece prefix) {
+  return strings::StrCat(prefix, kDeltaBaseSuffix);
+}
+
+}  // namespace
+
+void DirtyRowTracker::MarkDirty(int64 start_row, int64 num_rows) {
+  if (num_rows <= 0) return;
+  int64 start = start_row;
+  int64 end = start_row + num_rows;
+  // Merges with a preceding range that touches [start, end).
+  auto iter = ranges_.upper_bound(start);
+  if (iter != ranges_.begin()) {
+    auto prev = std::prev(iter);
+    if (prev->first + prev->second >= start) {
+      start = prev->first;
+      end = std::max(end, prev->first + prev->second);
+      iter = ranges_.erase(prev);
+    }
+  }
+  // Absorbs all following ranges that touch [start, end).
+  while (iter != ranges_.end() && iter->first <= end) {
+    end = std::max(end, iter->first + iter->second);
+    iter = ranges_.erase(iter);
+  }
+  ranges_[start] = end - start;
+}
+
+std::vector<DirtyRowTracker::RowRange> DirtyRowTracker::GetRanges() const {
+  std::vector<RowRange> result;
+  result.reserve(ranges_.size());
+  for (const auto& range : ranges_) {
+    result.push_back({range.first, range.second});
+  }
+  return result;
+}
+
+DeltaBundleWriter::DeltaBundleWriter(Env* env, StringPiece prefix,
+                                     StringPiece base_prefix,
+                                     const BundleWriter::Options& options)
+    : env_(env),
+      prefix_(prefix),
+      base_prefix_(base_prefix),
+      writer_(env, prefix, options) {}
+
+Status DeltaBundleWriter::Add(StringPiece key, const Tensor& val) {
+  return writer_.Add(key, val);
+}
+
+Status DeltaBundleWriter::AddRowDeltas(StringPiece key,
+                                       const Tensor& full_value,
+                                       const DirtyRowTracker& dirty) {
+  if (full_value.dims() < 1) {
+    return errors::InvalidArgument(
+        "AddRowDeltas requires a tensor with at least one dimension; key ",
+        key, " has shape ", full_value.shape().DebugString());
+  }
+  const int64 num_rows = full_value.dim_size(0);
+  for (const DirtyRowTracker::RowRange& range : dirty.GetRanges()) {
+    if (range.start < 0 || range.start + range.length > num_rows) {
+      return errors::InvalidArgument("Dirty rows [", range.start, ", ",
+                                     range.start + range.length,
+                                     ") out of range for key ", key, " with ",
+                                     num_rows, " rows");
+    }
+    TensorSlice slice(full_value.dims());
+    slice.set_start(0, range.start);
+    slice.set_length(0, range.length);
+    TF_RETURN_IF_ERROR(
+        writer_.AddSlice(key, full_value.shape(), slice,
+                         full_value.Slice(range.start,
+                                          range.start + range.length)));
+  }
+  return Status::OK();
+}
+
+Status DeltaBundleWriter::Finish() {
+  TF_RETURN_IF_ERROR(writer_.Finish());
+  return WriteStringToFile(env_, DeltaBaseFilename(prefix_), base_prefix_);
+}
+
+DeltaBundleReader::DeltaBundleReader(Env* env, StringPiece prefix)
+    : env_(env) {
+  string current(prefix);
+  while (true) {
+    if (static_cast<int>(readers_.size()) >= kMaxDeltaChainLength) {
+      status_ = errors::InvalidArgument(
+          "Delta chain starting at ", prefix, " exceeds ",
+          kMaxDeltaChainLength, " bundles; reference cycle?");
+      return;
+    }
+    readers_.emplace_back(new BundleReader(env_, current));
+    status_ = readers_.back()->status();
+    if (!status_.ok()) return;
+    // A bundle without the sidecar file is the full base of the chain.
+    const string base_file = DeltaBaseFilename(current);
+    if (!env_->FileExists(base_file).ok()) return;
+    string base_prefix;
+    status_ = ReadFileToString(env_, base_file, &base_prefix);
+    if (!status_.ok()) return;
+    current = base_prefix;
+  }
+}
+
+bool DeltaBundleReader::Contains(const string& key) {
+  for (std::unique_ptr<BundleReader>& reader : readers_) {
+    if (reader->Contains(key)) return true;
+  }
+  return false;
+}
+
+Status DeltaBundleReader::Lookup(const string& key, Tensor* val) {
+  CHECK(val != nullptr);
+  // Finds the newest layer holding a full (non-sliced) entry for "key";
+  // newer layers can only contribute slice overlays.
+  std::vector<std::vector<TensorSlice>> layer_slices(readers_.size());
+  int full_layer = -1;
+  for (int i = 0; i < static_cast<int>(readers_.size()); ++i) {
+    if (!readers_[i]->Contains(key)) continue;
+    TF_RETURN_IF_ERROR(readers_[i]->LookupTensorSlices(key, &layer_slices[i]));
+    if (layer_slices[i].empty()) {
+      full_layer = i;
+      break;
+    }
+  }
+  if (full_layer == -1) {
+    return errors::NotFound("Key ", key,
+                            " has no full entry in the delta chain");
+  }
+  TF_RETURN_IF_ERROR(readers_[full_layer]->Lookup(key, val));
+
+  // Overlays stored slices, oldest delta first, so the newest write of each
+  // row wins.
+  for (int i = full_layer - 1; i >= 0; --i) {
+    for (const TensorSlice& slice : layer_slices[i]) {
+      TF_RETURN_IF_ERROR(OverlaySlice(readers_[i].get(), key, slice, val));
+    }
+  }
+  return Status::OK();
+}
+
+Status DeltaBundleReader::OverlaySlice(BundleReader* reader, const string& key,
+                                       const TensorSlice& slice, Tensor* val) {
+  TensorShape slice_shape;
+  TF_RETURN_IF_ERROR(slice.SliceTensorShape(val->shape(), &slice_shape));
+  Tensor slice_tensor(val->dtype(), slice_shape);
+  TF_RETURN_IF_ERROR(reader->LookupSlice(key, slice, &slice_tensor));
+
+  const TensorSlice full_slice(val->shape().dims());
+  switch (val->dtype()) {
+#define HANDLE_COPY(T)                                           \
+  case DataTypeToEnum<T>::value:                                 \
+    CHECK(CopyDataFromTensorSliceToTensorSlice(                  \
+        val->shape(), slice, full_slice,                         \
+        slice_tensor.flat<T>().data(), val->flat<T>().data()));  \
+    break;
+
+    HANDLE_COPY(float)
+    HANDLE_COPY(double)
+    HANDLE_COPY(int32)
+    HANDLE_COPY(uint8)
+    HANDLE_COPY(int16)
+    HANDLE_COPY(int8)
+    HANDLE_COPY(complex64)
+    HANDLE_COPY(complex128)
+    HANDLE_COPY(int64)
+    HANDLE_COPY(bool)
+    HANDLE_COPY(qint32)
+    HANDLE_COPY(quint8)
+    HANDLE_COPY(qint8)
+    default:
+      return errors::InvalidArgument("Dtype ", DataTypeString(val->dtype()),
+                                     " not supported.");
+  }
+#undef HANDLE_COPY
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,162 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Incremental (delta) checkpoints on top of the tensor bundle format.
+//
+// When only a small fraction of a large variable changes between
+// checkpoints (e.g. sparsely updated embedding rows), rewriting the full
+// tensor wastes most of the save.  A delta bundle is an ordinary tensor
+// bundle that stores, for designated variables, only the dirty row ranges
+// as tensor slices, together with a sidecar file "<prefix>.delta_base"
+// naming the base checkpoint.  Variables saved in full (small or densely
+// updated ones) are stored as usual.
+//
+// Typical usage:
+//
+//   DirtyRowTracker dirty;                 // Long-lived, one per variable.
+//   dirty.MarkDirty(row, 1);               // Called as rows are updated.
+//   ...
+//   DeltaBundleWriter writer(env, "/ckpt/step100", "/ckpt/step90");
+//   writer.AddRowDeltas("embedding", embedding_value, dirty);
+//   writer.Add("global_step", step_value); // Full write.
+//   writer.Finish();
+//   dirty.Clear();
+//
+//   DeltaBundleReader reader(env, "/ckpt/step100");
+//   reader.Lookup("embedding", &restored); // Base value + overlaid deltas.
+//
+// Deltas chain: the base of a delta bundle may itself be a delta bundle.
+// DeltaBundleReader walks the chain and overlays stored slices from oldest
+// to newest, so the most recent write of a row wins.  A plain BundleReader
+// can still open a delta bundle, but full lookups of delta'd variables fail
+// since their slices do not cover the full shape.
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// Suffix of the sidecar file recording a delta bundle's base prefix.
+extern const char* const kDeltaBaseSuffix;
+
+// Accumulates dirty row ranges for one variable, coalescing overlapping and
+// adjacent ranges.  Not thread-safe; callers updating a variable from
+// multiple threads must synchronize.
+class DirtyRowTracker {
+ public:
+  struct RowRange {
+    int64 start;
+    int64 length;
+  };
+
+  // Marks rows [start_row, start_row + num_rows) as dirty.
+  void MarkDirty(int64 start_row, int64 num_rows);
+
+  // Forgets all dirty ranges, typically after a successful save.
+  void Clear() { ranges_.clear(); }
+
+  bool empty() const { return ranges_.empty(); }
+
+  // Returns the coalesced ranges, sorted by start row.
+  std::vector<RowRange> GetRanges() const;
+
+ private:
+  // Maps range start -> range length; ranges are disjoint and separated by
+  // at least one clean row.
+  std::map<int64, int64> ranges_;
+};
+
+// Writes a delta bundle.  Same threading contract as BundleWriter.
+class DeltaBundleWriter {
+ public:
+  // "base_prefix" names the checkpoint this delta applies to; it may itself
+  // be a delta bundle.
+  DeltaBundleWriter(Env* env, StringPiece prefix, StringPiece base_prefix,
+                    const BundleWriter::Options& options = {});
+
+  // Adds the tensor "val" in full, exactly like BundleWriter::Add().
+  Status Add(StringPiece key, const Tensor& val);
+
+  // Adds only the dirty row ranges of "full_value" (sliced along dimension
+  // 0) under key "key".  If "dirty" is empty, nothing is stored and readers
+  // fall through to the base checkpoint.
+  // REQUIRES: full_value has at least one dimension.
+  Status AddRowDeltas(StringPiece key, const Tensor& full_value,
+                      const DirtyRowTracker& dirty);
+
+  // Flushes the bundle and writes the base-checkpoint sidecar file.
+  Status Finish() TF_MUST_USE_RESULT;
+
+  Status status() const { return writer_.status(); }
+
+ private:
+  Env* const env_;  // Not owned.
+  const string prefix_;
+  const string base_prefix_;
+  BundleWriter writer_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleWriter);
+};
+
+// Reads a delta bundle chain.  Same threading contract as BundleReader.
+class DeltaBundleReader {
+ public:
+  // Opens the bundle at "prefix" and every base bundle it references.
+  // "status()" must be checked before calling any other member function.
+  DeltaBundleReader(Env* env, StringPiece prefix);
+
+  Status status() const { return status_; }
+
+  // Queries whether any bundle in the chain has an entry keyed by "key".
+  bool Contains(const string& key);
+
+  // Reconstructs the tensor keyed by "key": restores the newest full entry
+  // in the chain, then overlays stored slices from newer delta bundles,
+  // oldest first.
+  Status Lookup(const string& key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Number of bundles in the chain, the full base included.
+  int num_layers() const { return static_cast<int>(readers_.size()); }
+
+ private:
+  // Restores the stored slice "slice" of "key" from "reader" and copies it
+  // into the corresponding region of "val".
+  Status OverlaySlice(BundleReader* reader, const string& key,
+                      const TensorSlice& slice, Tensor* val);
+
+  Env* const env_;  // Not owned.
+  Status status_;
+  // readers_[0] is the newest delta; the last element is the full base.
+  std::vector<std::unique_ptr<BundleReader>> readers_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleReader);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
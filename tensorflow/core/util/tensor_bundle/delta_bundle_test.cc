@@ -0,0 +1,139 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+// A 10x4 float tensor whose row r is filled with "base + r".
+Tensor Embedding(float base) {
+  Tensor ret(DT_FLOAT, TensorShape({10, 4}));
+  for (int r = 0; r < 10; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      ret.matrix<float>()(r, c) = base + r;
+    }
+  }
+  return ret;
+}
+
+TEST(DirtyRowTrackerTest, CoalescesRanges) {
+  DirtyRowTracker dirty;
+  EXPECT_TRUE(dirty.empty());
+  dirty.MarkDirty(5, 2);
+  dirty.MarkDirty(0, 1);
+  dirty.MarkDirty(6, 3);  // Overlaps [5, 7).
+  dirty.MarkDirty(9, 1);  // Adjacent to [5, 9).
+  std::vector<DirtyRowTracker::RowRange> ranges = dirty.GetRanges();
+  ASSERT_EQ(2, ranges.size());
+  EXPECT_EQ(0, ranges[0].start);
+  EXPECT_EQ(1, ranges[0].length);
+  EXPECT_EQ(5, ranges[1].start);
+  EXPECT_EQ(5, ranges[1].length);
+  dirty.Clear();
+  EXPECT_TRUE(dirty.empty());
+}
+
+TEST(DeltaBundleTest, OverlaysDeltaChain) {
+  // Full base checkpoint.
+  {
+    BundleWriter writer(Env::Default(), Prefix("base"));
+    TF_EXPECT_OK(writer.Add("embedding", Embedding(0)));
+    TF_EXPECT_OK(writer.Add("bias", test::AsTensor<float>({1, 2, 3})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // First delta: rows 2-3 and 7 of the embedding change; bias is rewritten
+  // in full.
+  Tensor step1 = Embedding(0);
+  for (int c = 0; c < 4; ++c) {
+    step1.matrix<float>()(2, c) = 100 + 2;
+    step1.matrix<float>()(3, c) = 100 + 3;
+    step1.matrix<float>()(7, c) = 100 + 7;
+  }
+  {
+    DirtyRowTracker dirty;
+    dirty.MarkDirty(2, 2);
+    dirty.MarkDirty(7, 1);
+    DeltaBundleWriter writer(Env::Default(), Prefix("delta1"), Prefix("base"));
+    TF_EXPECT_OK(writer.AddRowDeltas("embedding", step1, dirty));
+    TF_EXPECT_OK(writer.Add("bias", test::AsTensor<float>({4, 5, 6})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Second delta on top of the first: row 3 changes again.
+  Tensor step2 = Embedding(0);
+  for (int c = 0; c < 4; ++c) {
+    step2.matrix<float>()(2, c) = 100 + 2;
+    step2.matrix<float>()(3, c) = 200 + 3;
+    step2.matrix<float>()(7, c) = 100 + 7;
+  }
+  {
+    DirtyRowTracker dirty;
+    dirty.MarkDirty(3, 1);
+    DeltaBundleWriter writer(Env::Default(), Prefix("delta2"),
+                             Prefix("delta1"));
+    TF_EXPECT_OK(writer.AddRowDeltas("embedding", step2, dirty));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  DeltaBundleReader reader(Env::Default(), Prefix("delta2"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(3, reader.num_layers());
+
+  Tensor embedding;
+  TF_ASSERT_OK(reader.Lookup("embedding", &embedding));
+  test::ExpectTensorEqual<float>(embedding, step2);
+
+  // "bias" comes from the newest layer that rewrote it in full.
+  Tensor bias;
+  TF_ASSERT_OK(reader.Lookup("bias", &bias));
+  test::ExpectTensorEqual<float>(bias, test::AsTensor<float>({4, 5, 6}));
+
+  EXPECT_TRUE(reader.Contains("embedding"));
+  EXPECT_FALSE(reader.Contains("not_in_chain"));
+  Tensor missing;
+  EXPECT_TRUE(errors::IsNotFound(reader.Lookup("not_in_chain", &missing)));
+}
+
+TEST(DeltaBundleTest, EmptyTrackerStoresNothing) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("base"));
+    TF_EXPECT_OK(writer.Add("embedding", Embedding(0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    DirtyRowTracker dirty;
+    DeltaBundleWriter writer(Env::Default(), Prefix("delta"), Prefix("base"));
+    TF_EXPECT_OK(writer.AddRowDeltas("embedding", Embedding(42), dirty));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  DeltaBundleReader reader(Env::Default(), Prefix("delta"));
+  TF_ASSERT_OK(reader.status());
+  Tensor embedding;
+  TF_ASSERT_OK(reader.Lookup("embedding", &embedding));
+  test::ExpectTensorEqual<float>(embedding, Embedding(0));
+}
+
+}  // namespace
+}  // namespace tensorflow
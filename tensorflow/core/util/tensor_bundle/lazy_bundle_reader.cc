@@ -0,0 +1,135 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/lazy_bundle_reader.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/protobuf/tensor_bundle.pb.h"
+
+namespace tensorflow {
+
+LazyBundleReader::LazyBundleReader(Env* env, StringPiece prefix)
+    : env_(env), reader_(new BundleReader(env, prefix)) {
+  status_ = reader_->status();
+  if (!status_.ok()) return;
+
+  // Collects every tensor key together with its position in the data files,
+  // so the prefetcher can read each shard sequentially.
+  struct KeyAndPosition {
+    string key;
+    int32 shard_id;
+    int64 offset;
+  };
+  std::vector<KeyAndPosition> entries;
+  reader_->Seek(kHeaderEntryKey);
+  reader_->Next();
+  for (; reader_->Valid(); reader_->Next()) {
+    BundleEntryProto entry;
+    if (!entry.ParseFromArray(reader_->value().data(),
+                              reader_->value().size())) {
+      status_ = errors::DataLoss("Cannot parse bundle entry for key ",
+                                 reader_->key());
+      return;
+    }
+    entries.push_back(
+        {string(reader_->key()), entry.shard_id(), entry.offset()});
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const KeyAndPosition& a, const KeyAndPosition& b) {
+              if (a.shard_id != b.shard_id) return a.shard_id < b.shard_id;
+              if (a.offset != b.offset) return a.offset < b.offset;
+              return a.key < b.key;
+            });
+  prefetch_order_.reserve(entries.size());
+  for (KeyAndPosition& entry : entries) {
+    prefetch_order_.push_back(std::move(entry.key));
+  }
+
+  prefetch_thread_.reset(
+      env_->StartThread(ThreadOptions(), "lazy_bundle_prefetch",
+                        [this]() { PrefetchLoop(); }));
+}
+
+LazyBundleReader::~LazyBundleReader() {
+  {
+    mutex_lock l(mu_);
+    stop_ = true;
+    done_cv_.notify_all();
+  }
+  prefetch_thread_.reset();  // Joins the prefetcher.
+}
+
+bool LazyBundleReader::Contains(const string& key) {
+  mutex_lock l(mu_);
+  return cache_.count(key) > 0 || reader_->Contains(key);
+}
+
+Status LazyBundleReader::Lookup(const string& key, Tensor* val) {
+  CHECK(val != nullptr);
+  mutex_lock l(mu_);
+  auto iter = cache_.find(key);
+  if (iter == cache_.end()) {
+    TF_RETURN_IF_ERROR(RestoreLocked(key));
+    iter = cache_.find(key);
+  }
+  *val = iter->second;
+  return Status::OK();
+}
+
+Status LazyBundleReader::WaitForAll() {
+  mutex_lock l(mu_);
+  while (!all_done_ && !stop_) {
+    done_cv_.wait(l);
+  }
+  return prefetch_status_;
+}
+
+Status LazyBundleReader::RestoreLocked(const string& key) {
+  Tensor val;
+  TF_RETURN_IF_ERROR(reader_->Lookup(key, &val));
+  cache_.emplace(key, std::move(val));
+  return Status::OK();
+}
+
+void LazyBundleReader::PrefetchLoop() {
+  while (true) {
+    mutex_lock l(mu_);
+    if (stop_) return;
+    // Skips entries already restored by an on-demand Lookup().
+    while (next_prefetch_ < prefetch_order_.size() &&
+           cache_.count(prefetch_order_[next_prefetch_]) > 0) {
+      ++next_prefetch_;
+    }
+    if (next_prefetch_ == prefetch_order_.size()) {
+      all_done_ = true;
+      done_cv_.notify_all();
+      return;
+    }
+    // Restores one entry per lock acquisition, so an on-demand Lookup()
+    // waits for at most one background restore.
+    const Status s = RestoreLocked(prefetch_order_[next_prefetch_]);
+    if (!s.ok() && prefetch_status_.ok()) {
+      // Remembers the first failure and keeps going; a Lookup() of the
+      // affected key surfaces its own error.
+      prefetch_status_ = s;
+    }
+    ++next_prefetch_;
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_LAZY_BUNDLE_READER_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_LAZY_BUNDLE_READER_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// Restores a tensor bundle lazily instead of all-at-once.
+//
+// A background thread prefetches entries in increasing (shard, offset) order,
+// so each data file is read sequentially, while Lookup() immediately
+// materializes any tensor that is requested before the prefetcher reaches it.
+// Jobs whose early steps touch only a small part of a checkpoint (e.g. the
+// hot rows of an embedding table) can therefore start running long before the
+// full bundle is resident.
+//
+// All public methods are thread-safe.
+class LazyBundleReader {
+ public:
+  // Reads the metadata of the bundle at "prefix" and starts the background
+  // prefetcher.  "status()" must be checked before calling any other member
+  // function.
+  LazyBundleReader(Env* env, StringPiece prefix);
+
+  // Stops the prefetcher and joins it.  Tensors already returned by Lookup()
+  // remain valid.
+  ~LazyBundleReader();
+
+  // Is ok() iff the reader construction is successful (completed the read of
+  // the metadata).
+  Status status() const { return status_; }
+
+  // Queries whether the bundle contains an entry keyed by "key".
+  bool Contains(const string& key);
+
+  // Returns in "*val" the tensor keyed by "key".  If the prefetcher has not
+  // restored it yet, restores it now, ahead of the background order.
+  // Returns a NotFound error if the key does not exist in the bundle.
+  Status Lookup(const string& key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Blocks until every entry in the bundle has been restored (or the reader
+  // is being destroyed) and returns the first prefetch error, if any.
+  Status WaitForAll();
+
+ private:
+  // Restores the tensor keyed by "key" into "cache_".
+  Status RestoreLocked(const string& key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Body of the background prefetch thread.
+  void PrefetchLoop();
+
+  Env* const env_;  // Not owned.
+  Status status_;
+
+  // Every tensor key in the bundle, sorted by (shard, offset).  Immutable
+  // after construction.
+  std::vector<string> prefetch_order_;
+
+  mutex mu_;
+  condition_variable done_cv_;
+
+  // The underlying reader requires external synchronization; after
+  // construction it is only used with "mu_" held.
+  std::unique_ptr<BundleReader> reader_;
+
+  std::unordered_map<string, Tensor> cache_ GUARDED_BY(mu_);
+  // Index into "prefetch_order_" of the next entry to prefetch.
+  size_t next_prefetch_ GUARDED_BY(mu_) = 0;
+  // First error encountered by the prefetcher, if any.
+  Status prefetch_status_ GUARDED_BY(mu_);
+  bool all_done_ GUARDED_BY(mu_) = false;
+  bool stop_ GUARDED_BY(mu_) = false;
+
+  // Joined by reset()/destruction.  Declared last so it stops before the
+  // members it uses are destroyed.
+  std::unique_ptr<Thread> prefetch_thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LazyBundleReader);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_LAZY_BUNDLE_READER_H_
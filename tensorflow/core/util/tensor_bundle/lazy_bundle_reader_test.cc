@@ -0,0 +1,102 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/lazy_bundle_reader.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+template <typename T>
+Tensor Constant(T v, TensorShape shape) {
+  Tensor ret(DataTypeToEnum<T>::value, shape);
+  ret.flat<T>().setConstant(v);
+  return ret;
+}
+
+template <typename T>
+Tensor Constant_2x3(T v) {
+  return Constant(v, TensorShape({2, 3}));
+}
+
+TEST(LazyBundleReaderTest, Basic) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_2x3<float>(3)));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<float>(2)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    Tensor strs(DT_STRING, TensorShape({2}));
+    strs.vec<string>()(0) = "hello";
+    strs.vec<string>()(1) = "world";
+    TF_EXPECT_OK(writer.Add("foo_str", strs));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  LazyBundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+
+  // On-demand lookups are served whether or not the prefetcher has reached
+  // them; access in an order unrelated to the stored one.
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("foo_002", &val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(2));
+  TF_ASSERT_OK(reader.Lookup("foo_str", &val));
+  EXPECT_EQ("hello", val.vec<string>()(0));
+  EXPECT_EQ("world", val.vec<string>()(1));
+
+  EXPECT_TRUE(reader.Contains("foo_000"));
+  EXPECT_FALSE(reader.Contains("not_in_bundle"));
+  EXPECT_TRUE(
+      errors::IsNotFound(reader.Lookup("not_in_bundle", &val)));
+
+  // After the prefetcher drains, everything is served from the cache.
+  TF_ASSERT_OK(reader.WaitForAll());
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(reader.Lookup(strings::StrCat("foo_00", i), &val));
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(i));
+  }
+}
+
+TEST(LazyBundleReaderTest, TensorsOutliveReader) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor val;
+  {
+    LazyBundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.Lookup("foo_000", &val));
+  }
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(0));
+}
+
+TEST(LazyBundleReaderTest, NonExistentBundle) {
+  LazyBundleReader reader(Env::Default(), Prefix("nonexistent"));
+  EXPECT_FALSE(reader.status().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,10 +21,12 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb_text.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb_text.h"
 #include "tensorflow/core/framework/variant.h"
@@ -32,15 +34,20 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/block_cache.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_slice_util.h"
 
@@ -54,6 +61,10 @@ const int kTensorBundleVersion = 1;
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
 
+// Reads larger than kBufferSize bypass the InputBuffer and are issued as
+// asynchronous segment reads of this size, all kept in flight at once.
+static const size_t kAsyncReadSegmentSize = 8 << 20;  // 8MB
+
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
 // bundle.
@@ -385,6 +396,17 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
 
 }  // namespace
 
+// A tensor queued for background writing.  "entry" points into "entries_",
+// which is stable under further insertions; the checksum worker fills in its
+// crc32c field while the writer thread appends the bytes.
+struct BundleWriter::AsyncWriteJob {
+  Tensor val;  // Deep-copied snapshot of the added tensor.
+  BundleEntryProto* entry = nullptr;
+  int64 pad_bytes = 0;
+  bool crc_done = false;
+  bool write_done = false;
+};
+
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     : env_(env),
       options_(options),
@@ -406,9 +428,32 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   out_ = std::unique_ptr<FileOutputBuffer>(
       new FileOutputBuffer(wrapper.release(), 8 << 20 /* 8MB write buffer */));
 
+  if (options_.num_concurrent_workers > 0) {
+    // The checksum workers compute each entry's crc32c, so the output
+    // buffer's own running checksum would only duplicate the work.
+    out_->set_track_crc32c(false);
+    checksum_pool_.reset(new thread::ThreadPool(
+        env_, "bundle_checksum", options_.num_concurrent_workers));
+    writer_thread_.reset(env_->StartThread(
+        ThreadOptions(), "bundle_ordered_writer", [this]() {
+          AsyncWriterLoop();
+        }));
+  }
+
   VLOG(1) << "Writing to file " << tmp_data_path_;
 }
 
+BundleWriter::~BundleWriter() {
+  if (writer_thread_ != nullptr) {
+    {
+      mutex_lock l(mu_);
+      writer_stop_ = true;
+      work_cv_.notify_all();
+    }
+    writer_thread_.reset();  // Joins; drains any queued writes first.
+  }
+}
+
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (!status_.ok()) return status_;
   CHECK_NE(key, kHeaderEntryKey);
@@ -424,6 +469,49 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   entry->set_shard_id(0);
   entry->set_offset(size_);
 
+  if (writer_thread_ != nullptr && val.dtype() != DT_STRING &&
+      val.dtype() != DT_VARIANT) {
+    // Background pipeline: the size, offset and padding of a plain tensor
+    // are known without writing anything, so the entry can be finalized now
+    // and the checksum and file append deferred to the workers.
+    const size_t data_bytes = val.TotalBytes();
+    entry->set_size(data_bytes);
+    size_ += data_bytes;
+    AsyncWriteJob* job = new AsyncWriteJob;
+    // Deep-copies the value: sharing the caller's buffer would let an
+    // in-place update during the save tear the snapshot and diverge from
+    // the checksum computed below.
+    job->val = tensor::DeepCopy(val);
+    job->entry = entry;
+    if (options_.data_alignment > 1 && size_ % options_.data_alignment != 0) {
+      job->pad_bytes = options_.data_alignment - size_ % options_.data_alignment;
+      size_ += job->pad_bytes;
+    }
+    {
+      mutex_lock l(mu_);
+      ++outstanding_jobs_;
+      write_queue_.push_back(job);
+      work_cv_.notify_all();
+    }
+    checksum_pool_->Schedule([this, job]() {
+      const StringPiece data = job->val.tensor_data();
+      const uint32 crc = crc32c::Value(data.data(), data.size());
+      mutex_lock l(mu_);
+      job->entry->set_crc32c(crc32c::Mask(crc));
+      job->crc_done = true;
+      MaybeCompleteJobLocked(job);
+    });
+    return status_;
+  }
+
+  // Synchronous path.  String and variant tensors are always written here;
+  // with the pipeline enabled, first waits for queued background writes so
+  // the file layout matches the offsets assigned above.
+  if (writer_thread_ != nullptr) {
+    status_.Update(DrainAsyncWrites());
+    if (!status_.ok()) return status_;
+  }
+
   // Updates the data file.
   size_t data_bytes_written = 0;
   uint32 crc32c = 0;
@@ -446,6 +534,49 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   return status_;
 }
 
+Status BundleWriter::DrainAsyncWrites() {
+  if (writer_thread_ == nullptr) return Status::OK();
+  mutex_lock l(mu_);
+  while (outstanding_jobs_ > 0) {
+    work_cv_.wait(l);
+  }
+  return async_status_;
+}
+
+void BundleWriter::MaybeCompleteJobLocked(AsyncWriteJob* job) {
+  if (!job->crc_done || !job->write_done) return;
+  delete job;
+  --outstanding_jobs_;
+  work_cv_.notify_all();
+}
+
+void BundleWriter::AsyncWriterLoop() {
+  while (true) {
+    AsyncWriteJob* job = nullptr;
+    {
+      mutex_lock l(mu_);
+      while (write_queue_.empty() && !writer_stop_) {
+        work_cv_.wait(l);
+      }
+      if (write_queue_.empty()) return;  // Stopped and drained.
+      job = write_queue_.front();
+      write_queue_.pop_front();
+    }
+    // Appends without holding the lock; "out_" is only touched by this
+    // thread while jobs are outstanding (the synchronous paths drain the
+    // queue first).
+    const StringPiece data = job->val.tensor_data();
+    Status s = out_->Append(data);
+    if (s.ok() && job->pad_bytes > 0) {
+      s = out_->Append(string(job->pad_bytes, '\0'));
+    }
+    mutex_lock l(mu_);
+    if (!s.ok() && async_status_.ok()) async_status_ = s;
+    job->write_done = true;
+    MaybeCompleteJobLocked(job);
+  }
+}
+
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
                               const TensorShape& full_tensor_shape,
                               const TensorSlice& slice_spec,
@@ -490,6 +621,16 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
+  if (writer_thread_ != nullptr) {
+    status_.Update(DrainAsyncWrites());
+    {
+      mutex_lock l(mu_);
+      writer_stop_ = true;
+      work_cv_.notify_all();
+    }
+    writer_thread_.reset();   // Joins the ordered writer.
+    checksum_pool_.reset();   // Joins the checksum workers.
+  }
   if (out_) {
     status_.Update(out_->Close());
     out_ = nullptr;
@@ -713,6 +854,63 @@ Status MergeBundles(Env* env, gtl::ArraySlice<string> prefixes,
 
 // Interface for reading a tensor bundle.
 
+// A refcounted wrapper around a read-only memory mapping of a bundle data
+// file.  Tensors returned by BundleReader::LookupMemmapped() hold a
+// reference, so the mapping outlives the reader if needed.
+class BundleMemoryRegion : public core::RefCounted {
+ public:
+  explicit BundleMemoryRegion(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  const void* data() const { return region_->data(); }
+  uint64 length() const { return region_->length(); }
+
+ private:
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BundleMemoryRegion);
+};
+
+namespace {
+
+// A TensorBuffer aliasing a range of a memory-mapped bundle data file.  The
+// pages behind the buffer are mapped read-only; callers must not write
+// through tensors backed by this buffer.
+class MmapTensorBuffer : public TensorBuffer {
+ public:
+  MmapTensorBuffer(BundleMemoryRegion* region, const void* data, size_t size)
+      : TensorBuffer(const_cast<void*>(data)), region_(region), size_(size) {
+    region_->Ref();
+  }
+  ~MmapTensorBuffer() override { region_->Unref(); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocated_bytes(size_);
+    proto->set_allocator_name("tensor_bundle_mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  BundleMemoryRegion* const region_;
+  const size_t size_;
+};
+
+// Cache of decoded metadata-table blocks, shared by all BundleReaders in the
+// process. Each metadata lookup re-reads the block holding the entry from
+// disk otherwise, so restores issuing many Lookup calls hammer the same hot
+// blocks.
+table::BlockCache* MetadataBlockCache() {
+  static const size_t kMetadataBlockCacheBytes = 16 << 20;
+  static table::BlockCache* cache =
+      new table::BlockCache(kMetadataBlockCacheBytes);
+  return cache;
+}
+
+}  // namespace
+
 BundleReader::BundleReader(Env* env, StringPiece prefix)
     : env_(env),
       prefix_(prefix),
@@ -729,7 +927,9 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   status_ = env_->NewRandomAccessFile(filename, &wrapper);
   if (!status_.ok()) return;
   metadata_ = wrapper.release();
-  status_ = table::Table::Open(table::Options(), metadata_, file_size, &table_);
+  table::Options o;
+  o.block_cache = MetadataBlockCache();
+  status_ = table::Table::Open(o, metadata_, file_size, &table_);
   if (!status_.ok()) return;
   iter_ = table_->NewIterator();
 
@@ -770,6 +970,10 @@ BundleReader::~BundleReader() {
   }
   gtl::STLDeleteValues(&data_);
   gtl::STLDeleteValues(&tensor_slices_);
+  // Tensors returned by LookupMemmapped() may still reference the regions.
+  for (auto pair : mmap_regions_) {
+    pair.second->Unref();
+  }
 }
 
 Status BundleReader::GetBundleEntryProto(StringPiece key,
@@ -841,11 +1045,36 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
     if (entry.size() > kBufferSize) {
-      StringPiece sp;
-      TF_RETURN_IF_ERROR(buffered_file->file()->Read(
-          entry.offset(), entry.size(), &sp, backing_buffer));
-      if (sp.data() != backing_buffer) {
-        memmove(backing_buffer, sp.data(), entry.size());
+      // Issues the read as segments that are all in flight at once, filling
+      // disjoint ranges of the tensor buffer. Filesystems with a truly
+      // asynchronous read path (e.g. the POSIX pread pool) then overlap the
+      // segment reads instead of serving one large read on this thread; the
+      // default ReadAsync performs them back to back, which is equivalent to
+      // the single large read this used to issue.
+      const size_t num_segments =
+          (entry.size() + kAsyncReadSegmentSize - 1) / kAsyncReadSegmentSize;
+      std::vector<Status> segment_status(num_segments);
+      BlockingCounter counter(num_segments);
+      for (size_t i = 0; i < num_segments; ++i) {
+        const uint64 seg_offset = i * kAsyncReadSegmentSize;
+        const size_t seg_size = static_cast<size_t>(
+            std::min<uint64>(kAsyncReadSegmentSize, entry.size() - seg_offset));
+        char* seg_buffer = backing_buffer + seg_offset;
+        Status* status = &segment_status[i];
+        buffered_file->file()->ReadAsync(
+            entry.offset() + seg_offset, seg_size, seg_buffer,
+            [status, seg_buffer, seg_size, &counter](const Status& s,
+                                                     StringPiece sp) {
+              *status = s;
+              if (s.ok() && sp.data() != seg_buffer) {
+                memmove(seg_buffer, sp.data(), seg_size);
+              }
+              counter.DecrementCount();
+            });
+      }
+      counter.Wait();
+      for (const Status& s : segment_status) {
+        TF_RETURN_IF_ERROR(s);
       }
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
@@ -890,6 +1119,179 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::GetMemmappedRegion(int32 shard_id,
+                                        BundleMemoryRegion** region) {
+  BundleMemoryRegion* found = gtl::FindPtrOrNull(mmap_regions_, shard_id);
+  if (found != nullptr) {
+    *region = found;
+    return Status::OK();
+  }
+  std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+  TF_RETURN_IF_ERROR(env_->NewReadOnlyMemoryRegionFromFile(
+      DataFilename(prefix_, shard_id, num_shards_), &mapped));
+  found = new BundleMemoryRegion(std::move(mapped));
+  mmap_regions_[shard_id] = found;  // The map owns one reference.
+  *region = found;
+  return Status::OK();
+}
+
+Status BundleReader::LookupMemmapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+
+  // Partitioned tensors, non-memcpy dtypes and entries whose stored offsets
+  // do not satisfy Eigen's alignment requirement cannot alias the mapping;
+  // restore those through the regular copying path.
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      entry.offset() % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return Lookup(key, val);
+  }
+
+  BundleMemoryRegion* region = nullptr;
+  TF_RETURN_IF_ERROR(GetMemmappedRegion(entry.shard_id(), &region));
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored offset ", entry.offset(), " + size ",
+                            entry.size(), " exceeds data file size ",
+                            region->length());
+  }
+
+  const TensorShape stored_shape(TensorShape(entry.shape()));
+  const size_t expected_size =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            expected_size);
+  }
+
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  // Validates the checksum on every call, faulting the pages in as a side
+  // effect, mirroring what Lookup() does on the restored bytes.
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the mapped bytes ", actual_crc32c);
+  }
+
+  TensorBuffer* buf = new MmapTensorBuffer(region, data, entry.size());
+  *val = Tensor(entry.dtype(), stored_shape, buf);
+  buf->Unref();  // The tensor now holds the only reference to the buffer.
+  return Status::OK();
+}
+
+Status BundleReader::LookupParallel(gtl::ArraySlice<string> keys,
+                                    std::vector<Tensor>* vals) {
+  CHECK(vals != nullptr);
+  if (vals->empty()) {
+    vals->resize(keys.size());
+  }
+  if (vals->size() != keys.size()) {
+    return errors::InvalidArgument("LookupParallel expects one value per key: ",
+                                   keys.size(), " keys vs. ", vals->size(),
+                                   " values");
+  }
+
+  // Serial metadata pass: resolve every entry, allocate output tensors,
+  // and decide which entries qualify for direct reads.  Partitioned,
+  // string and variant tensors need the buffered decode path and are
+  // kept for a serial pass below.
+  struct DirectRead {
+    BundleEntryProto entry;
+    Tensor* val;
+  };
+  std::vector<DirectRead> direct_reads;
+  std::vector<size_t> serial_indices;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entry));
+    if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype())) {
+      serial_indices.push_back(i);
+      continue;
+    }
+    Tensor* val = &(*vals)[i];
+    if (val->NumElements() == 0) {
+      *val = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    }
+    if (entry.size() != val->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", val->TotalBytes());
+    }
+    direct_reads.push_back({entry, val});
+  }
+
+  if (!direct_reads.empty()) {
+    // Opens a private handle per shard: RandomAccessFile reads are
+    // stateless, so one handle can serve many threads, unlike the
+    // seekable InputBuffers in data_.
+    std::unordered_map<int32, std::unique_ptr<RandomAccessFile>> shard_files;
+    for (const DirectRead& dr : direct_reads) {
+      std::unique_ptr<RandomAccessFile>& file =
+          shard_files[dr.entry.shard_id()];
+      if (file == nullptr) {
+        TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+            DataFilename(prefix_, dr.entry.shard_id(), num_shards_), &file));
+      }
+    }
+
+    // Reads in (shard, offset) order so each worker's stream of reads
+    // is mostly sequential within a file.
+    std::sort(direct_reads.begin(), direct_reads.end(),
+              [](const DirectRead& a, const DirectRead& b) {
+                if (a.entry.shard_id() != b.entry.shard_id()) {
+                  return a.entry.shard_id() < b.entry.shard_id();
+                }
+                return a.entry.offset() < b.entry.offset();
+              });
+
+    std::vector<Status> statuses(direct_reads.size());
+    {
+      const int num_threads = std::min<int>(direct_reads.size(),
+                                            port::NumSchedulableCPUs());
+      thread::ThreadPool pool(env_, "bundle_parallel_restore", num_threads);
+      for (size_t i = 0; i < direct_reads.size(); ++i) {
+        const DirectRead* dr = &direct_reads[i];
+        Status* status = &statuses[i];
+        RandomAccessFile* file = shard_files[dr->entry.shard_id()].get();
+        pool.Schedule([dr, status, file] {
+          char* backing_buffer =
+              const_cast<char*>(dr->val->tensor_data().data());
+          StringPiece sp;
+          Status s = file->Read(dr->entry.offset(), dr->entry.size(), &sp,
+                                backing_buffer);
+          if (s.ok() && sp.data() != backing_buffer) {
+            memmove(backing_buffer, sp.data(), dr->entry.size());
+          }
+          if (s.ok()) {
+            const uint32 actual_crc32c =
+                crc32c::Value(backing_buffer, dr->entry.size());
+            if (crc32c::Unmask(dr->entry.crc32c()) != actual_crc32c) {
+              s = errors::DataLoss(
+                  "Checksum does not match: stored ",
+                  strings::Printf("%08u", crc32c::Unmask(dr->entry.crc32c())),
+                  " vs. calculated on the restored bytes ", actual_crc32c);
+            }
+          }
+          *status = s;
+        });
+      }
+      // The pool destructor waits for all scheduled reads.
+    }
+    for (const Status& s : statuses) {
+      TF_RETURN_IF_ERROR(s);
+    }
+  }
+
+  for (size_t i : serial_indices) {
+    TF_RETURN_IF_ERROR(Lookup(keys[i], &(*vals)[i]));
+  }
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1087,12 +1489,16 @@ Status FileOutputBuffer::Append(StringPiece data) {
   if (data.size() + position_ <= buffer_size_) {
     // Can fit into the current buffer.
     memcpy(&buffer_[position_], data.data(), data.size());
-    crc32c_ = crc32c::Extend(crc32c_, &buffer_[position_], data.size());
+    if (track_crc32c_) {
+      crc32c_ = crc32c::Extend(crc32c_, &buffer_[position_], data.size());
+    }
   } else if (data.size() <= buffer_size_) {
     // Cannot fit, but can fit after flushing.
     TF_RETURN_IF_ERROR(FlushBuffer());
     memcpy(&buffer_[0], data.data(), data.size());
-    crc32c_ = crc32c::Extend(crc32c_, &buffer_[0], data.size());
+    if (track_crc32c_) {
+      crc32c_ = crc32c::Extend(crc32c_, &buffer_[0], data.size());
+    }
   } else {
     // Cannot fit even after flushing.  So we break down "data" by chunk, and
     // flush/checksum each chunk.
@@ -1100,7 +1506,9 @@ Status FileOutputBuffer::Append(StringPiece data) {
     for (size_t i = 0; i < data.size(); i += buffer_size_) {
       const size_t nbytes = std::min(data.size() - i, buffer_size_);
       memcpy(&buffer_[0], data.data() + i, nbytes);
-      crc32c_ = crc32c::Extend(crc32c_, &buffer_[0], nbytes);
+      if (track_crc32c_) {
+        crc32c_ = crc32c::Extend(crc32c_, &buffer_[0], nbytes);
+      }
       position_ = nbytes;
       TF_RETURN_IF_ERROR(FlushBuffer());
     }
@@ -63,7 +63,9 @@ limitations under the License.
 
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -71,18 +73,22 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/table.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_slice_set.h"
 
 namespace tensorflow {
 
+class BundleMemoryRegion;
 class FileOutputBuffer;
 
 // Versioning of the tensor bundle format.
@@ -111,10 +117,23 @@ class BundleWriter {
     Options() {}
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
+    // Writers producing bundles meant to be memory-mapped by readers (see
+    // BundleReader::LookupMemmapped()) should use at least
+    // EIGEN_MAX_ALIGN_BYTES.
     int data_alignment{1};
+    // Number of background threads used to checksum tensor data.  When > 0,
+    // Add() snapshots non-string, non-variant tensors and returns without
+    // waiting for the bytes to reach the file: checksum workers compute each
+    // entry's crc32c while a single writer thread appends the data in Add()
+    // order.  Finish() waits for all outstanding writes, so the caller can
+    // keep mutating the added tensors (e.g. continue training) while the
+    // save completes in the background.  The default of 0 writes
+    // synchronously on the caller's thread.
+    int num_concurrent_workers{0};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
+  ~BundleWriter();
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
@@ -146,6 +165,20 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  struct AsyncWriteJob;
+
+  // Blocks until all queued background writes have completed and returns the
+  // first error among them, if any.  No-op when the pipeline is disabled.
+  Status DrainAsyncWrites();
+
+  // Deletes "job" and wakes up waiters once both its checksum and its file
+  // write have completed.
+  void MaybeCompleteJobLocked(AsyncWriteJob* job) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Body of the ordered writer thread: appends queued tensors to the data
+  // file in Add() order.
+  void AsyncWriterLoop();
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
@@ -156,6 +189,17 @@ class BundleWriter {
   std::map<string, BundleEntryProto> entries_;
   Status status_;
 
+  // Background write pipeline; see Options::num_concurrent_workers.
+  std::unique_ptr<thread::ThreadPool> checksum_pool_;
+  mutex mu_;
+  condition_variable work_cv_;
+  std::deque<AsyncWriteJob*> write_queue_ GUARDED_BY(mu_);
+  int outstanding_jobs_ GUARDED_BY(mu_) = 0;
+  bool writer_stop_ GUARDED_BY(mu_) = false;
+  Status async_status_ GUARDED_BY(mu_);
+  // Joined on destruction; declared after the state it uses.
+  std::unique_ptr<Thread> writer_thread_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
 };
 
@@ -218,6 +262,42 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up all tensors keyed by "keys" and restores them concurrently,
+  // reading each entry directly into its tensor's buffer with one large
+  // read per entry.  Entries are spread over a thread pool so reads to
+  // different offsets and shards proceed in parallel, which saturates
+  // fast storage that a serial Lookup() loop leaves mostly idle.
+  //
+  // "vals" must either be empty, in which case tensors are allocated
+  // with their stored dtypes and shapes, or hold one preallocated (or
+  // default-constructed) tensor per key, following the contract of
+  // Lookup().  Partitioned, string and variant tensors are restored
+  // serially after the parallel pass.
+  //
+  // Validates each stored crc32c checksum against the restored bytes.
+  // REQUIRES: status().ok()
+  Status LookupParallel(gtl::ArraySlice<string> keys,
+                        std::vector<Tensor>* vals) TF_MUST_USE_RESULT;
+
+  // Looks up the tensor keyed by "key" and, when possible, overwrites "val"
+  // with a tensor aliasing a read-only memory mapping of the data file
+  // instead of copying the bytes into heap memory.  All tensors restored
+  // this way, across all processes serving the same bundle, share a single
+  // page-cache-backed copy of the data.
+  //
+  // Aliasing requires a memcpy-able dtype, a non-partitioned entry, and a
+  // stored offset aligned to EIGEN_MAX_ALIGN_BYTES; bundles written with
+  // BundleWriter::Options::data_alignment >= EIGEN_MAX_ALIGN_BYTES satisfy
+  // the latter.  Entries that do not qualify fall back to Lookup().
+  //
+  // The mapping is read-only: callers must not write through the returned
+  // tensor.  The mapping stays valid for the lifetime of the returned
+  // tensors, even after this reader is destroyed.
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupMemmapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -282,6 +362,12 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns in "region" a read-only memory mapping of the data file of shard
+  // "shard_id", mapping it on first use.  The region stays mapped until both
+  // this reader and all tensors returned by LookupMemmapped() are destroyed.
+  Status GetMemmappedRegion(int32 shard_id,
+                            BundleMemoryRegion** region) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const string prefix_;
 
@@ -292,6 +378,11 @@ class BundleReader {
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
 
+  // Memory mappings of the data files, created on demand by
+  // LookupMemmapped().  Holds one reference per region; tensors aliasing a
+  // region hold additional references.
+  std::unordered_map<int32, BundleMemoryRegion*> mmap_regions_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -324,6 +415,9 @@ class FileOutputBuffer {
   uint32 crc32c() { return crc32c_; }
   // Clears the running crc32c checksum.
   void clear_crc32c() { crc32c_ = 0; }
+  // Disables or re-enables the running checksum.  Useful when the caller
+  // computes checksums itself.
+  void set_track_crc32c(bool track) { track_crc32c_ = track; }
 
   // Appends the buffered data, then closes the underlying file.
   Status Close();
@@ -342,6 +436,8 @@ class FileOutputBuffer {
 
   // Checksum of all appended bytes since construction or last clear_crc32c().
   uint32 crc32c_ = 0;
+  // Whether Append() extends the running checksum.
+  bool track_crc32c_ = true;
 };
 
 }  // namespace tensorflow
@@ -320,6 +320,56 @@ TEST(TensorBundleTest, Basic) {
   TestBasic<qint8>();
 }
 
+TEST(TensorBundleTest, LookupParallel) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<float>(2)));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_2x3<float>(3)));
+    Tensor strings(DT_STRING, TensorShape({2}));
+    strings.vec<string>()(0) = "hello";
+    strings.vec<string>()(1) = "world";
+    TF_EXPECT_OK(writer.Add("foo_strings", strings));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // Empty "vals": tensors are allocated with the stored shapes.
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    std::vector<string> keys = {"foo_003", "foo_000", "foo_002", "foo_001",
+                                "foo_strings"};
+    std::vector<Tensor> vals;
+    TF_ASSERT_OK(reader.LookupParallel(keys, &vals));
+    ASSERT_EQ(5, vals.size());
+    test::ExpectTensorEqual<float>(vals[0], Constant_2x3<float>(3));
+    test::ExpectTensorEqual<float>(vals[1], Constant_2x3<float>(0));
+    test::ExpectTensorEqual<float>(vals[2], Constant_2x3<float>(2));
+    test::ExpectTensorEqual<float>(vals[3], Constant_2x3<float>(1));
+    EXPECT_EQ("hello", vals[4].vec<string>()(0));
+    EXPECT_EQ("world", vals[4].vec<string>()(1));
+  }
+  {
+    // Preallocated "vals": entries are read in place.
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    std::vector<string> keys = {"foo_000", "foo_001"};
+    std::vector<Tensor> vals = {Tensor(DT_FLOAT, TensorShape({2, 3})),
+                                Tensor(DT_FLOAT, TensorShape({2, 3}))};
+    TF_ASSERT_OK(reader.LookupParallel(keys, &vals));
+    test::ExpectTensorEqual<float>(vals[0], Constant_2x3<float>(0));
+    test::ExpectTensorEqual<float>(vals[1], Constant_2x3<float>(1));
+  }
+  {
+    // A missing key fails the whole call.
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    std::vector<string> keys = {"foo_000", "missing"};
+    std::vector<Tensor> vals;
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupParallel(keys, &vals)));
+  }
+}
+
 TEST(TensorBundleTest, PartitionedVariables) {
   const TensorShape kFullShape({5, 10});
   // Adds two slices.
@@ -830,6 +880,42 @@ TEST(TensorBundleTest, VersionTest) {
   }
 }
 
+TEST(TensorBundleTest, ConcurrentWriter) {
+  {
+    BundleWriter::Options opts;
+    opts.num_concurrent_workers = 4;
+    opts.data_alignment = 42;  // Exercises background padding writes.
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    Tensor snapshotted = Constant_2x3<float>(0);
+    TF_EXPECT_OK(writer.Add("foo_000", snapshotted));
+    // The pipeline snapshots added tensors: later in-place updates must not
+    // affect the saved value.
+    snapshotted.flat<float>().setConstant(-1);
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    // String tensors take the synchronous path, interleaved with background
+    // writes.
+    Tensor strs(DT_STRING, TensorShape({2}));
+    strs.vec<string>()(0) = "hello";
+    strs.vec<string>()(1) = "world";
+    TF_EXPECT_OK(writer.Add("foo_str", strs));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<float>(2)));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_2x3<float>(3)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo_000", Constant_2x3<float>(0));
+    Expect<float>(&reader, "foo_001", Constant_2x3<float>(1));
+    Expect<float>(&reader, "foo_002", Constant_2x3<float>(2));
+    Expect<float>(&reader, "foo_003", Constant_2x3<float>(3));
+    Tensor strs;
+    TF_ASSERT_OK(reader.Lookup("foo_str", &strs));
+    EXPECT_EQ("hello", strs.vec<string>()(0));
+    EXPECT_EQ("world", strs.vec<string>()(1));
+  }
+}
+
 class TensorBundleAlignmentTest : public ::testing::Test {
  protected:
   template <typename T>
@@ -883,6 +969,54 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST_F(TensorBundleAlignmentTest, MemmappedLookup) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    Tensor strs(DT_STRING, TensorShape({2}));
+    strs.vec<string>()(0) = "hello";
+    strs.vec<string>()(1) = "world";
+    TF_EXPECT_OK(writer.Add("foo_str", strs));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor outlived;
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    TF_ASSERT_OK(reader.LookupMemmapped("foo_000", &val));
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(0));
+    TF_ASSERT_OK(reader.LookupMemmapped("foo_001", &outlived));
+    // String tensors fall back to the copying path.
+    Tensor strs;
+    TF_ASSERT_OK(reader.LookupMemmapped("foo_str", &strs));
+    EXPECT_EQ("hello", strs.vec<string>()(0));
+    EXPECT_EQ("world", strs.vec<string>()(1));
+    // Missing keys still report NotFound.
+    Tensor missing;
+    EXPECT_TRUE(
+        errors::IsNotFound(reader.LookupMemmapped("not_in_bundle", &missing)));
+  }
+  // The mapping outlives the reader: tensors stay readable after it is gone.
+  test::ExpectTensorEqual<float>(outlived, Constant_2x3<float>(1));
+  {
+    // Densely packed bundles fall back to the copying path for entries whose
+    // offsets are not suitably aligned.
+    BundleWriter writer(Env::Default(), Prefix("bar"));
+    TF_EXPECT_OK(writer.Add("bar_000", Constant_2x3<float>(7)));
+    TF_EXPECT_OK(writer.Add("bar_001", Constant_2x3<float>(8)));
+    TF_ASSERT_OK(writer.Finish());
+    BundleReader reader(Env::Default(), Prefix("bar"));
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    TF_ASSERT_OK(reader.LookupMemmapped("bar_001", &val));
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(8));
+  }
+}
+
 static void BM_BundleAlignmentByteOff(int iters, int alignment,
                                       int tensor_size) {
   testing::StopTiming();
@@ -13,9 +13,40 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/arena_planner.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <utility>
 
 namespace tflite {
+namespace {
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+// Identifies serialized allocation plans; bump the trailing digit whenever
+// the format changes so stale plans are rejected instead of misparsed.
+constexpr char kPlanHeader[] = "TFLPLAN1";
+constexpr size_t kPlanHeaderSize = sizeof(kPlanHeader) - 1;
+
+void AppendPlanField(uint64_t value, std::string* serialized) {
+  serialized->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool ReadPlanField(const std::string& serialized, size_t* pos,
+                   uint64_t* value) {
+  if (*pos + sizeof(*value) > serialized.size()) {
+    return false;
+  }
+  memcpy(value, serialized.data() + *pos, sizeof(*value));
+  *pos += sizeof(*value);
+  return true;
+}
+
+}  // namespace
 
 struct AllocationInfo {
   // The node index requesting this allocation.
@@ -29,14 +60,15 @@ struct AllocationInfo {
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_inputs, bool preserve_intermediates,
-                           int tensor_alignment)
+                           int tensor_alignment, size_t locality_slack)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment),
       preserve_inputs_(preserve_inputs),
       preserve_intermediates_(preserve_intermediates),
-      tensor_alignment_(tensor_alignment) {}
+      tensor_alignment_(tensor_alignment),
+      locality_slack_(locality_slack) {}
 
 ArenaPlanner::~ArenaPlanner() {}
 
@@ -63,6 +95,11 @@ TfLiteStatus ArenaPlanner::ResetAllocations() {
 TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  // A plan committed for the old topology cannot seed incremental
+  // re-planning of the new one.
+  has_committed_plan_ = false;
+  committed_allocs_.clear();
+  committed_sizes_.clear();
   // The alloc_queue_ is specific to the graph topology, and will be
   // completely reconstructed from graph data here.
   alloc_queue_.clear();
@@ -184,12 +221,114 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::SerializePlan(std::string* serialized) const {
+  TF_LITE_ENSURE(context_, serialized != nullptr);
+  // The plan is only complete once every tensor has been through
+  // ExecuteAllocations().
+  TF_LITE_ENSURE(context_, allocs_.size() == graph_info_->num_tensors());
+  serialized->clear();
+  serialized->append(kPlanHeader, kPlanHeaderSize);
+  AppendPlanField(allocs_.size(), serialized);
+  for (const ArenaAlloc& alloc : allocs_) {
+    AppendPlanField(alloc.offset, serialized);
+    AppendPlanField(alloc.size, serialized);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus ArenaPlanner::RestorePlan(const std::string& serialized) {
+  has_restored_plan_ = false;
+  restored_allocs_.clear();
+  TF_LITE_ENSURE(context_, serialized.size() >= kPlanHeaderSize);
+  TF_LITE_ENSURE(context_, memcmp(serialized.data(), kPlanHeader,
+                                  kPlanHeaderSize) == 0);
+  size_t pos = kPlanHeaderSize;
+  uint64_t num_tensors = 0;
+  TF_LITE_ENSURE(context_, ReadPlanField(serialized, &pos, &num_tensors));
+  // The plan may contain more tensors than currently exist, since op
+  // preparation can add temporaries; it must never contain fewer.
+  TF_LITE_ENSURE(context_, num_tensors >= graph_info_->num_tensors());
+  restored_allocs_.resize(num_tensors);
+  for (uint64_t i = 0; i < num_tensors; ++i) {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    TF_LITE_ENSURE(context_, ReadPlanField(serialized, &pos, &offset));
+    TF_LITE_ENSURE(context_, ReadPlanField(serialized, &pos, &size));
+    restored_allocs_[i].offset = offset;
+    restored_allocs_[i].size = size;
+  }
+  TF_LITE_ENSURE(context_, pos == serialized.size());
+  has_restored_plan_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus ArenaPlanner::ApplyRestoredPlan() {
+  if (restored_allocs_.size() != graph_info_->num_tensors()) {
+    return kTfLiteError;
+  }
+  size_t arena_size = 0;
+  size_t persistent_arena_size = 0;
+  for (int i = 0; i < graph_info_->num_tensors(); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    const ArenaAlloc& alloc = restored_allocs_[i];
+    if (tensor.allocation_type == kTfLiteArenaRw) {
+      // A zero-size alloc means the tensor was never allocated (e.g. it is
+      // not connected to any input); anything else must match exactly.
+      if (alloc.size != 0 && tensor.bytes != alloc.size) {
+        return kTfLiteError;
+      }
+      arena_size = std::max(arena_size, alloc.offset + alloc.size);
+    } else if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      if (alloc.size != 0 && tensor.bytes != alloc.size) {
+        return kTfLiteError;
+      }
+      persistent_arena_size =
+          std::max(persistent_arena_size, alloc.offset + alloc.size);
+    } else if (alloc.size != 0) {
+      // The plan was computed with different settings (e.g. a tensor that is
+      // no longer arena-allocated).
+      return kTfLiteError;
+    }
+  }
+  allocs_ = restored_allocs_;
+  arena_.ReserveSize(arena_size);
+  persistent_arena_.ReserveSize(persistent_arena_size);
+  TF_LITE_ENSURE_STATUS(Commit());
+  for (int i = 0; i < graph_info_->num_tensors(); ++i) {
+    TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
+  if (has_restored_plan_) {
+    if (ApplyRestoredPlan() == kTfLiteOk) {
+      return kTfLiteOk;
+    }
+    // The prepared graph no longer matches the restored plan (e.g. an op
+    // resized one of its outputs); discard the plan and fall back to full
+    // planning from the start of the graph.
+    has_restored_plan_ = false;
+    restored_allocs_.clear();
+    TF_LITE_ENSURE_STATUS(PlanAllocations());
+    first_node = 0;
+  }
   // Grow the size of `allocs_` if necessary. This allows allocating temporary
   // tensors in op's `prepare` function.
   TF_LITE_ENSURE(context_, graph_info_->num_tensors() >= allocs_.size());
   allocs_.resize(graph_info_->num_tensors());
 
+  // When re-planning the whole graph (e.g. after ResizeInputTensor()) and a
+  // previous plan is available, the tensor lifetimes are unchanged: only the
+  // tensors whose size changed need new offsets.
+  const bool whole_graph =
+      first_node == 0 &&
+      static_cast<size_t>(last_node + 1) >= graph_info_->num_nodes();
+  if (whole_graph && has_committed_plan_ &&
+      ExecuteIncrementalAllocations() == kTfLiteOk) {
+    return kTfLiteOk;
+  }
+
   TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
   TF_LITE_ENSURE_STATUS(Commit());
 
@@ -201,9 +340,155 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i));
   }
 
+  if (whole_graph) {
+    committed_allocs_ = allocs_;
+    committed_sizes_.resize(graph_info_->num_tensors());
+    for (size_t i = 0; i < committed_sizes_.size(); ++i) {
+      committed_sizes_[i] = graph_info_->tensor(i)->bytes;
+    }
+    has_committed_plan_ = true;
+  } else {
+    // A partial plan (present when the graph has dynamic tensors) cannot be
+    // reused incrementally.
+    has_committed_plan_ = false;
+  }
+
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::ExecuteIncrementalAllocations() {
+  const size_t num_tensors = graph_info_->num_tensors();
+  if (committed_allocs_.size() > num_tensors) {
+    return kTfLiteError;
+  }
+  std::vector<int32_t> first_node;
+  std::vector<int32_t> last_node;
+  CalculateTensorLifetimes(&first_node, &last_node);
+
+  std::vector<ArenaAlloc> new_allocs(num_tensors);
+  // Tensors that already have their final offsets, per arena.
+  std::vector<int> placed_rw;
+  std::vector<int> placed_persistent;
+  std::vector<int> resized;
+  for (size_t i = 0; i < num_tensors; ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if (tensor.allocation_type != kTfLiteArenaRw &&
+        tensor.allocation_type != kTfLiteArenaRwPersistent) {
+      continue;
+    }
+    if (first_node[i] < 0 || tensor.bytes == 0) {
+      // Never allocated; the null allocation stands.
+      continue;
+    }
+    if (i < committed_allocs_.size() && tensor.bytes == committed_sizes_[i] &&
+        committed_allocs_[i].size == tensor.bytes) {
+      new_allocs[i] = committed_allocs_[i];
+      if (tensor.allocation_type == kTfLiteArenaRw) {
+        placed_rw.push_back(i);
+      } else {
+        placed_persistent.push_back(i);
+      }
+    } else {
+      resized.push_back(i);
+    }
+  }
+
+  // Lay out the resized tensors in the order of their previous offsets so
+  // the layout stays stable; tensors planned for the first time go last.
+  std::sort(resized.begin(), resized.end(), [this](int a, int b) -> bool {
+    const size_t offset_a = static_cast<size_t>(a) < committed_allocs_.size()
+                                ? committed_allocs_[a].offset
+                                : std::numeric_limits<size_t>::max();
+    const size_t offset_b = static_cast<size_t>(b) < committed_allocs_.size()
+                                ? committed_allocs_[b].offset
+                                : std::numeric_limits<size_t>::max();
+    if (offset_a != offset_b) return offset_a < offset_b;
+    return a < b;
+  });
+
+  for (int tensor_index : resized) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+    const bool persistent =
+        tensor.allocation_type == kTfLiteArenaRwPersistent;
+    std::vector<int>* placed = persistent ? &placed_persistent : &placed_rw;
+    // Collect the allocations this tensor may not overlap: everything in the
+    // persistent arena (which never frees), or the tensors with intersecting
+    // lifetimes in the flow arena.
+    std::vector<ArenaAlloc> neighbors;
+    neighbors.reserve(placed->size());
+    for (int other : *placed) {
+      if (!persistent && (last_node[other] < first_node[tensor_index] ||
+                          last_node[tensor_index] < first_node[other])) {
+        continue;
+      }
+      neighbors.push_back(new_allocs[other]);
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    // First-fit scan over the gaps between the neighbors.
+    size_t offset = 0;
+    for (const ArenaAlloc& neighbor : neighbors) {
+      if (offset + tensor.bytes <= neighbor.offset) break;
+      offset = std::max(
+          offset, AlignTo(tensor_alignment_, neighbor.offset + neighbor.size));
+    }
+    new_allocs[tensor_index].offset = offset;
+    new_allocs[tensor_index].size = tensor.bytes;
+    placed->push_back(tensor_index);
+  }
+
+  size_t arena_size = 0;
+  size_t persistent_arena_size = 0;
+  for (size_t i = 0; i < num_tensors; ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    const ArenaAlloc& alloc = new_allocs[i];
+    if (tensor.allocation_type == kTfLiteArenaRw) {
+      arena_size = std::max(arena_size, alloc.offset + alloc.size);
+    } else if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      persistent_arena_size =
+          std::max(persistent_arena_size, alloc.offset + alloc.size);
+    }
+  }
+  allocs_ = std::move(new_allocs);
+  arena_.ReserveSize(arena_size);
+  persistent_arena_.ReserveSize(persistent_arena_size);
+  TF_LITE_ENSURE_STATUS(Commit());
+  for (int i = 0; i < graph_info_->num_tensors(); ++i) {
+    TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i));
+  }
+
+  committed_allocs_ = allocs_;
+  committed_sizes_.resize(num_tensors);
+  for (size_t i = 0; i < num_tensors; ++i) {
+    committed_sizes_[i] = graph_info_->tensor(i)->bytes;
+  }
+  return kTfLiteOk;
+}
+
+void ArenaPlanner::CalculateTensorLifetimes(
+    std::vector<int32_t>* first_node, std::vector<int32_t>* last_node) const {
+  const size_t num_tensors = graph_info_->num_tensors();
+  first_node->assign(num_tensors, -1);
+  last_node->assign(num_tensors, std::numeric_limits<int32_t>::max());
+  for (const auto& alloc_info : alloc_queue_) {
+    if (alloc_info.type == AllocationInfo::ALLOC) {
+      (*first_node)[alloc_info.tensor] = alloc_info.node;
+    } else {
+      (*last_node)[alloc_info.tensor] = alloc_info.node;
+    }
+  }
+  // Temporaries are not part of the allocation queue; they live exactly for
+  // the duration of the node that owns them.
+  for (size_t i = 0; i < graph_info_->num_nodes(); ++i) {
+    const TfLiteNode& node = graph_info_->node(i);
+    TfLiteIntArray* node_temporaries = node.temporaries;
+    for (int j = 0; j < node_temporaries->size; ++j) {
+      const int tensor_index = node_temporaries->data[j];
+      (*first_node)[tensor_index] = i;
+      (*last_node)[tensor_index] = i;
+    }
+  }
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
@@ -231,7 +516,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
     // Handle the current item.
     if (alloc_info.type == AllocationInfo::ALLOC) {
-      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(alloc_info.tensor));
+      TF_LITE_ENSURE_STATUS(
+          CalculateTensorAllocation(alloc_info.tensor, alloc_info.node));
     } else {
       TF_LITE_ENSURE_STATUS(CalculateTensorDeallocation(alloc_info.tensor));
     }
@@ -261,11 +547,17 @@ TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   return kTfLiteOk;
 }
 
-TfLiteStatus ArenaPlanner::CalculateTensorAllocation(int tensor_index) {
+TfLiteStatus ArenaPlanner::CalculateTensorAllocation(int tensor_index,
+                                                     int node_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
-    TF_LITE_ENSURE_STATUS(arena_.Allocate(
-        context_, tensor_alignment_, tensor.bytes, &allocs_[tensor_index]));
+    size_t preferred_offset = kArenaNoPreferredOffset;
+    if (locality_slack_ > 0) {
+      preferred_offset = PreferredOffsetForNode(node_index);
+    }
+    TF_LITE_ENSURE_STATUS(arena_.Allocate(context_, tensor_alignment_,
+                                          tensor.bytes, &allocs_[tensor_index],
+                                          preferred_offset, locality_slack_));
   }
   if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
     TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
@@ -274,6 +566,32 @@ TfLiteStatus ArenaPlanner::CalculateTensorAllocation(int tensor_index) {
   return kTfLiteOk;
 }
 
+size_t ArenaPlanner::PreferredOffsetForNode(int node_index) const {
+  if (node_index < 0 || node_index >= graph_info_->num_nodes()) {
+    return kArenaNoPreferredOffset;
+  }
+  const TfLiteNode& node = graph_info_->node(node_index);
+  size_t preferred_offset = kArenaNoPreferredOffset;
+  auto consider_tensors = [&](const TfLiteIntArray* tensors) {
+    for (int i = 0; i < tensors->size; ++i) {
+      int tensor_index = tensors->data[i];
+      if (tensor_index == kOptionalTensor) continue;
+      const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+      if (tensor.allocation_type != kTfLiteArenaRw) continue;
+      const ArenaAlloc& alloc = allocs_[tensor_index];
+      if (alloc.size == 0) continue;
+      size_t end = AlignTo(tensor_alignment_, alloc.offset + alloc.size);
+      if (preferred_offset == kArenaNoPreferredOffset ||
+          end > preferred_offset) {
+        preferred_offset = end;
+      }
+    }
+  };
+  consider_tensors(node.inputs);
+  consider_tensors(node.outputs);
+  return preferred_offset;
+}
+
 TfLiteStatus ArenaPlanner::CalculateTensorDeallocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -289,7 +607,7 @@ TfLiteStatus ArenaPlanner::CalculateAllocationOfInternalTensors(
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int i = 0; i < node_temporaries->size; ++i) {
       int tensor_index = node_temporaries->data[i];
-      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(tensor_index));
+      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(tensor_index, node_index));
     }
   }
   return kTfLiteOk;
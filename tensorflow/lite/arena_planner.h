@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/lite/c/c_api_internal.h"
@@ -49,10 +50,14 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. If 'preserve_inputs' is true the inputs to the
   // graph will not share memory with any other tensor, effectively preserving
-  // them until the end of inference.
+  // them until the end of inference. A non-zero 'locality_slack' lets the
+  // arena grow by up to that many bytes in exchange for packing each op's
+  // inputs and outputs next to each other, which keeps the op's working set
+  // in fewer cache lines on devices with small last-level caches.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_inputs, bool preserve_intermediates,
-               int tensor_alignment = kDefaultTensorAlignment);
+               int tensor_alignment = kDefaultTensorAlignment,
+               size_t locality_slack = 0);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -61,10 +66,45 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus PlanAllocations() override;
   TfLiteStatus ExecuteAllocations(int first_node, int last_node) override;
 
+  // Serializes the computed allocation plan (per-tensor arena offsets and
+  // sizes) into `serialized`. Only valid after ExecuteAllocations() has run
+  // over the whole graph. The plan captures the result of lifetime analysis
+  // and offset assignment for a specific model, set of interpreter settings
+  // and host; it is meant to be computed once, stored next to the model, and
+  // handed back via RestorePlan() so that subsequent loads of fixed-shape
+  // models skip planning entirely.
+  TfLiteStatus SerializePlan(std::string* serialized) const;
+
+  // Restores a plan previously produced by SerializePlan(), replacing both
+  // PlanAllocations() and the offset-assignment phase of
+  // ExecuteAllocations(). Returns an error if the data is malformed. A plan
+  // that no longer matches the graph (e.g. a tensor changed size) is detected
+  // when ExecuteAllocations() runs, which then falls back to full planning.
+  TfLiteStatus RestorePlan(const std::string& serialized);
+
   // Returns the base arena location for a given allocation type.
   int64_t BasePointer(TfLiteAllocationType type);
 
  private:
+  // Validates the restored plan against the prepared graph and, if it still
+  // matches, installs its offsets and commits the arenas. Returns an error
+  // without reporting if the plan and graph have diverged.
+  TfLiteStatus ApplyRestoredPlan();
+
+  // Re-plans after a resize without replaying the whole allocation queue:
+  // tensors whose size is unchanged keep the offsets of the last committed
+  // plan, and only resized (or newly added) tensors are assigned fresh
+  // offsets, constrained by the tensor lifetimes. Returns an error without
+  // reporting when the cached plan cannot be reused, in which case the
+  // caller falls back to a full replay.
+  TfLiteStatus ExecuteIncrementalAllocations();
+
+  // Computes, for every tensor, the interval of nodes during which it must
+  // remain allocated, from the allocation queue and the per-node
+  // temporaries. Tensors that are never allocated get a first node of -1;
+  // tensors that are never deallocated get a last node of INT32_MAX.
+  void CalculateTensorLifetimes(std::vector<int32_t>* first_node,
+                                std::vector<int32_t>* last_node) const;
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
   TfLiteStatus Commit();
@@ -77,8 +117,15 @@ class ArenaPlanner : public MemoryPlanner {
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
 
-  // Register an allocation for the given tensor.
-  TfLiteStatus CalculateTensorAllocation(int tensor_index);
+  // Register an allocation for the given tensor, requested by the given
+  // node. When a locality slack is configured, the tensor is placed as close
+  // as possible to the node's already-placed tensors.
+  TfLiteStatus CalculateTensorAllocation(int tensor_index, int node_index);
+
+  // Returns the first aligned offset after the already-placed kTfLiteArenaRw
+  // tensors of 'node_index', so that the node's remaining tensors can be
+  // packed next to them, or kArenaNoPreferredOffset if none is placed yet.
+  size_t PreferredOffsetForNode(int node_index) const;
 
   // Register a deallocation for the given tensor.
   TfLiteStatus CalculateTensorDeallocation(int tensor_index);
@@ -97,6 +144,18 @@ class ArenaPlanner : public MemoryPlanner {
   // Stores allocation data for all tensors.
   std::vector<ArenaAlloc> allocs_;
 
+  // Per-tensor allocations loaded through RestorePlan(), applied in place of
+  // planning while `has_restored_plan_` is true.
+  std::vector<ArenaAlloc> restored_allocs_;
+  bool has_restored_plan_ = false;
+
+  // Snapshot of the last whole-graph plan and the tensor sizes it was
+  // computed for, kept across ResetAllocations() so that re-planning after
+  // ResizeInputTensor() only has to lay out the tensors that changed size.
+  std::vector<ArenaAlloc> committed_allocs_;
+  std::vector<size_t> committed_sizes_;
+  bool has_committed_plan_ = false;
+
   // A chronological list of instructions to allocated and deallocate tensors,
   // reflecting the way they are used in the graph.
   std::vector<AllocationInfo> alloc_queue_;
@@ -120,6 +179,10 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // Number of bytes the arena may grow beyond its minimal size in order to
+  // co-locate the tensors of an op. Zero disables the locality heuristic.
+  size_t locality_slack_;
 };
 
 }  // namespace tflite
@@ -161,12 +161,14 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_inputs = false) {
+  void SetGraph(TestGraph* graph, bool preserve_inputs = false,
+                size_t locality_slack = 0) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment));
+        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment,
+        locality_slack));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -283,6 +285,36 @@ TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   EXPECT_EQ(GetOffset(3), GetOffsetAfter(1));
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithLocalitySlack) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},  // First op
+                      {{2, 1}, {3}, {}},  // Second op
+                      {{3}, {4}, {}}      // Third op
+                  },
+                  {4});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Alloc(+) and dealloc(-) order: +0 +1 +2 -0 +3 -1 -2 +4 -3
+  // Without slack, the last op's output reuses the gap left by the first
+  // op's deallocated tensors, far away from its input.
+  EXPECT_EQ(GetOffset(4), 0);
+
+  SetGraph(&graph, /*preserve_inputs=*/false, /*locality_slack=*/64);
+  Execute(0, 10);
+
+  // The tensors that were already packed tightly keep their offsets.
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(2));
+  // With slack, the last op's output is co-located right after its input
+  // instead of reusing the gap at the start of the arena.
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(3));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   TestGraph graph({0, 1},
                   {
@@ -534,6 +566,129 @@ TEST_F(ArenaPlannerTest, ModifiedGraph) {
   EXPECT_EQ(GetOffset(3), GetOffsetAfter(1));
 }
 
+TEST_F(ArenaPlannerTest, IncrementalReplanAfterResize) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  std::vector<int64_t> offsets;
+  for (int i = 0; i < 6; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // Growing #2 (as a batch-size change would) must leave every other tensor
+  // at its old offset and only find a new home for #2.
+  (*graph.tensors())[2].bytes = 100;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    if (i == 2) continue;
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+  // #2 no longer fits between #1 and #4 and moves past the end of #5.
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(5));
+
+  // Shrinking it back lets it return to the gap it originally occupied.
+  (*graph.tensors())[2].bytes = 3 * 3;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, SerializedPlanRoundTrip) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  std::string plan;
+  ASSERT_EQ(planner_->SerializePlan(&plan), kTfLiteOk);
+  std::vector<int64_t> offsets;
+  for (int i = 0; i < 6; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // Restoring the plan into a fresh planner over an identical graph must
+  // reproduce the same offsets without replanning.
+  TestGraph graph2({0, 1},
+                   {
+                       {{0, 1}, {2}, {}},
+                       {{2, 0}, {4, 5}, {}},
+                       {{4, 5}, {3}, {}}
+                   },
+                   {3});
+  SetGraph(&graph2);
+  ASSERT_EQ(planner_->RestorePlan(plan), kTfLiteOk);
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, StaleSerializedPlanFallsBackToPlanning) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},
+                      {{2, 0}, {4, 5}, {}},
+                      {{4, 5}, {3}, {}}
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  std::string plan;
+  ASSERT_EQ(planner_->SerializePlan(&plan), kTfLiteOk);
+
+  // Resize a tensor so the plan no longer matches the graph. ExecuteAllocations
+  // must detect the mismatch and silently plan from scratch.
+  TestGraph graph2({0, 1},
+                   {
+                       {{0, 1}, {2}, {}},
+                       {{2, 0}, {4, 5}, {}},
+                       {{4, 5}, {3}, {}}
+                   },
+                   {3});
+  (*graph2.tensors())[2].bytes += 64;
+  SetGraph(&graph2);
+  ASSERT_EQ(planner_->RestorePlan(plan), kTfLiteOk);
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(5), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(3), 0);
+}
+
+TEST_F(ArenaPlannerTest, MalformedSerializedPlanIsRejected) {
+  TestGraph graph({1}, {{{1}, {2}, {}}}, {2});
+  SetGraph(&graph);
+  EXPECT_EQ(planner_->RestorePlan("not a plan"), kTfLiteError);
+  // A truncated plan must also be rejected.
+  Execute(0, 10);
+  std::string plan;
+  ASSERT_EQ(planner_->SerializePlan(&plan), kTfLiteOk);
+  plan.resize(plan.size() - 1);
+  EXPECT_EQ(planner_->RestorePlan(plan), kTfLiteError);
+}
+
 }  // namespace
 }  // namespace tflite
 
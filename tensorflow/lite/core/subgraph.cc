@@ -14,6 +14,10 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/lite/core/subgraph.h"
+
+#include <algorithm>
+#include <thread>
+
 #include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/context_util.h"
@@ -496,6 +500,11 @@ TfLiteStatus Subgraph::AllocateTensors() {
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
+  parallel_chains_.clear();
+  if (parallel_invoke_threads_ > 1 && !has_dynamic_tensors_) {
+    BuildParallelChains();
+  }
+
   state_ = kStateInvokable;
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
@@ -507,6 +516,35 @@ TfLiteStatus Subgraph::AllocateTensors() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::SetPrecomputedAllocationPlan(const std::string& plan) {
+  if (parallel_invoke_threads_ > 1) {
+    // Plans record overlapping intermediates, which parallel execution
+    // forbids.
+    ReportError(
+        "SetPrecomputedAllocationPlan cannot be combined with "
+        "SetParallelInvokeThreads.");
+    return kTfLiteError;
+  }
+  if (memory_planner_) {
+    // The planner already exists; hand the plan to it directly so the next
+    // AllocateTensors() can apply it, e.g. after a ResizeInputTensor() to a
+    // previously planned geometry.
+    return static_cast<ArenaPlanner*>(memory_planner_.get())
+        ->RestorePlan(plan);
+  }
+  precomputed_allocation_plan_ = plan;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::GetAllocationPlan(std::string* plan) const {
+  if (!memory_planner_) {
+    ReportError("GetAllocationPlan called before AllocateTensors.");
+    return kTfLiteError;
+  }
+  return static_cast<ArenaPlanner*>(memory_planner_.get())
+      ->SerializePlan(plan);
+}
+
 // TODO(ycling): Support non-zero default values.
 TfLiteStatus Subgraph::ResetVariableTensors() {
   for (auto& tensor : tensors_) {
@@ -646,10 +684,26 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
 
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
+    // Parallel execution requires that no two intermediate tensors ever
+    // share arena space, since their lifetimes can overlap across threads.
     memory_planner_.reset(new ArenaPlanner(
         context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
-        /*preserve_inputs=*/true, /*preserve_intermediates*/ false));
-    memory_planner_->PlanAllocations();
+        /*preserve_inputs=*/true,
+        /*preserve_intermediates=*/parallel_invoke_threads_ > 1,
+        kDefaultTensorAlignment, arena_locality_slack_));
+    bool restored_plan = false;
+    if (!precomputed_allocation_plan_.empty() &&
+        parallel_invoke_threads_ <= 1) {
+      // A successfully restored plan replaces lifetime analysis entirely. If
+      // it later turns out not to match the prepared graph, the planner falls
+      // back to full planning on its own.
+      restored_plan = static_cast<ArenaPlanner*>(memory_planner_.get())
+                          ->RestorePlan(precomputed_allocation_plan_) ==
+                      kTfLiteOk;
+    }
+    if (!restored_plan) {
+      memory_planner_->PlanAllocations();
+    }
   }
 
   int last_exec_plan_index_prepared = 0;
@@ -689,6 +743,15 @@ TfLiteStatus Subgraph::Invoke() {
     }
   }
 
+  // Run independent branches in parallel when that was requested and the
+  // whole plan is prepared. A profiler forces the sequential path because
+  // profile events are not thread-safe.
+  if (parallel_invoke_threads_ > 1 && parallel_chains_.size() > 1 &&
+      profiler_ == nullptr &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    return InvokeParallel();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -746,6 +809,160 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+TfLiteStatus Subgraph::SetParallelInvokeThreads(int num_threads) {
+  if (memory_planner_) {
+    ReportError(
+        "SetParallelInvokeThreads must be called before the first call to "
+        "AllocateTensors.");
+    return kTfLiteError;
+  }
+  parallel_invoke_threads_ = num_threads < 2 ? 1 : num_threads;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetArenaLocalitySlack(size_t slack_bytes) {
+  if (memory_planner_) {
+    ReportError(
+        "SetArenaLocalitySlack must be called before the first call to "
+        "AllocateTensors.");
+    return kTfLiteError;
+  }
+  arena_locality_slack_ = slack_bytes;
+  return kTfLiteOk;
+}
+
+void Subgraph::BuildParallelChains() {
+  parallel_chains_.clear();
+
+  // Union-find over execution plan positions: two nodes belong to the same
+  // chain if they share any non-constant tensor, either as producer or
+  // consumer. Path halving keeps the scan close to linear.
+  std::vector<int> parent(execution_plan_.size());
+  for (size_t i = 0; i < parent.size(); ++i) parent[i] = i;
+  auto find_root = [&parent](int i) -> int {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+
+  // Maps each tensor to the first execution plan position that touched it.
+  std::vector<int> first_user(tensors_.size(), -1);
+  for (size_t i = 0; i < execution_plan_.size(); ++i) {
+    const TfLiteNode& node =
+        nodes_and_registration_[execution_plan_[i]].first;
+    for (const TfLiteIntArray* tensor_list :
+         {node.inputs, node.outputs, node.temporaries}) {
+      if (tensor_list == nullptr) continue;
+      for (int j = 0; j < tensor_list->size; ++j) {
+        int tensor_index = tensor_list->data[j];
+        if (tensor_index == kOptionalTensor) continue;
+        // Constant tensors are read-only and do not order nodes.
+        if (tensors_[tensor_index].allocation_type == kTfLiteMmapRo) continue;
+        if (first_user[tensor_index] == -1) {
+          first_user[tensor_index] = i;
+        } else {
+          parent[find_root(i)] = find_root(first_user[tensor_index]);
+        }
+      }
+    }
+  }
+
+  // Emit one chain per component, keeping execution plan order both across
+  // and within chains.
+  std::vector<int> chain_of_root(execution_plan_.size(), -1);
+  for (size_t i = 0; i < execution_plan_.size(); ++i) {
+    int root = find_root(i);
+    if (chain_of_root[root] == -1) {
+      chain_of_root[root] = parallel_chains_.size();
+      parallel_chains_.push_back({});
+    }
+    parallel_chains_[chain_of_root[root]].push_back(i);
+  }
+}
+
+void Subgraph::InvokeChain(const std::vector<int>& plan_indices,
+                           ChainResult* result) {
+  result->failed_node_index = -1;
+  result->cancelled = false;
+  for (int execution_plan_index : plan_indices) {
+    int node_index = execution_plan_[execution_plan_index];
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+
+    for (int i = 0; i < node.inputs->size; ++i) {
+      int tensor_index = node.inputs->data[i];
+      if (tensor_index == kOptionalTensor) {
+        continue;
+      }
+      TfLiteTensor* tensor = &tensors_[tensor_index];
+      if (tensor->delegate && tensor->delegate != node.delegate &&
+          tensor->data_is_stale) {
+        if (EnsureTensorDataIsReadable(tensor_index) != kTfLiteOk) {
+          result->failed_node_index = node_index;
+          return;
+        }
+      }
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      result->cancelled = true;
+      return;
+    }
+
+    if (OpInvoke(registration, &node) == kTfLiteError) {
+      result->failed_node_index = node_index;
+      return;
+    }
+  }
+}
+
+TfLiteStatus Subgraph::InvokeParallel() {
+  int num_workers = std::min(parallel_invoke_threads_,
+                             static_cast<int>(parallel_chains_.size()));
+  // Distribute the chains round-robin; each worker runs its share of the
+  // plan in execution order.
+  std::vector<std::vector<int>> work(num_workers);
+  for (size_t i = 0; i < parallel_chains_.size(); ++i) {
+    const std::vector<int>& chain = parallel_chains_[i];
+    std::vector<int>& bucket = work[i % num_workers];
+    bucket.insert(bucket.end(), chain.begin(), chain.end());
+  }
+
+  // Tensor pointers must be stable while workers are running.
+  EnsureTensorsVectorCapacity();
+
+  std::vector<ChainResult> results(num_workers);
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_workers; ++i) {
+    threads.push_back(std::thread(&Subgraph::InvokeChain, this,
+                                  std::cref(work[i]), &results[i]));
+  }
+  InvokeChain(work[0], &results[0]);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // Errors are reported here, after every worker has finished, so the error
+  // reporter is never used concurrently.
+  for (int i = 0; i < num_workers; ++i) {
+    if (results[i].cancelled) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+    if (results[i].failed_node_index != -1) {
+      int node_index = results[i].failed_node_index;
+      return ReportOpError(context_, nodes_and_registration_[node_index].first,
+                           nodes_and_registration_[node_index].second,
+                           node_index, "failed to invoke");
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
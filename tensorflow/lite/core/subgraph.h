@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_CORE_SUBGRAPH_H_
 
 #include <cstdlib>
+#include <string>
 #include <vector>
 
 #include "tensorflow/lite/allocation.h"
@@ -207,6 +208,20 @@ class Subgraph {
   // Returns status of success or failure.
   TfLiteStatus AllocateTensors();
 
+  // Supplies a serialized arena allocation plan previously obtained from
+  // GetAllocationPlan(), letting the next AllocateTensors() skip tensor
+  // lifetime analysis and offset assignment. The plan must match the tensor
+  // geometry in effect when AllocateTensors() runs; a plan that does not
+  // match is detected and discarded, falling back to full planning.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetPrecomputedAllocationPlan(const std::string& plan);
+
+  // Retrieves the serialized arena allocation plan computed by the last
+  // AllocateTensors(), for storage alongside the model. Returns an error if
+  // tensors have not been allocated yet.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus GetAllocationPlan(std::string* plan) const;
+
   // Invoke the subgraph (run the whole graph in dependency order).
   //
   // NOTE: It is possible that the interpreter is not in a ready state
@@ -215,6 +230,26 @@ class Subgraph {
   // Returns status of success or failure.
   TfLiteStatus Invoke();
 
+  // Enables parallel execution of independent branches of the graph during
+  // Invoke(). The execution plan is partitioned into connected components of
+  // the dataflow graph (constant tensors do not connect nodes), and the
+  // components are distributed over `num_threads` threads, including the
+  // calling thread. Must be called before the first AllocateTensors(), so
+  // that the memory plan keeps concurrent branches from sharing arena space;
+  // this increases peak arena usage. Graphs with dynamic tensors, an attached
+  // profiler, or a single component fall back to sequential execution. Pass a
+  // value less than 2 to disable.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetParallelInvokeThreads(int num_threads);
+
+  // Allows the tensor arena to grow by up to `slack_bytes` in exchange for
+  // placing each op's inputs and outputs next to each other in memory. This
+  // reduces cache misses on devices with small last-level caches, at the
+  // cost of a slightly larger arena. Must be called before the first
+  // AllocateTensors(). Pass zero to disable (the default).
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetArenaLocalitySlack(size_t slack_bytes);
+
   // Entry point for C node plugin API to report an error.
   void ReportError(const char* format, ...);
 
@@ -340,6 +375,30 @@ class Subgraph {
   TfLiteStatus PrepareOpsStartingAt(int first_execution_plan_index,
                                     int* last_execution_plan_index_prepared);
 
+  // Partitions the execution plan into connected components of the dataflow
+  // graph, filling parallel_chains_ with lists of execution plan indices.
+  // Nodes that only share constant (kTfLiteMmapRo) tensors are considered
+  // independent. Leaves a single chain when the graph has no parallelism.
+  void BuildParallelChains();
+
+  // Runs the fully prepared execution plan with the chains computed by
+  // BuildParallelChains() distributed across parallel_invoke_threads_
+  // threads. Only valid when no tensors are dynamic.
+  TfLiteStatus InvokeParallel();
+
+  // Outcome of running one worker's share of the plan in InvokeParallel().
+  struct ChainResult {
+    // Node index of the first failing op, or -1 if all ops succeeded.
+    int failed_node_index = -1;
+    // True if a client cancellation was observed.
+    bool cancelled = false;
+  };
+
+  // Invokes the ops at the given execution plan indices in order. Errors are
+  // recorded in 'result' and reported by the caller after all chains have
+  // finished, so that workers never touch the error reporter concurrently.
+  void InvokeChain(const std::vector<int>& plan_indices, ChainResult* result);
+
   // Tensors needed by the interpreter. Use `AddTensors` to add more blank
   // tensor entries. Note, `tensors_.data()` needs to be synchronized to the
   // `context_` whenever this std::vector is reallocated. Currently this
@@ -511,6 +570,22 @@ class Subgraph {
   // TODO(aselle): replace execution_plan_ with this.
   std::unique_ptr<TfLiteIntArray, TfLiteIntArrayDeleter> plan_cache_;
 
+  // Serialized allocation plan supplied via SetPrecomputedAllocationPlan(),
+  // handed to the memory planner when it is created. Empty if none was set.
+  std::string precomputed_allocation_plan_;
+
+  // Number of threads used by InvokeParallel(), including the calling thread.
+  // Values below 2 keep the default sequential execution.
+  int parallel_invoke_threads_ = 1;
+
+  // Number of bytes the tensor arena may grow in exchange for co-locating
+  // each op's tensors. Zero disables the locality heuristic.
+  size_t arena_locality_slack_ = 0;
+
+  // Independent chains of execution plan indices computed by
+  // BuildParallelChains() after the graph is fully prepared.
+  std::vector<std::vector<int>> parallel_chains_;
+
   // Whether to delegate to NN API
   std::unique_ptr<NNAPIDelegate> nnapi_delegate_;
 
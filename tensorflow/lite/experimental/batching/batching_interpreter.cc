@@ -0,0 +1,236 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_interpreter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace tflite {
+namespace batching {
+
+BatchingInterpreter::BatchingInterpreter(Interpreter* interpreter,
+                                         const Options& options)
+    : interpreter_(interpreter), options_(options) {
+  if (options_.max_batch_size < 1) {
+    options_.max_batch_size = 1;
+  }
+  if (options_.allowed_batch_sizes.empty()) {
+    for (int size = 1; size < options_.max_batch_size; size *= 2) {
+      options_.allowed_batch_sizes.push_back(size);
+    }
+    options_.allowed_batch_sizes.push_back(options_.max_batch_size);
+  } else {
+    std::sort(options_.allowed_batch_sizes.begin(),
+              options_.allowed_batch_sizes.end());
+    // Never gather more examples than can be run at once.
+    options_.max_batch_size =
+        std::min(options_.max_batch_size, options_.allowed_batch_sizes.back());
+  }
+
+  // Remember each input's per-example shape; batches only change dim 0.
+  for (int input_index : interpreter_->inputs()) {
+    const TfLiteTensor* tensor = interpreter_->tensor(input_index);
+    std::vector<int> example_dims;
+    for (int i = 1; i < tensor->dims->size; ++i) {
+      example_dims.push_back(tensor->dims->data[i]);
+    }
+    input_example_dims_.push_back(example_dims);
+  }
+
+  scheduler_ = std::thread(&BatchingInterpreter::SchedulerLoop, this);
+}
+
+BatchingInterpreter::~BatchingInterpreter() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    shutdown_ = true;
+  }
+  cond_.notify_all();
+  scheduler_.join();
+}
+
+TfLiteStatus BatchingInterpreter::Invoke(
+    const std::vector<std::vector<char>>& inputs,
+    std::vector<std::vector<char>>* outputs) {
+  if (inputs.size() != interpreter_->inputs().size() || outputs == nullptr) {
+    return kTfLiteError;
+  }
+
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+
+  std::unique_lock<std::mutex> lock(mu_);
+  if (shutdown_) {
+    return kTfLiteError;
+  }
+  queue_.push_back(&request);
+  cond_.notify_all();
+  while (!request.done) {
+    cond_.wait(lock);
+  }
+  return request.status;
+}
+
+int BatchingInterpreter::RoundUpBatchSize(int num_examples) const {
+  for (int size : options_.allowed_batch_sizes) {
+    if (size >= num_examples) {
+      return size;
+    }
+  }
+  return options_.allowed_batch_sizes.back();
+}
+
+TfLiteStatus BatchingInterpreter::PrepareForBatchSize(int batch_size) {
+  if (batch_size == current_batch_size_) {
+    return kTfLiteOk;
+  }
+  for (size_t i = 0; i < interpreter_->inputs().size(); ++i) {
+    std::vector<int> dims;
+    dims.push_back(batch_size);
+    dims.insert(dims.end(), input_example_dims_[i].begin(),
+                input_example_dims_[i].end());
+    if (interpreter_->ResizeInputTensor(interpreter_->inputs()[i], dims) !=
+        kTfLiteOk) {
+      return kTfLiteError;
+    }
+  }
+
+  // A geometry seen before can reuse its arena plan; the interpreter falls
+  // back to full planning on its own if the plan no longer applies.
+  std::map<int, std::string>::const_iterator cached =
+      plan_cache_.find(batch_size);
+  if (cached != plan_cache_.end()) {
+    interpreter_->SetPrecomputedAllocationPlan(cached->second);
+  }
+  if (interpreter_->AllocateTensors() != kTfLiteOk) {
+    return kTfLiteError;
+  }
+  if (cached == plan_cache_.end()) {
+    std::string plan;
+    if (interpreter_->GetAllocationPlan(&plan) == kTfLiteOk) {
+      plan_cache_[batch_size] = plan;
+    }
+  }
+  current_batch_size_ = batch_size;
+  return kTfLiteOk;
+}
+
+void BatchingInterpreter::ProcessBatch(const std::vector<Request*>& batch) {
+  const int num_examples = batch.size();
+  const int batch_size = RoundUpBatchSize(num_examples);
+
+  TfLiteStatus status = PrepareForBatchSize(batch_size);
+
+  // Scatter each example into its row of the batched input tensors. A size
+  // mismatch fails the whole batch; callers share the tensors, so a partial
+  // batch cannot be salvaged.
+  if (status == kTfLiteOk) {
+    for (size_t i = 0; i < interpreter_->inputs().size() && status == kTfLiteOk;
+         ++i) {
+      TfLiteTensor* tensor = interpreter_->tensor(interpreter_->inputs()[i]);
+      const size_t example_bytes = tensor->bytes / batch_size;
+      for (int example = 0; example < num_examples; ++example) {
+        const std::vector<char>& data = (*batch[example]->inputs)[i];
+        if (data.size() != example_bytes) {
+          status = kTfLiteError;
+          break;
+        }
+        memcpy(tensor->data.raw + example * example_bytes, data.data(),
+               example_bytes);
+      }
+      // Zero the padding rows so the op output is deterministic.
+      if (status == kTfLiteOk && num_examples < batch_size) {
+        memset(tensor->data.raw + num_examples * example_bytes, 0,
+               (batch_size - num_examples) * example_bytes);
+      }
+    }
+  }
+
+  if (status == kTfLiteOk) {
+    status = interpreter_->Invoke();
+  }
+
+  // Gather each example's rows of the batched output tensors.
+  if (status == kTfLiteOk) {
+    for (int example = 0; example < num_examples; ++example) {
+      batch[example]->outputs->resize(interpreter_->outputs().size());
+    }
+    for (size_t i = 0; i < interpreter_->outputs().size(); ++i) {
+      const TfLiteTensor* tensor =
+          interpreter_->tensor(interpreter_->outputs()[i]);
+      const size_t example_bytes = tensor->bytes / batch_size;
+      for (int example = 0; example < num_examples; ++example) {
+        std::vector<char>& data = (*batch[example]->outputs)[i];
+        data.resize(example_bytes);
+        memcpy(data.data(), tensor->data.raw + example * example_bytes,
+               example_bytes);
+      }
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mu_);
+  for (Request* request : batch) {
+    request->status = status;
+    request->done = true;
+  }
+  cond_.notify_all();
+}
+
+void BatchingInterpreter::SchedulerLoop() {
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    while (!shutdown_ && queue_.empty()) {
+      cond_.wait(lock);
+    }
+    if (shutdown_) break;
+
+    // Give other callers a chance to join the batch, up to the timeout.
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::microseconds(options_.batch_timeout_us);
+    while (!shutdown_ &&
+           static_cast<int>(queue_.size()) < options_.max_batch_size) {
+      if (cond_.wait_until(lock, deadline) == std::cv_status::timeout) {
+        break;
+      }
+    }
+    if (shutdown_) break;
+
+    std::vector<Request*> batch;
+    while (!queue_.empty() &&
+           static_cast<int>(batch.size()) < options_.max_batch_size) {
+      batch.push_back(queue_.front());
+      queue_.pop_front();
+    }
+
+    lock.unlock();
+    ProcessBatch(batch);
+    lock.lock();
+  }
+
+  // Fail anything still queued during shutdown.
+  while (!queue_.empty()) {
+    Request* request = queue_.front();
+    queue_.pop_front();
+    request->status = kTfLiteError;
+    request->done = true;
+  }
+  cond_.notify_all();
+}
+
+}  // namespace batching
+}  // namespace tflite
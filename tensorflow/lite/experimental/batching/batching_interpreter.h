@@ -0,0 +1,125 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_INTERPRETER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_INTERPRETER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+namespace batching {
+
+// A server-side batching front-end for a TFLite Interpreter.
+//
+// Concurrent callers each submit one example; a scheduler thread gathers
+// waiting examples into a batch, resizes the interpreter's inputs along
+// dimension 0, runs a single Invoke(), and hands each caller its slice of
+// the outputs. Batch sizes are rounded up to a small set of allowed sizes
+// so the interpreter only ever sees a few tensor geometries, and the arena
+// allocation plan computed for each geometry is cached and restored on
+// reuse, amortizing AllocateTensors() across requests.
+//
+// The wrapped interpreter must have fixed-shape tensors whose first input
+// dimension is the batch dimension, and must not be used directly while the
+// BatchingInterpreter exists.
+//
+// WARNING: This is experimental and subject to change.
+class BatchingInterpreter {
+ public:
+  struct Options {
+    // Largest number of examples run in one Invoke().
+    int max_batch_size = 8;
+    // How long the scheduler waits for more examples before running a
+    // partial batch.
+    int batch_timeout_us = 1000;
+    // Batch sizes the interpreter may be resized to, in ascending order.
+    // A batch is padded up to the smallest allowed size that fits. When
+    // empty, powers of two up to max_batch_size are used.
+    std::vector<int> allowed_batch_sizes;
+  };
+
+  // Ownership of 'interpreter' is not taken; it must outlive this object and
+  // already have had its tensors sized for some batch size.
+  BatchingInterpreter(Interpreter* interpreter, const Options& options);
+
+  // Fails all queued examples and joins the scheduler thread.
+  ~BatchingInterpreter();
+  BatchingInterpreter(const BatchingInterpreter&) = delete;
+  BatchingInterpreter& operator=(const BatchingInterpreter&) = delete;
+
+  // Runs one example. 'inputs' holds the raw data of a single example for
+  // each model input, in input order; on success 'outputs' is filled with a
+  // single example's data for each model output. Blocks until the example's
+  // batch has been processed. Safe to call from multiple threads.
+  TfLiteStatus Invoke(const std::vector<std::vector<char>>& inputs,
+                      std::vector<std::vector<char>>* outputs);
+
+ private:
+  // One caller's example, waiting in the queue until its batch runs.
+  struct Request {
+    const std::vector<std::vector<char>>* inputs;
+    std::vector<std::vector<char>>* outputs;
+    TfLiteStatus status = kTfLiteOk;
+    bool done = false;
+  };
+
+  // Scheduler thread body: gathers requests into batches and runs them.
+  void SchedulerLoop();
+
+  // Runs one batch of requests through the interpreter. Called only from the
+  // scheduler thread. Marks every request done, with its status.
+  void ProcessBatch(const std::vector<Request*>& batch);
+
+  // Resizes the interpreter's inputs to 'batch_size' examples and allocates
+  // tensors, restoring a cached allocation plan for that size when one
+  // exists. Called only from the scheduler thread.
+  TfLiteStatus PrepareForBatchSize(int batch_size);
+
+  // Returns the smallest allowed batch size that fits 'num_examples'.
+  int RoundUpBatchSize(int num_examples) const;
+
+  Interpreter* interpreter_;
+  Options options_;
+
+  // Per-input tensor dims beyond the batch dimension, captured at
+  // construction so each batch resize only changes dimension 0.
+  std::vector<std::vector<int>> input_example_dims_;
+
+  // Cached serialized allocation plans, keyed by batch size.
+  std::map<int, std::string> plan_cache_;
+
+  // Batch size the interpreter's tensors are currently allocated for, or 0
+  // before the first batch.
+  int current_batch_size_ = 0;
+
+  std::mutex mu_;
+  std::condition_variable cond_;
+  std::deque<Request*> queue_;  // Guarded by mu_. Requests owned by callers.
+  bool shutdown_ = false;       // Guarded by mu_.
+
+  std::thread scheduler_;
+};
+
+}  // namespace batching
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_INTERPRETER_H_
@@ -0,0 +1,147 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_interpreter.h"
+
+#include <cstring>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace batching {
+namespace {
+
+// Builds a single-op interpreter that adds 1.0 to a [batch, 2] float input.
+void BuildAddOneInterpreter(Interpreter* interpreter) {
+  ASSERT_EQ(interpreter->AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetOutputs({1}), kTfLiteOk);
+
+  TfLiteQuantizationParams quantized;
+  ASSERT_EQ(interpreter->SetTensorParametersReadWrite(0, kTfLiteFloat32, "in",
+                                                      {1, 2}, quantized),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->SetTensorParametersReadWrite(1, kTfLiteFloat32, "out",
+                                                      {1, 2}, quantized),
+            kTfLiteOk);
+
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    int num = input->bytes / sizeof(float);
+    for (int i = 0; i < num; ++i) {
+      output->data.f[i] = input->data.f[i] + 1.0f;
+    }
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(
+      interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+}
+
+std::vector<char> MakeExample(float a, float b) {
+  float values[2] = {a, b};
+  std::vector<char> data(sizeof(values));
+  memcpy(data.data(), values, sizeof(values));
+  return data;
+}
+
+TEST(BatchingInterpreter, SingleRequest) {
+  Interpreter interpreter;
+  BuildAddOneInterpreter(&interpreter);
+
+  BatchingInterpreter::Options options;
+  options.max_batch_size = 4;
+  BatchingInterpreter batcher(&interpreter, options);
+
+  std::vector<std::vector<char>> inputs = {MakeExample(1.0f, 2.0f)};
+  std::vector<std::vector<char>> outputs;
+  ASSERT_EQ(batcher.Invoke(inputs, &outputs), kTfLiteOk);
+  ASSERT_EQ(outputs.size(), 1);
+  ASSERT_EQ(outputs[0].size(), 2 * sizeof(float));
+  const float* result = reinterpret_cast<const float*>(outputs[0].data());
+  EXPECT_EQ(result[0], 2.0f);
+  EXPECT_EQ(result[1], 3.0f);
+}
+
+TEST(BatchingInterpreter, ConcurrentRequestsAreBatched) {
+  Interpreter interpreter;
+  BuildAddOneInterpreter(&interpreter);
+
+  BatchingInterpreter::Options options;
+  options.max_batch_size = 8;
+  options.batch_timeout_us = 10000;
+  BatchingInterpreter batcher(&interpreter, options);
+
+  const int kNumRequests = 16;
+  std::vector<std::thread> threads;
+  std::vector<TfLiteStatus> statuses(kNumRequests, kTfLiteError);
+  std::vector<std::vector<std::vector<char>>> outputs(kNumRequests);
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.push_back(std::thread([i, &batcher, &statuses, &outputs]() {
+      std::vector<std::vector<char>> inputs = {
+          MakeExample(i, 2.0f * i)};
+      statuses[i] = batcher.Invoke(inputs, &outputs[i]);
+    }));
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumRequests; ++i) {
+    ASSERT_EQ(statuses[i], kTfLiteOk);
+    ASSERT_EQ(outputs[i].size(), 1);
+    const float* result =
+        reinterpret_cast<const float*>(outputs[i][0].data());
+    EXPECT_EQ(result[0], i + 1.0f);
+    EXPECT_EQ(result[1], 2.0f * i + 1.0f);
+  }
+}
+
+TEST(BatchingInterpreter, RejectsWrongInputSize) {
+  Interpreter interpreter;
+  BuildAddOneInterpreter(&interpreter);
+
+  BatchingInterpreter::Options options;
+  options.max_batch_size = 1;
+  BatchingInterpreter batcher(&interpreter, options);
+
+  // One float instead of two.
+  std::vector<std::vector<char>> inputs = {std::vector<char>(sizeof(float))};
+  std::vector<std::vector<char>> outputs;
+  EXPECT_EQ(batcher.Invoke(inputs, &outputs), kTfLiteError);
+
+  // Wrong number of inputs.
+  std::vector<std::vector<char>> no_inputs;
+  EXPECT_EQ(batcher.Invoke(no_inputs, &outputs), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace batching
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -20,6 +20,7 @@ limitations under the License.
 #include <complex>
 #include <cstdio>
 #include <cstdlib>
+#include <string>
 #include <vector>
 
 #include "tensorflow/lite/allocation.h"
@@ -331,6 +332,23 @@ class Interpreter {
   // Returns status of success or failure.
   TfLiteStatus AllocateTensors();
 
+  // Supplies an allocation plan previously produced by GetAllocationPlan(),
+  // letting the next AllocateTensors() skip memory planning. The plan must
+  // match the tensor geometry in effect when AllocateTensors() runs; a plan
+  // that does not match is ignored and planning runs as usual.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetPrecomputedAllocationPlan(const std::string& plan) {
+    return primary_subgraph().SetPrecomputedAllocationPlan(plan);
+  }
+
+  // Serializes the current allocation plan into `plan`. Only valid after
+  // AllocateTensors() has succeeded. The plan is specific to the model, the
+  // interpreter settings and the host binary.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus GetAllocationPlan(std::string* plan) const {
+    return primary_subgraph().GetAllocationPlan(plan);
+  }
+
   // Invoke the interpreter (run the whole graph in dependency order).
   //
   // NOTE: It is possible that the interpreter is not in a ready state
@@ -339,6 +357,28 @@ class Interpreter {
   // Returns status of success or failure.
   TfLiteStatus Invoke();
 
+  // Enables parallel execution of independent branches of the graph during
+  // Invoke(), using up to `num_threads` threads including the calling one.
+  // Must be called before the first AllocateTensors(); the memory plan then
+  // keeps concurrent branches from sharing arena space, which increases peak
+  // arena usage. Graphs without independent branches, with dynamic tensors,
+  // or with an attached profiler run sequentially as before. Pass a value
+  // less than 2 to disable.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetParallelInvokeThreads(int num_threads) {
+    return primary_subgraph().SetParallelInvokeThreads(num_threads);
+  }
+
+  // Allows the tensor arena to grow by up to `slack_bytes` in exchange for
+  // placing each op's inputs and outputs next to each other in memory, which
+  // reduces cache misses on devices with small last-level caches. Must be
+  // called before the first AllocateTensors(). Pass zero to disable (the
+  // default).
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetArenaLocalitySlack(size_t slack_bytes) {
+    return primary_subgraph().SetArenaLocalitySlack(slack_bytes);
+  }
+
   // Enable or disable the NN API (true to enable)
   void UseNNAPI(bool enable);
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/kernels/eigen_support.h"
 #include "tensorflow/lite/kernels/gemm_support.h"
+#include "tensorflow/lite/kernels/internal/optimized/block_sparse_ops.h"
 #include "tensorflow/lite/kernels/internal/optimized/integer_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -65,6 +66,10 @@ struct OpData {
   int hwcn_weights_id = kTensorNotAllocated;
   int input_quantized_id = kTensorNotAllocated;
   int scaling_factors_id = kTensorNotAllocated;
+  // First of three consecutive ids for the block compressed-sparse-row form
+  // of a constant, mostly-zero pointwise filter: block row starts, block
+  // column indices and block contents.
+  int sparse_row_starts_id = kTensorNotAllocated;
 
   TfLitePaddingValues padding;
   // The scaling factor from input to output (aka the 'real multiplier') can
@@ -86,9 +91,15 @@ struct OpData {
   int32_t hwcn_weights_index;
   int32_t input_quantized_index;
   int32_t scaling_factors_index;
+  int32_t sparse_row_starts_index;
+  int32_t sparse_col_indices_index;
+  int32_t sparse_block_data_index;
+  int sparse_nonzero_blocks;
   bool need_hwcn_weights;
   bool have_weights_been_transposed;
   bool need_im2col;
+  bool use_sparse_weights;
+  bool have_sparse_weights_been_packed;
 
   bool run_multithreaded_kernel;
 };
@@ -173,6 +184,29 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   data->need_hwcn_weights = (input->type == kTfLiteFloat32 &&
                              data->run_multithreaded_kernel && !is_hybrid);
 
+  // A constant pointwise (1x1, stride 1, no dilation) filter that is mostly
+  // zero -- the dense form a pruned model ships with -- is repacked into
+  // block compressed-sparse-row form and evaluated as a block-sparse matrix
+  // multiply over the flattened activations, skipping the zero blocks.
+  data->use_sparse_weights = false;
+  if (!is_hybrid && !data->need_im2col && input->type == kTfLiteFloat32 &&
+      filter->type == kTfLiteFloat32 &&
+      filter->allocation_type == kTfLiteMmapRo) {
+    const int channels_out = filter->dims->data[0];
+    const int channels_in = filter->dims->data[3];
+    const int num_blocks = optimized_ops::BlockRowCount(channels_out) *
+                           optimized_ops::BlockColCount(channels_in);
+    data->sparse_nonzero_blocks = optimized_ops::CountNonZeroBlocks(
+        GetTensorData<float>(filter), channels_out, channels_in);
+    data->use_sparse_weights =
+        num_blocks - data->sparse_nonzero_blocks >=
+        num_blocks * optimized_ops::kMinBlockSparsity;
+    // The sparse kernel replaces the transposed-weights Eigen path.
+    if (data->use_sparse_weights) {
+      data->need_hwcn_weights = false;
+    }
+  }
+
   int temporaries_count = 0;
   if (data->need_im2col) {
     data->im2col_index = temporaries_count;
@@ -189,6 +223,17 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
     ++temporaries_count;
   }
 
+  if (data->use_sparse_weights) {
+    data->sparse_row_starts_index = temporaries_count;
+    data->sparse_col_indices_index = temporaries_count + 1;
+    data->sparse_block_data_index = temporaries_count + 2;
+    if (data->sparse_row_starts_id == kTensorNotAllocated) {
+      TF_LITE_ENSURE_OK(context, context->AddTensors(
+                                     context, 3, &data->sparse_row_starts_id));
+    }
+    temporaries_count += 3;
+  }
+
   if (is_hybrid) {
     // Allocate tensor to store the on-the-fly quantized inputs.
     data->input_quantized_index = temporaries_count;
@@ -383,6 +428,58 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     data->have_weights_been_transposed = false;
   }
 
+  // The block compressed-sparse-row form of the filter lives in persistent
+  // arena tensors so it is reused across invocations; it is filled at the
+  // first Eval, once the arena has been committed.
+  if (data->use_sparse_weights) {
+    node->temporaries->data[data->sparse_row_starts_index] =
+        data->sparse_row_starts_id;
+    node->temporaries->data[data->sparse_col_indices_index] =
+        data->sparse_row_starts_id + 1;
+    node->temporaries->data[data->sparse_block_data_index] =
+        data->sparse_row_starts_id + 2;
+    const int num_stored_blocks = std::max(data->sparse_nonzero_blocks, 1);
+
+    TfLiteTensor* row_starts =
+        GetTemporary(context, node, data->sparse_row_starts_index);
+    row_starts->type = kTfLiteInt32;
+    row_starts->allocation_type = kTfLiteArenaRwPersistent;
+    int row_starts_dims[1] = {optimized_ops::BlockRowCount(channels_out) + 1};
+    if (!TfLiteIntArrayEqualsArray(row_starts->dims, 1, row_starts_dims)) {
+      TfLiteIntArray* row_starts_size = TfLiteIntArrayCreate(1);
+      row_starts_size->data[0] = row_starts_dims[0];
+      TF_LITE_ENSURE_OK(
+          context, context->ResizeTensor(context, row_starts, row_starts_size));
+    }
+
+    TfLiteTensor* col_indices =
+        GetTemporary(context, node, data->sparse_col_indices_index);
+    col_indices->type = kTfLiteInt32;
+    col_indices->allocation_type = kTfLiteArenaRwPersistent;
+    int col_indices_dims[1] = {num_stored_blocks};
+    if (!TfLiteIntArrayEqualsArray(col_indices->dims, 1, col_indices_dims)) {
+      TfLiteIntArray* col_indices_size = TfLiteIntArrayCreate(1);
+      col_indices_size->data[0] = col_indices_dims[0];
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, col_indices,
+                                                       col_indices_size));
+    }
+
+    TfLiteTensor* block_data =
+        GetTemporary(context, node, data->sparse_block_data_index);
+    block_data->type = kTfLiteFloat32;
+    block_data->allocation_type = kTfLiteArenaRwPersistent;
+    int block_data_dims[1] = {num_stored_blocks *
+                              optimized_ops::kSparseBlockSize};
+    if (!TfLiteIntArrayEqualsArray(block_data->dims, 1, block_data_dims)) {
+      TfLiteIntArray* block_data_size = TfLiteIntArrayCreate(1);
+      block_data_size->data[0] = block_data_dims[0];
+      TF_LITE_ENSURE_OK(
+          context, context->ResizeTensor(context, block_data, block_data_size));
+    }
+    // The arena may move the buffers whenever tensors are (re)allocated.
+    data->have_sparse_weights_been_packed = false;
+  }
+
   if (is_hybrid) {
     node->temporaries->data[data->input_quantized_index] =
         data->input_quantized_id;
@@ -538,6 +635,44 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   }
 }
 
+// Pointwise convolution of a mostly-zero constant filter, evaluated as a
+// block-sparse matrix multiply with the spatial dimensions folded into the
+// batch dimension.
+void EvalSparseFloat(TfLiteContext* context, TfLiteNode* node,
+                     TfLiteConvParams* params, OpData* data,
+                     TfLiteTensor* input, TfLiteTensor* filter,
+                     TfLiteTensor* bias, TfLiteTensor* output) {
+  TfLiteTensor* row_starts =
+      GetTemporary(context, node, data->sparse_row_starts_index);
+  TfLiteTensor* col_indices =
+      GetTemporary(context, node, data->sparse_col_indices_index);
+  TfLiteTensor* block_data =
+      GetTemporary(context, node, data->sparse_block_data_index);
+  // A 1x1 filter of shape [channels_out, 1, 1, channels_in] is already laid
+  // out as the [channels_out, channels_in] matrix the packing expects.
+  const int channels_out = filter->dims->data[0];
+  const int channels_in = filter->dims->data[3];
+  if (!data->have_sparse_weights_been_packed) {
+    optimized_ops::PackBlockSparseMatrix(
+        GetTensorData<float>(filter), channels_out, channels_in,
+        GetTensorData<int32_t>(row_starts), GetTensorData<int32_t>(col_indices),
+        GetTensorData<float>(block_data));
+    data->have_sparse_weights_been_packed = true;
+  }
+  float output_activation_min, output_activation_max;
+  CalculateActivationRange(params->activation, &output_activation_min,
+                           &output_activation_max);
+  FullyConnectedParams op_params;
+  op_params.float_activation_min = output_activation_min;
+  op_params.float_activation_max = output_activation_max;
+  optimized_ops::BlockSparseFullyConnected(
+      op_params, GetTensorShape(input), GetTensorData<float>(input),
+      channels_out, channels_in, GetTensorData<int32_t>(row_starts),
+      GetTensorData<int32_t>(col_indices), GetTensorData<float>(block_data),
+      GetTensorData<float>(bias), GetTensorShape(output),
+      GetTensorData<float>(output));
+}
+
 template <KernelType kernel_type>
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, OpData* data, TfLiteTensor* input,
@@ -714,6 +849,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       if (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8) {
         EvalHybrid<kernel_type>(context, node, params, data, input, filter,
                                 bias, im2col, hwcn_weights, output);
+      } else if (data->use_sparse_weights && kernel_type != kReference) {
+        EvalSparseFloat(context, node, params, data, input, filter, bias,
+                        output);
       } else if (data->run_multithreaded_kernel) {
         EvalFloat<kernel_type>(context, node, params, data, input, filter, bias,
                                im2col, hwcn_weights, output);
@@ -123,6 +123,46 @@ class ConvolutionOpModel : public BaseConvolutionOpModel {
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
 };
 
+// A pointwise-convolution model whose filter and bias are compile-time
+// constants, so the kernel sees them as read-only tensors and may repack a
+// mostly-zero filter into the block-sparse form.
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           const TensorData& input,
+                           std::initializer_list<int> filter_shape,
+                           std::initializer_list<float> filter_data,
+                           std::initializer_list<float> bias_data,
+                           const TensorData& output) {
+    input_ = AddInput(input);
+    filter_ = AddConstInput(TensorType_FLOAT32, filter_data, filter_shape);
+    bias_ = AddConstInput(TensorType_FLOAT32, bias_data,
+                          {static_cast<int>(bias_data.size())});
+    output_ = AddOutput(output);
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID,
+                                     /*stride_width=*/1, /*stride_height=*/1,
+                                     ActivationFunctionType_NONE,
+                                     /*dilation_width_factor=*/1,
+                                     /*dilation_height_factor=*/1)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                    registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)});
+  }
+
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_CONVOLUTION_REF()},
     {"GenericOptimized", ops::builtin::Register_CONVOLUTION_GENERIC_OPT()},
@@ -290,6 +330,44 @@ TEST_P(ConvolutionOpTest, DISABLED_PointwiseMultifilterFloat32) {
               }));
 }
 
+TEST_P(ConvolutionOpTest, PointwiseBlockSparseFloat32) {
+  // Only 1 of the 4 blocks of the 8x8 pointwise filter holds non-zeros, so
+  // the optimized kernels take the block-sparse path; the reference kernel
+  // stays dense and must agree on the output.
+  SparseConvolutionOpModel m(
+      GetRegistration(), {TensorType_FLOAT32, {1, 2, 2, 8}},
+      /*filter_shape=*/{8, 1, 1, 8},
+      /*filter_data=*/
+      {
+          0, 0, 0, 0, 0, 0, 0, 0,  // u = 0
+          0, 0, 0, 0, 0, 0, 0, 0,  // u = 1
+          0, 0, 0, 0, 0, 0, 0, 0,  // u = 2
+          0, 0, 0, 0, 0, 0, 0, 0,  // u = 3
+          0, 0, 0, 0, 1, 1, 1, 1,  // u = 4
+          0, 0, 0, 0, 2, 2, 2, 2,  // u = 5
+          0, 0, 0, 0, 3, 3, 3, 3,  // u = 6
+          0, 0, 0, 0, 4, 4, 4, 4,  // u = 7
+      },
+      /*bias_data=*/{1, 2, 3, 4, 5, 6, 7, 8}, {TensorType_FLOAT32, {}});
+
+  m.SetInput({
+      1, 1, 1, 1, 1, 1, 1, 1,  // row = 1, column = 1
+      2, 2, 2, 2, 2, 2, 2, 2,  // row = 1, column = 2
+      3, 3, 3, 3, 3, 3, 3, 3,  // row = 2, column = 1
+      4, 4, 4, 4, 4, 4, 4, 4,  // row = 2, column = 2
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray({
+                  1, 2, 3, 4, 9, 14, 19, 24,   // row = 1, column = 1
+                  1, 2, 3, 4, 13, 22, 31, 40,  // row = 1, column = 2
+                  1, 2, 3, 4, 17, 30, 43, 56,  // row = 2, column = 1
+                  1, 2, 3, 4, 21, 38, 55, 72,  // row = 2, column = 2
+              }));
+}
+
 TEST_P(ConvolutionOpTest, SimpleTestFloat32WithAnisotropicStrides) {
   ConvolutionOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 3, 6, 1}},
                        {TensorType_FLOAT32, {1, 2, 2, 1}},
@@ -107,6 +107,12 @@ class LazyEigenThreadPoolHolder {
 struct RefCountedEigenContext : public TfLiteExternalContext {
   std::unique_ptr<LazyEigenThreadPoolHolder> thread_pool_holder;
   int num_references = 0;
+  // When true the context is owned by the process (see
+  // CreateSharedEigenContext) rather than by the interpreters using it, and
+  // is never deleted when the reference count drops to zero. The size of a
+  // shared pool is fixed at creation; per-interpreter thread settings do not
+  // resize it.
+  bool shared = false;
 };
 
 RefCountedEigenContext* GetEigenContext(TfLiteContext* context) {
@@ -115,9 +121,13 @@ RefCountedEigenContext* GetEigenContext(TfLiteContext* context) {
 }
 
 TfLiteStatus Refresh(TfLiteContext* context) {
+  auto* ptr = GetEigenContext(context);
+  if (ptr != nullptr && ptr->shared) {
+    return kTfLiteOk;
+  }
+
   SetEigenNbThreads(context->recommended_num_threads);
 
-  auto* ptr = GetEigenContext(context);
   if (ptr != nullptr) {
     ptr->thread_pool_holder->SetNumThreads(context->recommended_num_threads);
   }
@@ -151,12 +161,26 @@ void DecrementUsageCounter(TfLiteContext* context) {
         "Call to DecrementUsageCounter() not preceded by "
         "IncrementUsageCounter()");
   }
-  if (--ptr->num_references == 0) {
+  if (--ptr->num_references == 0 && !ptr->shared) {
     delete ptr;
     context->SetExternalContext(context, kTfLiteEigenContext, nullptr);
   }
 }
 
+TfLiteExternalContext* CreateSharedEigenContext(int num_threads) {
+  auto* ptr = new RefCountedEigenContext;
+  ptr->type = kTfLiteEigenContext;
+  ptr->Refresh = Refresh;
+  ptr->thread_pool_holder.reset(new LazyEigenThreadPoolHolder(num_threads));
+  ptr->num_references = 0;
+  ptr->shared = true;
+  return ptr;
+}
+
+void DestroySharedEigenContext(TfLiteExternalContext* context) {
+  delete reinterpret_cast<RefCountedEigenContext*>(context);
+}
+
 const Eigen::ThreadPoolDevice* GetThreadPoolDevice(TfLiteContext* context) {
   auto* ptr = GetEigenContext(context);
   if (ptr == nullptr) {
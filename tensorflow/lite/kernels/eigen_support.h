@@ -29,9 +29,21 @@ namespace eigen_support {
 void IncrementUsageCounter(TfLiteContext* context);
 
 // Let the framework know that the op stopped using Eigen. If there are no more
-// usages all temporary Eigen objects will be deleted.
+// usages all temporary Eigen objects will be deleted, unless they belong to a
+// shared context created with CreateSharedEigenContext().
 void DecrementUsageCounter(TfLiteContext* context);
 
+// Creates an Eigen thread pool wrapped in an external context that can be
+// installed into several interpreters, so that they all draw from one pool of
+// 'num_threads' threads instead of each spinning its own. The pool size is
+// fixed at creation; per-interpreter thread settings do not resize it. The
+// caller owns the returned object and must keep it alive for as long as any
+// interpreter uses it, then release it with DestroySharedEigenContext().
+TfLiteExternalContext* CreateSharedEigenContext(int num_threads);
+
+// Destroys a context created with CreateSharedEigenContext().
+void DestroySharedEigenContext(TfLiteExternalContext* context);
+
 // Fetch the ThreadPoolDevice associated with the provided context.
 //
 // Note: The caller must ensure that |IncrementUsageCounter()| has already been
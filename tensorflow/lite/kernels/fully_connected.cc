@@ -13,17 +13,20 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/kernels/activation_functor.h"
 #include "tensorflow/lite/kernels/gemm_support.h"
+#include "tensorflow/lite/kernels/internal/optimized/block_sparse_ops.h"
 #include "tensorflow/lite/kernels/internal/optimized/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
@@ -46,6 +49,9 @@ enum KernelType {
   kLegacyPie,  // Legacy path used by the PIE team and related clients.
 };
 
+// This sentinel is used to mark the packed-weights tensor as not yet created.
+constexpr int kTensorNotAllocated = -1;
+
 struct OpData {
   // The scaling factor from input to output (aka the 'real multiplier') can
   // be represented as a fixed point multiplier plus a left shift.
@@ -57,6 +63,25 @@ struct OpData {
   int32_t output_activation_max;
   // The index of the temporary tensor where the quantized inputs are cached.
   int scratch_tensor_index;
+  // Per-channel quantization parameters, used when the int8 filter carries
+  // one scale per output channel; empty otherwise.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int> per_channel_output_shift;
+  bool is_per_channel = false;
+  // Id of the persistent tensor holding the cache-blocked prepacked copy of
+  // the weights used by the per-channel path. The packing happens at the
+  // first Eval, since the persistent arena buffer only becomes valid once
+  // tensors have been allocated.
+  int packed_weights_id = kTensorNotAllocated;
+  bool have_weights_been_packed = false;
+  // Ids of the persistent tensors holding the block compressed-sparse-row
+  // form of a constant, mostly-zero float filter: block row starts, block
+  // column indices and block contents, consecutively. Packed at the first
+  // Eval like the quantized packed weights above.
+  int sparse_row_starts_id = kTensorNotAllocated;
+  int sparse_nonzero_blocks = 0;
+  bool use_sparse_weights = false;
+  bool have_sparse_weights_been_packed = false;
 };
 
 constexpr int kInputTensor = 0;
@@ -117,15 +142,35 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   if (input->type == kTfLiteUInt8 || input->type == kTfLiteInt8) {
-    double real_multiplier = 0.0;
-    TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
-        context, input, filter, bias, output, &real_multiplier));
-    int exponent;
-    QuantizeMultiplier(real_multiplier, &data->output_multiplier, &exponent);
-    data->output_shift = exponent;
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            filter->quantization.params);
+    data->is_per_channel =
+        filter->quantization.type == kTfLiteAffineQuantization &&
+        affine_quantization != nullptr && affine_quantization->scale &&
+        affine_quantization->scale->size > 1;
+    if (data->is_per_channel) {
+      const int number_channel = affine_quantization->scale->size;
+      data->per_channel_output_multiplier.resize(number_channel);
+      data->per_channel_output_shift.resize(number_channel);
+      TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
+          context, input, filter, bias, output, params->activation,
+          &data->output_multiplier, &data->output_shift,
+          &data->output_activation_min, &data->output_activation_max,
+          data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data()));
+    }
     TF_LITE_ENSURE_STATUS(CalculateActivationRangeQuantized(
         context, params->activation, output, &data->output_activation_min,
         &data->output_activation_max));
+    if (!data->is_per_channel) {
+      double real_multiplier = 0.0;
+      TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
+          context, input, filter, bias, output, &real_multiplier));
+      int exponent;
+      QuantizeMultiplier(real_multiplier, &data->output_multiplier, &exponent);
+      data->output_shift = exponent;
+    }
   }
 
   // If we have to perform on-the-fly quantization (with quantized weights and
@@ -158,6 +203,108 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
+  // Pruned float models still ship dense filters, just mostly zero. When the
+  // filter is a constant and enough of its blocks are all-zero, repack it
+  // into block compressed-sparse-row form so Eval can skip the zero blocks.
+  // The packed form lives in persistent arena tensors filled at the first
+  // Eval, once the arena has been committed.
+  data->use_sparse_weights = false;
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat32 &&
+      filter->allocation_type == kTfLiteMmapRo) {
+    const int input_depth = filter->dims->data[1];
+    const int num_blocks = optimized_ops::BlockRowCount(num_units) *
+                           optimized_ops::BlockColCount(input_depth);
+    data->sparse_nonzero_blocks = optimized_ops::CountNonZeroBlocks(
+        GetTensorData<float>(filter), num_units, input_depth);
+    data->use_sparse_weights =
+        num_blocks - data->sparse_nonzero_blocks >=
+        num_blocks * optimized_ops::kMinBlockSparsity;
+  }
+  if (data->use_sparse_weights) {
+    if (data->sparse_row_starts_id == kTensorNotAllocated) {
+      TF_LITE_ENSURE_OK(context, context->AddTensors(
+                                     context, 3, &data->sparse_row_starts_id));
+      // AddTensors may reallocate the tensor array; refresh the pointers.
+      filter = GetInput(context, node, kWeightsTensor);
+      output = GetOutput(context, node, kOutputTensor);
+    }
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(3);
+    node->temporaries->data[0] = data->sparse_row_starts_id;
+    node->temporaries->data[1] = data->sparse_row_starts_id + 1;
+    node->temporaries->data[2] = data->sparse_row_starts_id + 2;
+    const int num_stored_blocks = std::max(data->sparse_nonzero_blocks, 1);
+
+    TfLiteTensor* row_starts = GetTemporary(context, node, /*index=*/0);
+    row_starts->type = kTfLiteInt32;
+    row_starts->allocation_type = kTfLiteArenaRwPersistent;
+    int row_starts_dims[1] = {optimized_ops::BlockRowCount(num_units) + 1};
+    if (!TfLiteIntArrayEqualsArray(row_starts->dims, 1, row_starts_dims)) {
+      TfLiteIntArray* row_starts_size = TfLiteIntArrayCreate(1);
+      row_starts_size->data[0] = row_starts_dims[0];
+      TF_LITE_ENSURE_OK(
+          context, context->ResizeTensor(context, row_starts, row_starts_size));
+    }
+
+    TfLiteTensor* col_indices = GetTemporary(context, node, /*index=*/1);
+    col_indices->type = kTfLiteInt32;
+    col_indices->allocation_type = kTfLiteArenaRwPersistent;
+    int col_indices_dims[1] = {num_stored_blocks};
+    if (!TfLiteIntArrayEqualsArray(col_indices->dims, 1, col_indices_dims)) {
+      TfLiteIntArray* col_indices_size = TfLiteIntArrayCreate(1);
+      col_indices_size->data[0] = col_indices_dims[0];
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, col_indices,
+                                                       col_indices_size));
+    }
+
+    TfLiteTensor* block_data = GetTemporary(context, node, /*index=*/2);
+    block_data->type = kTfLiteFloat32;
+    block_data->allocation_type = kTfLiteArenaRwPersistent;
+    int block_data_dims[1] = {num_stored_blocks *
+                              optimized_ops::kSparseBlockSize};
+    if (!TfLiteIntArrayEqualsArray(block_data->dims, 1, block_data_dims)) {
+      TfLiteIntArray* block_data_size = TfLiteIntArrayCreate(1);
+      block_data_size->data[0] = block_data_dims[0];
+      TF_LITE_ENSURE_OK(
+          context, context->ResizeTensor(context, block_data, block_data_size));
+    }
+    // The arena may move the buffers whenever tensors are (re)allocated.
+    data->have_sparse_weights_been_packed = false;
+  }
+
+  // The per-channel int8 path reads the weights through a cache-blocked
+  // prepacked copy that is reused across invokes. It lives in a persistent
+  // arena tensor so it survives between invocations; it is filled at the
+  // first Eval, once the arena has been committed.
+  if (data->is_per_channel) {
+    if (data->packed_weights_id == kTensorNotAllocated) {
+      TF_LITE_ENSURE_OK(
+          context, context->AddTensors(context, 1, &data->packed_weights_id));
+      // AddTensors may reallocate the tensor array; refresh the pointers.
+      filter = GetInput(context, node, kWeightsTensor);
+      output = GetOutput(context, node, kOutputTensor);
+    }
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(1);
+    node->temporaries->data[0] = data->packed_weights_id;
+
+    TfLiteTensor* packed_weights = GetTemporary(context, node, /*index=*/0);
+    packed_weights->type = kTfLiteInt8;
+    packed_weights->allocation_type = kTfLiteArenaRwPersistent;
+    const int packed_size =
+        optimized_integer_ops::PackedFullyConnectedWeightsSize(
+            num_units, filter->dims->data[1]);
+    int packed_dims[1] = {packed_size};
+    if (!TfLiteIntArrayEqualsArray(packed_weights->dims, 1, packed_dims)) {
+      TfLiteIntArray* packed_weights_size = TfLiteIntArrayCreate(1);
+      packed_weights_size->data[0] = packed_size;
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, packed_weights,
+                                                       packed_weights_size));
+    }
+    // The arena may move the buffer whenever tensors are (re)allocated.
+    data->have_weights_been_packed = false;
+  }
+
   // Resize output.
   TfLiteIntArray* output_size_array = TfLiteIntArrayCreate(2);
   output_size_array->data[0] = batch_size;
@@ -304,6 +451,45 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
 }
 }  // namespace
 
+template <KernelType kernel_type>
+TfLiteStatus EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                                     TfLiteFullyConnectedParams* params,
+                                     OpData* data, const TfLiteTensor* input,
+                                     const TfLiteTensor* filter,
+                                     const TfLiteTensor* bias,
+                                     TfLiteTensor* output) {
+  FullyConnectedParams op_params;
+  op_params.input_offset = -input->params.zero_point;
+  op_params.output_offset = output->params.zero_point;
+  op_params.quantized_activation_min = data->output_activation_min;
+  op_params.quantized_activation_max = data->output_activation_max;
+  if (kernel_type == kReference) {
+    reference_integer_ops::FullyConnectedPerChannel(
+        op_params, data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(), GetTensorShape(input),
+        GetTensorData<int8_t>(input), GetTensorShape(filter),
+        GetTensorData<int8_t>(filter), GetTensorShape(bias),
+        GetTensorData<int32_t>(bias), GetTensorShape(output),
+        GetTensorData<int8_t>(output));
+  } else {
+    TfLiteTensor* packed_weights = GetTemporary(context, node, /*index=*/0);
+    if (!data->have_weights_been_packed) {
+      optimized_integer_ops::PackFullyConnectedWeights(
+          GetTensorData<int8_t>(filter), filter->dims->data[0],
+          filter->dims->data[1], GetTensorData<int8_t>(packed_weights));
+      data->have_weights_been_packed = true;
+    }
+    optimized_integer_ops::FullyConnectedPerChannel(
+        op_params, data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(), GetTensorShape(input),
+        GetTensorData<int8_t>(input), GetTensorShape(filter),
+        GetTensorData<int8_t>(packed_weights), GetTensorShape(bias),
+        GetTensorData<int32_t>(bias), GetTensorShape(output),
+        GetTensorData<int8_t>(output));
+  }
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                            TfLiteFullyConnectedParams* params, OpData* data,
@@ -348,6 +534,10 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
         }
         break;
       case kTfLiteInt8:
+        if (data->is_per_channel) {
+          return EvalQuantizedPerChannel<kernel_type>(
+              context, node, params, data, input, filter, bias, output);
+        }
         FullyConnectedInt8<kernel_type>(data, input, filter, bias, output,
                                         gemm_context);
         break;
@@ -413,11 +603,47 @@ TfLiteStatus EvalShuffledQuantized(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+TfLiteStatus EvalSparseFloat(TfLiteContext* context, TfLiteNode* node,
+                             TfLiteFullyConnectedParams* params, OpData* data,
+                             const TfLiteTensor* input,
+                             const TfLiteTensor* filter,
+                             const TfLiteTensor* bias, TfLiteTensor* output) {
+  TfLiteTensor* row_starts = GetTemporary(context, node, /*index=*/0);
+  TfLiteTensor* col_indices = GetTemporary(context, node, /*index=*/1);
+  TfLiteTensor* block_data = GetTemporary(context, node, /*index=*/2);
+  const int num_units = filter->dims->data[0];
+  const int input_size = filter->dims->data[1];
+  if (!data->have_sparse_weights_been_packed) {
+    optimized_ops::PackBlockSparseMatrix(
+        GetTensorData<float>(filter), num_units, input_size,
+        GetTensorData<int32_t>(row_starts), GetTensorData<int32_t>(col_indices),
+        GetTensorData<float>(block_data));
+    data->have_sparse_weights_been_packed = true;
+  }
+  float output_activation_min, output_activation_max;
+  CalculateActivationRange(params->activation, &output_activation_min,
+                           &output_activation_max);
+  FullyConnectedParams op_params;
+  op_params.float_activation_min = output_activation_min;
+  op_params.float_activation_max = output_activation_max;
+  optimized_ops::BlockSparseFullyConnected(
+      op_params, GetTensorShape(input), GetTensorData<float>(input), num_units,
+      input_size, GetTensorData<int32_t>(row_starts),
+      GetTensorData<int32_t>(col_indices), GetTensorData<float>(block_data),
+      GetTensorData<float>(bias), GetTensorShape(output),
+      GetTensorData<float>(output));
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
                        TfLiteFullyConnectedParams* params, OpData* data,
                        const TfLiteTensor* input, const TfLiteTensor* filter,
                        const TfLiteTensor* bias, TfLiteTensor* output) {
+  if (kernel_type == kGenericOptimized && data->use_sparse_weights) {
+    return EvalSparseFloat(context, node, params, data, input, filter, bias,
+                           output);
+  }
   float output_activation_min, output_activation_max;
   CalculateActivationRange(params->activation, &output_activation_min,
                            &output_activation_max);
@@ -269,6 +269,83 @@ class QuantizedFullyConnectedOpModel : public BaseFullyConnectedOpModel {
   }
 };
 
+// In the per-channel model the weights carry one symmetric scale per output
+// channel (row), as produced by per-axis quantized training.
+class PerChannelQuantizedFullyConnectedOpModel : public SingleOpModel {
+ public:
+  PerChannelQuantizedFullyConnectedOpModel(TfLiteRegistration* registration,
+                                           int units, int batches,
+                                           const TensorData& input,
+                                           const TensorData& weights,
+                                           const TensorData& output)
+      : batches_(batches), units_(units) {
+    int total_input_size = 1;
+    for (size_t i = 0; i < input.shape.size(); ++i) {
+      total_input_size *= input.shape[i];
+    }
+    input_size_ = total_input_size / batches_;
+
+    input_ = AddInput(input);
+    weights_ = AddInput(weights);
+
+    // The bias scale for each channel is input scale * weight channel scale.
+    std::vector<float> bias_scale(weights.per_channel_quantization_scales);
+    std::vector<int64_t> bias_zero_points(bias_scale.size(), 0);
+    for (size_t i = 0; i < bias_scale.size(); ++i) {
+      bias_scale[i] *= input.scale;
+    }
+    TensorData bias{TensorType_INT32,
+                    {units_},
+                    /*min=*/0,
+                    /*max=*/0,
+                    /*scale=*/0,
+                    /*zero_point=*/0,
+                    true,
+                    /*per_channel_scale=*/bias_scale,
+                    /*per_channel_zero_point=*/bias_zero_points,
+                    /*channel_index=*/0};
+    bias_ = AddInput(bias);
+
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(builder_,
+                                             ActivationFunctionType_RELU)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter(
+        {GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  void SetInput(const std::vector<float>& data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+  void SetWeights(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(weights_, data);
+  }
+  void SetBias(const std::vector<float>& data) {
+    PerChannelQuantizeBias(bias_, data);
+  }
+
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<int8_t>(ExtractVector<int8_t>(output_),
+                              GetScale(output_), GetZeroPoint(output_));
+  }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+
+  int batches_;
+  int units_;
+  int input_size_;
+};
+
 // In the hybrid model the weights are quantized (to uint8). But the bias,
 // input (and output) are expected to be in float precision.
 class HybridFullyConnectedOpModel : public SingleOpModel {
@@ -327,6 +404,48 @@ class HybridFullyConnectedOpModel : public SingleOpModel {
   int input_size_;
 };
 
+// A float model whose weights and bias are compile-time constants, so the
+// kernel sees them as read-only tensors and may repack mostly-zero weights
+// into the block-sparse form.
+class SparseFloatFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseFloatFullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                                   int batches, int input_size,
+                                   std::initializer_list<float> weights,
+                                   std::initializer_list<float> bias)
+      : batches_(batches), units_(units), input_size_(input_size) {
+    input_ = AddInput({TensorType_FLOAT32, {batches_, input_size_}});
+    weights_ =
+        AddConstInput(TensorType_FLOAT32, weights, {units_, input_size_});
+    bias_ = AddConstInput(TensorType_FLOAT32, bias, {units_});
+    output_ = AddOutput({TensorType_FLOAT32});
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(builder_,
+                                             ActivationFunctionType_RELU)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+
+  int batches_;
+  int units_;
+  int input_size_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_FULLY_CONNECTED_REF()},
     {"GenericOptimized", ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT()},
@@ -407,6 +526,64 @@ TEST_P(FloatFullyConnectedOpTest, SimpleTest2) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(11, 9));
 }
 
+TEST_P(FloatFullyConnectedOpTest, BlockSparseConstantWeights) {
+  // Only blocks (0, 0) and (1, 3) of the 2x4 block grid hold non-zeros, so
+  // the optimized kernel takes the block-sparse path; the other kernels stay
+  // dense and must agree on the output.
+  SparseFloatFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/8, /*batches=*/2, /*input_size=*/16,
+      /*weights=*/
+      {
+          1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // u = 0
+          2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // u = 1
+          3, 3, 3, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // u = 2
+          4, 4, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // u = 3
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1,  // u = 4
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2,  // u = 5
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 3, 3, 3,  // u = 6
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 4, 4, 4,  // u = 7
+      },
+      /*bias=*/{1, 2, 3, 4, 5, 6, 7, 8});
+
+  m.SetInput({
+      1,  2,  3,  4,  5,  6,  7,  8,   // b = 0
+      9,  10, 11, 12, 13, 14, 15, 16,  //
+      -1, -1, -1, -1, -1, -1, -1, -1,  // b = 1
+      -1, -1, -1, -1, -1, -1, -1, -1,  //
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAre(11, 22, 33, 44, 63, 122, 181, 240,  // b = 0
+                          0, 0, 0, 0, 1, 0, 0, 0));           // b = 1
+}
+
+TEST_P(FloatFullyConnectedOpTest, BlockSparseConstantWeightsPartialBlocks) {
+  // Neither dimension is a multiple of the block size, exercising the
+  // zero-padded edge blocks; 4 of the 6 blocks are all-zero.
+  SparseFloatFullyConnectedOpModel m(GetRegistration(), /*units=*/5,
+                                     /*batches=*/1, /*input_size=*/10,
+                                     /*weights=*/
+                                     {
+                                         0, 0, 0, 0, 0, 0, 0, 0, 1, 2,  // u = 0
+                                         0, 0, 0, 0, 0, 0, 0, 0, 1, 2,  // u = 1
+                                         0, 0, 0, 0, 0, 0, 0, 0, 1, 2,  // u = 2
+                                         0, 0, 0, 0, 0, 0, 0, 0, 1, 2,  // u = 3
+                                         1, 1, 1, 1, 0, 0, 0, 0, 0, 0,  // u = 4
+                                     },
+                                     /*bias=*/{1, 2, 3, 4, 5});
+
+  m.SetInput({1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAre(30, 31, 32, 33, 15));
+
+  // A second invocation reuses the packed weights.
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAre(30, 31, 32, 33, 15));
+}
+
 TEST(FloatFullyConnectedOpTest, SimpleTestNoBias) {
   // The optimized kernel assumes that the bias is specified.
   FloatFullyConnectedOpModel m(ops::builtin::Register_FULLY_CONNECTED_PIE(),
@@ -511,6 +688,84 @@ TEST_P(QuantizedFullyConnectedOpTest, SimpleTestSingleBatchQuantizedInt8) {
   EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAre(57, 58, 59, 60));
 }
 
+TEST_P(QuantizedFullyConnectedOpTest, SimplePerChannelTest) {
+  PerChannelQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 10}, -63.5, 64},
+      /*weights=*/
+      {TensorType_INT8,
+       {3, 10},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel=*/true,
+       /*per_channel_scales=*/{1, 2, 2},
+       /*per_channel_zeros=*/{0, 0, 0},
+       /*channel_index=*/0},
+      /*output=*/{TensorType_INT8, {}, -127, 128});
+
+  m.SetWeights({
+      1, 2, 3, 4,  5,  6,  7,  8,  9,  10,  // u = 0, scale = 1
+      2, 4, 6, 8,  10, 12, 14, 16, 18, 20,  // u = 1, scale = 2
+      2, 4, 6, 8,  10, 12, 14, 16, 18, 20,  // u = 2, scale = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear({24, 48, 49, 58, 116, 117})));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(23, 47, 48, 57, 115, 116));
+
+  // A second invoke reuses the weights packed during the first one.
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAre(23, 47, 48, 57, 115, 116));
+}
+
+// Dimensions that are not multiples of the packed tile shape exercise the
+// zero-padded edge tiles of the prepacked weights.
+TEST_P(QuantizedFullyConnectedOpTest, PerChannelTestPartialTiles) {
+  PerChannelQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/6, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 20}, -63.5, 64},
+      /*weights=*/
+      {TensorType_INT8,
+       {6, 20},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel=*/true,
+       /*per_channel_scales=*/{1, 2, 1, 2, 1, 2},
+       /*per_channel_zeros=*/{0, 0, 0, 0, 0, 0},
+       /*channel_index=*/0},
+      /*output=*/{TensorType_INT8, {}, -127, 128});
+
+  // Each unit's weights are a constant equal to unit index + 1.
+  std::vector<float> weights;
+  for (int u = 0; u < 6; ++u) {
+    for (int d = 0; d < 20; ++d) {
+      weights.push_back(u + 1);
+    }
+  }
+  m.SetWeights(weights);
+  m.SetBias({1, 2, 3, 4, 5, 6});
+
+  m.SetInput(std::vector<float>(2 * 20, 0.5));
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {11, 22, 33, 44, 55, 66, 11, 22, 33, 44, 55, 66})));
+}
+
 TEST_P(QuantizedFullyConnectedOpTest,
        SimpleTestQuantizedOutputMultiplierGreaterThan1Uint8) {
   // real_multiplier = 2.
@@ -25,6 +25,13 @@ namespace {
 struct RefCountedGemmContext : public TfLiteExternalContext {
   std::unique_ptr<gemmlowp::GemmContext> gemm_context;
   int num_references = 0;
+  // When true the context is owned by the process (see
+  // CreateSharedGemmContext) rather than by the interpreters using it, and is
+  // never deleted when the reference count drops to zero.
+  bool shared = false;
+  // Worker count of a shared context; per-interpreter thread settings are
+  // capped to it.
+  int max_num_threads = -1;
 };
 
 RefCountedGemmContext* GetGemmLowpContext(TfLiteContext* context) {
@@ -35,7 +42,12 @@ RefCountedGemmContext* GetGemmLowpContext(TfLiteContext* context) {
 TfLiteStatus Refresh(TfLiteContext* context) {
   auto* ptr = GetGemmLowpContext(context);
   if (ptr != nullptr) {
-    ptr->gemm_context->set_max_num_threads(context->recommended_num_threads);
+    int num_threads = context->recommended_num_threads;
+    if (ptr->shared &&
+        (num_threads == -1 || num_threads > ptr->max_num_threads)) {
+      num_threads = ptr->max_num_threads;
+    }
+    ptr->gemm_context->set_max_num_threads(num_threads);
   }
   return kTfLiteOk;
 }
@@ -65,12 +77,28 @@ void DecrementUsageCounter(TfLiteContext* context) {
         "Call to DecrementUsageCounter() not preceded by "
         "IncrementUsageCounter()");
   }
-  if (--ptr->num_references == 0) {
+  if (--ptr->num_references == 0 && !ptr->shared) {
     delete ptr;
     context->SetExternalContext(context, kTfLiteGemmLowpContext, nullptr);
   }
 }
 
+TfLiteExternalContext* CreateSharedGemmContext(int num_threads) {
+  auto* ptr = new RefCountedGemmContext;
+  ptr->type = kTfLiteGemmLowpContext;
+  ptr->Refresh = Refresh;
+  ptr->gemm_context.reset(new gemmlowp::GemmContext());
+  ptr->gemm_context->set_max_num_threads(num_threads);
+  ptr->num_references = 0;
+  ptr->shared = true;
+  ptr->max_num_threads = num_threads;
+  return ptr;
+}
+
+void DestroySharedGemmContext(TfLiteExternalContext* context) {
+  delete reinterpret_cast<RefCountedGemmContext*>(context);
+}
+
 gemmlowp::GemmContext* GetFromContext(TfLiteContext* context) {
   auto* ptr = GetGemmLowpContext(context);
   if (ptr == nullptr) {
@@ -42,9 +42,21 @@ gemmlowp::GemmContext* GetFromContext(TfLiteContext* context);
 void IncrementUsageCounter(TfLiteContext* context);
 
 // Let the framework know that the op stopped using the GemmContext stored in
-// 'context'. If there are no more usages the GemmContext will be deleted.
+// 'context'. If there are no more usages the GemmContext will be deleted,
+// unless it is a shared context created with CreateSharedGemmContext().
 void DecrementUsageCounter(TfLiteContext* context);
 
+// Creates a GemmContext wrapped in an external context that can be installed
+// into several interpreters, so that they all draw from one worker pool of
+// 'num_threads' threads instead of each spinning its own. Per-interpreter
+// thread settings are capped to the pool size. The caller owns the returned
+// object and must keep it alive for as long as any interpreter uses it, then
+// release it with DestroySharedGemmContext().
+TfLiteExternalContext* CreateSharedGemmContext(int num_threads);
+
+// Destroys a context created with CreateSharedGemmContext().
+void DestroySharedGemmContext(TfLiteExternalContext* context);
+
 }  // namespace gemm_support
 }  // namespace tflite
 
@@ -0,0 +1,157 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_BLOCK_SPARSE_OPS_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_BLOCK_SPARSE_OPS_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// Block compressed-sparse-row storage for pruned weight matrices.
+//
+// The dense [rows, cols] matrix is tiled into kSparseBlockRows x
+// kSparseBlockCols blocks; only blocks containing at least one non-zero are
+// stored. Per block row, 'row_starts' gives the range of stored blocks,
+// 'col_indices' their block-column positions, and 'block_data' their
+// (zero-padded) contents, contiguously. All-zero blocks cost neither memory
+// traffic nor arithmetic, which is where the speedup on pruned models comes
+// from; pruning in aligned 4x4 blocks preserves the most sparsity under this
+// encoding.
+constexpr int kSparseBlockRows = 4;
+constexpr int kSparseBlockCols = 4;
+constexpr int kSparseBlockSize = kSparseBlockRows * kSparseBlockCols;
+
+// Fraction of all-zero blocks a filter must reach before the sparse encoding
+// pays off; below it the bookkeeping of the sparse traversal outweighs the
+// skipped arithmetic.
+constexpr float kMinBlockSparsity = 0.6f;
+
+inline int BlockRowCount(int rows) {
+  return (rows + kSparseBlockRows - 1) / kSparseBlockRows;
+}
+
+inline int BlockColCount(int cols) {
+  return (cols + kSparseBlockCols - 1) / kSparseBlockCols;
+}
+
+// Returns the number of blocks of 'dense' holding at least one non-zero.
+inline int CountNonZeroBlocks(const float* dense, int rows, int cols) {
+  int nonzero_blocks = 0;
+  for (int br = 0; br < BlockRowCount(rows); ++br) {
+    for (int bc = 0; bc < BlockColCount(cols); ++bc) {
+      bool nonzero = false;
+      for (int r = br * kSparseBlockRows;
+           r < std::min(rows, (br + 1) * kSparseBlockRows) && !nonzero; ++r) {
+        for (int c = bc * kSparseBlockCols;
+             c < std::min(cols, (bc + 1) * kSparseBlockCols); ++c) {
+          if (dense[r * cols + c] != 0.0f) {
+            nonzero = true;
+            break;
+          }
+        }
+      }
+      if (nonzero) ++nonzero_blocks;
+    }
+  }
+  return nonzero_blocks;
+}
+
+// Packs 'dense' into block compressed-sparse-row form. 'row_starts' must hold
+// BlockRowCount(rows) + 1 entries, 'col_indices' one entry per non-zero block
+// and 'block_data' kSparseBlockSize values per non-zero block (see
+// CountNonZeroBlocks for the block count).
+inline void PackBlockSparseMatrix(const float* dense, int rows, int cols,
+                                  int32_t* row_starts, int32_t* col_indices,
+                                  float* block_data) {
+  int num_blocks = 0;
+  for (int br = 0; br < BlockRowCount(rows); ++br) {
+    row_starts[br] = num_blocks;
+    for (int bc = 0; bc < BlockColCount(cols); ++bc) {
+      float block[kSparseBlockSize] = {};
+      bool nonzero = false;
+      for (int r = 0; r < kSparseBlockRows; ++r) {
+        for (int c = 0; c < kSparseBlockCols; ++c) {
+          const int row = br * kSparseBlockRows + r;
+          const int col = bc * kSparseBlockCols + c;
+          if (row < rows && col < cols) {
+            const float value = dense[row * cols + col];
+            block[r * kSparseBlockCols + c] = value;
+            nonzero = nonzero || value != 0.0f;
+          }
+        }
+      }
+      if (nonzero) {
+        col_indices[num_blocks] = bc;
+        std::copy(block, block + kSparseBlockSize,
+                  block_data + num_blocks * kSparseBlockSize);
+        ++num_blocks;
+      }
+    }
+  }
+  row_starts[BlockRowCount(rows)] = num_blocks;
+}
+
+// Fully-connected layer (or pointwise convolution treated as one) over a
+// weight matrix packed with PackBlockSparseMatrix. Scalar tiles sized for the
+// compiler to vectorize; zero blocks are skipped entirely.
+inline void BlockSparseFullyConnected(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, int output_depth, int accum_depth,
+    const int32_t* row_starts, const int32_t* col_indices,
+    const float* block_data, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data) {
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+  const int batches = output_shape.FlatSize() / output_depth;
+  const int block_rows = BlockRowCount(output_depth);
+  for (int b = 0; b < batches; ++b) {
+    const float* input_row = input_data + b * accum_depth;
+    float* output_row = output_data + b * output_depth;
+    for (int br = 0; br < block_rows; ++br) {
+      float acc[kSparseBlockRows] = {};
+      for (int k = row_starts[br]; k < row_starts[br + 1]; ++k) {
+        const float* block = block_data + k * kSparseBlockSize;
+        const int col = col_indices[k] * kSparseBlockCols;
+        // The rightmost blocks are zero-padded in the weights; clamp the
+        // input reads to the real depth instead of padding the input.
+        const int depth_count = std::min(accum_depth - col, kSparseBlockCols);
+        for (int r = 0; r < kSparseBlockRows; ++r) {
+          for (int c = 0; c < depth_count; ++c) {
+            acc[r] += block[r * kSparseBlockCols + c] * input_row[col + c];
+          }
+        }
+      }
+      const int row_count =
+          std::min(output_depth - br * kSparseBlockRows, kSparseBlockRows);
+      for (int r = 0; r < row_count; ++r) {
+        float value = acc[r];
+        if (bias_data) {
+          value += bias_data[br * kSparseBlockRows + r];
+        }
+        output_row[br * kSparseBlockRows + r] =
+            ActivationFunctionWithMinMax(value, output_activation_min,
+                                         output_activation_max);
+      }
+    }
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_BLOCK_SPARSE_OPS_H_
@@ -0,0 +1,532 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Micro-benchmark harness for the builtin kernels. Each case runs a single
+// op in its own interpreter across a matrix of representative shapes and
+// quantization modes, and emits one CSV row per case so results can be stored
+// as machine-readable baselines and diffed between releases.
+//
+// Timing is wall-clock microseconds; pass --cpu_mhz to add a cycles column.
+// When --peak_gmacs and --peak_gb_per_sec describe the target machine, each
+// row also reports the roofline-attainable rate for the op's arithmetic
+// intensity and the fraction of it achieved.
+//
+// Example:
+//   op_benchmark --num_runs=100 --peak_gmacs=16 --peak_gb_per_sec=12
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/command_line_flags.h"
+
+namespace tflite {
+namespace ops {
+namespace builtin {
+
+TfLiteRegistration* Register_CONV_2D();
+TfLiteRegistration* Register_DEPTHWISE_CONV_2D();
+TfLiteRegistration* Register_FULLY_CONNECTED();
+TfLiteRegistration* Register_AVERAGE_POOL_2D();
+TfLiteRegistration* Register_MAX_POOL_2D();
+TfLiteRegistration* Register_SOFTMAX();
+TfLiteRegistration* Register_RELU();
+
+}  // namespace builtin
+}  // namespace ops
+
+namespace benchmark {
+namespace {
+
+struct BenchmarkOptions {
+  int num_runs = 50;
+  int warmup_runs = 3;
+  // Peak multiply-accumulate rate and memory bandwidth of the machine, used
+  // for the roofline columns; 0 leaves them empty.
+  float peak_gmacs = 0.0f;
+  float peak_gb_per_sec = 0.0f;
+  // Clock frequency used to convert microseconds to cycles; 0 omits cycles.
+  float cpu_mhz = 0.0f;
+};
+
+// A single benchmark case: a one-op interpreter plus the work one invoke
+// performs, used for the throughput and roofline columns.
+struct OpBenchmark {
+  std::string op;
+  std::string dtype;
+  std::string shape;
+  std::unique_ptr<Interpreter> interpreter;
+  // Multiply-accumulates per invoke for compute ops; elements processed for
+  // memory-bound ops (pooling, activations).
+  int64_t macs = 0;
+  // Tensor bytes read and written per invoke, a lower bound on traffic.
+  int64_t bytes = 0;
+};
+
+// Quantization parameters used for all uint8/int8 benchmark tensors. The
+// product of input and filter scale stays below the output scale, as the
+// quantized kernels require.
+constexpr float kScale = 0.0078125f;  // 2^-7
+constexpr int kUint8ZeroPoint = 128;
+
+int64_t NumElements(const std::vector<int>& dims) {
+  int64_t count = 1;
+  for (int d : dims) count *= d;
+  return count;
+}
+
+int64_t TensorBytes(const std::vector<int>& dims, TfLiteType type) {
+  return NumElements(dims) * (type == kTfLiteFloat32 ? 4 : 1);
+}
+
+TfLiteQuantizationParams Quant(TfLiteType type) {
+  TfLiteQuantizationParams q;
+  q.scale = 0.0f;
+  q.zero_point = 0;
+  if (type == kTfLiteUInt8) {
+    q.scale = kScale;
+    q.zero_point = kUint8ZeroPoint;
+  } else if (type == kTfLiteInt8) {
+    q.scale = kScale;
+    q.zero_point = 0;
+  }
+  return q;
+}
+
+// Fills every input tensor with deterministic pseudo-random bytes, so
+// data-dependent paths (e.g. zero skipping) see realistic data.
+void FillInputs(Interpreter* interpreter) {
+  uint32_t state = 1;
+  for (int input : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(input);
+    for (size_t i = 0; i < tensor->bytes; ++i) {
+      state = state * 1664525u + 1013904223u;
+      tensor->data.raw[i] = static_cast<char>(state >> 24);
+    }
+  }
+}
+
+std::string DtypeName(TfLiteType type) {
+  return type == kTfLiteFloat32 ? "float32"
+                                : (type == kTfLiteUInt8 ? "uint8" : "int8");
+}
+
+std::unique_ptr<OpBenchmark> MakeConv(TfLiteType type, int size, int in_c,
+                                      int out_c, int kernel, int stride) {
+  auto b = std::unique_ptr<OpBenchmark>(new OpBenchmark);
+  b->op = "CONV_2D";
+  b->dtype = DtypeName(type);
+  char shape[64];
+  snprintf(shape, sizeof(shape), "%dx%dx%d/%dc%ds%d", size, size, in_c, out_c,
+           kernel, stride);
+  b->shape = shape;
+
+  const std::vector<int> input_dims = {1, size, size, in_c};
+  const std::vector<int> filter_dims = {out_c, kernel, kernel, in_c};
+  const std::vector<int> bias_dims = {out_c};
+  const int out_size = (size + stride - 1) / stride;  // 'same' padding.
+  const std::vector<int> output_dims = {1, out_size, out_size, out_c};
+
+  const TfLiteType bias_type = type == kTfLiteFloat32 ? kTfLiteFloat32
+                                                      : kTfLiteInt32;
+  TfLiteQuantizationParams bias_quant;
+  bias_quant.scale = kScale * kScale;
+  bias_quant.zero_point = 0;
+
+  b->interpreter.reset(new Interpreter);
+  b->interpreter->AddTensors(4);
+  b->interpreter->SetInputs({0, 1, 2});
+  b->interpreter->SetOutputs({3});
+  b->interpreter->SetTensorParametersReadWrite(0, type, "input", input_dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(1, type, "filter", filter_dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(
+      2, bias_type, "bias", bias_dims,
+      type == kTfLiteFloat32 ? Quant(type) : bias_quant);
+  b->interpreter->SetTensorParametersReadWrite(3, type, "output", output_dims,
+                                               Quant(type));
+
+  auto* params = reinterpret_cast<TfLiteConvParams*>(
+      malloc(sizeof(TfLiteConvParams)));
+  memset(params, 0, sizeof(TfLiteConvParams));
+  params->padding = kTfLitePaddingSame;
+  params->stride_width = stride;
+  params->stride_height = stride;
+  params->activation = kTfLiteActNone;
+  params->dilation_width_factor = 1;
+  params->dilation_height_factor = 1;
+  b->interpreter->AddNodeWithParameters({0, 1, 2}, {3}, nullptr, 0, params,
+                                        ops::builtin::Register_CONV_2D());
+
+  b->macs = static_cast<int64_t>(out_size) * out_size * out_c * kernel *
+            kernel * in_c;
+  b->bytes = TensorBytes(input_dims, type) + TensorBytes(filter_dims, type) +
+             TensorBytes(bias_dims, bias_type) +
+             TensorBytes(output_dims, type);
+  return b;
+}
+
+std::unique_ptr<OpBenchmark> MakeDepthwiseConv(TfLiteType type, int size,
+                                               int channels, int kernel,
+                                               int stride) {
+  auto b = std::unique_ptr<OpBenchmark>(new OpBenchmark);
+  b->op = "DEPTHWISE_CONV_2D";
+  b->dtype = DtypeName(type);
+  char shape[64];
+  snprintf(shape, sizeof(shape), "%dx%dx%d/%ds%d", size, size, channels,
+           kernel, stride);
+  b->shape = shape;
+
+  const std::vector<int> input_dims = {1, size, size, channels};
+  const std::vector<int> filter_dims = {1, kernel, kernel, channels};
+  const std::vector<int> bias_dims = {channels};
+  const int out_size = (size + stride - 1) / stride;
+  const std::vector<int> output_dims = {1, out_size, out_size, channels};
+
+  const TfLiteType bias_type = type == kTfLiteFloat32 ? kTfLiteFloat32
+                                                      : kTfLiteInt32;
+  TfLiteQuantizationParams bias_quant;
+  bias_quant.scale = kScale * kScale;
+  bias_quant.zero_point = 0;
+
+  b->interpreter.reset(new Interpreter);
+  b->interpreter->AddTensors(4);
+  b->interpreter->SetInputs({0, 1, 2});
+  b->interpreter->SetOutputs({3});
+  b->interpreter->SetTensorParametersReadWrite(0, type, "input", input_dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(1, type, "filter", filter_dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(
+      2, bias_type, "bias", bias_dims,
+      type == kTfLiteFloat32 ? Quant(type) : bias_quant);
+  b->interpreter->SetTensorParametersReadWrite(3, type, "output", output_dims,
+                                               Quant(type));
+
+  auto* params = reinterpret_cast<TfLiteDepthwiseConvParams*>(
+      malloc(sizeof(TfLiteDepthwiseConvParams)));
+  memset(params, 0, sizeof(TfLiteDepthwiseConvParams));
+  params->padding = kTfLitePaddingSame;
+  params->stride_width = stride;
+  params->stride_height = stride;
+  params->depth_multiplier = 1;
+  params->activation = kTfLiteActNone;
+  params->dilation_width_factor = 1;
+  params->dilation_height_factor = 1;
+  b->interpreter->AddNodeWithParameters(
+      {0, 1, 2}, {3}, nullptr, 0, params,
+      ops::builtin::Register_DEPTHWISE_CONV_2D());
+
+  b->macs =
+      static_cast<int64_t>(out_size) * out_size * channels * kernel * kernel;
+  b->bytes = TensorBytes(input_dims, type) + TensorBytes(filter_dims, type) +
+             TensorBytes(bias_dims, bias_type) +
+             TensorBytes(output_dims, type);
+  return b;
+}
+
+std::unique_ptr<OpBenchmark> MakeFullyConnected(TfLiteType type, int batches,
+                                                int input_size, int units) {
+  auto b = std::unique_ptr<OpBenchmark>(new OpBenchmark);
+  b->op = "FULLY_CONNECTED";
+  b->dtype = DtypeName(type);
+  char shape[64];
+  snprintf(shape, sizeof(shape), "%dx%d/%du", batches, input_size, units);
+  b->shape = shape;
+
+  const std::vector<int> input_dims = {batches, input_size};
+  const std::vector<int> filter_dims = {units, input_size};
+  const std::vector<int> bias_dims = {units};
+  const std::vector<int> output_dims = {batches, units};
+
+  const TfLiteType bias_type = type == kTfLiteFloat32 ? kTfLiteFloat32
+                                                      : kTfLiteInt32;
+  TfLiteQuantizationParams bias_quant;
+  bias_quant.scale = kScale * kScale;
+  bias_quant.zero_point = 0;
+
+  b->interpreter.reset(new Interpreter);
+  b->interpreter->AddTensors(4);
+  b->interpreter->SetInputs({0, 1, 2});
+  b->interpreter->SetOutputs({3});
+  b->interpreter->SetTensorParametersReadWrite(0, type, "input", input_dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(1, type, "filter", filter_dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(
+      2, bias_type, "bias", bias_dims,
+      type == kTfLiteFloat32 ? Quant(type) : bias_quant);
+  b->interpreter->SetTensorParametersReadWrite(3, type, "output", output_dims,
+                                               Quant(type));
+
+  auto* params = reinterpret_cast<TfLiteFullyConnectedParams*>(
+      malloc(sizeof(TfLiteFullyConnectedParams)));
+  memset(params, 0, sizeof(TfLiteFullyConnectedParams));
+  params->activation = kTfLiteActNone;
+  params->weights_format = kTfLiteFullyConnectedWeightsFormatDefault;
+  b->interpreter->AddNodeWithParameters(
+      {0, 1, 2}, {3}, nullptr, 0, params,
+      ops::builtin::Register_FULLY_CONNECTED());
+
+  b->macs = static_cast<int64_t>(batches) * input_size * units;
+  b->bytes = TensorBytes(input_dims, type) + TensorBytes(filter_dims, type) +
+             TensorBytes(bias_dims, bias_type) +
+             TensorBytes(output_dims, type);
+  return b;
+}
+
+std::unique_ptr<OpBenchmark> MakePool(bool average, TfLiteType type, int size,
+                                      int channels, int window, int stride) {
+  auto b = std::unique_ptr<OpBenchmark>(new OpBenchmark);
+  b->op = average ? "AVERAGE_POOL_2D" : "MAX_POOL_2D";
+  b->dtype = DtypeName(type);
+  char shape[64];
+  snprintf(shape, sizeof(shape), "%dx%dx%d/%dw%ds", size, size, channels,
+           window, stride);
+  b->shape = shape;
+
+  const std::vector<int> input_dims = {1, size, size, channels};
+  const int out_size = (size - window) / stride + 1;  // 'valid' padding.
+  const std::vector<int> output_dims = {1, out_size, out_size, channels};
+
+  b->interpreter.reset(new Interpreter);
+  b->interpreter->AddTensors(2);
+  b->interpreter->SetInputs({0});
+  b->interpreter->SetOutputs({1});
+  b->interpreter->SetTensorParametersReadWrite(0, type, "input", input_dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(1, type, "output", output_dims,
+                                               Quant(type));
+
+  auto* params = reinterpret_cast<TfLitePoolParams*>(
+      malloc(sizeof(TfLitePoolParams)));
+  memset(params, 0, sizeof(TfLitePoolParams));
+  params->padding = kTfLitePaddingValid;
+  params->stride_width = stride;
+  params->stride_height = stride;
+  params->filter_width = window;
+  params->filter_height = window;
+  params->activation = kTfLiteActNone;
+  b->interpreter->AddNodeWithParameters(
+      {0}, {1}, nullptr, 0, params,
+      average ? ops::builtin::Register_AVERAGE_POOL_2D()
+              : ops::builtin::Register_MAX_POOL_2D());
+
+  // Comparisons/additions, not MACs, but counted the same way for roofline
+  // purposes.
+  b->macs = static_cast<int64_t>(out_size) * out_size * channels * window *
+            window;
+  b->bytes = TensorBytes(input_dims, type) + TensorBytes(output_dims, type);
+  return b;
+}
+
+std::unique_ptr<OpBenchmark> MakeSoftmax(TfLiteType type, int batches,
+                                         int size) {
+  auto b = std::unique_ptr<OpBenchmark>(new OpBenchmark);
+  b->op = "SOFTMAX";
+  b->dtype = DtypeName(type);
+  char shape[64];
+  snprintf(shape, sizeof(shape), "%dx%d", batches, size);
+  b->shape = shape;
+
+  const std::vector<int> dims = {batches, size};
+
+  // The quantized softmax kernel requires an output scale of 1/256 and a
+  // zero point of 0.
+  TfLiteQuantizationParams output_quant = Quant(type);
+  if (type == kTfLiteUInt8) {
+    output_quant.scale = 1.0f / 256.0f;
+    output_quant.zero_point = 0;
+  }
+
+  b->interpreter.reset(new Interpreter);
+  b->interpreter->AddTensors(2);
+  b->interpreter->SetInputs({0});
+  b->interpreter->SetOutputs({1});
+  b->interpreter->SetTensorParametersReadWrite(0, type, "input", dims,
+                                               Quant(type));
+  b->interpreter->SetTensorParametersReadWrite(1, type, "output", dims,
+                                               output_quant);
+
+  auto* params = reinterpret_cast<TfLiteSoftmaxParams*>(
+      malloc(sizeof(TfLiteSoftmaxParams)));
+  memset(params, 0, sizeof(TfLiteSoftmaxParams));
+  params->beta = 1.0f;
+  b->interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, params,
+                                        ops::builtin::Register_SOFTMAX());
+
+  b->macs = static_cast<int64_t>(batches) * size;
+  b->bytes = 2 * TensorBytes(dims, type);
+  return b;
+}
+
+std::unique_ptr<OpBenchmark> MakeRelu(int batches, int size) {
+  auto b = std::unique_ptr<OpBenchmark>(new OpBenchmark);
+  b->op = "RELU";
+  b->dtype = "float32";
+  char shape[64];
+  snprintf(shape, sizeof(shape), "%dx%d", batches, size);
+  b->shape = shape;
+
+  const std::vector<int> dims = {batches, size};
+
+  b->interpreter.reset(new Interpreter);
+  b->interpreter->AddTensors(2);
+  b->interpreter->SetInputs({0});
+  b->interpreter->SetOutputs({1});
+  b->interpreter->SetTensorParametersReadWrite(0, kTfLiteFloat32, "input",
+                                               dims, Quant(kTfLiteFloat32));
+  b->interpreter->SetTensorParametersReadWrite(1, kTfLiteFloat32, "output",
+                                               dims, Quant(kTfLiteFloat32));
+  b->interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                        ops::builtin::Register_RELU());
+
+  b->macs = static_cast<int64_t>(batches) * size;
+  b->bytes = 2 * TensorBytes(dims, kTfLiteFloat32);
+  return b;
+}
+
+std::vector<std::unique_ptr<OpBenchmark>> BuildBenchmarkMatrix() {
+  std::vector<std::unique_ptr<OpBenchmark>> cases;
+  for (TfLiteType type : {kTfLiteFloat32, kTfLiteUInt8}) {
+    // Representative convolution layers: early spatial, pointwise,
+    // mid-network 3x3 and late pointwise.
+    cases.push_back(MakeConv(type, 224, 3, 32, 3, 2));
+    cases.push_back(MakeConv(type, 56, 64, 128, 1, 1));
+    cases.push_back(MakeConv(type, 28, 128, 128, 3, 1));
+    cases.push_back(MakeConv(type, 7, 512, 512, 1, 1));
+
+    cases.push_back(MakeDepthwiseConv(type, 112, 32, 3, 1));
+    cases.push_back(MakeDepthwiseConv(type, 28, 128, 3, 1));
+    cases.push_back(MakeDepthwiseConv(type, 7, 512, 3, 2));
+
+    cases.push_back(MakeFullyConnected(type, 1, 1024, 1000));
+    cases.push_back(MakeFullyConnected(type, 1, 2048, 512));
+    cases.push_back(MakeFullyConnected(type, 4, 512, 512));
+
+    cases.push_back(MakePool(/*average=*/true, type, 56, 64, 2, 2));
+    cases.push_back(MakePool(/*average=*/true, type, 7, 512, 7, 1));
+    cases.push_back(MakePool(/*average=*/false, type, 56, 64, 2, 2));
+
+    cases.push_back(MakeSoftmax(type, 1, 1000));
+  }
+  cases.push_back(MakeFullyConnected(kTfLiteInt8, 1, 1024, 1000));
+  cases.push_back(MakeFullyConnected(kTfLiteInt8, 4, 512, 512));
+  cases.push_back(MakeRelu(1, 112 * 112 * 32));
+  return cases;
+}
+
+bool RunBenchmark(OpBenchmark* b, const BenchmarkOptions& options) {
+  if (b->interpreter->AllocateTensors() != kTfLiteOk) {
+    fprintf(stderr, "Failed to allocate tensors for %s %s %s\n", b->op.c_str(),
+            b->dtype.c_str(), b->shape.c_str());
+    return false;
+  }
+  FillInputs(b->interpreter.get());
+
+  for (int i = 0; i < options.warmup_runs; ++i) {
+    if (b->interpreter->Invoke() != kTfLiteOk) {
+      fprintf(stderr, "Failed to invoke %s %s %s\n", b->op.c_str(),
+              b->dtype.c_str(), b->shape.c_str());
+      return false;
+    }
+  }
+
+  double sum_us = 0.0;
+  double sum_sq_us = 0.0;
+  double min_us = 0.0;
+  for (int i = 0; i < options.num_runs; ++i) {
+    const uint64_t start = profiling::time::NowMicros();
+    if (b->interpreter->Invoke() != kTfLiteOk) {
+      return false;
+    }
+    const double elapsed =
+        static_cast<double>(profiling::time::NowMicros() - start);
+    sum_us += elapsed;
+    sum_sq_us += elapsed * elapsed;
+    if (i == 0 || elapsed < min_us) min_us = elapsed;
+  }
+  const double mean_us = sum_us / options.num_runs;
+  const double var_us = sum_sq_us / options.num_runs - mean_us * mean_us;
+  const double stddev_us = var_us > 0.0 ? std::sqrt(var_us) : 0.0;
+
+  // Rates are computed from the best run, which is the least disturbed by
+  // the rest of the system and the right basis for regression gating.
+  const double gmacs_per_sec = b->macs / (min_us * 1e3);
+  const double macs_per_byte = static_cast<double>(b->macs) / b->bytes;
+
+  printf("%s,%s,%s,%.1f,%.1f,%.1f", b->op.c_str(), b->dtype.c_str(),
+         b->shape.c_str(), mean_us, stddev_us, min_us);
+  if (options.cpu_mhz > 0.0f) {
+    printf(",%.0f", min_us * options.cpu_mhz);
+  } else {
+    printf(",");
+  }
+  printf(",%lld,%.3f,%lld,%.2f", static_cast<long long>(b->macs),
+         gmacs_per_sec, static_cast<long long>(b->bytes), macs_per_byte);
+  if (options.peak_gmacs > 0.0f && options.peak_gb_per_sec > 0.0f) {
+    double attainable = macs_per_byte * options.peak_gb_per_sec;
+    if (attainable > options.peak_gmacs) attainable = options.peak_gmacs;
+    printf(",%.3f,%.1f\n", attainable, 100.0 * gmacs_per_sec / attainable);
+  } else {
+    printf(",,\n");
+  }
+  return true;
+}
+
+int Main(int argc, char** argv) {
+  BenchmarkOptions options;
+  std::vector<Flag> flags = {
+      Flag::CreateFlag("num_runs", &options.num_runs, "number of timed runs"),
+      Flag::CreateFlag("warmup_runs", &options.warmup_runs,
+                       "number of untimed warmup runs"),
+      Flag::CreateFlag("peak_gmacs", &options.peak_gmacs,
+                       "peak GMAC/s of this machine, for roofline columns"),
+      Flag::CreateFlag("peak_gb_per_sec", &options.peak_gb_per_sec,
+                       "peak memory bandwidth in GB/s, for roofline columns"),
+      Flag::CreateFlag("cpu_mhz", &options.cpu_mhz,
+                       "clock frequency used to report cycles"),
+  };
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flags)) {
+    fprintf(stderr, "%s", Flags::Usage(argv[0], flags).c_str());
+    return 1;
+  }
+
+  printf(
+      "op,dtype,shape,mean_us,stddev_us,min_us,cycles,macs,gmacs_per_sec,"
+      "bytes,macs_per_byte,attainable_gmacs,pct_of_attainable\n");
+  bool ok = true;
+  for (auto& benchmark : BuildBenchmarkMatrix()) {
+    ok = RunBenchmark(benchmark.get(), options) && ok;
+  }
+  return ok ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  return tflite::benchmark::Main(argc, argv);
+}
@@ -0,0 +1,47 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/shared_thread_pool.h"
+
+#include "tensorflow/lite/kernels/eigen_support.h"
+#include "tensorflow/lite/kernels/gemm_support.h"
+
+namespace tflite {
+
+SharedThreadPool::SharedThreadPool(int num_threads)
+    : num_threads_(num_threads < 1 ? 1 : num_threads) {
+  gemm_context_ = gemm_support::CreateSharedGemmContext(num_threads_);
+  eigen_context_ = eigen_support::CreateSharedEigenContext(num_threads_);
+}
+
+SharedThreadPool::~SharedThreadPool() {
+  gemm_support::DestroySharedGemmContext(gemm_context_);
+  eigen_support::DestroySharedEigenContext(eigen_context_);
+}
+
+TfLiteStatus SharedThreadPool::AttachTo(Interpreter* interpreter,
+                                        int max_invoke_threads) {
+  if (interpreter == nullptr) {
+    return kTfLiteError;
+  }
+  interpreter->SetExternalContext(kTfLiteGemmLowpContext, gemm_context_);
+  interpreter->SetExternalContext(kTfLiteEigenContext, eigen_context_);
+  // Kernels read the thread count from the interpreter's context, so express
+  // the cap there; the shared contexts clamp it to the pool size.
+  interpreter->SetNumThreads(max_invoke_threads == -1 ? num_threads_
+                                                      : max_invoke_threads);
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
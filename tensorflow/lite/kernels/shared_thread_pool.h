@@ -0,0 +1,72 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_SHARED_THREAD_POOL_H_
+#define TENSORFLOW_LITE_KERNELS_SHARED_THREAD_POOL_H_
+
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+
+// A process-level execution provider that lets several interpreters share one
+// set of worker threads. By default every Interpreter spins its own threads,
+// so a process running many models oversubscribes the cores; attaching all of
+// them to one SharedThreadPool keeps the total worker count bounded.
+//
+// Usage:
+//   SharedThreadPool pool(/*num_threads=*/4);
+//   pool.AttachTo(interpreter_a.get());
+//   pool.AttachTo(interpreter_b.get(), /*max_invoke_threads=*/1);
+// or, when building interpreters:
+//   builder.SetExternalContext(kTfLiteGemmLowpContext, pool.gemm_context());
+//   builder.SetExternalContext(kTfLiteEigenContext, pool.eigen_context());
+//
+// 'max_invoke_threads' caps how many of the pool's workers an interpreter's
+// invocations may occupy, so latency-critical models can be given the full
+// pool while background models are held to a smaller share. The cap can be
+// changed between invocations with Interpreter::SetNumThreads(). It applies
+// to the gemmlowp workers; the shared Eigen device has a fixed parallelism of
+// the pool size.
+//
+// The pool must outlive every interpreter attached to it.
+//
+// WARNING: This is an experimental API and subject to change.
+class SharedThreadPool {
+ public:
+  explicit SharedThreadPool(int num_threads);
+  ~SharedThreadPool();
+  SharedThreadPool(const SharedThreadPool&) = delete;
+  SharedThreadPool& operator=(const SharedThreadPool&) = delete;
+
+  // Makes 'interpreter' draw its worker threads from this pool.
+  // 'max_invoke_threads' limits the threads used by each of its invocations;
+  // -1 means the whole pool. Must be called before tensors are allocated.
+  TfLiteStatus AttachTo(Interpreter* interpreter, int max_invoke_threads = -1);
+
+  // Handles for installation via InterpreterBuilder::SetExternalContext().
+  TfLiteExternalContext* gemm_context() const { return gemm_context_; }
+  TfLiteExternalContext* eigen_context() const { return eigen_context_; }
+
+  int num_threads() const { return num_threads_; }
+
+ private:
+  int num_threads_;
+  TfLiteExternalContext* gemm_context_;
+  TfLiteExternalContext* eigen_context_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_SHARED_THREAD_POOL_H_
@@ -468,6 +468,13 @@ TfLiteStatus InterpreterBuilder::ApplyDelegates(Interpreter* interpreter) {
   return kTfLiteOk;
 }
 
+void InterpreterBuilder::SetExternalContext(
+    TfLiteExternalContextType type, TfLiteExternalContext* external_context) {
+  if (type >= 0 && type < kTfLiteMaxExternalContexts) {
+    external_contexts_[type] = external_context;
+  }
+}
+
 TfLiteStatus InterpreterBuilder::operator()(
     std::unique_ptr<Interpreter>* interpreter) {
   return operator()(interpreter, /*num_threads=*/-1);
@@ -520,6 +527,12 @@ TfLiteStatus InterpreterBuilder::operator()(
   }
 
   interpreter->reset(new Interpreter(error_reporter_));
+  for (int i = 0; i < kTfLiteMaxExternalContexts; ++i) {
+    if (external_contexts_[i] != nullptr) {
+      (*interpreter)->SetExternalContext(
+          static_cast<TfLiteExternalContextType>(i), external_contexts_[i]);
+    }
+  }
   (*interpreter)->SetNumThreads(num_threads);
   if (subgraphs->Length() > 1) {
     (*interpreter)->AddSubgraphs(subgraphs->Length() - 1);
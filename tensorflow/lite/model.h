@@ -194,6 +194,14 @@ class InterpreterBuilder {
   TfLiteStatus operator()(std::unique_ptr<Interpreter>* interpreter,
                           int num_threads);
 
+  // Registers an external context, e.g. the handle of a process-level shared
+  // thread pool, to be installed into every interpreter produced by this
+  // builder. Ownership is not taken; 'external_context' must outlive the
+  // interpreters built. Passing nullptr removes a previous registration.
+  // WARNING: This is an experimental API and subject to change.
+  void SetExternalContext(TfLiteExternalContextType type,
+                          TfLiteExternalContext* external_context);
+
  private:
   TfLiteStatus BuildLocalIndexToRegistrationMapping();
   TfLiteStatus ParseNodes(
@@ -214,6 +222,7 @@ class InterpreterBuilder {
   std::vector<const TfLiteRegistration*> flatbuffer_op_index_to_registration_;
   std::vector<BuiltinOperator> flatbuffer_op_index_to_registration_types_;
   const Allocation* allocation_ = nullptr;
+  TfLiteExternalContext* external_contexts_[kTfLiteMaxExternalContexts] = {};
 };
 
 }  // namespace tflite
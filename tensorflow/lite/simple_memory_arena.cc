@@ -34,7 +34,9 @@ namespace tflite {
 
 TfLiteStatus SimpleMemoryArena::Allocate(TfLiteContext* context,
                                          size_t alignment, size_t size,
-                                         ArenaAlloc* new_alloc) {
+                                         ArenaAlloc* new_alloc,
+                                         size_t preferred_offset,
+                                         size_t locality_slack) {
   TF_LITE_ENSURE(context, alignment <= arena_alignment_);
 
   if (size == 0) {
@@ -70,6 +72,43 @@ TfLiteStatus SimpleMemoryArena::Allocate(TfLiteContext* context,
     current_offset = it->offset + it->size;
   }
 
+  // When the caller expressed a placement preference, go through the gaps
+  // once more and pick the one that puts the allocation closest to the
+  // preferred offset, as long as that makes the buffer at most
+  // 'locality_slack' bytes larger than the best-fit choice above would.
+  if (preferred_offset != kArenaNoPreferredOffset) {
+    size_t max_extent =
+        std::max(high_water_mark_, best_offset + size) + locality_slack;
+    size_t best_distance = std::numeric_limits<size_t>::max();
+    auto consider_gap = [&](size_t gap_start, size_t gap_end,
+                            std::list<ArenaAlloc>::iterator insertion_it) {
+      size_t candidate = AlignTo(alignment, gap_start);
+      // If the gap spans the preferred offset, place the allocation right at
+      // it rather than at the start of the gap.
+      size_t aligned_preferred = AlignTo(alignment, preferred_offset);
+      if (aligned_preferred > candidate && aligned_preferred + size <= gap_end) {
+        candidate = aligned_preferred;
+      }
+      if (candidate + size > gap_end) return;
+      if (std::max(high_water_mark_, candidate + size) > max_extent) return;
+      size_t distance = candidate > preferred_offset
+                            ? candidate - preferred_offset
+                            : preferred_offset - candidate;
+      if (distance < best_distance) {
+        best_distance = distance;
+        best_offset = candidate;
+        best_insertion_it = insertion_it;
+      }
+    };
+    current_offset = 0;
+    for (auto it = allocs_.begin(); it != allocs_.end(); ++it) {
+      consider_gap(current_offset, it->offset, it);
+      current_offset = it->offset + it->size;
+    }
+    consider_gap(current_offset, std::numeric_limits<size_t>::max(),
+                 allocs_.end());
+  }
+
   // Update the required buffer size.
   high_water_mark_ = std::max(high_water_mark_, best_offset + size);
 
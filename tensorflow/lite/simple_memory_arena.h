@@ -21,6 +21,10 @@ limitations under the License.
 
 namespace tflite {
 
+// Passed as the preferred offset to SimpleMemoryArena::Allocate() when the
+// caller has no placement preference.
+constexpr const size_t kArenaNoPreferredOffset = ~static_cast<size_t>(0);
+
 // This little structure holds the offset and the size for a dynamic memory
 // allocation in the memory arena. When the arena is committed and the
 // underlying buffer is set, the alloc can be resolved into an actual memory
@@ -50,8 +54,15 @@ class SimpleMemoryArena {
         underlying_buffer_size_(0),
         allocs_() {}
 
+  // Reserves `size` bytes in the arena, preferring the smallest gap that
+  // fits. If `preferred_offset` is given, the allocation is instead placed as
+  // close to it as possible, provided this makes the arena at most
+  // `locality_slack` bytes larger than the default choice would. Callers use
+  // this to keep tensors that are accessed together in nearby cache lines.
   TfLiteStatus Allocate(TfLiteContext* context, size_t alignment, size_t size,
-                        ArenaAlloc* new_alloc);
+                        ArenaAlloc* new_alloc,
+                        size_t preferred_offset = kArenaNoPreferredOffset,
+                        size_t locality_slack = 0);
 
   TfLiteStatus Deallocate(TfLiteContext* context, const ArenaAlloc& alloc);
 
@@ -62,6 +73,16 @@ class SimpleMemoryArena {
     return arena_alignment_ + high_water_mark_ + padding;
   }
 
+  // Raises the high water mark to at least `size` bytes without registering
+  // an allocation. Used when restoring a precomputed allocation plan, where
+  // offsets were assigned externally and only the backing buffer needs to be
+  // reserved before Commit().
+  inline void ReserveSize(size_t size) {
+    if (size > high_water_mark_) {
+      high_water_mark_ = size;
+    }
+  }
+
   TfLiteStatus Commit(TfLiteContext* context);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context, const ArenaAlloc& alloc,
@@ -43,6 +43,36 @@ TEST(SimpleMemoryArenaTest, BasicArenaOperations) {
   EXPECT_EQ(allocs[5].offset, 1024);
 }
 
+TEST(SimpleMemoryArenaTest, PreferredOffsetWithinSlack) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAlloc allocs[5];
+
+  arena.Allocate(&context, 32, 2047, &allocs[0]);
+  arena.Allocate(&context, 32, 2047, &allocs[1]);
+  arena.Deallocate(&context, allocs[0]);
+
+  // Without slack the preference cannot be honored, since placing the
+  // allocation at the end would grow the buffer; it falls back to the gap
+  // left by allocs[0].
+  arena.Allocate(&context, 32, 1023, &allocs[2], /*preferred_offset=*/4096,
+                 /*locality_slack=*/0);
+  EXPECT_EQ(allocs[2].offset, 0);
+
+  // With enough slack the allocation lands right at the preferred offset,
+  // past the end of the current buffer.
+  arena.Allocate(&context, 32, 1023, &allocs[3], /*preferred_offset=*/4096,
+                 /*locality_slack=*/1024);
+  EXPECT_EQ(allocs[3].offset, 4096);
+
+  // A preference that points inside an existing gap is honored without any
+  // slack, since it does not grow the buffer.
+  arena.Deallocate(&context, allocs[2]);
+  arena.Allocate(&context, 32, 511, &allocs[4], /*preferred_offset=*/1024,
+                 /*locality_slack=*/0);
+  EXPECT_EQ(allocs[4].offset, 1024);
+}
+
 TEST(SimpleMemoryArenaTest, BasicZeroAlloc) {
   TfLiteContext context;
   SimpleMemoryArena arena(64);
@@ -186,6 +186,7 @@ struct ParsedTocoFlags {
   Arg<bool> enable_select_tf_ops = Arg<bool>(false);
   // WARNING: Experimental interface, subject to change
   Arg<bool> force_select_tf_ops = Arg<bool>(false);
+  Arg<bool> align_weight_buffers = Arg<bool>(false);
 };
 
 }  // namespace toco
@@ -47,6 +47,11 @@ using ::tflite::Tensor;
 
 namespace {
 
+// Alignment applied to constant buffers when --align_weight_buffers is set.
+// Matches the arena alignment used by the interpreter, so memory-mapped
+// weights can be consumed in place by kernels that require aligned data.
+constexpr size_t kWeightBufferAlignment = 64;
+
 // Check if a TensorFlow Op is a control flow op by its name.
 bool IsControlFlowOp(const string& tensorflow_op) {
   // Technically this is equalivent to `::tensorflow::Node::IsControlFlow()`.
@@ -413,12 +418,13 @@ Offset<Vector<Offset<Operator>>> ExportOperators(
 
 Offset<Vector<Offset<Buffer>>> ExportBuffers(
     const Model& model, const std::vector<const Array*>& buffers_to_write,
-    FlatBufferBuilder* builder) {
+    size_t buffer_alignment, FlatBufferBuilder* builder) {
   std::vector<Offset<Buffer>> buffer_vector;
   size_t index = 0;
   for (const Array* array_ptr : buffers_to_write) {
     const Array& array = *array_ptr;
-    Offset<Vector<uint8_t>> data_buffer = DataBuffer::Serialize(array, builder);
+    Offset<Vector<uint8_t>> data_buffer =
+        DataBuffer::Serialize(array, builder, buffer_alignment);
     buffer_vector.push_back(CreateBuffer(*builder, data_buffer));
     index++;
   }
@@ -578,7 +584,10 @@ tensorflow::Status Export(
                                  /* name */ 0);
   std::vector<flatbuffers::Offset<SubGraph>> subgraphs = {subgraph};
 
-  auto buffers = ExportBuffers(model, buffers_to_write, &builder);
+  const size_t buffer_alignment =
+      params.align_weight_buffers ? kWeightBufferAlignment : 0;
+  auto buffers =
+      ExportBuffers(model, buffers_to_write, buffer_alignment, &builder);
   auto description = builder.CreateString("TOCO Converted.");
   auto new_model_location =
       CreateModel(builder, TFLITE_SCHEMA_VERSION, op_codes,
@@ -28,6 +28,10 @@ struct ExportParams {
   bool allow_custom_ops = false;
   bool enable_select_tf_ops = false;
   bool quantize_weights = false;
+  // Pad constant buffers so their data is 64-byte aligned within the
+  // flatbuffer. This lets the interpreter alias memory-mapped weights
+  // directly, at the cost of a slightly larger model file.
+  bool align_weight_buffers = false;
 };
 
 // Transform the given tf.mini model into a TF Lite flatbuffer and deposit the
@@ -241,6 +241,30 @@ TEST_F(ExportTest, QuantizeWeights) {
   EXPECT_LT(quantized_result.size(), unquantized_result.size());
 }
 
+TEST_F(ExportTest, AlignWeightBuffers) {
+  BuildQuantizableTestModel();
+
+  ExportParams params;
+  params.allow_custom_ops = true;
+  params.align_weight_buffers = true;
+
+  string result;
+  ASSERT_TRUE(Export(input_model_, &result, params).ok());
+
+  // Every non-empty buffer must start at a 64-byte boundary within the
+  // flatbuffer, so memory-mapped weights can be used in place.
+  auto* model = ::tflite::GetModel(result.data());
+  int num_checked = 0;
+  for (const ::tflite::Buffer* buffer : *model->buffers()) {
+    if (buffer->data() == nullptr || buffer->data()->size() == 0) continue;
+    auto offset = reinterpret_cast<const char*>(buffer->data()->data()) -
+                  result.data();
+    EXPECT_EQ(0, offset % 64);
+    ++num_checked;
+  }
+  EXPECT_GT(num_checked, 0);
+}
+
 class OpSetsTest : public ExportTest {
  public:
   enum OpSet { kTfLiteBuiltins, kSelectTfOps, kCustomOps };
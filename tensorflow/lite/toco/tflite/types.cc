@@ -21,8 +21,19 @@ namespace tflite {
 
 namespace {
 
+// Asks the builder to align the start of the next vector of 'size' bytes,
+// when an alignment was requested. Must be called right before the
+// corresponding CreateVector.
+void MaybeForceAlignment(size_t size, size_t alignment,
+                         flatbuffers::FlatBufferBuilder* builder) {
+  if (alignment > 1) {
+    builder->ForceVectorAlignment(size, sizeof(uint8_t), alignment);
+  }
+}
+
 DataBuffer::FlatBufferOffset CopyStringToBuffer(
-    const Array& array, flatbuffers::FlatBufferBuilder* builder) {
+    const Array& array, flatbuffers::FlatBufferBuilder* builder,
+    size_t alignment) {
   const auto& src_data = array.GetBuffer<ArrayDataType::kString>().data;
   ::tflite::DynamicBuffer dyn_buffer;
   for (const string& str : src_data) {
@@ -33,6 +44,7 @@ DataBuffer::FlatBufferOffset CopyStringToBuffer(
   std::vector<uint8_t> dst_data(bytes);
   memcpy(dst_data.data(), tensor_buffer, bytes);
   free(tensor_buffer);
+  MaybeForceAlignment(bytes, alignment, builder);
   return builder->CreateVector(dst_data.data(), bytes);
 }
 
@@ -41,18 +53,22 @@ DataBuffer::FlatBufferOffset CopyStringToBuffer(
 // CreateVector handle it.
 // Background: https://isocpp.org/blog/2012/11/on-vectorbool
 DataBuffer::FlatBufferOffset CopyBoolToBuffer(
-    const Array& array, flatbuffers::FlatBufferBuilder* builder) {
+    const Array& array, flatbuffers::FlatBufferBuilder* builder,
+    size_t alignment) {
   const auto& src_data = array.GetBuffer<ArrayDataType::kBool>().data;
+  MaybeForceAlignment(src_data.size(), alignment, builder);
   return builder->CreateVector(src_data);
 }
 
 template <ArrayDataType T>
 DataBuffer::FlatBufferOffset CopyBuffer(
-    const Array& array, flatbuffers::FlatBufferBuilder* builder) {
+    const Array& array, flatbuffers::FlatBufferBuilder* builder,
+    size_t alignment) {
   using NativeT = ::toco::DataType<T>;
   const auto& src_data = array.GetBuffer<T>().data;
   const uint8_t* dst_data = reinterpret_cast<const uint8_t*>(src_data.data());
   auto size = src_data.size() * sizeof(NativeT);
+  MaybeForceAlignment(size, alignment, builder);
   return builder->CreateVector(dst_data, size);
 }
 
@@ -133,26 +149,27 @@ ArrayDataType DataType::Deserialize(int tensor_type) {
 }
 
 flatbuffers::Offset<flatbuffers::Vector<uint8_t>> DataBuffer::Serialize(
-    const Array& array, flatbuffers::FlatBufferBuilder* builder) {
+    const Array& array, flatbuffers::FlatBufferBuilder* builder,
+    size_t alignment) {
   if (!array.buffer) return 0;  // an empty buffer, usually an output.
 
   switch (array.data_type) {
     case ArrayDataType::kFloat:
-      return CopyBuffer<ArrayDataType::kFloat>(array, builder);
+      return CopyBuffer<ArrayDataType::kFloat>(array, builder, alignment);
     case ArrayDataType::kInt16:
-      return CopyBuffer<ArrayDataType::kInt16>(array, builder);
+      return CopyBuffer<ArrayDataType::kInt16>(array, builder, alignment);
     case ArrayDataType::kInt32:
-      return CopyBuffer<ArrayDataType::kInt32>(array, builder);
+      return CopyBuffer<ArrayDataType::kInt32>(array, builder, alignment);
     case ArrayDataType::kInt64:
-      return CopyBuffer<ArrayDataType::kInt64>(array, builder);
+      return CopyBuffer<ArrayDataType::kInt64>(array, builder, alignment);
     case ArrayDataType::kString:
-      return CopyStringToBuffer(array, builder);
+      return CopyStringToBuffer(array, builder, alignment);
     case ArrayDataType::kUint8:
-      return CopyBuffer<ArrayDataType::kUint8>(array, builder);
+      return CopyBuffer<ArrayDataType::kUint8>(array, builder, alignment);
     case ArrayDataType::kBool:
-      return CopyBoolToBuffer(array, builder);
+      return CopyBoolToBuffer(array, builder, alignment);
     case ArrayDataType::kComplex64:
-      return CopyBuffer<ArrayDataType::kComplex64>(array, builder);
+      return CopyBuffer<ArrayDataType::kComplex64>(array, builder, alignment);
     default:
       LOG(FATAL) << "Unhandled array data type.";
   }
@@ -32,9 +32,13 @@ struct DataBuffer {
 
   // Build the flatbuffer representation of a toco's Array and return the
   // corresponding offset into the flatbuffer. Note that data from the array
-  // will be copied into the flatbuffer.
+  // will be copied into the flatbuffer. If 'alignment' is greater than one,
+  // the buffer data is force-aligned to that many bytes within the
+  // flatbuffer, so that a memory-mapped model exposes properly aligned weight
+  // data without any copies at load time.
   static FlatBufferOffset Serialize(const Array& array,
-                                    flatbuffers::FlatBufferBuilder* builder);
+                                    flatbuffers::FlatBufferBuilder* builder,
+                                    size_t alignment = 0);
   // Copy data from the given tensor into toco's Array.
   static void Deserialize(const ::tflite::Tensor& tensor,
                           const ::tflite::Buffer& buffer, Array* array);
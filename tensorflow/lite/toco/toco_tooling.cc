@@ -450,6 +450,7 @@ tensorflow::Status Export(const TocoFlags& toco_flags, const Model& model,
           toco_flags.force_select_tf_ops() || toco_flags.enable_select_tf_ops();
       params.allow_custom_ops = allow_custom_ops;
       params.quantize_weights = toco_flags.post_training_quantize();
+      params.align_weight_buffers = toco_flags.align_weight_buffers();
 
       auto status = toco::tflite::Export(model, output_file_contents, params);
       if (!status.ok()) {
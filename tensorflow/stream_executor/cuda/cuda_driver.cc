@@ -571,6 +571,88 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return true;
 }
 
+#if CUDA_VERSION >= 10000
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activation(context);
+#if CUDA_VERSION >= 10010
+  CUresult res = cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_GLOBAL);
+#else
+  CUresult res = cuStreamBeginCapture(stream);
+#endif
+  if (res != CUDA_SUCCESS) {
+    return port::Status(
+        port::error::INTERNAL,
+        port::Printf("failed to begin stream capture on stream %p: %s", stream,
+                     ToString(res).c_str()));
+  }
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuStreamEndCapture(stream, graph);
+  if (res != CUDA_SUCCESS) {
+    return port::Status(
+        port::error::INTERNAL,
+        port::Printf("failed to end stream capture on stream %p: %s", stream,
+                     ToString(res).c_str()));
+  }
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(GpuContext* context,
+                                                      CUgraph graph,
+                                                      CUgraphExec* exec) {
+  ScopedActivateContext activation(context);
+  CUgraphNode error_node = nullptr;
+  char log_buffer[256];
+  log_buffer[0] = '\0';
+  CUresult res = cuGraphInstantiate(exec, graph, &error_node, log_buffer,
+                                    sizeof(log_buffer));
+  if (res != CUDA_SUCCESS) {
+    return port::Status(
+        port::error::INTERNAL,
+        port::Printf("failed to instantiate CUDA graph: %s: %s",
+                     ToString(res).c_str(), log_buffer));
+  }
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuGraphLaunch(exec, stream);
+  if (res != CUDA_SUCCESS) {
+    return port::Status(
+        port::error::INTERNAL,
+        port::Printf("failed to launch CUDA graph on stream %p: %s", stream,
+                     ToString(res).c_str()));
+  }
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::GraphDestroy(GpuContext* context, CUgraph graph) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::GraphExecDestroy(GpuContext* context,
+                                              CUgraphExec exec) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuGraphExecDestroy(exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy executable CUDA graph: " << ToString(res);
+  }
+}
+#endif  // CUDA_VERSION >= 10000
+
 /* static */ port::Status GpuDriver::LoadCubin(GpuContext* context,
                                                const char* cubin_bytes,
                                                CUmodule* module) {
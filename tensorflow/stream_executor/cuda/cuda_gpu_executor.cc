@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/stream_executor/lib/path.h"
 #include "tensorflow/stream_executor/lib/process_state.h"
 #include "tensorflow/stream_executor/lib/ptr_util.h"
+#include "tensorflow/stream_executor/lib/status_macros.h"
 #include "tensorflow/stream_executor/lib/statusor.h"
 #include "tensorflow/stream_executor/lib/str_util.h"
 #include "tensorflow/stream_executor/lib/stringprintf.h"
@@ -460,6 +461,39 @@ bool GpuExecutor::Launch(Stream* stream, const ThreadDim& thread_dims,
   return true;
 }
 
+#if CUDA_VERSION >= 10000
+port::Status GpuExecutor::BeginStreamCapture(Stream* stream) {
+  return GpuDriver::StreamBeginCapture(context_, AsGpuStreamValue(stream));
+}
+
+port::Status GpuExecutor::EndStreamCapture(Stream* stream,
+                                           void** graph_exec) {
+  CUgraph graph = nullptr;
+  SE_RETURN_IF_ERROR(GpuDriver::StreamEndCapture(
+      context_, AsGpuStreamValue(stream), &graph));
+  CUgraphExec exec = nullptr;
+  port::Status instantiate_status =
+      GpuDriver::GraphInstantiate(context_, graph, &exec);
+  // The executable graph holds its own copy of the topology; the captured
+  // graph is no longer needed either way.
+  GpuDriver::GraphDestroy(context_, graph);
+  SE_RETURN_IF_ERROR(instantiate_status);
+  *graph_exec = exec;
+  return port::Status::OK();
+}
+
+port::Status GpuExecutor::LaunchCapturedGraph(Stream* stream,
+                                              void* graph_exec) {
+  return GpuDriver::GraphLaunch(context_,
+                                static_cast<CUgraphExec>(graph_exec),
+                                AsGpuStreamValue(stream));
+}
+
+void GpuExecutor::DestroyCapturedGraph(void* graph_exec) {
+  GpuDriver::GraphExecDestroy(context_, static_cast<CUgraphExec>(graph_exec));
+}
+#endif  // CUDA_VERSION >= 10000
+
 // This is a non-essential operation; if there's a failure, proceed without
 // logging an error. It's nearly certain that in case of failures, we'd never
 // get here in the first place; these are very low-impact routines.
@@ -696,6 +730,60 @@ bool GpuExecutor::HostCallback(Stream* stream,
   delete callback;
 }
 
+GpuExecutor::HostCallbackFrame* GpuExecutor::PopHostCallbackFrame() {
+  const uint32 start =
+      host_callback_frame_index_.fetch_add(1, std::memory_order_relaxed);
+  for (int i = 0; i < kNumHostCallbackFrames; ++i) {
+    HostCallbackFrame* frame =
+        &host_callback_frames_[(start + i) % kNumHostCallbackFrames];
+    bool expected = false;
+    if (frame->in_use.compare_exchange_strong(expected, true,
+                                              std::memory_order_acquire)) {
+      return frame;
+    }
+  }
+  return nullptr;
+}
+
+bool GpuExecutor::HostCallback(Stream* stream, void (*callback)(void*),
+                               void* arg) {
+  HostCallbackFrame* frame = PopHostCallbackFrame();
+  if (frame == nullptr) {
+    // All pre-allocated frames are in flight; fall back to the heap. The
+    // landing routine deletes frames it does not own.
+    frame = new HostCallbackFrame;
+    frame->owner = nullptr;
+  }
+  frame->fn = callback;
+  frame->arg = arg;
+  if (!GpuDriver::AddStreamCallback(context_, AsGpuStreamValue(stream),
+                                    InternalHostCallbackWithArg, frame)) {
+    if (frame->owner != nullptr) {
+      frame->in_use.store(false, std::memory_order_release);
+    } else {
+      delete frame;
+    }
+    return false;
+  }
+  return true;
+}
+
+/* static */ void GpuExecutor::InternalHostCallbackWithArg(CUstream stream,
+                                                           CUresult status,
+                                                           void* data) {
+  HostCallbackFrame* frame = static_cast<HostCallbackFrame*>(data);
+  void (*fn)(void*) = frame->fn;
+  void* arg = frame->arg;
+  // Release the frame before invoking the callback so it can be reused while
+  // the callback runs.
+  if (frame->owner != nullptr) {
+    frame->in_use.store(false, std::memory_order_release);
+  } else {
+    delete frame;
+  }
+  fn(arg);
+}
+
 port::Status GpuExecutor::AllocateEvent(Event* event) {
   return AsGpuEvent(event)->Init();
 }
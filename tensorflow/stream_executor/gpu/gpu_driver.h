@@ -208,6 +208,38 @@ class GpuDriver {
                            GpuStreamHandle stream, void** kernel_params,
                            void** extra);
 
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 10000
+  // Stream capture and executable graph support, via cuStreamBeginCapture et
+  // al. Work submitted to a capturing stream is recorded instead of executed;
+  // the recorded launch sequence can be instantiated once and then replayed
+  // as a single submission, amortizing per-kernel launch overhead.
+  // (supported on CUDA 10.0+ only)
+
+  // Puts `stream` into capture mode.
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends capture on `stream` and returns the captured graph in `graph`. The
+  // caller owns the graph and must destroy it with GraphDestroy.
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Instantiates `graph` into an executable graph that can be launched
+  // repeatedly. The caller must destroy it with GraphExecDestroy.
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* exec);
+
+  // Replays the captured launch sequence in `exec` on `stream`.
+  static port::Status GraphLaunch(GpuContext* context, GpuGraphExecHandle exec,
+                                  GpuStreamHandle stream);
+
+  static void GraphDestroy(GpuContext* context, GpuGraphHandle graph);
+
+  static void GraphExecDestroy(GpuContext* context, GpuGraphExecHandle exec);
+#endif
+
   // Loads ptx_contents with the CUDA driver's PTX JIT and stores the resulting
   // handle in "module". Any error logs that are produced are logged internally.
   // (supported on CUDA only)
@@ -22,6 +22,7 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_EXECUTOR_H_
 #define TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_EXECUTOR_H_
 
+#include <atomic>
 #include <set>
 #include <unordered_map>
 
@@ -52,7 +53,11 @@ class GpuExecutor : public internal::StreamExecutorInterface {
         cc_major_(0),
         cc_minor_(0),
         version_(0),
-        plugin_config_(plugin_config) {}
+        plugin_config_(plugin_config) {
+    for (HostCallbackFrame& frame : host_callback_frames_) {
+      frame.owner = this;
+    }
+  }
 
   // See the corresponding StreamExecutor methods for method comments on the
   // following overrides.
@@ -73,6 +78,14 @@ class GpuExecutor : public internal::StreamExecutorInterface {
               const BlockDim& block_dims, const KernelBase& k,
               const KernelArgsArrayBase& args) override;
 
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 10000
+  // (supported on CUDA 10.0+ only)
+  port::Status BeginStreamCapture(Stream* stream) override;
+  port::Status EndStreamCapture(Stream* stream, void** graph_exec) override;
+  port::Status LaunchCapturedGraph(Stream* stream, void* graph_exec) override;
+  void DestroyCapturedGraph(void* graph_exec) override;
+#endif
+
   // (supported on CUDA only)
   int CalculateOccupancy(const DeviceDescription& device_description,
                          uint64 registers_per_thread,
@@ -155,6 +168,9 @@ class GpuExecutor : public internal::StreamExecutorInterface {
   bool HostCallback(Stream* stream,
                     std::function<port::Status()> callback) override;
 
+  bool HostCallback(Stream* stream, void (*callback)(void*),
+                    void* arg) override;
+
   bool AllocateStream(Stream* stream) override;
 
   void DeallocateStream(Stream* stream) override;
@@ -260,6 +276,30 @@ class GpuExecutor : public internal::StreamExecutorInterface {
   static void InternalHostCallback(GpuStreamHandle stream, GpuStatus status,
                                    void* data);
 
+  // Landing routine for callbacks enqueued through the allocation-free
+  // HostCallback overload.
+  // data: A HostCallbackFrame, returned to the frame pool by this call (or
+  //       deleted, if it was heap-allocated because the pool was exhausted).
+  static void InternalHostCallbackWithArg(GpuStreamHandle stream,
+                                          GpuStatus status, void* data);
+
+  // A pre-allocated frame carrying the function and argument entrained by
+  // the allocation-free HostCallback overload.
+  struct HostCallbackFrame {
+    void (*fn)(void*);
+    void* arg;
+    // Executor owning the frame, or null if the frame was heap-allocated.
+    GpuExecutor* owner;
+    // True while the frame holds a callback in flight. Frames are claimed by
+    // atomically flipping this flag; a linear scan over the small fixed pool
+    // is cheap and avoids the ABA hazards of a lock-free free list.
+    std::atomic<bool> in_use{false};
+  };
+
+  // Claims a frame from the pool, or returns null if all frames are in
+  // flight.
+  HostCallbackFrame* PopHostCallbackFrame();
+
   // Collects metadata for the specified kernel.
   bool GetKernelMetadata(GpuKernel* cuda_kernel,
                          KernelMetadata* kernel_metadata);
@@ -307,6 +347,18 @@ class GpuExecutor : public internal::StreamExecutorInterface {
   std::unordered_map<const void*, std::pair<GpuModuleHandle, uint64>>
       gpu_binary_to_module_ GUARDED_BY(in_memory_modules_mu_);
 
+  // Number of pre-allocated host-callback frames per executor. Pool
+  // exhaustion is not an error; further enqueues fall back to the heap.
+  static constexpr int kNumHostCallbackFrames = 256;
+
+  // Fixed pool of host-callback frames, so that hot completion paths can
+  // enqueue callbacks without heap allocation or locking.
+  HostCallbackFrame host_callback_frames_[kNumHostCallbackFrames];
+
+  // Rotating index into host_callback_frames_ used to spread frame claims
+  // across the pool.
+  std::atomic<uint32> host_callback_frame_index_{0};
+
   // Guards the launched kernel set.
   mutex launched_kernels_mu_;
 
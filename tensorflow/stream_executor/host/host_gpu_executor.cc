@@ -158,6 +158,12 @@ bool HostExecutor::HostCallback(Stream *stream,
   return true;
 }
 
+bool HostExecutor::HostCallback(Stream *stream, void (*callback)(void *),
+                                void *arg) {
+  AsHostStream(stream)->EnqueueTask([callback, arg]() { callback(arg); });
+  return true;
+}
+
 bool HostExecutor::AllocateStream(Stream *stream) { return true; }
 
 void HostExecutor::DeallocateStream(Stream *stream) {}
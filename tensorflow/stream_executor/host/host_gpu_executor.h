@@ -105,6 +105,8 @@ class HostExecutor : public internal::StreamExecutorInterface {
 
   bool HostCallback(Stream *stream,
                     std::function<port::Status()> callback) override;
+  bool HostCallback(Stream *stream, void (*callback)(void *),
+                    void *arg) override;
 
   port::Status AllocateEvent(Event *event) override {
     return port::Status(port::error::UNIMPLEMENTED, "");
@@ -577,6 +577,59 @@ bool GpuExecutor::HostCallback(Stream* stream,
   delete callback;
 }
 
+GpuExecutor::HostCallbackFrame* GpuExecutor::PopHostCallbackFrame() {
+  const uint32 start =
+      host_callback_frame_index_.fetch_add(1, std::memory_order_relaxed);
+  for (int i = 0; i < kNumHostCallbackFrames; ++i) {
+    HostCallbackFrame* frame =
+        &host_callback_frames_[(start + i) % kNumHostCallbackFrames];
+    bool expected = false;
+    if (frame->in_use.compare_exchange_strong(expected, true,
+                                              std::memory_order_acquire)) {
+      return frame;
+    }
+  }
+  return nullptr;
+}
+
+bool GpuExecutor::HostCallback(Stream* stream, void (*callback)(void*),
+                               void* arg) {
+  HostCallbackFrame* frame = PopHostCallbackFrame();
+  if (frame == nullptr) {
+    // All pre-allocated frames are in flight; fall back to the heap. The
+    // landing routine deletes frames it does not own.
+    frame = new HostCallbackFrame;
+    frame->owner = nullptr;
+  }
+  frame->fn = callback;
+  frame->arg = arg;
+  if (!GpuDriver::AddStreamCallback(context_, AsGpuStreamValue(stream),
+                                    InternalHostCallbackWithArg, frame)) {
+    if (frame->owner != nullptr) {
+      frame->in_use.store(false, std::memory_order_release);
+    } else {
+      delete frame;
+    }
+    return false;
+  }
+  return true;
+}
+
+/* static */ void GpuExecutor::InternalHostCallbackWithArg(
+    GpuStreamHandle stream, hipError_t status, void* data) {
+  HostCallbackFrame* frame = static_cast<HostCallbackFrame*>(data);
+  void (*fn)(void*) = frame->fn;
+  void* arg = frame->arg;
+  // Release the frame before invoking the callback so it can be reused while
+  // the callback runs.
+  if (frame->owner != nullptr) {
+    frame->in_use.store(false, std::memory_order_release);
+  } else {
+    delete frame;
+  }
+  fn(arg);
+}
+
 port::Status GpuExecutor::AllocateEvent(Event* event) {
   return AsGpuEvent(event)->Init();
 }
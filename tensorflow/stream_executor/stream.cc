@@ -5124,6 +5124,18 @@ Stream &Stream::ThenDoHostCallback(std::function<void()> callback) {
   return *this;
 }
 
+Stream &Stream::ThenDoHostCallbackWithArg(void (*callback)(void *arg),
+                                          void *arg) {
+  // Deliberately no VLOG_CALL here: this entry point exists for hot
+  // completion paths where per-callback overhead matters.
+  if (!ok()) {
+    LOG(INFO) << DebugStreamPointers()
+              << " was in error state before adding host callback";
+  }
+  CheckError(parent_->HostCallback(this, callback, arg));
+  return *this;
+}
+
 Stream &Stream::ThenDoHostCallbackWithStatus(
     std::function<port::Status()> callback) {
   VLOG_CALL(PARAM(callback));
@@ -1928,6 +1928,13 @@ class Stream {
   // TODO(b/112125301): Eventually remove this method.
   Stream &ThenDoHostCallback(std::function<void()> callback);
 
+  // Entrains onto the stream a callback to the host (from the device) that
+  // takes a single fixed argument. Behaves as ThenDoHostCallback, but does
+  // not construct a std::function wrapper per call; hot completion paths
+  // that enqueue thousands of callbacks per second should prefer this form.
+  // `callback` must remain invocable until it runs, and must not fail.
+  Stream &ThenDoHostCallbackWithArg(void (*callback)(void *arg), void *arg);
+
   // Entrains onto the stream a callback to the host (from the device).
   // Host callbacks block/occupy the stream just as device functions
   // (execute one at a time, block later stream operations).
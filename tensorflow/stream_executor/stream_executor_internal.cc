@@ -54,5 +54,15 @@ bool StreamExecutorInterface::HostCallback(Stream* stream,
       }));
 }
 
+// The default implementation routes through the allocating std::function
+// overload; platforms with hot completion paths override this with an
+// allocation-free version.
+bool StreamExecutorInterface::HostCallback(Stream* stream,
+                                           void (*callback)(void*),
+                                           void* arg) {
+  return HostCallback(
+      stream, std::function<void()>([callback, arg]() { callback(arg); }));
+}
+
 }  // namespace internal
 }  // namespace stream_executor
@@ -242,6 +242,11 @@ class StreamExecutorInterface {
   virtual bool HostCallback(Stream *stream, std::function<void()> callback);
   virtual bool HostCallback(Stream *stream,
                             std::function<port::Status()> callback) = 0;
+  // Entrains a host callback taking a fixed argument. Implementations should
+  // avoid per-call heap allocation on this path; the default implementation
+  // falls back to the allocating std::function overload.
+  virtual bool HostCallback(Stream *stream, void (*callback)(void *),
+                            void *arg);
   virtual port::Status AllocateEvent(Event *event) = 0;
   virtual port::Status DeallocateEvent(Event *event) = 0;
   virtual port::Status RecordEvent(Stream *stream, Event *event) = 0;
@@ -259,6 +264,25 @@ class StreamExecutorInterface {
     return port::Status(port::error::UNIMPLEMENTED,
                         "GetStatus is not supported on this executor.");
   }
+
+  // Stream capture / replay support. While a stream is capturing, work
+  // submitted to it is recorded instead of executed; EndStreamCapture
+  // instantiates the recorded launch sequence into an opaque executable
+  // graph handle that LaunchCapturedGraph replays as a single submission.
+  // Platforms without capture support return UNIMPLEMENTED.
+  virtual port::Status BeginStreamCapture(Stream *stream) {
+    return port::Status(port::error::UNIMPLEMENTED,
+                        "stream capture is not supported on this executor.");
+  }
+  virtual port::Status EndStreamCapture(Stream *stream, void **graph_exec) {
+    return port::Status(port::error::UNIMPLEMENTED,
+                        "stream capture is not supported on this executor.");
+  }
+  virtual port::Status LaunchCapturedGraph(Stream *stream, void *graph_exec) {
+    return port::Status(port::error::UNIMPLEMENTED,
+                        "graph replay is not supported on this executor.");
+  }
+  virtual void DestroyCapturedGraph(void *graph_exec) {}
   virtual int PlatformDeviceCount() = 0;
   virtual port::Status EnablePeerAccessTo(StreamExecutorInterface *other) = 0;
   virtual bool CanEnablePeerAccessTo(StreamExecutorInterface *other) = 0;
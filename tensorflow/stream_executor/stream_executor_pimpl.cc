@@ -486,6 +486,24 @@ bool StreamExecutor::Launch(Stream *stream, const ThreadDim &thread_dims,
   return implementation_->Launch(stream, thread_dims, block_dims, kernel, args);
 }
 
+port::Status StreamExecutor::BeginStreamCapture(Stream *stream) {
+  return implementation_->BeginStreamCapture(stream);
+}
+
+port::Status StreamExecutor::EndStreamCapture(Stream *stream,
+                                              void **graph_exec) {
+  return implementation_->EndStreamCapture(stream, graph_exec);
+}
+
+port::Status StreamExecutor::LaunchCapturedGraph(Stream *stream,
+                                                 void *graph_exec) {
+  return implementation_->LaunchCapturedGraph(stream, graph_exec);
+}
+
+void StreamExecutor::DestroyCapturedGraph(void *graph_exec) {
+  implementation_->DestroyCapturedGraph(graph_exec);
+}
+
 port::Status StreamExecutor::BlockHostUntilDone(Stream *stream) {
   port::Status result;
   SCOPED_TRACE(TraceListener::BlockHostUntilDone, &result, stream);
@@ -751,6 +769,11 @@ bool StreamExecutor::HostCallback(Stream *stream,
   return implementation_->HostCallback(stream, std::move(callback));
 }
 
+bool StreamExecutor::HostCallback(Stream *stream, void (*callback)(void *),
+                                  void *arg) {
+  return implementation_->HostCallback(stream, callback, arg);
+}
+
 port::Status StreamExecutor::AllocateEvent(Event *event) {
   return implementation_->AllocateEvent(event);
 }
@@ -453,6 +453,22 @@ class StreamExecutor {
               const BlockDim &block_dims, const KernelBase &kernel,
               const KernelArgsArrayBase &args);
 
+  // Stream capture / replay (experimental). Between BeginStreamCapture and
+  // EndStreamCapture, work submitted to `stream` is recorded rather than
+  // executed; EndStreamCapture returns an opaque executable graph handle in
+  // `graph_exec` that LaunchCapturedGraph replays as a single submission,
+  // amortizing per-kernel launch overhead for fixed launch sequences.
+  //
+  // The captured sequence bakes in kernel parameters, including device
+  // addresses; callers are responsible for destroying the handle with
+  // DestroyCapturedGraph and re-capturing whenever shapes, buffers, or other
+  // resources referenced by the sequence change. Returns UNIMPLEMENTED on
+  // platforms without capture support.
+  port::Status BeginStreamCapture(Stream *stream);
+  port::Status EndStreamCapture(Stream *stream, void **graph_exec);
+  port::Status LaunchCapturedGraph(Stream *stream, void *graph_exec);
+  void DestroyCapturedGraph(void *graph_exec);
+
   // Gets-or-creates (creates with memoization) a FftSupport datatype that can
   // be used to execute FFT routines on the current platform.
   //
@@ -567,6 +583,11 @@ class StreamExecutor {
   // This is the preferred form for a callback that may return an error.
   bool HostCallback(Stream *stream, std::function<port::Status()> callback);
 
+  // Entrains on a stream a user-specified function taking a fixed argument to
+  // be run on the host, without allocating a std::function wrapper per call.
+  // See Stream::ThenDoHostCallbackWithArg for full details.
+  bool HostCallback(Stream *stream, void (*callback)(void *), void *arg);
+
   // Performs platform-specific allocation and initialization of an event.
   port::Status AllocateEvent(Event *event);
 
@@ -43,6 +43,19 @@ TEST_F(StreamTest, InitOk) {
   EXPECT_TRUE(stream.ok());
 }
 
+TEST_F(StreamTest, DoHostCallbackWithArg) {
+  std::unique_ptr<StreamExecutor> executor = NewStreamExecutor();
+  Stream stream(executor.get());
+  stream.Init();
+  EXPECT_TRUE(stream.ok());
+
+  int value = 0;
+  stream.ThenDoHostCallbackWithArg(
+      [](void* arg) { *static_cast<int*>(arg) = 42; }, &value);
+  EXPECT_TRUE(stream.BlockHostUntilDone().ok());
+  EXPECT_EQ(42, value);
+}
+
 TEST_F(StreamTest, OneSubStream) {
   std::unique_ptr<StreamExecutor> executor = NewStreamExecutor();
   Stream stream(executor.get());